@@ -0,0 +1,264 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "alloc_tracker.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+//
+// These are plain counters with no constructors, so they're usable
+// from operator new before anything else has been set up.
+//
+
+static atomic<uint64_t> total_allocations(0);
+static atomic<uint64_t> total_frees(0);
+static atomic<uint64_t> total_bytes(0);
+static thread_local alloc_counts thread_counts = { 0, 0, 0 };
+
+#if defined(ALLOC_TRACKING)
+static void count_allocation(const size_t size);
+static void count_free(void* pointer);
+static void* tracked_malloc(const size_t size);
+static void* tracked_aligned_malloc(const size_t size, const size_t alignment);
+static void tracked_free(void* pointer);
+static void tracked_aligned_free(void* pointer);
+#endif
+
+alloc_frame_stats::alloc_frame_stats() {
+	name = "";
+	frame_start = {};
+	frames = 0;
+	last_frame_allocations = 0;
+	total_allocations = 0;
+	frames_with_allocations = 0;
+	peak_allocations = 0;
+}
+
+bool is_alloc_tracking_enabled() {
+#if defined(ALLOC_TRACKING)
+	return true;
+#else
+	return false;
+#endif
+}
+
+alloc_counts get_alloc_counts() {
+	alloc_counts counts;
+
+	counts.allocations = total_allocations.load(memory_order_relaxed);
+	counts.frees = total_frees.load(memory_order_relaxed);
+	counts.bytes = total_bytes.load(memory_order_relaxed);
+
+	return counts;
+}
+
+alloc_counts get_thread_alloc_counts() {
+	return thread_counts;
+}
+
+void initialize_alloc_frame_stats(alloc_frame_stats* stats, const char* name) {
+	stats->name = name;
+	stats->frame_start = get_thread_alloc_counts();
+	stats->frames.store(0);
+	stats->last_frame_allocations.store(0);
+	stats->total_allocations.store(0);
+	stats->frames_with_allocations.store(0);
+	stats->peak_allocations.store(0);
+}
+
+void begin_alloc_frame(alloc_frame_stats* stats) {
+	stats->frame_start = get_thread_alloc_counts();
+}
+
+void end_alloc_frame(alloc_frame_stats* stats) {
+	uint64_t allocations;
+
+	allocations = get_thread_alloc_counts().allocations - stats->frame_start.allocations;
+
+	stats->frames.store(stats->frames.load(memory_order_relaxed) + 1, memory_order_relaxed);
+	stats->last_frame_allocations.store(allocations, memory_order_relaxed);
+	stats->total_allocations.store(
+		stats->total_allocations.load(memory_order_relaxed) + allocations,
+		memory_order_relaxed
+	);
+
+	if (allocations > 0) {
+		stats->frames_with_allocations.store(
+			stats->frames_with_allocations.load(memory_order_relaxed) + 1,
+			memory_order_relaxed
+		);
+	}
+
+	if (allocations > stats->peak_allocations.load(memory_order_relaxed)) {
+		stats->peak_allocations.store(allocations, memory_order_relaxed);
+	}
+}
+
+string get_alloc_report(const alloc_frame_stats* stats) {
+	uint64_t frames;
+	char report[256];
+
+	if (!is_alloc_tracking_enabled()) {
+		return string("Allocations (") + stats->name + "): not tracked in this build\n";
+	}
+
+	frames = stats->frames.load(memory_order_relaxed);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Allocations (%s): %llu last frame, %.2f a frame on average, "
+		"at most %llu, in %llu of %llu frames\n",
+		stats->name,
+		(unsigned long long)stats->last_frame_allocations.load(memory_order_relaxed),
+		frames > 0 ? (double)stats->total_allocations.load(memory_order_relaxed) / (double)frames : 0.0,
+		(unsigned long long)stats->peak_allocations.load(memory_order_relaxed),
+		(unsigned long long)stats->frames_with_allocations.load(memory_order_relaxed),
+		(unsigned long long)frames
+	);
+
+	return report;
+}
+
+#if defined(ALLOC_TRACKING)
+
+static void count_allocation(const size_t size) {
+	total_allocations.fetch_add(1, memory_order_relaxed);
+	total_bytes.fetch_add(size, memory_order_relaxed);
+
+	thread_counts.allocations++;
+	thread_counts.bytes += size;
+}
+
+static void count_free(void* pointer) {
+	if (pointer) {
+		total_frees.fetch_add(1, memory_order_relaxed);
+		thread_counts.frees++;
+	}
+}
+
+static void* tracked_malloc(const size_t size) {
+	void* pointer;
+
+	count_allocation(size);
+
+	// malloc(0) may return NULL, but new has to return something.
+	pointer = malloc(size > 0 ? size : 1);
+	if (!pointer) {
+		throw bad_alloc();
+	}
+
+	return pointer;
+}
+
+static void* tracked_aligned_malloc(const size_t size, const size_t alignment) {
+	void* pointer;
+
+	count_allocation(size);
+
+#if defined(_WIN32)
+	pointer = _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+	if (posix_memalign(&pointer, alignment < sizeof(void*) ? sizeof(void*) : alignment, size > 0 ? size : 1) != 0) {
+		pointer = NULL;
+	}
+#endif
+
+	if (!pointer) {
+		throw bad_alloc();
+	}
+
+	return pointer;
+}
+
+static void tracked_free(void* pointer) {
+	count_free(pointer);
+	free(pointer);
+}
+
+static void tracked_aligned_free(void* pointer) {
+	count_free(pointer);
+
+#if defined(_WIN32)
+	_aligned_free(pointer);
+#else
+	free(pointer);
+#endif
+}
+
+//
+// Every form of the global new and delete, so nothing slips past.
+//
+
+void* operator new(size_t size) {
+	return tracked_malloc(size);
+}
+
+void* operator new[](size_t size) {
+	return tracked_malloc(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+	try {
+		return tracked_malloc(size);
+	} catch (...) {
+		return NULL;
+	}
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+	try {
+		return tracked_malloc(size);
+	} catch (...) {
+		return NULL;
+	}
+}
+
+void* operator new(size_t size, align_val_t alignment) {
+	return tracked_aligned_malloc(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, align_val_t alignment) {
+	return tracked_aligned_malloc(size, (size_t)alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+	tracked_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+	tracked_free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+	tracked_free(pointer);
+}
+
+void operator delete(void* pointer, align_val_t) noexcept {
+	tracked_aligned_free(pointer);
+}
+
+void operator delete[](void* pointer, align_val_t) noexcept {
+	tracked_aligned_free(pointer);
+}
+
+void operator delete(void* pointer, size_t, align_val_t) noexcept {
+	tracked_aligned_free(pointer);
+}
+
+void operator delete[](void* pointer, size_t, align_val_t) noexcept {
+	tracked_aligned_free(pointer);
+}
+
+#endif // ALLOC_TRACKING
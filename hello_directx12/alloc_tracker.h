@@ -0,0 +1,59 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Counts heap allocations, so we can see (and check) that the per-frame
+// path doesn't make any once it's warmed up.
+//
+// With ALLOC_TRACKING defined (it is in debug builds), the global
+// operator new and delete are replaced with ones that count every call,
+// both for the whole program and for each thread. Without it, the
+// counts just stay at zero.
+//
+// Each thread that wants per-frame numbers keeps an alloc_frame_stats,
+// and brackets its frame with begin_alloc_frame and end_alloc_frame.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(_DEBUG) && !defined(ALLOC_TRACKING)
+#define ALLOC_TRACKING
+#endif
+
+struct alloc_counts {
+	uint64_t allocations;
+	uint64_t frees;
+	uint64_t bytes;
+};
+
+// Written by the thread it belongs to, read by anyone.
+struct alloc_frame_stats {
+	alloc_frame_stats();
+
+	const char* name;
+	alloc_counts frame_start;
+
+	std::atomic<uint64_t> frames;
+	std::atomic<uint64_t> last_frame_allocations;
+	std::atomic<uint64_t> total_allocations;
+	std::atomic<uint64_t> frames_with_allocations;
+	std::atomic<uint64_t> peak_allocations;
+};
+
+// Whether the counts mean anything in this build.
+bool is_alloc_tracking_enabled();
+
+// Everything allocated so far, on every thread.
+alloc_counts get_alloc_counts();
+// Everything allocated so far by the calling thread.
+alloc_counts get_thread_alloc_counts();
+
+void initialize_alloc_frame_stats(alloc_frame_stats* stats, const char* name);
+// Both from the thread the stats belong to.
+void begin_alloc_frame(alloc_frame_stats* stats);
+void end_alloc_frame(alloc_frame_stats* stats);
+
+std::string get_alloc_report(const alloc_frame_stats* stats);
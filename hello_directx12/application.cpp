@@ -1,11 +1,13 @@
 // Liam Wynn, 9/26/2024, Hello DirectX 12
 
 #include "application.h"
+#include "hash_utils.h"
 #include "utils.h"
 #include <DirectXTex.h>
 #include <iostream>
 #include <chrono>
 #include <filesystem>
+#include <cstring>
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -18,18 +20,35 @@ bool initialize_application(
 	const bool use_warp
 ) {
 	bool success;
+	sim_snapshot* initial_world;
+	atlas_settings atlas;
 
 	app->screen_w = screen_w;
 	app->screen_h = screen_h;
 	app->field_of_view = 45.0f;
+	app->loading = NULL;
+	app->mapped_materials = NULL;
+	app->cube_material = MATERIAL_INVALID;
+	app->mapped_objects = NULL;
+	app->mapped_indirect_upload = NULL;
+	app->render_constant_count = 0;
 
-	app->angle = 0.0f;
+	set_profile_thread_name("Main thread");
+	initialize_alloc_frame_stats(&(app->main_allocs), "main thread");
+	initialize_frame_pacer(&(app->pacer), FRAME_RATE_LIMIT);
+	initialize_job_system(&(app->jobs), 0, PIN_JOB_THREADS);
+	initialize_io_queue(&(app->io), IO_QUEUE_DEPTH, false);
+	initialize_texture_cache(&(app->textures), TEXTURE_CACHE_BUDGET);
 
 	//
 	// First set up the DX12 Handler.
 	//
 
 	app->dx12 = new dx12_handler;
+	app->dx12->presentation.max_frame_latency = MAX_FRAME_LATENCY;
+	app->dx12->presentation.vsync = VSYNC;
+	app->dx12->presentation.allow_tearing = ALLOW_TEARING;
+
 	success = initialize_directx_12(
 		app->dx12,
 		hwnd,
@@ -60,12 +79,68 @@ bool initialize_application(
 
 	app->scissor_rect = CD3DX12_RECT(0, 0, (long)screen_w, (long)screen_h);
 
+	//
+	// Set up the shader cache. Shaders are compiled on a miss, so
+	// this is always safe to do even with an empty cache directory.
+	//
+
+	initialize_shader_cache(
+		&(app->shaders),
+		"./shader_cache",
+		compile_shader_from_file,
+		D3D_COMPILER_VERSION
+	);
+
+	// This is allowed to fail: we just won't have precompiled shaders.
+	open_shader_archive(&(app->shader_pack), "./shaders.pak");
+	// So is this, and then the assets are loose files.
+	open_asset_archive(&(app->asset_pack), "./assets.pak");
+
+	initialize_material_registry(&(app->materials), MAX_MATERIALS, SRV_HEAP_SIZE);
+
+	initialize_occlusion_buffer(&(app->occlusion), OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+	app->cube_visible = true;
+
+	// The page has no mips, so the gutter only has to cover bilinear
+	// filtering.
+	atlas = {};
+	atlas.page_width = ATLAS_PAGE_SIZE;
+	atlas.page_height = ATLAS_PAGE_SIZE;
+	atlas.padding = ATLAS_PADDING;
+	atlas.mip_levels = 1;
+	initialize_atlas_allocator(&(app->atlas), &atlas);
+
 	//
 	// Next load all the assets needed for running the program.
 	//
 
 	load_assets(app);
 
+	//
+	// Finally, start the game logic on its own thread.
+	//
+
+	initial_world = new sim_snapshot;
+	initialize_world(app, initial_world);
+	initialize_simulation(&(app->sim), SIMULATION_RATE, step_world, NULL, initial_world);
+	delete initial_world;
+
+	app->drawn_world = app->sim.world;
+	start_simulation(&(app->sim));
+
+	//
+	// And start the render thread. From here on, only it uses the
+	// command list.
+	//
+
+	initialize_render_ring(&(app->render_commands), RENDER_RING_SIZE, RENDER_RING_WAIT);
+	initialize_frame_arena(&(app->render_arena), RENDER_ARENA_SIZE);
+	app->render_draws = NULL;
+	app->render_draw_count = 0;
+	app->render_draw_capacity = 0;
+	initialize_render_queue(&(app->draw_queue), MAX_DRAWS_PER_FRAME);
+	app->render_thread = thread(run_render_thread, app);
+
 	return success;
 }
 
@@ -73,44 +148,291 @@ void load_assets(application* app) {
 	ComPtr<ID3D12GraphicsCommandList> command_list;
 	ComPtr<ID3D12CommandAllocator> command_allocator;
 	HRESULT result;
+	asset_loading loading;
+	task_graph startup;
+	uint32_t root_signature;
+	uint32_t vertex_shader;
+	uint32_t pixel_shader;
+	uint32_t pipeline_state;
+	uint32_t sprite_vertex_shader;
+	uint32_t sprite_pixel_shader;
+	uint32_t sprite_pipelines;
+	uint32_t decode_texture;
+	uint32_t constant_buffer;
+	uint32_t cube_buffers;
+	uint32_t upload_texture;
+	uint32_t materials;
+	uint32_t sprite_buffers;
+	uint32_t cull_shader;
+	uint32_t cull_pipeline;
+	uint32_t indirect_buffers;
+	uint32_t frame_graph;
+	uint32_t depth_view;
+	bool success;
 
 	command_list = app->dx12->command_list;
 	command_allocator = app->dx12->command_allocator;
+	app->loading = &loading;
 
 	//
-	// First initialize the shader pipeline's root signature.
+	// The tasks record the texture copy onto the command list, and it
+	// all gets submitted at the end.
 	//
 
-	app->root_signature = initialize_root_signature(app);
+	result = command_list->Reset(command_allocator.Get(), NULL);
+	throw_if_failed(result);
+	begin_tracked_command_list(app->dx12);
 
 	//
-	// Next, create the pipeline state and attach it to the
-	// command list.
+	// If the shaders were compiled offline into the shader archive, we
+	// use those. Looking them up is quick, so it isn't worth a task.
 	//
 
-	app->pipeline_state = initialize_pipeline_state(app);
+	loading.shader_defines.push_back({ "APPLY_GAMMA", "0" });
 
-	result = command_list->Reset(command_allocator.Get(), NULL);
+	loading.shaders_from_archive = find_shaders_in_archive(
+		app,
+		"texture_shader.hlsl",
+		loading.shader_defines,
+		&(loading.vertex_shader),
+		&(loading.pixel_shader)
+	);
+
+	loading.sprite_shaders_from_archive = find_shaders_in_archive(
+		app,
+		"sprite_shader.hlsl",
+		vector<shader_define>(),
+		&(loading.sprite_vertex_shader),
+		&(loading.sprite_pixel_shader)
+	);
+
+	loading.cull_shader_from_archive = find_compute_shader_in_archive(
+		app,
+		"cull_shader.hlsl",
+		vector<shader_define>(),
+		&(loading.cull_shader)
+	);
+
+	//
+	// Now lay out startup as a graph. The device is free threaded, so
+	// compiling shaders, decoding the PNG, and creating the root
+	// signature and pipeline state can all happen at once. The steps
+	// that place resources share the GPU allocator and the command
+	// list, which aren't, so they go one after another.
+	//
+
+	reset_task_graph(&startup);
+
+	root_signature = add_task(&startup, "root signature", create_root_signature_task, app);
+	pipeline_state = add_task(&startup, "pipeline state", create_pipeline_state_task, app);
+	add_task_dependency(&startup, pipeline_state, root_signature);
+
+	if (!loading.shaders_from_archive) {
+		vertex_shader = add_task(&startup, "vertex shader", compile_vertex_shader_task, app);
+		pixel_shader = add_task(&startup, "pixel shader", compile_pixel_shader_task, app);
+		add_task_dependency(&startup, pipeline_state, vertex_shader);
+		add_task_dependency(&startup, pipeline_state, pixel_shader);
+	}
+
+	sprite_pipelines = add_task(&startup, "sprite pipelines", create_sprite_pipelines_task, app);
+	add_task_dependency(&startup, sprite_pipelines, root_signature);
+
+	if (!loading.sprite_shaders_from_archive) {
+		sprite_vertex_shader = add_task(&startup, "sprite vertex shader", compile_sprite_vertex_shader_task, app);
+		sprite_pixel_shader = add_task(&startup, "sprite pixel shader", compile_sprite_pixel_shader_task, app);
+		add_task_dependency(&startup, sprite_pipelines, sprite_vertex_shader);
+		add_task_dependency(&startup, sprite_pipelines, sprite_pixel_shader);
+	}
+
+	// The command signature is made against the root signature, since
+	// it sets some of its parameters.
+	cull_pipeline = add_task(&startup, "cull pipeline", create_cull_pipeline_task, app);
+	add_task_dependency(&startup, cull_pipeline, root_signature);
+
+	if (!loading.cull_shader_from_archive) {
+		cull_shader = add_task(&startup, "cull shader", compile_cull_shader_task, app);
+		add_task_dependency(&startup, cull_pipeline, cull_shader);
+	}
+
+	decode_texture = add_task(&startup, "decode texture", decode_texture_task, app);
+	constant_buffer = add_task(&startup, "constant buffer", create_constant_buffer_task, app);
+	cube_buffers = add_task(&startup, "cube buffers", create_cube_task, app);
+	upload_texture = add_task(&startup, "upload texture", upload_texture_task, app);
+	add_task_dependency(&startup, cube_buffers, constant_buffer);
+	add_task_dependency(&startup, upload_texture, decode_texture);
+	add_task_dependency(&startup, upload_texture, cube_buffers);
+	materials = add_task(&startup, "materials", create_materials_task, app);
+	add_task_dependency(&startup, materials, upload_texture);
+	sprite_buffers = add_task(&startup, "sprite buffers", create_sprite_buffers_task, app);
+	add_task_dependency(&startup, sprite_buffers, materials);
+	indirect_buffers = add_task(&startup, "indirect buffers", create_indirect_buffers_task, app);
+	add_task_dependency(&startup, indirect_buffers, sprite_buffers);
+
+	// The frame graph is also what creates the depth buffer, since it
+	// is one of the graph's transients. It brings in the indirect draw
+	// buffers, so those have to exist first.
+	frame_graph = add_task(&startup, "frame graph", create_frame_graph_task, app);
+	depth_view = add_task(&startup, "depth view", create_depth_view_task, app);
+	add_task_dependency(&startup, frame_graph, indirect_buffers);
+	add_task_dependency(&startup, depth_view, frame_graph);
+
+	success = run_task_graph(&startup, &(app->jobs));
+	if (!success) {
+		throw_if_failed(E_FAIL);
+	}
+
+	//
+	// Finally, submit the copies and wait for the GPU, once, for all of
+	// it. After that the upload buffer can go.
+	//
+
+	result = command_list->Close();
 	throw_if_failed(result);
-	command_list->SetPipelineState(app->pipeline_state.Get());
+	execute_tracked_command_list(app->dx12);
+
+	wait_for_previous_frame(app->dx12);
+
+	loading.texture_upload_heap.Reset();
+	free_gpu_memory(&(app->dx12->memory), &(loading.texture_upload_memory));
+
+	app->loading = NULL;
+
+	cout << "Startup: " << get_task_graph_timeline(&startup);
+
+#if defined(_DEBUG)
+	cout << get_gpu_allocator_report(&(app->dx12->memory));
+#endif
+}
+
+void create_root_signature_task(void* data) {
+	application* app;
+
+	app = (application*)data;
+	app->root_signature = initialize_root_signature(app);
+}
+
+void compile_vertex_shader_task(void* data) {
+	load_cube_shader((application*)data, 0);
+}
+
+void compile_pixel_shader_task(void* data) {
+	load_cube_shader((application*)data, 1);
+}
+
+void create_pipeline_state_task(void* data) {
+	application* app;
+
+	app = (application*)data;
+	app->pipeline_state = initialize_pipeline_state(app);
+	app->draw_pipelines[DRAW_PIPELINE_TEXTURED] = app->pipeline_state.Get();
+}
+
+void decode_texture_task(void* data) {
+	application* app;
+	texture_cache_entry* texture;
+	const UINT8* pixels;
+	HRESULT result;
+
+	app = (application*)data;
 
 	//
-	// Initialize the vertex buffer for the textured cube.
+	// WIC (which decodes the PNG) needs COM on whichever thread this
+	// ends up on. The main thread already has it, so this might just
+	// add to its count.
 	//
 
-	initialize_cube(app);
+	result = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+
+	texture = load_texture_asset(app, "friendo.png");
+	pixels = texture->pixels.data();
 
 	//
-	// Create the texture for our cube.
+	// Procedurally generate a texture.
 	//
 
-	create_texture(app);
+	//app->loading->texture_data = generate_texture_data();
+	//pixels = app->loading->texture_data.data();
 
 	//
-	// Initialize the depth buffer.
+	// Find the texture a place on the atlas page, and copy it there.
+	// The rest of the page is left clear for whatever comes later.
 	//
 
-	initialize_depth_buffer(app);
+	if (!allocate_atlas_rect(&(app->atlas), TEXTURE_W, TEXTURE_H, &(app->cube_image))) {
+		throw_if_failed(E_OUTOFMEMORY);
+	}
+
+	app->loading->atlas_data.assign(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * TEXTURE_PIXEL_SIZE, 0);
+
+	copy_atlas_image(
+		&(app->atlas.settings),
+		&(app->cube_image),
+		pixels,
+		TEXTURE_W * TEXTURE_PIXEL_SIZE,
+		TEXTURE_PIXEL_SIZE,
+		app->loading->atlas_data.data(),
+		ATLAS_PAGE_SIZE * TEXTURE_PIXEL_SIZE
+	);
+
+	// It's on the atlas page now. The cache keeps it, in case it's
+	// wanted again, until it needs the room.
+	release_texture(&(app->textures), texture);
+
+	if (SUCCEEDED(result)) {
+		CoUninitialize();
+	}
+}
+
+void create_constant_buffer_task(void* data) {
+	initialize_constant_buffer((application*)data);
+}
+
+void create_cube_task(void* data) {
+	initialize_cube((application*)data);
+}
+
+void upload_texture_task(void* data) {
+	create_texture((application*)data);
+}
+
+void create_materials_task(void* data) {
+	initialize_materials((application*)data);
+}
+
+void compile_sprite_vertex_shader_task(void* data) {
+	load_sprite_shader((application*)data, 0);
+}
+
+void compile_sprite_pixel_shader_task(void* data) {
+	load_sprite_shader((application*)data, 1);
+}
+
+void create_sprite_pipelines_task(void* data) {
+	initialize_sprite_pipelines((application*)data);
+}
+
+void create_sprite_buffers_task(void* data) {
+	initialize_sprite_buffers((application*)data);
+}
+
+void compile_cull_shader_task(void* data) {
+	load_cull_shader((application*)data);
+}
+
+void create_cull_pipeline_task(void* data) {
+	initialize_cull_pipeline((application*)data);
+}
+
+void create_indirect_buffers_task(void* data) {
+	initialize_indirect_buffers((application*)data);
+}
+
+void create_frame_graph_task(void* data) {
+	initialize_frame_graph((application*)data);
+}
+
+void create_depth_view_task(void* data) {
+	initialize_depth_buffer((application*)data);
 }
 
 ComPtr<ID3D12RootSignature> initialize_root_signature(application* app) {
@@ -119,7 +441,7 @@ ComPtr<ID3D12RootSignature> initialize_root_signature(application* app) {
 	D3D12_FEATURE_DATA_ROOT_SIGNATURE feature_data;
 	HRESULT result;
 	CD3DX12_DESCRIPTOR_RANGE1 ranges[1];
-	CD3DX12_ROOT_PARAMETER1 root_parameters[2];
+	CD3DX12_ROOT_PARAMETER1 root_parameters[4];
 	D3D12_STATIC_SAMPLER_DESC sampler;
 	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC root_sig_desc;
 	ComPtr<ID3DBlob> sig_blob;
@@ -150,15 +472,17 @@ ComPtr<ID3D12RootSignature> initialize_root_signature(application* app) {
 	//
 
 	// First we set up our ranges. In this case, we only
-	// have one to deal with - SRVs. We only have one texture
-	// we sample from, starting from the 0th register.
+	// have one to deal with - SRVs. Every texture in the SRV heap is
+	// in it, as one unbounded array in register space 1, and materials
+	// say which of them to sample. Textures come and go while the table
+	// is bound, so the descriptors are volatile.
 	ranges[0] = {};
 	ranges[0].Init(
 		D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
-		1,
+		UINT_MAX,
 		0,
-		0,
-		D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC
+		1,
+		D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE
 	);
 
 	root_parameters[0] = {};
@@ -168,14 +492,40 @@ ComPtr<ID3D12RootSignature> initialize_root_signature(application* app) {
 		D3D12_SHADER_VISIBILITY_PIXEL
 	);
 
+	// Each draw's MVP matrix comes from its own slice of the constant
+	// buffer, bound straight to the root signature (a root CBV), so
+	// there's no descriptor to write per draw. The slice is written
+	// before the command list is recorded and never changes after, so
+	// the driver can treat it as static while it's set.
 	root_parameters[1] = {};
-	root_parameters[1].InitAsConstants(
-		sizeof(XMMATRIX) / 4,
+	root_parameters[1].InitAsConstantBufferView(
 		0,
 		0,
+		D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE,
 		D3D12_SHADER_VISIBILITY_VERTEX
 	);
 
+	// The material records, as a structured buffer bound straight to
+	// the root signature. They're only written before the command list
+	// is recorded.
+	root_parameters[2] = {};
+	root_parameters[2].InitAsShaderResourceView(
+		0,
+		0,
+		D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE,
+		D3D12_SHADER_VISIBILITY_PIXEL
+	);
+
+	// Which material record a draw uses. One root constant is all it
+	// takes to switch materials.
+	root_parameters[3] = {};
+	root_parameters[3].InitAsConstants(
+		1,
+		1,
+		0,
+		D3D12_SHADER_VISIBILITY_PIXEL
+	);
+
 	// Here we set up what kind of texture filter we want.
 	// At some point I'd like to go back and learn what exactly
 	// all these parameters are doing.
@@ -257,23 +607,24 @@ ComPtr<ID3D12RootSignature> initialize_root_signature(application* app) {
 	return root_signature;
 }
 
-ComPtr<ID3D12PipelineState> initialize_pipeline_state(application* app) {
-	ComPtr<ID3D12Device> dev;
-	ComPtr<ID3D12PipelineState> pipeline_state;
-	ComPtr<ID3DBlob> vertex_blob;
-	ComPtr<ID3DBlob> pixel_blob;
-	ComPtr<ID3DBlob> err_blob;
-	char* error;
+void load_shader_stage(
+	application* app,
+	const char* source_path,
+	const uint32_t index,
+	const vector<shader_define>& defines,
+	shader_bytecode* bytecode
+) {
+	const char* const entry_points[] = { "vs_main", "ps_main", "cs_main" };
+	const char* const targets[] = { "vs_5_1", "ps_5_1", "cs_5_1" };
+	shader_compile_request request;
+	string errors;
 	UINT compile_flags;
-	HRESULT result;
-	D3D12_INPUT_ELEMENT_DESC input_element_desc[2];
-	D3D12_GRAPHICS_PIPELINE_STATE_DESC pso_desc;
-
-	dev = app->dx12->device;
+	bool success;
 
 	//
-	// Load the shader (which is a single file with both the vertex and pixel
-	// shaders), and compile it.
+	// The shaders in a file are named after their stage. They come out
+	// of the shader cache, and only get compiled if the cache doesn't
+	// have them.
 	//
 
 	// If we're in debug mode, we want to add these flags.
@@ -282,49 +633,82 @@ ComPtr<ID3D12PipelineState> initialize_pipeline_state(application* app) {
 	compile_flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
 
-	// Compile the vertex shader.
-	result = D3DCompileFromFile(
-		L"./texture_shader.hlsl",
-		NULL,
-		NULL,
-		"vs_main",
-		"vs_5_1",
-		compile_flags,
-		0,
-		&vertex_blob,
-		&err_blob
-	);
+	request.source_path = source_path;
+	request.entry_point = entry_points[index];
+	request.target = targets[index];
+	request.defines = defines;
+	request.flags = compile_flags;
 
-	if (FAILED(result)) {
-		if (err_blob) {
-			error = (char*)err_blob->GetBufferPointer();
-			cerr << error << endl;
-		}
+	success = load_shader(&(app->shaders), request, bytecode, &errors);
+
+	if (!success) {
+		cerr << errors << endl;
+		throw_if_failed(E_FAIL);
 	}
+}
 
-	throw_if_failed(result);
+void load_cube_shader(application* app, const uint32_t index) {
+	load_shader_stage(
+		app,
+		"./texture_shader.hlsl",
+		index,
+		app->loading->shader_defines,
+		&(app->loading->shader_bytecodes[index])
+	);
+}
 
-	// Compile the pixel shader.
-	result = D3DCompileFromFile(
-		L"./texture_shader.hlsl",
-		NULL,
-		NULL,
-		"ps_main",
-		"ps_5_1",
-		compile_flags,
-		0,
-		&pixel_blob,
-		NULL
+void load_sprite_shader(application* app, const uint32_t index) {
+	load_shader_stage(
+		app,
+		"./sprite_shader.hlsl",
+		index,
+		vector<shader_define>(),
+		&(app->loading->sprite_bytecodes[index])
 	);
+}
 
-	if (FAILED(result)) {
-		if (err_blob) {
-			error = (char*)err_blob->GetBufferPointer();
-			cerr << error << endl;
-		}
-	}
+void load_cull_shader(application* app) {
+	load_shader_stage(
+		app,
+		"./cull_shader.hlsl",
+		2,
+		vector<shader_define>(),
+		&(app->loading->cull_bytecode)
+	);
+}
 
-	throw_if_failed(result);
+ComPtr<ID3D12PipelineState> initialize_pipeline_state(application* app) {
+	ComPtr<ID3D12Device> dev;
+	ComPtr<ID3D12PipelineState> pipeline_state;
+	asset_loading* loading;
+	D3D12_SHADER_BYTECODE vertex_shader;
+	D3D12_SHADER_BYTECODE pixel_shader;
+	HRESULT result;
+	D3D12_INPUT_ELEMENT_DESC input_element_desc[2];
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pso_desc;
+
+	dev = app->dx12->device;
+	loading = app->loading;
+
+	//
+	// The shaders either came out of the offline shader archive (see
+	// load_assets), or were just loaded by load_cube_shader.
+	//
+
+	if (loading->shaders_from_archive) {
+		vertex_shader = loading->vertex_shader;
+		pixel_shader = loading->pixel_shader;
+	} else {
+		vertex_shader = CD3DX12_SHADER_BYTECODE(
+			get_shader_bytecode_data(&(loading->shader_bytecodes[0])),
+			get_shader_bytecode_size(&(loading->shader_bytecodes[0]))
+		);
+
+		pixel_shader = CD3DX12_SHADER_BYTECODE(
+			get_shader_bytecode_data(&(loading->shader_bytecodes[1])),
+			get_shader_bytecode_size(&(loading->shader_bytecodes[1]))
+		);
+	}
 
 	//
 	// Define the vertex input layout. So what I think is happening
@@ -360,8 +744,8 @@ ComPtr<ID3D12PipelineState> initialize_pipeline_state(application* app) {
 	pso_desc = {};
 	pso_desc.InputLayout = { input_element_desc, _countof(input_element_desc) };
 	pso_desc.pRootSignature = app->root_signature.Get();
-	pso_desc.VS = CD3DX12_SHADER_BYTECODE(vertex_blob.Get());
-	pso_desc.PS = CD3DX12_SHADER_BYTECODE(pixel_blob.Get());
+	pso_desc.VS = vertex_shader;
+	pso_desc.PS = pixel_shader;
 	pso_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 	pso_desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	pso_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
@@ -383,83 +767,577 @@ ComPtr<ID3D12PipelineState> initialize_pipeline_state(application* app) {
 
 	throw_if_failed(result);
 
+	// The PSO keeps its own copy of the bytecode, so we can let go
+	// of ours (and unmap the cache files). These are empty if the
+	// shaders came from the archive, which is fine.
+	release_shader_bytecode(&(loading->shader_bytecodes[0]));
+	release_shader_bytecode(&(loading->shader_bytecodes[1]));
+
 	return pipeline_state;
 }
 
-void initialize_cube(application* app) {
-	vertex cube_verts[24];
-	WORD cube_indices[36];
-	UINT vertex_buffer_size;
-	UINT index_buffer_size;
-	ComPtr<ID3D12Resource> vertex_buffer;
-	ComPtr<ID3D12Resource> index_buffer;
+void initialize_sprite_pipelines(application* app) {
 	ComPtr<ID3D12Device> dev;
-	D3D12_VERTEX_BUFFER_VIEW vbv;
-	D3D12_INDEX_BUFFER_VIEW ibv;
+	asset_loading* loading;
+	D3D12_SHADER_BYTECODE vertex_shader;
+	D3D12_SHADER_BYTECODE pixel_shader;
+	D3D12_INPUT_ELEMENT_DESC input_element_desc[4];
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pso_desc;
+	D3D12_RENDER_TARGET_BLEND_DESC* blend;
+	HRESULT result;
+	uint32_t i;
 
 	dev = app->dx12->device;
+	loading = app->loading;
+
+	if (loading->sprite_shaders_from_archive) {
+		vertex_shader = loading->sprite_vertex_shader;
+		pixel_shader = loading->sprite_pixel_shader;
+	} else {
+		vertex_shader = CD3DX12_SHADER_BYTECODE(
+			get_shader_bytecode_data(&(loading->sprite_bytecodes[0])),
+			get_shader_bytecode_size(&(loading->sprite_bytecodes[0]))
+		);
+
+		pixel_shader = CD3DX12_SHADER_BYTECODE(
+			get_shader_bytecode_data(&(loading->sprite_bytecodes[1])),
+			get_shader_bytecode_size(&(loading->sprite_bytecodes[1]))
+		);
+	}
 
 	//
-	// Define the input data we will send to the shader.
-	// For reference on these vertices, please see Cube-Vertices.png.
-	// 
-	// You'd think there'd be 8 verticies in total. Normally, you'd
-	// be right, if the cube is not textured. But if it is textured,
-	// we need to account for the fact that multiple verticies need
-	// different texture coordinates.
-	// 
-	// To solve this, we define 4 vertices per face. Since there are
-	// 6 faces, we will need 24 vertices for the cube.
+	// This must match sprite_vertex. The color is four bytes, which
+	// the input assembler turns into a float4 from 0 to 1.
 	//
 
-	// Front-face
-	cube_verts[ 0] = { { -1.0f, -1.0f, -1.0f }, { 0.0f, 1.0f } }; 
-	cube_verts[ 1] = { { -1.0f,  1.0f, -1.0f }, { 0.0f, 0.0f } }; 
-	cube_verts[ 2] = { {  1.0f,  1.0f, -1.0f }, { 1.0f, 0.0f } }; 
-	cube_verts[ 3] = { {  1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f } };
-	// Back-face
-	cube_verts[ 4] = { { -1.0f, -1.0f,  1.0f }, { 1.0f, 1.0f } };
-	cube_verts[ 5] = { { -1.0f,  1.0f,  1.0f }, { 1.0f, 0.0f } };
-	cube_verts[ 6] = { {  1.0f,  1.0f,  1.0f }, { 0.0f, 0.0f } };
-	cube_verts[ 7] = { {  1.0f, -1.0f,  1.0f }, { 0.0f, 1.0f } };
-	// Left-face
-	cube_verts[ 8] = { { -1.0f, -1.0f,  1.0f }, { 0.0f, 1.0f } };
-	cube_verts[ 9] = { { -1.0f,  1.0f,  1.0f }, { 0.0f, 0.0f } };
-	cube_verts[10] = { { -1.0f,  1.0f, -1.0f }, { 1.0f, 0.0f } };
-	cube_verts[11] = { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f } };
-	// Right-face
-	cube_verts[12] = { {  1.0f, -1.0f, -1.0f }, { 0.0f, 1.0f } };
-	cube_verts[13] = { {  1.0f,  1.0f, -1.0f }, { 0.0f, 0.0f } };
-	cube_verts[14] = { {  1.0f,  1.0f,  1.0f }, { 1.0f, 0.0f } };
-	cube_verts[15] = { {  1.0f, -1.0f,  1.0f }, { 1.0f, 1.0f } };
-	// Top-face
-	cube_verts[16] = { { -1.0f,  1.0f, -1.0f }, { 0.0f, 1.0f } };
-	cube_verts[17] = { { -1.0f,  1.0f,  1.0f }, { 0.0f, 0.0f } };
-	cube_verts[18] = { {  1.0f,  1.0f,  1.0f }, { 1.0f, 0.0f } };
-	cube_verts[19] = { {  1.0f,  1.0f, -1.0f }, { 1.0f, 1.0f } };
-	// Bottom-face
-	cube_verts[20] = { { -1.0f, -1.0f,  1.0f }, { 0.0f, 1.0f } };
-	cube_verts[21] = { { -1.0f, -1.0f, -1.0f }, { 0.0f, 0.0f } };
-	cube_verts[22] = { {  1.0f, -1.0f, -1.0f }, { 1.0f, 0.0f } };
-	cube_verts[23] = { {  1.0f, -1.0f,  1.0f }, { 1.0f, 1.0f } };
+	input_element_desc[0] = {
+		"POSITION",
+		0,
+		DXGI_FORMAT_R32G32_FLOAT,
+		0,
+		0,
+		D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+		0
+	};
 
-	// Front-face
-	cube_indices[ 0] = 0;
-	cube_indices[ 1] = 1;
-	cube_indices[ 2] = 2;
-	cube_indices[ 3] = 0;
-	cube_indices[ 4] = 2;
-	cube_indices[ 5] = 3;
-	// Back-face
-	cube_indices[ 6] = 4;
-	cube_indices[ 7] = 6;
-	cube_indices[ 8] = 5;
-	cube_indices[ 9] = 4;
-	cube_indices[10] = 7;
-	cube_indices[11] = 6;
-	// Left-face
-	cube_indices[12] = 8;
-	cube_indices[13] = 9;
+	input_element_desc[1] = {
+		"TEXCOORD",
+		0,
+		DXGI_FORMAT_R32G32_FLOAT,
+		0,
+		8,
+		D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+		0
+	};
+
+	input_element_desc[2] = {
+		"COLOR",
+		0,
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		0,
+		16,
+		D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+		0
+	};
+
+	input_element_desc[3] = {
+		"TEXTURE",
+		0,
+		DXGI_FORMAT_R32_UINT,
+		0,
+		20,
+		D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+		0
+	};
+
+	//
+	// Sprites go over everything, so there's no depth test, and they
+	// can be mirrored with a negative size, so there's no culling
+	// either. Only the blending differs between the pipelines.
+	//
+
+	pso_desc = {};
+	pso_desc.InputLayout = { input_element_desc, _countof(input_element_desc) };
+	pso_desc.pRootSignature = app->root_signature.Get();
+	pso_desc.VS = vertex_shader;
+	pso_desc.PS = pixel_shader;
+	pso_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	pso_desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	pso_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	pso_desc.DepthStencilState.DepthEnable = FALSE;
+	pso_desc.SampleMask = UINT_MAX;
+	pso_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	pso_desc.NumRenderTargets = 1;
+	pso_desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+	pso_desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+	pso_desc.SampleDesc.Count = 1;
+
+	for (i = 0; i < SPRITE_BLEND_COUNT; i++) {
+		pso_desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+		blend = &(pso_desc.BlendState.RenderTarget[0]);
+
+		if (i == SPRITE_BLEND_ALPHA) {
+			blend->BlendEnable = TRUE;
+			blend->SrcBlend = D3D12_BLEND_SRC_ALPHA;
+			blend->DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+			blend->SrcBlendAlpha = D3D12_BLEND_ONE;
+			blend->DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+		} else if (i == SPRITE_BLEND_ADDITIVE) {
+			blend->BlendEnable = TRUE;
+			blend->SrcBlend = D3D12_BLEND_SRC_ALPHA;
+			blend->DestBlend = D3D12_BLEND_ONE;
+			blend->SrcBlendAlpha = D3D12_BLEND_ZERO;
+			blend->DestBlendAlpha = D3D12_BLEND_ONE;
+		}
+
+		result = dev->CreateGraphicsPipelineState(
+			&pso_desc,
+			IID_PPV_ARGS(&(app->sprite_pipelines[i]))
+		);
+
+		throw_if_failed(result);
+	}
+
+	release_shader_bytecode(&(loading->sprite_bytecodes[0]));
+	release_shader_bytecode(&(loading->sprite_bytecodes[1]));
+}
+
+void initialize_cull_pipeline(application* app) {
+	ComPtr<ID3D12Device> dev;
+	asset_loading* loading;
+	D3D12_FEATURE_DATA_ROOT_SIGNATURE feature_data;
+	CD3DX12_ROOT_PARAMETER1 root_parameters[4];
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC root_sig_desc;
+	ComPtr<ID3DBlob> sig_blob;
+	ComPtr<ID3DBlob> err_blob;
+	D3D12_COMPUTE_PIPELINE_STATE_DESC pso_desc;
+	D3D12_INDIRECT_ARGUMENT_DESC arguments[3];
+	D3D12_COMMAND_SIGNATURE_DESC signature_desc;
+	HRESULT result;
+
+	dev = app->dx12->device;
+	loading = app->loading;
+
+	feature_data = {};
+	feature_data.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+
+	result = dev->CheckFeatureSupport(
+		D3D12_FEATURE_ROOT_SIGNATURE,
+		&feature_data,
+		sizeof(feature_data)
+	);
+
+	if (FAILED(result)) {
+		feature_data.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+	}
+
+	//
+	// The culling shader's root signature. Its constants (the frustum
+	// and so on) are small enough to be root constants, and everything
+	// else is a buffer bound straight to the root, so there are no
+	// descriptors at all.
+	//
+
+	root_parameters[0] = {};
+	root_parameters[0].InitAsConstants(sizeof(culling_constants) / 4, 0);
+
+	// The objects.
+	root_parameters[1] = {};
+	root_parameters[1].InitAsShaderResourceView(
+		0,
+		0,
+		D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE
+	);
+
+	// The commands, and the count of them.
+	root_parameters[2] = {};
+	root_parameters[2].InitAsUnorderedAccessView(0);
+	root_parameters[3] = {};
+	root_parameters[3].InitAsUnorderedAccessView(1);
+
+	root_sig_desc.Init_1_1(
+		_countof(root_parameters),
+		root_parameters,
+		0,
+		NULL,
+		D3D12_ROOT_SIGNATURE_FLAG_NONE
+	);
+
+	result = D3DX12SerializeVersionedRootSignature(
+		&root_sig_desc,
+		feature_data.HighestVersion,
+		&sig_blob,
+		&err_blob
+	);
+
+	throw_if_failed(result);
+
+	result = dev->CreateRootSignature(
+		0,
+		sig_blob->GetBufferPointer(),
+		sig_blob->GetBufferSize(),
+		IID_PPV_ARGS(&(app->cull_root_signature))
+	);
+
+	throw_if_failed(result);
+
+	//
+	// The pipeline state. Compute ones only need the shader.
+	//
+
+	pso_desc = {};
+	pso_desc.pRootSignature = app->cull_root_signature.Get();
+
+	if (loading->cull_shader_from_archive) {
+		pso_desc.CS = loading->cull_shader;
+	} else {
+		pso_desc.CS = CD3DX12_SHADER_BYTECODE(
+			get_shader_bytecode_data(&(loading->cull_bytecode)),
+			get_shader_bytecode_size(&(loading->cull_bytecode))
+		);
+	}
+
+	result = dev->CreateComputePipelineState(
+		&pso_desc,
+		IID_PPV_ARGS(&(app->cull_pipeline))
+	);
+
+	throw_if_failed(result);
+
+	release_shader_bytecode(&(loading->cull_bytecode));
+
+	//
+	// The command signature says what each of the culling shader's
+	// commands does: set the draw's constant buffer (root parameter 1)
+	// and material (root parameter 3), then draw. It has to be laid
+	// out just like indirect_command.
+	//
+
+	arguments[0] = {};
+	arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW;
+	arguments[0].ConstantBufferView.RootParameterIndex = 1;
+
+	arguments[1] = {};
+	arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+	arguments[1].Constant.RootParameterIndex = 3;
+	arguments[1].Constant.DestOffsetIn32BitValues = 0;
+	arguments[1].Constant.Num32BitValuesToSet = 1;
+
+	arguments[2] = {};
+	arguments[2].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+	signature_desc = {};
+	signature_desc.ByteStride = sizeof(indirect_command);
+	signature_desc.NumArgumentDescs = _countof(arguments);
+	signature_desc.pArgumentDescs = arguments;
+	signature_desc.NodeMask = 0;
+
+	result = dev->CreateCommandSignature(
+		&signature_desc,
+		app->root_signature.Get(),
+		IID_PPV_ARGS(&(app->draw_signature))
+	);
+
+	throw_if_failed(result);
+}
+
+bool can_use_shader_archive(application* app) {
+	D3D12_FEATURE_DATA_SHADER_MODEL shader_model;
+	HRESULT result;
+
+	//
+	// The archive holds Shader Model 6 shaders, so the device has to
+	// support at least 6.0 for us to use them.
+	//
+
+	shader_model = {};
+	shader_model.HighestShaderModel = D3D_SHADER_MODEL_6_0;
+
+	result = app->dx12->device->CheckFeatureSupport(
+		D3D12_FEATURE_SHADER_MODEL,
+		&shader_model,
+		sizeof(shader_model)
+	);
+
+	return SUCCEEDED(result) && shader_model.HighestShaderModel >= D3D_SHADER_MODEL_6_0;
+}
+
+bool find_shaders_in_archive(
+	application* app,
+	const char* source_file,
+	const vector<shader_define>& defines,
+	D3D12_SHADER_BYTECODE* vertex_shader,
+	D3D12_SHADER_BYTECODE* pixel_shader
+) {
+	uint64_t vertex_key;
+	uint64_t pixel_key;
+	uint64_t source_hash;
+	shader_archive_view vertex_view;
+	shader_archive_view pixel_view;
+	bool found;
+
+	if (!can_use_shader_archive(app)) {
+		return false;
+	}
+
+	// These must match the entries in shader_permutations.txt.
+	vertex_key = get_shader_permutation_key(
+		source_file,
+		"vs_main",
+		"vs_6_0",
+		defines
+	);
+
+	pixel_key = get_shader_permutation_key(
+		source_file,
+		"ps_main",
+		"ps_6_0",
+		defines
+	);
+
+	found =
+		find_shader_in_archive(&(app->shader_pack), vertex_key, &vertex_view) &&
+		find_shader_in_archive(&(app->shader_pack), pixel_key, &pixel_view);
+
+	if (!found) {
+		return false;
+	}
+
+	//
+	// The key doesn't change when the source does, so check the source
+	// is still what was packed. If it isn't, shaders.pak is out of date
+	// and we compile instead. If the source isn't here to check, the
+	// archive is all we have.
+	//
+
+	if (hash_shader_source(source_file, &source_hash) &&
+		(vertex_view.source_hash != source_hash || pixel_view.source_hash != source_hash))
+	{
+		cout << "shaders.pak is older than " << source_file << ", compiling it instead" << endl;
+		return false;
+	}
+
+	*vertex_shader = CD3DX12_SHADER_BYTECODE(
+		vertex_view.bytecode,
+		vertex_view.bytecode_size
+	);
+
+	*pixel_shader = CD3DX12_SHADER_BYTECODE(
+		pixel_view.bytecode,
+		pixel_view.bytecode_size
+	);
+
+	return true;
+}
+
+bool find_compute_shader_in_archive(
+	application* app,
+	const char* source_file,
+	const vector<shader_define>& defines,
+	D3D12_SHADER_BYTECODE* compute_shader
+) {
+	uint64_t key;
+	uint64_t source_hash;
+	shader_archive_view view;
+
+	if (!can_use_shader_archive(app)) {
+		return false;
+	}
+
+	// This must match the entry in shader_permutations.txt.
+	key = get_shader_permutation_key(source_file, "cs_main", "cs_6_0", defines);
+
+	if (!find_shader_in_archive(&(app->shader_pack), key, &view)) {
+		return false;
+	}
+
+	// Same as for the other stages.
+	if (hash_shader_source(source_file, &source_hash) && view.source_hash != source_hash) {
+		cout << "shaders.pak is older than " << source_file << ", compiling it instead" << endl;
+		return false;
+	}
+
+	*compute_shader = CD3DX12_SHADER_BYTECODE(view.bytecode, view.bytecode_size);
+
+	return true;
+}
+
+bool compile_shader_from_file(
+	const shader_compile_request& request,
+	vector<uint8_t>* bytecode,
+	string* errors
+) {
+	wstring source_path;
+	vector<D3D_SHADER_MACRO> macros;
+	ComPtr<ID3DBlob> shader_blob;
+	ComPtr<ID3DBlob> err_blob;
+	const UINT8* shader_data;
+	HRESULT result;
+	size_t i;
+
+	source_path = fs::path(request.source_path).wstring();
+
+	// The D3D compiler wants the defines as a NULL terminated array.
+	for (i = 0; i < request.defines.size(); i++) {
+		macros.push_back({
+			request.defines[i].name.c_str(),
+			request.defines[i].value.c_str()
+		});
+	}
+
+	macros.push_back({ NULL, NULL });
+
+	// The standard include handler resolves #includes relative to the
+	// source file, which is also what the shader cache assumes when it
+	// hashes them.
+	result = D3DCompileFromFile(
+		source_path.c_str(),
+		macros.data(),
+		D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		request.entry_point.c_str(),
+		request.target.c_str(),
+		request.flags,
+		0,
+		&shader_blob,
+		&err_blob
+	);
+
+	if (FAILED(result)) {
+		if (err_blob && errors) {
+			*errors = string(
+				(const char*)err_blob->GetBufferPointer(),
+				err_blob->GetBufferSize()
+			);
+		}
+
+		return false;
+	}
+
+	shader_data = (const UINT8*)shader_blob->GetBufferPointer();
+	bytecode->assign(shader_data, shader_data + shader_blob->GetBufferSize());
+
+	return true;
+}
+
+void initialize_constant_buffer(application* app) {
+	ComPtr<ID3D12Resource> constant_buffer;
+	CD3DX12_RESOURCE_DESC buffer_desc;
+	UINT64 frame_size;
+	UINT64 buffer_size;
+	UINT8* mapped;
+	CD3DX12_RANGE read_range(0, 0);
+	HRESULT result;
+
+	frame_size = (UINT64)MAX_DRAWS_PER_FRAME * CONSTANT_BUFFER_ALIGNMENT;
+	buffer_size = get_constant_buffer_size(frame_size, NUM_RENDER_TARGETS);
+	buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(buffer_size);
+
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_UPLOAD,
+		buffer_desc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		NULL,
+		&constant_buffer,
+		&(app->constant_buffer_memory)
+	);
+
+	//
+	// Upload heaps can stay mapped for as long as we like, so map it
+	// once here and unmap it at shutdown. We never read from it, hence
+	// the empty read range.
+	//
+
+	mapped = NULL;
+	result = constant_buffer->Map(0, &read_range, (void**)(&mapped));
+	throw_if_failed(result);
+
+	initialize_constant_allocator(
+		&(app->constants),
+		mapped,
+		constant_buffer->GetGPUVirtualAddress(),
+		frame_size,
+		NUM_RENDER_TARGETS
+	);
+
+	app->constant_buffer = constant_buffer;
+}
+
+void initialize_cube(application* app) {
+	vertex cube_verts[24];
+	uint32_t cube_indices[36];
+	mesh_source cube_mesh;
+	lod_chain_options lod_options;
+	vector<WORD> lod_indices;
+	float center[3];
+	UINT vertex_buffer_size;
+	UINT index_buffer_size;
+	ComPtr<ID3D12Resource> vertex_buffer;
+	ComPtr<ID3D12Resource> index_buffer;
+	D3D12_VERTEX_BUFFER_VIEW vbv;
+	D3D12_INDEX_BUFFER_VIEW ibv;
+
+	//
+	// Define the input data we will send to the shader.
+	// For reference on these vertices, please see Cube-Vertices.png.
+	// 
+	// You'd think there'd be 8 verticies in total. Normally, you'd
+	// be right, if the cube is not textured. But if it is textured,
+	// we need to account for the fact that multiple verticies need
+	// different texture coordinates.
+	// 
+	// To solve this, we define 4 vertices per face. Since there are
+	// 6 faces, we will need 24 vertices for the cube.
+	//
+
+	// Front-face
+	cube_verts[ 0] = { { -1.0f, -1.0f, -1.0f }, { 0.0f, 1.0f } }; 
+	cube_verts[ 1] = { { -1.0f,  1.0f, -1.0f }, { 0.0f, 0.0f } }; 
+	cube_verts[ 2] = { {  1.0f,  1.0f, -1.0f }, { 1.0f, 0.0f } }; 
+	cube_verts[ 3] = { {  1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f } };
+	// Back-face
+	cube_verts[ 4] = { { -1.0f, -1.0f,  1.0f }, { 1.0f, 1.0f } };
+	cube_verts[ 5] = { { -1.0f,  1.0f,  1.0f }, { 1.0f, 0.0f } };
+	cube_verts[ 6] = { {  1.0f,  1.0f,  1.0f }, { 0.0f, 0.0f } };
+	cube_verts[ 7] = { {  1.0f, -1.0f,  1.0f }, { 0.0f, 1.0f } };
+	// Left-face
+	cube_verts[ 8] = { { -1.0f, -1.0f,  1.0f }, { 0.0f, 1.0f } };
+	cube_verts[ 9] = { { -1.0f,  1.0f,  1.0f }, { 0.0f, 0.0f } };
+	cube_verts[10] = { { -1.0f,  1.0f, -1.0f }, { 1.0f, 0.0f } };
+	cube_verts[11] = { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f } };
+	// Right-face
+	cube_verts[12] = { {  1.0f, -1.0f, -1.0f }, { 0.0f, 1.0f } };
+	cube_verts[13] = { {  1.0f,  1.0f, -1.0f }, { 0.0f, 0.0f } };
+	cube_verts[14] = { {  1.0f,  1.0f,  1.0f }, { 1.0f, 0.0f } };
+	cube_verts[15] = { {  1.0f, -1.0f,  1.0f }, { 1.0f, 1.0f } };
+	// Top-face
+	cube_verts[16] = { { -1.0f,  1.0f, -1.0f }, { 0.0f, 1.0f } };
+	cube_verts[17] = { { -1.0f,  1.0f,  1.0f }, { 0.0f, 0.0f } };
+	cube_verts[18] = { {  1.0f,  1.0f,  1.0f }, { 1.0f, 0.0f } };
+	cube_verts[19] = { {  1.0f,  1.0f, -1.0f }, { 1.0f, 1.0f } };
+	// Bottom-face
+	cube_verts[20] = { { -1.0f, -1.0f,  1.0f }, { 0.0f, 1.0f } };
+	cube_verts[21] = { { -1.0f, -1.0f, -1.0f }, { 0.0f, 0.0f } };
+	cube_verts[22] = { {  1.0f, -1.0f, -1.0f }, { 1.0f, 0.0f } };
+	cube_verts[23] = { {  1.0f, -1.0f,  1.0f }, { 1.0f, 1.0f } };
+
+	// Front-face
+	cube_indices[ 0] = 0;
+	cube_indices[ 1] = 1;
+	cube_indices[ 2] = 2;
+	cube_indices[ 3] = 0;
+	cube_indices[ 4] = 2;
+	cube_indices[ 5] = 3;
+	// Back-face
+	cube_indices[ 6] = 4;
+	cube_indices[ 7] = 6;
+	cube_indices[ 8] = 5;
+	cube_indices[ 9] = 4;
+	cube_indices[10] = 7;
+	cube_indices[11] = 6;
+	// Left-face
+	cube_indices[12] = 8;
+	cube_indices[13] = 9;
 	cube_indices[14] = 10;
 	cube_indices[15] = 8;
 	cube_indices[16] = 10;
@@ -486,67 +1364,289 @@ void initialize_cube(application* app) {
 	cube_indices[34] = 22;
 	cube_indices[35] = 23;
 
-	vertex_buffer_size = sizeof(cube_verts);
-	index_buffer_size = sizeof(cube_indices);
+	//
+	// Build the cube's levels of detail. Every vertex of the cube is on
+	// a UV seam, so none of them can move and the chain is just the cube
+	// itself, but a real mesh would go through here the same way. All
+	// the levels share the vertex buffer, and their indices go one after
+	// another in the index buffer.
+	//
+
+	cube_mesh.vertices = (const mesh_vertex*)cube_verts;
+	cube_mesh.vertex_count = 24;
+	cube_mesh.indices = cube_indices;
+	cube_mesh.index_count = 36;
+
+	build_lod_chain(&cube_mesh, &lod_options, &(app->cube_lods));
+
+#if defined(_DEBUG)
+	cout << get_lod_chain_report(&(app->cube_lods), 1);
+#endif
+
+	// update moves it to wherever the simulation has the cube.
+	center[0] = 0.0f;
+	center[1] = 0.0f;
+	center[2] = 0.0f;
+
+	app->cube_instances.chain = &(app->cube_lods);
+	add_lod_instance(&(app->cube_instances), center, CUBE_RADIUS);
+
+	// The index buffer is 16 bit.
+	lod_indices.assign(app->cube_lods.indices.begin(), app->cube_lods.indices.end());
+
+	vertex_buffer_size = sizeof(cube_verts);
+	index_buffer_size = (UINT)(lod_indices.size() * sizeof(WORD));
+
+	upload_buffer_data(
+		&(app->dx12->memory),
+		cube_verts,
+		vertex_buffer_size,
+		&vertex_buffer,
+		&(app->vertex_buffer_memory)
+	);
+
+	app->vertex_buffer = vertex_buffer;
+
+	//
+	// Finally, initialize the vertex buffer view.
+	//
+
+	vbv = {};
+	vbv.BufferLocation = vertex_buffer->GetGPUVirtualAddress();
+	vbv.StrideInBytes = sizeof(vertex);
+	vbv.SizeInBytes = vertex_buffer_size;
+
+	app->vertex_buffer_view = vbv;
+
+	//
+	// Now we will repeat the process for the index buffer.
+	//
+
+	upload_buffer_data(
+		&(app->dx12->memory),
+		lod_indices.data(),
+		index_buffer_size,
+		&index_buffer,
+		&(app->index_buffer_memory)
+	);
+
+	app->index_buffer = index_buffer;
+
+	//
+	// Finally, initialize the index buffer view.
+	//
+
+	ibv = {};
+	ibv.BufferLocation = index_buffer->GetGPUVirtualAddress();
+	ibv.SizeInBytes = index_buffer_size;
+	ibv.Format = DXGI_FORMAT_R16_UINT;
+
+	app->index_buffer_view = ibv;
+}
+
+void initialize_sprite_buffers(application* app) {
+	ComPtr<ID3D12Resource> sprite_vertices;
+	ComPtr<ID3D12Resource> sprite_indices;
+	CD3DX12_RESOURCE_DESC buffer_desc;
+	vector<uint16_t> indices;
+	D3D12_INDEX_BUFFER_VIEW ibv;
+	CD3DX12_RANGE read_range(0, 0);
+	UINT8* mapped;
+	const gpu_material* material;
+	HRESULT result;
+
+	//
+	// The vertex buffer is rewritten every frame, so it's an upload
+	// heap that stays mapped, like the constant buffer.
+	//
+
+	buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(
+		get_sprite_vertex_buffer_size(MAX_SPRITES_PER_FRAME, NUM_RENDER_TARGETS)
+	);
+
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_UPLOAD,
+		buffer_desc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		NULL,
+		&sprite_vertices,
+		&(app->sprite_vertex_memory)
+	);
+
+	mapped = NULL;
+	result = sprite_vertices->Map(0, &read_range, (void**)(&mapped));
+	throw_if_failed(result);
+
+	initialize_sprite_batcher(&(app->sprites), MAX_SPRITES_PER_FRAME, NUM_RENDER_TARGETS, mapped);
+	set_sprite_viewport(&(app->sprites), (float)app->screen_w, (float)app->screen_h);
+
+	app->sprite_vertices = sprite_vertices;
+
+	//
+	// The indices never change.
+	//
+
+	indices.resize(SPRITE_INDEX_COUNT);
+	write_sprite_indices(indices.data());
 
 	upload_buffer_data(
-		dev,
-		cube_verts,
-		vertex_buffer_size,
-		&vertex_buffer
+		&(app->dx12->memory),
+		indices.data(),
+		SPRITE_INDEX_COUNT * sizeof(uint16_t),
+		&sprite_indices,
+		&(app->sprite_index_memory)
 	);
 
-	app->vertex_buffer = vertex_buffer;
+	ibv = {};
+	ibv.BufferLocation = sprite_indices->GetGPUVirtualAddress();
+	ibv.SizeInBytes = SPRITE_INDEX_COUNT * sizeof(uint16_t);
+	ibv.Format = DXGI_FORMAT_R16_UINT;
+
+	app->sprite_indices = sprite_indices;
+	app->sprite_index_view = ibv;
 
 	//
-	// Finally, initialize the vertex buffer view.
+	// A small copy of the cube's texture in the top left corner.
 	//
 
-	vbv = {};
-	vbv.BufferLocation = vertex_buffer->GetGPUVirtualAddress();
-	vbv.StrideInBytes = sizeof(vertex);
-	vbv.SizeInBytes = vertex_buffer_size;
+	material = &(app->materials.materials[app->cube_material]);
 
-	app->vertex_buffer_view = vbv;
+	app->overlay_sprite = {};
+	app->overlay_sprite.position[0] = 80.0f;
+	app->overlay_sprite.position[1] = 80.0f;
+	app->overlay_sprite.size[0] = 128.0f;
+	app->overlay_sprite.size[1] = 128.0f;
+	app->overlay_sprite.color = 0xc0ffffff;
+	app->overlay_sprite.uv_scale[0] = material->uv_scale[0];
+	app->overlay_sprite.uv_scale[1] = material->uv_scale[1];
+	app->overlay_sprite.uv_offset[0] = material->uv_offset[0];
+	app->overlay_sprite.uv_offset[1] = material->uv_offset[1];
+	app->overlay_sprite.texture = material->albedo_texture;
+	app->overlay_sprite.blend = SPRITE_BLEND_ALPHA;
+}
+
+void initialize_indirect_buffers(application* app) {
+	ComPtr<ID3D12Resource> object_buffer;
+	ComPtr<ID3D12Resource> indirect_commands;
+	ComPtr<ID3D12Resource> indirect_count;
+	ComPtr<ID3D12Resource> indirect_upload;
+	CD3DX12_RESOURCE_DESC buffer_desc;
+	CD3DX12_RANGE read_range(0, 0);
+	UINT8* mapped;
+	HRESULT result;
+
+	if (!INDIRECT_DRAWS) {
+		return;
+	}
 
 	//
-	// Now we will repeat the process for the index buffer.
+	// The objects are rewritten every frame, so like the constant
+	// buffer they're in an upload heap that stays mapped, with a
+	// region for each back buffer.
 	//
 
-	upload_buffer_data(
-		dev,
-		cube_indices,
-		index_buffer_size,
-		&index_buffer
+	buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(
+		(UINT64)MAX_DRAWS_PER_FRAME * sizeof(gpu_object) * NUM_RENDER_TARGETS
 	);
 
-	app->index_buffer = index_buffer;
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_UPLOAD,
+		buffer_desc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		NULL,
+		&object_buffer,
+		&(app->object_buffer_memory)
+	);
+
+	mapped = NULL;
+	result = object_buffer->Map(0, &read_range, (void**)(&mapped));
+	throw_if_failed(result);
+
+	app->object_buffer = object_buffer;
+	app->mapped_objects = mapped;
 
 	//
-	// Finally, initialize the index buffer view.
+	// The commands and their count are only ever written by the
+	// culling shader, so they live on the GPU. Between frames they
+	// sit in the state ExecuteIndirect reads them in.
 	//
 
-	ibv = {};
-	ibv.BufferLocation = index_buffer->GetGPUVirtualAddress();
-	ibv.SizeInBytes = index_buffer_size;
-	ibv.Format = DXGI_FORMAT_R16_UINT;
+	buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(
+		(UINT64)MAX_DRAWS_PER_FRAME * sizeof(indirect_command),
+		D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+	);
 
-	app->index_buffer_view = ibv;
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_DEFAULT,
+		buffer_desc,
+		D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT,
+		NULL,
+		&indirect_commands,
+		&(app->indirect_commands_memory)
+	);
+
+	buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(
+		sizeof(uint32_t),
+		D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+	);
+
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_DEFAULT,
+		buffer_desc,
+		D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT,
+		NULL,
+		&indirect_count,
+		&(app->indirect_count_memory)
+	);
+
+	app->indirect_commands = indirect_commands;
+	app->indirect_count = indirect_count;
+
+	//
+	// The zero for the count, then, for CPU culling, each back buffer's
+	// commands and count.
+	//
+
+	buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(
+		INDIRECT_UPLOAD_HEADER_SIZE + INDIRECT_UPLOAD_FRAME_SIZE * NUM_RENDER_TARGETS
+	);
+
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_UPLOAD,
+		buffer_desc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		NULL,
+		&indirect_upload,
+		&(app->indirect_upload_memory)
+	);
+
+	mapped = NULL;
+	result = indirect_upload->Map(0, &read_range, (void**)(&mapped));
+	throw_if_failed(result);
+
+	memset(mapped, 0, INDIRECT_UPLOAD_HEADER_SIZE);
+
+	app->indirect_upload = indirect_upload;
+	app->mapped_indirect_upload = mapped;
 }
 
 void upload_buffer_data(
-	ComPtr<ID3D12Device> dev,
+	gpu_allocator* allocator,
 	void* buffer_data,
 	const UINT buffer_size,
-	ID3D12Resource** resource_buffer
+	ID3D12Resource** resource_buffer,
+	gpu_allocation* buffer_memory
 ) {
-	CD3DX12_HEAP_PROPERTIES heap_properties;
 	CD3DX12_RESOURCE_DESC buffer_resource_desc;
 	HRESULT result;
 	UINT8* buffer_data_begin;
 	CD3DX12_RANGE read_range(0, 0);
 
-	heap_properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
 	buffer_resource_desc = CD3DX12_RESOURCE_DESC::Buffer(buffer_size);
 
 	// Note: using upload heaps to transfer static data like vert
@@ -554,17 +1654,16 @@ void upload_buffer_data(
 	// upload heap will be marshalled over. Please read up on Default
 	// Heap Usage. An upload heap is used here for code simplicity,
 	// and because there are very few verts to actually transfer.
-	result = dev->CreateCommittedResource(
-		&heap_properties,
-		D3D12_HEAP_FLAG_NONE,
-		&buffer_resource_desc,
+	create_placed_resource(
+		allocator,
+		D3D12_HEAP_TYPE_UPLOAD,
+		buffer_resource_desc,
 		D3D12_RESOURCE_STATE_GENERIC_READ,
 		NULL,
-		IID_PPV_ARGS(resource_buffer)
+		resource_buffer,
+		buffer_memory
 	);
 
-	throw_if_failed(result);
-
 	//
 	// Copy the cube vertex data over to the vertex buffer.
 	//
@@ -581,23 +1680,19 @@ void create_texture(application* app) {
 	ComPtr<ID3D12Resource> texture;
 	ComPtr<ID3D12Device> dev;
 	ComPtr<ID3D12GraphicsCommandList> command_list;
-	ComPtr<ID3D12CommandQueue> command_queue;
 	ComPtr<ID3D12DescriptorHeap> srv_heap;
-	CD3DX12_HEAP_PROPERTIES default_heap;
-	HRESULT result;
 	UINT64 upload_buffer_size;
-	CD3DX12_HEAP_PROPERTIES upload_heap;
 	CD3DX12_RESOURCE_DESC upload_buff;
-	ComPtr<ID3D12Resource> texture_upload_heap;
-	vector<UINT8> texture_data;
+	asset_loading* loading;
 	D3D12_SUBRESOURCE_DATA texture_subresource;
-	CD3DX12_RESOURCE_BARRIER texture_upload_barrier;
 	D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc;
+	uint32_t texture_slot;
+	CD3DX12_CPU_DESCRIPTOR_HANDLE srv_handle;
 
 	dev = app->dx12->device;
 	command_list = app->dx12->command_list;
-	command_queue = app->dx12->command_queue;
 	srv_heap = app->dx12->srv_heap;
+	loading = app->loading;
 
 	//
 	// First describe the texture for DX12.
@@ -606,8 +1701,8 @@ void create_texture(application* app) {
 	texture_desc = {};
 	texture_desc.MipLevels = 1;
 	texture_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-	texture_desc.Width = TEXTURE_W;
-	texture_desc.Height = TEXTURE_H;
+	texture_desc.Width = ATLAS_PAGE_SIZE;
+	texture_desc.Height = ATLAS_PAGE_SIZE;
 	texture_desc.Flags = D3D12_RESOURCE_FLAG_NONE;
 	texture_desc.DepthOrArraySize = 1;
 	texture_desc.SampleDesc.Count = 1;
@@ -618,17 +1713,22 @@ void create_texture(application* app) {
 	// Now create the texture.
 	//
 
-	default_heap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-	result = dev->CreateCommittedResource(
-		&default_heap,
-		D3D12_HEAP_FLAG_NONE,
-		&texture_desc,
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_DEFAULT,
+		texture_desc,
 		D3D12_RESOURCE_STATE_COPY_DEST,
 		NULL,
-		IID_PPV_ARGS(&texture)
+		&texture,
+		&(app->texture_memory)
 	);
 
-	throw_if_failed(result);
+	register_resource(
+		&(app->dx12->resource_states),
+		texture.Get(),
+		1,
+		RESOURCE_STATE_COPY_DEST
+	);
 
 	upload_buffer_size = GetRequiredIntermediateSize(
 		texture.Get(),
@@ -640,33 +1740,20 @@ void create_texture(application* app) {
 	// Now create the GPU upload buffer
 	//
 
-	upload_heap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
 	upload_buff = CD3DX12_RESOURCE_DESC::Buffer(upload_buffer_size);
-	result = dev->CreateCommittedResource(
-		&upload_heap,
-		D3D12_HEAP_FLAG_NONE,
-		&upload_buff,
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_UPLOAD,
+		upload_buff,
 		D3D12_RESOURCE_STATE_GENERIC_READ,
 		NULL,
-		IID_PPV_ARGS(&texture_upload_heap)
+		&(loading->texture_upload_heap),
+		&(loading->texture_upload_memory)
 	);
 
-	throw_if_failed(result);
-
-	//
-	// Load texture from file
-	//
-
-	texture_data = load_texture_from_file(L"./assets/friendo.png");
-
-	//
-	// Procedurally generate a texture.
-	//
-
-	//texture_data = generate_texture_data();
-
 	//
-	// Upload the actual texture data using the upload heap.
+	// Upload the actual texture data (decode_texture_task loaded it)
+	// using the upload heap.
 	// 
 	// One thing - what exactly are RowPitch and SlicePitch? They aren't
 	// just the width and height of the texture. But basically it goes like
@@ -682,32 +1769,56 @@ void create_texture(application* app) {
 	//
 
 	texture_subresource = {};
-	texture_subresource.pData = texture_data.data();
-	texture_subresource.RowPitch = TEXTURE_W * TEXTURE_PIXEL_SIZE;
-	texture_subresource.SlicePitch = texture_subresource.RowPitch * TEXTURE_H;
+	texture_subresource.pData = loading->atlas_data.data();
+	texture_subresource.RowPitch = ATLAS_PAGE_SIZE * TEXTURE_PIXEL_SIZE;
+	texture_subresource.SlicePitch = texture_subresource.RowPitch * ATLAS_PAGE_SIZE;
+
+	use_gpu_memory(&(app->dx12->memory), app->texture_memory, app->dx12->fence_value);
+
+	transition_resource(
+		&(app->dx12->command_list_states),
+		texture.Get(),
+		ALL_SUBRESOURCES,
+		RESOURCE_STATE_COPY_DEST
+	);
+
+	flush_tracked_barriers(app->dx12);
 
 	UpdateSubresources(
 		command_list.Get(),
 		texture.Get(),
-		texture_upload_heap.Get(),
+		loading->texture_upload_heap.Get(),
 		0,
 		0,
 		1,
 		&texture_subresource
 	);
 
-	texture_upload_barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+	transition_resource(
+		&(app->dx12->command_list_states),
 		texture.Get(),
-		D3D12_RESOURCE_STATE_COPY_DEST,
-		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+		ALL_SUBRESOURCES,
+		RESOURCE_STATE_PIXEL_SHADER_RESOURCE
 	);
 
-	command_list->ResourceBarrier(1, &texture_upload_barrier);
+	flush_tracked_barriers(app->dx12);
 
 	//
-	// Lastly, create the SRV for the texture.
+	// Lastly, create the SRV for the texture, in the slot the material
+	// registry gives it. Materials refer to it by that slot.
 	//
 
+	texture_slot = add_material_texture(&(app->materials), texture.Get());
+	if (texture_slot == MATERIAL_NO_TEXTURE) {
+		throw_if_failed(E_OUTOFMEMORY);
+	}
+
+	srv_handle.InitOffsetted(
+		srv_heap->GetCPUDescriptorHandleForHeapStart(),
+		texture_slot,
+		app->dx12->srv_descriptor_size
+	);
+
 	srv_desc = {};
 	srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srv_desc.Format = texture_desc.Format;
@@ -716,45 +1827,113 @@ void create_texture(application* app) {
 	dev->CreateShaderResourceView(
 		texture.Get(),
 		&srv_desc,
-		srv_heap->GetCPUDescriptorHandleForHeapStart()
+		srv_handle
 	);
 
+	app->texture = texture;
+}
+
+void initialize_materials(application* app) {
+	ComPtr<ID3D12Resource> material_buffer;
+	CD3DX12_RESOURCE_DESC buffer_desc;
+	gpu_material material;
+	CD3DX12_RANGE read_range(0, 0);
+	HRESULT result;
+
 	//
-	// Finally, close the command list.
+	// The material buffer is small and rarely changes, so it lives in
+	// an upload heap and the GPU reads it from there. It stays mapped,
+	// and changed records are copied in at the start of a frame.
 	//
 
-	result = command_list->Close();
-	throw_if_failed(result);
-	ID3D12CommandList* commands[] = { command_list.Get() };
-	command_queue->ExecuteCommandLists(
-		_countof(commands),
-		commands
+	buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(MAX_MATERIALS * sizeof(gpu_material));
+
+	create_placed_resource(
+		&(app->dx12->memory),
+		D3D12_HEAP_TYPE_UPLOAD,
+		buffer_desc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		NULL,
+		&material_buffer,
+		&(app->material_buffer_memory)
 	);
 
-	wait_for_previous_frame(app->dx12);
+	result = material_buffer->Map(0, &read_range, (void**)(&(app->mapped_materials)));
+	throw_if_failed(result);
 
-	app->texture = texture;
+	app->material_buffer = material_buffer;
+
+	//
+	// The cube just shows its texture as it is. Its UVs are remapped to
+	// where the texture is on the atlas page.
+	//
+
+	material = get_default_material();
+	material.albedo_texture = add_material_texture(&(app->materials), app->texture.Get());
+	get_atlas_uv_transform(&(app->atlas.settings), &(app->cube_image), material.uv_scale, material.uv_offset);
+
+	app->cube_material = add_material(&(app->materials), "cube", material);
+	if (app->cube_material == MATERIAL_INVALID) {
+		throw_if_failed(E_FAIL);
+	}
+
+	upload_materials(&(app->materials), app->mapped_materials);
+}
+
+vector<UINT8> read_file(application* app, const string& file_path) {
+	vector<io_request> requests;
+	vector<UINT8> contents;
+	io_file file;
+	io_batch batch;
+	uint64_t offset;
+	uint32_t i;
+	bool read;
+
+	if (!open_io_file(&(app->io), &file, file_path)) {
+		throw_if_failed(E_FAIL);
+	}
+
+	//
+	// The whole file is read in one batch, in pieces that all go at
+	// once, straight into the buffer that's returned.
+	//
+
+	contents.resize((size_t)file.size);
+	requests.resize((size_t)((file.size + IO_READ_SIZE - 1) / IO_READ_SIZE));
+
+	for (i = 0; i < requests.size(); i++) {
+		offset = (uint64_t)i * IO_READ_SIZE;
+
+		requests[i].file = &file;
+		requests[i].offset = offset;
+		requests[i].size = (uint32_t)min((uint64_t)IO_READ_SIZE, file.size - offset);
+		requests[i].destination = contents.data() + offset;
+	}
+
+	submit_io_batch(&(app->io), &batch, requests.data(), (uint32_t)requests.size());
+	read = wait_for_io_batch(&(app->io), &batch);
+	close_io_file(&file);
+
+	if (!read) {
+		throw_if_failed(E_FAIL);
+	}
+
+	return contents;
 }
 
 // TODO: Texture is coming in too saturated. I think this is due to a lack
 // of gamma correction. Need to read up on this a bit more to understand the
 // problem.
-vector<UINT8> load_texture_from_file(const wstring& file_path) {
+vector<UINT8> load_texture_from_memory(const void* data, const size_t size) {
 	vector<UINT8> texture_data;
-	fs::path path(file_path);
 	HRESULT result;
 	TexMetadata metadata;
 	ScratchImage scratch_image;
 	UINT texture_size;
-	UINT8* data;
 
-	if (!fs:: exists(path)) {
-		result = E_FAIL;
-		throw_if_failed(result);
-	}
-
-	result = LoadFromWICFile(
-		file_path.c_str(),
+	result = LoadFromWICMemory(
+		data,
+		size,
 		WIC_FLAGS_FORCE_RGB,
 		&metadata,
 		scratch_image
@@ -764,14 +1943,77 @@ vector<UINT8> load_texture_from_file(const wstring& file_path) {
 
 	const Image* images = scratch_image.GetImages();
 	texture_size = images[0].rowPitch * images[0].height;
-	texture_data.resize(texture_size);
-	data = texture_data.data();
+	texture_data.assign(images[0].pixels, images[0].pixels + texture_size);
+
+	return texture_data;
+}
+
+bool decode_texture(void* data, vector<uint8_t>* pixels) {
+	encoded_texture* encoded;
+
+	encoded = (encoded_texture*)data;
 
-	for (int i = 0; i < texture_size; i++) {
-		data[i] = images[0].pixels[i];
+	// The texture cache has to hear about a failure, or whoever else
+	// is waiting for this texture would wait forever.
+	try {
+		*pixels = load_texture_from_memory(encoded->data, encoded->size);
+	} catch (...) {
+		return false;
 	}
 
-	return texture_data;
+	return true;
+}
+
+texture_cache_entry* load_texture_asset(application* app, const string& name) {
+	const asset_archive_entry* entry;
+	texture_cache_entry* texture;
+	vector<UINT8> contents;
+	encoded_texture encoded;
+
+	//
+	// A stored image (and PNGs always are) is used straight out of the
+	// mapping. A compressed one is decompressed first, across the job
+	// system, and one that isn't packed is read through the I/O queue.
+	//
+
+	entry = find_asset(&(app->asset_pack), name);
+	encoded.data = entry ? get_mapped_asset(&(app->asset_pack), entry) : NULL;
+	encoded.size = entry ? (size_t)entry->size : 0;
+
+	if (!entry) {
+		contents = read_file(app, "./assets/" + name);
+	} else if (!encoded.data) {
+		contents.resize((size_t)entry->size);
+
+		if (!read_asset(&(app->jobs), &(app->asset_pack), entry, contents.data())) {
+			throw_if_failed(E_FAIL);
+		}
+	}
+
+	if (!encoded.data) {
+		encoded.data = contents.data();
+		encoded.size = contents.size();
+	}
+
+	//
+	// Only decode it if it isn't already. Hashing the file is far
+	// cheaper than decoding it, and means an image that's been changed
+	// isn't mistaken for the one that was there before.
+	//
+
+	texture = acquire_texture(
+		&(app->textures),
+		name,
+		hash_bytes(encoded.data, encoded.size),
+		decode_texture,
+		&encoded
+	);
+
+	if (!texture) {
+		throw_if_failed(E_FAIL);
+	}
+
+	return texture;
 }
 
 vector<UINT8> generate_texture_data() {
@@ -824,60 +2066,115 @@ vector<UINT8> generate_texture_data() {
 	return result;
 }
 
-void initialize_depth_buffer(application* app) {
-	dx12_handler* dx12;
-	ComPtr<ID3D12Device> device;
-	D3D12_CLEAR_VALUE optimized_clear_val;
-	CD3DX12_HEAP_PROPERTIES heap_properties;
-	CD3DX12_RESOURCE_DESC tex_desc;
-	D3D12_DESCRIPTOR_HEAP_DESC dsv_heap_desc;
-	D3D12_DEPTH_STENCIL_VIEW_DESC dsv_desc;
-	HRESULT result;
-
-	dx12 = app->dx12;
-	device = dx12->device;
-
-	//
-	// First we should wait until the command queue
-	// is finished doing anything.
-	//
+void initialize_frame_graph(application* app) {
+	frame_graph* graph;
+	frame_graph_texture_desc depth_desc;
+	float depth_clear_value[4];
+	uint32_t clear_pass;
+	uint32_t cull_pass;
+	uint32_t main_pass;
+	bool success;
 
-	wait_for_previous_frame(dx12);
+	graph = &(app->graph);
+	reset_frame_graph(graph);
 
 	//
-	// Next we set up all the properties for our depth buffer.
+	// The main pass draws the cubes into the back buffer, using the
+	// depth buffer. The back buffer changes each frame, so it stays
+	// outside the graph. With GPU culling, two passes come before it:
+	// one zeroes the draw count, and the other culls the objects into
+	// the commands that the main pass draws.
 	//
 
-	optimized_clear_val = {};
-	optimized_clear_val.Format = DXGI_FORMAT_D32_FLOAT;
-	optimized_clear_val.DepthStencil = { 1.0f, 0 };
+	depth_clear_value[0] = 1.0f;
+	depth_clear_value[1] = 0.0f;
+	depth_clear_value[2] = 0.0f;
+	depth_clear_value[3] = 0.0f;
 
-	heap_properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-	tex_desc = CD3DX12_RESOURCE_DESC::Tex2D(
+	depth_desc = describe_transient_texture(
+		app->dx12->device,
 		DXGI_FORMAT_D32_FLOAT,
 		app->screen_w,
 		app->screen_h,
-		1,
-		0,
-		1,
-		0,
-		D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL
+		D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL,
+		depth_clear_value
 	);
 
+	app->depth_target = create_transient_texture(graph, "depth", depth_desc);
+
+	app->indirect_commands_target = FRAME_GRAPH_INVALID_RESOURCE;
+	app->indirect_count_target = FRAME_GRAPH_INVALID_RESOURCE;
+
+	if (INDIRECT_DRAWS && GPU_CULLING) {
+		app->indirect_commands_target = import_resource(
+			graph,
+			"indirect commands",
+			app->indirect_commands.Get(),
+			RESOURCE_STATE_INDIRECT_ARGUMENT,
+			RESOURCE_STATE_INDIRECT_ARGUMENT
+		);
+
+		app->indirect_count_target = import_resource(
+			graph,
+			"indirect count",
+			app->indirect_count.Get(),
+			RESOURCE_STATE_INDIRECT_ARGUMENT,
+			RESOURCE_STATE_INDIRECT_ARGUMENT
+		);
+
+		clear_pass = add_pass(graph, "clear draw count", record_clear_draw_count_pass, app, false);
+		write_resource(graph, clear_pass, app->indirect_count_target, RESOURCE_STATE_COPY_DEST);
+
+		cull_pass = add_pass(graph, "cull", record_cull_pass, app, false);
+		write_resource(graph, cull_pass, app->indirect_commands_target, RESOURCE_STATE_UNORDERED_ACCESS);
+		write_resource(graph, cull_pass, app->indirect_count_target, RESOURCE_STATE_UNORDERED_ACCESS);
+	}
+
+	main_pass = add_pass(graph, "main", record_main_pass, app, true);
+	write_resource(graph, main_pass, app->depth_target, RESOURCE_STATE_DEPTH_WRITE);
+
+	if (INDIRECT_DRAWS && GPU_CULLING) {
+		read_resource(graph, main_pass, app->indirect_commands_target, RESOURCE_STATE_INDIRECT_ARGUMENT);
+		read_resource(graph, main_pass, app->indirect_count_target, RESOURCE_STATE_INDIRECT_ARGUMENT);
+	}
+
+	success = compile_frame_graph(graph);
+	if (!success) {
+		throw_if_failed(E_FAIL);
+	}
+
+#if defined(_DEBUG)
+	cout << get_frame_graph_report(graph);
+#endif
+
 	//
-	// Finally we create our depth-buffer and depth stencil views.
+	// Now create the heap and the transient resources.
 	//
 
-	result = device->CreateCommittedResource(
-		&heap_properties,
-		D3D12_HEAP_FLAG_NONE,
-		&tex_desc,
-		D3D12_RESOURCE_STATE_DEPTH_WRITE,
-		&optimized_clear_val,
-		IID_PPV_ARGS(&(app->depth_buffer))
+	realize_frame_graph(
+		&(app->dx12->memory),
+		graph,
+		&(app->transient_memory),
+		&(app->transient_resources)
 	);
 
-	throw_if_failed(result);
+	app->depth_buffer = app->transient_resources[app->depth_target];
+}
+
+void initialize_depth_buffer(application* app) {
+	dx12_handler* dx12;
+	ComPtr<ID3D12Device> device;
+	D3D12_DESCRIPTOR_HEAP_DESC dsv_heap_desc;
+	D3D12_DEPTH_STENCIL_VIEW_DESC dsv_desc;
+	HRESULT result;
+
+	dx12 = app->dx12;
+	device = dx12->device;
+
+	//
+	// The depth buffer itself was created by the frame graph. All
+	// that's left is to create the depth stencil view for it.
+	//
 
 	// TODO: Should move this out so we create it once. The rest
 	// of our code can be used to resize depth buffer when our
@@ -905,33 +2202,170 @@ void initialize_depth_buffer(application* app) {
 }
 
 void frame(application* app) {
-	update(app);
-	render(app);
+	profiler* prof;
+	bool capture_finished;
+
+	begin_alloc_frame(&(app->main_allocs));
+
+	//
+	// Wait until it's time for the next frame (if the frame rate is
+	// capped). Waiting here, before we read the simulation, is what
+	// keeps latency down.
+	//
+
+	{
+		PROFILE_ZONE("pacing");
+		begin_paced_frame(&(app->pacer));
+	}
+
+	{
+		PROFILE_ZONE("frame");
+
+		update(app);
+		submit_frame(app);
+	}
+
+	//
+	// Gather up this frame's timings. If a capture just finished,
+	// write it out.
+	//
+
+	prof = get_profiler();
+	capture_finished = collect_profile_frame(prof);
+
+	end_alloc_frame(&(app->main_allocs));
+
+	if (capture_finished) {
+		write_chrome_trace(prof, PROFILE_TRACE_PATH);
+		cout << "Wrote profile capture to " << PROFILE_TRACE_PATH << endl;
+		cout << get_profile_report(prof);
+		cout << get_frame_pacing_report(&(app->pacer));
+		cout << get_render_ring_report(&(app->render_commands));
+		cout << get_job_system_report(&(app->jobs));
+		cout << get_io_queue_report(&(app->io));
+		cout << get_texture_cache_report(&(app->textures));
+		cout << get_alloc_report(&(app->main_allocs));
+		cout << get_alloc_report(&(app->render_allocs));
+
+		reset_frame_time_histogram(&(app->pacer.frame_times));
+	}
+}
+
+void initialize_world(application* app, sim_snapshot* world) {
+	sim_transform* cube;
+
+	*world = {};
+
+	//
+	// The cube sits at the origin.
+	//
+
+	world->transform_count = 1;
+	cube = &(world->transforms[0]);
+	cube->rotation[3] = 1.0f;
+	cube->scale[0] = 1.0f;
+	cube->scale[1] = 1.0f;
+	cube->scale[2] = 1.0f;
+
+	//
+	// The camera looks down at it.
+	//
+
+	world->camera.eye[0] = 0.0f;
+	world->camera.eye[1] = -5.0f;
+	world->camera.eye[2] = -10.0f;
+	world->camera.up[1] = 1.0f;
+	world->camera.field_of_view = app->field_of_view;
+}
+
+void step_world(
+	sim_snapshot* world,
+	const uint32_t input,
+	const double step_seconds,
+	void* user_data
+) {
+	sim_transform* cube;
+	XMVECTOR rotation;
+	XMVECTOR spin;
+	float direction;
+
+	cube = &(world->transforms[0]);
+
+	direction = 0.0f;
+	if (input & SIM_INPUT_SPIN_LEFT) {
+		direction += 1.0f;
+	}
+
+	if (input & SIM_INPUT_SPIN_RIGHT) {
+		direction -= 1.0f;
+	}
+
+	if (direction == 0.0f) {
+		return;
+	}
+
+	spin = XMQuaternionRotationAxis(
+		XMVectorSet(0, 1, 0, 0),
+		XMConvertToRadians(CUBE_SPIN_SPEED * direction * (float)step_seconds)
+	);
+
+	rotation = XMLoadFloat4((XMFLOAT4*)cube->rotation);
+	rotation = XMQuaternionNormalize(XMQuaternionMultiply(rotation, spin));
+	XMStoreFloat4((XMFLOAT4*)cube->rotation, rotation);
+}
+
+uint32_t get_simulation_buttons(const WPARAM key) {
+	switch (key) {
+	case VK_LEFT:
+		return SIM_INPUT_SPIN_LEFT;
+	case VK_RIGHT:
+		return SIM_INPUT_SPIN_RIGHT;
+	default:
+		return 0;
+	}
 }
 
 void update(application* app) {
-	XMVECTOR rotation_axis;
+	sim_transform* cube;
+	sim_camera* camera;
 	XMVECTOR eye_position;
 	XMVECTOR focus_point;
 	XMVECTOR up_dir;
+	XMFLOAT4X4 cube_matrix;
+	float box_min[3];
+	float box_max[3];
 	float aspect_ratio;
+	float scale;
+
+	PROFILE_ZONE("update");
+
+	//
+	// Get the world as of this frame from the simulation.
+	//
+
+	read_simulation(&(app->sim), get_system_time_ns(NULL), &(app->drawn_world));
+
+	cube = &(app->drawn_world.transforms[0]);
+	camera = &(app->drawn_world.camera);
 
 	//
 	// Set the model matrix.
 	//
 
-	app->model_matrix = XMMatrixIdentity();
-	//app->angle += 0.01;
-	//rotation_axis = XMVectorSet(0, 1, 1, 0);
-	//app->model_matrix = XMMatrixRotationAxis(rotation_axis, (float)app->angle);
+	app->model_matrix = XMMatrixAffineTransformation(
+		XMLoadFloat3((XMFLOAT3*)cube->scale),
+		XMVectorZero(),
+		XMLoadFloat4((XMFLOAT4*)cube->rotation),
+		XMLoadFloat3((XMFLOAT3*)cube->position)
+	);
 
 	//
 	// Set the view matrix.
 	//
 
-	eye_position = XMVectorSet(0, -5, -10, 1);
-	focus_point = XMVectorSet(0, 0, 0, 1);
-	up_dir = XMVectorSet(0, 1, 0, 0);
+	eye_position = XMVectorSet(camera->eye[0], camera->eye[1], camera->eye[2], 1);
+	focus_point = XMVectorSet(camera->focus[0], camera->focus[1], camera->focus[2], 1);
+	up_dir = XMVectorSet(camera->up[0], camera->up[1], camera->up[2], 0);
 	app->view_matrix = XMMatrixLookAtLH(
 		eye_position,
 		focus_point,
@@ -940,24 +2374,199 @@ void update(application* app) {
 
 	aspect_ratio = (float)app->screen_w / (float)app->screen_h;
 	app->projection_matrix = XMMatrixPerspectiveFovLH(
-		XMConvertToRadians(app->field_of_view),
+		XMConvertToRadians(camera->field_of_view),
 		aspect_ratio,
 		0.1f,
 		100.0f
 	);
+
+	//
+	// Pick the cube's level of detail. Its bounding sphere sits on its
+	// origin, and grows with its largest scale.
+	//
+
+	set_lod_view(
+		&(app->lod_camera),
+		camera->eye,
+		XMConvertToRadians(camera->field_of_view),
+		(float)app->screen_h
+	);
+
+	scale = max(cube->scale[0], max(cube->scale[1], cube->scale[2]));
+	move_lod_instance(&(app->cube_instances), 0, cube->position, CUBE_RADIUS * scale);
+
+	select_all_lods(&(app->jobs), &(app->lod_camera), &(app->lod_options), &(app->cube_instances));
+
+	//
+	// Draw the occluders, and see if the cube is behind any of them.
+	// Its box is its vertices', in its own space.
+	//
+
+	render_occluders(
+		&(app->jobs),
+		&(app->occlusion),
+		app->occluders.data(),
+		(uint32_t)app->occluders.size()
+	);
+
+	XMStoreFloat4x4(
+		&cube_matrix,
+		XMMatrixMultiply(XMMatrixMultiply(app->model_matrix, app->view_matrix), app->projection_matrix)
+	);
+
+	box_min[0] = -1.0f;
+	box_min[1] = -1.0f;
+	box_min[2] = -1.0f;
+	box_max[0] = 1.0f;
+	box_max[1] = 1.0f;
+	box_max[2] = 1.0f;
+
+	app->cube_visible = is_box_visible(&(app->occlusion), box_min, box_max, &(cube_matrix.m[0][0]));
+}
+
+void submit_frame(application* app) {
+	render_ring* ring;
+	begin_frame_packet* begin;
+	draw_packet* draw;
+	const mesh_lod* lod;
+	float depth;
+
+	PROFILE_ZONE("submit frame");
+
+	ring = &(app->render_commands);
+
+	//
+	// If the render thread is still busy with earlier frames, wait for
+	// it. This is what stops us racing ahead and adding latency.
+	//
+
+	begin_render_frame(ring, MAX_QUEUED_FRAMES);
+
+	begin = (begin_frame_packet*)begin_render_packet(
+		ring,
+		RENDER_PACKET_BEGIN_FRAME,
+		sizeof(begin_frame_packet)
+	);
+	XMStoreFloat4x4(&(begin->view_matrix), app->view_matrix);
+	XMStoreFloat4x4(&(begin->projection_matrix), app->projection_matrix);
+	begin->draw_count = app->cube_visible ? 1 : 0;
+	end_render_packet(ring);
+
+	//
+	// The sort key wants how far the cube is from the camera, which is
+	// where its origin ends up along the view's z axis.
+	//
+
+	depth = XMVectorGetZ(XMVector3Transform(app->model_matrix.r[3], app->view_matrix));
+
+	lod = get_instance_lod(&(app->cube_instances), 0);
+
+	// Hidden behind an occluder, so not worth sending at all.
+	if (app->cube_visible) {
+		draw = (draw_packet*)begin_render_packet(ring, RENDER_PACKET_DRAW, sizeof(draw_packet));
+		XMStoreFloat4x4(&(draw->model_matrix), app->model_matrix);
+		draw->index_count = lod->index_count;
+		draw->first_index = lod->first_index;
+		draw->material = app->cube_material;
+		draw->sort_key = make_render_key(0, RENDER_PASS_OPAQUE, DRAW_PIPELINE_TEXTURED, app->cube_material, depth);
+		draw->bounds[0] = 0.0f;
+		draw->bounds[1] = 0.0f;
+		draw->bounds[2] = 0.0f;
+		draw->bounds[3] = CUBE_RADIUS;
+		end_render_packet(ring);
+	}
+
+	write_render_packet(ring, RENDER_PACKET_SPRITES, &(app->overlay_sprite), sizeof(sprite));
+
+	write_render_packet(ring, RENDER_PACKET_END_FRAME, NULL, 0);
+	end_render_frame(ring);
+}
+
+void run_render_thread(application* app) {
+	render_ring* ring;
+	const render_packet_header* packet;
+	const begin_frame_packet* begin;
+	uint32_t type;
+	bool running;
+
+	set_profile_thread_name("Render thread");
+	initialize_alloc_frame_stats(&(app->render_allocs), "render thread");
+
+	ring = &(app->render_commands);
+	running = true;
+
+	while (running) {
+		packet = wait_for_render_packet(ring);
+		type = packet->type;
+
+		switch (type) {
+		case RENDER_PACKET_BEGIN_FRAME:
+			begin_alloc_frame(&(app->render_allocs));
+
+			// Last frame's draws are done with.
+			reset_frame_arena(&(app->render_arena));
+
+			begin = (const begin_frame_packet*)get_render_packet_data(packet);
+			app->render_view_matrix = XMLoadFloat4x4(&(begin->view_matrix));
+			app->render_projection_matrix = XMLoadFloat4x4(&(begin->projection_matrix));
+			app->render_draws = allocate_array_from_arena<draw_packet>(&(app->render_arena), begin->draw_count);
+			app->render_draw_count = 0;
+			app->render_draw_capacity = begin->draw_count;
+
+			reset_render_queue(&(app->draw_queue));
+			reset_sprite_batch(&(app->sprites));
+			break;
+		case RENDER_PACKET_DRAW:
+			if (app->render_draw_count < app->render_draw_capacity) {
+				app->render_draws[app->render_draw_count] = *(const draw_packet*)get_render_packet_data(packet);
+				add_render_item(
+					&(app->draw_queue),
+					app->render_draws[app->render_draw_count].sort_key,
+					app->render_draw_count
+				);
+				app->render_draw_count++;
+			}
+			break;
+		case RENDER_PACKET_SPRITES:
+			add_sprites(
+				&(app->sprites),
+				(const sprite*)get_render_packet_data(packet),
+				packet->size / sizeof(sprite)
+			);
+			break;
+		case RENDER_PACKET_END_FRAME:
+			render(app);
+			end_alloc_frame(&(app->render_allocs));
+			break;
+		case RENDER_PACKET_QUIT:
+			running = false;
+			break;
+		}
+
+		// The packet is gone once it's popped, so don't touch it after.
+		pop_render_packet(ring);
+
+		if (type == RENDER_PACKET_END_FRAME) {
+			finish_render_frame(ring);
+		}
+	}
 }
 
 void render(application* app) {
 	dx12_handler* dx12;
-	ComPtr<ID3D12GraphicsCommandList> command_list;
-	ComPtr<ID3D12CommandQueue> command_queue;
-	ComPtr<IDXGISwapChain3> swap_chain;
-	HRESULT result;
+
+	PROFILE_ZONE("render");
 
 	dx12 = app->dx12;
-	command_list = dx12->command_list;
-	command_queue = dx12->command_queue;
-	swap_chain = dx12->swap_chain;
+
+	//
+	// Wait until the swap chain has room for another frame.
+	//
+
+	{
+		PROFILE_ZONE("wait for swap chain");
+		wait_for_swap_chain(dx12);
+	}
 
 	//
 	// Record all the commands we need to render the scene into
@@ -970,52 +2579,54 @@ void render(application* app) {
 	// Execute the command list.
 	//
 
-	ID3D12CommandList* command_lists[] = { command_list.Get() };
-	command_queue->ExecuteCommandLists(
-		_countof(command_lists),
-		command_lists
-	);
+	{
+		PROFILE_ZONE("execute");
+		execute_tracked_command_list(dx12);
+	}
 
 	//
 	// Lastly, draw the frame.
 	//
 
-	result = swap_chain->Present(1, 0);
-	throw_if_failed(result);
+	{
+		PROFILE_ZONE("present");
+		present_frame(dx12);
+	}
 
 	//
 	// Do synchronization step.
 	//
 
+	PROFILE_ZONE("wait for gpu");
 	wait_for_previous_frame(dx12);
 }
 
 void populate_command_list(application* app) {
 	dx12_handler* dx12;
 	HRESULT result;
-	ComPtr<ID3D12CommandAllocator> command_allocator;
-	ComPtr<ID3D12GraphicsCommandList> command_list;
+	ID3D12CommandAllocator* command_allocator;
+	ID3D12GraphicsCommandList* command_list;
 	UINT frame_index;
-	ComPtr<ID3D12Resource> back_buffer;
-	ComPtr<ID3D12DescriptorHeap> rtv_heap;
-	UINT rtv_descriptor_size;
-	ComPtr<ID3D12DescriptorHeap> srv_heap;
-	ComPtr<ID3D12PipelineState> pipeline_state;
-	CD3DX12_RESOURCE_BARRIER barrier_render_target;
-	CD3DX12_RESOURCE_BARRIER barrier_present;
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtv_handle;
-	D3D12_CPU_DESCRIPTOR_HANDLE dsv_handle;
-	XMMATRIX mvp_matrix;
+	ID3D12Resource* back_buffer;
+	ID3D12DescriptorHeap* srv_heap;
+	ID3D12PipelineState* pipeline_state;
+	uint32_t gpu_frame_zone;
+
+	PROFILE_ZONE("populate command list");
+
+	//
+	// These are borrowed from the dx12 handler and the application,
+	// which own them for as long as we render. Copying the ComPtrs
+	// instead would AddRef and Release each one every frame.
+	//
 
 	dx12 = app->dx12;
-	command_allocator = dx12->command_allocator;
-	command_list = dx12->command_list;
+	command_allocator = dx12->command_allocator.Get();
+	command_list = dx12->command_list.Get();
 	frame_index = dx12->frame_index;
-	back_buffer = dx12->render_targets[frame_index];
-	rtv_heap = dx12->rtv_heap;
-	rtv_descriptor_size = dx12->rtv_descriptor_size;
-	srv_heap = dx12->srv_heap;
-	pipeline_state = app->pipeline_state;
+	back_buffer = dx12->render_targets[frame_index].Get();
+	srv_heap = dx12->srv_heap.Get();
+	pipeline_state = app->pipeline_state.Get();
 
 	//
 	// First step is to reset the command allocator. The command
@@ -1037,8 +2648,60 @@ void populate_command_list(application* app) {
 	// longer exist!
 	//
 
-	result = command_list->Reset(command_allocator.Get(), pipeline_state.Get());
+	result = command_list->Reset(command_allocator, pipeline_state);
 	throw_if_failed(result);
+	begin_tracked_command_list(dx12);
+
+	//
+	// Tell the residency manager which heaps this frame uses, so none
+	// of them are evicted out from under it.
+	//
+
+	use_gpu_memory(&(dx12->memory), app->vertex_buffer_memory, dx12->fence_value);
+	use_gpu_memory(&(dx12->memory), app->index_buffer_memory, dx12->fence_value);
+	use_gpu_memory(&(dx12->memory), app->texture_memory, dx12->fence_value);
+	use_gpu_memory(&(dx12->memory), app->transient_memory, dx12->fence_value);
+	use_gpu_memory(&(dx12->memory), app->constant_buffer_memory, dx12->fence_value);
+	use_gpu_memory(&(dx12->memory), app->material_buffer_memory, dx12->fence_value);
+	use_gpu_memory(&(dx12->memory), app->sprite_vertex_memory, dx12->fence_value);
+	use_gpu_memory(&(dx12->memory), app->sprite_index_memory, dx12->fence_value);
+
+	if (INDIRECT_DRAWS) {
+		use_gpu_memory(&(dx12->memory), app->object_buffer_memory, dx12->fence_value);
+		use_gpu_memory(&(dx12->memory), app->indirect_commands_memory, dx12->fence_value);
+		use_gpu_memory(&(dx12->memory), app->indirect_count_memory, dx12->fence_value);
+		use_gpu_memory(&(dx12->memory), app->indirect_upload_memory, dx12->fence_value);
+	}
+
+	//
+	// The GPU is done with the last frame that used this back buffer,
+	// so its constants can be overwritten.
+	//
+
+	begin_constant_frame(&(app->constants), frame_index);
+
+	//
+	// There's only the one material buffer, but we wait for the GPU at
+	// the end of every frame, so nothing is reading it now either. Copy
+	// over whatever materials changed.
+	//
+
+	upload_materials(&(app->materials), app->mapped_materials);
+
+	//
+	// And this frame's draws: their constants and, for indirect draws,
+	// what the culling needs. Both passes skip drawing without them.
+	//
+
+	prepare_draws(app);
+
+	//
+	// Pick up the GPU timings of any finished frames, and start timing
+	// this one.
+	//
+
+	begin_gpu_profile_frame(&(dx12->gpu_timings), dx12->fence->GetCompletedValue());
+	gpu_frame_zone = begin_gpu_zone(&(dx12->gpu_timings), command_list, "frame");
 
 	//
 	// Next, set all the pipeline state
@@ -1046,37 +2709,253 @@ void populate_command_list(application* app) {
 
 	command_list->SetGraphicsRootSignature(app->root_signature.Get());
 
-	ID3D12DescriptorHeap* heaps[] = { srv_heap.Get() };
+	ID3D12DescriptorHeap* heaps[] = { srv_heap };
 	command_list->SetDescriptorHeaps(
 		_countof(heaps),
 		heaps
 	);
 
 	//
-	// Get the RTV and DSV for the current back buffer.
+	// Before we can draw to the render target, we need to make sure
+	// the current render target is transitioned from the PRESENT state
+	// to RENDER_TARGET. The state tracker knows the back buffer is in
+	// PRESENT, so we only need to say where we want it to be.
 	//
 
-	rtv_handle.InitOffsetted(
-		rtv_heap->GetCPUDescriptorHandleForHeapStart(),
-		frame_index,
-		rtv_descriptor_size
+	transition_resource(
+		&(dx12->command_list_states),
+		back_buffer,
+		ALL_SUBRESOURCES,
+		RESOURCE_STATE_RENDER_TARGET
 	);
 
-	dsv_handle = app->depth_stencil_view->GetCPUDescriptorHandleForHeapStart();
+	flush_tracked_barriers(dx12);
+
+	//
+	// Now run the frame graph's passes. The graph takes care of the
+	// barriers for its own resources (like the depth buffer).
+	//
+
+	execute_frame_graph(&(app->graph), record_frame_graph_barriers, dx12);
+
+	//
+	// Once our commands are done, close the command list.
+	//
+
+	transition_resource(
+		&(dx12->command_list_states),
+		back_buffer,
+		ALL_SUBRESOURCES,
+		RESOURCE_STATE_PRESENT
+	);
+
+	flush_tracked_barriers(dx12);
+
+	end_gpu_zone(&(dx12->gpu_timings), command_list, gpu_frame_zone);
+	end_gpu_profile_frame(&(dx12->gpu_timings), command_list, dx12->fence_value);
+
+	result = command_list->Close();
+	throw_if_failed(result);
+}
+
+void prepare_draws(application* app) {
+	XMFLOAT4X4 view_projection;
+	gpu_object* objects;
+	gpu_object* object;
+	const draw_packet* draw;
+	indirect_command* commands;
+	atomic<uint32_t> counter;
+	uint32_t visible;
+	uint32_t draw_count;
+	uint32_t i;
+
+	PROFILE_ZONE("prepare draws");
+
+	app->render_constant_count = 0;
+
+	//
+	// Write every draw's MVP matrix into the constant buffer in one go.
+	// Each draw then points at its own slice, found by its index. The
+	// buffer only has room for MAX_DRAWS_PER_FRAME, so any more are
+	// dropped (as they are from the render queue).
+	//
+
+	XMStoreFloat4x4(
+		&view_projection,
+		XMMatrixMultiply(app->render_view_matrix, app->render_projection_matrix)
+	);
+
+	draw_count = min(app->render_draw_count, MAX_DRAWS_PER_FRAME);
+
+	if (draw_count == 0 ||
+		!allocate_constant_array(
+			&(app->constants),
+			sizeof(XMFLOAT4X4),
+			draw_count,
+			&(app->render_constants),
+			&(app->render_constant_stride)
+		))
+	{
+		return;
+	}
+
+	write_transform_constants(
+		&(view_projection.m[0][0]),
+		&(app->render_draws[0].model_matrix),
+		sizeof(draw_packet),
+		draw_count,
+		app->render_constants.cpu,
+		app->render_constant_stride
+	);
+
+	app->render_constant_count = draw_count;
+
+	if (!INDIRECT_DRAWS) {
+		return;
+	}
 
 	//
-	// Now we can begin to clear the render target. To do so,
-	// we first need to make sure the current render target is
-	// transitioned from the PRESENT state to RENDER_TARGET.
+	// Copy each draw into this back buffer's region of the object
+	// buffer, for the culling pass.
 	//
 
-	barrier_render_target = CD3DX12_RESOURCE_BARRIER::Transition(
-		back_buffer.Get(),
-		D3D12_RESOURCE_STATE_PRESENT,
-		D3D12_RESOURCE_STATE_RENDER_TARGET
+	objects = (gpu_object*)(
+		app->mapped_objects +
+		(UINT64)app->dx12->frame_index * MAX_DRAWS_PER_FRAME * sizeof(gpu_object)
 	);
 
-	command_list->ResourceBarrier(1, &barrier_render_target);
+	for (i = 0; i < draw_count; i++) {
+		draw = &(app->render_draws[i]);
+		object = &(objects[i]);
+
+		memcpy(object->world, &(draw->model_matrix), sizeof(object->world));
+		memcpy(object->bounds, draw->bounds, sizeof(object->bounds));
+		object->index_count = draw->index_count;
+		object->first_index = draw->first_index;
+		object->base_vertex = 0;
+		object->material = draw->material;
+	}
+
+	extract_frustum_planes(&(view_projection.m[0][0]), app->culling.planes);
+	app->culling.object_count = draw_count;
+	app->culling.max_commands = MAX_DRAWS_PER_FRAME;
+	app->culling.constants_address[0] = (uint32_t)(app->render_constants.gpu_address & 0xffffffff);
+	app->culling.constants_address[1] = (uint32_t)(app->render_constants.gpu_address >> 32);
+	app->culling.constant_stride = (uint32_t)app->render_constant_stride;
+
+	if (GPU_CULLING) {
+		return;
+	}
+
+	//
+	// Without GPU culling, run the same shader here, writing the
+	// commands and their count straight into this back buffer's
+	// region of the upload buffer.
+	//
+
+	commands = (indirect_command*)(
+		app->mapped_indirect_upload +
+		INDIRECT_UPLOAD_HEADER_SIZE +
+		app->dx12->frame_index * INDIRECT_UPLOAD_FRAME_SIZE
+	);
+
+	counter = 0;
+	cull_objects(objects, &(app->culling), 0, draw_count, commands, &counter);
+
+	visible = min(counter.load(), MAX_DRAWS_PER_FRAME);
+	memcpy((UINT8*)commands + INDIRECT_UPLOAD_COUNT_OFFSET, &visible, sizeof(visible));
+}
+
+void record_clear_draw_count_pass(void* user_data) {
+	application* app;
+	ID3D12GraphicsCommandList* command_list;
+
+	app = (application*)user_data;
+	command_list = app->dx12->command_list.Get();
+
+	// The culling shader adds to the count, so it has to start at 0.
+	command_list->CopyBufferRegion(
+		app->indirect_count.Get(),
+		0,
+		app->indirect_upload.Get(),
+		0,
+		sizeof(uint32_t)
+	);
+}
+
+void record_cull_pass(void* user_data) {
+	application* app;
+	dx12_handler* dx12;
+	ID3D12GraphicsCommandList* command_list;
+	D3D12_GPU_VIRTUAL_ADDRESS objects;
+	uint32_t group_count;
+
+	PROFILE_ZONE("cull pass");
+
+	app = (application*)user_data;
+	dx12 = app->dx12;
+	command_list = dx12->command_list.Get();
+
+	GPU_PROFILE_ZONE(&(dx12->gpu_timings), command_list, "cull pass");
+
+	if (app->render_constant_count == 0) {
+		return;
+	}
+
+	objects =
+		app->object_buffer->GetGPUVirtualAddress() +
+		(UINT64)dx12->frame_index * MAX_DRAWS_PER_FRAME * sizeof(gpu_object);
+
+	command_list->SetPipelineState(app->cull_pipeline.Get());
+	command_list->SetComputeRootSignature(app->cull_root_signature.Get());
+	command_list->SetComputeRoot32BitConstants(
+		0,
+		sizeof(culling_constants) / sizeof(uint32_t),
+		&(app->culling),
+		0
+	);
+	command_list->SetComputeRootShaderResourceView(1, objects);
+	command_list->SetComputeRootUnorderedAccessView(2, app->indirect_commands->GetGPUVirtualAddress());
+	command_list->SetComputeRootUnorderedAccessView(3, app->indirect_count->GetGPUVirtualAddress());
+
+	group_count = (app->culling.object_count + CULLING_GROUP_SIZE - 1) / CULLING_GROUP_SIZE;
+	command_list->Dispatch(group_count, 1, 1);
+}
+
+void record_main_pass(void* user_data) {
+	application* app;
+	dx12_handler* dx12;
+	ID3D12GraphicsCommandList* command_list;
+	UINT frame_index;
+	ID3D12DescriptorHeap* rtv_heap;
+	UINT rtv_descriptor_size;
+	ID3D12DescriptorHeap* srv_heap;
+	CD3DX12_CPU_DESCRIPTOR_HANDLE rtv_handle;
+	D3D12_CPU_DESCRIPTOR_HANDLE dsv_handle;
+
+	PROFILE_ZONE("main pass");
+
+	app = (application*)user_data;
+	dx12 = app->dx12;
+	command_list = dx12->command_list.Get();
+	frame_index = dx12->frame_index;
+	rtv_heap = dx12->rtv_heap.Get();
+	rtv_descriptor_size = dx12->rtv_descriptor_size;
+	srv_heap = dx12->srv_heap.Get();
+
+	GPU_PROFILE_ZONE(&(dx12->gpu_timings), command_list, "main pass");
+
+	//
+	// Get the RTV and DSV for the current back buffer.
+	//
+
+	rtv_handle.InitOffsetted(
+		rtv_heap->GetCPUDescriptorHandleForHeapStart(),
+		frame_index,
+		rtv_descriptor_size
+	);
+
+	dsv_handle = app->depth_stencil_view->GetCPUDescriptorHandleForHeapStart();
 
 	//
 	// Clear the render target.
@@ -1090,7 +2969,10 @@ void populate_command_list(application* app) {
 		NULL
 	);
 
-	// Next clear the depth stencil
+	// Next clear the depth stencil. Since the depth buffer is a
+	// transient, this also matters for correctness: if it ever shares
+	// memory with another transient, its contents are garbage until
+	// it is cleared.
 	command_list->ClearDepthStencilView(
 		dsv_handle,
 		D3D12_CLEAR_FLAG_DEPTH,
@@ -1104,7 +2986,6 @@ void populate_command_list(application* app) {
 	// Prepare the rendering pipeline
 	//
 
-	command_list->SetPipelineState(app->pipeline_state.Get());
 	command_list->SetComputeRootSignature(app->root_signature.Get());
 	command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	command_list->IASetVertexBuffers(0, 1, &(app->vertex_buffer_view));
@@ -1117,57 +2998,245 @@ void populate_command_list(application* app) {
 		0,
 		srv_heap->GetGPUDescriptorHandleForHeapStart()
 	);
+	command_list->SetGraphicsRootShaderResourceView(
+		2,
+		app->material_buffer->GetGPUVirtualAddress()
+	);
+
+	if (app->render_constant_count > 0) {
+		if (INDIRECT_DRAWS) {
+			record_indirect_draws(app);
+		} else {
+			record_direct_draws(app);
+		}
+	}
+
+	record_sprites(app);
+}
+
+void record_direct_draws(application* app) {
+	ID3D12GraphicsCommandList* command_list;
+	uint32_t changes;
+	const render_item* item;
+	const draw_packet* draw;
+	uint32_t i;
+
+	command_list = app->dx12->command_list.Get();
 
 	//
-	// Now update our root parameters. In this case, it is just the
-	// MVP matrix.
+	// Sort the draws so the ones using the same pipeline and material
+	// are together, then record them in that order. Each only sets the
+	// state that's different from the draw before it. The constants
+	// stay in the order the draws came in, so each draw finds its
+	// slice by its index.
 	//
 
-	mvp_matrix = XMMatrixMultiply(
-		app->model_matrix,
-		app->view_matrix
-	);
+	{
+		PROFILE_ZONE("sort draws");
+		sort_render_queue(&(app->draw_queue), &(app->jobs));
+	}
 
-	mvp_matrix = XMMatrixMultiply(
-		mvp_matrix,
-		app->projection_matrix
-	);
+	for (i = 0; i < (uint32_t)app->draw_queue.items.size(); i++) {
+		item = &(app->draw_queue.items[i]);
+		draw = &(app->render_draws[item->draw]);
+		changes = get_render_state_changes(&(app->draw_queue), i);
 
-	command_list->SetGraphicsRoot32BitConstants(
-		1,
-		sizeof(XMMATRIX) / 4,
-		&mvp_matrix,
-		0
+		if (changes & RENDER_STATE_PIPELINE) {
+			command_list->SetPipelineState(app->draw_pipelines[get_render_key_pipeline(item->key)]);
+		}
+
+		if (changes & RENDER_STATE_MATERIAL) {
+			command_list->SetGraphicsRoot32BitConstant(3, draw->material, 0);
+		}
+
+		command_list->SetGraphicsRootConstantBufferView(
+			1,
+			app->render_constants.gpu_address + item->draw * app->render_constant_stride
+		);
+
+		command_list->DrawIndexedInstanced(draw->index_count, 1, draw->first_index, 0, 0);
+	}
+}
+
+void record_indirect_draws(application* app) {
+	ID3D12GraphicsCommandList* command_list;
+	ID3D12Resource* arguments;
+	UINT64 arguments_offset;
+	ID3D12Resource* count;
+	UINT64 count_offset;
+
+	command_list = app->dx12->command_list.Get();
+
+	//
+	// Every command sets its own constants and material, and they all
+	// use the same pipeline. The count says how many of them the
+	// culling wrote, so the CPU never has to know.
+	//
+
+	if (GPU_CULLING) {
+		arguments = app->indirect_commands.Get();
+		arguments_offset = 0;
+		count = app->indirect_count.Get();
+		count_offset = 0;
+	} else {
+		arguments = app->indirect_upload.Get();
+		arguments_offset = INDIRECT_UPLOAD_HEADER_SIZE + app->dx12->frame_index * INDIRECT_UPLOAD_FRAME_SIZE;
+		count = arguments;
+		count_offset = arguments_offset + INDIRECT_UPLOAD_COUNT_OFFSET;
+	}
+
+	command_list->SetPipelineState(app->draw_pipelines[DRAW_PIPELINE_TEXTURED]);
+	command_list->ExecuteIndirect(
+		app->draw_signature.Get(),
+		MAX_DRAWS_PER_FRAME,
+		arguments,
+		arguments_offset,
+		count,
+		count_offset
 	);
+}
+
+void record_sprites(application* app) {
+	ID3D12GraphicsCommandList* command_list;
+	D3D12_VERTEX_BUFFER_VIEW vbv;
+	const sprite_draw* draw;
+	uint32_t draw_count;
+	uint32_t blend;
+	uint32_t i;
+
+	PROFILE_ZONE("sprites");
+
+	command_list = app->dx12->command_list.Get();
 
 	//
-	// Now actually record the commands.
+	// The GPU is done with this back buffer's region of the vertex
+	// buffer, so the quads can go straight in.
 	//
 
+	draw_count = build_sprite_batch(&(app->sprites), app->dx12->frame_index);
+	if (draw_count == 0) {
+		return;
+	}
+
+	vbv = {};
+	vbv.BufferLocation =
+		app->sprite_vertices->GetGPUVirtualAddress() +
+		get_sprite_frame_offset(&(app->sprites), app->dx12->frame_index);
+	vbv.StrideInBytes = sizeof(sprite_vertex);
+	vbv.SizeInBytes = (UINT)get_sprite_vertex_buffer_size(MAX_SPRITES_PER_FRAME, 1);
 
-	// Draw the cube.
-	command_list->DrawIndexedInstanced(36, 1, 0, 0, 0);
+	command_list->IASetVertexBuffers(0, 1, &vbv);
+	command_list->IASetIndexBuffer(&(app->sprite_index_view));
 
 	//
-	// Once our commands are done, close the command list.
+	// Only a change of blend mode needs a new pipeline state. The root
+	// signature, and with it the texture array, stay as they are.
 	//
 
-	barrier_present = CD3DX12_RESOURCE_BARRIER::Transition(
-		back_buffer.Get(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET,
-		D3D12_RESOURCE_STATE_PRESENT
-	);
+	blend = SPRITE_BLEND_COUNT;
 
-	command_list->ResourceBarrier(1, &barrier_present);
+	for (i = 0; i < draw_count; i++) {
+		draw = &(app->sprites.draws[i]);
 
-	result = command_list->Close();
-	throw_if_failed(result);
+		if (draw->blend != blend) {
+			blend = draw->blend;
+			command_list->SetPipelineState(app->sprite_pipelines[blend].Get());
+		}
+
+		command_list->DrawIndexedInstanced(draw->index_count, 1, 0, draw->base_vertex, 0);
+	}
 }
 
 void shutdown_application(application* app) {
+	gpu_allocator* memory;
+	size_t i;
+
+	stop_simulation(&(app->sim));
+
+	//
+	// Let the render thread finish whatever it has, then stop it.
+	//
+
+	if (app->render_thread.joinable()) {
+		write_render_packet(&(app->render_commands), RENDER_PACKET_QUIT, NULL, 0);
+		app->render_thread.join();
+
+		cout << get_frame_arena_report(&(app->render_arena));
+		cout << get_constant_allocator_report(&(app->constants));
+		cout << get_render_queue_report(&(app->draw_queue));
+		cout << get_material_registry_report(&(app->materials));
+		cout << get_atlas_allocator_report(&(app->atlas));
+		cout << get_sprite_batcher_report(&(app->sprites));
+	}
+
 	if (app->dx12) {
 		shutdown_directx_12(app->dx12);
+
+		//
+		// The GPU is idle now. Release everything placed in the dx12
+		// handler's heaps before the heaps themselves go away.
+		//
+
+		memory = &(app->dx12->memory);
+
+		app->depth_buffer.Reset();
+		for (i = 0; i < app->transient_resources.size(); i++) {
+			app->transient_resources[i].Reset();
+		}
+		free_gpu_memory(memory, &(app->transient_memory));
+
+		remove_material_texture(&(app->materials), app->texture.Get());
+		unregister_resource(&(app->dx12->resource_states), app->texture.Get());
+		app->texture.Reset();
+		free_gpu_memory(memory, &(app->texture_memory));
+
+		if (app->constant_buffer) {
+			app->constant_buffer->Unmap(0, NULL);
+			app->constant_buffer.Reset();
+		}
+		free_gpu_memory(memory, &(app->constant_buffer_memory));
+
+		if (app->material_buffer) {
+			app->material_buffer->Unmap(0, NULL);
+			app->material_buffer.Reset();
+		}
+		free_gpu_memory(memory, &(app->material_buffer_memory));
+
+		if (app->sprite_vertices) {
+			app->sprite_vertices->Unmap(0, NULL);
+			app->sprite_vertices.Reset();
+		}
+		free_gpu_memory(memory, &(app->sprite_vertex_memory));
+		app->sprite_indices.Reset();
+		free_gpu_memory(memory, &(app->sprite_index_memory));
+
+		if (app->object_buffer) {
+			app->object_buffer->Unmap(0, NULL);
+			app->object_buffer.Reset();
+		}
+		free_gpu_memory(memory, &(app->object_buffer_memory));
+		if (app->indirect_upload) {
+			app->indirect_upload->Unmap(0, NULL);
+			app->indirect_upload.Reset();
+		}
+		free_gpu_memory(memory, &(app->indirect_upload_memory));
+		app->indirect_commands.Reset();
+		free_gpu_memory(memory, &(app->indirect_commands_memory));
+		app->indirect_count.Reset();
+		free_gpu_memory(memory, &(app->indirect_count_memory));
+
+		app->vertex_buffer.Reset();
+		free_gpu_memory(memory, &(app->vertex_buffer_memory));
+		app->index_buffer.Reset();
+		free_gpu_memory(memory, &(app->index_buffer_memory));
+
 		delete app->dx12;
 		app->dx12 = NULL;
 	}
+
+	close_shader_archive(&(app->shader_pack));
+	close_asset_archive(&(app->asset_pack));
+	shutdown_io_queue(&(app->io));
+	shutdown_texture_cache(&(app->textures));
+	shutdown_job_system(&(app->jobs));
 }
\ No newline at end of file
@@ -9,7 +9,28 @@
 
 #pragma once
 
+#include "alloc_tracker.h"
+#include "asset_archive.h"
+#include "constant_allocator.h"
 #include "dx12_handler.h"
+#include "frame_arena.h"
+#include "frame_pacer.h"
+#include "gpu_culling.h"
+#include "io_queue.h"
+#include "job_system.h"
+#include "lod_selector.h"
+#include "material_registry.h"
+#include "mesh_simplifier.h"
+#include "occlusion_culler.h"
+#include "render_queue.h"
+#include "render_ring.h"
+#include "shader_archive.h"
+#include "shader_cache.h"
+#include "simulation.h"
+#include "sprite_batcher.h"
+#include "task_graph.h"
+#include "texture_atlas.h"
+#include "texture_cache.h"
 
 using namespace DirectX;
 using namespace std;
@@ -18,6 +39,75 @@ const UINT TEXTURE_W = 256;
 const UINT TEXTURE_H = 256;
 // Num bytes per pixel.
 const UINT TEXTURE_PIXEL_SIZE = 4;
+// The cube goes from -1 to 1 on each axis, so this is the radius of a
+// sphere around it.
+const float CUBE_RADIUS = 1.7320508f;
+// Small images share atlas pages this big, instead of having a texture
+// each. The cube's texture is one of them.
+const UINT ATLAS_PAGE_SIZE = 1024;
+// Texels of gutter around each image on the page.
+const uint32_t ATLAS_PADDING = 1;
+
+// Frame pacing. A frame rate limit of 0 means no limit. Tearing only
+// happens with vsync off, and only if the display supports it.
+const uint32_t MAX_FRAME_LATENCY = 2;
+const bool VSYNC = true;
+const bool ALLOW_TEARING = true;
+const uint32_t FRAME_RATE_LIMIT = 0;
+
+// The game logic runs at this fixed rate on its own thread, however
+// fast we render.
+const uint32_t SIMULATION_RATE = 60;
+// Buttons the simulation knows about, as bits in its input.
+const uint32_t SIM_INPUT_SPIN_LEFT = 1 << 0;
+const uint32_t SIM_INPUT_SPIN_RIGHT = 1 << 1;
+// How fast the arrow keys spin the cube, in degrees a second.
+const float CUBE_SPIN_SPEED = 90.0f;
+
+// The main thread hands each frame to the render thread as packets in
+// a ring this big, and can get at most MAX_QUEUED_FRAMES ahead of it.
+const uint64_t RENDER_RING_SIZE = 256 * 1024;
+const uint32_t MAX_QUEUED_FRAMES = 1;
+// The render thread's per-frame memory. It grows if a frame needs more.
+const size_t RENDER_ARENA_SIZE = 64 * 1024;
+// Each draw's constants take a 256 byte slice of the constant buffer,
+// which has room for this many draws a frame.
+const uint32_t MAX_DRAWS_PER_FRAME = 4096;
+// Whether draws go through one ExecuteIndirect, with their commands
+// written by a compute shader that frustum culls them, instead of a
+// DrawIndexedInstanced each from the CPU. With GPU_CULLING off, the
+// CPU does the same culling and writes the commands itself.
+const bool INDIRECT_DRAWS = true;
+const bool GPU_CULLING = true;
+// How indirect_upload is laid out: the zero that resets the draw count,
+// then a region for each back buffer with room for a command per draw
+// and, after them, the count.
+const UINT64 INDIRECT_UPLOAD_HEADER_SIZE = 256;
+const UINT64 INDIRECT_UPLOAD_COUNT_OFFSET = MAX_DRAWS_PER_FRAME * sizeof(indirect_command);
+const UINT64 INDIRECT_UPLOAD_FRAME_SIZE = INDIRECT_UPLOAD_COUNT_OFFSET + 256;
+// Records in the material buffer.
+const uint32_t MAX_MATERIALS = 256;
+// The sprite vertex buffer has room for this many quads a frame.
+const uint32_t MAX_SPRITES_PER_FRAME = 16384;
+// The CPU occlusion buffer's size. It only has to be good enough to
+// tell what's hidden, so it's much smaller than the screen.
+const uint32_t OCCLUSION_WIDTH = 256;
+const uint32_t OCCLUSION_HEIGHT = 144;
+
+// Whether to keep each job worker on a core of its own.
+const bool PIN_JOB_THREADS = false;
+// How many file reads are kept going at once, and how big each one is.
+// A file bigger than IO_READ_SIZE is read in pieces, all at once.
+const uint32_t IO_QUEUE_DEPTH = 64;
+const uint32_t IO_READ_SIZE = 256 * 1024;
+// How much decoded texture data is kept around once nothing's using it.
+const uint64_t TEXTURE_CACHE_BUDGET = 256 * 1024 * 1024;
+
+// Pressing F9 captures this many frames of profiling to
+// PROFILE_TRACE_PATH, which can be opened in chrome://tracing or
+// ui.perfetto.dev.
+const uint32_t PROFILE_CAPTURE_FRAMES = 120;
+const char* const PROFILE_TRACE_PATH = "./profile_trace.json";
 
 // One of the things I am taking issue with this example is that the
 // input to our vertex shader here is a FLOAT3 and a FLOAT2. However,
@@ -32,6 +122,86 @@ struct vertex {
 	XMFLOAT3 position;
 	XMFLOAT2 uv;
 };
+static_assert(sizeof(vertex) == sizeof(mesh_vertex), "vertex must match mesh_vertex, for the mesh simplifier");
+
+// The pipelines draws can use, by the pipeline number in their sort
+// keys.
+enum draw_pipeline {
+	DRAW_PIPELINE_TEXTURED = 0,
+	DRAW_PIPELINE_COUNT
+};
+
+//
+// Render packets, from the main thread to the render thread. A frame
+// is a BEGIN_FRAME, any number of DRAWs and SPRITES, then an
+// END_FRAME.
+//
+
+enum render_packet_type {
+	RENDER_PACKET_BEGIN_FRAME = 1,
+	RENDER_PACKET_DRAW,
+	// Any number of sprites, one after another.
+	RENDER_PACKET_SPRITES,
+	RENDER_PACKET_END_FRAME,
+	// Tells the render thread to exit.
+	RENDER_PACKET_QUIT
+};
+
+struct begin_frame_packet {
+	XMFLOAT4X4 view_matrix;
+	XMFLOAT4X4 projection_matrix;
+	// How many draw packets follow, so the render thread can make room
+	// for them up front.
+	uint32_t draw_count;
+};
+
+struct draw_packet {
+	XMFLOAT4X4 model_matrix;
+	uint32_t index_count;
+	// Where the draw's indices start in the index buffer, so it can be
+	// any level of the mesh's LOD chain.
+	uint32_t first_index;
+	// Index into the material buffer.
+	uint32_t material;
+	// Where the draw goes in the render queue (see make_render_key).
+	// Its pipeline is a draw_pipeline.
+	uint64_t sort_key;
+	// A sphere around the mesh, in its own space, for culling: the
+	// centre, then the radius.
+	float bounds[4];
+};
+
+// What the startup tasks hand each other while the assets load.
+// What load_texture_asset gives the texture cache to decode.
+struct encoded_texture {
+	const void* data;
+	size_t size;
+};
+
+struct asset_loading {
+	vector<shader_define> shader_defines;
+	// If the shader archive has the shaders, nothing is compiled.
+	bool shaders_from_archive;
+	shader_bytecode shader_bytecodes[2];
+	D3D12_SHADER_BYTECODE vertex_shader;
+	D3D12_SHADER_BYTECODE pixel_shader;
+	// The same again for the sprite shaders.
+	bool sprite_shaders_from_archive;
+	shader_bytecode sprite_bytecodes[2];
+	D3D12_SHADER_BYTECODE sprite_vertex_shader;
+	D3D12_SHADER_BYTECODE sprite_pixel_shader;
+	// And the culling shader.
+	bool cull_shader_from_archive;
+	shader_bytecode cull_bytecode;
+	D3D12_SHADER_BYTECODE cull_shader;
+
+	vector<UINT8> texture_data;
+	// The atlas page, with the texture copied onto it.
+	vector<UINT8> atlas_data;
+	// Has to stay around until the GPU has done the copy.
+	ComPtr<ID3D12Resource> texture_upload_heap;
+	gpu_allocation texture_upload_memory;
+};
 
 struct application {
 	uint32_t screen_w;
@@ -42,36 +212,183 @@ struct application {
 
 	float clear_color[4];
 
+	// Caps the frame rate and records frame times.
+	frame_pacer pacer;
+
+	// Worker threads for anything that can be split up. The main
+	// thread is worker 0, and helps out whenever it waits on jobs.
+	job_system jobs;
+	// Reads files, many at once, on a thread of its own.
+	io_queue io;
+	// Decoded textures, so one that's asked for again isn't decoded
+	// again.
+	texture_cache textures;
+	// Only set while load_assets runs.
+	asset_loading* loading;
+
 	// Resources to render the cube.
 	ComPtr<ID3D12Resource> vertex_buffer;
 	D3D12_VERTEX_BUFFER_VIEW vertex_buffer_view;
 	ComPtr<ID3D12Resource> index_buffer;
 	D3D12_INDEX_BUFFER_VIEW index_buffer_view;
+	// The cube's levels of detail. Their indices are what's in the
+	// index buffer.
+	lod_chain cube_lods;
+	// Which level each cube is drawn with. There's only the one cube.
+	lod_group cube_instances;
+	// The atlas page the cube's texture is on.
 	ComPtr<ID3D12Resource> texture;
+	// Where the above live in the dx12 handler's GPU memory.
+	gpu_allocation vertex_buffer_memory;
+	gpu_allocation index_buffer_memory;
+	gpu_allocation texture_memory;
+	// Where everything is on the atlas page.
+	atlas_allocator atlas;
+	atlas_rect cube_image;
+
+	// Per-draw constants, written by the render thread each frame. The
+	// buffer stays mapped, and has a region for each back buffer.
+	ComPtr<ID3D12Resource> constant_buffer;
+	gpu_allocation constant_buffer_memory;
+	constant_allocator constants;
 
-	// Game-logic resources.
-	double angle;
+	// Every material's parameters and texture slots. The registry's
+	// records are copied into material_buffer, which stays mapped, and
+	// shaders index it with each draw's material.
+	material_registry materials;
+	ComPtr<ID3D12Resource> material_buffer;
+	gpu_allocation material_buffer_memory;
+	UINT8* mapped_materials;
+	uint32_t cube_material;
 
-	// Camera resources
+	// Game-logic resources. The simulation owns the world and steps
+	// it on its own thread. drawn_world is what this frame draws,
+	// blended from the simulation's two latest snapshots.
+	simulation sim;
+	sim_snapshot drawn_world;
+
+	// Camera resources. These belong to the main thread.
 	XMMATRIX model_matrix;
 	XMMATRIX view_matrix;
 	XMMATRIX projection_matrix;
 	float field_of_view;
+	// Where LODs are picked from this frame, and how.
+	lod_view lod_camera;
+	lod_selection_options lod_options;
+	// Big, simple meshes that hide what's behind them, drawn into
+	// occlusion each frame. There aren't any in the scene yet, so
+	// nothing is ever hidden.
+	vector<occluder_mesh> occluders;
+	occlusion_buffer occlusion;
+	bool cube_visible;
+
+	// The main thread decides what to draw and sends it to the render
+	// thread through this ring. The render thread records the command
+	// list and presents, so neither waits on the other's work.
+	render_ring render_commands;
+	thread render_thread;
+
+	// What the render thread is drawing this frame, from the packets.
+	// Only the render thread touches these. The draws live in
+	// render_arena, which is emptied at the start of each frame.
+	// draw_queue has each draw's sort key, and puts them in the order
+	// they're recorded in.
+	XMMATRIX render_view_matrix;
+	XMMATRIX render_projection_matrix;
+	frame_arena render_arena;
+	draw_packet* render_draws;
+	uint32_t render_draw_count;
+	uint32_t render_draw_capacity;
+	render_queue draw_queue;
+	// This frame's per-draw constants, one slice per draw in the order
+	// they came in. Written before the frame graph runs, since the
+	// culling pass needs their addresses too.
+	constant_slice render_constants;
+	uint64_t render_constant_stride;
+	uint32_t render_constant_count;
+
+	// Indirect draws. The render thread writes each frame's draws into
+	// object_buffer, which stays mapped and has a region for each back
+	// buffer. The culling pass reads them, writes a command for each
+	// visible one into indirect_commands and counts them in
+	// indirect_count, and the main pass draws them all with one
+	// ExecuteIndirect through draw_signature.
+	//
+	// indirect_upload starts with a zero, copied over indirect_count
+	// before each culling pass. With GPU_CULLING off, it also has a
+	// region for each back buffer where the CPU writes the commands
+	// and count instead.
+	ComPtr<ID3D12Resource> object_buffer;
+	gpu_allocation object_buffer_memory;
+	UINT8* mapped_objects;
+	ComPtr<ID3D12Resource> indirect_commands;
+	gpu_allocation indirect_commands_memory;
+	ComPtr<ID3D12Resource> indirect_count;
+	gpu_allocation indirect_count_memory;
+	ComPtr<ID3D12Resource> indirect_upload;
+	gpu_allocation indirect_upload_memory;
+	UINT8* mapped_indirect_upload;
+	ComPtr<ID3D12RootSignature> cull_root_signature;
+	ComPtr<ID3D12PipelineState> cull_pipeline;
+	ComPtr<ID3D12CommandSignature> draw_signature;
+	// This frame's culling pass's root constants.
+	culling_constants culling;
+
+	// Sprites are batched by the render thread into sprite_vertices,
+	// which stays mapped and has a region for each back buffer. Every
+	// batch shares the indices in sprite_indices. There's a pipeline
+	// for each blend mode.
+	sprite_batcher sprites;
+	ComPtr<ID3D12Resource> sprite_vertices;
+	gpu_allocation sprite_vertex_memory;
+	ComPtr<ID3D12Resource> sprite_indices;
+	gpu_allocation sprite_index_memory;
+	D3D12_INDEX_BUFFER_VIEW sprite_index_view;
+	ComPtr<ID3D12PipelineState> sprite_pipelines[SPRITE_BLEND_COUNT];
+	// Shows the cube's texture in the corner of the screen.
+	sprite overlay_sprite;
+
+	// Heap allocations made each frame by the main and render threads.
+	// Once they're warmed up, these should stay at zero.
+	alloc_frame_stats main_allocs;
+	alloc_frame_stats render_allocs;
 
 	// This describes the various parameters passed to the
 	// different stages of the shader pipeline.
 	ComPtr<ID3D12RootSignature> root_signature;
 
+	// Compiled shaders are kept on disk between runs so we don't
+	// have to compile them at every start up.
+	shader_cache shaders;
+	// Shaders compiled offline by tools/build_shaders.sh. If this is
+	// missing, everything comes from the shader cache instead.
+	shader_archive shader_pack;
+	// assets/, packed by tools/build_assets.sh. If this is missing, the
+	// assets are loaded from their own files instead.
+	asset_archive asset_pack;
+
 	// This describes all the state information for the rendering
 	// pipeline. This would be things like the root signature, the
 	// vertex shader, and the pixel shader.
 	ComPtr<ID3D12PipelineState> pipeline_state;
+	// The same, by draw_pipeline. Borrowed from the ComPtrs above.
+	ID3D12PipelineState* draw_pipelines[DRAW_PIPELINE_COUNT];
 
 	// Needed for rasterizer state
 	CD3DX12_VIEWPORT viewport;
 	CD3DX12_RECT scissor_rect;
 
-	// Needed for the depth buffer.
+	// The frame graph describes the passes that make up a frame. Its
+	// transient resources all live in transient_memory.
+	frame_graph graph;
+	gpu_allocation transient_memory;
+	vector<ComPtr<ID3D12Resource>> transient_resources;
+	frame_graph_resource depth_target;
+	frame_graph_resource indirect_commands_target;
+	frame_graph_resource indirect_count_target;
+
+	// Needed for the depth buffer. The depth buffer is a transient in
+	// the frame graph.
 	ComPtr<ID3D12Resource> depth_buffer;
 	ComPtr<ID3D12DescriptorHeap> depth_stencil_view;
 };
@@ -84,28 +401,163 @@ bool initialize_application(
 	const bool use_warp
 );
 
+// Loads everything as a graph of startup tasks, so the steps that
+// don't depend on each other run at the same time, then waits on the
+// GPU once for all of it.
 void load_assets(application* app);
+// The startup tasks. Each takes the application, and they hand each
+// other what they make through app->loading.
+void create_root_signature_task(void* data);
+void compile_vertex_shader_task(void* data);
+void compile_pixel_shader_task(void* data);
+void create_pipeline_state_task(void* data);
+void decode_texture_task(void* data);
+void create_constant_buffer_task(void* data);
+void create_cube_task(void* data);
+void upload_texture_task(void* data);
+void create_materials_task(void* data);
+void compile_sprite_vertex_shader_task(void* data);
+void compile_sprite_pixel_shader_task(void* data);
+void create_sprite_pipelines_task(void* data);
+void create_sprite_buffers_task(void* data);
+void compile_cull_shader_task(void* data);
+void create_cull_pipeline_task(void* data);
+void create_indirect_buffers_task(void* data);
+void create_frame_graph_task(void* data);
+void create_depth_view_task(void* data);
+
 ComPtr<ID3D12RootSignature> initialize_root_signature(application* app);
+// Loads a vertex (index 0), pixel (index 1) or compute (index 2)
+// shader from the shader cache, compiling it if it has to.
+void load_shader_stage(
+	application* app,
+	const char* source_path,
+	const uint32_t index,
+	const vector<shader_define>& defines,
+	shader_bytecode* bytecode
+);
+// Loads one of the cube's shaders.
+void load_cube_shader(application* app, const uint32_t index);
+// Loads one of the sprite shaders.
+void load_sprite_shader(application* app, const uint32_t index);
+// Loads the culling shader.
+void load_cull_shader(application* app);
 ComPtr<ID3D12PipelineState> initialize_pipeline_state(application* app);
-// Initializes the buffers needed for the cube we draw.
+// Creates a pipeline state for each sprite blend mode.
+void initialize_sprite_pipelines(application* app);
+// Creates the culling pass's root signature and pipeline state, and
+// the command signature ExecuteIndirect draws through.
+void initialize_cull_pipeline(application* app);
+// Whether the device can run the offline shader archive's shaders.
+bool can_use_shader_archive(application* app);
+// Looks for a file's vertex and pixel shaders in the offline shader
+// archive. Returns false if the archive doesn't have both of them, or
+// they were packed from a different version of the source.
+bool find_shaders_in_archive(
+	application* app,
+	const char* source_file,
+	const vector<shader_define>& defines,
+	D3D12_SHADER_BYTECODE* vertex_shader,
+	D3D12_SHADER_BYTECODE* pixel_shader
+);
+// The same for a file's compute shader.
+bool find_compute_shader_in_archive(
+	application* app,
+	const char* source_file,
+	const vector<shader_define>& defines,
+	D3D12_SHADER_BYTECODE* compute_shader
+);
+// Compiles a shader with the D3D compiler. This is what the shader
+// cache calls when it doesn't already have the shader.
+bool compile_shader_from_file(
+	const shader_compile_request& request,
+	vector<uint8_t>* bytecode,
+	string* errors
+);
+// Creates and maps the upload buffer the per-draw constants go in.
+void initialize_constant_buffer(application* app);
+// Initializes the buffers needed for the cube we draw, and builds its
+// LOD chain.
 void initialize_cube(application* app);
+// Creates the sprite vertex and index buffers, and sets up the
+// batcher.
+void initialize_sprite_buffers(application* app);
+// Creates the buffers for indirect draws.
+void initialize_indirect_buffers(application* app);
 void upload_buffer_data(
-	ComPtr<ID3D12Device> dev,
+	gpu_allocator* allocator,
 	void* buffer_data,
 	const UINT buffer_size,
-	ID3D12Resource** resource_buffer
+	ID3D12Resource** resource_buffer,
+	gpu_allocation* buffer_memory
 );
+// Creates the texture and records copying app->loading's texture data
+// into it. The copy happens when load_assets submits the command list.
 void create_texture(application* app);
+// Creates the material buffer and the cube's material. Needs the
+// texture to be in the material registry already.
+void initialize_materials(application* app);
 vector<UINT8> generate_texture_data();
-vector<UINT8> load_texture_from_file(const std::wstring& file_path);
+// Reads all of file_path through app->io.
+vector<UINT8> read_file(application* app, const std::string& file_path);
+vector<UINT8> load_texture_from_memory(const void* data, const size_t size);
+// A texture_decode_function, for an encoded_texture.
+bool decode_texture(void* data, vector<uint8_t>* pixels);
+// Returns name from app->textures, loading it from the asset archive if
+// it's in there, or from assets/name if it isn't, and decoding it if
+// the cache doesn't have it. Release it when done with it.
+texture_cache_entry* load_texture_asset(application* app, const std::string& name);
+// Builds, compiles, and creates the resources for the frame graph.
+void initialize_frame_graph(application* app);
 void initialize_depth_buffer(application* app);
 
 void frame(application* app);
 
+// Sets up the world the simulation starts with: the cube and the
+// camera.
+void initialize_world(application* app, sim_snapshot* world);
+// The simulation's step function. Spins the cube while an arrow key
+// is held.
+void step_world(
+	sim_snapshot* world,
+	const uint32_t input,
+	const double step_seconds,
+	void* user_data
+);
+// Which simulation buttons a key maps to, if any.
+uint32_t get_simulation_buttons(const WPARAM key);
+
+// Builds the matrices for this frame from the simulation, and picks
+// the level of detail everything is drawn with.
 void update(application* app);
+// Sends this frame to the render thread.
+void submit_frame(application* app);
 
+// The render thread. Turns render packets into frames until it gets a
+// RENDER_PACKET_QUIT.
+void run_render_thread(application* app);
+// Records, submits and presents a frame. Render thread only.
 void render(application* app);
 // Sets up the dx12 handler's command list for rendering.
 void populate_command_list(application* app);
+// Writes this frame's per-draw constants and, for indirect draws, its
+// objects and culling constants. With GPU_CULLING off, this is also
+// where the CPU culls them.
+void prepare_draws(application* app);
+// The frame graph's passes for indirect draws: zero the draw count,
+// then cull the objects into commands.
+void record_clear_draw_count_pass(void* user_data);
+void record_cull_pass(void* user_data);
+// The frame graph's main pass: clears the targets, draws the cube, then
+// the sprites.
+void record_main_pass(void* user_data);
+// Records this frame's draws, one DrawIndexedInstanced each. Part of
+// the main pass.
+void record_direct_draws(application* app);
+// Records this frame's draws with one ExecuteIndirect. Part of the main
+// pass.
+void record_indirect_draws(application* app);
+// Batches this frame's sprites and draws them. Part of the main pass.
+void record_sprites(application* app);
 
 void shutdown_application(application* app);
@@ -0,0 +1,575 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "asset_archive.h"
+#include "hash_utils.h"
+#include "job_system.h"
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+// An input's place once they're sorted by hash.
+struct sorted_input {
+	uint64_t name_hash;
+	uint32_t input;
+};
+
+// A chunk of an input, as it'll be written.
+struct packed_chunk {
+	uint32_t input;
+	uint64_t source_offset;
+	uint32_t size;
+	// Compressed, or the chunk as it was if that didn't make it smaller.
+	vector<uint8_t> data;
+};
+
+struct compress_chunks_job {
+	const vector<asset_archive_input>* inputs;
+	packed_chunk* chunks;
+};
+
+struct decompress_chunks_job {
+	const asset_archive* archive;
+	const asset_archive_entry* entry;
+	uint8_t* destination;
+	atomic<uint32_t> failures;
+};
+
+static bool compare_sorted_inputs(const sorted_input& a, const sorted_input& b);
+static bool compare_entry_hash(const asset_archive_entry& entry, const uint64_t name_hash);
+static bool read_chunk(const asset_archive* archive, const asset_archive_chunk* chunk, uint8_t* destination);
+static void compress_chunks(const uint32_t begin, const uint32_t end, void* data);
+static void decompress_chunks(const uint32_t begin, const uint32_t end, void* data);
+static uint64_t align_asset_offset(const uint64_t offset);
+
+asset_archive::asset_archive() {
+	header = NULL;
+	entries = NULL;
+	chunks = NULL;
+}
+
+uint64_t get_asset_name_hash(const string& name) {
+	string normalized;
+	size_t start;
+	size_t i;
+	char c;
+
+	start = 0;
+	while (name.compare(start, 2, "./") == 0 || name.compare(start, 2, ".\\") == 0) {
+		start += 2;
+	}
+
+	normalized.reserve(name.size() - start);
+
+	for (i = start; i < name.size(); i++) {
+		c = name[i];
+
+		if (c == '\\') {
+			c = '/';
+		} else if (c >= 'A' && c <= 'Z') {
+			c = (char)(c - 'A' + 'a');
+		}
+
+		normalized.push_back(c);
+	}
+
+	return hash_string(normalized);
+}
+
+bool open_asset_archive(asset_archive* archive, const string& path) {
+	const asset_archive_header* header;
+	const asset_archive_entry* entries;
+	const asset_archive_entry* entry;
+	const asset_archive_chunk* chunks;
+	const asset_archive_chunk* chunk;
+	uint64_t table_end;
+	uint64_t file_size;
+	uint64_t remaining;
+	uint32_t i;
+	uint32_t j;
+
+	archive->header = NULL;
+	archive->entries = NULL;
+	archive->chunks = NULL;
+
+	if (!open_mapped_file(&(archive->file), path)) {
+		return false;
+	}
+
+	//
+	// Check the header, then that the tables and everything they point
+	// at lie inside the file, and that each compressed asset's chunks
+	// add up to it. After this, reading can trust all of it.
+	//
+
+	file_size = archive->file.size;
+	header = (const asset_archive_header*)archive->file.data;
+
+	if (file_size < sizeof(asset_archive_header) ||
+		header->magic != ASSET_ARCHIVE_MAGIC ||
+		header->version != ASSET_ARCHIVE_VERSION ||
+		header->chunk_size == 0)
+	{
+		close_asset_archive(archive);
+		return false;
+	}
+
+	table_end = sizeof(asset_archive_header) +
+		(uint64_t)header->entry_count * sizeof(asset_archive_entry) +
+		(uint64_t)header->chunk_count * sizeof(asset_archive_chunk);
+
+	if (table_end > file_size) {
+		close_asset_archive(archive);
+		return false;
+	}
+
+	entries = (const asset_archive_entry*)(header + 1);
+	chunks = (const asset_archive_chunk*)(entries + header->entry_count);
+
+	for (i = 0; i < header->chunk_count; i++) {
+		chunk = &chunks[i];
+
+		if (chunk->offset > file_size ||
+			chunk->compressed_size > file_size - chunk->offset ||
+			chunk->compressed_size > chunk->size ||
+			chunk->size > header->chunk_size)
+		{
+			close_asset_archive(archive);
+			return false;
+		}
+	}
+
+	for (i = 0; i < header->entry_count; i++) {
+		entry = &entries[i];
+
+		if (i > 0 && entries[i - 1].name_hash >= entry->name_hash) {
+			close_asset_archive(archive);
+			return false;
+		}
+
+		if (entry->chunk_count == 0) {
+			if (entry->offset > file_size || entry->size > file_size - entry->offset) {
+				close_asset_archive(archive);
+				return false;
+			}
+
+			continue;
+		}
+
+		if ((uint64_t)entry->first_chunk + entry->chunk_count > header->chunk_count ||
+			(entry->size + header->chunk_size - 1) / header->chunk_size != entry->chunk_count)
+		{
+			close_asset_archive(archive);
+			return false;
+		}
+
+		remaining = entry->size;
+
+		for (j = 0; j < entry->chunk_count; j++) {
+			if (chunks[entry->first_chunk + j].size != min(remaining, (uint64_t)header->chunk_size)) {
+				close_asset_archive(archive);
+				return false;
+			}
+
+			remaining -= chunks[entry->first_chunk + j].size;
+		}
+	}
+
+	archive->header = header;
+	archive->entries = entries;
+	archive->chunks = chunks;
+
+	return true;
+}
+
+const asset_archive_entry* find_asset(const asset_archive* archive, const string& name) {
+	const asset_archive_entry* begin;
+	const asset_archive_entry* end;
+	const asset_archive_entry* entry;
+	uint64_t name_hash;
+
+	if (!archive->header) {
+		return NULL;
+	}
+
+	//
+	// The entries are sorted by hash, so a binary search finds it.
+	//
+
+	name_hash = get_asset_name_hash(name);
+	begin = archive->entries;
+	end = begin + archive->header->entry_count;
+	entry = lower_bound(begin, end, name_hash, compare_entry_hash);
+
+	if (entry == end || entry->name_hash != name_hash) {
+		return NULL;
+	}
+
+	return entry;
+}
+
+bool is_asset_stored(const asset_archive_entry* entry) {
+	return entry->chunk_count == 0;
+}
+
+const void* get_mapped_asset(const asset_archive* archive, const asset_archive_entry* entry) {
+	if (!is_asset_stored(entry)) {
+		return NULL;
+	}
+
+	return archive->file.data + entry->offset;
+}
+
+bool read_asset(
+	job_system* jobs,
+	const asset_archive* archive,
+	const asset_archive_entry* entry,
+	void* destination
+) {
+	decompress_chunks_job job;
+
+	if (is_asset_stored(entry)) {
+		if (entry->size > 0) {
+			memcpy(destination, archive->file.data + entry->offset, (size_t)entry->size);
+		}
+
+		return true;
+	}
+
+	job.archive = archive;
+	job.entry = entry;
+	job.destination = (uint8_t*)destination;
+	job.failures = 0;
+
+	// A chunk at a time. Each is 64KB, which is plenty to be worth
+	// handing to another worker.
+	if (jobs && entry->chunk_count > 1) {
+		parallel_for(jobs, entry->chunk_count, 1, decompress_chunks, &job);
+	} else {
+		decompress_chunks(0, entry->chunk_count, &job);
+	}
+
+	return job.failures == 0;
+}
+
+void close_asset_archive(asset_archive* archive) {
+	close_mapped_file(&(archive->file));
+	archive->header = NULL;
+	archive->entries = NULL;
+	archive->chunks = NULL;
+}
+
+bool write_asset_archive(
+	job_system* jobs,
+	const string& path,
+	const vector<asset_archive_input>& inputs
+) {
+	asset_archive_header header;
+	vector<sorted_input> order;
+	vector<asset_archive_entry> entries;
+	vector<packed_chunk> chunks;
+	vector<asset_archive_chunk> table;
+	vector<const packed_chunk*> table_chunks;
+	compress_chunks_job job;
+	const asset_archive_input* input;
+	asset_archive_entry* entry;
+	packed_chunk chunk;
+	uint64_t offset;
+	uint64_t compressed_size;
+	uint32_t first_chunk;
+	ofstream file;
+	const char padding[ASSET_ARCHIVE_ALIGNMENT] = {};
+	size_t i;
+	size_t j;
+
+	//
+	// Sort the inputs by their names' hashes, which have to be unique.
+	//
+
+	order.resize(inputs.size());
+
+	for (i = 0; i < inputs.size(); i++) {
+		order[i].name_hash = get_asset_name_hash(inputs[i].name);
+		order[i].input = (uint32_t)i;
+	}
+
+	sort(order.begin(), order.end(), compare_sorted_inputs);
+
+	for (i = 1; i < order.size(); i++) {
+		if (order[i - 1].name_hash == order[i].name_hash) {
+			return false;
+		}
+	}
+
+	//
+	// Cut everything that might compress into chunks, and compress them
+	// all at once.
+	//
+
+	entries.resize(inputs.size());
+
+	for (i = 0; i < order.size(); i++) {
+		input = &inputs[order[i].input];
+		entry = &entries[i];
+
+		*entry = {};
+		entry->name_hash = order[i].name_hash;
+		entry->size = input->data.size();
+
+		if (!input->compress) {
+			continue;
+		}
+
+		entry->first_chunk = (uint32_t)chunks.size();
+
+		for (offset = 0; offset < entry->size; offset += ASSET_CHUNK_SIZE) {
+			chunk.input = order[i].input;
+			chunk.source_offset = offset;
+			chunk.size = (uint32_t)min((uint64_t)ASSET_CHUNK_SIZE, entry->size - offset);
+			chunks.push_back(chunk);
+			entry->chunk_count++;
+		}
+	}
+
+	job.inputs = &inputs;
+	job.chunks = chunks.data();
+
+	if (jobs) {
+		parallel_for(jobs, (uint32_t)chunks.size(), 1, compress_chunks, &job);
+	} else {
+		compress_chunks(0, (uint32_t)chunks.size(), &job);
+	}
+
+	//
+	// Anything that didn't shrink by at least a sixteenth is stored
+	// instead, since then it can be mapped rather than copied.
+	//
+
+	for (i = 0; i < entries.size(); i++) {
+		entry = &entries[i];
+
+		if (entry->chunk_count == 0) {
+			continue;
+		}
+
+		compressed_size = 0;
+		for (j = 0; j < entry->chunk_count; j++) {
+			compressed_size += chunks[entry->first_chunk + j].data.size();
+		}
+
+		first_chunk = entry->first_chunk;
+		entry->first_chunk = 0;
+
+		if (compressed_size >= entry->size - entry->size / 16) {
+			entry->chunk_count = 0;
+			continue;
+		}
+
+		entry->first_chunk = (uint32_t)table.size();
+
+		for (j = 0; j < entry->chunk_count; j++) {
+			table.push_back({ 0, (uint32_t)chunks[first_chunk + j].data.size(), chunks[first_chunk + j].size });
+			table_chunks.push_back(&chunks[first_chunk + j]);
+		}
+	}
+
+	//
+	// Lay everything out after the tables, in the same order as the
+	// entries.
+	//
+
+	header = {};
+	header.magic = ASSET_ARCHIVE_MAGIC;
+	header.version = ASSET_ARCHIVE_VERSION;
+	header.entry_count = (uint32_t)entries.size();
+	header.chunk_count = (uint32_t)table.size();
+	header.chunk_size = ASSET_CHUNK_SIZE;
+
+	offset = sizeof(header) +
+		entries.size() * sizeof(asset_archive_entry) +
+		table.size() * sizeof(asset_archive_chunk);
+
+	for (i = 0; i < entries.size(); i++) {
+		entry = &entries[i];
+
+		if (entry->chunk_count == 0) {
+			offset = align_asset_offset(offset);
+			entry->offset = offset;
+			offset += entry->size;
+			continue;
+		}
+
+		for (j = 0; j < entry->chunk_count; j++) {
+			table[entry->first_chunk + j].offset = offset;
+			offset += table[entry->first_chunk + j].compressed_size;
+		}
+	}
+
+	//
+	// Now write it all out.
+	//
+
+	file.open(path, ios::out | ios::binary | ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)entries.data(), entries.size() * sizeof(asset_archive_entry));
+	file.write((const char*)table.data(), table.size() * sizeof(asset_archive_chunk));
+
+	offset = sizeof(header) +
+		entries.size() * sizeof(asset_archive_entry) +
+		table.size() * sizeof(asset_archive_chunk);
+
+	for (i = 0; i < entries.size(); i++) {
+		entry = &entries[i];
+
+		if (entry->chunk_count == 0) {
+			input = &inputs[order[i].input];
+
+			file.write(padding, entry->offset - offset);
+			file.write((const char*)input->data.data(), input->data.size());
+			offset = entry->offset + entry->size;
+			continue;
+		}
+
+		for (j = 0; j < entry->chunk_count; j++) {
+			file.write(
+				(const char*)table_chunks[entry->first_chunk + j]->data.data(),
+				table_chunks[entry->first_chunk + j]->data.size()
+			);
+			offset += table[entry->first_chunk + j].compressed_size;
+		}
+	}
+
+	file.close();
+
+	return !file.fail();
+}
+
+string get_asset_archive_report(const asset_archive* archive) {
+	const asset_archive_entry* entry;
+	uint64_t stored_bytes;
+	uint64_t compressed_bytes;
+	uint64_t unpacked_bytes;
+	uint32_t stored;
+	uint32_t i;
+	char line[256];
+
+	if (!archive->header) {
+		return "Asset archive: not open\n";
+	}
+
+	stored = 0;
+	stored_bytes = 0;
+	compressed_bytes = 0;
+	unpacked_bytes = 0;
+
+	for (i = 0; i < archive->header->entry_count; i++) {
+		entry = &(archive->entries[i]);
+
+		if (is_asset_stored(entry)) {
+			stored++;
+			stored_bytes += entry->size;
+		} else {
+			unpacked_bytes += entry->size;
+		}
+	}
+
+	for (i = 0; i < archive->header->chunk_count; i++) {
+		compressed_bytes += archive->chunks[i].compressed_size;
+	}
+
+	snprintf(
+		line,
+		sizeof(line),
+		"Asset archive: %u assets, %.2fMB\n"
+		"  %u stored, %.2fMB\n"
+		"  %u compressed into %u chunks, %.2fMB from %.2fMB (%.1f%%)\n",
+		archive->header->entry_count,
+		archive->file.size / (1024.0 * 1024.0),
+		stored,
+		stored_bytes / (1024.0 * 1024.0),
+		archive->header->entry_count - stored,
+		archive->header->chunk_count,
+		compressed_bytes / (1024.0 * 1024.0),
+		unpacked_bytes / (1024.0 * 1024.0),
+		unpacked_bytes > 0 ? 100.0 * compressed_bytes / unpacked_bytes : 0.0
+	);
+
+	return line;
+}
+
+static bool compare_sorted_inputs(const sorted_input& a, const sorted_input& b) {
+	return a.name_hash < b.name_hash;
+}
+
+static bool compare_entry_hash(const asset_archive_entry& entry, const uint64_t name_hash) {
+	return entry.name_hash < name_hash;
+}
+
+static bool read_chunk(const asset_archive* archive, const asset_archive_chunk* chunk, uint8_t* destination) {
+	if (chunk->compressed_size == chunk->size) {
+		memcpy(destination, archive->file.data + chunk->offset, chunk->size);
+		return true;
+	}
+
+	return decompress_lz4_block(
+		archive->file.data + chunk->offset,
+		chunk->compressed_size,
+		destination,
+		chunk->size
+	);
+}
+
+static void compress_chunks(const uint32_t begin, const uint32_t end, void* data) {
+	compress_chunks_job* job;
+	packed_chunk* chunk;
+	const uint8_t* source;
+	size_t size;
+	uint32_t i;
+
+	job = (compress_chunks_job*)data;
+
+	for (i = begin; i < end; i++) {
+		chunk = &(job->chunks[i]);
+		source = (*job->inputs)[chunk->input].data.data() + chunk->source_offset;
+
+		chunk->data.resize(get_lz4_bound(chunk->size));
+		size = compress_lz4_block(source, chunk->size, chunk->data.data(), chunk->data.size());
+
+		// No smaller, so keep it as it was.
+		if (size >= chunk->size) {
+			chunk->data.assign(source, source + chunk->size);
+		} else {
+			chunk->data.resize(size);
+		}
+	}
+}
+
+static void decompress_chunks(const uint32_t begin, const uint32_t end, void* data) {
+	decompress_chunks_job* job;
+	const asset_archive_chunk* chunk;
+	uint32_t i;
+
+	job = (decompress_chunks_job*)data;
+
+	for (i = begin; i < end; i++) {
+		chunk = &(job->archive->chunks[job->entry->first_chunk + i]);
+
+		if (!read_chunk(job->archive, chunk, job->destination + (size_t)i * job->archive->header->chunk_size)) {
+			job->failures++;
+		}
+	}
+}
+
+static uint64_t align_asset_offset(const uint64_t offset) {
+	return (offset + ASSET_ARCHIVE_ALIGNMENT - 1) &
+		~((uint64_t)ASSET_ARCHIVE_ALIGNMENT - 1);
+}
@@ -0,0 +1,133 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// An asset archive is a single file holding many assets, so loading
+// them doesn't mean opening (and checking for) a file each. It is made
+// offline by tools/asset_packer from a directory, and memory mapped at
+// start up like the shader archive.
+//
+// The layout of the file is:
+//
+//	asset_archive_header
+//	asset_archive_entry[entry_count]  (sorted by name hash)
+//	asset_archive_chunk[chunk_count]
+//	Assets and chunks                 (stored assets 16 byte aligned)
+//
+// Assets are found by a hash of their name, which is their path in the
+// directory that was packed. Nothing else of the name is kept, so the
+// packer refuses two names with the same hash.
+//
+// Each asset is either stored or compressed. A stored asset is its
+// bytes as they were, and can be used straight out of the mapping
+// without copying it. A compressed one is cut into 64KB chunks, each
+// compressed on its own with LZ4, so they can be decompressed at the
+// same time across the job system. The packer only compresses an asset
+// if that saves something worthwhile. Already compressed files (PNGs,
+// say) are stored.
+//
+
+#pragma once
+
+#include "file_mapping.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct job_system;
+
+// "ASPK" in little-endian.
+const uint32_t ASSET_ARCHIVE_MAGIC = 0x4b505341;
+const uint32_t ASSET_ARCHIVE_VERSION = 1;
+const uint32_t ASSET_ARCHIVE_ALIGNMENT = 16;
+// How much of an asset each chunk holds, before it's compressed.
+const uint32_t ASSET_CHUNK_SIZE = 64 * 1024;
+
+struct asset_archive_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t chunk_count;
+	uint32_t chunk_size;
+	uint32_t reserved[3];
+};
+
+struct asset_archive_entry {
+	uint64_t name_hash;
+	// Its size once it's decompressed.
+	uint64_t size;
+	// Where a stored asset is in the file. Unused if it's compressed.
+	uint64_t offset;
+	// A compressed asset's chunks. chunk_count is 0 if it's stored.
+	uint32_t first_chunk;
+	uint32_t chunk_count;
+};
+
+struct asset_archive_chunk {
+	uint64_t offset;
+	// If it's the same as size, the chunk didn't compress and is stored
+	// as it was.
+	uint32_t compressed_size;
+	uint32_t size;
+};
+
+struct asset_archive {
+	asset_archive();
+
+	mapped_file file;
+	const asset_archive_header* header;
+	const asset_archive_entry* entries;
+	const asset_archive_chunk* chunks;
+};
+
+// One asset for write_asset_archive.
+struct asset_archive_input {
+	std::string name;
+	std::vector<uint8_t> data;
+	// Whether to try compressing it at all.
+	bool compress;
+};
+
+// Names are paths, and are hashed the way Windows would find them:
+// backslashes and forward slashes are the same, case doesn't matter,
+// and a leading "./" is ignored.
+uint64_t get_asset_name_hash(const std::string& name);
+
+// Maps the archive at path and validates it. Returns false if the
+// file is missing or not a valid archive.
+bool open_asset_archive(asset_archive* archive, const std::string& path);
+
+// Returns NULL if there's no such asset.
+const asset_archive_entry* find_asset(const asset_archive* archive, const std::string& name);
+
+// Whether the asset is stored, so it can be used straight out of the
+// mapping.
+bool is_asset_stored(const asset_archive_entry* entry);
+
+// Where a stored asset's bytes are in the mapping, or NULL if it's
+// compressed. Only valid while the archive is open.
+const void* get_mapped_asset(const asset_archive* archive, const asset_archive_entry* entry);
+
+// Copies or decompresses the asset into destination, which must have
+// room for entry->size bytes. Chunks are decompressed across the job
+// system, or on this thread if jobs is NULL. Returns false if any of
+// them is damaged.
+bool read_asset(
+	job_system* jobs,
+	const asset_archive* archive,
+	const asset_archive_entry* entry,
+	void* destination
+);
+
+void close_asset_archive(asset_archive* archive);
+
+// Writes an archive holding all of inputs, compressing them across the
+// job system (or on this thread if jobs is NULL). The inputs don't need
+// to be sorted, but their names' hashes must be unique.
+bool write_asset_archive(
+	job_system* jobs,
+	const std::string& path,
+	const std::vector<asset_archive_input>& inputs
+);
+
+std::string get_asset_archive_report(const asset_archive* archive);
@@ -0,0 +1,223 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "constant_allocator.h"
+
+#include <cassert>
+#include <cstdio>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define CONSTANTS_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static uint64_t align_up(const uint64_t value, const uint64_t alignment);
+#if !defined(CONSTANTS_USE_SSE)
+static void multiply_matrix(const float* a, const float* b, float* result);
+#endif
+
+constant_allocator::constant_allocator() {
+	cpu_base = NULL;
+	gpu_base = 0;
+	frame_size = 0;
+	frame_count = 0;
+	frame = 0;
+	used = 0;
+	peak = 0;
+	allocations = 0;
+	failures = 0;
+}
+
+uint64_t get_constant_buffer_size(const uint64_t frame_size, const uint32_t frame_count) {
+	return align_up(frame_size, CONSTANT_BUFFER_ALIGNMENT) * frame_count;
+}
+
+void initialize_constant_allocator(
+	constant_allocator* allocator,
+	uint8_t* cpu_base,
+	const uint64_t gpu_base,
+	const uint64_t frame_size,
+	const uint32_t frame_count
+) {
+	assert((uintptr_t)cpu_base % CONSTANT_BUFFER_ALIGNMENT == 0);
+	assert(gpu_base % CONSTANT_BUFFER_ALIGNMENT == 0);
+
+	allocator->cpu_base = cpu_base;
+	allocator->gpu_base = gpu_base;
+	allocator->frame_size = align_up(frame_size, CONSTANT_BUFFER_ALIGNMENT);
+	allocator->frame_count = frame_count;
+	allocator->frame = 0;
+	allocator->used = 0;
+	allocator->peak = 0;
+	allocator->allocations = 0;
+	allocator->failures = 0;
+}
+
+void begin_constant_frame(constant_allocator* allocator, const uint64_t frame) {
+	allocator->frame = (uint32_t)(frame % allocator->frame_count);
+	allocator->used = 0;
+}
+
+bool allocate_constants(
+	constant_allocator* allocator,
+	const uint64_t size,
+	constant_slice* slice
+) {
+	uint64_t aligned_size;
+	uint64_t region;
+
+	aligned_size = align_up(size > 0 ? size : 1, CONSTANT_BUFFER_ALIGNMENT);
+
+	if (aligned_size > allocator->frame_size - allocator->used) {
+		allocator->failures++;
+		return false;
+	}
+
+	region = (uint64_t)allocator->frame * allocator->frame_size;
+
+	slice->offset = allocator->used;
+	slice->size = aligned_size;
+	slice->cpu = allocator->cpu_base + region + slice->offset;
+	slice->gpu_address = allocator->gpu_base + region + slice->offset;
+
+	allocator->used += aligned_size;
+	allocator->allocations++;
+
+	if (allocator->used > allocator->peak) {
+		allocator->peak = allocator->used;
+	}
+
+	return true;
+}
+
+bool allocate_constant_array(
+	constant_allocator* allocator,
+	const uint64_t element_size,
+	const uint32_t count,
+	constant_slice* slice,
+	uint64_t* stride
+) {
+	*stride = align_up(element_size > 0 ? element_size : 1, CONSTANT_BUFFER_ALIGNMENT);
+
+	return allocate_constants(allocator, *stride * count, slice);
+}
+
+void write_transform_constants(
+	const float* view_projection,
+	const void* models,
+	const size_t model_stride,
+	const uint32_t count,
+	uint8_t* destination,
+	const uint64_t stride
+) {
+	const uint8_t* model_bytes;
+	const float* model;
+	float* result;
+	uint32_t i;
+#if defined(CONSTANTS_USE_SSE)
+	__m128 rows[4];
+	__m128 row;
+	uint32_t r;
+#else
+	float product[16];
+	uint32_t j;
+#endif
+
+	assert((uintptr_t)destination % 16 == 0 && stride % 16 == 0);
+
+	model_bytes = (const uint8_t*)models;
+
+#if defined(CONSTANTS_USE_SSE)
+	// The rows of view_projection stay in registers for every draw.
+	for (r = 0; r < 4; r++) {
+		rows[r] = _mm_loadu_ps(view_projection + r * 4);
+	}
+#endif
+
+	for (i = 0; i < count; i++) {
+		model = (const float*)(model_bytes + i * model_stride);
+		result = (float*)(destination + i * stride);
+
+#if defined(CONSTANTS_USE_SSE)
+		//
+		// Each row of the result is the rows of view_projection,
+		// weighted by that row of the model matrix.
+		//
+
+		for (r = 0; r < 4; r++) {
+			row = _mm_mul_ps(_mm_set1_ps(model[r * 4 + 0]), rows[0]);
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(model[r * 4 + 1]), rows[1]));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(model[r * 4 + 2]), rows[2]));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(model[r * 4 + 3]), rows[3]));
+
+			_mm_stream_ps(result + r * 4, row);
+		}
+#else
+		multiply_matrix(model, view_projection, product);
+
+		for (j = 0; j < 16; j++) {
+			result[j] = product[j];
+		}
+#endif
+	}
+
+#if defined(CONSTANTS_USE_SSE)
+	// Streaming stores aren't ordered with the rest, so make sure
+	// they're all out before anything submits the command list.
+	_mm_sfence();
+#endif
+}
+
+constant_allocator_stats get_constant_allocator_stats(const constant_allocator* allocator) {
+	constant_allocator_stats stats;
+
+	stats.frame_capacity = allocator->frame_size;
+	stats.used = allocator->used;
+	stats.peak = allocator->peak;
+	stats.allocations = allocator->allocations;
+	stats.failures = allocator->failures;
+
+	return stats;
+}
+
+string get_constant_allocator_report(const constant_allocator* allocator) {
+	constant_allocator_stats stats;
+	char report[256];
+
+	stats = get_constant_allocator_stats(allocator);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Constants: %.1fKB of %.1fKB used last frame, peak %.1fKB, %llu allocations, %llu didn't fit\n",
+		(double)stats.used / 1024.0,
+		(double)stats.frame_capacity / 1024.0,
+		(double)stats.peak / 1024.0,
+		(unsigned long long)stats.allocations,
+		(unsigned long long)stats.failures
+	);
+
+	return report;
+}
+
+static uint64_t align_up(const uint64_t value, const uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+#if !defined(CONSTANTS_USE_SSE)
+static void multiply_matrix(const float* a, const float* b, float* result) {
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < 4; j++) {
+			result[i * 4 + j] =
+				a[i * 4 + 0] * b[0 * 4 + j] +
+				a[i * 4 + 1] * b[1 * 4 + j] +
+				a[i * 4 + 2] * b[2 * 4 + j] +
+				a[i * 4 + 3] * b[3 * 4 + j];
+		}
+	}
+}
+#endif
@@ -0,0 +1,126 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Hands out constant buffer space for each frame's draws. One upload
+// buffer stays mapped for the whole run, and is split into a region per
+// frame in flight. Within a region, allocating is just bumping an
+// offset, and beginning a frame empties that frame's region again.
+//
+// D3D12 wants constant buffer views to start on a 256 byte boundary,
+// so every slice is rounded up to that. A slice's GPU address can be
+// bound straight to a root CBV.
+//
+// The allocator never touches D3D itself: it's given the mapped pointer
+// and the buffer's GPU address, so it builds and is tested on Linux
+// too (see tools/constant_allocator_bench.cpp).
+//
+// Frames must not be begun again until the GPU is done with them. The
+// application waits on the GPU at the end of each frame, and there's a
+// region per back buffer, so that's always true.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Same as D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT.
+const uint64_t CONSTANT_BUFFER_ALIGNMENT = 256;
+
+struct constant_slice {
+	// Where to write the constants, and where the GPU reads them.
+	uint8_t* cpu;
+	uint64_t gpu_address;
+	// From the start of the frame's region.
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct constant_allocator_stats {
+	uint64_t frame_capacity;
+	uint64_t used;
+	// The most any one frame has used.
+	uint64_t peak;
+	uint64_t allocations;
+	// Allocations that didn't fit in their frame.
+	uint64_t failures;
+};
+
+struct constant_allocator {
+	constant_allocator();
+
+	uint8_t* cpu_base;
+	uint64_t gpu_base;
+	uint64_t frame_size;
+	uint32_t frame_count;
+
+	// The region being allocated from, and how much of it is used.
+	uint32_t frame;
+	uint64_t used;
+
+	uint64_t peak;
+	uint64_t allocations;
+	uint64_t failures;
+};
+
+// How big the buffer has to be for frame_count regions of at least
+// frame_size bytes.
+uint64_t get_constant_buffer_size(const uint64_t frame_size, const uint32_t frame_count);
+
+// cpu_base and gpu_base are the start of a buffer at least
+// get_constant_buffer_size bytes long, and must be 256 byte aligned.
+void initialize_constant_allocator(
+	constant_allocator* allocator,
+	uint8_t* cpu_base,
+	const uint64_t gpu_base,
+	const uint64_t frame_size,
+	const uint32_t frame_count
+);
+
+// Starts allocating from frame's region (wrapping around the frame
+// count), dropping everything allocated there before.
+void begin_constant_frame(constant_allocator* allocator, const uint64_t frame);
+
+// Room for size bytes of constants. Returns false if the frame is full.
+bool allocate_constants(
+	constant_allocator* allocator,
+	const uint64_t size,
+	constant_slice* slice
+);
+
+// Room for count constant buffers of element_size bytes each, one after
+// another. Each starts on a 256 byte boundary; stride is how far apart
+// they are. Returns false if the frame is full.
+bool allocate_constant_array(
+	constant_allocator* allocator,
+	const uint64_t element_size,
+	const uint32_t count,
+	constant_slice* slice,
+	uint64_t* stride
+);
+
+//
+// Writes model * view_projection for count draws, one 4x4 row-major
+// float matrix every stride bytes from destination. The models are
+// read every model_stride bytes from models, so they can be pulled
+// straight out of an array of draws.
+//
+// This is the same product as XMMatrixMultiply(model, view_projection),
+// done four floats at a time with SSE where we have it. The results are
+// written with streaming stores, since upload heaps are write-combined
+// and never read back by the CPU. destination and stride must be 16
+// byte aligned.
+//
+
+void write_transform_constants(
+	const float* view_projection,
+	const void* models,
+	const size_t model_stride,
+	const uint32_t count,
+	uint8_t* destination,
+	const uint64_t stride
+);
+
+constant_allocator_stats get_constant_allocator_stats(const constant_allocator* allocator);
+std::string get_constant_allocator_report(const constant_allocator* allocator);
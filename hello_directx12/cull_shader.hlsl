@@ -0,0 +1,131 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+    Frustum culls every object, and writes a draw command for each one
+    that's visible, for ExecuteIndirect to draw. One thread per object.
+
+    This is cull_objects in gpu_culling.cpp, which has to stay the same
+    as it. So do the structs, which match the ones in gpu_culling.h.
+*/
+
+#define FRUSTUM_PLANE_COUNT 6
+#define CULLING_GROUP_SIZE 64
+
+struct gpu_object
+{
+    // Row by row.
+    float4 world[4];
+    float4 bounds;
+    uint index_count;
+    uint first_index;
+    int base_vertex;
+    uint material;
+};
+
+struct indirect_command
+{
+    uint2 constants_address;
+    uint material;
+    uint index_count_per_instance;
+    uint instance_count;
+    uint start_index_location;
+    int base_vertex_location;
+    uint start_instance_location;
+};
+
+struct culling_constants
+{
+    float4 planes[FRUSTUM_PLANE_COUNT];
+    uint object_count;
+    uint max_commands;
+    uint2 constants_address;
+    uint constant_stride;
+};
+
+// All root constants, so there's nothing to upload per frame.
+ConstantBuffer<culling_constants> culling : register(b0);
+StructuredBuffer<gpu_object> objects : register(t0);
+RWStructuredBuffer<indirect_command> commands : register(u0);
+// How many objects were visible. ExecuteIndirect reads it as the
+// number of commands.
+RWByteAddressBuffer command_count : register(u1);
+
+bool is_object_visible(gpu_object object)
+{
+    float3 center;
+    float scale;
+    float radius;
+    float distance;
+    uint plane;
+
+    center =
+        object.bounds.x * object.world[0].xyz +
+        object.bounds.y * object.world[1].xyz +
+        object.bounds.z * object.world[2].xyz +
+        object.world[3].xyz;
+
+    scale = max(
+        dot(object.world[0].xyz, object.world[0].xyz),
+        max(
+            dot(object.world[1].xyz, object.world[1].xyz),
+            dot(object.world[2].xyz, object.world[2].xyz)
+        )
+    );
+
+    radius = object.bounds.w * sqrt(scale);
+
+    [unroll]
+    for (plane = 0; plane < FRUSTUM_PLANE_COUNT; plane++)
+    {
+        distance = dot(culling.planes[plane].xyz, center) + culling.planes[plane].w;
+
+        if (distance < -radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+[numthreads(CULLING_GROUP_SIZE, 1, 1)]
+void cs_main(uint3 thread_id : SV_DispatchThreadID)
+{
+    gpu_object object;
+    indirect_command command;
+    uint index;
+    uint slot;
+    uint low;
+
+    index = thread_id.x;
+    if (index >= culling.object_count)
+    {
+        return;
+    }
+
+    object = objects[index];
+    if (!is_object_visible(object))
+    {
+        return;
+    }
+
+    command_count.InterlockedAdd(0, 1, slot);
+    if (slot >= culling.max_commands)
+    {
+        return;
+    }
+
+    // The address is 64 bits, which HLSL only has as two halves.
+    low = culling.constants_address.x + index * culling.constant_stride;
+
+    command.constants_address.x = low;
+    command.constants_address.y = culling.constants_address.y + (low < culling.constants_address.x ? 1 : 0);
+    command.material = object.material;
+    command.index_count_per_instance = object.index_count;
+    command.instance_count = 1;
+    command.start_index_location = object.first_index;
+    command.base_vertex_location = object.base_vertex;
+    command.start_instance_location = 0;
+
+    commands[slot] = command;
+}
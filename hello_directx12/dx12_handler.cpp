@@ -3,8 +3,16 @@
 #include "dx12_handler.h"
 #include "utils.h"
 
+using namespace std;
+
 dx12_handler::dx12_handler() {
+	presentation.max_frame_latency = 2;
+	presentation.vsync = true;
+	presentation.allow_tearing = false;
+	frame_latency_waitable = NULL;
+	tearing_supported = false;
 	rtv_descriptor_size = 0;
+	srv_descriptor_size = 0;
 	frame_index = 0;
 	fence_event = NULL;
 	fence_value = 1;
@@ -19,6 +27,8 @@ bool initialize_directx_12(
 ) {
 	ComPtr<IDXGIFactory4> factory;
 	ComPtr<IDXGIAdapter4> adapter;
+	UINT swap_chain_flags;
+	HRESULT result;
 
 	enable_dx12_debug_layer();
 
@@ -40,6 +50,25 @@ bool initialize_directx_12(
 	// device is needed to manage all of the resources and
 	// memory for DX12 - it's like the GPU's memory context.
 	dx12->device = create_dx12_device(adapter);
+	dx12->adapter = adapter;
+
+	//
+	// Set up the GPU memory allocator, and the residency manager that
+	// keeps what it allocates within budget.
+	//
+
+	initialize_residency_manager(
+		&(dx12->residency),
+		RESIDENCY_MIN_EVICTION_AGE,
+		RESIDENCY_THRASH_WINDOW
+	);
+
+	initialize_gpu_allocator(
+		&(dx12->memory),
+		dx12->device,
+		GPU_HEAP_BLOCK_SIZE,
+		&(dx12->residency)
+	);
 
 	//
 	// Next, create the command queue.
@@ -51,14 +80,30 @@ bool initialize_directx_12(
 	// Next, create the swap chain.
 	//
 
+	// The waitable object lets us wait for the swap chain before we
+	// start a frame, rather than blocking in Present after we've done
+	// all the work. Tearing has to be asked for up front too.
+	swap_chain_flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
+	dx12->tearing_supported = check_tearing_support(factory);
+	if (dx12->tearing_supported) {
+		swap_chain_flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+	}
+
 	dx12->swap_chain = create_swap_chain(
 		hwnd,
 		screen_w,
 		screen_h,
+		swap_chain_flags,
 		factory,
 		dx12->command_queue
 	);
 
+	result = dx12->swap_chain->SetMaximumFrameLatency(dx12->presentation.max_frame_latency);
+	throw_if_failed(result);
+
+	dx12->frame_latency_waitable = dx12->swap_chain->GetFrameLatencyWaitableObject();
+
 	dx12->frame_index = dx12->swap_chain->GetCurrentBackBufferIndex();
 
 	//
@@ -73,16 +118,20 @@ bool initialize_directx_12(
 	);
 
 	//
-	// Create the shader resource view heap for the texture.
+	// Create the shader resource view heap for the textures.
 	//
 
 	dx12->srv_heap = create_descriptor_heap(
 		dx12->device,
-		1,
+		SRV_HEAP_SIZE,
 		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
 		D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
 	);
 
+	dx12->srv_descriptor_size = dx12->device->GetDescriptorHandleIncrementSize(
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
+	);
+
 	//
 	// Next, update the render target views.
 	//
@@ -108,12 +157,28 @@ bool initialize_directx_12(
 		D3D12_COMMAND_LIST_TYPE_DIRECT
 	);
 
+	// The fixup command list shares the command allocator. That's fine
+	// since it is only ever recorded after the main one is closed.
+	dx12->fixup_command_list = create_command_list(
+		dx12->device,
+		dx12->command_allocator,
+		D3D12_COMMAND_LIST_TYPE_DIRECT
+	);
+
 	//
 	// Finally, create the fence and synchronization objects.
 	//
 
 	dx12->fence = create_fence(dx12->device);
 	dx12->fence_event = create_fence_event();
+	dx12->residency_fence = create_fence(dx12->device);
+
+	initialize_gpu_profiler(
+		&(dx12->gpu_timings),
+		dx12->device,
+		&(dx12->memory),
+		dx12->command_queue
+	);
 
 	return true;
 }
@@ -353,10 +418,33 @@ ComPtr<ID3D12CommandQueue> create_command_queue(ComPtr<ID3D12Device> dev) {
 	return command_queue;
 }
 
+bool check_tearing_support(ComPtr<IDXGIFactory4> factory) {
+	ComPtr<IDXGIFactory5> factory5;
+	BOOL allow_tearing;
+	HRESULT result;
+
+	// IDXGIFactory5 is where this was added, so older versions of
+	// Windows don't support it.
+	result = factory.As(&factory5);
+	if (FAILED(result)) {
+		return false;
+	}
+
+	allow_tearing = FALSE;
+	result = factory5->CheckFeatureSupport(
+		DXGI_FEATURE_PRESENT_ALLOW_TEARING,
+		&allow_tearing,
+		sizeof(allow_tearing)
+	);
+
+	return SUCCEEDED(result) && allow_tearing;
+}
+
 ComPtr<IDXGISwapChain3> create_swap_chain(
 	HWND hwnd,
 	const uint32_t screen_w,
 	const uint32_t screen_h,
+	const UINT swap_chain_flags,
 	ComPtr<IDXGIFactory4> factory,
 	ComPtr<ID3D12CommandQueue> command_queue
 ) {
@@ -373,6 +461,7 @@ ComPtr<IDXGISwapChain3> create_swap_chain(
 	swap_chain_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
 	swap_chain_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
 	swap_chain_desc.SampleDesc.Count = 1;
+	swap_chain_desc.Flags = swap_chain_flags;
 
 	result = factory->CreateSwapChainForHwnd(
 		command_queue.Get(),
@@ -475,6 +564,14 @@ void update_render_target_views(dx12_handler* dx12) {
 		dev->CreateRenderTargetView(back_buffer.Get(), NULL, rtv_handle);
 		dx12->render_targets[i] = back_buffer;
 
+		// Back buffers start out ready to present.
+		register_resource(
+			&(dx12->resource_states),
+			back_buffer.Get(),
+			1,
+			RESOURCE_STATE_PRESENT
+		);
+
 		// This increments to the next RTV descriptor.
 		rtv_handle.Offset(rtv_descriptor_size);
 	}
@@ -560,6 +657,399 @@ HANDLE create_fence_event() {
 	return fence_event;
 }
 
+void record_resource_barriers(
+	ID3D12GraphicsCommandList* command_list,
+	const vector<resource_barrier>& barriers,
+	vector<D3D12_RESOURCE_BARRIER>* d3d12_barriers
+) {
+	const resource_barrier* barrier;
+	D3D12_RESOURCE_BARRIER_FLAGS flags;
+	size_t i;
+
+	if (barriers.empty()) {
+		return;
+	}
+
+	d3d12_barriers->clear();
+
+	for (i = 0; i < barriers.size(); i++) {
+		barrier = &barriers[i];
+
+		if (barrier->type == RESOURCE_BARRIER_UAV) {
+			d3d12_barriers->push_back(
+				CD3DX12_RESOURCE_BARRIER::UAV((ID3D12Resource*)barrier->resource)
+			);
+
+			continue;
+		}
+
+		// A NULL before resource means "whatever was using this memory".
+		if (barrier->type == RESOURCE_BARRIER_ALIASING) {
+			d3d12_barriers->push_back(
+				CD3DX12_RESOURCE_BARRIER::Aliasing(
+					NULL,
+					(ID3D12Resource*)barrier->resource
+				)
+			);
+
+			continue;
+		}
+
+		flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		if (barrier->split == RESOURCE_BARRIER_SPLIT_BEGIN_ONLY) {
+			flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+		} else if (barrier->split == RESOURCE_BARRIER_SPLIT_END_ONLY) {
+			flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+		}
+
+		// The tracker's states are the same bits as D3D12's, so they
+		// can be cast straight across.
+		d3d12_barriers->push_back(
+			CD3DX12_RESOURCE_BARRIER::Transition(
+				(ID3D12Resource*)barrier->resource,
+				(D3D12_RESOURCE_STATES)barrier->before,
+				(D3D12_RESOURCE_STATES)barrier->after,
+				barrier->subresource,
+				flags
+			)
+		);
+	}
+
+	command_list->ResourceBarrier(
+		(UINT)d3d12_barriers->size(),
+		d3d12_barriers->data()
+	);
+}
+
+void begin_tracked_command_list(dx12_handler* dx12) {
+	reset_state_tracker(&(dx12->command_list_states), &(dx12->resource_states));
+}
+
+void flush_tracked_barriers(dx12_handler* dx12) {
+	flush_resource_barriers(&(dx12->command_list_states), &(dx12->barrier_batch));
+
+	record_resource_barriers(
+		dx12->command_list.Get(),
+		dx12->barrier_batch,
+		&(dx12->d3d12_barrier_batch)
+	);
+}
+
+void update_gpu_residency(dx12_handler* dx12) {
+	DXGI_QUERY_VIDEO_MEMORY_INFO memory_info;
+	residency_frame_info frame_info;
+	residency_work* work;
+	ComPtr<ID3D12Device3> device3;
+	HRESULT result;
+	size_t i;
+
+	//
+	// The budget can change at any time, so ask every frame. We only
+	// track heaps in video memory, so the local segment is the one
+	// that matters.
+	//
+
+	result = dx12->adapter->QueryVideoMemoryInfo(
+		0,
+		DXGI_MEMORY_SEGMENT_GROUP_LOCAL,
+		&memory_info
+	);
+
+	throw_if_failed(result);
+
+	frame_info.budget = memory_info.Budget;
+	frame_info.usage = memory_info.CurrentUsage;
+	frame_info.completed_fence = dx12->fence->GetCompletedValue();
+	frame_info.completed_residency_fence = dx12->residency_fence->GetCompletedValue();
+
+	work = &(dx12->residency_changes);
+	update_residency(&(dx12->residency), frame_info, work);
+
+	//
+	// Evict first, so there's room for what we're making resident.
+	//
+
+	if (!work->evict.empty()) {
+		dx12->pageables.clear();
+		for (i = 0; i < work->evict.size(); i++) {
+			dx12->pageables.push_back((ID3D12Pageable*)work->evict[i]);
+		}
+
+		result = dx12->device->Evict((UINT)dx12->pageables.size(), dx12->pageables.data());
+		throw_if_failed(result);
+	}
+
+	// MakeResident blocks until everything is in, which is what we
+	// want for heaps the next command list uses.
+	if (!work->make_resident.empty()) {
+		dx12->pageables.clear();
+		for (i = 0; i < work->make_resident.size(); i++) {
+			dx12->pageables.push_back((ID3D12Pageable*)work->make_resident[i]);
+		}
+
+		result = dx12->device->MakeResident((UINT)dx12->pageables.size(), dx12->pageables.data());
+		throw_if_failed(result);
+	}
+
+	//
+	// Streaming requests don't need to block. EnqueueMakeResident
+	// signals the residency fence when they're in. Older runtimes
+	// don't have it, so there we make them resident now and signal the
+	// fence ourselves.
+	//
+
+	if (!work->make_resident_async.empty()) {
+		dx12->pageables.clear();
+		for (i = 0; i < work->make_resident_async.size(); i++) {
+			dx12->pageables.push_back((ID3D12Pageable*)work->make_resident_async[i]);
+		}
+
+		result = dx12->device.As(&device3);
+
+		if (SUCCEEDED(result)) {
+			result = device3->EnqueueMakeResident(
+				D3D12_RESIDENCY_FLAG_NONE,
+				(UINT)dx12->pageables.size(),
+				dx12->pageables.data(),
+				dx12->residency_fence.Get(),
+				work->async_fence_value
+			);
+
+			throw_if_failed(result);
+		} else {
+			result = dx12->device->MakeResident((UINT)dx12->pageables.size(), dx12->pageables.data());
+			throw_if_failed(result);
+
+			result = dx12->residency_fence->Signal(work->async_fence_value);
+			throw_if_failed(result);
+		}
+	}
+}
+
+void execute_tracked_command_list(dx12_handler* dx12) {
+	ID3D12CommandList* command_lists[2];
+	UINT num_command_lists;
+	size_t num_barriers;
+	HRESULT result;
+
+	//
+	// Work out what has to happen before the command list can run.
+	// Most of the time this is a back buffer going from PRESENT to
+	// RENDER_TARGET.
+	//
+
+	num_barriers = resolve_pending_barriers(
+		&(dx12->resource_states),
+		&(dx12->command_list_states),
+		&(dx12->barrier_batch)
+	);
+
+	num_command_lists = 0;
+
+	if (num_barriers > 0) {
+		result = dx12->fixup_command_list->Reset(
+			dx12->command_allocator.Get(),
+			NULL
+		);
+
+		throw_if_failed(result);
+
+		record_resource_barriers(
+			dx12->fixup_command_list.Get(),
+			dx12->barrier_batch,
+			&(dx12->d3d12_barrier_batch)
+		);
+
+		result = dx12->fixup_command_list->Close();
+		throw_if_failed(result);
+
+		command_lists[num_command_lists++] = dx12->fixup_command_list.Get();
+	}
+
+	command_lists[num_command_lists++] = dx12->command_list.Get();
+
+	// Make sure every heap the command lists use is resident.
+	update_gpu_residency(dx12);
+
+	dx12->command_queue->ExecuteCommandLists(num_command_lists, command_lists);
+}
+
+frame_graph_texture_desc describe_transient_texture(
+	ComPtr<ID3D12Device> dev,
+	const DXGI_FORMAT format,
+	const uint32_t width,
+	const uint32_t height,
+	const D3D12_RESOURCE_FLAGS flags,
+	const float clear_value[4]
+) {
+	frame_graph_texture_desc desc;
+	CD3DX12_RESOURCE_DESC resource_desc;
+	D3D12_RESOURCE_ALLOCATION_INFO allocation_info;
+
+	desc = {};
+	desc.width = width;
+	desc.height = height;
+	desc.format = (uint32_t)format;
+	desc.flags = (uint32_t)flags;
+	memcpy(desc.clear_value, clear_value, sizeof(desc.clear_value));
+
+	resource_desc = CD3DX12_RESOURCE_DESC::Tex2D(
+		format,
+		width,
+		height,
+		1,
+		1,
+		1,
+		0,
+		flags
+	);
+
+	allocation_info = dev->GetResourceAllocationInfo(0, 1, &resource_desc);
+	desc.size = allocation_info.SizeInBytes;
+	desc.alignment = allocation_info.Alignment;
+
+	return desc;
+}
+
+void realize_frame_graph(
+	gpu_allocator* allocator,
+	frame_graph* graph,
+	gpu_allocation* memory,
+	vector<ComPtr<ID3D12Resource>>* resources
+) {
+	CD3DX12_RESOURCE_DESC resource_desc;
+	D3D12_CLEAR_VALUE clear_value;
+	frame_graph_resource_node* node;
+	HRESULT result;
+	size_t i;
+
+	resources->clear();
+	resources->resize(graph->resources.size());
+
+	if (graph->transient_heap_size == 0) {
+		return;
+	}
+
+	//
+	// One allocation holds every transient. The transients are all
+	// render targets or depth buffers, so it comes from the render
+	// target pool.
+	//
+
+	allocate_gpu_memory(
+		allocator,
+		GPU_POOL_RENDER_TARGETS,
+		graph->transient_heap_size,
+		graph->transient_heap_alignment,
+		memory
+	);
+
+	//
+	// Now place each transient at the offset the graph picked for it.
+	//
+
+	for (i = 0; i < graph->resources.size(); i++) {
+		node = &(graph->resources[i]);
+
+		if (node->imported || !node->used) {
+			continue;
+		}
+
+		resource_desc = CD3DX12_RESOURCE_DESC::Tex2D(
+			(DXGI_FORMAT)node->desc.format,
+			node->desc.width,
+			node->desc.height,
+			1,
+			1,
+			1,
+			0,
+			(D3D12_RESOURCE_FLAGS)node->desc.flags
+		);
+
+		clear_value = {};
+		clear_value.Format = (DXGI_FORMAT)node->desc.format;
+
+		if (node->desc.flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) {
+			clear_value.DepthStencil = { node->desc.clear_value[0], 0 };
+		} else {
+			memcpy(clear_value.Color, node->desc.clear_value, sizeof(clear_value.Color));
+		}
+
+		result = allocator->device->CreatePlacedResource(
+			memory->heap,
+			memory->offset + node->heap_offset,
+			&resource_desc,
+			(D3D12_RESOURCE_STATES)node->initial_state,
+			&clear_value,
+			IID_PPV_ARGS(&((*resources)[i]))
+		);
+
+		throw_if_failed(result);
+
+		node->physical = (*resources)[i].Get();
+	}
+}
+
+void record_frame_graph_barriers(
+	const frame_graph* graph,
+	const vector<frame_graph_barrier>& barriers,
+	void* user_data
+) {
+	dx12_handler* dx12;
+	resource_barrier barrier;
+	size_t i;
+
+	dx12 = (dx12_handler*)user_data;
+
+	//
+	// Swap each graph resource for the actual resource, and then
+	// record them like any other batch of barriers.
+	//
+
+	dx12->barrier_batch.clear();
+
+	for (i = 0; i < barriers.size(); i++) {
+		barrier = {};
+		barrier.type = barriers[i].type;
+		barrier.split = RESOURCE_BARRIER_SPLIT_NONE;
+		barrier.resource = graph->resources[barriers[i].resource].physical;
+		barrier.subresource = ALL_SUBRESOURCES;
+		barrier.before = barriers[i].before;
+		barrier.after = barriers[i].after;
+
+		dx12->barrier_batch.push_back(barrier);
+	}
+
+	record_resource_barriers(
+		dx12->command_list.Get(),
+		dx12->barrier_batch,
+		&(dx12->d3d12_barrier_batch)
+	);
+}
+
+void wait_for_swap_chain(dx12_handler* dx12) {
+	if (dx12->frame_latency_waitable) {
+		WaitForSingleObjectEx(dx12->frame_latency_waitable, 1000, TRUE);
+	}
+}
+
+void present_frame(dx12_handler* dx12) {
+	UINT sync_interval;
+	UINT present_flags;
+	HRESULT result;
+
+	sync_interval = dx12->presentation.vsync ? 1 : 0;
+	present_flags = 0;
+
+	// Tearing is only allowed with a sync interval of 0.
+	if (!dx12->presentation.vsync && dx12->presentation.allow_tearing && dx12->tearing_supported) {
+		present_flags |= DXGI_PRESENT_ALLOW_TEARING;
+	}
+
+	result = dx12->swap_chain->Present(sync_interval, present_flags);
+	throw_if_failed(result);
+}
+
 void wait_for_previous_frame(dx12_handler* dx12) {
 	
 	//
@@ -589,21 +1079,22 @@ void wait_for_previous_frame(dx12_handler* dx12) {
 	//
 
 	UINT64 fence_val;
-	ComPtr<ID3D12Fence> fence;
-	ComPtr<ID3D12CommandQueue> command_queue;
+	ID3D12Fence* fence;
+	ID3D12CommandQueue* command_queue;
 	HANDLE fence_event;
 	HRESULT result;
 
+	// Borrowed, so this doesn't AddRef and Release them every frame.
 	fence_val = dx12->fence_value;
-	fence = dx12->fence;
+	fence = dx12->fence.Get();
 	fence_event = dx12->fence_event;
-	command_queue = dx12->command_queue;
+	command_queue = dx12->command_queue.Get();
 
 	//
 	// Signal and increment the fence value.
 	//
 
-	result = command_queue->Signal(fence.Get(), fence_val);
+	result = command_queue->Signal(fence, fence_val);
 	throw_if_failed(result);
 	dx12->fence_value++;
 
@@ -621,5 +1112,10 @@ void wait_for_previous_frame(dx12_handler* dx12) {
 
 void shutdown_directx_12(dx12_handler* dx12) {
 	wait_for_previous_frame(dx12);
+	shutdown_gpu_profiler(&(dx12->gpu_timings), &(dx12->memory));
 	CloseHandle(dx12->fence_event);
+
+	if (dx12->frame_latency_waitable) {
+		CloseHandle(dx12->frame_latency_waitable);
+	}
 }
\ No newline at end of file
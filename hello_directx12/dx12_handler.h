@@ -11,8 +11,34 @@
 #pragma once
 
 #include "stdafx.h"
+#include "frame_graph.h"
+#include "gpu_allocator.h"
+#include "gpu_profiler.h"
+#include "resource_state_tracker.h"
 
 const UINT NUM_RENDER_TARGETS = 3;
+// Descriptors in the shader visible SRV heap. Every texture gets one,
+// and the shaders see them all as one array (see material_registry.h).
+const UINT SRV_HEAP_SIZE = 1024;
+// Heaps used within this many frames are never evicted.
+const uint32_t RESIDENCY_MIN_EVICTION_AGE = NUM_RENDER_TARGETS;
+// A heap made resident this many frames after being evicted counts as
+// thrashing in the residency stats.
+const uint32_t RESIDENCY_THRASH_WINDOW = 60;
+
+// How frames are handed to the display. Set these before calling
+// initialize_directx_12.
+struct present_settings {
+	// How many frames the CPU can queue up ahead of the display. Lower
+	// is less latency, higher is smoother when frame times vary.
+	uint32_t max_frame_latency;
+	bool vsync;
+	// With vsync off, present straight away even if the display is
+	// partway through showing the last frame. This tears on a fixed
+	// refresh display, but is what lets variable refresh rate displays
+	// show frames as soon as they're ready.
+	bool allow_tearing;
+};
 
 struct dx12_handler {
 	dx12_handler();
@@ -21,16 +47,55 @@ struct dx12_handler {
 	// Core DX12 objects.
 	//
 
+	ComPtr<IDXGIAdapter4> adapter;
 	ComPtr<ID3D12Device> device;
 	ComPtr<ID3D12CommandQueue> command_queue;
 	ComPtr<IDXGISwapChain3> swap_chain;
+	present_settings presentation;
+	// Signalled when the swap chain is ready for another frame.
+	HANDLE frame_latency_waitable;
+	bool tearing_supported;
 	ComPtr<ID3D12Resource> render_targets[NUM_RENDER_TARGETS];
 	ComPtr<ID3D12DescriptorHeap> rtv_heap;
 	ComPtr<ID3D12DescriptorHeap> srv_heap;
 	UINT rtv_descriptor_size;
+	UINT srv_descriptor_size;
 	ComPtr<ID3D12CommandAllocator> command_allocator;
 	ComPtr<ID3D12GraphicsCommandList> command_list;
 
+	// Buffers and textures are placed in heaps owned by this, rather
+	// than each being a committed resource.
+	gpu_allocator memory;
+
+	//
+	// Keeps us within the OS's video memory budget by evicting the
+	// least recently used heaps. The residency fence is signalled when
+	// asynchronous make-resident requests finish.
+	//
+
+	residency_manager residency;
+	ComPtr<ID3D12Fence> residency_fence;
+	residency_work residency_changes;
+	std::vector<ID3D12Pageable*> pageables;
+
+	//
+	// Resource state tracking. The registry knows what state every
+	// resource is in as of the last submission, and the tracker
+	// works out the barriers for the command list being recorded.
+	// Barriers that have to happen before the command list runs go
+	// into the fixup command list, which is submitted just ahead of it.
+	//
+
+	resource_state_registry resource_states;
+	command_list_state_tracker command_list_states;
+	ComPtr<ID3D12GraphicsCommandList> fixup_command_list;
+	// Reused between frames so flushing barriers doesn't allocate.
+	std::vector<resource_barrier> barrier_batch;
+	std::vector<D3D12_RESOURCE_BARRIER> d3d12_barrier_batch;
+
+	// Times command list regions on the GPU for the profiler.
+	gpu_profiler gpu_timings;
+
 	//
 	// Synchronization fence objects needed for rendering.
 	//
@@ -65,14 +130,26 @@ ComPtr<ID3D12Device> create_dx12_device(ComPtr<IDXGIAdapter4> adapter);
 
 ComPtr<ID3D12CommandQueue> create_command_queue(ComPtr<ID3D12Device> dev);
 
+// Whether the display supports presenting with tearing (needed for
+// variable refresh rate).
+bool check_tearing_support(ComPtr<IDXGIFactory4> factory);
+
 ComPtr<IDXGISwapChain3> create_swap_chain(
 	HWND hwnd,
 	const uint32_t screen_w,
 	const uint32_t screen_h,
+	const UINT swap_chain_flags,
 	ComPtr<IDXGIFactory4> factory,
 	ComPtr<ID3D12CommandQueue> command_queue
 );
 
+// Blocks until the swap chain can take another frame without going
+// over the maximum frame latency. Call before starting a frame.
+void wait_for_swap_chain(dx12_handler* dx12);
+
+// Presents the current back buffer the way presentation says to.
+void present_frame(dx12_handler* dx12);
+
 ComPtr<ID3D12DescriptorHeap> create_descriptor_heap(
 	ComPtr<ID3D12Device> dev,
 	const UINT num_descriptors,
@@ -97,6 +174,61 @@ ComPtr<ID3D12Fence> create_fence(ComPtr<ID3D12Device> device);
 
 HANDLE create_fence_event();
 
+// Converts barriers into D3D12 barriers and records all of them with
+// a single ResourceBarrier call.
+void record_resource_barriers(
+	ID3D12GraphicsCommandList* command_list,
+	const std::vector<resource_barrier>& barriers,
+	std::vector<D3D12_RESOURCE_BARRIER>* d3d12_barriers
+);
+
+// Call right after resetting the command list.
+void begin_tracked_command_list(dx12_handler* dx12);
+
+// Records every barrier queued up by transition_resource and friends.
+// Call this before recording commands that need the new states.
+void flush_tracked_barriers(dx12_handler* dx12);
+
+// Asks the OS for the current video memory budget, and evicts or makes
+// resident whatever the residency manager says to. Call before every
+// submission, after marking what the submission uses with
+// use_gpu_memory.
+void update_gpu_residency(dx12_handler* dx12);
+
+// Executes the (closed) command list, first running the fixup command
+// list if any resource needs to be moved into the state the command
+// list expects.
+void execute_tracked_command_list(dx12_handler* dx12);
+
+// Fills in a frame graph texture description, including how much
+// memory the device says the texture needs.
+frame_graph_texture_desc describe_transient_texture(
+	ComPtr<ID3D12Device> dev,
+	const DXGI_FORMAT format,
+	const uint32_t width,
+	const uint32_t height,
+	const D3D12_RESOURCE_FLAGS flags,
+	const float clear_value[4]
+);
+
+// Allocates the memory for a compiled frame graph's transients, and
+// a placed resource in it for each one. resources is indexed by
+// frame_graph_resource, and is NULL for anything not a transient.
+void realize_frame_graph(
+	gpu_allocator* allocator,
+	frame_graph* graph,
+	gpu_allocation* memory,
+	std::vector<ComPtr<ID3D12Resource>>* resources
+);
+
+// A frame_graph_barrier_fn that records barriers into the dx12 handler's
+// command list. Pass the dx12_handler as the user data.
+void record_frame_graph_barriers(
+	const frame_graph* graph,
+	const std::vector<frame_graph_barrier>& barriers,
+	void* user_data
+);
+
 void wait_for_previous_frame(dx12_handler* dx12);
 
 void shutdown_directx_12(dx12_handler* dx12);
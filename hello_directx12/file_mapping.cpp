@@ -0,0 +1,169 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "file_mapping.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // ! WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file() {
+	data = NULL;
+	size = 0;
+
+#if defined(_WIN32)
+	file_handle = NULL;
+	mapping_handle = NULL;
+#else
+	file_descriptor = -1;
+#endif
+}
+
+#if defined(_WIN32)
+
+bool open_mapped_file(mapped_file* file, const std::string& path) {
+	HANDLE file_handle;
+	HANDLE mapping_handle;
+	LARGE_INTEGER file_size;
+	void* view;
+
+	*file = mapped_file();
+
+	file_handle = CreateFileA(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL
+	);
+
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	if (!GetFileSizeEx(file_handle, &file_size)) {
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	// You cannot create a mapping of an empty file, so we treat it
+	// as a successfully opened file with nothing in it.
+	if (file_size.QuadPart == 0) {
+		file->file_handle = file_handle;
+		return true;
+	}
+
+	mapping_handle = CreateFileMappingA(
+		file_handle,
+		NULL,
+		PAGE_READONLY,
+		0,
+		0,
+		NULL
+	);
+
+	if (!mapping_handle) {
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping_handle);
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	file->data = (const uint8_t*)view;
+	file->size = (size_t)file_size.QuadPart;
+	file->file_handle = file_handle;
+	file->mapping_handle = mapping_handle;
+
+	return true;
+}
+
+void close_mapped_file(mapped_file* file) {
+	if (file->data) {
+		UnmapViewOfFile(file->data);
+	}
+
+	if (file->mapping_handle) {
+		CloseHandle(file->mapping_handle);
+	}
+
+	if (file->file_handle) {
+		CloseHandle(file->file_handle);
+	}
+
+	*file = mapped_file();
+}
+
+#else
+
+bool open_mapped_file(mapped_file* file, const std::string& path) {
+	int file_descriptor;
+	struct stat file_stats;
+	void* view;
+
+	*file = mapped_file();
+
+	file_descriptor = open(path.c_str(), O_RDONLY);
+	if (file_descriptor < 0) {
+		return false;
+	}
+
+	if (fstat(file_descriptor, &file_stats) != 0) {
+		close(file_descriptor);
+		return false;
+	}
+
+	// mmap refuses zero-length mappings, so an empty file is simply
+	// an open file with no data.
+	if (file_stats.st_size == 0) {
+		file->file_descriptor = file_descriptor;
+		return true;
+	}
+
+	view = mmap(
+		NULL,
+		(size_t)file_stats.st_size,
+		PROT_READ,
+		MAP_PRIVATE,
+		file_descriptor,
+		0
+	);
+
+	if (view == MAP_FAILED) {
+		close(file_descriptor);
+		return false;
+	}
+
+	file->data = (const uint8_t*)view;
+	file->size = (size_t)file_stats.st_size;
+	file->file_descriptor = file_descriptor;
+
+	return true;
+}
+
+void close_mapped_file(mapped_file* file) {
+	if (file->data) {
+		munmap((void*)file->data, file->size);
+	}
+
+	if (file->file_descriptor >= 0) {
+		close(file->file_descriptor);
+	}
+
+	*file = mapped_file();
+}
+
+#endif
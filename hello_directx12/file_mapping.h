@@ -0,0 +1,40 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A read-only memory mapped file. Rather than reading a file into
+// a buffer we allocate, we ask the OS to map the file into our
+// address space and page it in as we touch it. This is how the
+// shader cache and the archives hand out their data without
+// copying it around.
+//
+// This works on both Windows and Linux so that the code built on
+// top of it stays platform-neutral.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+struct mapped_file {
+	mapped_file();
+
+	// Start of the mapped file contents and the size in bytes.
+	// For an empty file, data is NULL and size is 0.
+	const uint8_t* data;
+	size_t size;
+
+#if defined(_WIN32)
+	void* file_handle;
+	void* mapping_handle;
+#else
+	int file_descriptor;
+#endif
+};
+
+// Maps the whole file at path. Returns false if the file could not
+// be opened or mapped, in which case file is left empty.
+bool open_mapped_file(mapped_file* file, const std::string& path);
+
+void close_mapped_file(mapped_file* file);
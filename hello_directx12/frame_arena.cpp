@@ -0,0 +1,131 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "frame_arena.h"
+
+#include <cstdio>
+
+using namespace std;
+
+static uint8_t* align_pointer(uint8_t* pointer, const size_t alignment);
+
+frame_arena::frame_arena() {
+	capacity = 0;
+	used = 0;
+	overflow_bytes = 0;
+	peak = 0;
+	overflows = 0;
+	grows = 0;
+}
+
+void initialize_frame_arena(frame_arena* arena, const size_t capacity) {
+	//
+	// Allocate a little extra, so the start can be aligned however new
+	// happens to align it.
+	//
+
+	arena->memory.reset(new uint8_t[capacity + FRAME_ARENA_ALIGNMENT]);
+	arena->capacity = capacity;
+	arena->used = 0;
+	arena->overflow.clear();
+	arena->overflow_bytes = 0;
+	arena->peak = 0;
+	arena->overflows = 0;
+	arena->grows = 0;
+}
+
+void reset_frame_arena(frame_arena* arena) {
+	size_t needed;
+
+	//
+	// If last frame spilled over, grow so that next time it all fits,
+	// with some room to spare.
+	//
+
+	if (arena->overflow_bytes > 0) {
+		needed = arena->used + arena->overflow_bytes;
+
+		arena->memory.reset(new uint8_t[needed * 2 + FRAME_ARENA_ALIGNMENT]);
+		arena->capacity = needed * 2;
+		arena->grows++;
+
+		arena->overflow.clear();
+		arena->overflow_bytes = 0;
+	}
+
+	arena->used = 0;
+}
+
+void* allocate_from_arena(
+	frame_arena* arena,
+	const size_t size,
+	const size_t alignment
+) {
+	uint8_t* base;
+	uint8_t* start;
+	size_t offset;
+
+	base = align_pointer(arena->memory.get(), FRAME_ARENA_ALIGNMENT);
+	start = align_pointer(base + arena->used, alignment);
+	offset = (size_t)(start - base);
+
+	if (arena->memory && offset + size <= arena->capacity) {
+		arena->used = offset + size;
+
+		if (arena->used + arena->overflow_bytes > arena->peak) {
+			arena->peak = arena->used + arena->overflow_bytes;
+		}
+
+		return start;
+	}
+
+	//
+	// It doesn't fit. Get it from the heap for now; the arena grows
+	// at the next reset.
+	//
+
+	arena->overflow.push_back(unique_ptr<uint8_t[]>(new uint8_t[size + alignment]));
+	arena->overflow_bytes += size + alignment;
+	arena->overflows++;
+
+	if (arena->used + arena->overflow_bytes > arena->peak) {
+		arena->peak = arena->used + arena->overflow_bytes;
+	}
+
+	return align_pointer(arena->overflow.back().get(), alignment);
+}
+
+frame_arena_stats get_frame_arena_stats(const frame_arena* arena) {
+	frame_arena_stats stats;
+
+	stats.capacity = arena->capacity;
+	stats.used = arena->used + arena->overflow_bytes;
+	stats.peak = arena->peak;
+	stats.overflows = arena->overflows;
+	stats.grows = arena->grows;
+
+	return stats;
+}
+
+string get_frame_arena_report(const frame_arena* arena) {
+	frame_arena_stats stats;
+	char report[256];
+
+	stats = get_frame_arena_stats(arena);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Frame arena: %.1fKB of %.1fKB used, peak %.1fKB, %llu overflows, grown %llu times\n",
+		(double)stats.used / 1024.0,
+		(double)stats.capacity / 1024.0,
+		(double)stats.peak / 1024.0,
+		(unsigned long long)stats.overflows,
+		(unsigned long long)stats.grows
+	);
+
+	return report;
+}
+
+static uint8_t* align_pointer(uint8_t* pointer, const size_t alignment) {
+	return (uint8_t*)(((uintptr_t)pointer + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
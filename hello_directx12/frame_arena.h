@@ -0,0 +1,79 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A frame arena hands out memory for things that only last a frame
+// (the draw list, per-draw temporaries and so on). Allocating is just
+// bumping an offset, and everything is freed at once by resetting the
+// arena at the start of the next frame.
+//
+// If a frame needs more than the arena has, the rest comes from the
+// heap, and the arena grows at the next reset to fit the whole frame.
+// So after the first few frames, it never touches the heap.
+//
+// The arena never runs constructors or destructors, so only put plain
+// data in it. Each thread that wants one should have its own.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Enough for anything we put in here, including XMMATRIX.
+const size_t FRAME_ARENA_ALIGNMENT = 16;
+
+struct frame_arena_stats {
+	size_t capacity;
+	size_t used;
+	// The most any one frame has used.
+	size_t peak;
+	// Allocations that didn't fit, and how often the arena grew
+	// because of them.
+	uint64_t overflows;
+	uint64_t grows;
+};
+
+struct frame_arena {
+	frame_arena();
+
+	std::unique_ptr<uint8_t[]> memory;
+	size_t capacity;
+	size_t used;
+
+	// What didn't fit this frame. Freed at the next reset.
+	std::vector<std::unique_ptr<uint8_t[]>> overflow;
+	size_t overflow_bytes;
+
+	size_t peak;
+	uint64_t overflows;
+	uint64_t grows;
+};
+
+void initialize_frame_arena(frame_arena* arena, const size_t capacity);
+
+// Frees everything allocated since the last reset. If the last frame
+// didn't fit, grows to fit it.
+void reset_frame_arena(frame_arena* arena);
+
+// alignment must be a power of two.
+void* allocate_from_arena(
+	frame_arena* arena,
+	const size_t size,
+	const size_t alignment = FRAME_ARENA_ALIGNMENT
+);
+
+// Room for count Ts, not constructed.
+template <typename T>
+T* allocate_array_from_arena(frame_arena* arena, const size_t count) {
+	return (T*)allocate_from_arena(
+		arena,
+		sizeof(T) * count,
+		alignof(T) > FRAME_ARENA_ALIGNMENT ? alignof(T) : FRAME_ARENA_ALIGNMENT
+	);
+}
+
+frame_arena_stats get_frame_arena_stats(const frame_arena* arena);
+std::string get_frame_arena_report(const frame_arena* arena);
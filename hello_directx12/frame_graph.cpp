@@ -0,0 +1,608 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "frame_graph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+using namespace std;
+
+static void cull_passes(frame_graph* graph);
+static bool compute_lifetimes(frame_graph* graph);
+static void place_transients(frame_graph* graph);
+static void derive_barriers(frame_graph* graph);
+static uint64_t align_offset(const uint64_t offset, const uint64_t alignment);
+static bool lifetimes_overlap(
+	const frame_graph_resource_node* a,
+	const frame_graph_resource_node* b
+);
+
+frame_graph::frame_graph() {
+	compiled = false;
+	transient_heap_size = 0;
+	transient_heap_alignment = 0;
+	stats = {};
+}
+
+void reset_frame_graph(frame_graph* graph) {
+	*graph = frame_graph();
+}
+
+frame_graph_resource create_transient_texture(
+	frame_graph* graph,
+	const string& name,
+	const frame_graph_texture_desc& desc
+) {
+	frame_graph_resource_node node;
+
+	node = {};
+	node.name = name;
+	node.desc = desc;
+	node.imported = false;
+	node.physical = NULL;
+	node.initial_state = RESOURCE_STATE_COMMON;
+	node.final_state = RESOURCE_STATE_COMMON;
+
+	graph->resources.push_back(node);
+	graph->compiled = false;
+
+	return (frame_graph_resource)(graph->resources.size() - 1);
+}
+
+frame_graph_resource import_resource(
+	frame_graph* graph,
+	const string& name,
+	const void* physical,
+	const resource_state initial_state,
+	const resource_state final_state
+) {
+	frame_graph_resource_node node;
+
+	node = {};
+	node.name = name;
+	node.imported = true;
+	node.physical = physical;
+	node.initial_state = initial_state;
+	node.final_state = final_state;
+
+	graph->resources.push_back(node);
+	graph->compiled = false;
+
+	return (frame_graph_resource)(graph->resources.size() - 1);
+}
+
+uint32_t add_pass(
+	frame_graph* graph,
+	const string& name,
+	frame_graph_execute_fn execute,
+	void* user_data,
+	const bool side_effects
+) {
+	frame_graph_pass pass;
+
+	pass.name = name;
+	pass.side_effects = side_effects;
+	pass.execute = execute;
+	pass.user_data = user_data;
+	pass.culled = false;
+
+	graph->passes.push_back(pass);
+	graph->compiled = false;
+
+	return (uint32_t)(graph->passes.size() - 1);
+}
+
+void read_resource(
+	frame_graph* graph,
+	const uint32_t pass,
+	const frame_graph_resource resource,
+	const resource_state state
+) {
+	assert(pass < graph->passes.size());
+	assert(resource < graph->resources.size());
+
+	graph->passes[pass].reads.push_back({ resource, state });
+	graph->compiled = false;
+}
+
+void write_resource(
+	frame_graph* graph,
+	const uint32_t pass,
+	const frame_graph_resource resource,
+	const resource_state state
+) {
+	assert(pass < graph->passes.size());
+	assert(resource < graph->resources.size());
+
+	graph->passes[pass].writes.push_back({ resource, state });
+	graph->compiled = false;
+}
+
+bool compile_frame_graph(frame_graph* graph) {
+	uint32_t i;
+
+	graph->compiled = false;
+	graph->order.clear();
+	graph->pass_barriers.clear();
+	graph->final_barriers.clear();
+	graph->stats = {};
+
+	//
+	// First get rid of the passes that don't contribute anything.
+	//
+
+	cull_passes(graph);
+
+	for (i = 0; i < graph->passes.size(); i++) {
+		if (!graph->passes[i].culled) {
+			graph->order.push_back(i);
+		}
+	}
+
+	//
+	// Next work out when each resource is first and last used. This is
+	// also where we catch reads of things nothing wrote.
+	//
+
+	if (!compute_lifetimes(graph)) {
+		return false;
+	}
+
+	//
+	// Now find a home for each transient in the transient heap, and
+	// figure out the barriers.
+	//
+
+	place_transients(graph);
+	derive_barriers(graph);
+
+	graph->stats.pass_count = (uint32_t)graph->passes.size();
+	graph->stats.culled_pass_count =
+		(uint32_t)(graph->passes.size() - graph->order.size());
+	graph->stats.transient_heap_size = graph->transient_heap_size;
+	graph->compiled = true;
+
+	return true;
+}
+
+void execute_frame_graph(
+	const frame_graph* graph,
+	frame_graph_barrier_fn record_barriers,
+	void* user_data
+) {
+	const frame_graph_pass* pass;
+	size_t i;
+
+	assert(graph->compiled);
+
+	for (i = 0; i < graph->order.size(); i++) {
+		pass = &(graph->passes[graph->order[i]]);
+
+		if (!graph->pass_barriers[i].empty()) {
+			record_barriers(graph, graph->pass_barriers[i], user_data);
+		}
+
+		if (pass->execute) {
+			pass->execute(pass->user_data);
+		}
+	}
+
+	if (!graph->final_barriers.empty()) {
+		record_barriers(graph, graph->final_barriers, user_data);
+	}
+}
+
+string get_frame_graph_report(const frame_graph* graph) {
+	const frame_graph_resource_node* node;
+	string report;
+	char line[256];
+	size_t i;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"Frame graph: %u passes (%u culled), %u transients, %u barriers\n",
+		graph->stats.pass_count,
+		graph->stats.culled_pass_count,
+		graph->stats.transient_count,
+		graph->stats.barrier_count
+	);
+
+	report += line;
+
+	for (i = 0; i < graph->order.size(); i++) {
+		snprintf(
+			line,
+			sizeof(line),
+			"  pass %zu: %s\n",
+			i,
+			graph->passes[graph->order[i]].name.c_str()
+		);
+
+		report += line;
+	}
+
+	for (i = 0; i < graph->resources.size(); i++) {
+		node = &(graph->resources[i]);
+
+		if (node->imported || !node->used) {
+			continue;
+		}
+
+		snprintf(
+			line,
+			sizeof(line),
+			"  transient %s: %llu bytes at offset %llu, passes %u-%u%s\n",
+			node->name.c_str(),
+			(unsigned long long)node->desc.size,
+			(unsigned long long)node->heap_offset,
+			node->first_use,
+			node->last_use,
+			node->aliased ? " (aliased)" : ""
+		);
+
+		report += line;
+	}
+
+	snprintf(
+		line,
+		sizeof(line),
+		"  peak transient memory: %llu bytes (%llu without aliasing)\n",
+		(unsigned long long)graph->stats.transient_heap_size,
+		(unsigned long long)graph->stats.unaliased_bytes
+	);
+
+	report += line;
+
+	return report;
+}
+
+static void cull_passes(frame_graph* graph) {
+	vector<char> needed;
+	frame_graph_pass* pass;
+	bool alive;
+	size_t i;
+	size_t j;
+
+	//
+	// Walk the passes backwards, keeping a set of the resources some
+	// later pass still needs. A pass is kept if it has side effects or
+	// writes something in that set. Imported resources are always
+	// needed, since whoever imported them will look at them after.
+	//
+
+	needed.resize(graph->resources.size());
+
+	for (i = 0; i < graph->resources.size(); i++) {
+		needed[i] = graph->resources[i].imported;
+	}
+
+	for (i = graph->passes.size(); i > 0; i--) {
+		pass = &(graph->passes[i - 1]);
+
+		alive = pass->side_effects;
+		for (j = 0; j < pass->writes.size() && !alive; j++) {
+			alive = needed[pass->writes[j].resource] != 0;
+		}
+
+		pass->culled = !alive;
+		if (!alive) {
+			continue;
+		}
+
+		for (j = 0; j < pass->reads.size(); j++) {
+			needed[pass->reads[j].resource] = 1;
+		}
+	}
+}
+
+static bool compute_lifetimes(frame_graph* graph) {
+	vector<char> written;
+	frame_graph_resource_node* node;
+	const frame_graph_pass* pass;
+	frame_graph_resource resource;
+	uint32_t i;
+	size_t j;
+
+	written.resize(graph->resources.size());
+
+	for (j = 0; j < graph->resources.size(); j++) {
+		graph->resources[j].used = false;
+		graph->resources[j].aliased = false;
+		graph->resources[j].heap_offset = 0;
+	}
+
+	for (i = 0; i < graph->order.size(); i++) {
+		pass = &(graph->passes[graph->order[i]]);
+
+		for (j = 0; j < pass->reads.size(); j++) {
+			resource = pass->reads[j].resource;
+			node = &(graph->resources[resource]);
+
+			// Transients have no contents until someone writes them.
+			if (!node->imported && !written[resource]) {
+				return false;
+			}
+
+			if (!node->used) {
+				node->used = true;
+				node->first_use = i;
+			}
+
+			node->last_use = i;
+		}
+
+		for (j = 0; j < pass->writes.size(); j++) {
+			resource = pass->writes[j].resource;
+			node = &(graph->resources[resource]);
+
+			if (!node->used) {
+				node->used = true;
+				node->first_use = i;
+			}
+
+			node->last_use = i;
+			written[resource] = 1;
+		}
+	}
+
+	return true;
+}
+
+static void place_transients(frame_graph* graph) {
+	vector<frame_graph_resource_node*> transients;
+	vector<pair<uint64_t, uint64_t>> taken;
+	frame_graph_resource_node* node;
+	frame_graph_resource_node* other;
+	uint64_t offset;
+	uint64_t heap_size;
+	uint64_t heap_alignment;
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < graph->resources.size(); i++) {
+		node = &(graph->resources[i]);
+
+		if (!node->imported && node->used) {
+			transients.push_back(node);
+			graph->stats.unaliased_bytes += node->desc.size;
+		}
+	}
+
+	graph->stats.transient_count = (uint32_t)transients.size();
+
+	//
+	// Place the biggest transients first. For each one, look at the
+	// transients already placed that are alive at the same time, and
+	// put it in the lowest gap between them that it fits in. Anything
+	// not alive at the same time can be freely overlapped.
+	//
+
+	sort(
+		transients.begin(),
+		transients.end(),
+		[](const frame_graph_resource_node* a, const frame_graph_resource_node* b) {
+			return a->desc.size > b->desc.size;
+		}
+	);
+
+	heap_size = 0;
+	heap_alignment = 1;
+
+	for (i = 0; i < transients.size(); i++) {
+		node = transients[i];
+
+		taken.clear();
+		for (j = 0; j < i; j++) {
+			other = transients[j];
+
+			if (lifetimes_overlap(node, other)) {
+				taken.push_back({
+					other->heap_offset,
+					other->heap_offset + other->desc.size
+				});
+			}
+		}
+
+		sort(taken.begin(), taken.end());
+
+		offset = 0;
+		for (j = 0; j < taken.size(); j++) {
+			offset = align_offset(offset, node->desc.alignment);
+
+			if (offset + node->desc.size <= taken[j].first) {
+				break;
+			}
+
+			offset = max(offset, taken[j].second);
+		}
+
+		offset = align_offset(offset, node->desc.alignment);
+		node->heap_offset = offset;
+
+		heap_size = max(heap_size, offset + node->desc.size);
+		heap_alignment = max(heap_alignment, node->desc.alignment);
+	}
+
+	//
+	// Now note which transients share memory. Those need an aliasing
+	// barrier before they are used.
+	//
+
+	for (i = 0; i < transients.size(); i++) {
+		for (j = i + 1; j < transients.size(); j++) {
+			node = transients[i];
+			other = transients[j];
+
+			if (node->heap_offset < other->heap_offset + other->desc.size &&
+				other->heap_offset < node->heap_offset + node->desc.size)
+			{
+				node->aliased = true;
+				other->aliased = true;
+			}
+		}
+	}
+
+	graph->transient_heap_size = heap_size;
+	graph->transient_heap_alignment = heap_alignment;
+}
+
+static void derive_barriers(frame_graph* graph) {
+	vector<resource_state> current_states;
+	vector<resource_state> pass_states;
+	vector<frame_graph_resource> pass_resources;
+	vector<frame_graph_barrier>* barriers;
+	frame_graph_resource_node* node;
+	const frame_graph_pass* pass;
+	frame_graph_barrier barrier;
+	frame_graph_resource resource;
+	uint32_t i;
+	size_t j;
+
+	current_states.resize(graph->resources.size());
+	pass_states.assign(graph->resources.size(), RESOURCE_STATE_UNKNOWN);
+
+	//
+	// Transients are created in the state of their last use. Since the
+	// same graph runs every frame, that's also the state they're in
+	// when the next frame starts, so the first frame looks just like
+	// every other frame.
+	//
+
+	for (j = 0; j < graph->resources.size(); j++) {
+		node = &(graph->resources[j]);
+
+		if (node->imported) {
+			current_states[j] = node->initial_state;
+		} else {
+			current_states[j] = RESOURCE_STATE_UNKNOWN;
+		}
+	}
+
+	for (i = 0; i < graph->order.size(); i++) {
+		pass = &(graph->passes[graph->order[i]]);
+
+		// Remember the last state each transient is used in.
+		for (j = 0; j < pass->reads.size(); j++) {
+			resource = pass->reads[j].resource;
+			if (!graph->resources[resource].imported) {
+				graph->resources[resource].initial_state = pass->reads[j].state;
+			}
+		}
+
+		for (j = 0; j < pass->writes.size(); j++) {
+			resource = pass->writes[j].resource;
+			if (!graph->resources[resource].imported) {
+				graph->resources[resource].initial_state = pass->writes[j].state;
+			}
+		}
+	}
+
+	for (j = 0; j < graph->resources.size(); j++) {
+		node = &(graph->resources[j]);
+
+		if (!node->imported) {
+			current_states[j] = node->initial_state;
+		}
+	}
+
+	//
+	// Now walk the passes in order. Within a pass, all the reads of a
+	// resource are combined into one state, and a write overrides them.
+	//
+
+	graph->pass_barriers.resize(graph->order.size());
+
+	for (i = 0; i < graph->order.size(); i++) {
+		pass = &(graph->passes[graph->order[i]]);
+		barriers = &(graph->pass_barriers[i]);
+
+		pass_resources.clear();
+
+		for (j = 0; j < pass->reads.size(); j++) {
+			resource = pass->reads[j].resource;
+
+			if (pass_states[resource] == RESOURCE_STATE_UNKNOWN) {
+				pass_resources.push_back(resource);
+				pass_states[resource] = pass->reads[j].state;
+			} else {
+				pass_states[resource] |= pass->reads[j].state;
+			}
+		}
+
+		for (j = 0; j < pass->writes.size(); j++) {
+			resource = pass->writes[j].resource;
+
+			if (pass_states[resource] == RESOURCE_STATE_UNKNOWN) {
+				pass_resources.push_back(resource);
+			}
+
+			pass_states[resource] = pass->writes[j].state;
+		}
+
+		for (j = 0; j < pass_resources.size(); j++) {
+			resource = pass_resources[j];
+			node = &(graph->resources[resource]);
+
+			// A transient that shares memory is taking it over from
+			// whatever used it last.
+			if (!node->imported && node->aliased && node->first_use == i) {
+				barrier = {};
+				barrier.type = RESOURCE_BARRIER_ALIASING;
+				barrier.resource = resource;
+				barriers->push_back(barrier);
+			}
+
+			if (current_states[resource] != pass_states[resource]) {
+				barrier = {};
+				barrier.type = RESOURCE_BARRIER_TRANSITION;
+				barrier.resource = resource;
+				barrier.before = current_states[resource];
+				barrier.after = pass_states[resource];
+				barriers->push_back(barrier);
+
+				current_states[resource] = pass_states[resource];
+			}
+
+			pass_states[resource] = RESOURCE_STATE_UNKNOWN;
+		}
+
+		graph->stats.barrier_count += (uint32_t)barriers->size();
+	}
+
+	//
+	// Finally, hand the imported resources back in the state their
+	// owner expects.
+	//
+
+	for (j = 0; j < graph->resources.size(); j++) {
+		node = &(graph->resources[j]);
+
+		if (node->imported && current_states[j] != node->final_state) {
+			barrier = {};
+			barrier.type = RESOURCE_BARRIER_TRANSITION;
+			barrier.resource = (frame_graph_resource)j;
+			barrier.before = current_states[j];
+			barrier.after = node->final_state;
+			graph->final_barriers.push_back(barrier);
+		}
+	}
+
+	graph->stats.barrier_count += (uint32_t)graph->final_barriers.size();
+}
+
+static uint64_t align_offset(const uint64_t offset, const uint64_t alignment) {
+	if (alignment <= 1) {
+		return offset;
+	}
+
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+static bool lifetimes_overlap(
+	const frame_graph_resource_node* a,
+	const frame_graph_resource_node* b
+) {
+	return a->first_use <= b->last_use && b->first_use <= a->last_use;
+}
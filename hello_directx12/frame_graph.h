@@ -0,0 +1,219 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// The frame graph describes a frame as a list of passes, where each
+// pass says which resources it reads and which it writes. From that
+// the graph can work out a lot of things we'd otherwise do by hand:
+//
+// * Passes whose results nobody uses are culled.
+// * The barriers between passes are derived from how each pass uses
+//   each resource.
+// * Transient textures (ones that only live for part of a frame, like
+//   the depth buffer or a post-processing target) don't get their own
+//   memory. Instead, they are placed into one shared heap, and two
+//   transients that are never alive at the same time can share the
+//   same memory. This is called aliasing.
+//
+// Using it looks like:
+//
+//	reset_frame_graph(&graph);
+//	depth = create_transient_texture(&graph, "depth", depth_desc);
+//	pass = add_pass(&graph, "main", record_main_pass, app, true);
+//	write_resource(&graph, pass, depth, RESOURCE_STATE_DEPTH_WRITE);
+//	compile_frame_graph(&graph);
+//
+// and then the DX12 side creates the heap and the placed resources
+// (see realize_frame_graph in dx12_handler). Every frame after that,
+// execute_frame_graph runs the passes.
+//
+// Passes run in the order they were added. A pass can only read what
+// an earlier pass wrote, so that order always works.
+//
+// Like the resource state tracker, none of this depends on DirectX.
+//
+
+#pragma once
+
+#include "resource_state_tracker.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef uint32_t frame_graph_resource;
+
+const frame_graph_resource FRAME_GRAPH_INVALID_RESOURCE = 0xffffffff;
+
+// Records the commands for a pass.
+typedef void (*frame_graph_execute_fn)(void* user_data);
+
+struct frame_graph;
+struct frame_graph_barrier;
+
+// Records a batch of barriers. Called by execute_frame_graph before
+// each pass that needs any.
+typedef void (*frame_graph_barrier_fn)(
+	const frame_graph* graph,
+	const std::vector<frame_graph_barrier>& barriers,
+	void* user_data
+);
+
+struct frame_graph_texture_desc {
+	uint32_t width;
+	uint32_t height;
+	// A DXGI_FORMAT and D3D12_RESOURCE_FLAGS.
+	uint32_t format;
+	uint32_t flags;
+	// What the texture gets cleared to. For depth textures, the first
+	// value is the depth.
+	float clear_value[4];
+	// How much memory the texture needs, and its alignment. These come
+	// from the device (GetResourceAllocationInfo).
+	uint64_t size;
+	uint64_t alignment;
+};
+
+struct frame_graph_resource_node {
+	std::string name;
+	frame_graph_texture_desc desc;
+	bool imported;
+	// The actual resource. Imported resources have this from the
+	// start. Transients get it once they are realized.
+	const void* physical;
+	// For imported resources, the state they are in before the graph
+	// runs and the state to leave them in afterwards. For transients,
+	// this is the state they are created in (see compile_frame_graph).
+	resource_state initial_state;
+	resource_state final_state;
+
+	//
+	// Everything below is filled in by compile_frame_graph.
+	//
+
+	bool used;
+	// Position in the execution order of the first and last passes to
+	// use the resource.
+	uint32_t first_use;
+	uint32_t last_use;
+	// Where the transient lives in the transient heap, and whether it
+	// shares any of that memory with another transient.
+	uint64_t heap_offset;
+	bool aliased;
+};
+
+struct frame_graph_use {
+	frame_graph_resource resource;
+	resource_state state;
+};
+
+struct frame_graph_pass {
+	std::string name;
+	std::vector<frame_graph_use> reads;
+	std::vector<frame_graph_use> writes;
+	// Passes with side effects (like drawing to the back buffer) are
+	// never culled.
+	bool side_effects;
+	frame_graph_execute_fn execute;
+	void* user_data;
+	bool culled;
+};
+
+// Like resource_barrier, but for a graph resource rather than an
+// actual one.
+struct frame_graph_barrier {
+	resource_barrier_type type;
+	frame_graph_resource resource;
+	resource_state before;
+	resource_state after;
+};
+
+struct frame_graph_stats {
+	uint32_t pass_count;
+	uint32_t culled_pass_count;
+	uint32_t transient_count;
+	uint32_t barrier_count;
+	// What the transients would need if each had its own memory.
+	uint64_t unaliased_bytes;
+	// What they actually need with aliasing. This is the peak amount of
+	// transient memory over the frame.
+	uint64_t transient_heap_size;
+};
+
+struct frame_graph {
+	frame_graph();
+
+	std::vector<frame_graph_resource_node> resources;
+	std::vector<frame_graph_pass> passes;
+
+	//
+	// Filled in by compile_frame_graph.
+	//
+
+	bool compiled;
+	// Indices of the passes that weren't culled, in execution order.
+	std::vector<uint32_t> order;
+	// The barriers to record before each pass in order.
+	std::vector<std::vector<frame_graph_barrier>> pass_barriers;
+	// Barriers that put imported resources in their final states.
+	std::vector<frame_graph_barrier> final_barriers;
+	uint64_t transient_heap_size;
+	uint64_t transient_heap_alignment;
+	frame_graph_stats stats;
+};
+
+void reset_frame_graph(frame_graph* graph);
+
+frame_graph_resource create_transient_texture(
+	frame_graph* graph,
+	const std::string& name,
+	const frame_graph_texture_desc& desc
+);
+
+// Brings a resource the graph doesn't own (like a back buffer) into
+// the graph so passes can use it.
+frame_graph_resource import_resource(
+	frame_graph* graph,
+	const std::string& name,
+	const void* physical,
+	const resource_state initial_state,
+	const resource_state final_state
+);
+
+// Returns the index of the new pass.
+uint32_t add_pass(
+	frame_graph* graph,
+	const std::string& name,
+	frame_graph_execute_fn execute,
+	void* user_data,
+	const bool side_effects
+);
+
+void read_resource(
+	frame_graph* graph,
+	const uint32_t pass,
+	const frame_graph_resource resource,
+	const resource_state state
+);
+
+void write_resource(
+	frame_graph* graph,
+	const uint32_t pass,
+	const frame_graph_resource resource,
+	const resource_state state
+);
+
+// Culls, orders, derives barriers, and places the transients in the
+// transient heap. Returns false if the graph doesn't make sense, such
+// as a pass reading a transient nothing wrote.
+bool compile_frame_graph(frame_graph* graph);
+
+// Runs each pass in order, recording its barriers first.
+void execute_frame_graph(
+	const frame_graph* graph,
+	frame_graph_barrier_fn record_barriers,
+	void* user_data
+);
+
+// A short human readable summary of the compiled graph: which passes
+// run, where each transient lives, and how much memory aliasing saved.
+std::string get_frame_graph_report(const frame_graph* graph);
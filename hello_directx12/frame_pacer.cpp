@@ -0,0 +1,282 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "frame_pacer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // ! WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace std;
+
+static double get_bucket_percentile(
+	const frame_time_histogram* histogram,
+	const double percentile
+);
+
+frame_time_histogram::frame_time_histogram() {
+	reset_frame_time_histogram(this);
+}
+
+frame_pacer::frame_pacer() {
+	clock = get_system_time_ns;
+	sleep = sleep_system_ns;
+	clock_user_data = NULL;
+	target_interval_ns = 0;
+	spin_threshold_ns = 0;
+	next_frame_ns = 0;
+	last_frame_ns = 0;
+	missed_deadlines = 0;
+	time_slept_ns = 0;
+}
+
+uint64_t get_system_time_ns(void*) {
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+		chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+#if defined(_WIN32)
+
+void sleep_system_ns(const uint64_t duration_ns, void*) {
+	static thread_local HANDLE timer = NULL;
+	LARGE_INTEGER due_time;
+
+	//
+	// Sleep() only wakes up on the scheduler's tick, which is usually
+	// 15.6ms. A high resolution waitable timer gets us within a
+	// fraction of a millisecond. Older versions of Windows don't have
+	// those, so fall back to a plain timer there.
+	//
+
+	if (!timer) {
+		timer = CreateWaitableTimerExW(
+			NULL,
+			NULL,
+			CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+			TIMER_ALL_ACCESS
+		);
+	}
+
+	if (!timer) {
+		timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+	}
+
+	if (!timer) {
+		Sleep((DWORD)(duration_ns / 1000000));
+		return;
+	}
+
+	// Negative means relative, in 100ns units.
+	due_time.QuadPart = -(LONGLONG)(duration_ns / 100);
+
+	SetWaitableTimer(timer, &due_time, 0, NULL, NULL, FALSE);
+	WaitForSingleObject(timer, INFINITE);
+}
+
+#else
+
+void sleep_system_ns(const uint64_t duration_ns, void*) {
+	struct timespec duration;
+
+	duration.tv_sec = (time_t)(duration_ns / 1000000000);
+	duration.tv_nsec = (long)(duration_ns % 1000000000);
+
+	while (nanosleep(&duration, &duration) != 0) {
+	}
+}
+
+#endif
+
+void initialize_frame_pacer(frame_pacer* pacer, const uint32_t frames_per_second) {
+	*pacer = frame_pacer();
+
+	if (frames_per_second > 0) {
+		pacer->target_interval_ns = 1000000000ULL / frames_per_second;
+	}
+
+#if defined(_WIN32)
+	// Even the high resolution timer can be half a millisecond late.
+	pacer->spin_threshold_ns = 500000;
+#endif
+}
+
+void set_frame_pacer_clock(
+	frame_pacer* pacer,
+	pacer_clock_fn clock,
+	pacer_sleep_fn sleep,
+	void* user_data
+) {
+	pacer->clock = clock;
+	pacer->sleep = sleep;
+	pacer->clock_user_data = user_data;
+	pacer->next_frame_ns = 0;
+	pacer->last_frame_ns = 0;
+}
+
+void begin_paced_frame(frame_pacer* pacer) {
+	uint64_t now;
+	uint64_t sleep_ns;
+
+	now = pacer->clock(pacer->clock_user_data);
+
+	if (pacer->target_interval_ns > 0) {
+		if (pacer->next_frame_ns == 0) {
+			pacer->next_frame_ns = now;
+		}
+
+		//
+		// Sleep until the frame is due, less the spin threshold, and
+		// then spin the rest of the way.
+		//
+
+		if (now < pacer->next_frame_ns) {
+			sleep_ns = pacer->next_frame_ns - now;
+
+			if (sleep_ns > pacer->spin_threshold_ns) {
+				pacer->sleep(sleep_ns - pacer->spin_threshold_ns, pacer->clock_user_data);
+				pacer->time_slept_ns += sleep_ns - pacer->spin_threshold_ns;
+			}
+
+			now = pacer->clock(pacer->clock_user_data);
+			while (now < pacer->next_frame_ns) {
+				now = pacer->clock(pacer->clock_user_data);
+			}
+		}
+
+		//
+		// The next deadline is a whole interval after this one, not
+		// after now, so oversleeping a little doesn't slow the rate
+		// down. But if we've fallen more than a whole frame behind,
+		// start the grid again from now. Otherwise we'd run a burst of
+		// frames back to back to catch up.
+		//
+
+		pacer->next_frame_ns += pacer->target_interval_ns;
+
+		if (now >= pacer->next_frame_ns) {
+			pacer->missed_deadlines++;
+			pacer->next_frame_ns = now + pacer->target_interval_ns;
+		}
+	}
+
+	if (pacer->last_frame_ns != 0) {
+		add_frame_time(&(pacer->frame_times), now - pacer->last_frame_ns);
+	}
+
+	pacer->last_frame_ns = now;
+}
+
+void add_frame_time(frame_time_histogram* histogram, const uint64_t frame_ns) {
+	uint64_t bucket;
+
+	bucket = frame_ns / FRAME_HISTOGRAM_BUCKET_NS;
+	if (bucket >= FRAME_HISTOGRAM_BUCKET_COUNT) {
+		bucket = FRAME_HISTOGRAM_BUCKET_COUNT - 1;
+	}
+
+	histogram->buckets[bucket]++;
+	histogram->count++;
+	histogram->total_ns += frame_ns;
+
+	if (frame_ns < histogram->min_ns) {
+		histogram->min_ns = frame_ns;
+	}
+
+	if (frame_ns > histogram->max_ns) {
+		histogram->max_ns = frame_ns;
+	}
+}
+
+void reset_frame_time_histogram(frame_time_histogram* histogram) {
+	memset(histogram->buckets, 0, sizeof(histogram->buckets));
+	histogram->count = 0;
+	histogram->total_ns = 0;
+	histogram->min_ns = UINT64_MAX;
+	histogram->max_ns = 0;
+}
+
+frame_time_percentiles get_frame_time_percentiles(const frame_time_histogram* histogram) {
+	frame_time_percentiles percentiles;
+
+	percentiles = {};
+
+	if (histogram->count == 0) {
+		return percentiles;
+	}
+
+	percentiles.p50_ms = get_bucket_percentile(histogram, 0.50);
+	percentiles.p95_ms = get_bucket_percentile(histogram, 0.95);
+	percentiles.p99_ms = get_bucket_percentile(histogram, 0.99);
+	percentiles.average_ms = (double)histogram->total_ns / (double)histogram->count / 1000000.0;
+	percentiles.min_ms = (double)histogram->min_ns / 1000000.0;
+	percentiles.max_ms = (double)histogram->max_ns / 1000000.0;
+
+	return percentiles;
+}
+
+string get_frame_pacing_report(const frame_pacer* pacer) {
+	frame_time_percentiles percentiles;
+	char report[512];
+
+	percentiles = get_frame_time_percentiles(&(pacer->frame_times));
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Frame times over %llu frames: p50 %.2fms, p95 %.2fms, p99 %.2fms "
+		"(avg %.2fms, min %.2fms, max %.2fms), %llu missed deadlines, %.1fms slept\n",
+		(unsigned long long)pacer->frame_times.count,
+		percentiles.p50_ms,
+		percentiles.p95_ms,
+		percentiles.p99_ms,
+		percentiles.average_ms,
+		percentiles.min_ms,
+		percentiles.max_ms,
+		(unsigned long long)pacer->missed_deadlines,
+		(double)pacer->time_slept_ns / 1000000.0
+	);
+
+	return report;
+}
+
+static double get_bucket_percentile(
+	const frame_time_histogram* histogram,
+	const double percentile
+) {
+	uint64_t rank;
+	uint64_t seen;
+	uint32_t i;
+
+	//
+	// Find the bucket the rank-th frame falls in, and report its
+	// middle. The answer is good to half a bucket (0.05ms).
+	//
+
+	rank = (uint64_t)(percentile * (double)(histogram->count - 1)) + 1;
+	seen = 0;
+
+	for (i = 0; i < FRAME_HISTOGRAM_BUCKET_COUNT; i++) {
+		seen += histogram->buckets[i];
+
+		if (seen >= rank) {
+			break;
+		}
+	}
+
+	// The last bucket has no upper end, so the best we can say there
+	// is the slowest frame.
+	if (i >= FRAME_HISTOGRAM_BUCKET_COUNT - 1) {
+		return (double)histogram->max_ns / 1000000.0;
+	}
+
+	return ((double)i + 0.5) * (double)FRAME_HISTOGRAM_BUCKET_NS / 1000000.0;
+}
@@ -0,0 +1,106 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Frame pacing. The pacer does two things:
+//
+//   - It can cap the frame rate. If a frame finishes early, it sleeps
+//     until the next frame is due rather than spinning, so a capped
+//     frame rate doesn't burn a core. Deadlines are kept on a fixed
+//     grid, so the average rate is exact even though each sleep isn't.
+//
+//   - It records how long every frame took in a histogram, so we can
+//     report the median and the slow frames (95th and 99th percentile),
+//     which say much more about smoothness than an average does.
+//
+// The clock and sleep are function pointers. They default to the OS's,
+// but a fake clock can be swapped in to test pacing without waiting
+// (see tools/frame_pacer_sim.cpp).
+//
+// Waiting on the swap chain itself (so we never queue up more frames
+// than the latency allows) is done by the dx12_handler.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Buckets are 0.1ms wide and cover 0 to 100ms. Anything slower goes
+// in the last bucket.
+const uint32_t FRAME_HISTOGRAM_BUCKET_COUNT = 1000;
+const uint64_t FRAME_HISTOGRAM_BUCKET_NS = 100000;
+
+// Returns the current time in nanoseconds.
+typedef uint64_t (*pacer_clock_fn)(void* user_data);
+// Sleeps for about the given number of nanoseconds. Sleeping too long
+// is fine, waking early is not.
+typedef void (*pacer_sleep_fn)(const uint64_t duration_ns, void* user_data);
+
+struct frame_time_histogram {
+	frame_time_histogram();
+
+	uint32_t buckets[FRAME_HISTOGRAM_BUCKET_COUNT];
+	uint64_t count;
+	uint64_t total_ns;
+	uint64_t min_ns;
+	uint64_t max_ns;
+};
+
+struct frame_pacer {
+	frame_pacer();
+
+	pacer_clock_fn clock;
+	pacer_sleep_fn sleep;
+	void* clock_user_data;
+
+	// 0 means the frame rate isn't capped.
+	uint64_t target_interval_ns;
+	// Sleeps are cut short by this much, and the rest is spun, for
+	// platforms whose sleep is too coarse to hit a deadline. 0 means
+	// never spin.
+	uint64_t spin_threshold_ns;
+
+	// When the next frame should start.
+	uint64_t next_frame_ns;
+	// When the last frame started, or 0 before the first frame.
+	uint64_t last_frame_ns;
+
+	frame_time_histogram frame_times;
+	// Frames that started late enough to miss their deadline.
+	uint64_t missed_deadlines;
+	uint64_t time_slept_ns;
+};
+
+struct frame_time_percentiles {
+	double p50_ms;
+	double p95_ms;
+	double p99_ms;
+	double average_ms;
+	double min_ms;
+	double max_ms;
+};
+
+// The OS clock and sleep.
+uint64_t get_system_time_ns(void* user_data);
+void sleep_system_ns(const uint64_t duration_ns, void* user_data);
+
+// frames_per_second of 0 means no cap.
+void initialize_frame_pacer(frame_pacer* pacer, const uint32_t frames_per_second);
+
+// Changes where the pacer gets its time from. Mostly for testing.
+void set_frame_pacer_clock(
+	frame_pacer* pacer,
+	pacer_clock_fn clock,
+	pacer_sleep_fn sleep,
+	void* user_data
+);
+
+// Call at the start of every frame. Waits until the frame is due, then
+// records how long the last frame took.
+void begin_paced_frame(frame_pacer* pacer);
+
+void add_frame_time(frame_time_histogram* histogram, const uint64_t frame_ns);
+void reset_frame_time_histogram(frame_time_histogram* histogram);
+frame_time_percentiles get_frame_time_percentiles(const frame_time_histogram* histogram);
+
+std::string get_frame_pacing_report(const frame_pacer* pacer);
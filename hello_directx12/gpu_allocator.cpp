@@ -0,0 +1,455 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "gpu_allocator.h"
+#include "utils.h"
+
+#include <cstdio>
+
+using namespace std;
+
+static const char* POOL_NAMES[GPU_POOL_COUNT] = {
+	"upload buffers",
+	"readback buffers",
+	"buffers",
+	"textures",
+	"render targets"
+};
+
+static uint32_t create_heap_block(
+	gpu_allocator* allocator,
+	const gpu_memory_pool pool,
+	const uint64_t size
+);
+
+gpu_allocation::gpu_allocation() {
+	heap = NULL;
+	offset = 0;
+	size = 0;
+	pool = 0;
+	block = 0;
+	handle = TLSF_INVALID_BLOCK;
+}
+
+gpu_allocator::gpu_allocator() {
+	block_size = GPU_HEAP_BLOCK_SIZE;
+	residency = NULL;
+}
+
+void initialize_gpu_allocator(
+	gpu_allocator* allocator,
+	ComPtr<ID3D12Device> dev,
+	const uint64_t block_size,
+	residency_manager* residency
+) {
+	uint32_t i;
+
+	allocator->device = dev;
+	allocator->residency = residency;
+
+	// Heaps that can hold MSAA textures have to be 4MB aligned, so
+	// keep the blocks a multiple of that.
+	allocator->block_size = block_size;
+	allocator->block_size += D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1;
+	allocator->block_size &= ~((uint64_t)D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+
+	for (i = 0; i < GPU_POOL_COUNT; i++) {
+		allocator->pools[i].clear();
+	}
+}
+
+gpu_memory_pool get_gpu_memory_pool(
+	const D3D12_HEAP_TYPE heap_type,
+	const D3D12_RESOURCE_DESC& desc
+) {
+	D3D12_RESOURCE_FLAGS rt_ds_flags;
+
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+		if (heap_type == D3D12_HEAP_TYPE_UPLOAD) {
+			return GPU_POOL_UPLOAD_BUFFERS;
+		}
+
+		if (heap_type == D3D12_HEAP_TYPE_READBACK) {
+			return GPU_POOL_READBACK_BUFFERS;
+		}
+
+		return GPU_POOL_BUFFERS;
+	}
+
+	rt_ds_flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET |
+		D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+
+	if (desc.Flags & rt_ds_flags) {
+		return GPU_POOL_RENDER_TARGETS;
+	}
+
+	return GPU_POOL_TEXTURES;
+}
+
+void allocate_gpu_memory(
+	gpu_allocator* allocator,
+	const gpu_memory_pool pool,
+	const uint64_t size,
+	const uint64_t alignment,
+	gpu_allocation* allocation
+) {
+	vector<gpu_heap_block>* blocks;
+	uint64_t offset;
+	uint64_t dedicated_size;
+	uint64_t pool_block_size;
+	uint32_t handle;
+	uint32_t block;
+
+	blocks = &(allocator->pools[pool]);
+	handle = TLSF_INVALID_BLOCK;
+	offset = 0;
+
+	//
+	// Try the heaps we already have first. Finding a spot in a heap
+	// is O(1), and there are only ever a handful of heaps.
+	//
+
+	for (block = 0; block < blocks->size(); block++) {
+		if (!(*blocks)[block].heap) {
+			continue;
+		}
+
+		handle = tlsf_allocate(&((*blocks)[block].allocator), size, alignment, &offset);
+		if (handle != TLSF_INVALID_BLOCK) {
+			break;
+		}
+	}
+
+	//
+	// Nothing fits, so make a new heap. Anything too big for a normal
+	// block gets a heap sized just for it.
+	//
+
+	if (handle == TLSF_INVALID_BLOCK) {
+		dedicated_size = size + alignment - 1;
+		dedicated_size += D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1;
+		dedicated_size &= ~((uint64_t)D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+
+		pool_block_size = allocator->block_size;
+		if (pool == GPU_POOL_READBACK_BUFFERS && pool_block_size > GPU_READBACK_HEAP_BLOCK_SIZE) {
+			pool_block_size = GPU_READBACK_HEAP_BLOCK_SIZE;
+		}
+
+		if (dedicated_size < pool_block_size) {
+			dedicated_size = pool_block_size;
+		}
+
+		block = create_heap_block(allocator, pool, dedicated_size);
+		handle = tlsf_allocate(&((*blocks)[block].allocator), size, alignment, &offset);
+
+		if (handle == TLSF_INVALID_BLOCK) {
+			throw_if_failed(E_OUTOFMEMORY);
+		}
+	}
+
+	allocation->heap = (*blocks)[block].heap.Get();
+	allocation->offset = offset;
+	allocation->size = size;
+	allocation->pool = (uint32_t)pool;
+	allocation->block = block;
+	allocation->handle = handle;
+}
+
+void create_placed_resource(
+	gpu_allocator* allocator,
+	const D3D12_HEAP_TYPE heap_type,
+	const D3D12_RESOURCE_DESC& desc,
+	const D3D12_RESOURCE_STATES initial_state,
+	const D3D12_CLEAR_VALUE* clear_value,
+	ID3D12Resource** resource,
+	gpu_allocation* allocation
+) {
+	D3D12_RESOURCE_DESC placed_desc;
+	D3D12_RESOURCE_ALLOCATION_INFO allocation_info;
+	gpu_memory_pool pool;
+	HRESULT result;
+
+	pool = get_gpu_memory_pool(heap_type, desc);
+	placed_desc = desc;
+
+	//
+	// Small textures can be placed at 4KB rather than 64KB, but only
+	// if we ask, and the device still gets to say no.
+	//
+
+	if (pool == GPU_POOL_TEXTURES && placed_desc.Alignment == 0) {
+		placed_desc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+		allocation_info = allocator->device->GetResourceAllocationInfo(0, 1, &placed_desc);
+
+		if (allocation_info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+			placed_desc.Alignment = 0;
+		}
+	}
+
+	allocation_info = allocator->device->GetResourceAllocationInfo(0, 1, &placed_desc);
+	if (allocation_info.SizeInBytes == UINT64_MAX) {
+		throw_if_failed(E_INVALIDARG);
+	}
+
+	allocate_gpu_memory(
+		allocator,
+		pool,
+		allocation_info.SizeInBytes,
+		allocation_info.Alignment,
+		allocation
+	);
+
+	result = allocator->device->CreatePlacedResource(
+		allocation->heap,
+		allocation->offset,
+		&placed_desc,
+		initial_state,
+		clear_value,
+		IID_PPV_ARGS(resource)
+	);
+
+	if (FAILED(result)) {
+		free_gpu_memory(allocator, allocation);
+	}
+
+	throw_if_failed(result);
+}
+
+void free_gpu_memory(gpu_allocator* allocator, gpu_allocation* allocation) {
+	gpu_heap_block* block;
+	vector<gpu_heap_block>* blocks;
+	uint32_t i;
+	uint32_t live_blocks;
+
+	if (!allocation->heap) {
+		return;
+	}
+
+	blocks = &(allocator->pools[allocation->pool]);
+	block = &((*blocks)[allocation->block]);
+
+	tlsf_free(&(block->allocator), allocation->handle);
+
+	//
+	// Let go of heaps nobody is using, but keep one per pool around
+	// so a pool that empties out and refills doesn't keep making and
+	// destroying heaps.
+	//
+
+	if (block->allocator.allocation_count == 0) {
+		live_blocks = 0;
+		for (i = 0; i < blocks->size(); i++) {
+			if ((*blocks)[i].heap) {
+				live_blocks++;
+			}
+		}
+
+		if (live_blocks > 1) {
+			if (block->residency != INVALID_RESIDENCY_HANDLE) {
+				untrack_residency(allocator->residency, block->residency);
+			}
+
+			block->heap.Reset();
+			initialize_tlsf_allocator(&(block->allocator), 0);
+		}
+	}
+
+	*allocation = gpu_allocation();
+}
+
+void use_gpu_memory(
+	gpu_allocator* allocator,
+	const gpu_allocation& allocation,
+	const uint64_t fence_value
+) {
+	residency_handle handle;
+
+	if (!allocation.heap) {
+		return;
+	}
+
+	handle = allocator->pools[allocation.pool][allocation.block].residency;
+	if (handle != INVALID_RESIDENCY_HANDLE) {
+		use_resident_object(allocator->residency, handle, fence_value);
+	}
+}
+
+uint64_t request_gpu_memory_residency(
+	gpu_allocator* allocator,
+	const gpu_allocation& allocation
+) {
+	residency_handle handle;
+
+	if (!allocation.heap) {
+		return 0;
+	}
+
+	handle = allocator->pools[allocation.pool][allocation.block].residency;
+	if (handle == INVALID_RESIDENCY_HANDLE) {
+		return 0;
+	}
+
+	return request_residency_async(allocator->residency, handle);
+}
+
+gpu_pool_stats get_gpu_pool_stats(
+	const gpu_allocator* allocator,
+	const gpu_memory_pool pool
+) {
+	gpu_pool_stats stats;
+	tlsf_stats block_stats;
+	uint64_t free_bytes;
+	float weighted_fragmentation;
+	size_t i;
+
+	stats = {};
+	free_bytes = 0;
+	weighted_fragmentation = 0.0f;
+
+	for (i = 0; i < allocator->pools[pool].size(); i++) {
+		if (!allocator->pools[pool][i].heap) {
+			continue;
+		}
+
+		block_stats = get_tlsf_stats(&(allocator->pools[pool][i].allocator));
+
+		stats.heap_count++;
+		stats.heap_bytes += block_stats.total_bytes;
+		stats.used_bytes += block_stats.used_bytes;
+		stats.allocation_count += block_stats.allocation_count;
+		stats.free_block_count += block_stats.free_block_count;
+
+		if (block_stats.largest_free_block > stats.largest_free_block) {
+			stats.largest_free_block = block_stats.largest_free_block;
+		}
+
+		free_bytes += block_stats.free_bytes;
+		weighted_fragmentation += block_stats.fragmentation * (float)block_stats.free_bytes;
+	}
+
+	if (free_bytes > 0) {
+		stats.fragmentation = weighted_fragmentation / (float)free_bytes;
+	}
+
+	return stats;
+}
+
+string get_gpu_allocator_report(const gpu_allocator* allocator) {
+	gpu_pool_stats stats;
+	char line[256];
+	string report;
+	uint32_t i;
+
+	report = "GPU memory:\n";
+
+	for (i = 0; i < GPU_POOL_COUNT; i++) {
+		stats = get_gpu_pool_stats(allocator, (gpu_memory_pool)i);
+
+		snprintf(
+			line,
+			sizeof(line),
+			"  %-16s %u heaps, %.1fMB of %.1fMB used by %u allocations, "
+			"%u free blocks, %.0f%% fragmented\n",
+			POOL_NAMES[i],
+			stats.heap_count,
+			(double)stats.used_bytes / (1024.0 * 1024.0),
+			(double)stats.heap_bytes / (1024.0 * 1024.0),
+			stats.allocation_count,
+			stats.free_block_count,
+			stats.fragmentation * 100.0f
+		);
+
+		report += line;
+	}
+
+	return report;
+}
+
+static uint32_t create_heap_block(
+	gpu_allocator* allocator,
+	const gpu_memory_pool pool,
+	const uint64_t size
+) {
+	CD3DX12_HEAP_DESC heap_desc;
+	vector<gpu_heap_block>* blocks;
+	D3D12_HEAP_TYPE heap_type;
+	D3D12_HEAP_FLAGS heap_flags;
+	uint64_t alignment;
+	uint32_t block;
+	HRESULT result;
+
+	heap_type = D3D12_HEAP_TYPE_DEFAULT;
+	alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+	switch (pool) {
+		case GPU_POOL_UPLOAD_BUFFERS:
+			heap_type = D3D12_HEAP_TYPE_UPLOAD;
+			heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+			break;
+
+		case GPU_POOL_READBACK_BUFFERS:
+			heap_type = D3D12_HEAP_TYPE_READBACK;
+			heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+			break;
+
+		case GPU_POOL_BUFFERS:
+			heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+			break;
+
+		case GPU_POOL_TEXTURES:
+			heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+			break;
+
+		default:
+			// Render targets might be multisampled.
+			heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+			alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+			break;
+	}
+
+	//
+	// Reuse a released slot if there is one, so the block indices in
+	// live allocations stay valid.
+	//
+
+	blocks = &(allocator->pools[pool]);
+
+	for (block = 0; block < blocks->size(); block++) {
+		if (!(*blocks)[block].heap) {
+			break;
+		}
+	}
+
+	if (block == blocks->size()) {
+		blocks->push_back(gpu_heap_block());
+	}
+
+	heap_desc = CD3DX12_HEAP_DESC(size, heap_type, alignment, heap_flags);
+
+	result = allocator->device->CreateHeap(
+		&heap_desc,
+		IID_PPV_ARGS((*blocks)[block].heap.ReleaseAndGetAddressOf())
+	);
+
+	throw_if_failed(result);
+
+	initialize_tlsf_allocator(&((*blocks)[block].allocator), size);
+
+	//
+	// Upload and readback heaps are in system memory, which isn't what
+	// the budget is for (and the CPU touches them whenever it likes),
+	// so only the video memory heaps are tracked.
+	//
+
+	(*blocks)[block].residency = INVALID_RESIDENCY_HANDLE;
+	if (allocator->residency && heap_type == D3D12_HEAP_TYPE_DEFAULT) {
+		// Track it as a pageable, since that's what Evict and
+		// MakeResident take.
+		(*blocks)[block].residency = track_residency(
+			allocator->residency,
+			static_cast<ID3D12Pageable*>((*blocks)[block].heap.Get()),
+			size
+		);
+	}
+
+	return block;
+}
@@ -0,0 +1,143 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Instead of giving every buffer and texture its own committed
+// resource (and so its own heap, which the driver has to create and
+// page in separately), we create a few big ID3D12Heaps up front and
+// place resources in them. The space in each heap is handed out with
+// a TLSF allocator (see tlsf_allocator.h).
+//
+// Resources are split into pools by what heap they need. Upload and
+// readback buffers need heaps of those types, and on older hardware (resource heap
+// tier 1) buffers, regular textures, and render target / depth
+// textures can't share a heap, so each of those gets its own pool too.
+// A pool grows by a block (one heap) at a time.
+//
+// If given a residency manager, every heap is tracked by it, so heaps
+// can be evicted when we go over the video memory budget. Whatever
+// uses an allocation has to say so with use_gpu_memory.
+//
+
+#pragma once
+
+#include "stdafx.h"
+#include "residency_manager.h"
+#include "tlsf_allocator.h"
+
+#include <string>
+
+// Each heap in a pool is this big, unless a single resource needs more.
+const uint64_t GPU_HEAP_BLOCK_SIZE = 64 * 1024 * 1024;
+// Readback buffers are few and small, so their heaps are too.
+const uint64_t GPU_READBACK_HEAP_BLOCK_SIZE = 4 * 1024 * 1024;
+
+enum gpu_memory_pool {
+	GPU_POOL_UPLOAD_BUFFERS,
+	GPU_POOL_READBACK_BUFFERS,
+	GPU_POOL_BUFFERS,
+	GPU_POOL_TEXTURES,
+	GPU_POOL_RENDER_TARGETS,
+	GPU_POOL_COUNT
+};
+
+struct gpu_heap_block {
+	// NULL if the block has been released and the slot can be reused.
+	ComPtr<ID3D12Heap> heap;
+	tlsf_allocator allocator;
+	residency_handle residency;
+};
+
+struct gpu_allocation {
+	gpu_allocation();
+
+	// NULL if nothing is allocated.
+	ID3D12Heap* heap;
+	uint64_t offset;
+	uint64_t size;
+
+	// Where the allocation came from, so we can give it back.
+	uint32_t pool;
+	uint32_t block;
+	uint32_t handle;
+};
+
+struct gpu_pool_stats {
+	uint32_t heap_count;
+	uint64_t heap_bytes;
+	uint64_t used_bytes;
+	uint64_t largest_free_block;
+	uint32_t allocation_count;
+	uint32_t free_block_count;
+	// Averaged over the pool's heaps, weighted by their free space.
+	float fragmentation;
+};
+
+struct gpu_allocator {
+	gpu_allocator();
+
+	ComPtr<ID3D12Device> device;
+	uint64_t block_size;
+	std::vector<gpu_heap_block> pools[GPU_POOL_COUNT];
+	// Can be NULL, in which case heaps are always resident.
+	residency_manager* residency;
+};
+
+void initialize_gpu_allocator(
+	gpu_allocator* allocator,
+	ComPtr<ID3D12Device> dev,
+	const uint64_t block_size,
+	residency_manager* residency
+);
+
+// Which pool a resource with this description has to go in.
+gpu_memory_pool get_gpu_memory_pool(
+	const D3D12_HEAP_TYPE heap_type,
+	const D3D12_RESOURCE_DESC& desc
+);
+
+// Reserves raw memory from a pool. This is for things that place
+// several resources themselves, like the frame graph's transients.
+void allocate_gpu_memory(
+	gpu_allocator* allocator,
+	const gpu_memory_pool pool,
+	const uint64_t size,
+	const uint64_t alignment,
+	gpu_allocation* allocation
+);
+
+// The placed resource version of CreateCommittedResource.
+void create_placed_resource(
+	gpu_allocator* allocator,
+	const D3D12_HEAP_TYPE heap_type,
+	const D3D12_RESOURCE_DESC& desc,
+	const D3D12_RESOURCE_STATES initial_state,
+	const D3D12_CLEAR_VALUE* clear_value,
+	ID3D12Resource** resource,
+	gpu_allocation* allocation
+);
+
+// Gives the memory back. Whatever was placed there must be released
+// first, and the GPU must be done with it.
+void free_gpu_memory(gpu_allocator* allocator, gpu_allocation* allocation);
+
+// Says the allocation is used by GPU work that completes at
+// fence_value, so its heap has to be resident for it.
+void use_gpu_memory(
+	gpu_allocator* allocator,
+	const gpu_allocation& allocation,
+	const uint64_t fence_value
+);
+
+// For streaming: asks for the allocation's heap to be made resident in
+// the background. Returns the residency fence value to wait for.
+uint64_t request_gpu_memory_residency(
+	gpu_allocator* allocator,
+	const gpu_allocation& allocation
+);
+
+gpu_pool_stats get_gpu_pool_stats(
+	const gpu_allocator* allocator,
+	const gpu_memory_pool pool
+);
+
+std::string get_gpu_allocator_report(const gpu_allocator* allocator);
@@ -0,0 +1,160 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "gpu_culling.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static bool compare_commands(const indirect_command& a, const indirect_command& b);
+
+void extract_frustum_planes(
+	const float view_projection[16],
+	float planes[FRUSTUM_PLANE_COUNT][4]
+) {
+	float column[4][4];
+	float length;
+	uint32_t plane;
+	uint32_t i;
+
+	//
+	// A point p is in clip space at p * M, so each clip coordinate is p
+	// dotted with a column of M. The point is inside when -w <= x <= w,
+	// -w <= y <= w and 0 <= z <= w, and each of those is a plane made
+	// from two of the columns.
+	//
+
+	for (i = 0; i < 4; i++) {
+		column[i][0] = view_projection[0 * 4 + i];
+		column[i][1] = view_projection[1 * 4 + i];
+		column[i][2] = view_projection[2 * 4 + i];
+		column[i][3] = view_projection[3 * 4 + i];
+	}
+
+	for (i = 0; i < 4; i++) {
+		planes[0][i] = column[3][i] + column[0][i];
+		planes[1][i] = column[3][i] - column[0][i];
+		planes[2][i] = column[3][i] + column[1][i];
+		planes[3][i] = column[3][i] - column[1][i];
+		planes[4][i] = column[2][i];
+		planes[5][i] = column[3][i] - column[2][i];
+	}
+
+	// Normalized, so the distances are in world units and can be
+	// compared with the spheres' radii.
+	for (plane = 0; plane < FRUSTUM_PLANE_COUNT; plane++) {
+		length = sqrtf(
+			planes[plane][0] * planes[plane][0] +
+			planes[plane][1] * planes[plane][1] +
+			planes[plane][2] * planes[plane][2]
+		);
+
+		if (length > 0.0f) {
+			for (i = 0; i < 4; i++) {
+				planes[plane][i] /= length;
+			}
+		}
+	}
+}
+
+bool is_object_visible(const gpu_object* object, const float planes[FRUSTUM_PLANE_COUNT][4]) {
+	float center[3];
+	float scale;
+	float radius;
+	float distance;
+	uint32_t plane;
+	uint32_t i;
+
+	//
+	// Move the sphere into the world. Its centre goes through the world
+	// matrix, and its radius grows by the most the matrix scales any
+	// axis, so it still covers the object however it's stretched.
+	//
+
+	for (i = 0; i < 3; i++) {
+		center[i] =
+			object->bounds[0] * object->world[0][i] +
+			object->bounds[1] * object->world[1][i] +
+			object->bounds[2] * object->world[2][i] +
+			object->world[3][i];
+	}
+
+	scale = 0.0f;
+	for (i = 0; i < 3; i++) {
+		scale = max(
+			scale,
+			object->world[i][0] * object->world[i][0] +
+			object->world[i][1] * object->world[i][1] +
+			object->world[i][2] * object->world[i][2]
+		);
+	}
+
+	radius = object->bounds[3] * sqrtf(scale);
+
+	// Outside if it's entirely behind any one plane.
+	for (plane = 0; plane < FRUSTUM_PLANE_COUNT; plane++) {
+		distance =
+			planes[plane][0] * center[0] +
+			planes[plane][1] * center[1] +
+			planes[plane][2] * center[2] +
+			planes[plane][3];
+
+		if (distance < -radius) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void cull_objects(
+	const gpu_object* objects,
+	const culling_constants* constants,
+	const uint32_t first,
+	const uint32_t last,
+	indirect_command* commands,
+	atomic<uint32_t>* counter
+) {
+	const gpu_object* object;
+	indirect_command* command;
+	uint64_t constants_address;
+	uint32_t slot;
+	uint32_t i;
+
+	constants_address =
+		(uint64_t)constants->constants_address[0] |
+		((uint64_t)constants->constants_address[1] << 32);
+
+	for (i = first; i < last && i < constants->object_count; i++) {
+		object = &(objects[i]);
+
+		if (!is_object_visible(object, constants->planes)) {
+			continue;
+		}
+
+		slot = counter->fetch_add(1);
+		if (slot >= constants->max_commands) {
+			continue;
+		}
+
+		command = &(commands[slot]);
+		command->constants_address = constants_address + (uint64_t)i * constants->constant_stride;
+		command->material = object->material;
+		command->draw.index_count_per_instance = object->index_count;
+		command->draw.instance_count = 1;
+		command->draw.start_index_location = object->first_index;
+		command->draw.base_vertex_location = object->base_vertex;
+		command->draw.start_instance_location = 0;
+	}
+}
+
+void sort_indirect_commands(indirect_command* commands, const uint32_t count, const uint32_t max_commands) {
+	// Every object's constants come after the one before it's, so the
+	// addresses are in object order.
+	sort(commands, commands + min(count, max_commands), compare_commands);
+}
+
+static bool compare_commands(const indirect_command& a, const indirect_command& b) {
+	return a.constants_address < b.constants_address;
+}
@@ -0,0 +1,118 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// GPU-driven drawing. Instead of the CPU recording a draw for every
+// object, each object's data goes in a buffer, and a compute shader
+// (cull_shader.hlsl) frustum culls them and writes a draw command for
+// every one that's visible. A single ExecuteIndirect then draws
+// whatever the shader wrote, however many that turns out to be.
+//
+// Each visible object takes the next slot from a counter, which the
+// shader bumps with an atomic add, so the commands are packed at the
+// front of the buffer and the counter ends up as the number of draws.
+// ExecuteIndirect reads that count straight from the GPU buffer, so the
+// CPU never needs to know it.
+//
+// cull_objects here is the same shader, line for line, on the CPU. It
+// writes the same commands, and is what the application uses if
+// GPU_CULLING is off. The one difference is order: GPU threads get to
+// the counter in whatever order they like, so compare the two after
+// sort_indirect_commands.
+//
+// The structs below are what the shaders see, so they're all 4 byte
+// fields and must match cull_shader.hlsl.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// The frustum has six planes: left, right, bottom, top, near, far.
+const uint32_t FRUSTUM_PLANE_COUNT = 6;
+// Threads in one of the culling shader's groups.
+const uint32_t CULLING_GROUP_SIZE = 64;
+
+// Same layout as D3D12_DRAW_INDEXED_ARGUMENTS.
+struct draw_indexed_arguments {
+	uint32_t index_count_per_instance;
+	uint32_t instance_count;
+	uint32_t start_index_location;
+	int32_t base_vertex_location;
+	uint32_t start_instance_location;
+};
+
+static_assert(sizeof(draw_indexed_arguments) == 20, "draw_indexed_arguments must match D3D12_DRAW_INDEXED_ARGUMENTS");
+
+// Everything needed to cull and draw an object.
+struct gpu_object {
+	// The world matrix, row by row, like the rest of our matrices.
+	float world[4][4];
+	// A sphere around the object, in its own space: the centre, then
+	// the radius.
+	float bounds[4];
+	uint32_t index_count;
+	uint32_t first_index;
+	int32_t base_vertex;
+	uint32_t material;
+};
+
+static_assert(sizeof(gpu_object) == 96, "gpu_object must match the HLSL struct");
+
+// One draw for ExecuteIndirect. The command signature sets the root
+// CBV and the material root constant, then draws.
+struct indirect_command {
+	// The object's slice of the constant buffer (its MVP matrix).
+	uint64_t constants_address;
+	uint32_t material;
+	draw_indexed_arguments draw;
+};
+
+static_assert(sizeof(indirect_command) == 32, "indirect_command must match the HLSL struct");
+
+// The culling shader's root constants.
+struct culling_constants {
+	// Pointing inwards, and normalized, so a point's signed distance
+	// from a plane is dot(plane.xyz, point) + plane.w.
+	float planes[FRUSTUM_PLANE_COUNT][4];
+	uint32_t object_count;
+	// How many commands the buffer has room for. Visible objects past
+	// this still count, but aren't written.
+	uint32_t max_commands;
+	// Object i's constants are at constants_address + i *
+	// constant_stride. The address is split in two (low, then high) so
+	// the struct has no padding.
+	uint32_t constants_address[2];
+	uint32_t constant_stride;
+};
+
+static_assert(sizeof(culling_constants) == 29 * 4, "culling_constants must match the root constants");
+
+// Gets the frustum planes of a row-major view * projection matrix (the
+// kind DirectXMath makes), for a depth range of 0 to 1.
+void extract_frustum_planes(
+	const float view_projection[16],
+	float planes[FRUSTUM_PLANE_COUNT][4]
+);
+
+// What one thread of the culling shader decides.
+bool is_object_visible(const gpu_object* object, const float planes[FRUSTUM_PLANE_COUNT][4]);
+
+// Runs the culling shader's threads from first to last - 1, writing
+// commands for the visible objects and bumping counter for each. On
+// one thread, over every object, the commands come out in object
+// order. It's safe to split the objects across threads, just as the
+// GPU does.
+void cull_objects(
+	const gpu_object* objects,
+	const culling_constants* constants,
+	const uint32_t first,
+	const uint32_t last,
+	indirect_command* commands,
+	std::atomic<uint32_t>* counter
+);
+
+// Puts commands in object order, whatever order they were written in.
+// count is the counter's final value; only the commands that fit in
+// max_commands are sorted.
+void sort_indirect_commands(indirect_command* commands, const uint32_t count, const uint32_t max_commands);
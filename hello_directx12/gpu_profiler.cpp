@@ -0,0 +1,290 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "gpu_profiler.h"
+#include "utils.h"
+
+using namespace std;
+
+const uint32_t INVALID_GPU_ZONE = 0xffffffff;
+const uint32_t QUERIES_PER_FRAME = GPU_PROFILER_MAX_ZONES * 2;
+
+static void calibrate_gpu_clock(gpu_profiler* gpu_prof);
+static void read_back_frame(gpu_profiler* gpu_prof, const uint32_t frame);
+static uint64_t gpu_ticks_to_profile_ticks(gpu_profiler* gpu_prof, const uint64_t gpu_ticks);
+
+gpu_profiler::gpu_profiler() {
+	uint32_t i;
+
+	timestamp_frequency = 0;
+	frame_index = 0;
+	frame_count = 0;
+	calibration_gpu_ticks = 0;
+	calibration_cpu_ticks = 0;
+	track = NULL;
+
+	for (i = 0; i < GPU_PROFILER_FRAME_COUNT; i++) {
+		frames[i].query_count = 0;
+		frames[i].fence_value = 0;
+	}
+}
+
+gpu_profile_scope::gpu_profile_scope(
+	gpu_profiler* gpu_prof,
+	ID3D12GraphicsCommandList* command_list,
+	const char* name
+) {
+	this->gpu_prof = gpu_prof;
+	this->command_list = command_list;
+	zone = begin_gpu_zone(gpu_prof, command_list, name);
+}
+
+gpu_profile_scope::~gpu_profile_scope() {
+	end_gpu_zone(gpu_prof, command_list, zone);
+}
+
+void initialize_gpu_profiler(
+	gpu_profiler* gpu_prof,
+	ComPtr<ID3D12Device> dev,
+	gpu_allocator* allocator,
+	ComPtr<ID3D12CommandQueue> command_queue
+) {
+	D3D12_QUERY_HEAP_DESC query_heap_desc;
+	CD3DX12_RESOURCE_DESC readback_desc;
+	HRESULT result;
+
+	gpu_prof->command_queue = command_queue;
+
+	//
+	// One query heap holds every frame's timestamps, each frame in a
+	// range of its own, and the readback buffer is laid out the same.
+	//
+
+	query_heap_desc = {};
+	query_heap_desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	query_heap_desc.Count = QUERIES_PER_FRAME * GPU_PROFILER_FRAME_COUNT;
+
+	result = dev->CreateQueryHeap(&query_heap_desc, IID_PPV_ARGS(&(gpu_prof->query_heap)));
+	throw_if_failed(result);
+
+	readback_desc = CD3DX12_RESOURCE_DESC::Buffer(
+		sizeof(uint64_t) * QUERIES_PER_FRAME * GPU_PROFILER_FRAME_COUNT
+	);
+
+	create_placed_resource(
+		allocator,
+		D3D12_HEAP_TYPE_READBACK,
+		readback_desc,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		NULL,
+		&(gpu_prof->readback_buffer),
+		&(gpu_prof->readback_memory)
+	);
+
+	result = command_queue->GetTimestampFrequency(&(gpu_prof->timestamp_frequency));
+	throw_if_failed(result);
+
+	calibrate_gpu_clock(gpu_prof);
+
+	gpu_prof->track = create_profile_track(get_profiler(), "GPU");
+}
+
+void begin_gpu_profile_frame(gpu_profiler* gpu_prof, const uint64_t completed_fence) {
+	gpu_profiler_frame* frame;
+	uint32_t i;
+
+	//
+	// Read back every frame the GPU has finished, oldest first, so
+	// the events go into the track in order.
+	//
+
+	for (i = 1; i <= GPU_PROFILER_FRAME_COUNT; i++) {
+		frame = &(gpu_prof->frames[(gpu_prof->frame_index + i) % GPU_PROFILER_FRAME_COUNT]);
+
+		if (frame->fence_value != 0 && frame->fence_value <= completed_fence) {
+			read_back_frame(gpu_prof, (gpu_prof->frame_index + i) % GPU_PROFILER_FRAME_COUNT);
+		}
+	}
+
+	if (gpu_prof->frame_count % GPU_PROFILER_CALIBRATION_INTERVAL == 0) {
+		calibrate_gpu_clock(gpu_prof);
+	}
+
+	//
+	// If the GPU is more than GPU_PROFILER_FRAME_COUNT frames behind,
+	// this frame's slot still hasn't been read. Drop its timings
+	// rather than wait for it.
+	//
+
+	frame = &(gpu_prof->frames[gpu_prof->frame_index]);
+	frame->zones.clear();
+	frame->query_count = 0;
+	frame->fence_value = 0;
+
+	gpu_prof->open_zones.clear();
+}
+
+uint32_t begin_gpu_zone(
+	gpu_profiler* gpu_prof,
+	ID3D12GraphicsCommandList* command_list,
+	const char* name
+) {
+	gpu_profiler_frame* frame;
+	gpu_profile_zone zone;
+
+	frame = &(gpu_prof->frames[gpu_prof->frame_index]);
+
+	if (frame->query_count + 2 > QUERIES_PER_FRAME) {
+		return INVALID_GPU_ZONE;
+	}
+
+	zone.name = name;
+	zone.begin_query = gpu_prof->frame_index * QUERIES_PER_FRAME + frame->query_count++;
+	zone.end_query = gpu_prof->frame_index * QUERIES_PER_FRAME + frame->query_count++;
+
+	command_list->EndQuery(
+		gpu_prof->query_heap.Get(),
+		D3D12_QUERY_TYPE_TIMESTAMP,
+		zone.begin_query
+	);
+
+	frame->zones.push_back(zone);
+	gpu_prof->open_zones.push_back((uint32_t)(frame->zones.size() - 1));
+
+	return (uint32_t)(frame->zones.size() - 1);
+}
+
+void end_gpu_zone(
+	gpu_profiler* gpu_prof,
+	ID3D12GraphicsCommandList* command_list,
+	const uint32_t zone
+) {
+	gpu_profiler_frame* frame;
+
+	if (zone == INVALID_GPU_ZONE) {
+		return;
+	}
+
+	frame = &(gpu_prof->frames[gpu_prof->frame_index]);
+
+	// Zones have to nest.
+	assert(!gpu_prof->open_zones.empty() && gpu_prof->open_zones.back() == zone);
+	gpu_prof->open_zones.pop_back();
+
+	command_list->EndQuery(
+		gpu_prof->query_heap.Get(),
+		D3D12_QUERY_TYPE_TIMESTAMP,
+		frame->zones[zone].end_query
+	);
+}
+
+void end_gpu_profile_frame(
+	gpu_profiler* gpu_prof,
+	ID3D12GraphicsCommandList* command_list,
+	const uint64_t fence_value
+) {
+	gpu_profiler_frame* frame;
+	uint32_t first_query;
+
+	frame = &(gpu_prof->frames[gpu_prof->frame_index]);
+
+	assert(gpu_prof->open_zones.empty());
+
+	if (frame->query_count > 0) {
+		first_query = gpu_prof->frame_index * QUERIES_PER_FRAME;
+
+		command_list->ResolveQueryData(
+			gpu_prof->query_heap.Get(),
+			D3D12_QUERY_TYPE_TIMESTAMP,
+			first_query,
+			frame->query_count,
+			gpu_prof->readback_buffer.Get(),
+			sizeof(uint64_t) * first_query
+		);
+
+		frame->fence_value = fence_value;
+	}
+
+	gpu_prof->frame_index = (gpu_prof->frame_index + 1) % GPU_PROFILER_FRAME_COUNT;
+	gpu_prof->frame_count++;
+}
+
+void shutdown_gpu_profiler(gpu_profiler* gpu_prof, gpu_allocator* allocator) {
+	gpu_prof->readback_buffer.Reset();
+	free_gpu_memory(allocator, &(gpu_prof->readback_memory));
+	gpu_prof->query_heap.Reset();
+}
+
+static void calibrate_gpu_clock(gpu_profiler* gpu_prof) {
+	uint64_t cpu_qpc;
+	HRESULT result;
+
+	//
+	// GetClockCalibration gives the CPU time as a QPC value, but our
+	// timeline is profile ticks, so read those straight after. The two
+	// are only a few hundred nanoseconds apart.
+	//
+
+	result = gpu_prof->command_queue->GetClockCalibration(
+		&(gpu_prof->calibration_gpu_ticks),
+		&cpu_qpc
+	);
+
+	throw_if_failed(result);
+
+	gpu_prof->calibration_cpu_ticks = profile_now();
+}
+
+static void read_back_frame(gpu_profiler* gpu_prof, const uint32_t frame_index) {
+	gpu_profiler_frame* frame;
+	D3D12_RANGE read_range;
+	D3D12_RANGE written_range;
+	uint64_t* timestamps;
+	uint64_t begin;
+	uint64_t end;
+	size_t i;
+	HRESULT result;
+
+	frame = &(gpu_prof->frames[frame_index]);
+
+	read_range.Begin = sizeof(uint64_t) * frame_index * QUERIES_PER_FRAME;
+	read_range.End = read_range.Begin + sizeof(uint64_t) * frame->query_count;
+
+	timestamps = NULL;
+	result = gpu_prof->readback_buffer->Map(0, &read_range, (void**)&timestamps);
+	throw_if_failed(result);
+
+	for (i = 0; i < frame->zones.size(); i++) {
+		begin = timestamps[frame->zones[i].begin_query];
+		end = timestamps[frame->zones[i].end_query];
+
+		// A zone that was never ended has no end timestamp.
+		if (end < begin) {
+			continue;
+		}
+
+		record_profile_event(
+			gpu_prof->track,
+			frame->zones[i].name,
+			gpu_ticks_to_profile_ticks(gpu_prof, begin),
+			gpu_ticks_to_profile_ticks(gpu_prof, end)
+		);
+	}
+
+	// We didn't write anything.
+	written_range = {};
+	gpu_prof->readback_buffer->Unmap(0, &written_range);
+
+	frame->fence_value = 0;
+}
+
+static uint64_t gpu_ticks_to_profile_ticks(gpu_profiler* gpu_prof, const uint64_t gpu_ticks) {
+	double gpu_ns;
+	double profile_ticks;
+
+	gpu_ns = ((double)gpu_ticks - (double)gpu_prof->calibration_gpu_ticks) *
+		1000000000.0 / (double)gpu_prof->timestamp_frequency;
+
+	profile_ticks = (double)gpu_prof->calibration_cpu_ticks + gpu_ns / get_profiler()->ns_per_tick;
+
+	return profile_ticks > 0.0 ? (uint64_t)profile_ticks : 0;
+}
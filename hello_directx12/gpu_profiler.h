@@ -0,0 +1,112 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Times regions of a command list on the GPU. Each zone writes a
+// timestamp query when it begins and another when it ends. At the end
+// of the frame the queries are resolved into a readback buffer, and a
+// few frames later (once the GPU is done with that frame) we read them
+// back and hand them to the profiler as events on a "GPU" track.
+//
+// GPU timestamps count in the GPU's own ticks. GetClockCalibration
+// tells us what GPU tick lines up with what CPU time, which is enough
+// to put the GPU zones on the same timeline as the CPU ones.
+//
+
+#pragma once
+
+#include "stdafx.h"
+#include "gpu_allocator.h"
+#include "profiler.h"
+
+// Frames whose timings can be in flight at once.
+const uint32_t GPU_PROFILER_FRAME_COUNT = 3;
+const uint32_t GPU_PROFILER_MAX_ZONES = 256;
+// Re-measure how GPU and CPU time line up every so often, since the
+// two clocks drift.
+const uint32_t GPU_PROFILER_CALIBRATION_INTERVAL = 60;
+
+struct gpu_profile_zone {
+	const char* name;
+	uint32_t begin_query;
+	uint32_t end_query;
+};
+
+struct gpu_profiler_frame {
+	std::vector<gpu_profile_zone> zones;
+	uint32_t query_count;
+	// The fence value that says the GPU has finished the frame, or 0
+	// if there's nothing to read back.
+	uint64_t fence_value;
+};
+
+struct gpu_profiler {
+	gpu_profiler();
+
+	ComPtr<ID3D12QueryHeap> query_heap;
+	ComPtr<ID3D12Resource> readback_buffer;
+	gpu_allocation readback_memory;
+	ComPtr<ID3D12CommandQueue> command_queue;
+	uint64_t timestamp_frequency;
+
+	gpu_profiler_frame frames[GPU_PROFILER_FRAME_COUNT];
+	uint32_t frame_index;
+	uint64_t frame_count;
+	// Zones begun but not yet ended this frame.
+	std::vector<uint32_t> open_zones;
+
+	uint64_t calibration_gpu_ticks;
+	uint64_t calibration_cpu_ticks;
+
+	profile_track* track;
+};
+
+void initialize_gpu_profiler(
+	gpu_profiler* gpu_prof,
+	ComPtr<ID3D12Device> dev,
+	gpu_allocator* allocator,
+	ComPtr<ID3D12CommandQueue> command_queue
+);
+
+// Call after resetting the frame's command list. Reads back any
+// finished frame's timings.
+void begin_gpu_profile_frame(gpu_profiler* gpu_prof, const uint64_t completed_fence);
+
+uint32_t begin_gpu_zone(
+	gpu_profiler* gpu_prof,
+	ID3D12GraphicsCommandList* command_list,
+	const char* name
+);
+
+void end_gpu_zone(
+	gpu_profiler* gpu_prof,
+	ID3D12GraphicsCommandList* command_list,
+	const uint32_t zone
+);
+
+// Call before closing the frame's command list. fence_value is what
+// the fence will be signalled with once the GPU has run it.
+void end_gpu_profile_frame(
+	gpu_profiler* gpu_prof,
+	ID3D12GraphicsCommandList* command_list,
+	const uint64_t fence_value
+);
+
+// Must be released while the GPU is idle.
+void shutdown_gpu_profiler(gpu_profiler* gpu_prof, gpu_allocator* allocator);
+
+// Times its own lifetime on the GPU. Use through GPU_PROFILE_ZONE.
+struct gpu_profile_scope {
+	gpu_profile_scope(
+		gpu_profiler* gpu_prof,
+		ID3D12GraphicsCommandList* command_list,
+		const char* name
+	);
+	~gpu_profile_scope();
+
+	gpu_profiler* gpu_prof;
+	ID3D12GraphicsCommandList* command_list;
+	uint32_t zone;
+};
+
+#define GPU_PROFILE_ZONE(gpu_prof, command_list, name) \
+	gpu_profile_scope PROFILE_CONCAT(gpu_profile_zone_, __LINE__)(gpu_prof, command_list, name)
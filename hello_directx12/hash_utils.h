@@ -0,0 +1,56 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Small hashing helpers shared by the caches and archives. These
+// are FNV-1a hashes: they are not cryptographic, but they are fast,
+// simple, and stable across runs and platforms. That last part is
+// the important bit, since we write these hashes to disk as keys.
+//
+// Unlike stdafx.h, this file has no Windows dependencies, so the
+// platform-neutral code can include it directly.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+inline uint64_t hash_bytes(
+	const void* data,
+	const size_t size,
+	uint64_t seed = FNV_OFFSET_BASIS
+) {
+	const uint8_t* bytes;
+	size_t i;
+
+	bytes = (const uint8_t*)data;
+
+	for (i = 0; i < size; i++) {
+		seed ^= bytes[i];
+		seed *= FNV_PRIME;
+	}
+
+	return seed;
+}
+
+inline uint64_t hash_string(
+	const std::string& str,
+	uint64_t seed = FNV_OFFSET_BASIS
+) {
+	uint64_t length;
+
+	// Hash the length as well so that ("ab", "c") and ("a", "bc")
+	// don't produce the same result when hashed one after another.
+	length = (uint64_t)str.size();
+	seed = hash_bytes(&length, sizeof(length), seed);
+
+	return hash_bytes(str.data(), str.size(), seed);
+}
+
+inline uint64_t hash_combine(const uint64_t seed, const uint64_t value) {
+	return hash_bytes(&value, sizeof(value), seed);
+}
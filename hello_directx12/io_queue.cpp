@@ -0,0 +1,964 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "io_queue.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // ! WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static void finish_request(io_queue* queue, io_request* request, const bool succeeded);
+static void run_thread_pool_worker(io_queue* queue);
+
+// These differ by platform.
+static bool start_backend(io_queue* queue);
+static void stop_backend(io_queue* queue);
+static void run_io_thread(io_queue* queue);
+static void wake_io_thread(io_queue* queue);
+// Reads all of request, one blocking read after another, for the thread
+// pool. Adds the reads it took to system_calls.
+static bool read_request(io_request* request, uint64_t* system_calls);
+
+io_file::io_file() {
+	size = 0;
+
+#if defined(_WIN32)
+	file_handle = NULL;
+#else
+	file_descriptor = -1;
+#endif
+}
+
+io_batch::io_batch() {
+	pending = 0;
+	failures = 0;
+}
+
+io_queue::io_queue() {
+	backend = IO_BACKEND_THREADS;
+	depth = 0;
+	in_flight = 0;
+	stopping = false;
+	state = NULL;
+	stats = {};
+}
+
+void initialize_io_queue(io_queue* queue, const uint32_t depth, const bool use_threads) {
+	uint32_t thread_count;
+	uint32_t i;
+
+	queue->depth = min(max(depth, 1u), MAX_IO_QUEUE_DEPTH);
+	queue->in_flight = 0;
+	queue->stopping = false;
+	queue->stats = {};
+
+	if (!use_threads && start_backend(queue)) {
+		queue->threads.push_back(thread(run_io_thread, queue));
+		return;
+	}
+
+	//
+	// Either we were asked for the thread pool, or there's nothing
+	// better. Each thread is a read in flight.
+	//
+
+	queue->backend = IO_BACKEND_THREADS;
+	thread_count = min(queue->depth, MAX_IO_THREADS);
+
+	for (i = 0; i < thread_count; i++) {
+		queue->threads.push_back(thread(run_thread_pool_worker, queue));
+	}
+}
+
+void shutdown_io_queue(io_queue* queue) {
+	size_t i;
+
+	{
+		lock_guard<mutex> guard(queue->lock);
+		queue->stopping = true;
+	}
+
+	if (queue->backend == IO_BACKEND_THREADS) {
+		queue->work_ready.notify_all();
+	} else {
+		wake_io_thread(queue);
+	}
+
+	for (i = 0; i < queue->threads.size(); i++) {
+		queue->threads[i].join();
+	}
+
+	queue->threads.clear();
+
+	if (queue->backend != IO_BACKEND_THREADS) {
+		stop_backend(queue);
+	}
+}
+
+void submit_io_batch(io_queue* queue, io_batch* batch, io_request* requests, const uint32_t count) {
+	io_request* request;
+	uint32_t queued;
+	uint32_t i;
+
+	if (count == 0) {
+		return;
+	}
+
+	// All of them up front, so the batch can't look done while the first
+	// few finish before the rest are queued.
+	batch->pending += count;
+	queued = 0;
+
+	{
+		lock_guard<mutex> guard(queue->lock);
+
+		for (i = 0; i < count; i++) {
+			request = &requests[i];
+			request->batch = batch;
+			request->done = 0;
+
+			queue->stats.requests++;
+			queue->stats.bytes += request->size;
+
+			// Nothing to read, or past the end of the file, are done
+			// straight away.
+			if (request->size == 0 || request->offset + request->size > request->file->size) {
+				continue;
+			}
+
+			queue->pending.push_back(request);
+			queued++;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		request = &requests[i];
+
+		if (request->size == 0) {
+			finish_request(queue, request, true);
+		} else if (request->offset + request->size > request->file->size) {
+			{
+				lock_guard<mutex> guard(queue->lock);
+				queue->stats.failures++;
+			}
+
+			finish_request(queue, request, false);
+		}
+	}
+
+	if (queued == 0) {
+		return;
+	}
+
+	if (queue->backend == IO_BACKEND_THREADS) {
+		queue->work_ready.notify_all();
+	} else {
+		wake_io_thread(queue);
+	}
+}
+
+bool is_io_batch_done(const io_batch* batch) {
+	return batch->pending.load(memory_order_acquire) == 0;
+}
+
+bool wait_for_io_batch(io_queue* queue, io_batch* batch) {
+	unique_lock<mutex> guard(queue->lock);
+
+	while (batch->pending.load(memory_order_acquire) > 0) {
+		queue->batch_done.wait(guard);
+	}
+
+	return batch->failures.load() == 0;
+}
+
+const char* get_io_backend_name(const io_backend backend) {
+	switch (backend) {
+	case IO_BACKEND_IO_URING:
+		return "io_uring";
+	case IO_BACKEND_OVERLAPPED:
+		return "overlapped I/O";
+	default:
+		return "thread pool";
+	}
+}
+
+io_queue_stats get_io_queue_stats(io_queue* queue) {
+	lock_guard<mutex> guard(queue->lock);
+
+	return queue->stats;
+}
+
+string get_io_queue_report(io_queue* queue) {
+	io_queue_stats stats;
+	char line[256];
+	string report;
+
+	stats = get_io_queue_stats(queue);
+
+	snprintf(
+		line,
+		sizeof(line),
+		"I/O queue: %s, depth %u\n",
+		get_io_backend_name(queue->backend),
+		queue->depth
+	);
+	report += line;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"  %llu reads (%llu failed), %.2fMB\n",
+		(unsigned long long)stats.requests,
+		(unsigned long long)stats.failures,
+		stats.bytes / (1024.0 * 1024.0)
+	);
+	report += line;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"  %llu system calls (%.2f a read), at most %u in flight\n",
+		(unsigned long long)stats.system_calls,
+		stats.requests > 0 ? (double)stats.system_calls / stats.requests : 0.0,
+		stats.most_in_flight
+	);
+	report += line;
+
+	return report;
+}
+
+static void finish_request(io_queue* queue, io_request* request, const bool succeeded) {
+	io_batch* batch;
+
+	batch = request->batch;
+
+	if (!succeeded) {
+		batch->failures++;
+	}
+
+	//
+	// The last one wakes whoever's waiting. Once pending is 0 the batch
+	// might be gone, so it's not touched after that. Taking the lock
+	// before notifying means a waiter can't check pending, miss this,
+	// and then sleep.
+	//
+
+	if (batch->pending.fetch_sub(1, memory_order_acq_rel) == 1) {
+		{
+			lock_guard<mutex> guard(queue->lock);
+		}
+
+		queue->batch_done.notify_all();
+	}
+}
+
+static void run_thread_pool_worker(io_queue* queue) {
+	io_request* request;
+	uint64_t system_calls;
+	bool succeeded;
+
+	for (;;) {
+		{
+			unique_lock<mutex> guard(queue->lock);
+
+			while (queue->pending.empty() && !queue->stopping) {
+				queue->work_ready.wait(guard);
+			}
+
+			if (queue->pending.empty()) {
+				return;
+			}
+
+			request = queue->pending.front();
+			queue->pending.pop_front();
+
+			queue->in_flight++;
+			queue->stats.most_in_flight = max(queue->stats.most_in_flight, queue->in_flight);
+		}
+
+		system_calls = 0;
+		succeeded = read_request(request, &system_calls);
+
+		{
+			lock_guard<mutex> guard(queue->lock);
+
+			queue->in_flight--;
+			queue->stats.system_calls += system_calls;
+			queue->stats.failures += succeeded ? 0 : 1;
+		}
+
+		finish_request(queue, request, succeeded);
+	}
+}
+
+#if defined(_WIN32)
+
+// Completions for reads have this key. The ones that only wake the I/O
+// thread up have no OVERLAPPED.
+const ULONG_PTR IO_READ_KEY = 1;
+// How many completions the I/O thread takes at once.
+const ULONG IO_COMPLETION_BATCH = 64;
+
+struct io_slot {
+	OVERLAPPED overlapped;
+	io_request* request;
+};
+
+struct io_backend_state {
+	HANDLE completion_port;
+	io_slot slots[MAX_IO_QUEUE_DEPTH];
+	uint32_t free_slots[MAX_IO_QUEUE_DEPTH];
+	uint32_t free_count;
+};
+
+static bool start_read(io_backend_state* state, io_request* request, uint64_t* system_calls);
+
+bool open_io_file(io_queue* queue, io_file* file, const string& path) {
+	HANDLE file_handle;
+	LARGE_INTEGER file_size;
+	DWORD flags;
+
+	*file = io_file();
+
+	// The thread pool reads with plain ReadFile, which needs a handle
+	// that isn't overlapped.
+	flags = queue->backend == IO_BACKEND_OVERLAPPED ? FILE_FLAG_OVERLAPPED : FILE_ATTRIBUTE_NORMAL;
+
+	file_handle = CreateFileA(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		flags,
+		NULL
+	);
+
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	if (!GetFileSizeEx(file_handle, &file_size)) {
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	if (queue->backend == IO_BACKEND_OVERLAPPED &&
+		!CreateIoCompletionPort(file_handle, queue->state->completion_port, IO_READ_KEY, 0))
+	{
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	file->file_handle = file_handle;
+	file->size = (uint64_t)file_size.QuadPart;
+
+	return true;
+}
+
+void close_io_file(io_file* file) {
+	if (file->file_handle) {
+		CloseHandle(file->file_handle);
+	}
+
+	*file = io_file();
+}
+
+static bool start_backend(io_queue* queue) {
+	io_backend_state* state;
+	uint32_t i;
+
+	state = new io_backend_state;
+	state->completion_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+
+	if (!state->completion_port) {
+		delete state;
+		return false;
+	}
+
+	for (i = 0; i < queue->depth; i++) {
+		state->free_slots[i] = i;
+	}
+
+	state->free_count = queue->depth;
+
+	queue->backend = IO_BACKEND_OVERLAPPED;
+	queue->state = state;
+
+	return true;
+}
+
+static void stop_backend(io_queue* queue) {
+	CloseHandle(queue->state->completion_port);
+	delete queue->state;
+	queue->state = NULL;
+}
+
+static void run_io_thread(io_queue* queue) {
+	io_backend_state* state;
+	OVERLAPPED_ENTRY completions[IO_COMPLETION_BATCH];
+	vector<io_request*> starting;
+	vector<io_request*> carrying_on;
+	io_slot* slot;
+	io_request* request;
+	uint64_t system_calls;
+	uint32_t in_flight;
+	ULONG count;
+	ULONG i;
+	size_t j;
+
+	state = queue->state;
+	in_flight = 0;
+	system_calls = 0;
+
+	for (;;) {
+		//
+		// Take as many new reads as there's room for, after any that came
+		// up short and need carrying on with.
+		//
+
+		starting.swap(carrying_on);
+		carrying_on.clear();
+
+		{
+			lock_guard<mutex> guard(queue->lock);
+
+			if (queue->stopping && queue->pending.empty() && in_flight == 0 && starting.empty()) {
+				queue->stats.system_calls += system_calls;
+				break;
+			}
+
+			while (in_flight + starting.size() < queue->depth && !queue->pending.empty()) {
+				starting.push_back(queue->pending.front());
+				queue->pending.pop_front();
+			}
+
+			queue->in_flight = in_flight + (uint32_t)starting.size();
+			queue->stats.most_in_flight = max(queue->stats.most_in_flight, queue->in_flight);
+			queue->stats.system_calls += system_calls;
+			system_calls = 0;
+		}
+
+		for (j = 0; j < starting.size(); j++) {
+			if (start_read(state, starting[j], &system_calls)) {
+				in_flight++;
+			} else {
+				{
+					lock_guard<mutex> guard(queue->lock);
+					queue->stats.failures++;
+				}
+
+				finish_request(queue, starting[j], false);
+			}
+		}
+
+		starting.clear();
+
+		//
+		// Wait for anything to finish, and take everything that has.
+		//
+
+		if (!GetQueuedCompletionStatusEx(state->completion_port, completions, IO_COMPLETION_BATCH, &count, INFINITE, FALSE)) {
+			continue;
+		}
+
+		system_calls++;
+
+		for (i = 0; i < count; i++) {
+			// Just a wake up.
+			if (!completions[i].lpOverlapped) {
+				continue;
+			}
+
+			slot = CONTAINING_RECORD(completions[i].lpOverlapped, io_slot, overlapped);
+			request = slot->request;
+			state->free_slots[state->free_count] = (uint32_t)(slot - state->slots);
+			state->free_count++;
+			in_flight--;
+
+			// The status of a read is in Internal, as an NTSTATUS.
+			if (completions[i].lpOverlapped->Internal != 0 || completions[i].dwNumberOfBytesTransferred == 0) {
+				{
+					lock_guard<mutex> guard(queue->lock);
+					queue->stats.failures++;
+				}
+
+				finish_request(queue, request, false);
+				continue;
+			}
+
+			request->done += completions[i].dwNumberOfBytesTransferred;
+
+			if (request->done < request->size) {
+				carrying_on.push_back(request);
+			} else {
+				finish_request(queue, request, true);
+			}
+		}
+	}
+}
+
+static void wake_io_thread(io_queue* queue) {
+	PostQueuedCompletionStatus(queue->state->completion_port, 0, 0, NULL);
+}
+
+static bool start_read(io_backend_state* state, io_request* request, uint64_t* system_calls) {
+	io_slot* slot;
+	uint64_t offset;
+
+	state->free_count--;
+	slot = &(state->slots[state->free_slots[state->free_count]]);
+	slot->request = request;
+
+	offset = request->offset + request->done;
+
+	memset(&(slot->overlapped), 0, sizeof(slot->overlapped));
+	slot->overlapped.Offset = (DWORD)(offset & 0xffffffff);
+	slot->overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+	(*system_calls)++;
+
+	// Even a read that finishes straight away is reported through the
+	// completion port.
+	if (!ReadFile(
+		request->file->file_handle,
+		(uint8_t*)request->destination + request->done,
+		request->size - request->done,
+		NULL,
+		&(slot->overlapped)
+	) && GetLastError() != ERROR_IO_PENDING)
+	{
+		state->free_count++;
+		return false;
+	}
+
+	return true;
+}
+
+static bool read_request(io_request* request, uint64_t* system_calls) {
+	OVERLAPPED overlapped;
+	uint64_t offset;
+	DWORD bytes_read;
+
+	while (request->done < request->size) {
+		offset = request->offset + request->done;
+
+		// On a handle that isn't overlapped, this just says where to
+		// read from.
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.Offset = (DWORD)(offset & 0xffffffff);
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+		(*system_calls)++;
+
+		if (!ReadFile(
+			request->file->file_handle,
+			(uint8_t*)request->destination + request->done,
+			request->size - request->done,
+			&bytes_read,
+			&overlapped
+		) || bytes_read == 0)
+		{
+			return false;
+		}
+
+		request->done += bytes_read;
+	}
+
+	return true;
+}
+
+#else
+
+// The user data of the read that wakes the I/O thread up. Every other
+// read's is its request, which is never NULL.
+const uint64_t IO_WAKE_TAG = 0;
+
+struct io_backend_state {
+	int ring_fd;
+	// Written to by submit_io_batch, and always being read from by the
+	// ring, so writing to it wakes the I/O thread.
+	int wake_fd;
+	uint64_t wake_value;
+
+	uint8_t* sq_ring;
+	size_t sq_ring_size;
+	uint8_t* cq_ring;
+	size_t cq_ring_size;
+	io_uring_sqe* sqes;
+	size_t sqes_size;
+
+	uint32_t* sq_tail;
+	uint32_t sq_mask;
+	uint32_t* sq_array;
+	uint32_t* cq_head;
+	uint32_t* cq_tail;
+	uint32_t cq_mask;
+	io_uring_cqe* cqes;
+};
+
+static void queue_read(
+	io_backend_state* state,
+	const int file_descriptor,
+	void* destination,
+	const uint32_t size,
+	const uint64_t offset,
+	const uint64_t user_data
+);
+
+bool open_io_file(io_queue* queue, io_file* file, const string& path) {
+	int file_descriptor;
+	struct stat file_stats;
+
+	// The same for every backend on Linux.
+	(void)queue;
+
+	*file = io_file();
+
+	file_descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file_descriptor < 0) {
+		return false;
+	}
+
+	if (fstat(file_descriptor, &file_stats) != 0) {
+		close(file_descriptor);
+		return false;
+	}
+
+	file->file_descriptor = file_descriptor;
+	file->size = (uint64_t)file_stats.st_size;
+
+	return true;
+}
+
+void close_io_file(io_file* file) {
+	if (file->file_descriptor >= 0) {
+		close(file->file_descriptor);
+	}
+
+	*file = io_file();
+}
+
+static bool start_backend(io_queue* queue) {
+	io_backend_state* state;
+	io_uring_params params;
+	void* mapping;
+
+	state = new io_backend_state;
+	memset(state, 0, sizeof(*state));
+	memset(&params, 0, sizeof(params));
+
+	//
+	// A submission queue entry for each read, and one for the wake up.
+	// The completion queue is twice that, so it can't overflow.
+	//
+
+	state->ring_fd = (int)syscall(__NR_io_uring_setup, queue->depth + 1, &params);
+	if (state->ring_fd < 0) {
+		delete state;
+		return false;
+	}
+
+	state->wake_fd = eventfd(0, EFD_CLOEXEC);
+	if (state->wake_fd < 0) {
+		close(state->ring_fd);
+		delete state;
+		return false;
+	}
+
+	//
+	// Map the two rings and the submission entries. Newer kernels put
+	// both rings in one mapping.
+	//
+
+	state->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	state->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		state->sq_ring_size = max(state->sq_ring_size, state->cq_ring_size);
+		state->cq_ring_size = state->sq_ring_size;
+	}
+
+	mapping = mmap(NULL, state->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, state->ring_fd, IORING_OFF_SQ_RING);
+	state->sq_ring = mapping == MAP_FAILED ? NULL : (uint8_t*)mapping;
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		state->cq_ring = state->sq_ring;
+	} else {
+		mapping = mmap(NULL, state->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, state->ring_fd, IORING_OFF_CQ_RING);
+		state->cq_ring = mapping == MAP_FAILED ? NULL : (uint8_t*)mapping;
+	}
+
+	state->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	mapping = mmap(NULL, state->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, state->ring_fd, IORING_OFF_SQES);
+	state->sqes = mapping == MAP_FAILED ? NULL : (io_uring_sqe*)mapping;
+
+	queue->state = state;
+
+	if (!state->sq_ring || !state->cq_ring || !state->sqes) {
+		stop_backend(queue);
+		return false;
+	}
+
+	state->sq_tail = (uint32_t*)(state->sq_ring + params.sq_off.tail);
+	state->sq_mask = *(uint32_t*)(state->sq_ring + params.sq_off.ring_mask);
+	state->sq_array = (uint32_t*)(state->sq_ring + params.sq_off.array);
+	state->cq_head = (uint32_t*)(state->cq_ring + params.cq_off.head);
+	state->cq_tail = (uint32_t*)(state->cq_ring + params.cq_off.tail);
+	state->cq_mask = *(uint32_t*)(state->cq_ring + params.cq_off.ring_mask);
+	state->cqes = (io_uring_cqe*)(state->cq_ring + params.cq_off.cqes);
+
+	queue->backend = IO_BACKEND_IO_URING;
+
+	return true;
+}
+
+static void stop_backend(io_queue* queue) {
+	io_backend_state* state;
+
+	state = queue->state;
+
+	if (state->sqes) {
+		munmap(state->sqes, state->sqes_size);
+	}
+
+	if (state->cq_ring && state->cq_ring != state->sq_ring) {
+		munmap(state->cq_ring, state->cq_ring_size);
+	}
+
+	if (state->sq_ring) {
+		munmap(state->sq_ring, state->sq_ring_size);
+	}
+
+	close(state->wake_fd);
+	close(state->ring_fd);
+
+	delete state;
+	queue->state = NULL;
+}
+
+static void run_io_thread(io_queue* queue) {
+	io_backend_state* state;
+	vector<io_request*> carrying_on;
+	io_request* request;
+	const io_uring_cqe* completion;
+	uint64_t system_calls;
+	uint32_t in_flight;
+	uint32_t unsubmitted;
+	uint32_t head;
+	uint32_t tail;
+	bool wake_armed;
+	long submitted;
+	size_t i;
+
+	state = queue->state;
+	in_flight = 0;
+	unsubmitted = 0;
+	system_calls = 0;
+	wake_armed = false;
+
+	for (;;) {
+		//
+		// Queue up the wake up read if it isn't already, any reads that
+		// came up short, and then as many new ones as there's room for.
+		//
+
+		if (!wake_armed) {
+			queue_read(state, state->wake_fd, &(state->wake_value), sizeof(state->wake_value), 0, IO_WAKE_TAG);
+			wake_armed = true;
+			unsubmitted++;
+		}
+
+		for (i = 0; i < carrying_on.size(); i++) {
+			request = carrying_on[i];
+			queue_read(
+				state,
+				request->file->file_descriptor,
+				(uint8_t*)request->destination + request->done,
+				request->size - request->done,
+				request->offset + request->done,
+				(uint64_t)(uintptr_t)request
+			);
+			in_flight++;
+			unsubmitted++;
+		}
+
+		carrying_on.clear();
+
+		{
+			lock_guard<mutex> guard(queue->lock);
+
+			if (queue->stopping && queue->pending.empty() && in_flight == 0) {
+				queue->stats.system_calls += system_calls;
+				break;
+			}
+
+			while (in_flight < queue->depth && !queue->pending.empty()) {
+				request = queue->pending.front();
+				queue->pending.pop_front();
+
+				queue_read(
+					state,
+					request->file->file_descriptor,
+					request->destination,
+					request->size,
+					request->offset,
+					(uint64_t)(uintptr_t)request
+				);
+				in_flight++;
+				unsubmitted++;
+			}
+
+			queue->in_flight = in_flight;
+			queue->stats.most_in_flight = max(queue->stats.most_in_flight, in_flight);
+			queue->stats.system_calls += system_calls;
+			system_calls = 0;
+		}
+
+		//
+		// Submit them all and wait for at least one thing to finish, in
+		// the one call. If it's interrupted, whatever it didn't take
+		// goes next time.
+		//
+
+		submitted = syscall(__NR_io_uring_enter, state->ring_fd, unsubmitted, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		system_calls++;
+
+		if (submitted > 0) {
+			unsubmitted -= (uint32_t)submitted;
+		}
+
+		//
+		// Take everything that's finished.
+		//
+
+		head = *(state->cq_head);
+		tail = __atomic_load_n(state->cq_tail, __ATOMIC_ACQUIRE);
+
+		while (head != tail) {
+			completion = &(state->cqes[head & state->cq_mask]);
+			head++;
+
+			if (completion->user_data == IO_WAKE_TAG) {
+				wake_armed = false;
+				continue;
+			}
+
+			request = (io_request*)(uintptr_t)completion->user_data;
+			in_flight--;
+
+			if (completion->res == -EINTR || completion->res == -EAGAIN) {
+				carrying_on.push_back(request);
+				continue;
+			}
+
+			// An error, or the file ending early.
+			if (completion->res <= 0) {
+				{
+					lock_guard<mutex> guard(queue->lock);
+					queue->stats.failures++;
+				}
+
+				finish_request(queue, request, false);
+				continue;
+			}
+
+			request->done += (uint32_t)completion->res;
+
+			if (request->done < request->size) {
+				carrying_on.push_back(request);
+			} else {
+				finish_request(queue, request, true);
+			}
+		}
+
+		__atomic_store_n(state->cq_head, head, __ATOMIC_RELEASE);
+	}
+}
+
+static void wake_io_thread(io_queue* queue) {
+	uint64_t one;
+
+	one = 1;
+
+	// If it fails, the counter's full, which wakes it up anyway.
+	if (write(queue->state->wake_fd, &one, sizeof(one)) < 0) {
+		return;
+	}
+}
+
+static void queue_read(
+	io_backend_state* state,
+	const int file_descriptor,
+	void* destination,
+	const uint32_t size,
+	const uint64_t offset,
+	const uint64_t user_data
+) {
+	io_uring_sqe* entry;
+	uint32_t tail;
+	uint32_t index;
+
+	// Only the I/O thread writes the tail, so it can read it plainly.
+	tail = *(state->sq_tail);
+	index = tail & state->sq_mask;
+	entry = &(state->sqes[index]);
+
+	memset(entry, 0, sizeof(*entry));
+	entry->opcode = IORING_OP_READ;
+	entry->fd = file_descriptor;
+	entry->addr = (uint64_t)(uintptr_t)destination;
+	entry->len = size;
+	entry->off = offset;
+	entry->user_data = user_data;
+
+	state->sq_array[index] = index;
+
+	__atomic_store_n(state->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static bool read_request(io_request* request, uint64_t* system_calls) {
+	ssize_t bytes_read;
+
+	while (request->done < request->size) {
+		(*system_calls)++;
+
+		bytes_read = pread(
+			request->file->file_descriptor,
+			(uint8_t*)request->destination + request->done,
+			request->size - request->done,
+			(off_t)(request->offset + request->done)
+		);
+
+		if (bytes_read < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (bytes_read <= 0) {
+			return false;
+		}
+
+		request->done += (uint32_t)bytes_read;
+	}
+
+	return true;
+}
+
+#endif
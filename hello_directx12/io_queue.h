@@ -0,0 +1,147 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Reads files asynchronously, many at a time, straight into whatever
+// memory they're wanted in (a mapped upload heap, say), in the style of
+// DirectStorage. Nothing is read into a buffer of our own first and
+// then copied.
+//
+// Reads are submitted in batches. A batch is done once every read in
+// it is, and whoever's waiting for it (or checking on it each frame)
+// can then copy all of them to the GPU in one go. Any thread can submit
+// batches and wait for them.
+//
+// There are three ways it does the reading:
+//
+// * io_uring on Linux. It's set up with the system calls themselves
+//   rather than liburing. One I/O thread keeps up to depth reads in the
+//   kernel's queue, and submits new ones and collects finished ones
+//   with a single system call each time round.
+// * Overlapped ReadFile on Windows, with an I/O completion port. The
+//   I/O thread keeps up to depth reads going in the same way.
+// * A pool of threads calling pread, on Linux when io_uring isn't
+//   there (old kernels, or sandboxes that block it), or when asked for.
+//   Each thread is one read in flight.
+//
+// A read that comes up short (a file that's shorter than it said, or
+// the kernel stopping early) is carried on from where it got to. One
+// that fails, or runs off the end of the file, counts as a failure for
+// its batch.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The most reads a queue keeps in flight.
+const uint32_t MAX_IO_QUEUE_DEPTH = 256;
+// The most threads the thread pool uses, whatever the depth.
+const uint32_t MAX_IO_THREADS = 32;
+
+enum io_backend {
+	IO_BACKEND_IO_URING,
+	IO_BACKEND_OVERLAPPED,
+	IO_BACKEND_THREADS
+};
+
+struct io_file {
+	io_file();
+
+	uint64_t size;
+
+#if defined(_WIN32)
+	void* file_handle;
+#else
+	int file_descriptor;
+#endif
+};
+
+struct io_batch {
+	io_batch();
+
+	// Reads that haven't finished yet, and ones that failed.
+	std::atomic<uint32_t> pending;
+	std::atomic<uint32_t> failures;
+};
+
+struct io_request {
+	const io_file* file;
+	uint64_t offset;
+	uint32_t size;
+	// Where the bytes go. Has to stay put until the batch is done.
+	void* destination;
+
+	// Filled in by submit_io_batch.
+	io_batch* batch;
+	// How much has been read so far.
+	uint32_t done;
+};
+
+struct io_queue_stats {
+	uint64_t requests;
+	uint64_t bytes;
+	uint64_t failures;
+	// Calls into the kernel to submit or wait for reads. The thread pool
+	// makes one per read, at least.
+	uint64_t system_calls;
+	uint32_t most_in_flight;
+};
+
+// Whatever the backend needs, in io_queue.cpp.
+struct io_backend_state;
+
+struct io_queue {
+	io_queue();
+
+	io_backend backend;
+	uint32_t depth;
+
+	std::mutex lock;
+	// The I/O thread, or the pool, waits on this for requests.
+	std::condition_variable work_ready;
+	// Waiters on batches wait on this.
+	std::condition_variable batch_done;
+	// Submitted, but not handed to the kernel (or a thread) yet.
+	std::deque<io_request*> pending;
+	uint32_t in_flight;
+	bool stopping;
+
+	std::vector<std::thread> threads;
+	io_backend_state* state;
+
+	io_queue_stats stats;
+};
+
+// Starts a queue that keeps up to depth reads in flight (at most
+// MAX_IO_QUEUE_DEPTH). It uses io_uring or overlapped I/O unless
+// use_threads is set, or io_uring isn't available, in which case it uses
+// the thread pool.
+void initialize_io_queue(io_queue* queue, const uint32_t depth, const bool use_threads);
+// Finishes every read that's been submitted, then stops.
+void shutdown_io_queue(io_queue* queue);
+
+// Opens path for reading through queue. Returns false if it can't be
+// opened.
+bool open_io_file(io_queue* queue, io_file* file, const std::string& path);
+void close_io_file(io_file* file);
+
+// Starts count reads as part of batch. The requests are the caller's,
+// and have to stay put until the batch is done. A batch can be
+// submitted to more than once before it's waited on.
+void submit_io_batch(io_queue* queue, io_batch* batch, io_request* requests, const uint32_t count);
+// Whether every read submitted to batch has finished, without waiting.
+bool is_io_batch_done(const io_batch* batch);
+// Waits for every read submitted to batch. Returns true if they all
+// succeeded.
+bool wait_for_io_batch(io_queue* queue, io_batch* batch);
+
+const char* get_io_backend_name(const io_backend backend);
+io_queue_stats get_io_queue_stats(io_queue* queue);
+std::string get_io_queue_report(io_queue* queue);
@@ -0,0 +1,778 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "job_system.h"
+#include "profiler.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // ! WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+// The worker the current thread is, if any.
+static thread_local job_worker* current_worker = NULL;
+// Where threads that aren't workers start looking for jobs to steal.
+static thread_local uint32_t helper_steal_from = 0;
+
+static void run_worker(job_worker* worker, const bool pin_thread);
+static void pin_current_thread(const uint32_t core);
+
+static bool push_to_deque(job_deque* deque, job* j);
+static job* pop_from_deque(job_deque* deque);
+static job* steal_from_deque(job_deque* deque);
+static bool is_deque_empty(const job_deque* deque);
+
+static job_worker* get_current_worker(job_system* system);
+static job* allocate_job(job_system* system);
+static void release_job(job_system* system, job* j);
+static void push_job(job_system* system, job* j);
+static bool run_one_job(job_system* system);
+static void execute_job(job_system* system, job* j);
+static void execute_range(job_system* system, job* j);
+static void start_job(job_system* system, const job_decl& decl, job_counter* counter);
+static void finish_counter(job_system* system, job_counter* counter);
+static bool has_work(job_system* system);
+static void wake_sleepers(job_system* system, const bool all);
+
+// Sleeps until there's work or done() is true.
+template <typename done_fn>
+static void sleep_until_work(job_system* system, done_fn done);
+
+job_counter::job_counter() {
+	remaining = 0;
+}
+
+job_deque::job_deque() {
+	uint32_t i;
+
+	top = 0;
+	bottom = 0;
+
+	for (i = 0; i < JOB_DEQUE_SIZE; i++) {
+		jobs[i] = NULL;
+	}
+}
+
+job_worker::job_worker() {
+	uint32_t i;
+
+	system = NULL;
+	index = 0;
+	next_job = 0;
+	steal_from = 0;
+	jobs_run = 0;
+	steals = 0;
+	sleeps = 0;
+
+	for (i = 0; i < JOB_POOL_SIZE; i++) {
+		pool[i].in_use = false;
+		pool[i].shared = false;
+	}
+}
+
+job_system::job_system() {
+	running = false;
+	shared_count = 0;
+	sleeping = 0;
+}
+
+void initialize_job_system(
+	job_system* system,
+	uint32_t worker_count,
+	const bool pin_threads
+) {
+	uint32_t i;
+
+	if (worker_count == 0) {
+		worker_count = thread::hardware_concurrency();
+	}
+
+	if (worker_count == 0) {
+		worker_count = 1;
+	}
+
+	system->running.store(true);
+
+	for (i = 0; i < worker_count; i++) {
+		system->workers.push_back(unique_ptr<job_worker>(new job_worker));
+		system->workers[i]->system = system;
+		system->workers[i]->index = i;
+		system->workers[i]->steal_from = i + 1;
+	}
+
+	//
+	// The calling thread is worker 0. It doesn't get a thread of its
+	// own, but it runs jobs whenever it waits on them.
+	//
+
+	current_worker = system->workers[0].get();
+
+	if (pin_threads) {
+		pin_current_thread(0);
+	}
+
+	for (i = 1; i < worker_count; i++) {
+		system->workers[i]->thread = thread(run_worker, system->workers[i].get(), pin_threads);
+	}
+}
+
+void shutdown_job_system(job_system* system) {
+	size_t i;
+
+	system->running.store(false, memory_order_seq_cst);
+	wake_sleepers(system, true);
+
+	for (i = 1; i < system->workers.size(); i++) {
+		system->workers[i]->thread.join();
+	}
+
+	if (current_worker && current_worker->system == system) {
+		current_worker = NULL;
+	}
+
+	system->workers.clear();
+	system->shared_jobs.clear();
+	system->shared_free.clear();
+	system->shared_pool.clear();
+}
+
+void run_jobs(
+	job_system* system,
+	const job_decl* jobs,
+	const uint32_t count,
+	job_counter* counter
+) {
+	uint32_t i;
+
+	if (counter) {
+		counter->remaining.fetch_add((int32_t)count, memory_order_relaxed);
+	}
+
+	for (i = 0; i < count; i++) {
+		start_job(system, jobs[i], counter);
+	}
+}
+
+void run_jobs_after(
+	job_system* system,
+	job_counter* dependency,
+	const job_decl* jobs,
+	const uint32_t count,
+	job_counter* counter
+) {
+	job_continuation continuation;
+	uint32_t i;
+
+	if (counter) {
+		counter->remaining.fetch_add((int32_t)count, memory_order_relaxed);
+	}
+
+	//
+	// The count only reaches zero while the lock is held (see
+	// finish_counter), so if it isn't zero now, it's safe to add to
+	// the list: whoever finishes the last job will see it.
+	//
+
+	{
+		lock_guard<mutex> lock(dependency->continuations_lock);
+
+		if (dependency->remaining.load(memory_order_acquire) > 0) {
+			for (i = 0; i < count; i++) {
+				continuation.decl = jobs[i];
+				continuation.counter = counter;
+				dependency->continuations.push_back(continuation);
+			}
+
+			return;
+		}
+	}
+
+	// Already done, so they can start now.
+	for (i = 0; i < count; i++) {
+		start_job(system, jobs[i], counter);
+	}
+}
+
+void wait_for_counter(job_system* system, job_counter* counter) {
+	uint32_t spins;
+
+	spins = 0;
+
+	while (counter->remaining.load(memory_order_acquire) > 0) {
+		if (run_one_job(system)) {
+			spins = 0;
+			continue;
+		}
+
+		if (spins < JOB_SPIN_COUNT) {
+			spins++;
+			this_thread::yield();
+			continue;
+		}
+
+		sleep_until_work(system, [counter]() {
+			return counter->remaining.load(memory_order_seq_cst) == 0;
+		});
+
+		spins = 0;
+	}
+
+	//
+	// Whoever finished the last job might still be holding the lock.
+	// Once we've had it, they're done with the counter, and the caller
+	// is free to throw it away.
+	//
+
+	lock_guard<mutex> lock(counter->continuations_lock);
+}
+
+void parallel_for(
+	job_system* system,
+	const uint32_t count,
+	uint32_t grain,
+	parallel_for_fn function,
+	void* data
+) {
+	job_counter counter;
+	job* j;
+
+	if (count == 0) {
+		return;
+	}
+
+	//
+	// By default, aim for a few dozen pieces per worker at most. The
+	// range is only split that far if workers are actually idle.
+	//
+
+	if (grain == 0) {
+		grain = count / (get_job_worker_count(system) * 32);
+	}
+
+	if (grain == 0) {
+		grain = 1;
+	}
+
+	j = allocate_job(system);
+	j->function = NULL;
+	j->data = data;
+	j->counter = &counter;
+	j->range_function = function;
+	j->begin = 0;
+	j->end = count;
+	j->grain = grain;
+
+	counter.remaining.store(1, memory_order_relaxed);
+	push_job(system, j);
+
+	wait_for_counter(system, &counter);
+}
+
+uint32_t get_job_worker_count(const job_system* system) {
+	return (uint32_t)system->workers.size();
+}
+
+uint32_t get_current_job_worker(job_system* system) {
+	job_worker* worker;
+
+	worker = get_current_worker(system);
+
+	return worker ? worker->index : JOB_NOT_A_WORKER;
+}
+
+job_system_stats get_job_system_stats(const job_system* system) {
+	job_system_stats stats;
+	size_t i;
+
+	stats = {};
+	stats.worker_count = (uint32_t)system->workers.size();
+
+	for (i = 0; i < system->workers.size(); i++) {
+		stats.jobs_run += system->workers[i]->jobs_run.load(memory_order_relaxed);
+		stats.steals += system->workers[i]->steals.load(memory_order_relaxed);
+		stats.sleeps += system->workers[i]->sleeps.load(memory_order_relaxed);
+	}
+
+	return stats;
+}
+
+string get_job_system_report(const job_system* system) {
+	job_system_stats stats;
+	char report[256];
+
+	stats = get_job_system_stats(system);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Job system: %u workers, %llu jobs run, %llu stolen, %llu sleeps\n",
+		stats.worker_count,
+		(unsigned long long)stats.jobs_run,
+		(unsigned long long)stats.steals,
+		(unsigned long long)stats.sleeps
+	);
+
+	return report;
+}
+
+static void run_worker(job_worker* worker, const bool pin_thread) {
+	job_system* system;
+	char name[64];
+	uint32_t spins;
+
+	system = worker->system;
+	current_worker = worker;
+
+	snprintf(name, sizeof(name), "Job worker %u", worker->index);
+	set_profile_thread_name(name);
+
+	if (pin_thread) {
+		pin_current_thread(worker->index);
+	}
+
+	spins = 0;
+
+	while (system->running.load(memory_order_acquire)) {
+		if (run_one_job(system)) {
+			spins = 0;
+			continue;
+		}
+
+		if (spins < JOB_SPIN_COUNT) {
+			spins++;
+			this_thread::yield();
+			continue;
+		}
+
+		worker->sleeps.fetch_add(1, memory_order_relaxed);
+
+		sleep_until_work(system, [system]() {
+			return !system->running.load(memory_order_seq_cst);
+		});
+
+		spins = 0;
+	}
+
+	current_worker = NULL;
+}
+
+static void pin_current_thread(const uint32_t core) {
+#if defined(_WIN32)
+	SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+	cpu_set_t cores;
+
+	CPU_ZERO(&cores);
+	CPU_SET(core % CPU_SETSIZE, &cores);
+	pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+#endif
+}
+
+static bool push_to_deque(job_deque* deque, job* j) {
+	int64_t bottom;
+	int64_t top;
+
+	bottom = deque->bottom.load(memory_order_relaxed);
+	top = deque->top.load(memory_order_acquire);
+
+	if (bottom - top >= (int64_t)JOB_DEQUE_SIZE) {
+		return false;
+	}
+
+	deque->jobs[bottom & (JOB_DEQUE_SIZE - 1)].store(j, memory_order_relaxed);
+
+	// Publishes the job to thieves, and (being seq_cst) makes sure a
+	// thread going to sleep either sees it or is seen by wake_sleepers.
+	deque->bottom.store(bottom + 1, memory_order_seq_cst);
+
+	return true;
+}
+
+static job* pop_from_deque(job_deque* deque) {
+	int64_t bottom;
+	int64_t top;
+	job* j;
+
+	//
+	// Claim the bottom job, then check no thief got to it first. If
+	// it's the last one, we race the thieves for it on top.
+	//
+
+	bottom = deque->bottom.load(memory_order_relaxed) - 1;
+	deque->bottom.store(bottom, memory_order_seq_cst);
+	top = deque->top.load(memory_order_seq_cst);
+
+	if (top > bottom) {
+		deque->bottom.store(bottom + 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	j = deque->jobs[bottom & (JOB_DEQUE_SIZE - 1)].load(memory_order_relaxed);
+
+	if (top == bottom) {
+		if (!deque->top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+			j = NULL;
+		}
+
+		deque->bottom.store(bottom + 1, memory_order_relaxed);
+	}
+
+	return j;
+}
+
+static job* steal_from_deque(job_deque* deque) {
+	int64_t top;
+	int64_t bottom;
+	job* j;
+
+	top = deque->top.load(memory_order_seq_cst);
+	bottom = deque->bottom.load(memory_order_seq_cst);
+
+	if (top >= bottom) {
+		return NULL;
+	}
+
+	j = deque->jobs[top & (JOB_DEQUE_SIZE - 1)].load(memory_order_acquire);
+
+	// Someone else (the owner or another thief) may have taken it.
+	if (!deque->top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+		return NULL;
+	}
+
+	return j;
+}
+
+static bool is_deque_empty(const job_deque* deque) {
+	return deque->bottom.load(memory_order_seq_cst) <= deque->top.load(memory_order_seq_cst);
+}
+
+static job_worker* get_current_worker(job_system* system) {
+	if (current_worker && current_worker->system == system) {
+		return current_worker;
+	}
+
+	return NULL;
+}
+
+static job* allocate_job(job_system* system) {
+	job_worker* worker;
+	job* j;
+	uint32_t i;
+
+	worker = get_current_worker(system);
+
+	//
+	// Workers hand out their own jobs in order. The pool is big enough
+	// that the next slot is almost always free. It might not be if a job
+	// from a while back is still waiting on others (fib, say), so look
+	// further on, and if the whole pool is busy, use the shared one.
+	//
+
+	if (worker) {
+		for (i = 0; i < JOB_POOL_SIZE; i++) {
+			j = &(worker->pool[worker->next_job & (JOB_POOL_SIZE - 1)]);
+			worker->next_job++;
+
+			if (!j->in_use.load(memory_order_acquire)) {
+				j->in_use.store(true, memory_order_relaxed);
+				j->shared = false;
+
+				return j;
+			}
+		}
+	}
+
+	lock_guard<mutex> lock(system->shared_lock);
+
+	if (system->shared_free.empty()) {
+		system->shared_pool.push_back(unique_ptr<job>(new job));
+		system->shared_free.push_back(system->shared_pool.back().get());
+	}
+
+	j = system->shared_free.back();
+	system->shared_free.pop_back();
+
+	j->in_use.store(true, memory_order_relaxed);
+	j->shared = true;
+
+	return j;
+}
+
+static void release_job(job_system* system, job* j) {
+	if (j->shared) {
+		lock_guard<mutex> lock(system->shared_lock);
+		j->in_use.store(false, memory_order_relaxed);
+		system->shared_free.push_back(j);
+		return;
+	}
+
+	j->in_use.store(false, memory_order_release);
+}
+
+static void push_job(job_system* system, job* j) {
+	job_worker* worker;
+
+	worker = get_current_worker(system);
+
+	if (worker) {
+		// If our deque is full, there's plenty for everyone to do
+		// already, so just do this one now.
+		if (!push_to_deque(&(worker->deque), j)) {
+			execute_job(system, j);
+			return;
+		}
+	} else {
+		lock_guard<mutex> lock(system->shared_lock);
+		system->shared_jobs.push_back(j);
+		system->shared_count.fetch_add(1, memory_order_seq_cst);
+	}
+
+	wake_sleepers(system, false);
+}
+
+static bool run_one_job(job_system* system) {
+	job_worker* worker;
+	job_worker* victim;
+	uint32_t* steal_from;
+	uint32_t worker_count;
+	uint32_t i;
+	job* j;
+
+	worker = get_current_worker(system);
+	j = NULL;
+
+	//
+	// Our own jobs first, newest first, since they're the most likely
+	// to still be in the cache.
+	//
+
+	if (worker) {
+		j = pop_from_deque(&(worker->deque));
+	}
+
+	//
+	// Then anything from threads that aren't workers.
+	//
+
+	if (!j && system->shared_count.load(memory_order_relaxed) > 0) {
+		lock_guard<mutex> lock(system->shared_lock);
+
+		if (!system->shared_jobs.empty()) {
+			j = system->shared_jobs.front();
+			system->shared_jobs.pop_front();
+			system->shared_count.fetch_sub(1, memory_order_relaxed);
+		}
+	}
+
+	//
+	// Then steal the oldest job from someone else. Start from a
+	// different worker each time, so we don't all pick on the same one.
+	//
+
+	if (!j) {
+		worker_count = (uint32_t)system->workers.size();
+		steal_from = worker ? &(worker->steal_from) : &helper_steal_from;
+
+		for (i = 0; i < worker_count && !j; i++) {
+			victim = system->workers[(*steal_from + i) % worker_count].get();
+
+			if (victim != worker) {
+				j = steal_from_deque(&(victim->deque));
+			}
+		}
+
+		*steal_from += 1;
+
+		if (j && worker) {
+			worker->steals.fetch_add(1, memory_order_relaxed);
+		}
+	}
+
+	if (!j) {
+		return false;
+	}
+
+	execute_job(system, j);
+
+	return true;
+}
+
+static void execute_job(job_system* system, job* j) {
+	job_worker* worker;
+	job_counter* counter;
+
+	if (j->range_function) {
+		execute_range(system, j);
+	} else {
+		j->function(j->data);
+	}
+
+	counter = j->counter;
+	release_job(system, j);
+
+	if (counter) {
+		finish_counter(system, counter);
+	}
+
+	worker = get_current_worker(system);
+	if (worker) {
+		worker->jobs_run.fetch_add(1, memory_order_relaxed);
+	}
+}
+
+static void execute_range(job_system* system, job* j) {
+	job_worker* worker;
+	job* split;
+	uint32_t begin;
+	uint32_t end;
+	uint32_t middle;
+
+	worker = get_current_worker(system);
+	begin = j->begin;
+	end = j->end;
+
+	//
+	// Work through the range a grain at a time. Whenever our deque is
+	// empty, the other workers have run out of things to steal, so
+	// split off the back half of what's left for them.
+	//
+
+	while (end - begin > j->grain) {
+		if (!worker || is_deque_empty(&(worker->deque))) {
+			middle = begin + (end - begin) / 2;
+
+			split = allocate_job(system);
+			split->function = NULL;
+			split->data = j->data;
+			split->counter = j->counter;
+			split->range_function = j->range_function;
+			split->begin = middle;
+			split->end = end;
+			split->grain = j->grain;
+
+			j->counter->remaining.fetch_add(1, memory_order_relaxed);
+			push_job(system, split);
+
+			end = middle;
+			continue;
+		}
+
+		j->range_function(begin, begin + j->grain, j->data);
+		begin += j->grain;
+	}
+
+	j->range_function(begin, end, j->data);
+}
+
+static void start_job(job_system* system, const job_decl& decl, job_counter* counter) {
+	job* j;
+
+	j = allocate_job(system);
+	j->function = decl.function;
+	j->data = decl.data;
+	j->counter = counter;
+	j->range_function = NULL;
+
+	push_job(system, j);
+}
+
+static void finish_counter(job_system* system, job_counter* counter) {
+	vector<job_continuation> continuations;
+	int32_t remaining;
+	size_t i;
+
+	//
+	// If this isn't the last job, just count it off.
+	//
+
+	remaining = counter->remaining.load(memory_order_relaxed);
+
+	while (remaining > 1) {
+		if (counter->remaining.compare_exchange_weak(remaining, remaining - 1, memory_order_acq_rel)) {
+			return;
+		}
+	}
+
+	//
+	// It's the last one. The count only ever reaches zero with the lock
+	// held, so run_jobs_after and wait_for_counter can both rely on it.
+	// Take the jobs waiting on this counter out before letting go: the
+	// counter might be gone the moment we do.
+	//
+
+	{
+		lock_guard<mutex> lock(counter->continuations_lock);
+
+		// A job can add more jobs to its own counter, so it may not
+		// be the last one after all.
+		if (counter->remaining.fetch_sub(1, memory_order_seq_cst) != 1) {
+			return;
+		}
+
+		continuations.swap(counter->continuations);
+	}
+
+	for (i = 0; i < continuations.size(); i++) {
+		start_job(system, continuations[i].decl, continuations[i].counter);
+	}
+
+	// Anyone sleeping might be waiting on this counter.
+	wake_sleepers(system, true);
+}
+
+static bool has_work(job_system* system) {
+	size_t i;
+
+	if (system->shared_count.load(memory_order_seq_cst) > 0) {
+		return true;
+	}
+
+	for (i = 0; i < system->workers.size(); i++) {
+		if (!is_deque_empty(&(system->workers[i]->deque))) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void wake_sleepers(job_system* system, const bool all) {
+	//
+	// Taking the lock before notifying means a sleeper is either
+	// already waiting (and gets the notification), or hasn't checked
+	// for work yet (and will find what we just did).
+	//
+
+	if (system->sleeping.load(memory_order_seq_cst) == 0) {
+		return;
+	}
+
+	lock_guard<mutex> lock(system->sleep_lock);
+
+	if (all) {
+		system->wake.notify_all();
+	} else {
+		system->wake.notify_one();
+	}
+}
+
+template <typename done_fn>
+static void sleep_until_work(job_system* system, done_fn done) {
+	unique_lock<mutex> lock(system->sleep_lock);
+
+	system->sleeping.fetch_add(1, memory_order_seq_cst);
+
+	while (!has_work(system) && !done()) {
+		system->wake.wait(lock);
+	}
+
+	system->sleeping.fetch_sub(1, memory_order_relaxed);
+}
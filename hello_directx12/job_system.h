@@ -0,0 +1,204 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A work-stealing job system. There is a worker thread per core (less
+// one for the main thread), and each has a deque of jobs. A worker
+// pushes and pops jobs at the bottom of its own deque, and when it runs
+// out, steals from the top of someone else's. These are Chase-Lev
+// deques, so neither the owner nor the thieves ever take a lock.
+//
+// A job is a function and a pointer. Jobs are run against a counter,
+// which goes down as they finish, so you can wait for a batch of jobs
+// or have more jobs start once a batch is done (a dependency). Any
+// thread waiting on a counter helps run jobs in the meantime, so the
+// main thread is never just sitting there.
+//
+// Threads that aren't workers (the render thread, say) can run and
+// wait on jobs too. What they run goes into a shared queue, which is
+// locked, but the workers only look there when their deques are empty.
+//
+// parallel_for splits a range up as it goes. A worker only splits off
+// more of its range when its own deque is empty, which means someone
+// has stolen everything it had and is probably looking for more. So
+// busy machines get big chunks and idle ones get small ones, without
+// having to pick a chunk size up front.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per worker. Must be powers of two. A deque that fills up just runs
+// the job straight away instead, and a pool that fills up borrows from
+// the shared one.
+const uint32_t JOB_DEQUE_SIZE = 4096;
+const uint32_t JOB_POOL_SIZE = 4096;
+// How many times an idle thread looks for work (yielding in between)
+// before it goes to sleep.
+const uint32_t JOB_SPIN_COUNT = 64;
+// What get_current_job_worker returns on threads that aren't workers.
+const uint32_t JOB_NOT_A_WORKER = UINT32_MAX;
+
+typedef void (*job_fn)(void* data);
+// Handles [begin, end) of a parallel_for.
+typedef void (*parallel_for_fn)(const uint32_t begin, const uint32_t end, void* data);
+
+struct job_decl {
+	job_fn function;
+	void* data;
+};
+
+struct job_system;
+struct job_counter;
+
+// A job waiting on a counter, and the counter it finishes against.
+struct job_continuation {
+	job_decl decl;
+	job_counter* counter;
+};
+
+// Counts unfinished jobs. Must not be reused until it reaches zero.
+struct job_counter {
+	job_counter();
+
+	std::atomic<int32_t> remaining;
+
+	// Jobs to start when this reaches zero. Locked, but only when
+	// adding to it or when the count hits zero.
+	std::mutex continuations_lock;
+	std::vector<job_continuation> continuations;
+};
+
+struct job {
+	job_fn function;
+	void* data;
+	job_counter* counter;
+
+	// For parallel_for. If range_function is set, this job handles
+	// [begin, end) of the range instead of calling function.
+	parallel_for_fn range_function;
+	uint32_t begin;
+	uint32_t end;
+	uint32_t grain;
+
+	// Set while the job is queued or running, so its slot in the
+	// pool isn't handed out again too soon.
+	std::atomic<bool> in_use;
+	// Whether it came from the shared pool rather than a worker's.
+	bool shared;
+};
+
+// A Chase-Lev deque. The owner pushes and pops at the bottom, anyone
+// can steal from the top.
+struct job_deque {
+	job_deque();
+
+	alignas(64) std::atomic<int64_t> top;
+	alignas(64) std::atomic<int64_t> bottom;
+	std::atomic<job*> jobs[JOB_DEQUE_SIZE];
+};
+
+struct job_worker {
+	job_worker();
+
+	job_system* system;
+	uint32_t index;
+	std::thread thread;
+
+	job_deque deque;
+	// Jobs are handed out from here in order. Only this worker takes
+	// from it, so there's nothing to lock.
+	job pool[JOB_POOL_SIZE];
+	uint32_t next_job;
+	// Where to start looking for something to steal.
+	uint32_t steal_from;
+
+	std::atomic<uint64_t> jobs_run;
+	std::atomic<uint64_t> steals;
+	std::atomic<uint64_t> sleeps;
+};
+
+struct job_system {
+	job_system();
+
+	// workers[0] is the main thread's (or whoever called
+	// initialize_job_system). The rest have threads of their own.
+	std::vector<std::unique_ptr<job_worker>> workers;
+	std::atomic<bool> running;
+
+	// Jobs from threads that aren't workers.
+	std::mutex shared_lock;
+	std::deque<job*> shared_jobs;
+	std::atomic<uint32_t> shared_count;
+	std::vector<std::unique_ptr<job>> shared_pool;
+	std::vector<job*> shared_free;
+
+	// Idle threads sleep here until there's work.
+	std::mutex sleep_lock;
+	std::condition_variable wake;
+	std::atomic<uint32_t> sleeping;
+};
+
+struct job_system_stats {
+	uint32_t worker_count;
+	uint64_t jobs_run;
+	uint64_t steals;
+	uint64_t sleeps;
+};
+
+// Starts worker_count - 1 worker threads; the calling thread is
+// worker 0. worker_count of 0 means one per core. If pin_threads is
+// set, each worker is kept on a core of its own.
+void initialize_job_system(
+	job_system* system,
+	uint32_t worker_count,
+	const bool pin_threads
+);
+// Waits for the workers to finish what they're doing and stops them.
+void shutdown_job_system(job_system* system);
+
+// Starts count jobs. counter (if any) goes up by count now and down by
+// one as each job finishes.
+void run_jobs(
+	job_system* system,
+	const job_decl* jobs,
+	const uint32_t count,
+	job_counter* counter
+);
+
+// Starts count jobs once dependency reaches zero.
+void run_jobs_after(
+	job_system* system,
+	job_counter* dependency,
+	const job_decl* jobs,
+	const uint32_t count,
+	job_counter* counter
+);
+
+// Runs jobs until counter reaches zero.
+void wait_for_counter(job_system* system, job_counter* counter);
+
+// Calls function over [0, count) in pieces, spread across the workers,
+// and returns when it's all done. Pieces are never smaller than grain,
+// except the last. grain of 0 picks one.
+void parallel_for(
+	job_system* system,
+	const uint32_t count,
+	uint32_t grain,
+	parallel_for_fn function,
+	void* data
+);
+
+uint32_t get_job_worker_count(const job_system* system);
+// Which worker the calling thread is, or JOB_NOT_A_WORKER.
+uint32_t get_current_job_worker(job_system* system);
+job_system_stats get_job_system_stats(const job_system* system);
+std::string get_job_system_report(const job_system* system);
@@ -0,0 +1,602 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "lod_selector.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define LODS_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// What selection does with the instances' bands.
+enum lod_band_use {
+	// They're up to date, so only instances that have left theirs are
+	// worked out.
+	LOD_BANDS_USE = 0,
+	// Every instance is worked out, and given a band for these distances.
+	LOD_BANDS_REBUILD,
+	// Every instance is worked out, for distances the bands aren't for.
+	// Their bands are emptied, so they're worked out again next time.
+	LOD_BANDS_EMPTY
+};
+
+struct select_lods_job {
+	const lod_view* view;
+	const lod_distances* distances;
+	lod_group* group;
+	lod_band_use bands;
+};
+
+static void get_lod_distances(
+	const lod_view* view,
+	const lod_selection_options* options,
+	const lod_chain* chain,
+	lod_distances* distances
+);
+static bool same_lod_distances(const lod_distances* a, const lod_distances* b);
+// Somewhere in [1 - dither, 1 + dither], always the same for the same
+// instance.
+static float get_dither_scale(const uint32_t instance, const float dither);
+// How far, squared, an instance's centre has to be from the camera for
+// it to be distance past it, for its radius and one over its dither
+// scale.
+static float get_band_edge(const float distance, const float radius, const float inverse_scale);
+static void select_lods_with(
+	const lod_view* view,
+	const lod_distances* distances,
+	lod_group* group,
+	const uint32_t first,
+	const uint32_t last,
+	const lod_band_use bands
+);
+static void select_lod(
+	const lod_view* view,
+	const lod_distances* distances,
+	lod_group* group,
+	const uint32_t instance,
+	const lod_band_use bands
+);
+#if defined(LODS_USE_SSE)
+// The low 32 bits of each of a * b, which SSE2 has no one instruction
+// for.
+static __m128i multiply_4(const __m128i a, const uint32_t b);
+static __m128 get_dither_scale_4(const __m128i instances, const float dither);
+static __m128 get_band_edge_4(const __m128 distance, const __m128 radius, const __m128 inverse_scale);
+#endif
+
+static void select_lods_job_range(const uint32_t begin, const uint32_t end, void* data);
+
+lod_selection_options::lod_selection_options() {
+	max_pixel_error = 1.0f;
+	hysteresis = 0.1f;
+	dither = 0.0f;
+}
+
+lod_group::lod_group() {
+	chain = NULL;
+
+	// No chain has no levels, so these never match any real distances.
+	memset(&band_distances, 0, sizeof(band_distances));
+}
+
+void set_lod_view(
+	lod_view* view,
+	const float eye[3],
+	const float field_of_view,
+	const float screen_height
+) {
+	view->eye[0] = eye[0];
+	view->eye[1] = eye[1];
+	view->eye[2] = eye[2];
+
+	// The screen is 2 tan(fov / 2) units tall, one unit away.
+	view->pixels_per_unit = screen_height / (2.0f * tanf(field_of_view * 0.5f));
+}
+
+uint32_t add_lod_instance(lod_group* group, const float center[3], const float radius) {
+	uint32_t instance;
+
+	instance = (uint32_t)group->lods.size();
+
+	group->center_x.push_back(center[0]);
+	group->center_y.push_back(center[1]);
+	group->center_z.push_back(center[2]);
+	group->radius.push_back(radius);
+	group->lods.push_back(0);
+
+	// An empty band, so it's worked out the first time it's selected.
+	group->stay_near.push_back(INFINITY);
+	group->stay_far.push_back(0.0f);
+
+	return instance;
+}
+
+void move_lod_instance(lod_group* group, const uint32_t instance, const float center[3], const float radius) {
+	group->center_x[instance] = center[0];
+	group->center_y[instance] = center[1];
+	group->center_z[instance] = center[2];
+	group->radius[instance] = radius;
+
+	// Its band was for its old radius.
+	group->stay_near[instance] = INFINITY;
+	group->stay_far[instance] = 0.0f;
+}
+
+void select_lods(
+	const lod_view* view,
+	const lod_selection_options* options,
+	lod_group* group,
+	const uint32_t first,
+	const uint32_t last
+) {
+	lod_distances distances;
+
+	if (first >= last) {
+		return;
+	}
+
+	get_lod_distances(view, options, group->chain, &distances);
+
+	//
+	// Only select_all_lods brings the group's bands up to date, since
+	// it's the only thing that sees every instance. Here they're either
+	// already right, or of no use.
+	//
+
+	select_lods_with(
+		view,
+		&distances,
+		group,
+		first,
+		last,
+		same_lod_distances(&distances, &(group->band_distances)) ? LOD_BANDS_USE : LOD_BANDS_EMPTY
+	);
+}
+
+void select_all_lods(
+	job_system* jobs,
+	const lod_view* view,
+	const lod_selection_options* options,
+	lod_group* group
+) {
+	lod_distances distances;
+	select_lods_job job;
+	uint32_t count;
+
+	count = (uint32_t)group->lods.size();
+	if (count == 0) {
+		return;
+	}
+
+	get_lod_distances(view, options, group->chain, &distances);
+
+	job.view = view;
+	job.distances = &distances;
+	job.group = group;
+	job.bands = same_lod_distances(&distances, &(group->band_distances)) ? LOD_BANDS_USE : LOD_BANDS_REBUILD;
+
+	if (jobs) {
+		// Big pieces, since each instance is only a few nanoseconds.
+		parallel_for(jobs, count, 16384, select_lods_job_range, &job);
+	} else {
+		select_lods_with(view, &distances, group, 0, count, job.bands);
+	}
+
+	if (job.bands == LOD_BANDS_REBUILD) {
+		group->band_distances = distances;
+	}
+}
+
+const mesh_lod* get_instance_lod(const lod_group* group, const uint32_t instance) {
+	return &(group->chain->lods[group->lods[instance]]);
+}
+
+string get_lod_group_report(const lod_group* group) {
+	uint32_t counts[MAX_MESH_LODS];
+	uint32_t level_count;
+	uint32_t count;
+	uint32_t i;
+	char line[128];
+	string result;
+
+	memset(counts, 0, sizeof(counts));
+
+	level_count = group->chain ? group->chain->lod_count : 0;
+	count = (uint32_t)group->lods.size();
+
+	for (i = 0; i < count; i++) {
+		counts[min((uint32_t)group->lods[i], MAX_MESH_LODS - 1)]++;
+	}
+
+	snprintf(line, sizeof(line), "LOD group: %u instances, %u levels\n", count, level_count);
+	result += line;
+
+	for (i = 0; i < level_count; i++) {
+		snprintf(
+			line,
+			sizeof(line),
+			"  LOD %u: %9u instances (%5.1f%%), %8u triangles each\n",
+			i,
+			counts[i],
+			count > 0 ? 100.0 * counts[i] / count : 0.0,
+			group->chain->lods[i].index_count / 3
+		);
+
+		result += line;
+	}
+
+	return result;
+}
+
+static void get_lod_distances(
+	const lod_view* view,
+	const lod_selection_options* options,
+	const lod_chain* chain,
+	lod_distances* distances
+) {
+	float scale;
+	float error;
+	float distance;
+	uint32_t i;
+
+	//
+	// Level l's error is max_pixel_error pixels on screen at
+	// error * pixels_per_unit / max_pixel_error away.
+	//
+
+	scale = view->pixels_per_unit / max(options->max_pixel_error, 1e-6f);
+
+	distances->level_count = chain->lod_count;
+	distances->dither = options->dither;
+
+	distances->coarser[0] = 0.0f;
+	distances->finer[0] = 0.0f;
+
+	// A level's error includes every collapse before it, so errors only
+	// grow along a chain. The bands count on that, so make sure of it.
+	error = 0.0f;
+
+	for (i = 1; i < MAX_MESH_LODS; i++) {
+		if (i < chain->lod_count) {
+			error = max(error, chain->lods[i].error);
+			distance = error * scale;
+
+			distances->coarser[i] = distance * (1.0f + options->hysteresis);
+			distances->finer[i] = distance * (1.0f - options->hysteresis);
+		} else {
+			// Never reached, which also lets four at a time go through
+			// every level without checking how many there are.
+			distances->coarser[i] = INFINITY;
+			distances->finer[i] = INFINITY;
+		}
+	}
+}
+
+static bool same_lod_distances(const lod_distances* a, const lod_distances* b) {
+	// Every field is 4 bytes, so there's no padding to differ.
+	return memcmp(a, b, sizeof(lod_distances)) == 0;
+}
+
+static float get_dither_scale(const uint32_t instance, const float dither) {
+	uint32_t hash;
+	float unit;
+
+	hash = instance * 0x9e3779b9u;
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+
+	// The top 23 bits as a float's mantissa, for a number in [1, 2).
+	hash = (hash >> 9) | 0x3f800000u;
+	memcpy(&unit, &hash, sizeof(unit));
+
+	return 1.0f + dither * (2.0f * unit - 3.0f);
+}
+
+static float get_band_edge(const float distance, const float radius, const float inverse_scale) {
+	float edge;
+
+	//
+	// An instance is distance past it once its nearest point, dithered,
+	// is: (centre - radius) * scale >= distance. So its centre has to be
+	// distance / scale + radius away. At 0 or less, it's always past.
+	//
+
+	if (distance <= 0.0f) {
+		return 0.0f;
+	}
+
+	edge = distance * inverse_scale + radius;
+
+	return edge * edge;
+}
+
+static void select_lods_with(
+	const lod_view* view,
+	const lod_distances* distances,
+	lod_group* group,
+	const uint32_t first,
+	const uint32_t last,
+	const lod_band_use bands
+) {
+	uint32_t i;
+#if defined(LODS_USE_SSE)
+	__m128 coarser[MAX_MESH_LODS];
+	__m128 finer[MAX_MESH_LODS];
+	__m128 coarser_edges[MAX_MESH_LODS];
+	__m128 finer_edges[MAX_MESH_LODS];
+	__m128 eye_x;
+	__m128 eye_y;
+	__m128 eye_z;
+	__m128 zero;
+	__m128 infinity;
+	__m128 dx;
+	__m128 dy;
+	__m128 dz;
+	__m128 distance;
+	__m128 radius_4;
+	__m128 inverse_scale;
+	__m128 past;
+	__m128 near;
+	__m128 far;
+	__m128i lowest;
+	__m128i highest;
+	__m128i current;
+	__m128i lanes;
+	const float* center_x;
+	const float* center_y;
+	const float* center_z;
+	const float* radius;
+	float* stay_near;
+	float* stay_far;
+	uint8_t* lods;
+	int32_t packed;
+	uint32_t level;
+#endif
+
+	i = first;
+
+#if defined(LODS_USE_SSE)
+	// A distance of 0 or less is always past. As minus infinity,
+	// get_band_edge_4 gets that without having to check.
+	for (level = 1; level < MAX_MESH_LODS; level++) {
+		coarser[level] = _mm_set1_ps(distances->coarser[level] > 0.0f ? distances->coarser[level] : -INFINITY);
+		finer[level] = _mm_set1_ps(distances->finer[level] > 0.0f ? distances->finer[level] : -INFINITY);
+	}
+
+	eye_x = _mm_set1_ps(view->eye[0]);
+	eye_y = _mm_set1_ps(view->eye[1]);
+	eye_z = _mm_set1_ps(view->eye[2]);
+	zero = _mm_setzero_ps();
+	infinity = _mm_set1_ps(INFINITY);
+	inverse_scale = _mm_set1_ps(1.0f);
+	lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+	// Writing the levels a byte at a time could, as far as the compiler
+	// knows, change where the vectors' data is, so it'd have to look
+	// again every time round. Looking once is worth a lot here.
+	center_x = group->center_x.data();
+	center_y = group->center_y.data();
+	center_z = group->center_z.data();
+	radius = group->radius.data();
+	stay_near = group->stay_near.data();
+	stay_far = group->stay_far.data();
+	lods = group->lods.data();
+
+	for (; i + 4 <= last; i += 4) {
+		//
+		// Exactly what select_lod does, four instances at a time.
+		//
+
+		dx = _mm_sub_ps(_mm_loadu_ps(center_x + i), eye_x);
+		dy = _mm_sub_ps(_mm_loadu_ps(center_y + i), eye_y);
+		dz = _mm_sub_ps(_mm_loadu_ps(center_z + i), eye_z);
+
+		distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+		// Nearly always, all four are still in their bands, and there's
+		// nothing else to do.
+		if (bands == LOD_BANDS_USE) {
+			past = _mm_or_ps(
+				_mm_cmplt_ps(distance, _mm_loadu_ps(stay_near + i)),
+				_mm_cmpge_ps(distance, _mm_loadu_ps(stay_far + i))
+			);
+
+			if (_mm_movemask_ps(past) == 0) {
+				continue;
+			}
+		}
+
+		radius_4 = _mm_loadu_ps(radius + i);
+
+		if (distances->dither > 0.0f) {
+			inverse_scale = _mm_div_ps(
+				_mm_set1_ps(1.0f),
+				get_dither_scale_4(_mm_add_epi32(_mm_set1_epi32((int32_t)i), lanes), distances->dither)
+			);
+		}
+
+		// Each comparison is all ones (-1) where it holds, so taking
+		// them away counts the levels each instance is past.
+		lowest = _mm_setzero_si128();
+		highest = _mm_setzero_si128();
+
+		for (level = 1; level < MAX_MESH_LODS; level++) {
+			coarser_edges[level] = get_band_edge_4(coarser[level], radius_4, inverse_scale);
+			finer_edges[level] = get_band_edge_4(finer[level], radius_4, inverse_scale);
+
+			lowest = _mm_sub_epi32(lowest, _mm_castps_si128(_mm_cmpge_ps(distance, coarser_edges[level])));
+			highest = _mm_sub_epi32(highest, _mm_castps_si128(_mm_cmpge_ps(distance, finer_edges[level])));
+		}
+
+		// Levels fit in 16 bits, which is the only width SSE2 has a
+		// min and max for.
+		lowest = _mm_packs_epi32(lowest, lowest);
+		highest = _mm_packs_epi32(highest, highest);
+
+		memcpy(&packed, lods + i, sizeof(packed));
+		current = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), _mm_setzero_si128());
+		current = _mm_min_epi16(_mm_max_epi16(current, lowest), highest);
+
+		packed = _mm_cvtsi128_si32(_mm_packus_epi16(current, current));
+		memcpy(lods + i, &packed, sizeof(packed));
+
+		//
+		// The new band runs from the edge of the level it's at to the
+		// edge of the next one up. Edges only grow with level, so that's
+		// the furthest edge at or below its level, and the nearest one
+		// above it.
+		//
+
+		if (bands == LOD_BANDS_EMPTY) {
+			near = infinity;
+			far = zero;
+		} else {
+			current = _mm_unpacklo_epi16(current, _mm_setzero_si128());
+			near = zero;
+			far = infinity;
+
+			for (level = 1; level < MAX_MESH_LODS; level++) {
+				past = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32((int32_t)level), current));
+
+				near = _mm_max_ps(near, _mm_andnot_ps(past, finer_edges[level]));
+				far = _mm_min_ps(far, _mm_or_ps(_mm_and_ps(past, coarser_edges[level]), _mm_andnot_ps(past, infinity)));
+			}
+		}
+
+		_mm_storeu_ps(stay_near + i, near);
+		_mm_storeu_ps(stay_far + i, far);
+	}
+#endif
+
+	for (; i < last; i++) {
+		select_lod(view, distances, group, i, bands);
+	}
+}
+
+static void select_lod(
+	const lod_view* view,
+	const lod_distances* distances,
+	lod_group* group,
+	const uint32_t instance,
+	const lod_band_use bands
+) {
+	float dx;
+	float dy;
+	float dz;
+	float distance;
+	float radius;
+	float inverse_scale;
+	uint32_t lowest;
+	uint32_t highest;
+	uint32_t current;
+	uint32_t level;
+
+	dx = group->center_x[instance] - view->eye[0];
+	dy = group->center_y[instance] - view->eye[1];
+	dz = group->center_z[instance] - view->eye[2];
+
+	distance = dx * dx + dy * dy + dz * dz;
+
+	if (bands == LOD_BANDS_USE &&
+		distance >= group->stay_near[instance] &&
+		distance < group->stay_far[instance]) {
+		return;
+	}
+
+	radius = group->radius[instance];
+	inverse_scale = distances->dither > 0.0f ? 1.0f / get_dither_scale(instance, distances->dither) : 1.0f;
+
+	//
+	// lowest is the coarsest level it's well past, so it should be at
+	// least that coarse. highest is the coarsest it's anywhere near, so
+	// it can be no coarser. Between the two, it stays where it is.
+	//
+
+	lowest = 0;
+	highest = 0;
+
+	for (level = 1; level < distances->level_count; level++) {
+		lowest += distance >= get_band_edge(distances->coarser[level], radius, inverse_scale) ? 1 : 0;
+		highest += distance >= get_band_edge(distances->finer[level], radius, inverse_scale) ? 1 : 0;
+	}
+
+	current = min(max((uint32_t)group->lods[instance], lowest), highest);
+	group->lods[instance] = (uint8_t)current;
+
+	if (bands == LOD_BANDS_EMPTY) {
+		group->stay_near[instance] = INFINITY;
+		group->stay_far[instance] = 0.0f;
+	} else {
+		group->stay_near[instance] = current > 0 ? get_band_edge(distances->finer[current], radius, inverse_scale) : 0.0f;
+		group->stay_far[instance] = current + 1 < distances->level_count ?
+			get_band_edge(distances->coarser[current + 1], radius, inverse_scale) :
+			INFINITY;
+	}
+}
+
+#if defined(LODS_USE_SSE)
+static __m128i multiply_4(const __m128i a, const uint32_t b) {
+	__m128i factor;
+	__m128i even;
+	__m128i odd;
+
+	// _mm_mul_epu32 only does lanes 0 and 2, so do 1 and 3 shifted
+	// down, then put the low halves back together.
+	factor = _mm_set1_epi32((int32_t)b);
+	even = _mm_mul_epu32(a, factor);
+	odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), factor);
+
+	return _mm_unpacklo_epi32(
+		_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))
+	);
+}
+
+static __m128 get_dither_scale_4(const __m128i instances, const float dither) {
+	__m128i hash;
+	__m128 unit;
+
+	hash = multiply_4(instances, 0x9e3779b9u);
+	hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 16));
+	hash = multiply_4(hash, 0x85ebca6bu);
+	hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 13));
+
+	hash = _mm_or_si128(_mm_srli_epi32(hash, 9), _mm_set1_epi32(0x3f800000));
+	unit = _mm_castsi128_ps(hash);
+
+	return _mm_add_ps(
+		_mm_set1_ps(1.0f),
+		_mm_mul_ps(
+			_mm_set1_ps(dither),
+			_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.0f), unit), _mm_set1_ps(3.0f))
+		)
+	);
+}
+
+static __m128 get_band_edge_4(const __m128 distance, const __m128 radius, const __m128 inverse_scale) {
+	__m128 edge;
+
+	// Just as get_band_edge, for distances that are either more than 0
+	// or minus infinity, which comes out as 0.
+	edge = _mm_add_ps(_mm_mul_ps(distance, inverse_scale), radius);
+	edge = _mm_max_ps(edge, _mm_setzero_ps());
+
+	return _mm_mul_ps(edge, edge);
+}
+#endif
+
+static void select_lods_job_range(const uint32_t begin, const uint32_t end, void* data) {
+	select_lods_job* job;
+
+	job = (select_lods_job*)data;
+
+	select_lods_with(job->view, job->distances, job->group, begin, end, job->bands);
+}
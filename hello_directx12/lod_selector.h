@@ -0,0 +1,152 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Picks which level of its LOD chain each instance of a mesh is drawn
+// with, by how big the level's error would look on screen.
+//
+// A level's error (see mesh_lod) is in the mesh's own units. Seen from
+// a distance d, it covers about error * pixels_per_unit / d pixels,
+// where pixels_per_unit is how many pixels one unit covers at a
+// distance of one. A level is good enough once that's under
+// max_pixel_error, so every level has a distance past which it can be
+// used, and an instance gets the coarsest level it's past. The distance
+// is to the nearest point of the instance's bounding sphere, so a big
+// object right in front of the camera doesn't count as far away just
+// because its centre is.
+//
+// Left at that, an instance sitting right on one of those distances
+// would flicker between two levels as the camera bobs about. So there's
+// hysteresis: an instance only goes to a coarser level once it's
+// hysteresis further away than it needs to be, and only goes back to a
+// finer one once it's hysteresis closer. In between, it keeps whatever
+// level it had last time.
+//
+// A crowd of the same mesh still all switches at about the same time,
+// as the camera moves past the distance they all share. dither moves
+// each instance's distances a little, by an amount that's random but
+// always the same for that instance, so the crowd's switches are
+// spread over a few frames rather than all landing on one.
+//
+// All of that comes down to a band of distances an instance keeps its
+// level over, which only changes when it changes level or the view's
+// scale or the options do. So each instance keeps its band, as squared
+// distances from the camera to its centre, and most frames selecting
+// is just working out that distance and seeing it's still in the band.
+// Only instances that have left theirs are worked out in full.
+//
+// Instances are kept a component per array (every centre's x, then
+// every centre's y, ...) so four can be loaded and worked on at once
+// with SSE. On anything else, they're done one at a time, with the same
+// results. Selection only ever writes an instance's own level and band,
+// so a group can be split across the job system.
+//
+// Like the render queue, none of this depends on DirectX.
+//
+
+#pragma once
+
+#include "mesh_simplifier.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct job_system;
+
+struct lod_selection_options {
+	lod_selection_options();
+
+	// How many pixels of error a level can have on screen.
+	float max_pixel_error;
+	// As a fraction of the distance. 0 switches as soon as a level is
+	// good enough.
+	float hysteresis;
+	// How far instances' distances are spread, as a fraction. 0 turns
+	// dithering off.
+	float dither;
+};
+
+// Where this frame is seen from.
+struct lod_view {
+	float eye[3];
+	// How many pixels one unit covers, one unit in front of the camera.
+	float pixels_per_unit;
+};
+
+// The distances, from the camera, that a group's levels switch at for
+// some view and options. Level 0 can always be used, so these start at
+// level 1, and levels past the chain's end are never switched to.
+struct lod_distances {
+	uint32_t level_count;
+	// Past coarser[l], an instance goes to level l (or coarser) if it's
+	// finer than that now...
+	float coarser[MAX_MESH_LODS];
+	// ...and closer than finer[l], it goes back to level l - 1 (or
+	// finer) if it's coarser than that now.
+	float finer[MAX_MESH_LODS];
+	float dither;
+};
+
+// Every instance of one mesh.
+struct lod_group {
+	lod_group();
+
+	// The mesh's chain. Its levels' errors decide when to switch, and
+	// its index ranges are what get drawn.
+	const lod_chain* chain;
+
+	// Each instance's bounding sphere, in world space.
+	std::vector<float> center_x;
+	std::vector<float> center_y;
+	std::vector<float> center_z;
+	std::vector<float> radius;
+	// Each instance's level, as of the last selection. One set by hand
+	// needs a move_lod_instance after, so its band is worked out again.
+	std::vector<uint8_t> lods;
+
+	// Each instance keeps its level while its centre's squared distance
+	// from the camera is in [stay_near, stay_far).
+	std::vector<float> stay_near;
+	std::vector<float> stay_far;
+	// What the bands were worked out for. select_all_lods works them
+	// all out again when this changes.
+	lod_distances band_distances;
+};
+
+// field_of_view is vertical, in radians, and screen_height in pixels.
+void set_lod_view(
+	lod_view* view,
+	const float eye[3],
+	const float field_of_view,
+	const float screen_height
+);
+
+// Returns the new instance's index. It starts at the finest level.
+uint32_t add_lod_instance(lod_group* group, const float center[3], const float radius);
+void move_lod_instance(lod_group* group, const uint32_t instance, const float center[3], const float radius);
+
+// Picks levels for instances first to last - 1. It only uses the bands
+// if select_all_lods has already worked them out for this view's scale
+// and these options.
+void select_lods(
+	const lod_view* view,
+	const lod_selection_options* options,
+	lod_group* group,
+	const uint32_t first,
+	const uint32_t last
+);
+
+// Picks levels for every instance, spread across the job system. jobs
+// can be NULL to do them all on this thread.
+void select_all_lods(
+	job_system* jobs,
+	const lod_view* view,
+	const lod_selection_options* options,
+	lod_group* group
+);
+
+// The index range an instance is drawn with.
+const mesh_lod* get_instance_lod(const lod_group* group, const uint32_t instance);
+
+// How many instances are at each level.
+std::string get_lod_group_report(const lod_group* group);
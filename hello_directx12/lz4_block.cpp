@@ -0,0 +1,372 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "lz4_block.h"
+
+#include <cstring>
+
+using namespace std;
+
+// Matches are at least this long, which is what a length of 0 means.
+const size_t LZ4_MIN_MATCH = 4;
+// A block always ends with at least this many literals...
+const size_t LZ4_LAST_LITERALS = 5;
+// ...and its last match starts at least this far from the end.
+const size_t LZ4_MATCH_FIND_LIMIT = 12;
+const size_t LZ4_MAX_OFFSET = 65535;
+// A length of 15 in a token means more of it follows, a byte at a time.
+const uint32_t LZ4_RUN_MASK = 15;
+const uint32_t LZ4_HASH_BITS = 12;
+const uint32_t LZ4_HASH_SIZE = 1 << LZ4_HASH_BITS;
+// Every 2^this misses in a row, the search skips a byte more each time.
+const uint32_t LZ4_SKIP_TRIGGER = 6;
+// While there's this much room left in both buffers, short copies are
+// done a whole 16 or 8 bytes at a time, running past the end of what's
+// wanted into space that's written over next anyway.
+const size_t LZ4_FAST_MARGIN = 32;
+
+static uint32_t read_32(const uint8_t* data);
+static uint64_t read_64(const uint8_t* data);
+static uint32_t hash_position(const uint8_t* data);
+static uint8_t* write_length(uint8_t* output, size_t length);
+static uint8_t* write_sequence(
+	uint8_t* output,
+	const uint8_t* literals,
+	const size_t literal_length,
+	const size_t offset,
+	const size_t match_length
+);
+static bool read_length(const uint8_t** input, const uint8_t* input_end, size_t* length);
+
+size_t get_lz4_bound(const size_t size) {
+	return size + size / 255 + 16;
+}
+
+size_t compress_lz4_block(
+	const void* source,
+	const size_t size,
+	void* destination,
+	const size_t capacity
+) {
+	const uint8_t* input;
+	uint8_t* output;
+	uint32_t table[LZ4_HASH_SIZE];
+	size_t anchor;
+	size_t position;
+	size_t candidate;
+	size_t length;
+	size_t match_limit;
+	size_t find_limit;
+	uint32_t hash;
+	uint32_t search_count;
+	bool found;
+
+	if (capacity < get_lz4_bound(size)) {
+		return 0;
+	}
+
+	input = (const uint8_t*)source;
+	output = (uint8_t*)destination;
+	anchor = 0;
+
+	//
+	// Anything shorter than this is all literals.
+	//
+
+	if (size > LZ4_MATCH_FIND_LIMIT) {
+		memset(table, 0, sizeof(table));
+
+		match_limit = size - LZ4_LAST_LITERALS;
+		find_limit = size - LZ4_MATCH_FIND_LIMIT;
+		position = 0;
+
+		for (;;) {
+			//
+			// Look for four bytes we've seen before, close enough to reach.
+			// The table starts out pointing everything at 0, which is only
+			// ever a false lead.
+			//
+
+			search_count = 1 << LZ4_SKIP_TRIGGER;
+			found = false;
+
+			while (position <= find_limit) {
+				hash = hash_position(input + position);
+				candidate = table[hash];
+				table[hash] = (uint32_t)position;
+
+				if (candidate < position &&
+					position - candidate <= LZ4_MAX_OFFSET &&
+					read_32(input + candidate) == read_32(input + position))
+				{
+					found = true;
+					break;
+				}
+
+				position += search_count >> LZ4_SKIP_TRIGGER;
+				search_count++;
+			}
+
+			if (!found) {
+				break;
+			}
+
+			//
+			// Grow the match backwards over the literals before it, then
+			// forwards as far as it goes, eight bytes at a time and then
+			// one at a time.
+			//
+
+			while (position > anchor && candidate > 0 && input[position - 1] == input[candidate - 1]) {
+				position--;
+				candidate--;
+			}
+
+			length = LZ4_MIN_MATCH;
+
+			while (position + length + 8 <= match_limit &&
+				read_64(input + position + length) == read_64(input + candidate + length))
+			{
+				length += 8;
+			}
+
+			while (position + length < match_limit && input[position + length] == input[candidate + length]) {
+				length++;
+			}
+
+			output = write_sequence(output, input + anchor, position - anchor, position - candidate, length);
+
+			position += length;
+			anchor = position;
+		}
+	}
+
+	// The rest is literals, with no match after them.
+	output = write_sequence(output, input + anchor, size - anchor, 0, 0);
+
+	return (size_t)(output - (uint8_t*)destination);
+}
+
+bool decompress_lz4_block(
+	const void* source,
+	const size_t source_size,
+	void* destination,
+	const size_t size
+) {
+	const uint8_t* input;
+	const uint8_t* input_end;
+	uint8_t* output;
+	uint8_t* output_start;
+	uint8_t* output_end;
+	const uint8_t* match;
+	uint8_t* copy_end;
+	size_t literal_length;
+	size_t match_length;
+	size_t offset;
+	size_t piece;
+	uint32_t token;
+
+	input = (const uint8_t*)source;
+	input_end = input + source_size;
+	output_start = (uint8_t*)destination;
+	output = output_start;
+	output_end = output_start + size;
+
+	for (;;) {
+		if (input >= input_end) {
+			return false;
+		}
+
+		token = *input;
+		input++;
+
+		//
+		// Literals.
+		//
+
+		literal_length = token >> 4;
+
+		// Short, and far from either end, so copy 16 whatever it is.
+		if (literal_length < LZ4_RUN_MASK &&
+			(size_t)(input_end - input) >= LZ4_FAST_MARGIN &&
+			(size_t)(output_end - output) >= LZ4_FAST_MARGIN)
+		{
+			memcpy(output, input, 16);
+			input += literal_length;
+			output += literal_length;
+			literal_length = 0;
+		}
+
+		if (literal_length == LZ4_RUN_MASK && !read_length(&input, input_end, &literal_length)) {
+			return false;
+		}
+
+		if (literal_length > (size_t)(input_end - input) || literal_length > (size_t)(output_end - output)) {
+			return false;
+		}
+
+		if (literal_length > 0) {
+			memcpy(output, input, literal_length);
+			input += literal_length;
+			output += literal_length;
+		}
+
+		// The last sequence is only literals.
+		if (input == input_end) {
+			break;
+		}
+
+		//
+		// Then the match.
+		//
+
+		if (input_end - input < 2) {
+			return false;
+		}
+
+		offset = (size_t)input[0] | ((size_t)input[1] << 8);
+		input += 2;
+
+		if (offset == 0 || offset > (size_t)(output - output_start)) {
+			return false;
+		}
+
+		match_length = token & LZ4_RUN_MASK;
+		if (match_length == LZ4_RUN_MASK && !read_length(&input, input_end, &match_length)) {
+			return false;
+		}
+
+		match_length += LZ4_MIN_MATCH;
+
+		if (match_length > (size_t)(output_end - output)) {
+			return false;
+		}
+
+		//
+		// A match can overlap what it's writing, when it repeats
+		// something shorter than itself. What's written so far repeats
+		// every offset bytes, so copy it in pieces that never overlap,
+		// each twice as long as the last.
+		//
+
+		match = output - offset;
+
+		// Far enough back that 8 bytes at a time never reads what it's
+		// still writing.
+		if (offset >= 8 && (size_t)(output_end - output) >= match_length + LZ4_FAST_MARGIN) {
+			copy_end = output + match_length;
+
+			while (output < copy_end) {
+				memcpy(output, match, 8);
+				output += 8;
+				match += 8;
+			}
+
+			output = copy_end;
+			continue;
+		}
+
+		while (match_length > 0) {
+			piece = (size_t)(output - match);
+			piece = piece < match_length ? piece : match_length;
+
+			memcpy(output, match, piece);
+			output += piece;
+			match_length -= piece;
+		}
+	}
+
+	return output == output_end;
+}
+
+static uint32_t read_32(const uint8_t* data) {
+	uint32_t value;
+
+	memcpy(&value, data, sizeof(value));
+
+	return value;
+}
+
+static uint64_t read_64(const uint8_t* data) {
+	uint64_t value;
+
+	memcpy(&value, data, sizeof(value));
+
+	return value;
+}
+
+static uint32_t hash_position(const uint8_t* data) {
+	return (read_32(data) * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+static uint8_t* write_length(uint8_t* output, size_t length) {
+	while (length >= 255) {
+		*output = 255;
+		output++;
+		length -= 255;
+	}
+
+	*output = (uint8_t)length;
+	output++;
+
+	return output;
+}
+
+static uint8_t* write_sequence(
+	uint8_t* output,
+	const uint8_t* literals,
+	const size_t literal_length,
+	const size_t offset,
+	const size_t match_length
+) {
+	uint8_t* token;
+
+	token = output;
+	output++;
+
+	if (literal_length >= LZ4_RUN_MASK) {
+		*token = (uint8_t)(LZ4_RUN_MASK << 4);
+		output = write_length(output, literal_length - LZ4_RUN_MASK);
+	} else {
+		*token = (uint8_t)(literal_length << 4);
+	}
+
+	// Empty blocks can come with NULL pointers, which memcpy doesn't
+	// allow even for nothing.
+	if (literal_length > 0) {
+		memcpy(output, literals, literal_length);
+		output += literal_length;
+	}
+
+	if (match_length == 0) {
+		return output;
+	}
+
+	output[0] = (uint8_t)(offset & 0xff);
+	output[1] = (uint8_t)(offset >> 8);
+	output += 2;
+
+	if (match_length - LZ4_MIN_MATCH >= LZ4_RUN_MASK) {
+		*token |= (uint8_t)LZ4_RUN_MASK;
+		output = write_length(output, match_length - LZ4_MIN_MATCH - LZ4_RUN_MASK);
+	} else {
+		*token |= (uint8_t)(match_length - LZ4_MIN_MATCH);
+	}
+
+	return output;
+}
+
+static bool read_length(const uint8_t** input, const uint8_t* input_end, size_t* length) {
+	uint8_t byte;
+
+	do {
+		if (*input >= input_end) {
+			return false;
+		}
+
+		byte = **input;
+		(*input)++;
+		*length += byte;
+	} while (byte == 255);
+
+	return true;
+}
@@ -0,0 +1,48 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Compresses and decompresses blocks in LZ4's block format, so anything
+// written here can be read by the real LZ4 library and the other way
+// around. It's written out here rather than pulled in, since the asset
+// archive only needs the block functions and not LZ4's frames.
+//
+// A block is a run of sequences. Each is some bytes copied as they are
+// (literals), then a match: a length and how far back in what's been
+// decompressed so far to copy it from. The compressor finds matches with
+// a small hash table of where each four bytes were last seen, which is
+// quick rather than thorough. It gets through incompressible data
+// faster the longer it goes without finding a match.
+//
+// Decompressing checks every length and offset against both buffers, so
+// a damaged block fails rather than reading or writing out of bounds.
+//
+// Like the render queue, none of this depends on DirectX.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The most a block of size bytes can compress to, which is a bit more
+// than size when it doesn't compress at all.
+size_t get_lz4_bound(const size_t size);
+
+// Compresses size bytes of source into destination, which must have room
+// for get_lz4_bound(size). Returns the compressed size, or 0 if there
+// isn't enough room.
+size_t compress_lz4_block(
+	const void* source,
+	const size_t size,
+	void* destination,
+	const size_t capacity
+);
+
+// Decompresses a block that decompresses to exactly size bytes. Returns
+// false if the block is damaged or comes out any other size.
+bool decompress_lz4_block(
+	const void* source,
+	const size_t source_size,
+	void* destination,
+	const size_t size
+);
@@ -0,0 +1,271 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "material_registry.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+static bool is_valid_texture(const material_registry* registry, const uint32_t slot);
+static void mark_dirty(material_registry* registry, const uint32_t index);
+
+material_registry::material_registry() {
+	max_materials = 0;
+	max_textures = 0;
+	dirty_begin = 0;
+	dirty_end = 0;
+	records_uploaded = 0;
+	uploads = 0;
+}
+
+gpu_material get_default_material() {
+	gpu_material material;
+
+	material = {};
+	material.albedo_texture = MATERIAL_NO_TEXTURE;
+	material.roughness = 1.0f;
+	material.base_color[0] = 1.0f;
+	material.base_color[1] = 1.0f;
+	material.base_color[2] = 1.0f;
+	material.base_color[3] = 1.0f;
+	material.uv_scale[0] = 1.0f;
+	material.uv_scale[1] = 1.0f;
+
+	return material;
+}
+
+void initialize_material_registry(
+	material_registry* registry,
+	const uint32_t max_materials,
+	const uint32_t max_textures
+) {
+	uint32_t i;
+
+	registry->max_materials = max_materials;
+	registry->max_textures = max_textures;
+
+	registry->materials.clear();
+	registry->names.clear();
+	registry->free_materials.clear();
+	registry->materials_by_name.clear();
+
+	registry->textures.clear();
+	registry->free_textures.clear();
+	registry->texture_slots.clear();
+
+	//
+	// Every record starts out as the default material, and the whole
+	// buffer needs uploading once so the GPU sees that too.
+	//
+
+	registry->materials.assign(max_materials, get_default_material());
+	registry->names.assign(max_materials, string());
+
+	// Backwards, so the lowest slots get handed out first.
+	for (i = max_materials; i > 0; i--) {
+		registry->free_materials.push_back(i - 1);
+	}
+
+	registry->textures.assign(max_textures, NULL);
+
+	for (i = max_textures; i > 0; i--) {
+		registry->free_textures.push_back(i - 1);
+	}
+
+	registry->dirty_begin = 0;
+	registry->dirty_end = max_materials;
+	registry->records_uploaded = 0;
+	registry->uploads = 0;
+}
+
+uint32_t add_material_texture(material_registry* registry, const void* texture) {
+	unordered_map<const void*, uint32_t>::const_iterator it;
+	uint32_t slot;
+
+	it = registry->texture_slots.find(texture);
+	if (it != registry->texture_slots.end()) {
+		return it->second;
+	}
+
+	if (!texture || registry->free_textures.empty()) {
+		return MATERIAL_NO_TEXTURE;
+	}
+
+	slot = registry->free_textures.back();
+	registry->free_textures.pop_back();
+
+	registry->textures[slot] = texture;
+	registry->texture_slots[texture] = slot;
+
+	return slot;
+}
+
+void remove_material_texture(material_registry* registry, const void* texture) {
+	unordered_map<const void*, uint32_t>::iterator it;
+
+	it = registry->texture_slots.find(texture);
+	if (it == registry->texture_slots.end()) {
+		return;
+	}
+
+	registry->textures[it->second] = NULL;
+	registry->free_textures.push_back(it->second);
+	registry->texture_slots.erase(it);
+}
+
+uint32_t add_material(
+	material_registry* registry,
+	const string& name,
+	const gpu_material& material
+) {
+	unordered_map<string, uint32_t>::const_iterator it;
+	uint32_t index;
+
+	it = registry->materials_by_name.find(name);
+	if (it != registry->materials_by_name.end()) {
+		return update_material(registry, it->second, material) ? it->second : MATERIAL_INVALID;
+	}
+
+	if (registry->free_materials.empty() || !is_valid_texture(registry, material.albedo_texture)) {
+		return MATERIAL_INVALID;
+	}
+
+	index = registry->free_materials.back();
+	registry->free_materials.pop_back();
+
+	registry->materials[index] = material;
+	registry->names[index] = name;
+	registry->materials_by_name[name] = index;
+	mark_dirty(registry, index);
+
+	return index;
+}
+
+bool update_material(
+	material_registry* registry,
+	const uint32_t index,
+	const gpu_material& material
+) {
+	if (index >= registry->max_materials || registry->names[index].empty()) {
+		return false;
+	}
+
+	if (!is_valid_texture(registry, material.albedo_texture)) {
+		return false;
+	}
+
+	registry->materials[index] = material;
+	mark_dirty(registry, index);
+
+	return true;
+}
+
+void remove_material(material_registry* registry, const uint32_t index) {
+	if (index >= registry->max_materials || registry->names[index].empty()) {
+		return;
+	}
+
+	registry->materials_by_name.erase(registry->names[index]);
+	registry->names[index].clear();
+	registry->materials[index] = get_default_material();
+	registry->free_materials.push_back(index);
+	mark_dirty(registry, index);
+}
+
+uint32_t find_material(const material_registry* registry, const string& name) {
+	unordered_map<string, uint32_t>::const_iterator it;
+
+	it = registry->materials_by_name.find(name);
+	if (it == registry->materials_by_name.end()) {
+		return MATERIAL_INVALID;
+	}
+
+	return it->second;
+}
+
+uint32_t upload_materials(material_registry* registry, void* destination) {
+	uint32_t count;
+
+	if (registry->dirty_begin >= registry->dirty_end) {
+		return 0;
+	}
+
+	//
+	// Copy the changed records as one block. Material edits tend to be
+	// few and far between, so this is usually nothing or one record.
+	//
+
+	count = registry->dirty_end - registry->dirty_begin;
+
+	memcpy(
+		(uint8_t*)destination + (size_t)registry->dirty_begin * sizeof(gpu_material),
+		&(registry->materials[registry->dirty_begin]),
+		(size_t)count * sizeof(gpu_material)
+	);
+
+	registry->dirty_begin = 0;
+	registry->dirty_end = 0;
+	registry->records_uploaded += count;
+	registry->uploads++;
+
+	return count;
+}
+
+material_registry_stats get_material_registry_stats(const material_registry* registry) {
+	material_registry_stats stats;
+
+	stats.material_count = registry->max_materials - (uint32_t)registry->free_materials.size();
+	stats.max_materials = registry->max_materials;
+	stats.texture_count = registry->max_textures - (uint32_t)registry->free_textures.size();
+	stats.max_textures = registry->max_textures;
+	stats.records_uploaded = registry->records_uploaded;
+	stats.uploads = registry->uploads;
+
+	return stats;
+}
+
+string get_material_registry_report(const material_registry* registry) {
+	material_registry_stats stats;
+	char report[256];
+
+	stats = get_material_registry_stats(registry);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Materials: %u of %u, textures: %u of %u, %llu records uploaded in %llu uploads\n",
+		stats.material_count,
+		stats.max_materials,
+		stats.texture_count,
+		stats.max_textures,
+		(unsigned long long)stats.records_uploaded,
+		(unsigned long long)stats.uploads
+	);
+
+	return report;
+}
+
+static bool is_valid_texture(const material_registry* registry, const uint32_t slot) {
+	if (slot == MATERIAL_NO_TEXTURE) {
+		return true;
+	}
+
+	return slot < registry->max_textures && registry->textures[slot] != NULL;
+}
+
+static void mark_dirty(material_registry* registry, const uint32_t index) {
+	if (registry->dirty_begin >= registry->dirty_end) {
+		registry->dirty_begin = index;
+		registry->dirty_end = index + 1;
+		return;
+	}
+
+	if (index < registry->dirty_begin) {
+		registry->dirty_begin = index;
+	}
+
+	if (index + 1 > registry->dirty_end) {
+		registry->dirty_end = index + 1;
+	}
+}
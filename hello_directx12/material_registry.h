@@ -0,0 +1,126 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Materials, the bindless way. Every texture gets a slot in one big
+// shader visible descriptor heap, which the shaders see as a single
+// unbounded array of textures. A material is then just a record in a
+// structured buffer saying which slots it samples and what its scalar
+// parameters are, and a draw only needs to say which record to use.
+//
+// That means switching materials between draws is one root constant:
+// no descriptor copies, no table rebinding, and no new root signature
+// or pipeline state for a new texture.
+//
+// The registry keeps the records and hands out texture and material
+// slots. It doesn't touch D3D itself. The application creates an SRV
+// at each texture's slot, and copies the records into its material
+// buffer with upload_materials, which only copies what changed.
+//
+// Removed slots are reused. Anything still pointing at a removed
+// material draws with the default one. Removing a texture doesn't
+// touch the materials that use it, so update or remove those first.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const uint32_t MATERIAL_NO_TEXTURE = 0xffffffff;
+const uint32_t MATERIAL_INVALID = 0xffffffff;
+
+// What the shaders see. This must match struct material in
+// texture_shader.hlsl, which is why it's all 4 byte fields.
+struct gpu_material {
+	// Slot in the texture array, or MATERIAL_NO_TEXTURE.
+	uint32_t albedo_texture;
+	uint32_t flags;
+	float roughness;
+	float metallic;
+	float base_color[4];
+	float uv_scale[2];
+	float uv_offset[2];
+};
+
+static_assert(sizeof(gpu_material) == 48, "gpu_material must match the HLSL struct");
+
+struct material_registry_stats {
+	uint32_t material_count;
+	uint32_t max_materials;
+	uint32_t texture_count;
+	uint32_t max_textures;
+	uint64_t records_uploaded;
+	uint64_t uploads;
+};
+
+struct material_registry {
+	material_registry();
+
+	uint32_t max_materials;
+	uint32_t max_textures;
+
+	// Indexed by material. Removed ones are default materials with an
+	// empty name.
+	std::vector<gpu_material> materials;
+	std::vector<std::string> names;
+	std::vector<uint32_t> free_materials;
+	std::unordered_map<std::string, uint32_t> materials_by_name;
+
+	// Indexed by texture slot. NULL if the slot is free.
+	std::vector<const void*> textures;
+	std::vector<uint32_t> free_textures;
+	std::unordered_map<const void*, uint32_t> texture_slots;
+
+	// The records that have changed since the last upload.
+	uint32_t dirty_begin;
+	uint32_t dirty_end;
+
+	uint64_t records_uploaded;
+	uint64_t uploads;
+};
+
+// White, untextured, and with no UV scaling.
+gpu_material get_default_material();
+
+void initialize_material_registry(
+	material_registry* registry,
+	const uint32_t max_materials,
+	const uint32_t max_textures
+);
+
+// Returns the texture's slot, giving it one if it doesn't have one, or
+// MATERIAL_NO_TEXTURE if there are none left.
+uint32_t add_material_texture(material_registry* registry, const void* texture);
+// Frees the texture's slot for reuse.
+void remove_material_texture(material_registry* registry, const void* texture);
+
+// Adds a material, or replaces the one with the same name. Returns its
+// index, or MATERIAL_INVALID if there's no room or it uses a texture
+// slot nothing is in.
+uint32_t add_material(
+	material_registry* registry,
+	const std::string& name,
+	const gpu_material& material
+);
+// Returns false if the index isn't a material or the texture isn't in
+// a slot.
+bool update_material(
+	material_registry* registry,
+	const uint32_t index,
+	const gpu_material& material
+);
+void remove_material(material_registry* registry, const uint32_t index);
+
+// MATERIAL_INVALID if there isn't one with that name.
+uint32_t find_material(const material_registry* registry, const std::string& name);
+
+// Copies every record that changed since the last call into
+// destination, which holds max_materials records laid out like
+// materials. The GPU must not be reading it. Returns how many records
+// were copied.
+uint32_t upload_materials(material_registry* registry, void* destination);
+
+material_registry_stats get_material_registry_stats(const material_registry* registry);
+std::string get_material_registry_report(const material_registry* registry);
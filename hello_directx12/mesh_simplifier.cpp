@@ -0,0 +1,1201 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "mesh_simplifier.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// Each point in the quadrics is a position and a UV.
+const uint32_t QUADRIC_SIZE = 5;
+// The upper triangle of a symmetric QUADRIC_SIZE matrix.
+const uint32_t QUADRIC_TERMS = 15;
+// How much more the planes that hold open edges in place count than the
+// triangles' own, so border vertices slide along their edge rather
+// than off it.
+const float BORDER_WEIGHT = 10.0f;
+// A pass takes the collapses it needs, cheapest first, and any others
+// up to this many times as costly as the last of those. Anything
+// dearer waits for a later pass, in case something cheaper frees up.
+const float PASS_ERROR_SLACK = 1.5f;
+// A collapse can't turn any triangle more than this far (the cosine of
+// the angle), which also stops triangles being folded over.
+const float FLIP_LIMIT = 0.25f;
+
+enum vertex_kind {
+	VERTEX_INTERIOR = 0,
+	// On an open edge, and can only move along it.
+	VERTEX_BORDER,
+	// Can't move at all, though other vertices can move into it.
+	VERTEX_LOCKED
+};
+
+//
+// A point x's error is y'Ay + 2b'y + c, where y is x less the position
+// of the vertex the quadric belongs to. A is symmetric, so only its
+// upper triangle is kept, row by row.
+//
+// Measuring from the vertex, rather than from the origin, keeps the
+// numbers about as big as the edges around it. From the origin, every
+// term would be about 1 while the error itself can be 1e-8, which is
+// more than a float can tell apart, and dense meshes would look like
+// they have no error at all.
+//
+struct quadric {
+	float a[QUADRIC_TERMS];
+	float b[QUADRIC_SIZE];
+	float c;
+	// The area of the triangles in it. Dividing by this turns the error
+	// into a squared distance.
+	float weight;
+};
+
+struct edge_collapse {
+	uint32_t from;
+	uint32_t to;
+	float cost;
+};
+
+// Sorts vertices by position, to find the ones in the same place.
+struct weld_key {
+	float position[3];
+	uint32_t vertex;
+};
+
+// One mesh being simplified.
+struct simplifier {
+	uint32_t vertex_count;
+	// Each vertex's position and UV, QUADRIC_SIZE floats each. The mesh
+	// is moved and scaled to fit in a unit cube, and UVs are scaled by
+	// uv_weight, so the costs don't depend on the mesh's size.
+	vector<float> points;
+	// Turns a distance between points back into the mesh's units.
+	float scale;
+	// For each vertex, the lowest numbered vertex at the same position.
+	vector<uint32_t> welded;
+	vector<uint8_t> kinds;
+	vector<quadric> quadrics;
+
+	// The triangles left.
+	vector<uint32_t> indices;
+
+	//
+	// Rebuilt every pass.
+	//
+
+	// The triangles vertex v is in are adjacency[adjacency_offsets[v]]
+	// up to adjacency[adjacency_offsets[v + 1]].
+	vector<uint32_t> adjacency_offsets;
+	vector<uint32_t> adjacency;
+	vector<edge_collapse> collapses;
+	// Vertices with a triangle that's changed this pass.
+	vector<uint8_t> touched;
+	vector<uint8_t> dead;
+
+	// The costliest collapse so far, in points' units squared.
+	float error;
+	uint32_t passes;
+};
+
+// What the jobs building chains share.
+struct lod_chain_job {
+	const mesh_source* meshes;
+	const lod_chain_options* options;
+	lod_chain* chains;
+};
+
+static double now_seconds();
+static bool compare_weld_keys(const weld_key& a, const weld_key& b);
+static bool compare_collapses(const edge_collapse& a, const edge_collapse& b);
+static uint64_t make_edge_key(const uint32_t a, const uint32_t b);
+static float dot(const float* a, const float* b);
+
+static void initialize_simplifier(
+	simplifier* s,
+	const mesh_source* mesh,
+	const float uv_weight,
+	const bool lock_borders
+);
+static void weld_vertices(simplifier* s, const mesh_vertex* vertices);
+// Finds the seams, borders and non-manifold edges, and adds the border
+// planes to the quadrics.
+static void classify_vertices(simplifier* s, const bool lock_borders);
+static void add_triangle_quadric(simplifier* s, const uint32_t* triangle);
+static void add_border_quadric(simplifier* s, const uint32_t* triangle, const uint32_t edge);
+static void add_quadric(quadric* destination, const quadric* source);
+// Moves where a quadric measures from by offset.
+static void move_quadric(quadric* q, const float* offset);
+static float get_collapse_cost(const simplifier* s, const uint32_t from, const uint32_t to);
+
+// Collapses edges until there are target_triangles or fewer, or every
+// collapse left would cost more than error_limit (in points' units
+// squared).
+static void simplify(simplifier* s, const uint32_t target_triangles, const float error_limit);
+// Returns how many collapses it made.
+static uint32_t run_pass(simplifier* s, const uint32_t target_triangles, const float error_limit);
+static void build_adjacency(simplifier* s);
+static void gather_collapses(simplifier* s, const float error_limit);
+static bool can_collapse(const simplifier* s, const uint32_t from, const uint32_t to);
+static bool is_border_edge(const simplifier* s, const uint32_t from, const uint32_t to);
+static bool flips_triangle(const simplifier* s, const uint32_t from, const uint32_t to);
+// Returns how many triangles it removed.
+static uint32_t apply_collapse(simplifier* s, const edge_collapse* collapse);
+static void remove_dead_triangles(simplifier* s);
+static float get_simplifier_error(const simplifier* s);
+
+static void build_lod_chain_job(const uint32_t begin, const uint32_t end, void* data);
+
+simplify_options::simplify_options() {
+	target_triangles = 0;
+	target_error = FLT_MAX;
+	uv_weight = 0.5f;
+	lock_borders = false;
+}
+
+lod_chain_options::lod_chain_options() {
+	max_lods = MAX_MESH_LODS;
+	triangle_ratio = 0.5f;
+	min_triangles = 64;
+	max_error = FLT_MAX;
+	uv_weight = 0.5f;
+	lock_borders = false;
+}
+
+lod_chain::lod_chain() {
+	memset(lods, 0, sizeof(lods));
+	lod_count = 0;
+	passes = 0;
+	build_seconds = 0.0;
+}
+
+uint32_t simplify_mesh(
+	const mesh_source* mesh,
+	const simplify_options* options,
+	uint32_t* destination,
+	float* error
+) {
+	simplifier s;
+	float error_limit;
+	uint32_t index_count;
+
+	initialize_simplifier(&s, mesh, options->uv_weight, options->lock_borders);
+
+	error_limit = (options->target_error / s.scale) * (options->target_error / s.scale);
+	simplify(&s, options->target_triangles, error_limit);
+
+	index_count = (uint32_t)s.indices.size();
+	if (index_count > 0) {
+		memcpy(destination, s.indices.data(), index_count * sizeof(uint32_t));
+	}
+
+	if (error) {
+		*error = get_simplifier_error(&s);
+	}
+
+	return index_count;
+}
+
+void build_lod_chain(
+	const mesh_source* mesh,
+	const lod_chain_options* options,
+	lod_chain* chain
+) {
+	simplifier s;
+	mesh_lod* lod;
+	double start;
+	float error_limit;
+	uint32_t max_lods;
+	uint32_t triangles;
+	uint32_t target;
+	uint32_t simplified;
+
+	start = now_seconds();
+
+	//
+	// The full mesh is the first level, as it is.
+	//
+
+	chain->indices.assign(mesh->indices, mesh->indices + mesh->index_count);
+	chain->lods[0].first_index = 0;
+	chain->lods[0].index_count = mesh->index_count;
+	chain->lods[0].error = 0.0f;
+	chain->lod_count = 1;
+	chain->passes = 0;
+
+	max_lods = min(options->max_lods, MAX_MESH_LODS);
+	if (max_lods <= 1) {
+		chain->build_seconds = now_seconds() - start;
+		return;
+	}
+
+	//
+	// Then keep simplifying the one mesh, taking a copy each time it
+	// gets small enough for the next level.
+	//
+
+	initialize_simplifier(&s, mesh, options->uv_weight, options->lock_borders);
+	error_limit = (options->max_error / s.scale) * (options->max_error / s.scale);
+	triangles = mesh->index_count / 3;
+
+	while (chain->lod_count < max_lods && triangles > options->min_triangles) {
+		target = max((uint32_t)(triangles * options->triangle_ratio), options->min_triangles);
+
+		simplify(&s, target, error_limit);
+		simplified = (uint32_t)s.indices.size() / 3;
+
+		// Not even halfway there: seams, borders or the error limit are
+		// in the way, and more levels won't do any better.
+		if ((uint64_t)simplified * 2 > (uint64_t)triangles + target) {
+			break;
+		}
+
+		lod = &(chain->lods[chain->lod_count]);
+		lod->first_index = (uint32_t)chain->indices.size();
+		lod->index_count = simplified * 3;
+		lod->error = get_simplifier_error(&s);
+
+		chain->indices.insert(chain->indices.end(), s.indices.begin(), s.indices.end());
+		chain->lod_count++;
+
+		triangles = simplified;
+	}
+
+	chain->passes = s.passes;
+	chain->build_seconds = now_seconds() - start;
+}
+
+void build_lod_chains(
+	job_system* jobs,
+	const mesh_source* meshes,
+	const uint32_t count,
+	const lod_chain_options* options,
+	lod_chain* chains
+) {
+	lod_chain_job job;
+
+	job.meshes = meshes;
+	job.options = options;
+	job.chains = chains;
+
+	// A mesh at a time, since some can be far bigger than others.
+	if (jobs && count > 1) {
+		parallel_for(jobs, count, 1, build_lod_chain_job, &job);
+	} else {
+		build_lod_chain_job(0, count, &job);
+	}
+}
+
+string get_lod_chain_report(
+	const lod_chain* chains,
+	const uint32_t count
+) {
+	const lod_chain* chain;
+	const mesh_lod* lod;
+	uint32_t previous;
+	uint32_t triangles;
+	string report;
+	char line[256];
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < count; i++) {
+		chain = &(chains[i]);
+
+		snprintf(
+			line,
+			sizeof(line),
+			"LOD chain %u: %u levels, %u passes, %.2fms\n",
+			i,
+			chain->lod_count,
+			chain->passes,
+			chain->build_seconds * 1000.0
+		);
+		report += line;
+
+		previous = 0;
+
+		for (j = 0; j < chain->lod_count; j++) {
+			lod = &(chain->lods[j]);
+			triangles = lod->index_count / 3;
+
+			snprintf(
+				line,
+				sizeof(line),
+				"  LOD %u: %9u triangles (%5.1f%% of the last), error %g\n",
+				j,
+				triangles,
+				previous > 0 ? 100.0 * triangles / previous : 100.0,
+				lod->error
+			);
+			report += line;
+
+			previous = triangles;
+		}
+	}
+
+	return report;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool compare_weld_keys(const weld_key& a, const weld_key& b) {
+	uint32_t i;
+
+	for (i = 0; i < 3; i++) {
+		if (a.position[i] != b.position[i]) {
+			return a.position[i] < b.position[i];
+		}
+	}
+
+	return a.vertex < b.vertex;
+}
+
+static bool compare_collapses(const edge_collapse& a, const edge_collapse& b) {
+	// Ties go by vertex, so the result doesn't depend on how the sort
+	// happened to shuffle them.
+	if (a.cost != b.cost) {
+		return a.cost < b.cost;
+	}
+
+	if (a.from != b.from) {
+		return a.from < b.from;
+	}
+
+	return a.to < b.to;
+}
+
+static uint64_t make_edge_key(const uint32_t a, const uint32_t b) {
+	return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+}
+
+static float dot(const float* a, const float* b) {
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void initialize_simplifier(
+	simplifier* s,
+	const mesh_source* mesh,
+	const float uv_weight,
+	const bool lock_borders
+) {
+	const mesh_vertex* vertex;
+	float low[3];
+	float high[3];
+	float* point;
+	const uint32_t* triangle;
+	uint32_t i;
+	uint32_t j;
+
+	s->vertex_count = mesh->vertex_count;
+	s->error = 0.0f;
+	s->passes = 0;
+
+	//
+	// Fit the mesh in a unit cube.
+	//
+
+	for (j = 0; j < 3; j++) {
+		low[j] = FLT_MAX;
+		high[j] = -FLT_MAX;
+	}
+
+	for (i = 0; i < mesh->vertex_count; i++) {
+		for (j = 0; j < 3; j++) {
+			low[j] = min(low[j], mesh->vertices[i].position[j]);
+			high[j] = max(high[j], mesh->vertices[i].position[j]);
+		}
+	}
+
+	s->scale = 0.0f;
+	for (j = 0; j < 3 && mesh->vertex_count > 0; j++) {
+		s->scale = max(s->scale, high[j] - low[j]);
+	}
+
+	if (s->scale <= 0.0f) {
+		s->scale = 1.0f;
+	}
+
+	s->points.resize((size_t)mesh->vertex_count * QUADRIC_SIZE);
+
+	for (i = 0; i < mesh->vertex_count; i++) {
+		vertex = &(mesh->vertices[i]);
+		point = &(s->points[(size_t)i * QUADRIC_SIZE]);
+
+		for (j = 0; j < 3; j++) {
+			point[j] = (vertex->position[j] - low[j]) / s->scale;
+		}
+
+		point[3] = vertex->uv[0] * uv_weight;
+		point[4] = vertex->uv[1] * uv_weight;
+	}
+
+	weld_vertices(s, mesh->vertices);
+
+	//
+	// Triangles with two corners in the same place have nothing to
+	// lose, so they're dropped now.
+	//
+
+	s->indices.clear();
+	s->indices.reserve(mesh->index_count);
+
+	for (i = 0; i + 2 < mesh->index_count; i += 3) {
+		triangle = &(mesh->indices[i]);
+
+		if (s->welded[triangle[0]] == s->welded[triangle[1]] ||
+			s->welded[triangle[1]] == s->welded[triangle[2]] ||
+			s->welded[triangle[2]] == s->welded[triangle[0]])
+		{
+			continue;
+		}
+
+		s->indices.push_back(triangle[0]);
+		s->indices.push_back(triangle[1]);
+		s->indices.push_back(triangle[2]);
+	}
+
+	s->quadrics.resize(mesh->vertex_count);
+	memset(s->quadrics.data(), 0, s->quadrics.size() * sizeof(quadric));
+
+	for (i = 0; i < s->indices.size(); i += 3) {
+		add_triangle_quadric(s, &(s->indices[i]));
+	}
+
+	classify_vertices(s, lock_borders);
+
+	s->touched.resize(mesh->vertex_count);
+}
+
+static void weld_vertices(simplifier* s, const mesh_vertex* vertices) {
+	vector<weld_key> keys;
+	uint32_t i;
+
+	keys.resize(s->vertex_count);
+
+	for (i = 0; i < s->vertex_count; i++) {
+		// Adding 0 turns -0 into 0, so the two weld.
+		keys[i].position[0] = vertices[i].position[0] + 0.0f;
+		keys[i].position[1] = vertices[i].position[1] + 0.0f;
+		keys[i].position[2] = vertices[i].position[2] + 0.0f;
+		keys[i].vertex = i;
+	}
+
+	sort(keys.begin(), keys.end(), compare_weld_keys);
+
+	s->welded.resize(s->vertex_count);
+
+	for (i = 0; i < s->vertex_count; i++) {
+		if (i > 0 && memcmp(keys[i].position, keys[i - 1].position, sizeof(keys[i].position)) == 0) {
+			s->welded[keys[i].vertex] = s->welded[keys[i - 1].vertex];
+		} else {
+			s->welded[keys[i].vertex] = keys[i].vertex;
+		}
+	}
+}
+
+static void classify_vertices(simplifier* s, const bool lock_borders) {
+	vector<uint32_t> copies;
+	vector<uint64_t> edges;
+	vector<uint64_t> border_edges;
+	vector<uint8_t> on_border;
+	vector<uint8_t> non_manifold;
+	const uint32_t* triangle;
+	uint32_t a;
+	uint32_t b;
+	size_t run;
+	size_t i;
+	uint32_t j;
+
+	//
+	// Count each position's copies. More than one means a seam.
+	//
+
+	copies.resize(s->vertex_count);
+
+	for (i = 0; i < s->vertex_count; i++) {
+		copies[s->welded[i]]++;
+	}
+
+	//
+	// Count the triangles on each edge, going by position so both sides
+	// of a seam are the same edge. One is an open edge; more than two
+	// is an edge the surface folds around, which no collapse can fix.
+	//
+
+	edges.reserve(s->indices.size());
+
+	for (i = 0; i < s->indices.size(); i += 3) {
+		for (j = 0; j < 3; j++) {
+			a = s->welded[s->indices[i + j]];
+			b = s->welded[s->indices[i + (j + 1) % 3]];
+			edges.push_back(make_edge_key(a, b));
+		}
+	}
+
+	sort(edges.begin(), edges.end());
+
+	on_border.resize(s->vertex_count);
+	non_manifold.resize(s->vertex_count);
+
+	for (i = 0; i < edges.size(); i += run) {
+		for (run = 1; i + run < edges.size() && edges[i + run] == edges[i]; run++) {
+		}
+
+		a = (uint32_t)(edges[i] >> 32);
+		b = (uint32_t)(edges[i] & 0xffffffff);
+
+		if (run == 1) {
+			border_edges.push_back(edges[i]);
+			on_border[a] = 1;
+			on_border[b] = 1;
+		} else if (run > 2) {
+			non_manifold[a] = 1;
+			non_manifold[b] = 1;
+		}
+	}
+
+	s->kinds.resize(s->vertex_count);
+
+	for (i = 0; i < s->vertex_count; i++) {
+		a = s->welded[i];
+
+		if (copies[a] > 1 || non_manifold[a]) {
+			s->kinds[i] = VERTEX_LOCKED;
+		} else if (on_border[a]) {
+			s->kinds[i] = lock_borders ? VERTEX_LOCKED : VERTEX_BORDER;
+		} else {
+			s->kinds[i] = VERTEX_INTERIOR;
+		}
+	}
+
+	//
+	// Hold border vertices to their edges.
+	//
+
+	if (lock_borders || border_edges.empty()) {
+		return;
+	}
+
+	for (i = 0; i < s->indices.size(); i += 3) {
+		triangle = &(s->indices[i]);
+
+		for (j = 0; j < 3; j++) {
+			a = s->welded[triangle[j]];
+			b = s->welded[triangle[(j + 1) % 3]];
+
+			if (binary_search(border_edges.begin(), border_edges.end(), make_edge_key(a, b))) {
+				add_border_quadric(s, triangle, j);
+			}
+		}
+	}
+}
+
+static void add_triangle_quadric(simplifier* s, const uint32_t* triangle) {
+	const float* p;
+	const float* q;
+	const float* r;
+	double e1[QUADRIC_SIZE];
+	double e2[QUADRIC_SIZE];
+	double cross[3];
+	double area;
+	double length;
+	double projection;
+	quadric result;
+	uint32_t term;
+	uint32_t i;
+	uint32_t j;
+
+	p = &(s->points[(size_t)triangle[0] * QUADRIC_SIZE]);
+	q = &(s->points[(size_t)triangle[1] * QUADRIC_SIZE]);
+	r = &(s->points[(size_t)triangle[2] * QUADRIC_SIZE]);
+
+	//
+	// The triangle's area, by its positions alone, weights it.
+	//
+
+	for (i = 0; i < 3; i++) {
+		e1[i] = q[i] - p[i];
+		e2[i] = r[i] - p[i];
+	}
+
+	cross[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	cross[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	cross[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	area = 0.5 * sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+	if (area <= 0.0) {
+		return;
+	}
+
+	//
+	// Two orthonormal vectors, e1 and e2, that span the triangle in all
+	// 5 dimensions. A point's squared distance from the triangle's
+	// plane is its squared distance from a corner, less the parts along
+	// e1 and e2, so A = I - e1 e1' - e2 e2'.
+	//
+
+	length = 0.0;
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		e1[i] = q[i] - p[i];
+		length += e1[i] * e1[i];
+	}
+
+	length = sqrt(length);
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		e1[i] /= length;
+	}
+
+	projection = 0.0;
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		e2[i] = r[i] - p[i];
+		projection += e2[i] * e1[i];
+	}
+
+	length = 0.0;
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		e2[i] -= projection * e1[i];
+		length += e2[i] * e2[i];
+	}
+
+	if (length <= 0.0) {
+		return;
+	}
+
+	length = sqrt(length);
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		e2[i] /= length;
+	}
+
+	// Every corner is on the triangle, so measured from any of them,
+	// b and c are 0.
+	memset(&result, 0, sizeof(result));
+
+	term = 0;
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		for (j = i; j < QUADRIC_SIZE; j++) {
+			result.a[term] = (float)(area * ((i == j ? 1.0 : 0.0) - e1[i] * e1[j] - e2[i] * e2[j]));
+			term++;
+		}
+	}
+
+	result.weight = (float)area;
+
+	for (i = 0; i < 3; i++) {
+		add_quadric(&(s->quadrics[triangle[i]]), &result);
+	}
+}
+
+static void add_border_quadric(simplifier* s, const uint32_t* triangle, const uint32_t edge) {
+	const float* p;
+	const float* q;
+	const float* r;
+	float direction[3];
+	float other[3];
+	float normal[3];
+	float plane[3];
+	float length;
+	float weight;
+	quadric result;
+	uint32_t term;
+	uint32_t i;
+	uint32_t j;
+
+	p = &(s->points[(size_t)triangle[edge] * QUADRIC_SIZE]);
+	q = &(s->points[(size_t)triangle[(edge + 1) % 3] * QUADRIC_SIZE]);
+	r = &(s->points[(size_t)triangle[(edge + 2) % 3] * QUADRIC_SIZE]);
+
+	//
+	// The plane through the edge that stands straight up from the
+	// triangle. It only involves position, so its UV terms are 0. Like
+	// the triangle's, the edge's ends are on it, so b and c are 0.
+	//
+
+	for (i = 0; i < 3; i++) {
+		direction[i] = q[i] - p[i];
+		other[i] = r[i] - p[i];
+	}
+
+	normal[0] = direction[1] * other[2] - direction[2] * other[1];
+	normal[1] = direction[2] * other[0] - direction[0] * other[2];
+	normal[2] = direction[0] * other[1] - direction[1] * other[0];
+
+	plane[0] = direction[1] * normal[2] - direction[2] * normal[1];
+	plane[1] = direction[2] * normal[0] - direction[0] * normal[2];
+	plane[2] = direction[0] * normal[1] - direction[1] * normal[0];
+
+	length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+	if (length <= 0.0f) {
+		return;
+	}
+
+	for (i = 0; i < 3; i++) {
+		plane[i] /= length;
+	}
+
+	weight = BORDER_WEIGHT * (direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+
+	memset(&result, 0, sizeof(result));
+
+	term = 0;
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		for (j = i; j < QUADRIC_SIZE; j++) {
+			if (i < 3 && j < 3) {
+				result.a[term] = weight * plane[i] * plane[j];
+			}
+			term++;
+		}
+
+	}
+
+	// Its weight stays 0: it's there to stop border vertices leaving
+	// their edge, not to make the error any smaller.
+	add_quadric(&(s->quadrics[triangle[edge]]), &result);
+	add_quadric(&(s->quadrics[triangle[(edge + 1) % 3]]), &result);
+}
+
+static void add_quadric(quadric* destination, const quadric* source) {
+	uint32_t i;
+
+	for (i = 0; i < QUADRIC_TERMS; i++) {
+		destination->a[i] += source->a[i];
+	}
+
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		destination->b[i] += source->b[i];
+	}
+
+	destination->c += source->c;
+	destination->weight += source->weight;
+}
+
+static void move_quadric(quadric* q, const float* offset) {
+	float moved[QUADRIC_SIZE];
+	float c;
+	uint32_t i;
+
+	//
+	// With y = z + offset, y'Ay + 2b'y + c is
+	//
+	//	z'Az + 2(A offset + b)'z + (offset'A offset + 2b'offset + c)
+	//
+	// offset is an edge long, so nothing here is much bigger than the
+	// answer.
+	//
+
+	moved[0] = q->a[0] * offset[0] + q->a[1] * offset[1] + q->a[2] * offset[2] + q->a[3] * offset[3] + q->a[4] * offset[4];
+	moved[1] = q->a[1] * offset[0] + q->a[5] * offset[1] + q->a[6] * offset[2] + q->a[7] * offset[3] + q->a[8] * offset[4];
+	moved[2] = q->a[2] * offset[0] + q->a[6] * offset[1] + q->a[9] * offset[2] + q->a[10] * offset[3] + q->a[11] * offset[4];
+	moved[3] = q->a[3] * offset[0] + q->a[7] * offset[1] + q->a[10] * offset[2] + q->a[12] * offset[3] + q->a[13] * offset[4];
+	moved[4] = q->a[4] * offset[0] + q->a[8] * offset[1] + q->a[11] * offset[2] + q->a[13] * offset[3] + q->a[14] * offset[4];
+
+	c = q->c;
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		c += (moved[i] + 2.0f * q->b[i]) * offset[i];
+		q->b[i] += moved[i];
+	}
+
+	q->c = c;
+}
+
+static float get_collapse_cost(const simplifier* s, const uint32_t from, const uint32_t to) {
+	quadric q;
+	float offset[QUADRIC_SIZE];
+	float error;
+	uint32_t i;
+
+	//
+	// Measured from to, to's own quadric is just its c. from's has to
+	// be moved there first.
+	//
+
+	q = s->quadrics[from];
+
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		offset[i] = s->points[(size_t)to * QUADRIC_SIZE + i] - s->points[(size_t)from * QUADRIC_SIZE + i];
+	}
+
+	move_quadric(&q, offset);
+
+	error = q.c + s->quadrics[to].c;
+	// Rounding can take a perfect fit a little below 0.
+	error = max(error, 0.0f);
+
+	q.weight += s->quadrics[to].weight;
+
+	return q.weight > 0.0f ? error / q.weight : error;
+}
+
+static void simplify(simplifier* s, const uint32_t target_triangles, const float error_limit) {
+	uint32_t collapsed;
+
+	while (s->indices.size() / 3 > target_triangles) {
+		collapsed = run_pass(s, target_triangles, error_limit);
+		s->passes++;
+
+		if (collapsed == 0) {
+			break;
+		}
+	}
+}
+
+static uint32_t run_pass(simplifier* s, const uint32_t target_triangles, const float error_limit) {
+	vector<edge_collapse>::iterator end;
+	edge_collapse* collapse;
+	uint32_t triangles;
+	uint32_t goal;
+	uint32_t collapsed;
+	float pass_limit;
+	size_t kept;
+	size_t i;
+
+	triangles = (uint32_t)(s->indices.size() / 3);
+
+	build_adjacency(s);
+	gather_collapses(s, error_limit);
+
+	if (s->collapses.empty()) {
+		return 0;
+	}
+
+	//
+	// A collapse usually takes two triangles with it, so that's about
+	// how many are needed. Only the cheapest of them, and those not
+	// much dearer, are sorted.
+	//
+
+	goal = max((triangles - target_triangles) / 2, 1u);
+	end = s->collapses.end();
+
+	if (s->collapses.size() > goal) {
+		nth_element(s->collapses.begin(), s->collapses.begin() + goal, s->collapses.end(), compare_collapses);
+		pass_limit = s->collapses[goal].cost * PASS_ERROR_SLACK;
+
+		kept = goal;
+		for (i = goal; i < s->collapses.size(); i++) {
+			if (s->collapses[i].cost <= pass_limit) {
+				swap(s->collapses[kept], s->collapses[i]);
+				kept++;
+			}
+		}
+
+		end = s->collapses.begin() + kept;
+	}
+
+	sort(s->collapses.begin(), end, compare_collapses);
+
+	//
+	// Take them in order, skipping any that touch a triangle already
+	// changed this pass: its cost and adjacency are out of date.
+	//
+
+	memset(s->touched.data(), 0, s->touched.size());
+	s->dead.assign(triangles, 0);
+
+	collapsed = 0;
+
+	for (i = 0; i < (size_t)(end - s->collapses.begin()) && triangles > target_triangles; i++) {
+		collapse = &(s->collapses[i]);
+
+		if (s->touched[collapse->from] || s->touched[collapse->to]) {
+			continue;
+		}
+
+		if (flips_triangle(s, collapse->from, collapse->to)) {
+			continue;
+		}
+
+		triangles -= apply_collapse(s, collapse);
+		collapsed++;
+	}
+
+	remove_dead_triangles(s);
+
+	return collapsed;
+}
+
+static void build_adjacency(simplifier* s) {
+	vector<uint32_t>* offsets;
+	uint32_t triangle_count;
+	uint32_t vertex;
+	uint32_t total;
+	uint32_t count;
+	uint32_t i;
+
+	offsets = &(s->adjacency_offsets);
+	offsets->assign(s->vertex_count + 1, 0);
+
+	for (i = 0; i < s->indices.size(); i++) {
+		(*offsets)[s->indices[i]]++;
+	}
+
+	total = 0;
+	for (i = 0; i <= s->vertex_count; i++) {
+		count = (*offsets)[i];
+		(*offsets)[i] = total;
+		total += count;
+	}
+
+	//
+	// Fill them in, using each vertex's offset as where its next one
+	// goes, then put the offsets back.
+	//
+
+	s->adjacency.resize(s->indices.size());
+	triangle_count = (uint32_t)(s->indices.size() / 3);
+
+	for (i = 0; i < triangle_count * 3; i++) {
+		vertex = s->indices[i];
+		s->adjacency[(*offsets)[vertex]] = i / 3;
+		(*offsets)[vertex]++;
+	}
+
+	for (i = s->vertex_count; i > 0; i--) {
+		(*offsets)[i] = (*offsets)[i - 1];
+	}
+	(*offsets)[0] = 0;
+}
+
+static void gather_collapses(simplifier* s, const float error_limit) {
+	edge_collapse collapse;
+	edge_collapse reverse;
+	bool forward_ok;
+	bool reverse_ok;
+	uint32_t a;
+	uint32_t b;
+	size_t i;
+	uint32_t j;
+
+	s->collapses.clear();
+
+	for (i = 0; i < s->indices.size(); i += 3) {
+		for (j = 0; j < 3; j++) {
+			a = s->indices[i + j];
+			b = s->indices[i + (j + 1) % 3];
+
+			//
+			// Edges inside the mesh show up once each way, so only take
+			// them one way. Open edges show up once, either way round.
+			//
+
+			if (a > b && (s->kinds[a] == VERTEX_INTERIOR || s->kinds[b] == VERTEX_INTERIOR)) {
+				continue;
+			}
+
+			forward_ok = can_collapse(s, a, b);
+			reverse_ok = can_collapse(s, b, a);
+
+			collapse.from = a;
+			collapse.to = b;
+			collapse.cost = forward_ok ? get_collapse_cost(s, a, b) : FLT_MAX;
+
+			reverse.from = b;
+			reverse.to = a;
+			reverse.cost = reverse_ok ? get_collapse_cost(s, b, a) : FLT_MAX;
+
+			if (reverse_ok && (!forward_ok || reverse.cost < collapse.cost)) {
+				collapse = reverse;
+			} else if (!forward_ok) {
+				continue;
+			}
+
+			if (collapse.cost <= error_limit) {
+				s->collapses.push_back(collapse);
+			}
+		}
+	}
+}
+
+static bool can_collapse(const simplifier* s, const uint32_t from, const uint32_t to) {
+	switch (s->kinds[from]) {
+	case VERTEX_INTERIOR:
+		return true;
+	case VERTEX_BORDER:
+		return s->kinds[to] != VERTEX_INTERIOR && is_border_edge(s, from, to);
+	default:
+		return false;
+	}
+}
+
+static bool is_border_edge(const simplifier* s, const uint32_t from, const uint32_t to) {
+	const uint32_t* triangle;
+	uint32_t welded_to;
+	uint32_t count;
+	uint32_t i;
+	uint32_t j;
+
+	//
+	// from is on a border but not a seam, so an edge to it is open if
+	// only one triangle has it. to might be on a seam, so go by
+	// position.
+	//
+
+	welded_to = s->welded[to];
+	count = 0;
+
+	for (i = s->adjacency_offsets[from]; i < s->adjacency_offsets[from + 1]; i++) {
+		triangle = &(s->indices[(size_t)s->adjacency[i] * 3]);
+
+		for (j = 0; j < 3; j++) {
+			if (s->welded[triangle[j]] == welded_to) {
+				count++;
+			}
+		}
+	}
+
+	return count == 1;
+}
+
+static bool flips_triangle(const simplifier* s, const uint32_t from, const uint32_t to) {
+	const uint32_t* triangle;
+	const float* corners[3];
+	const float* moved[3];
+	float before[3];
+	float after[3];
+	float e1[3];
+	float e2[3];
+	uint32_t welded_to;
+	uint32_t i;
+	uint32_t j;
+
+	welded_to = s->welded[to];
+
+	for (i = s->adjacency_offsets[from]; i < s->adjacency_offsets[from + 1]; i++) {
+		triangle = &(s->indices[(size_t)s->adjacency[i] * 3]);
+
+		// Triangles on the edge itself go away, so they can't flip.
+		if (s->welded[triangle[0]] == welded_to ||
+			s->welded[triangle[1]] == welded_to ||
+			s->welded[triangle[2]] == welded_to)
+		{
+			continue;
+		}
+
+		for (j = 0; j < 3; j++) {
+			corners[j] = &(s->points[(size_t)triangle[j] * QUADRIC_SIZE]);
+			moved[j] = triangle[j] == from ? &(s->points[(size_t)to * QUADRIC_SIZE]) : corners[j];
+		}
+
+		for (j = 0; j < 3; j++) {
+			e1[j] = corners[1][j] - corners[0][j];
+			e2[j] = corners[2][j] - corners[0][j];
+		}
+
+		before[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		before[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		before[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+		for (j = 0; j < 3; j++) {
+			e1[j] = moved[1][j] - moved[0][j];
+			e2[j] = moved[2][j] - moved[0][j];
+		}
+
+		after[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		after[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		after[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+		// Already flat, so it has no way up to lose.
+		if (dot(before, before) <= 0.0f) {
+			continue;
+		}
+
+		// Turned over, squashed flat, or turned far enough on its side
+		// to be nearly either.
+		if (dot(before, after) <= FLIP_LIMIT * sqrtf(dot(before, before) * dot(after, after))) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static uint32_t apply_collapse(simplifier* s, const edge_collapse* collapse) {
+	quadric moved;
+	float offset[QUADRIC_SIZE];
+	uint32_t* triangle;
+	uint32_t triangle_index;
+	uint32_t removed;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < QUADRIC_SIZE; i++) {
+		offset[i] = s->points[(size_t)collapse->to * QUADRIC_SIZE + i] - s->points[(size_t)collapse->from * QUADRIC_SIZE + i];
+	}
+
+	moved = s->quadrics[collapse->from];
+	move_quadric(&moved, offset);
+	add_quadric(&(s->quadrics[collapse->to]), &moved);
+
+	removed = 0;
+
+	for (i = s->adjacency_offsets[collapse->from]; i < s->adjacency_offsets[collapse->from + 1]; i++) {
+		triangle_index = s->adjacency[i];
+		triangle = &(s->indices[(size_t)triangle_index * 3]);
+
+		for (j = 0; j < 3; j++) {
+			if (triangle[j] == collapse->from) {
+				triangle[j] = collapse->to;
+			}
+
+			s->touched[triangle[j]] = 1;
+		}
+
+		if (s->welded[triangle[0]] == s->welded[triangle[1]] ||
+			s->welded[triangle[1]] == s->welded[triangle[2]] ||
+			s->welded[triangle[2]] == s->welded[triangle[0]])
+		{
+			s->dead[triangle_index] = 1;
+			removed++;
+		}
+	}
+
+	s->touched[collapse->from] = 1;
+	s->touched[collapse->to] = 1;
+	s->error = max(s->error, collapse->cost);
+
+	return removed;
+}
+
+static void remove_dead_triangles(simplifier* s) {
+	size_t triangle_count;
+	size_t kept;
+	size_t i;
+
+	triangle_count = s->indices.size() / 3;
+	kept = 0;
+
+	for (i = 0; i < triangle_count; i++) {
+		if (s->dead[i]) {
+			continue;
+		}
+
+		if (kept != i) {
+			memcpy(&(s->indices[kept * 3]), &(s->indices[i * 3]), 3 * sizeof(uint32_t));
+		}
+		kept++;
+	}
+
+	s->indices.resize(kept * 3);
+}
+
+static float get_simplifier_error(const simplifier* s) {
+	return sqrtf(s->error) * s->scale;
+}
+
+static void build_lod_chain_job(const uint32_t begin, const uint32_t end, void* data) {
+	lod_chain_job* job;
+	uint32_t i;
+
+	job = (lod_chain_job*)data;
+
+	for (i = begin; i < end; i++) {
+		build_lod_chain(&(job->meshes[i]), job->options, &(job->chains[i]));
+	}
+}
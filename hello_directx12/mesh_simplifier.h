@@ -0,0 +1,160 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Builds levels of detail for a mesh by simplifying it: collapsing
+// edges, one vertex into its neighbour, until it has few enough
+// triangles or the next collapse would change it too much.
+//
+// Which collapses go first is decided by quadric error metrics
+// (Garland and Heckbert). Every vertex carries a quadric, a small
+// matrix that measures the squared distance from a point to the planes
+// of the triangles around it. Collapsing u into v adds u's quadric to
+// v's, and the cost of doing so is that quadric measured at v. The
+// quadrics live in 5 dimensions, position and UV, so a collapse that
+// would smear the texture costs as much as one that moves the surface
+// (the "generalized" quadrics from their follow-up paper). uv_weight
+// says how much.
+//
+// Vertices only ever collapse into other vertices, never to a new
+// position, so a simplified mesh is just a new index buffer into the
+// same vertices. That's what lets every level of a chain share one
+// vertex buffer.
+//
+// Some vertices can't move:
+//
+// * Vertices on a UV seam: the same position is in the vertex buffer
+//   more than once, with different UVs, and moving one copy would tear
+//   the seam open. (The cube is all seams, so it can't simplify at
+//   all.)
+// * Vertices on an open edge of the mesh, if lock_borders is set.
+//   Otherwise they can slide along that edge, but not off it.
+// * Vertices on an edge shared by more than two triangles.
+//
+// Each pass works out the cost of every edge, sorts them, and takes
+// the cheapest, skipping any collapse that would touch a triangle
+// another collapse in the same pass has already changed, or that would
+// flip a triangle over. That repeats until the mesh is small enough.
+//
+// A chain is built with one run of the simplifier, taking a copy of
+// the indices each time it gets down to the next level's triangle
+// count, so each level's error includes all the collapses before it.
+// The levels' indices are packed one after another, and each level is
+// a range of them. Chains for many meshes can be built at once on the
+// job system, a mesh per job.
+//
+// Like the render queue, none of this depends on DirectX.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct job_system;
+
+// The most levels a chain has, including the full mesh.
+const uint32_t MAX_MESH_LODS = 8;
+
+// Same layout as the application's vertex.
+struct mesh_vertex {
+	float position[3];
+	float uv[2];
+};
+
+struct mesh_source {
+	const mesh_vertex* vertices;
+	uint32_t vertex_count;
+	// Triangles.
+	const uint32_t* indices;
+	uint32_t index_count;
+};
+
+struct simplify_options {
+	simplify_options();
+
+	// Stop once the mesh has this many triangles or fewer...
+	uint32_t target_triangles;
+	// ...or before any collapse that would move the surface further
+	// than this, in the mesh's own units.
+	float target_error;
+	// How far a UV difference of 1 counts as, as a fraction of the
+	// mesh's size. 0 ignores UVs.
+	float uv_weight;
+	// Keep the vertices on the mesh's open edges where they are.
+	bool lock_borders;
+};
+
+struct lod_chain_options {
+	lod_chain_options();
+
+	// Levels to build, including the full mesh. At most MAX_MESH_LODS.
+	uint32_t max_lods;
+	// Each level aims for this fraction of the triangles in the one
+	// before it. The chain stops early if a level can't get at least
+	// halfway there.
+	float triangle_ratio;
+	// No level goes below this many triangles.
+	uint32_t min_triangles;
+	// Or has more error than this, in the mesh's own units.
+	float max_error;
+	float uv_weight;
+	bool lock_borders;
+};
+
+// A level's range of the chain's indices.
+struct mesh_lod {
+	uint32_t first_index;
+	uint32_t index_count;
+	// How far the level's surface is from the full mesh's, roughly, in
+	// the mesh's own units. 0 for the full mesh.
+	float error;
+};
+
+struct lod_chain {
+	lod_chain();
+
+	// Every level's triangles, the full mesh first. They index the
+	// mesh's own vertices.
+	std::vector<uint32_t> indices;
+	mesh_lod lods[MAX_MESH_LODS];
+	uint32_t lod_count;
+
+	// How many passes building it took, and how long.
+	uint32_t passes;
+	double build_seconds;
+};
+
+// Simplifies a mesh into destination, which needs room for index_count
+// indices, and returns how many it wrote. error (if not NULL) is set to
+// the result's error, in the mesh's own units.
+uint32_t simplify_mesh(
+	const mesh_source* mesh,
+	const simplify_options* options,
+	uint32_t* destination,
+	float* error
+);
+
+void build_lod_chain(
+	const mesh_source* mesh,
+	const lod_chain_options* options,
+	lod_chain* chain
+);
+
+// Builds a chain for each mesh, spread across the job system. jobs can
+// be NULL to build them one after another on this thread. Either way
+// the chains come out the same.
+void build_lod_chains(
+	job_system* jobs,
+	const mesh_source* meshes,
+	const uint32_t count,
+	const lod_chain_options* options,
+	lod_chain* chains
+);
+
+// Each chain's levels: triangles, error, and how much of the one
+// before it they kept.
+std::string get_lod_chain_report(
+	const lod_chain* chains,
+	const uint32_t count
+);
@@ -0,0 +1,984 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "occlusion_culler.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define OCCLUSION_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Chunks have at least this many triangles, so small scenes aren't cut
+// into pieces that cost more to hand out than to do.
+const uint32_t MIN_CHUNK_TRIANGLES = 1024;
+// Anything this close to the camera's plane, or behind it, counts as
+// crossing the near plane.
+const float OCCLUSION_MIN_W = 1e-6f;
+// Deep enough for any buffer: each level down adds at most 3 texels.
+const uint32_t HIZ_STACK_SIZE = 128;
+
+enum triangle_setup {
+	SETUP_OK,
+	SETUP_BACK_FACING,
+	SETUP_NEAR_CLIPPED,
+	SETUP_OFF_SCREEN
+};
+
+struct render_occluders_job {
+	occlusion_buffer* buffer;
+	const occluder_mesh* occluders;
+	// The first triangle of each occluder, counting across all of them,
+	// then the total.
+	const uint32_t* first_triangles;
+	uint32_t occluder_count;
+	uint32_t triangle_count;
+};
+
+struct test_occlusion_job {
+	const occlusion_buffer* buffer;
+	const float* box_mins;
+	const float* box_maxes;
+	const float* world_view_projections;
+	uint8_t* visible;
+};
+
+struct hiz_texel {
+	uint32_t level;
+	uint32_t x;
+	uint32_t y;
+};
+
+static double now_seconds();
+static void transform_point(const float* point, const float* matrix, float* result);
+static triangle_setup setup_triangle(
+	const occlusion_buffer* buffer,
+	const occluder_mesh* occluder,
+	const uint32_t triangle,
+	occlusion_triangle* result
+);
+static void bin_chunk(const render_occluders_job* job, const uint32_t chunk);
+static void rasterize_bin(occlusion_buffer* buffer, const uint32_t bin);
+static void rasterize_triangle(
+	occlusion_buffer* buffer,
+	const occlusion_triangle* triangle,
+	const int32_t min_x,
+	const int32_t min_y,
+	const int32_t max_x,
+	const int32_t max_y
+);
+static float* get_tile(occlusion_buffer* buffer, const uint32_t tile_x, const uint32_t tile_y);
+static void build_hiz(occlusion_buffer* buffer);
+
+static void bin_chunks_job(const uint32_t begin, const uint32_t end, void* data);
+static void rasterize_bins_job(const uint32_t begin, const uint32_t end, void* data);
+static void test_occlusion_range(const uint32_t begin, const uint32_t end, void* data);
+
+occlusion_buffer::occlusion_buffer() {
+	width = 0;
+	height = 0;
+	tiles_x = 0;
+	tiles_y = 0;
+	bins_x = 0;
+	bins_y = 0;
+	cull_back_faces = true;
+	chunk_count = 0;
+	memset(&stats, 0, sizeof(stats));
+}
+
+void initialize_occlusion_buffer(occlusion_buffer* buffer, const uint32_t width, const uint32_t height) {
+	uint32_t level_width;
+	uint32_t level_height;
+	uint32_t offset;
+	uint32_t i;
+
+	buffer->tiles_x = max((width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE, 1u);
+	buffer->tiles_y = max((height + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE, 1u);
+	buffer->width = buffer->tiles_x * OCCLUSION_TILE_SIZE;
+	buffer->height = buffer->tiles_y * OCCLUSION_TILE_SIZE;
+	buffer->bins_x = (buffer->tiles_x + OCCLUSION_BIN_TILES - 1) / OCCLUSION_BIN_TILES;
+	buffer->bins_y = (buffer->tiles_y + OCCLUSION_BIN_TILES - 1) / OCCLUSION_BIN_TILES;
+
+	buffer->depth.assign((size_t)buffer->width * buffer->height, 1.0f);
+
+	//
+	// Halve each level, rounding up, until it's one texel.
+	//
+
+	buffer->hiz_offsets.clear();
+	buffer->hiz_widths.clear();
+	buffer->hiz_heights.clear();
+
+	level_width = buffer->tiles_x;
+	level_height = buffer->tiles_y;
+	offset = 0;
+
+	while (true) {
+		buffer->hiz_offsets.push_back(offset);
+		buffer->hiz_widths.push_back(level_width);
+		buffer->hiz_heights.push_back(level_height);
+		offset += level_width * level_height;
+
+		if (level_width == 1 && level_height == 1) {
+			break;
+		}
+
+		level_width = (level_width + 1) / 2;
+		level_height = (level_height + 1) / 2;
+	}
+
+	buffer->hiz.assign(offset, 1.0f);
+
+	for (i = 0; i < MAX_OCCLUSION_CHUNKS; i++) {
+		buffer->chunks[i].triangles.clear();
+		buffer->chunks[i].bins.assign((size_t)buffer->bins_x * buffer->bins_y, vector<uint32_t>());
+	}
+
+	buffer->chunk_count = 0;
+}
+
+void render_occluders(
+	job_system* jobs,
+	occlusion_buffer* buffer,
+	const occluder_mesh* occluders,
+	const uint32_t occluder_count
+) {
+	render_occluders_job job;
+	vector<uint32_t> first_triangles;
+	occlusion_chunk* chunk;
+	uint32_t triangle_count;
+	uint32_t bin_count;
+	double start;
+	uint32_t i;
+	uint32_t j;
+
+	memset(&(buffer->stats), 0, sizeof(buffer->stats));
+
+	//
+	// Number the triangles across every occluder, so they can be cut
+	// into evenly sized chunks whatever meshes they came from.
+	//
+
+	first_triangles.resize(occluder_count + 1);
+	triangle_count = 0;
+
+	for (i = 0; i < occluder_count; i++) {
+		first_triangles[i] = triangle_count;
+		triangle_count += occluders[i].index_count / 3;
+	}
+
+	first_triangles[occluder_count] = triangle_count;
+
+	buffer->chunk_count = (triangle_count + MIN_CHUNK_TRIANGLES - 1) / MIN_CHUNK_TRIANGLES;
+	buffer->chunk_count = min(max(buffer->chunk_count, 1u), MAX_OCCLUSION_CHUNKS);
+
+	job.buffer = buffer;
+	job.occluders = occluders;
+	job.first_triangles = first_triangles.data();
+	job.occluder_count = occluder_count;
+	job.triangle_count = triangle_count;
+
+	//
+	// Bin...
+	//
+
+	start = now_seconds();
+
+	if (jobs) {
+		parallel_for(jobs, buffer->chunk_count, 1, bin_chunks_job, &job);
+	} else {
+		bin_chunks_job(0, buffer->chunk_count, &job);
+	}
+
+	buffer->stats.bin_seconds = now_seconds() - start;
+
+	//
+	// ...rasterize, which also clears each bin's tiles first and fills
+	// in their texels of the first Z level...
+	//
+
+	start = now_seconds();
+	bin_count = buffer->bins_x * buffer->bins_y;
+
+	if (jobs) {
+		parallel_for(jobs, bin_count, 1, rasterize_bins_job, buffer);
+	} else {
+		rasterize_bins_job(0, bin_count, buffer);
+	}
+
+	buffer->stats.rasterize_seconds = now_seconds() - start;
+
+	//
+	// ...and build the rest of the levels, which are small.
+	//
+
+	start = now_seconds();
+	build_hiz(buffer);
+	buffer->stats.hiz_seconds = now_seconds() - start;
+
+	buffer->stats.triangles = triangle_count;
+
+	for (i = 0; i < buffer->chunk_count; i++) {
+		chunk = &(buffer->chunks[i]);
+
+		buffer->stats.back_facing += chunk->back_facing;
+		buffer->stats.near_clipped += chunk->near_clipped;
+		buffer->stats.off_screen += chunk->off_screen;
+		buffer->stats.rasterized += (uint32_t)chunk->triangles.size();
+
+		for (j = 0; j < bin_count; j++) {
+			buffer->stats.binned += (uint32_t)chunk->bins[j].size();
+		}
+	}
+}
+
+bool is_box_visible(
+	const occlusion_buffer* buffer,
+	const float box_min[3],
+	const float box_max[3],
+	const float world_view_projection[16]
+) {
+	float corner[3];
+	float clip[4];
+	float min_x;
+	float min_y;
+	float max_x;
+	float max_y;
+	float nearest;
+	float x;
+	float y;
+	float inverse_w;
+	int32_t pixel_min_x;
+	int32_t pixel_min_y;
+	int32_t pixel_max_x;
+	int32_t pixel_max_y;
+	hiz_texel stack[HIZ_STACK_SIZE];
+	hiz_texel texel;
+	uint32_t stack_size;
+	uint32_t tile_min_x;
+	uint32_t tile_min_y;
+	uint32_t tile_max_x;
+	uint32_t tile_max_y;
+	uint32_t level;
+	uint32_t level_count;
+	uint32_t from_x;
+	uint32_t from_y;
+	uint32_t to_x;
+	uint32_t to_y;
+	uint32_t tx;
+	uint32_t ty;
+	const float* depth;
+	uint32_t i;
+
+	//
+	// Project the corners, and find the rectangle they cover on screen
+	// and how near the nearest one is.
+	//
+
+	min_x = FLT_MAX;
+	min_y = FLT_MAX;
+	max_x = -FLT_MAX;
+	max_y = -FLT_MAX;
+	nearest = FLT_MAX;
+
+	for (i = 0; i < 8; i++) {
+		corner[0] = (i & 1) ? box_max[0] : box_min[0];
+		corner[1] = (i & 2) ? box_max[1] : box_min[1];
+		corner[2] = (i & 4) ? box_max[2] : box_min[2];
+
+		transform_point(corner, world_view_projection, clip);
+
+		// Crossing the near plane, so it's right in front of us.
+		if (clip[3] <= OCCLUSION_MIN_W || clip[2] < 0.0f) {
+			return true;
+		}
+
+		inverse_w = 1.0f / clip[3];
+		x = (clip[0] * inverse_w * 0.5f + 0.5f) * (float)buffer->width;
+		y = (0.5f - clip[1] * inverse_w * 0.5f) * (float)buffer->height;
+
+		min_x = min(min_x, x);
+		min_y = min(min_y, y);
+		max_x = max(max_x, x);
+		max_y = max(max_y, y);
+		nearest = min(nearest, clip[2] * inverse_w);
+	}
+
+	// Off the screen altogether. That's for frustum culling to decide,
+	// not us.
+	if (max_x < 0.0f || max_y < 0.0f || min_x >= (float)buffer->width || min_y >= (float)buffer->height) {
+		return true;
+	}
+
+	//
+	// Every pixel the rectangle touches at all.
+	//
+
+	pixel_min_x = (int32_t)max(min_x, 0.0f);
+	pixel_min_y = (int32_t)max(min_y, 0.0f);
+	pixel_max_x = (int32_t)min(max_x, (float)(buffer->width - 1));
+	pixel_max_y = (int32_t)min(max_y, (float)(buffer->height - 1));
+
+	tile_min_x = (uint32_t)pixel_min_x / OCCLUSION_TILE_SIZE;
+	tile_min_y = (uint32_t)pixel_min_y / OCCLUSION_TILE_SIZE;
+	tile_max_x = (uint32_t)pixel_max_x / OCCLUSION_TILE_SIZE;
+	tile_max_y = (uint32_t)pixel_max_y / OCCLUSION_TILE_SIZE;
+
+	//
+	// Start at the level where the box covers at most 2 x 2 texels.
+	//
+
+	level_count = (uint32_t)buffer->hiz_offsets.size();
+	level = 0;
+
+	while (level + 1 < level_count &&
+		((tile_max_x >> level) - (tile_min_x >> level) > 1 || (tile_max_y >> level) - (tile_min_y >> level) > 1))
+	{
+		level++;
+	}
+
+	stack_size = 0;
+
+	for (ty = tile_min_y >> level; ty <= tile_max_y >> level; ty++) {
+		for (tx = tile_min_x >> level; tx <= tile_max_x >> level; tx++) {
+			stack[stack_size].level = level;
+			stack[stack_size].x = tx;
+			stack[stack_size].y = ty;
+			stack_size++;
+		}
+	}
+
+	while (stack_size > 0) {
+		stack_size--;
+		texel = stack[stack_size];
+
+		// Everything under it is nearer than the box.
+		if (buffer->hiz[buffer->hiz_offsets[texel.level] + texel.y * buffer->hiz_widths[texel.level] + texel.x] < nearest) {
+			continue;
+		}
+
+		if (texel.level > 0) {
+			//
+			// Look at the texels under it that the box covers.
+			//
+
+			level = texel.level - 1;
+
+			from_x = max(texel.x * 2, tile_min_x >> level);
+			from_y = max(texel.y * 2, tile_min_y >> level);
+			to_x = min(min(texel.x * 2 + 1, tile_max_x >> level), buffer->hiz_widths[level] - 1);
+			to_y = min(min(texel.y * 2 + 1, tile_max_y >> level), buffer->hiz_heights[level] - 1);
+
+			for (ty = from_y; ty <= to_y; ty++) {
+				for (tx = from_x; tx <= to_x; tx++) {
+					stack[stack_size].level = level;
+					stack[stack_size].x = tx;
+					stack[stack_size].y = ty;
+					stack_size++;
+				}
+			}
+
+			continue;
+		}
+
+		//
+		// A tile with something at or behind the box. Look at the
+		// pixels themselves.
+		//
+
+		depth = &(buffer->depth[(size_t)(texel.y * buffer->tiles_x + texel.x) * OCCLUSION_TILE_PIXELS]);
+
+		from_x = max(texel.x * OCCLUSION_TILE_SIZE, (uint32_t)pixel_min_x);
+		from_y = max(texel.y * OCCLUSION_TILE_SIZE, (uint32_t)pixel_min_y);
+		to_x = min(texel.x * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1, (uint32_t)pixel_max_x);
+		to_y = min(texel.y * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1, (uint32_t)pixel_max_y);
+
+		for (ty = from_y; ty <= to_y; ty++) {
+			for (tx = from_x; tx <= to_x; tx++) {
+				if (depth[(ty % OCCLUSION_TILE_SIZE) * OCCLUSION_TILE_SIZE + tx % OCCLUSION_TILE_SIZE] >= nearest) {
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+void test_occlusion(
+	job_system* jobs,
+	const occlusion_buffer* buffer,
+	const float* box_mins,
+	const float* box_maxes,
+	const float* world_view_projections,
+	const uint32_t count,
+	uint8_t* visible
+) {
+	test_occlusion_job job;
+
+	job.buffer = buffer;
+	job.box_mins = box_mins;
+	job.box_maxes = box_maxes;
+	job.world_view_projections = world_view_projections;
+	job.visible = visible;
+
+	if (jobs) {
+		parallel_for(jobs, count, 256, test_occlusion_range, &job);
+	} else {
+		test_occlusion_range(0, count, &job);
+	}
+}
+
+float get_occlusion_depth(const occlusion_buffer* buffer, const uint32_t x, const uint32_t y) {
+	size_t tile;
+
+	tile = (size_t)(y / OCCLUSION_TILE_SIZE) * buffer->tiles_x + x / OCCLUSION_TILE_SIZE;
+
+	return buffer->depth[tile * OCCLUSION_TILE_PIXELS + (y % OCCLUSION_TILE_SIZE) * OCCLUSION_TILE_SIZE + x % OCCLUSION_TILE_SIZE];
+}
+
+string get_occlusion_report(const occlusion_buffer* buffer) {
+	const occlusion_stats* stats;
+	char line[256];
+	string report;
+
+	stats = &(buffer->stats);
+
+	snprintf(
+		line,
+		sizeof(line),
+		"Occlusion buffer: %u x %u, %u x %u bins, %u chunks\n",
+		buffer->width,
+		buffer->height,
+		buffer->bins_x,
+		buffer->bins_y,
+		buffer->chunk_count
+	);
+	report += line;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"  %u triangles: %u rasterized (%u in bins), %u back facing, %u crossing the near plane, %u off screen\n",
+		stats->triangles,
+		stats->rasterized,
+		stats->binned,
+		stats->back_facing,
+		stats->near_clipped,
+		stats->off_screen
+	);
+	report += line;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"  binning %.3fms, rasterizing %.3fms, hierarchical Z %.3fms\n",
+		stats->bin_seconds * 1000.0,
+		stats->rasterize_seconds * 1000.0,
+		stats->hiz_seconds * 1000.0
+	);
+	report += line;
+
+	return report;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void transform_point(const float* point, const float* matrix, float* result) {
+	uint32_t i;
+
+	for (i = 0; i < 4; i++) {
+		result[i] = point[0] * matrix[i] + point[1] * matrix[4 + i] + point[2] * matrix[8 + i] + matrix[12 + i];
+	}
+}
+
+static triangle_setup setup_triangle(
+	const occlusion_buffer* buffer,
+	const occluder_mesh* occluder,
+	const uint32_t triangle,
+	occlusion_triangle* result
+) {
+	float clip[4];
+	float screen[3][3];
+	float inverse_w;
+	float area;
+	float swap;
+	float d1[3];
+	float d2[3];
+	float min_x;
+	float min_y;
+	float max_x;
+	float max_y;
+	const float* p;
+	const float* q;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < 3; i++) {
+		transform_point(&(occluder->positions[(size_t)occluder->indices[(size_t)triangle * 3 + i] * 3]), occluder->world_view_projection, clip);
+
+		if (clip[3] <= OCCLUSION_MIN_W || clip[2] < 0.0f) {
+			return SETUP_NEAR_CLIPPED;
+		}
+
+		inverse_w = 1.0f / clip[3];
+		screen[i][0] = (clip[0] * inverse_w * 0.5f + 0.5f) * (float)buffer->width;
+		screen[i][1] = (0.5f - clip[1] * inverse_w * 0.5f) * (float)buffer->height;
+		screen[i][2] = clip[2] * inverse_w;
+	}
+
+	//
+	// Clockwise on screen is positive, with y going down. Back faces
+	// are either skipped or turned around.
+	//
+
+	area =
+		(screen[1][0] - screen[0][0]) * (screen[2][1] - screen[0][1]) -
+		(screen[1][1] - screen[0][1]) * (screen[2][0] - screen[0][0]);
+
+	if (area == 0.0f || (area < 0.0f && buffer->cull_back_faces)) {
+		return SETUP_BACK_FACING;
+	}
+
+	if (area < 0.0f) {
+		for (j = 0; j < 3; j++) {
+			swap = screen[1][j];
+			screen[1][j] = screen[2][j];
+			screen[2][j] = swap;
+		}
+
+		area = -area;
+	}
+
+	//
+	// The pixels whose centres could be inside it. The corners are
+	// clamped first, since they can be a long way off screen.
+	//
+
+	min_x = min(screen[0][0], min(screen[1][0], screen[2][0]));
+	min_y = min(screen[0][1], min(screen[1][1], screen[2][1]));
+	max_x = max(screen[0][0], max(screen[1][0], screen[2][0]));
+	max_y = max(screen[0][1], max(screen[1][1], screen[2][1]));
+
+	min_x = min(max(min_x, -1.0f), (float)buffer->width + 1.0f);
+	min_y = min(max(min_y, -1.0f), (float)buffer->height + 1.0f);
+	max_x = min(max(max_x, -1.0f), (float)buffer->width + 1.0f);
+	max_y = min(max(max_y, -1.0f), (float)buffer->height + 1.0f);
+
+	result->min_x = max((int32_t)ceilf(min_x - 0.5f), 0);
+	result->min_y = max((int32_t)ceilf(min_y - 0.5f), 0);
+	result->max_x = min((int32_t)floorf(max_x - 0.5f), (int32_t)buffer->width - 1);
+	result->max_y = min((int32_t)floorf(max_y - 0.5f), (int32_t)buffer->height - 1);
+
+	if (result->min_x > result->max_x || result->min_y > result->max_y) {
+		return SETUP_OFF_SCREEN;
+	}
+
+	//
+	// For the edge from p to q, A x + B y + C is the cross product of
+	// q - p and (x, y) - p, which is positive on the inside.
+	//
+
+	for (i = 0; i < 3; i++) {
+		p = screen[i];
+		q = screen[(i + 1) % 3];
+
+		result->edges[i][0] = p[1] - q[1];
+		result->edges[i][1] = q[0] - p[0];
+		result->edges[i][2] = (q[1] - p[1]) * p[0] - (q[0] - p[0]) * p[1];
+	}
+
+	//
+	// Depth is linear across the screen, so it's a plane through the
+	// three corners.
+	//
+
+	for (j = 0; j < 3; j++) {
+		d1[j] = screen[1][j] - screen[0][j];
+		d2[j] = screen[2][j] - screen[0][j];
+	}
+
+	result->depth[0] = (d1[2] * d2[1] - d2[2] * d1[1]) / area;
+	result->depth[1] = (d2[2] * d1[0] - d1[2] * d2[0]) / area;
+	result->depth[2] = screen[0][2] - result->depth[0] * screen[0][0] - result->depth[1] * screen[0][1];
+
+	return SETUP_OK;
+}
+
+static void bin_chunk(const render_occluders_job* job, const uint32_t chunk_index) {
+	occlusion_buffer* buffer;
+	occlusion_chunk* chunk;
+	occlusion_triangle triangle;
+	triangle_setup setup;
+	uint32_t first;
+	uint32_t last;
+	uint32_t occluder;
+	uint32_t bin_min_x;
+	uint32_t bin_min_y;
+	uint32_t bin_max_x;
+	uint32_t bin_max_y;
+	uint32_t bin_pixels;
+	uint32_t index;
+	uint32_t bx;
+	uint32_t by;
+	uint32_t i;
+
+	buffer = job->buffer;
+	chunk = &(buffer->chunks[chunk_index]);
+
+	chunk->triangles.clear();
+	for (i = 0; i < chunk->bins.size(); i++) {
+		chunk->bins[i].clear();
+	}
+
+	chunk->back_facing = 0;
+	chunk->near_clipped = 0;
+	chunk->off_screen = 0;
+
+	first = (uint32_t)((uint64_t)job->triangle_count * chunk_index / buffer->chunk_count);
+	last = (uint32_t)((uint64_t)job->triangle_count * (chunk_index + 1) / buffer->chunk_count);
+
+	if (first >= last) {
+		return;
+	}
+
+	// The occluder the chunk's first triangle is in.
+	occluder = (uint32_t)(upper_bound(job->first_triangles, job->first_triangles + job->occluder_count, first) - job->first_triangles) - 1;
+
+	bin_pixels = OCCLUSION_BIN_TILES * OCCLUSION_TILE_SIZE;
+
+	for (i = first; i < last; i++) {
+		while (i >= job->first_triangles[occluder + 1]) {
+			occluder++;
+		}
+
+		setup = setup_triangle(buffer, &(job->occluders[occluder]), i - job->first_triangles[occluder], &triangle);
+
+		if (setup == SETUP_BACK_FACING) {
+			chunk->back_facing++;
+			continue;
+		}
+
+		if (setup == SETUP_NEAR_CLIPPED) {
+			chunk->near_clipped++;
+			continue;
+		}
+
+		if (setup == SETUP_OFF_SCREEN) {
+			chunk->off_screen++;
+			continue;
+		}
+
+		index = (uint32_t)chunk->triangles.size();
+		chunk->triangles.push_back(triangle);
+
+		bin_min_x = (uint32_t)triangle.min_x / bin_pixels;
+		bin_min_y = (uint32_t)triangle.min_y / bin_pixels;
+		bin_max_x = (uint32_t)triangle.max_x / bin_pixels;
+		bin_max_y = (uint32_t)triangle.max_y / bin_pixels;
+
+		for (by = bin_min_y; by <= bin_max_y; by++) {
+			for (bx = bin_min_x; bx <= bin_max_x; bx++) {
+				chunk->bins[by * buffer->bins_x + bx].push_back(index);
+			}
+		}
+	}
+}
+
+static void rasterize_bin(occlusion_buffer* buffer, const uint32_t bin) {
+	const occlusion_chunk* chunk;
+	const occlusion_triangle* triangle;
+	const vector<uint32_t>* list;
+	const float* tile;
+	float farthest;
+	int32_t min_x;
+	int32_t min_y;
+	int32_t max_x;
+	int32_t max_y;
+	uint32_t tile_min_x;
+	uint32_t tile_min_y;
+	uint32_t tile_max_x;
+	uint32_t tile_max_y;
+	uint32_t tx;
+	uint32_t ty;
+	uint32_t c;
+	uint32_t i;
+
+	tile_min_x = (bin % buffer->bins_x) * OCCLUSION_BIN_TILES;
+	tile_min_y = (bin / buffer->bins_x) * OCCLUSION_BIN_TILES;
+	tile_max_x = min(tile_min_x + OCCLUSION_BIN_TILES, buffer->tiles_x) - 1;
+	tile_max_y = min(tile_min_y + OCCLUSION_BIN_TILES, buffer->tiles_y) - 1;
+
+	min_x = (int32_t)(tile_min_x * OCCLUSION_TILE_SIZE);
+	min_y = (int32_t)(tile_min_y * OCCLUSION_TILE_SIZE);
+	max_x = (int32_t)((tile_max_x + 1) * OCCLUSION_TILE_SIZE) - 1;
+	max_y = (int32_t)((tile_max_y + 1) * OCCLUSION_TILE_SIZE) - 1;
+
+	for (ty = tile_min_y; ty <= tile_max_y; ty++) {
+		for (tx = tile_min_x; tx <= tile_max_x; tx++) {
+			fill_n(get_tile(buffer, tx, ty), OCCLUSION_TILE_PIXELS, 1.0f);
+		}
+	}
+
+	for (c = 0; c < buffer->chunk_count; c++) {
+		chunk = &(buffer->chunks[c]);
+		list = &(chunk->bins[bin]);
+
+		for (i = 0; i < list->size(); i++) {
+			triangle = &(chunk->triangles[(*list)[i]]);
+
+			rasterize_triangle(
+				buffer,
+				triangle,
+				max(triangle->min_x, min_x),
+				max(triangle->min_y, min_y),
+				min(triangle->max_x, max_x),
+				min(triangle->max_y, max_y)
+			);
+		}
+	}
+
+	//
+	// The bin's texels of the first Z level.
+	//
+
+	for (ty = tile_min_y; ty <= tile_max_y; ty++) {
+		for (tx = tile_min_x; tx <= tile_max_x; tx++) {
+			tile = get_tile(buffer, tx, ty);
+			farthest = tile[0];
+
+			for (i = 1; i < OCCLUSION_TILE_PIXELS; i++) {
+				farthest = max(farthest, tile[i]);
+			}
+
+			buffer->hiz[ty * buffer->tiles_x + tx] = farthest;
+		}
+	}
+}
+
+static void rasterize_triangle(
+	occlusion_buffer* buffer,
+	const occlusion_triangle* triangle,
+	const int32_t min_x,
+	const int32_t min_y,
+	const int32_t max_x,
+	const int32_t max_y
+) {
+	float* tile;
+	float* row;
+	uint32_t tile_min_x;
+	uint32_t tile_min_y;
+	uint32_t tile_max_x;
+	uint32_t tile_max_y;
+	uint32_t tx;
+	uint32_t ty;
+	int32_t from_y;
+	int32_t to_y;
+	int32_t from_x;
+	int32_t to_x;
+	int32_t x;
+	int32_t y;
+#if defined(OCCLUSION_USE_SSE)
+	__m128 edge_a[3];
+	__m128 edge_b[3];
+	__m128 edge_c[3];
+	__m128 depth_a;
+	__m128 depth_b;
+	__m128 depth_c;
+	__m128 offsets;
+	__m128 first_column;
+	__m128 last_column;
+	__m128 zero;
+	__m128 px;
+	__m128 py;
+	__m128 inside;
+	__m128 depth;
+	__m128 old;
+	uint32_t e;
+#else
+	float px;
+	float py;
+	float depth;
+#endif
+
+	if (min_x > max_x || min_y > max_y) {
+		return;
+	}
+
+	tile_min_x = (uint32_t)min_x / OCCLUSION_TILE_SIZE;
+	tile_min_y = (uint32_t)min_y / OCCLUSION_TILE_SIZE;
+	tile_max_x = (uint32_t)max_x / OCCLUSION_TILE_SIZE;
+	tile_max_y = (uint32_t)max_y / OCCLUSION_TILE_SIZE;
+
+#if defined(OCCLUSION_USE_SSE)
+	for (e = 0; e < 3; e++) {
+		edge_a[e] = _mm_set1_ps(triangle->edges[e][0]);
+		edge_b[e] = _mm_set1_ps(triangle->edges[e][1]);
+		edge_c[e] = _mm_set1_ps(triangle->edges[e][2]);
+	}
+
+	depth_a = _mm_set1_ps(triangle->depth[0]);
+	depth_b = _mm_set1_ps(triangle->depth[1]);
+	depth_c = _mm_set1_ps(triangle->depth[2]);
+	offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	zero = _mm_setzero_ps();
+#endif
+
+	for (ty = tile_min_y; ty <= tile_max_y; ty++) {
+		for (tx = tile_min_x; tx <= tile_max_x; tx++) {
+			tile = get_tile(buffer, tx, ty);
+
+			from_y = max(min_y, (int32_t)(ty * OCCLUSION_TILE_SIZE));
+			to_y = min(max_y, (int32_t)(ty * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1));
+			from_x = max(min_x, (int32_t)(tx * OCCLUSION_TILE_SIZE));
+			to_x = min(max_x, (int32_t)(tx * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1));
+
+#if defined(OCCLUSION_USE_SSE)
+			// Whole groups of four, leaving out the pixels in them that
+			// are past the bounds, exactly as the pixel at a time loop
+			// would.
+			first_column = _mm_set1_ps((float)from_x + 0.5f);
+			last_column = _mm_set1_ps((float)to_x + 0.5f);
+			from_x &= ~3;
+#endif
+
+			for (y = from_y; y <= to_y; y++) {
+				row = tile + (y % OCCLUSION_TILE_SIZE) * OCCLUSION_TILE_SIZE;
+
+#if defined(OCCLUSION_USE_SSE)
+				py = _mm_set1_ps((float)y + 0.5f);
+
+				for (x = from_x; x <= to_x; x += 4) {
+					px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+
+					inside = _mm_and_ps(_mm_cmpge_ps(px, first_column), _mm_cmple_ps(px, last_column));
+
+					for (e = 0; e < 3; e++) {
+						inside = _mm_and_ps(
+							inside,
+							_mm_cmpge_ps(
+								_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge_a[e], px), _mm_mul_ps(edge_b[e], py)), edge_c[e]),
+								zero
+							)
+						);
+					}
+
+					depth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(depth_a, px), _mm_mul_ps(depth_b, py)), depth_c);
+
+					old = _mm_loadu_ps(row + x % OCCLUSION_TILE_SIZE);
+					depth = _mm_or_ps(
+						_mm_and_ps(inside, _mm_min_ps(old, depth)),
+						_mm_andnot_ps(inside, old)
+					);
+					_mm_storeu_ps(row + x % OCCLUSION_TILE_SIZE, depth);
+				}
+#else
+				py = (float)y + 0.5f;
+
+				for (x = from_x; x <= to_x; x++) {
+					px = (float)x + 0.5f;
+
+					if (triangle->edges[0][0] * px + triangle->edges[0][1] * py + triangle->edges[0][2] >= 0.0f &&
+						triangle->edges[1][0] * px + triangle->edges[1][1] * py + triangle->edges[1][2] >= 0.0f &&
+						triangle->edges[2][0] * px + triangle->edges[2][1] * py + triangle->edges[2][2] >= 0.0f)
+					{
+						depth = triangle->depth[0] * px + triangle->depth[1] * py + triangle->depth[2];
+						row[x % OCCLUSION_TILE_SIZE] = min(row[x % OCCLUSION_TILE_SIZE], depth);
+					}
+				}
+#endif
+			}
+		}
+	}
+}
+
+static float* get_tile(occlusion_buffer* buffer, const uint32_t tile_x, const uint32_t tile_y) {
+	return &(buffer->depth[(size_t)(tile_y * buffer->tiles_x + tile_x) * OCCLUSION_TILE_PIXELS]);
+}
+
+static void build_hiz(occlusion_buffer* buffer) {
+	const float* below;
+	float* level;
+	uint32_t below_width;
+	uint32_t below_height;
+	uint32_t x;
+	uint32_t y;
+	uint32_t l;
+	float farthest;
+
+	for (l = 1; l < buffer->hiz_offsets.size(); l++) {
+		below = &(buffer->hiz[buffer->hiz_offsets[l - 1]]);
+		below_width = buffer->hiz_widths[l - 1];
+		below_height = buffer->hiz_heights[l - 1];
+		level = &(buffer->hiz[buffer->hiz_offsets[l]]);
+
+		for (y = 0; y < buffer->hiz_heights[l]; y++) {
+			for (x = 0; x < buffer->hiz_widths[l]; x++) {
+				// Odd sizes have texels with only one or two under them.
+				farthest = below[(y * 2) * below_width + x * 2];
+
+				if (x * 2 + 1 < below_width) {
+					farthest = max(farthest, below[(y * 2) * below_width + x * 2 + 1]);
+				}
+
+				if (y * 2 + 1 < below_height) {
+					farthest = max(farthest, below[(y * 2 + 1) * below_width + x * 2]);
+
+					if (x * 2 + 1 < below_width) {
+						farthest = max(farthest, below[(y * 2 + 1) * below_width + x * 2 + 1]);
+					}
+				}
+
+				level[y * buffer->hiz_widths[l] + x] = farthest;
+			}
+		}
+	}
+}
+
+static void bin_chunks_job(const uint32_t begin, const uint32_t end, void* data) {
+	const render_occluders_job* job;
+	uint32_t i;
+
+	job = (const render_occluders_job*)data;
+
+	for (i = begin; i < end; i++) {
+		bin_chunk(job, i);
+	}
+}
+
+static void rasterize_bins_job(const uint32_t begin, const uint32_t end, void* data) {
+	occlusion_buffer* buffer;
+	uint32_t i;
+
+	buffer = (occlusion_buffer*)data;
+
+	for (i = begin; i < end; i++) {
+		rasterize_bin(buffer, i);
+	}
+}
+
+static void test_occlusion_range(const uint32_t begin, const uint32_t end, void* data) {
+	const test_occlusion_job* job;
+	uint32_t i;
+
+	job = (const test_occlusion_job*)data;
+
+	for (i = begin; i < end; i++) {
+		job->visible[i] = is_box_visible(
+			job->buffer,
+			&(job->box_mins[(size_t)i * 3]),
+			&(job->box_maxes[(size_t)i * 3]),
+			&(job->world_view_projections[(size_t)i * 16])
+		) ? 1 : 0;
+	}
+}
@@ -0,0 +1,187 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Culls objects that are hidden behind others, on the CPU, before
+// they're ever sent to the GPU. In the style of Intel's Masked
+// Occlusion Culling, though simpler.
+//
+// A few big, simple meshes are picked as occluders (walls, floors,
+// hills) and rasterized into a small depth buffer, a few hundred pixels
+// across, with the frame's matrices. Then each object's bounding box
+// is projected onto the same buffer, and if every pixel it covers
+// already has something nearer in it, the object can't be seen.
+//
+// Getting that wrong one way just draws something that didn't need
+// drawing, but the other way makes things vanish, so everything errs
+// towards visible:
+//
+// * Occluder triangles that cross the near plane are dropped, rather
+//   than clipped. That only ever makes the occluders smaller.
+// * A box that crosses the near plane is always visible.
+// * A box covers every pixel its rectangle touches at all, while an
+//   occluder only covers the pixels whose centres it covers.
+// * An occluder has to be strictly nearer than the nearest corner of
+//   the box.
+//
+// The depth buffer is split into 8 x 8 pixel tiles, stored one after
+// another, so a tile is one 256 byte block. Rasterizing goes a row of
+// four pixels at a time with SSE (or one at a time without it, with the
+// same results). Each pixel keeps the nearest depth any occluder has
+// there, which doesn't depend on the order the triangles are drawn in,
+// so it doesn't matter which thread draws what.
+//
+// Drawing happens in two steps, both spread across the job system:
+//
+// 1. Binning. The occluders' triangles are split into chunks. Each
+//    chunk's triangles are transformed, culled and set up for
+//    rasterizing, and put in a list for every bin (a square of 4 x 4
+//    tiles) they touch. Every chunk has its own lists, so chunks never
+//    wait on each other.
+// 2. Rasterizing. Each bin draws every chunk's triangles for it into its
+//    own tiles, so bins never touch the same pixels.
+//
+// Then each tile's farthest depth goes into a hierarchical Z buffer:
+// level 0 has a texel per tile, and each level after that has a texel
+// for every 2 x 2 of the one before. Testing a box starts at the level
+// where it covers only a few texels. Any texel whose farthest depth is
+// nearer than the box is entirely hidden, and the rest are looked at
+// more closely, down to single pixels if need be.
+//
+// Like the render queue, none of this depends on DirectX.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct job_system;
+
+const uint32_t OCCLUSION_TILE_SIZE = 8;
+const uint32_t OCCLUSION_TILE_PIXELS = OCCLUSION_TILE_SIZE * OCCLUSION_TILE_SIZE;
+// Tiles across a bin, and down it.
+const uint32_t OCCLUSION_BIN_TILES = 4;
+// How many pieces binning is split into, at most.
+const uint32_t MAX_OCCLUSION_CHUNKS = 64;
+
+struct occluder_mesh {
+	// x, y, z for each vertex.
+	const float* positions;
+	uint32_t vertex_count;
+	// Triangles. Front faces are clockwise on screen, like D3D12's
+	// default rasterizer state.
+	const uint32_t* indices;
+	uint32_t index_count;
+	// World * view * projection, row by row, for row vectors (the
+	// DirectXMath way).
+	float world_view_projection[16];
+};
+
+// An occluder triangle, ready to rasterize.
+struct occlusion_triangle {
+	// Each edge's A, B and C: a pixel centre (x, y) is inside when
+	// A x + B y + C >= 0 for all three.
+	float edges[3][3];
+	// Depth at (x, y) is depth[0] x + depth[1] y + depth[2].
+	float depth[3];
+	// The pixels it could touch, inclusive.
+	int32_t min_x;
+	int32_t min_y;
+	int32_t max_x;
+	int32_t max_y;
+};
+
+struct occlusion_chunk {
+	std::vector<occlusion_triangle> triangles;
+	// For each bin, the triangles (in triangles) that touch it.
+	std::vector<std::vector<uint32_t>> bins;
+
+	uint32_t back_facing;
+	uint32_t near_clipped;
+	uint32_t off_screen;
+};
+
+struct occlusion_stats {
+	uint32_t triangles;
+	uint32_t back_facing;
+	uint32_t near_clipped;
+	uint32_t off_screen;
+	uint32_t rasterized;
+	// Triangles in bins, counting once per bin.
+	uint32_t binned;
+	double bin_seconds;
+	double rasterize_seconds;
+	double hiz_seconds;
+};
+
+struct occlusion_buffer {
+	occlusion_buffer();
+
+	// In pixels. Both are multiples of OCCLUSION_TILE_SIZE.
+	uint32_t width;
+	uint32_t height;
+	uint32_t tiles_x;
+	uint32_t tiles_y;
+	uint32_t bins_x;
+	uint32_t bins_y;
+	// Whether to skip triangles facing away from the camera. Closed
+	// meshes don't need them, but single sided walls do.
+	bool cull_back_faces;
+
+	// Tile by tile, each tile's pixels row by row. 0 is the near plane,
+	// 1 the far one.
+	std::vector<float> depth;
+
+	// Every level of the hierarchical Z buffer, the finest (one texel a
+	// tile) first, each texel the farthest depth under it.
+	std::vector<float> hiz;
+	std::vector<uint32_t> hiz_offsets;
+	std::vector<uint32_t> hiz_widths;
+	std::vector<uint32_t> hiz_heights;
+
+	occlusion_chunk chunks[MAX_OCCLUSION_CHUNKS];
+	uint32_t chunk_count;
+
+	// What the last render_occluders did.
+	occlusion_stats stats;
+};
+
+// width and height are rounded up to whole tiles.
+void initialize_occlusion_buffer(occlusion_buffer* buffer, const uint32_t width, const uint32_t height);
+
+// Draws the occluders into the depth buffer, which starts out empty
+// (all 1), and builds the hierarchical Z buffer from it. jobs can be
+// NULL to do it all on this thread, with the same results.
+void render_occluders(
+	job_system* jobs,
+	occlusion_buffer* buffer,
+	const occluder_mesh* occluders,
+	const uint32_t occluder_count
+);
+
+// Whether any of a box, in its own space, could be seen past the
+// occluders. world_view_projection is like an occluder's.
+bool is_box_visible(
+	const occlusion_buffer* buffer,
+	const float box_min[3],
+	const float box_max[3],
+	const float world_view_projection[16]
+);
+
+// Tests count boxes, a box and matrix each, spread across the job
+// system. visible[i] is 1 for the ones that could be seen.
+void test_occlusion(
+	job_system* jobs,
+	const occlusion_buffer* buffer,
+	const float* box_mins,
+	const float* box_maxes,
+	const float* world_view_projections,
+	const uint32_t count,
+	uint8_t* visible
+);
+
+// The depth of pixel (x, y), x to the right and y down.
+float get_occlusion_depth(const occlusion_buffer* buffer, const uint32_t x, const uint32_t y);
+
+std::string get_occlusion_report(const occlusion_buffer* buffer);
@@ -0,0 +1,432 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+// Hands the thread's track back when the thread exits.
+struct thread_track_owner {
+	thread_track_owner();
+	~thread_track_owner();
+
+	profile_track* track;
+};
+
+thread_local profile_track* current_profile_track = NULL;
+static thread_local thread_track_owner current_thread_owner;
+
+static void calibrate_profile_clock(profiler* prof);
+static void update_zone_stats(profile_zone_stats* stats, const double frame_ms, const uint32_t calls);
+static void write_json_string(ofstream& out, const char* str);
+
+profile_track::profile_track() {
+	id = 0;
+	write_count = 0;
+	read_count = 0;
+}
+
+thread_track_owner::thread_track_owner() {
+	track = NULL;
+}
+
+thread_track_owner::~thread_track_owner() {
+	profiler* prof;
+
+	if (!track) {
+		return;
+	}
+
+	prof = get_profiler();
+
+	lock_guard<mutex> lock(prof->tracks_lock);
+	prof->free_tracks.push_back(track);
+}
+
+profiler::profiler() {
+	uint64_t start_ns;
+
+	enabled = true;
+	frame = 0;
+	dropped_events = 0;
+	capture_frames_left = 0;
+
+	//
+	// Get a rough tick rate to start with. It only has to be good
+	// until the first collection, which measures it over a longer
+	// time.
+	//
+
+	calibration_ticks = profile_now();
+	calibration_ns = profile_now_ns();
+
+	start_ns = calibration_ns;
+	while (profile_now_ns() - start_ns < 1000000) {
+	}
+
+	ns_per_tick = 1.0;
+	calibrate_profile_clock(this);
+}
+
+double profile_ticks_to_ns(const profiler* prof, const uint64_t ticks) {
+	return ((double)ticks - (double)prof->calibration_ticks) * prof->ns_per_tick;
+}
+
+profile_track* create_profile_track(profiler* prof, const char* name) {
+	lock_guard<mutex> lock(prof->tracks_lock);
+	profile_track* track;
+	char default_name[32];
+
+	prof->tracks.push_back(unique_ptr<profile_track>(new profile_track));
+
+	track = prof->tracks.back().get();
+	track->id = (uint32_t)(prof->tracks.size() - 1);
+
+	if (name) {
+		track->name = name;
+	} else {
+		snprintf(default_name, sizeof(default_name), "Thread %u", track->id);
+		track->name = default_name;
+	}
+
+	return track;
+}
+
+profile_track* make_thread_profile_track() {
+	profiler* prof;
+	char name[32];
+
+	prof = get_profiler();
+
+	//
+	// Reuse the track of a thread that has exited if we can, so
+	// programs that start lots of short lived threads don't keep
+	// adding tracks.
+	//
+
+	{
+		lock_guard<mutex> lock(prof->tracks_lock);
+
+		if (!prof->free_tracks.empty()) {
+			current_profile_track = prof->free_tracks.back();
+			prof->free_tracks.pop_back();
+
+			snprintf(name, sizeof(name), "Thread %u", current_profile_track->id);
+			current_profile_track->name = name;
+		}
+	}
+
+	if (!current_profile_track) {
+		current_profile_track = create_profile_track(prof, NULL);
+	}
+
+	current_thread_owner.track = current_profile_track;
+
+	return current_profile_track;
+}
+
+void set_profile_thread_name(const char* name) {
+	profile_track* track;
+
+	track = get_thread_profile_track();
+
+	lock_guard<mutex> lock(get_profiler()->tracks_lock);
+	track->name = name;
+}
+
+bool collect_profile_frame(profiler* prof) {
+	map<profile_zone_key, profile_zone_stats>::iterator zone;
+	profile_zone_key key;
+	vector<profile_track*>* tracks;
+	profile_track* track;
+	profile_event event;
+	profile_zone_stats* stats;
+	profile_capture_event capture_event;
+	uint64_t write_count;
+	uint64_t index;
+	bool capture_finished;
+	size_t i;
+
+	tracks = &(prof->collect_tracks);
+	tracks->clear();
+
+	{
+		lock_guard<mutex> lock(prof->tracks_lock);
+
+		for (i = 0; i < prof->tracks.size(); i++) {
+			tracks->push_back(prof->tracks[i].get());
+		}
+	}
+
+	calibrate_profile_clock(prof);
+
+	//
+	// Drain every track. A writer may have lapped us if it recorded
+	// more than a ring's worth since last frame, in which case the
+	// oldest events are gone.
+	//
+
+	for (i = 0; i < tracks->size(); i++) {
+		track = (*tracks)[i];
+		write_count = track->write_count.load(memory_order_acquire);
+
+		if (write_count - track->read_count > PROFILE_RING_SIZE) {
+			prof->dropped_events += write_count - track->read_count - PROFILE_RING_SIZE;
+			track->read_count = write_count - PROFILE_RING_SIZE;
+		}
+
+		for (index = track->read_count; index < write_count; index++) {
+			event = track->events[index & (PROFILE_RING_SIZE - 1)];
+
+			//
+			// If the writer got all the way around to this slot while
+			// we were copying it, the copy could be half old, half new.
+			//
+
+			if (track->write_count.load(memory_order_acquire) - index > PROFILE_RING_SIZE) {
+				prof->dropped_events++;
+				continue;
+			}
+
+			//
+			// Zones are only added the first time they're seen, so
+			// after the first few frames this doesn't allocate.
+			//
+
+			key = make_pair(track->id, event.name);
+			zone = prof->zones.find(key);
+
+			if (zone == prof->zones.end()) {
+				stats = &(prof->zones[key]);
+				*stats = {};
+				stats->name = event.name;
+				stats->track = track->id;
+			} else {
+				stats = &(zone->second);
+			}
+
+			stats->collected_ms +=
+				(double)(event.end_ticks - event.start_ticks) * prof->ns_per_tick / 1000000.0;
+			stats->collected_calls++;
+
+			if (prof->capture_frames_left > 0) {
+				capture_event.event = event;
+				capture_event.track = track->id;
+				prof->capture.push_back(capture_event);
+			}
+		}
+
+		track->read_count = write_count;
+	}
+
+	//
+	// Zones that didn't run this frame count as zero, so a zone that
+	// only runs now and then doesn't look like it runs every frame.
+	//
+
+	for (zone = prof->zones.begin(); zone != prof->zones.end(); zone++) {
+		stats = &(zone->second);
+
+		update_zone_stats(stats, stats->collected_ms, stats->collected_calls);
+		stats->collected_ms = 0.0;
+		stats->collected_calls = 0;
+	}
+
+	prof->frame++;
+
+	capture_finished = false;
+	if (prof->capture_frames_left > 0) {
+		prof->capture_frames_left--;
+		capture_finished = prof->capture_frames_left == 0;
+	}
+
+	return capture_finished;
+}
+
+void start_profile_capture(profiler* prof, const uint32_t frame_count) {
+	prof->capture.clear();
+	prof->capture_frames_left = frame_count;
+}
+
+bool write_chrome_trace(profiler* prof, const string& path) {
+	ofstream out;
+	vector<pair<uint32_t, string>> track_names;
+	uint64_t base_ticks;
+	size_t i;
+
+	out.open(path, ios::out | ios::trunc);
+	if (!out.is_open()) {
+		return false;
+	}
+
+	{
+		lock_guard<mutex> lock(prof->tracks_lock);
+
+		for (i = 0; i < prof->tracks.size(); i++) {
+			track_names.push_back(make_pair(prof->tracks[i]->id, prof->tracks[i]->name));
+		}
+	}
+
+	// Timestamps are relative to the first event, to keep them short.
+	base_ticks = UINT64_MAX;
+	for (i = 0; i < prof->capture.size(); i++) {
+		base_ticks = min(base_ticks, prof->capture[i].event.start_ticks);
+	}
+
+	//
+	// Every zone is a complete ("X") event, in microseconds. Each
+	// track gets a thread name metadata event so the viewer labels it.
+	//
+
+	out << "{\"traceEvents\":[\n";
+
+	for (i = 0; i < track_names.size(); i++) {
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+			<< track_names[i].first << ",\"args\":{\"name\":";
+		write_json_string(out, track_names[i].second.c_str());
+		out << "}},\n";
+	}
+
+	for (i = 0; i < prof->capture.size(); i++) {
+		const profile_event& event = prof->capture[i].event;
+		char times[64];
+
+		snprintf(
+			times,
+			sizeof(times),
+			"\"ts\":%.3f,\"dur\":%.3f",
+			(double)(event.start_ticks - base_ticks) * prof->ns_per_tick / 1000.0,
+			(double)(event.end_ticks - event.start_ticks) * prof->ns_per_tick / 1000.0
+		);
+
+		out << "{\"name\":";
+		write_json_string(out, event.name);
+		out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << prof->capture[i].track
+			<< "," << times << "}";
+		out << (i + 1 < prof->capture.size() ? ",\n" : "\n");
+	}
+
+	out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+	return out.good();
+}
+
+string get_profile_report(profiler* prof) {
+	vector<const profile_zone_stats*> zones;
+	char line[256];
+	string report;
+	size_t i;
+
+	for (auto& zone : prof->zones) {
+		zones.push_back(&(zone.second));
+	}
+
+	// Group by track, then slowest first.
+	sort(zones.begin(), zones.end(), [](const profile_zone_stats* a, const profile_zone_stats* b) {
+		if (a->track != b->track) {
+			return a->track < b->track;
+		}
+
+		return a->average_ms > b->average_ms;
+	});
+
+	snprintf(
+		line,
+		sizeof(line),
+		"Profile over the last %u frames (%llu events dropped):\n",
+		PROFILE_STATS_WINDOW,
+		(unsigned long long)prof->dropped_events
+	);
+
+	report = line;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"  %-6s %-28s %8s %8s %8s %8s %6s\n",
+		"track", "zone", "last", "avg", "min", "max", "calls"
+	);
+
+	report += line;
+
+	for (i = 0; i < zones.size(); i++) {
+		snprintf(
+			line,
+			sizeof(line),
+			"  %-6u %-28s %8.3f %8.3f %8.3f %8.3f %6u\n",
+			zones[i]->track,
+			zones[i]->name,
+			zones[i]->last_ms,
+			zones[i]->average_ms,
+			zones[i]->min_ms,
+			zones[i]->max_ms,
+			zones[i]->calls_last_frame
+		);
+
+		report += line;
+	}
+
+	return report;
+}
+
+static void calibrate_profile_clock(profiler* prof) {
+	uint64_t ticks;
+	uint64_t ns;
+
+	//
+	// The longer the time since calibration_ticks, the better the
+	// rate, so this only gets more accurate as the program runs.
+	//
+
+	ticks = profile_now();
+	ns = profile_now_ns();
+
+	if (ticks > prof->calibration_ticks && ns > prof->calibration_ns) {
+		prof->ns_per_tick =
+			(double)(ns - prof->calibration_ns) / (double)(ticks - prof->calibration_ticks);
+	}
+}
+
+static void update_zone_stats(profile_zone_stats* stats, const double frame_ms, const uint32_t calls) {
+	uint32_t count;
+	uint32_t i;
+	double total;
+
+	stats->frame_ms[stats->frame_count % PROFILE_STATS_WINDOW] = frame_ms;
+	stats->frame_count++;
+	stats->calls_last_frame = calls;
+	stats->last_ms = frame_ms;
+
+	count = min(stats->frame_count, PROFILE_STATS_WINDOW);
+
+	total = 0.0;
+	stats->min_ms = stats->frame_ms[0];
+	stats->max_ms = stats->frame_ms[0];
+
+	for (i = 0; i < count; i++) {
+		total += stats->frame_ms[i];
+		stats->min_ms = min(stats->min_ms, stats->frame_ms[i]);
+		stats->max_ms = max(stats->max_ms, stats->frame_ms[i]);
+	}
+
+	stats->average_ms = total / (double)count;
+}
+
+static void write_json_string(ofstream& out, const char* str) {
+	out << '"';
+
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\') {
+			out << '\\' << *str;
+		} else if ((unsigned char)*str < 0x20) {
+			out << ' ';
+		} else {
+			out << *str;
+		}
+	}
+
+	out << '"';
+}
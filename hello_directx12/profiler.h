@@ -0,0 +1,238 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A frame profiler. Code marks out zones with PROFILE_ZONE("name"),
+// which records when the zone started and ended into a ring buffer
+// owned by the calling thread. Only that thread ever writes to its
+// ring, so recording a zone is two clock reads and a few stores, with
+// no locks. Once a frame, collect_profile_frame drains every thread's
+// ring and updates rolling statistics for each zone.
+//
+// GPU timings (see gpu_profiler) are fed in the same way, through a
+// track of their own, so they show up next to the CPU zones.
+//
+// While a capture is running, every event is also kept, and can be
+// written out as a Chrome trace (chrome://tracing, or ui.perfetto.dev).
+//
+// Zone names must be string literals (or otherwise live forever),
+// since we keep the pointer and use it to tell zones apart.
+//
+// Events are timestamped in ticks, which on x86 are read straight from
+// the CPU's time stamp counter. That's several times cheaper than
+// going through the OS clock, and those two reads are most of what a
+// zone costs; everything on the way to them is inlined here. Ticks
+// are converted to nanoseconds when they're collected, using a rate
+// measured against the OS clock as we go.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PROFILE_USE_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Per thread. Must be a power of two.
+const uint32_t PROFILE_RING_SIZE = 1 << 14;
+// How many frames the rolling statistics cover.
+const uint32_t PROFILE_STATS_WINDOW = 120;
+
+struct profile_event {
+	const char* name;
+	uint64_t start_ticks;
+	uint64_t end_ticks;
+};
+
+// One per thread that records zones, plus one per GPU queue.
+struct profile_track {
+	profile_track();
+
+	uint32_t id;
+	std::string name;
+
+	// Only the owning thread writes events, and only the collector
+	// reads them. write_count never wraps in practice, so the ring
+	// position is write_count % PROFILE_RING_SIZE.
+	std::atomic<uint64_t> write_count;
+	uint64_t read_count;
+	profile_event events[PROFILE_RING_SIZE];
+};
+
+struct profile_zone_stats {
+	const char* name;
+	uint32_t track;
+	// Summed over every call in a frame.
+	double frame_ms[PROFILE_STATS_WINDOW];
+	uint32_t frame_count;
+	uint32_t calls_last_frame;
+	double last_ms;
+	double average_ms;
+	double min_ms;
+	double max_ms;
+	// What's been collected for the frame being collected now.
+	double collected_ms;
+	uint32_t collected_calls;
+};
+
+// Zones are told apart by track and name, so a CPU zone and the GPU
+// work it records can share a name.
+typedef std::pair<uint32_t, const char*> profile_zone_key;
+
+struct profile_capture_event {
+	profile_event event;
+	uint32_t track;
+};
+
+struct profiler {
+	profiler();
+
+	std::atomic<bool> enabled;
+
+	// Tracks are created on the fly, so this is locked. Tracks are
+	// never destroyed, so pointers to them stay good.
+	std::mutex tracks_lock;
+	std::vector<std::unique_ptr<profile_track>> tracks;
+
+	// Tracks whose threads have exited, ready for new threads.
+	std::vector<profile_track*> free_tracks;
+
+	// How ticks line up with the OS clock. Measured once up front and
+	// refined every collection.
+	uint64_t calibration_ticks;
+	uint64_t calibration_ns;
+	double ns_per_tick;
+
+	// Only touched by whoever calls collect_profile_frame.
+	std::map<profile_zone_key, profile_zone_stats> zones;
+	// Kept between collections so collecting doesn't allocate.
+	std::vector<profile_track*> collect_tracks;
+	uint64_t frame;
+	// Events lost because a ring filled up between collections.
+	uint64_t dropped_events;
+
+	uint32_t capture_frames_left;
+	std::vector<profile_capture_event> capture;
+};
+
+// There's one profiler for the whole program. This is inline so that
+// a zone doesn't have to call into profiler.cpp to find it.
+inline profiler* get_profiler() {
+	static profiler instance;
+
+	return &instance;
+}
+
+// Nanoseconds on the OS's steady clock.
+inline uint64_t profile_now_ns() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+// The clock events are recorded with. Every timestamp (including GPU
+// ones) is converted to this.
+inline uint64_t profile_now() {
+#if defined(PROFILE_USE_TSC)
+	return __rdtsc();
+#else
+	return profile_now_ns();
+#endif
+}
+
+// Converts ticks to nanoseconds, relative to the start of the program.
+double profile_ticks_to_ns(const profiler* prof, const uint64_t ticks);
+
+// Makes a new track. Events can be added to it by any one thread.
+profile_track* create_profile_track(profiler* prof, const char* name);
+
+// The calling thread's track, or NULL until it's first needed.
+extern thread_local profile_track* current_profile_track;
+
+// Gives the calling thread a track. Use get_thread_profile_track.
+profile_track* make_thread_profile_track();
+
+// The calling thread's track, made the first time it's needed. It goes
+// back to the profiler when the thread exits, for the next new thread.
+// Once it's made, this is just a thread local read.
+inline profile_track* get_thread_profile_track() {
+	if (current_profile_track) {
+		return current_profile_track;
+	}
+
+	return make_thread_profile_track();
+}
+
+// Names the calling thread's track in reports and traces.
+void set_profile_thread_name(const char* name);
+
+inline void record_profile_event(
+	profile_track* track,
+	const char* name,
+	const uint64_t start_ticks,
+	const uint64_t end_ticks
+) {
+	uint64_t index;
+	profile_event* event;
+
+	index = track->write_count.load(std::memory_order_relaxed);
+	event = &(track->events[index & (PROFILE_RING_SIZE - 1)]);
+	event->name = name;
+	event->start_ticks = start_ticks;
+	event->end_ticks = end_ticks;
+
+	// Publishes the event to the collector.
+	track->write_count.store(index + 1, std::memory_order_release);
+}
+
+// Times its own lifetime. Use through PROFILE_ZONE.
+struct profile_scope {
+	profile_scope(const char* zone_name);
+	~profile_scope();
+
+	const char* name;
+	// 0 if the profiler was disabled when the zone started.
+	uint64_t start_ticks;
+};
+
+inline profile_scope::profile_scope(const char* zone_name) {
+	name = zone_name;
+	start_ticks = get_profiler()->enabled.load(std::memory_order_relaxed) ? profile_now() : 0;
+}
+
+inline profile_scope::~profile_scope() {
+	if (start_ticks != 0) {
+		record_profile_event(get_thread_profile_track(), name, start_ticks, profile_now());
+	}
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) profile_scope PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+
+// Drains every track and updates the rolling statistics. Call once a
+// frame, from one thread. Returns true on the frame a capture finishes.
+bool collect_profile_frame(profiler* prof);
+
+// Keeps every event for the next frame_count frames.
+void start_profile_capture(profiler* prof, const uint32_t frame_count);
+
+// Writes the last capture as Chrome trace event JSON.
+bool write_chrome_trace(profiler* prof, const std::string& path);
+
+// A table of every zone's rolling statistics.
+std::string get_profile_report(profiler* prof);
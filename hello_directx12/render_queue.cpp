@@ -0,0 +1,498 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "render_queue.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// Where each field sits in the key. See render_queue.h.
+const uint32_t LAYER_SHIFT = 60;
+const uint32_t PASS_SHIFT = 56;
+const uint32_t OPAQUE_PIPELINE_SHIFT = 44;
+const uint32_t OPAQUE_MATERIAL_SHIFT = 24;
+const uint32_t OPAQUE_DEPTH_SHIFT = 0;
+const uint32_t TRANSPARENT_DEPTH_SHIFT = 32;
+const uint32_t TRANSPARENT_PIPELINE_SHIFT = 20;
+const uint32_t TRANSPARENT_MATERIAL_SHIFT = 0;
+
+const uint64_t LAYER_MASK = (1ull << RENDER_KEY_LAYER_BITS) - 1;
+const uint64_t PASS_MASK = (1ull << RENDER_KEY_PASS_BITS) - 1;
+const uint64_t PIPELINE_MASK = (1ull << RENDER_KEY_PIPELINE_BITS) - 1;
+const uint64_t MATERIAL_MASK = (1ull << RENDER_KEY_MATERIAL_BITS) - 1;
+const uint64_t DEPTH_MASK = (1ull << RENDER_KEY_DEPTH_BITS) - 1;
+
+// One pass of the radix sort, for the jobs to share.
+struct radix_sort_pass {
+	render_queue* queue;
+	render_item* source;
+	render_item* destination;
+	uint32_t count;
+	uint32_t block_count;
+	uint32_t digit;
+};
+
+static uint32_t quantize_depth(const float depth);
+static uint32_t get_state_changes(const uint64_t previous, const uint64_t key);
+static uint32_t* get_block_counts(render_queue* queue, const uint32_t block, const uint32_t digit);
+static void get_block_range(
+	const radix_sort_pass* pass,
+	const uint32_t block,
+	uint32_t* begin,
+	uint32_t* end
+);
+// Fills in the blocks' counts of every byte of the key at once.
+static void count_all_digits(const uint32_t begin, const uint32_t end, void* data);
+// Fills in the blocks' counts of just the pass's byte.
+static void count_digit(const uint32_t begin, const uint32_t end, void* data);
+// Moves each block's items to where its counts (by now turned into
+// offsets) say.
+static void scatter_digit(const uint32_t begin, const uint32_t end, void* data);
+static void run_blocks(job_system* jobs, radix_sort_pass* pass, parallel_for_fn function);
+
+render_queue::render_queue() {
+	max_items = 0;
+	peak_items = 0;
+	dropped = 0;
+	pipeline_changes = 0;
+	material_changes = 0;
+	sort_passes = 0;
+}
+
+uint64_t make_render_key(
+	const uint32_t layer,
+	const uint32_t pass,
+	const uint32_t pipeline,
+	const uint32_t material,
+	const float depth
+) {
+	uint64_t key;
+	uint64_t quantized;
+
+	key = ((uint64_t)layer & LAYER_MASK) << LAYER_SHIFT;
+	key |= ((uint64_t)pass & PASS_MASK) << PASS_SHIFT;
+
+	quantized = quantize_depth(depth);
+
+	if (pass == RENDER_PASS_TRANSPARENT) {
+		// Far first.
+		key |= (DEPTH_MASK - quantized) << TRANSPARENT_DEPTH_SHIFT;
+		key |= ((uint64_t)pipeline & PIPELINE_MASK) << TRANSPARENT_PIPELINE_SHIFT;
+		key |= ((uint64_t)material & MATERIAL_MASK) << TRANSPARENT_MATERIAL_SHIFT;
+	} else {
+		key |= ((uint64_t)pipeline & PIPELINE_MASK) << OPAQUE_PIPELINE_SHIFT;
+		key |= ((uint64_t)material & MATERIAL_MASK) << OPAQUE_MATERIAL_SHIFT;
+		key |= quantized << OPAQUE_DEPTH_SHIFT;
+	}
+
+	return key;
+}
+
+uint32_t get_render_key_layer(const uint64_t key) {
+	return (uint32_t)((key >> LAYER_SHIFT) & LAYER_MASK);
+}
+
+uint32_t get_render_key_pass(const uint64_t key) {
+	return (uint32_t)((key >> PASS_SHIFT) & PASS_MASK);
+}
+
+uint32_t get_render_key_pipeline(const uint64_t key) {
+	if (get_render_key_pass(key) == RENDER_PASS_TRANSPARENT) {
+		return (uint32_t)((key >> TRANSPARENT_PIPELINE_SHIFT) & PIPELINE_MASK);
+	}
+
+	return (uint32_t)((key >> OPAQUE_PIPELINE_SHIFT) & PIPELINE_MASK);
+}
+
+uint32_t get_render_key_material(const uint64_t key) {
+	if (get_render_key_pass(key) == RENDER_PASS_TRANSPARENT) {
+		return (uint32_t)((key >> TRANSPARENT_MATERIAL_SHIFT) & MATERIAL_MASK);
+	}
+
+	return (uint32_t)((key >> OPAQUE_MATERIAL_SHIFT) & MATERIAL_MASK);
+}
+
+uint32_t get_render_key_depth(const uint64_t key) {
+	if (get_render_key_pass(key) == RENDER_PASS_TRANSPARENT) {
+		return (uint32_t)(DEPTH_MASK - ((key >> TRANSPARENT_DEPTH_SHIFT) & DEPTH_MASK));
+	}
+
+	return (uint32_t)((key >> OPAQUE_DEPTH_SHIFT) & DEPTH_MASK);
+}
+
+void initialize_render_queue(render_queue* queue, const uint32_t max_items) {
+	queue->max_items = max_items;
+	queue->peak_items = 0;
+	queue->dropped = 0;
+	queue->pipeline_changes = 0;
+	queue->material_changes = 0;
+	queue->sort_passes = 0;
+
+	// All the room there'll ever be, so the frame loop never allocates.
+	queue->items.clear();
+	queue->items.reserve(max_items);
+	queue->scratch.clear();
+	queue->scratch.resize(max_items);
+	queue->counts.assign(RENDER_SORT_MAX_BLOCKS * RENDER_SORT_DIGITS * RENDER_SORT_RADIX, 0);
+}
+
+void reset_render_queue(render_queue* queue) {
+	queue->items.clear();
+	queue->pipeline_changes = 0;
+	queue->material_changes = 0;
+}
+
+bool add_render_item(render_queue* queue, const uint64_t key, const uint32_t draw) {
+	render_item item;
+
+	if (queue->items.size() >= queue->max_items) {
+		queue->dropped++;
+		return false;
+	}
+
+	item.key = key;
+	item.draw = draw;
+	queue->items.push_back(item);
+
+	return true;
+}
+
+void sort_render_queue(render_queue* queue, job_system* jobs) {
+	radix_sort_pass pass;
+	bool skip[RENDER_SORT_DIGITS];
+	bool counted;
+	const uint32_t* block_counts;
+	uint32_t total[RENDER_SORT_RADIX];
+	uint32_t* offsets;
+	uint32_t offset;
+	uint32_t value_count;
+	uint32_t count;
+	uint32_t block;
+	uint32_t digit;
+	uint32_t value;
+
+	count = (uint32_t)queue->items.size();
+	queue->peak_items = max(queue->peak_items, count);
+	queue->sort_passes = 0;
+
+	if (count < 2) {
+		return;
+	}
+
+	// The scratch items are overwritten before they're read, so this
+	// only sets the size, and never grows past what was reserved.
+	queue->scratch.resize(count);
+
+	//
+	// Split the queue into blocks. Small queues are one block, sorted
+	// right here. Big ones get a few blocks per worker, so a worker
+	// that finishes early can take one from a slower one.
+	//
+
+	pass.queue = queue;
+	pass.source = queue->items.data();
+	pass.destination = queue->scratch.data();
+	pass.count = count;
+	pass.block_count = 1;
+	pass.digit = 0;
+
+	if (jobs && count >= RENDER_SORT_PARALLEL_MIN) {
+		pass.block_count = min(get_job_worker_count(jobs) * 4, RENDER_SORT_MAX_BLOCKS);
+	}
+
+	//
+	// Count every byte of every key in one go. A byte where every key
+	// has the same value wouldn't move anything, so that pass can be
+	// skipped.
+	//
+
+	run_blocks(jobs, &pass, count_all_digits);
+
+	for (digit = 0; digit < RENDER_SORT_DIGITS; digit++) {
+		memset(total, 0, sizeof(total));
+
+		for (block = 0; block < pass.block_count; block++) {
+			block_counts = get_block_counts(queue, block, digit);
+
+			for (value = 0; value < RENDER_SORT_RADIX; value++) {
+				total[value] += block_counts[value];
+			}
+		}
+
+		skip[digit] = false;
+		for (value = 0; value < RENDER_SORT_RADIX; value++) {
+			if (total[value] == count) {
+				skip[digit] = true;
+			}
+		}
+	}
+
+	//
+	// Sort by each byte, least significant first. The counts from above
+	// are only right for the first pass; after that the items have
+	// moved between blocks and have to be counted again.
+	//
+
+	counted = true;
+
+	for (digit = 0; digit < RENDER_SORT_DIGITS; digit++) {
+		if (skip[digit]) {
+			continue;
+		}
+
+		pass.digit = digit;
+
+		if (!counted) {
+			run_blocks(jobs, &pass, count_digit);
+		}
+		counted = false;
+
+		//
+		// Turn the counts into where each block's first item with each
+		// value goes: after every smaller value, and after the same
+		// value in earlier blocks.
+		//
+
+		offset = 0;
+		for (value = 0; value < RENDER_SORT_RADIX; value++) {
+			for (block = 0; block < pass.block_count; block++) {
+				offsets = get_block_counts(queue, block, digit);
+				value_count = offsets[value];
+				offsets[value] = offset;
+				offset += value_count;
+			}
+		}
+
+		run_blocks(jobs, &pass, scatter_digit);
+
+		swap(pass.source, pass.destination);
+		queue->sort_passes++;
+	}
+
+	// An odd number of passes leaves the sorted items in scratch.
+	if (pass.source != queue->items.data()) {
+		queue->items.swap(queue->scratch);
+	}
+}
+
+uint32_t get_render_state_changes(render_queue* queue, const uint32_t i) {
+	uint32_t changes;
+
+	if (i == 0) {
+		changes = RENDER_STATE_PIPELINE | RENDER_STATE_MATERIAL;
+	} else {
+		changes = get_state_changes(queue->items[i - 1].key, queue->items[i].key);
+	}
+
+	if (changes & RENDER_STATE_PIPELINE) {
+		queue->pipeline_changes++;
+	}
+
+	if (changes & RENDER_STATE_MATERIAL) {
+		queue->material_changes++;
+	}
+
+	return changes;
+}
+
+void count_render_state_changes(
+	const render_item* items,
+	const uint32_t count,
+	uint32_t* pipeline_changes,
+	uint32_t* material_changes
+) {
+	uint32_t changes;
+	uint32_t i;
+
+	*pipeline_changes = 0;
+	*material_changes = 0;
+
+	for (i = 0; i < count; i++) {
+		if (i == 0) {
+			changes = RENDER_STATE_PIPELINE | RENDER_STATE_MATERIAL;
+		} else {
+			changes = get_state_changes(items[i - 1].key, items[i].key);
+		}
+
+		if (changes & RENDER_STATE_PIPELINE) {
+			(*pipeline_changes)++;
+		}
+
+		if (changes & RENDER_STATE_MATERIAL) {
+			(*material_changes)++;
+		}
+	}
+}
+
+render_queue_stats get_render_queue_stats(const render_queue* queue) {
+	render_queue_stats stats;
+
+	stats.items = (uint32_t)queue->items.size();
+	stats.peak_items = queue->peak_items;
+	stats.dropped = queue->dropped;
+	stats.pipeline_changes = queue->pipeline_changes;
+	stats.material_changes = queue->material_changes;
+	stats.sort_passes = queue->sort_passes;
+
+	return stats;
+}
+
+string get_render_queue_report(const render_queue* queue) {
+	render_queue_stats stats;
+	char report[256];
+
+	stats = get_render_queue_stats(queue);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Render queue: %u draws last frame (%u pipeline and %u material changes, %u sort passes), "
+		"peak of %u of %u, %llu dropped\n",
+		stats.items,
+		stats.pipeline_changes,
+		stats.material_changes,
+		stats.sort_passes,
+		stats.peak_items,
+		queue->max_items,
+		(unsigned long long)stats.dropped
+	);
+
+	return report;
+}
+
+static uint32_t quantize_depth(const float depth) {
+	uint32_t bits;
+
+	//
+	// Positive floats sort the same as their bits do, so the top 24
+	// bits (less the sign, which is always clear) keep the order with
+	// no need to know how far the far plane is.
+	//
+
+	if (!(depth > 0.0f)) {
+		return 0;
+	}
+
+	memcpy(&bits, &depth, sizeof(bits));
+
+	return (uint32_t)min((uint64_t)(bits >> 7), DEPTH_MASK);
+}
+
+static uint32_t get_state_changes(const uint64_t previous, const uint64_t key) {
+	uint32_t changes;
+
+	changes = 0;
+
+	if (get_render_key_pipeline(previous) != get_render_key_pipeline(key)) {
+		changes |= RENDER_STATE_PIPELINE;
+	}
+
+	if (get_render_key_material(previous) != get_render_key_material(key)) {
+		changes |= RENDER_STATE_MATERIAL;
+	}
+
+	return changes;
+}
+
+static uint32_t* get_block_counts(render_queue* queue, const uint32_t block, const uint32_t digit) {
+	return &(queue->counts[(block * RENDER_SORT_DIGITS + digit) * RENDER_SORT_RADIX]);
+}
+
+static void get_block_range(
+	const radix_sort_pass* pass,
+	const uint32_t block,
+	uint32_t* begin,
+	uint32_t* end
+) {
+	*begin = (uint32_t)((uint64_t)pass->count * block / pass->block_count);
+	*end = (uint32_t)((uint64_t)pass->count * (block + 1) / pass->block_count);
+}
+
+static void count_all_digits(const uint32_t begin, const uint32_t end, void* data) {
+	radix_sort_pass* pass;
+	uint32_t* counts[RENDER_SORT_DIGITS];
+	uint64_t key;
+	uint32_t first;
+	uint32_t last;
+	uint32_t block;
+	uint32_t digit;
+	uint32_t i;
+
+	pass = (radix_sort_pass*)data;
+
+	for (block = begin; block < end; block++) {
+		get_block_range(pass, block, &first, &last);
+
+		for (digit = 0; digit < RENDER_SORT_DIGITS; digit++) {
+			counts[digit] = get_block_counts(pass->queue, block, digit);
+			memset(counts[digit], 0, RENDER_SORT_RADIX * sizeof(uint32_t));
+		}
+
+		for (i = first; i < last; i++) {
+			key = pass->source[i].key;
+
+			for (digit = 0; digit < RENDER_SORT_DIGITS; digit++) {
+				counts[digit][(key >> (digit * 8)) & 0xff]++;
+			}
+		}
+	}
+}
+
+static void count_digit(const uint32_t begin, const uint32_t end, void* data) {
+	radix_sort_pass* pass;
+	uint32_t* counts;
+	uint32_t shift;
+	uint32_t first;
+	uint32_t last;
+	uint32_t block;
+	uint32_t i;
+
+	pass = (radix_sort_pass*)data;
+	shift = pass->digit * 8;
+
+	for (block = begin; block < end; block++) {
+		get_block_range(pass, block, &first, &last);
+
+		counts = get_block_counts(pass->queue, block, pass->digit);
+		memset(counts, 0, RENDER_SORT_RADIX * sizeof(uint32_t));
+
+		for (i = first; i < last; i++) {
+			counts[(pass->source[i].key >> shift) & 0xff]++;
+		}
+	}
+}
+
+static void scatter_digit(const uint32_t begin, const uint32_t end, void* data) {
+	radix_sort_pass* pass;
+	uint32_t* offsets;
+	uint32_t shift;
+	uint32_t first;
+	uint32_t last;
+	uint32_t block;
+	uint32_t i;
+
+	pass = (radix_sort_pass*)data;
+	shift = pass->digit * 8;
+
+	for (block = begin; block < end; block++) {
+		get_block_range(pass, block, &first, &last);
+
+		offsets = get_block_counts(pass->queue, block, pass->digit);
+
+		for (i = first; i < last; i++) {
+			const render_item& item = pass->source[i];
+			pass->destination[offsets[(item.key >> shift) & 0xff]++] = item;
+		}
+	}
+}
+
+static void run_blocks(job_system* jobs, radix_sort_pass* pass, parallel_for_fn function) {
+	if (pass->block_count == 1) {
+		function(0, 1, pass);
+	} else {
+		parallel_for(jobs, pass->block_count, 1, function, pass);
+	}
+}
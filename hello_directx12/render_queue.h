@@ -0,0 +1,154 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Puts a frame's draws in the order that changes the least GPU state
+// between them, instead of whatever order code happened to ask for
+// them in.
+//
+// Each draw goes in the queue as a 64 bit sort key and the index of the
+// draw it stands for. The key is packed so that sorting it as a plain
+// number gives the order to record the draws in:
+//
+//   bits 63-60  layer     Everything in one layer is drawn before the
+//                         next.
+//   bits 59-56  pass      Opaque draws, then transparent ones.
+//   bits 55-0   opaque:       pipeline (12), material (20), depth (24)
+//               transparent:  depth (24, far first), pipeline (12),
+//                             material (20)
+//
+// So opaque draws are grouped by pipeline and then material, and front
+// to back within those, which helps early depth rejection. Transparent
+// draws have to go back to front to blend correctly, so depth comes
+// first for them and state changes are just whatever that leaves.
+// Pipelines that share a root signature should have numbers next to
+// each other, so they end up next to each other too.
+//
+// The sort is a least significant digit radix sort, a byte at a time.
+// Bytes that are the same in every key (the layer, often) are skipped.
+// Each pass counts the bytes in blocks of the queue, then every block
+// scatters its items to where the counts say they go, which keeps
+// blocks in order and so keeps the sort stable. Big queues do the
+// blocks in parallel on the job system.
+//
+// While recording, get_render_state_changes says which state each draw
+// needs set that the draw before it didn't already set. Nothing else
+// needs to be set.
+//
+// The frame loop mustn't allocate (see frame_arena.h), so everything
+// is sized up front by initialize_render_queue. Items past max_items
+// are dropped and counted.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct job_system;
+
+enum render_pass {
+	RENDER_PASS_OPAQUE = 0,
+	RENDER_PASS_TRANSPARENT,
+	RENDER_PASS_COUNT
+};
+
+const uint32_t RENDER_KEY_LAYER_BITS = 4;
+const uint32_t RENDER_KEY_PASS_BITS = 4;
+const uint32_t RENDER_KEY_PIPELINE_BITS = 12;
+const uint32_t RENDER_KEY_MATERIAL_BITS = 20;
+const uint32_t RENDER_KEY_DEPTH_BITS = 24;
+
+// What get_render_state_changes returns.
+const uint32_t RENDER_STATE_PIPELINE = 1 << 0;
+const uint32_t RENDER_STATE_MATERIAL = 1 << 1;
+
+// Queues smaller than this are sorted on the calling thread, since
+// handing out the work would cost more than it saves.
+const uint32_t RENDER_SORT_PARALLEL_MIN = 16384;
+// The most blocks a sort is split into.
+const uint32_t RENDER_SORT_MAX_BLOCKS = 64;
+// A byte at a time.
+const uint32_t RENDER_SORT_RADIX = 256;
+const uint32_t RENDER_SORT_DIGITS = 8;
+
+struct render_item {
+	uint64_t key;
+	// Which of the caller's draws this is.
+	uint32_t draw;
+};
+
+struct render_queue_stats {
+	uint32_t items;
+	uint32_t peak_items;
+	uint64_t dropped;
+	// How many times recording the last frame set each kind of state.
+	uint32_t pipeline_changes;
+	uint32_t material_changes;
+	// Byte passes the last sort did, out of RENDER_SORT_DIGITS.
+	uint32_t sort_passes;
+};
+
+struct render_queue {
+	render_queue();
+
+	uint32_t max_items;
+
+	// The sort goes back and forth between these, and ends up with the
+	// sorted items in items.
+	std::vector<render_item> items;
+	std::vector<render_item> scratch;
+	// Every block's count of every byte value, for each byte of the
+	// key.
+	std::vector<uint32_t> counts;
+
+	uint32_t peak_items;
+	uint64_t dropped;
+	uint32_t pipeline_changes;
+	uint32_t material_changes;
+	uint32_t sort_passes;
+};
+
+// Packs a sort key. Fields too big for their bits are cut down to fit.
+// depth is the distance from the camera; anything behind it counts as
+// zero.
+uint64_t make_render_key(
+	const uint32_t layer,
+	const uint32_t pass,
+	const uint32_t pipeline,
+	const uint32_t material,
+	const float depth
+);
+uint32_t get_render_key_layer(const uint64_t key);
+uint32_t get_render_key_pass(const uint64_t key);
+uint32_t get_render_key_pipeline(const uint64_t key);
+uint32_t get_render_key_material(const uint64_t key);
+// The quantized depth. Bigger is further away, whatever the pass.
+uint32_t get_render_key_depth(const uint64_t key);
+
+void initialize_render_queue(render_queue* queue, const uint32_t max_items);
+
+// Throws away last frame's items.
+void reset_render_queue(render_queue* queue);
+// Returns false, and counts it, if the queue is full.
+bool add_render_item(render_queue* queue, const uint64_t key, const uint32_t draw);
+
+// Sorts the items by key. Items with the same key stay in the order
+// they were added. jobs can be NULL to sort on the calling thread.
+void sort_render_queue(render_queue* queue, job_system* jobs);
+
+// The RENDER_STATE_ bits item i needs set, given that the item before
+// it has been drawn. The first item needs everything. Counts what it
+// returns in the queue's stats.
+uint32_t get_render_state_changes(render_queue* queue, const uint32_t i);
+// How many times drawing items in the order given would have to set
+// each kind of state.
+void count_render_state_changes(
+	const render_item* items,
+	const uint32_t count,
+	uint32_t* pipeline_changes,
+	uint32_t* material_changes
+);
+
+render_queue_stats get_render_queue_stats(const render_queue* queue);
+std::string get_render_queue_report(const render_queue* queue);
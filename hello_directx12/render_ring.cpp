@@ -0,0 +1,369 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "render_ring.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+static uint64_t get_packet_footprint(const uint32_t size);
+static bool producer_has_room(render_ring* ring, const uint64_t end);
+static bool consumer_has_packet(render_ring* ring, const uint64_t position);
+static bool consumer_caught_up(render_ring* ring, const uint32_t max_queued);
+static void wake_other_side(render_ring_waiter* waiter);
+
+// Waits until ready() returns true: first by yielding a few times, then
+// by sleeping until the other side wakes us.
+template <typename ready_fn>
+static void wait_for_ring(render_ring_waiter* waiter, ready_fn ready);
+
+render_ring_waiter::render_ring_waiter() {
+	sleeping = false;
+}
+
+render_ring::render_ring() {
+	capacity = 0;
+	policy = RENDER_RING_WAIT;
+	write_position = 0;
+	frames_written = 0;
+	packet_position = 0;
+	cached_read_position = 0;
+	frame = 0;
+	packets_written = 0;
+	bytes_written = 0;
+	packets_dropped = 0;
+	producer_waits = 0;
+	frame_waits = 0;
+	peak_occupancy = 0;
+	read_position = 0;
+	frames_read = 0;
+	cached_write_position = 0;
+	packets_read = 0;
+	consumer_waits = 0;
+}
+
+void initialize_render_ring(
+	render_ring* ring,
+	const uint64_t capacity,
+	const render_ring_policy policy
+) {
+	ring->buffer.assign(capacity, 0);
+	ring->capacity = capacity;
+	ring->policy = policy;
+
+	ring->write_position.store(0);
+	ring->frames_written.store(0);
+	ring->packet_position = 0;
+	ring->cached_read_position = 0;
+	ring->frame = 0;
+	ring->packets_written.store(0);
+	ring->bytes_written.store(0);
+	ring->packets_dropped.store(0);
+	ring->producer_waits.store(0);
+	ring->frame_waits.store(0);
+	ring->peak_occupancy.store(0);
+
+	ring->read_position.store(0);
+	ring->frames_read.store(0);
+	ring->cached_write_position = 0;
+	ring->packets_read.store(0);
+	ring->consumer_waits.store(0);
+}
+
+void begin_render_frame(render_ring* ring, const uint32_t max_queued) {
+	if (!consumer_caught_up(ring, max_queued)) {
+		ring->frame_waits.store(ring->frame_waits.load(memory_order_relaxed) + 1, memory_order_relaxed);
+
+		wait_for_ring(&(ring->producer_waiter), [ring, max_queued]() {
+			return consumer_caught_up(ring, max_queued);
+		});
+	}
+
+	ring->frame = ring->frames_written.load(memory_order_relaxed);
+}
+
+void end_render_frame(render_ring* ring) {
+	ring->frames_written.store(ring->frame + 1, memory_order_seq_cst);
+	wake_other_side(&(ring->consumer_waiter));
+}
+
+void* begin_render_packet(render_ring* ring, const uint32_t type, const uint32_t size) {
+	uint64_t position;
+	uint64_t footprint;
+	uint64_t offset;
+	uint64_t padding;
+	render_packet_header* header;
+
+	footprint = get_packet_footprint(size);
+	position = ring->write_position.load(memory_order_relaxed);
+
+	//
+	// A packet has to be in one piece, so if it would run off the end
+	// of the ring, pad out the rest and start again at the beginning.
+	//
+
+	offset = position & (ring->capacity - 1);
+	padding = 0;
+
+	if (offset + footprint > ring->capacity) {
+		padding = ring->capacity - offset;
+	}
+
+	// Anything over half the ring could wait forever for room.
+	if (footprint > ring->capacity / 2) {
+		ring->packets_dropped.store(ring->packets_dropped.load(memory_order_relaxed) + 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	if (!producer_has_room(ring, position + padding + footprint)) {
+		if (ring->policy == RENDER_RING_DROP) {
+			ring->packets_dropped.store(ring->packets_dropped.load(memory_order_relaxed) + 1, memory_order_relaxed);
+			return NULL;
+		}
+
+		ring->producer_waits.store(ring->producer_waits.load(memory_order_relaxed) + 1, memory_order_relaxed);
+
+		// The consumer might be asleep waiting on a packet we haven't
+		// published yet, so make sure it's awake to make room.
+		wake_other_side(&(ring->consumer_waiter));
+
+		wait_for_ring(&(ring->producer_waiter), [ring, position, padding, footprint]() {
+			return producer_has_room(ring, position + padding + footprint);
+		});
+	}
+
+	if (padding > 0) {
+		header = (render_packet_header*)&(ring->buffer[offset]);
+		header->type = RENDER_PACKET_PADDING;
+		header->size = (uint32_t)(padding - sizeof(render_packet_header));
+		header->frame = ring->frame;
+
+		position += padding;
+	}
+
+	header = (render_packet_header*)&(ring->buffer[position & (ring->capacity - 1)]);
+	header->type = type;
+	header->size = size;
+	header->frame = ring->frame;
+
+	ring->packet_position = position + footprint;
+	ring->bytes_written.store(ring->bytes_written.load(memory_order_relaxed) + footprint, memory_order_relaxed);
+
+	return header + 1;
+}
+
+void end_render_packet(render_ring* ring) {
+	uint64_t occupancy;
+
+	ring->write_position.store(ring->packet_position, memory_order_seq_cst);
+	wake_other_side(&(ring->consumer_waiter));
+
+	ring->packets_written.store(ring->packets_written.load(memory_order_relaxed) + 1, memory_order_relaxed);
+
+	occupancy = ring->packet_position - ring->cached_read_position;
+	if (occupancy > ring->peak_occupancy.load(memory_order_relaxed)) {
+		ring->peak_occupancy.store(occupancy, memory_order_relaxed);
+	}
+}
+
+bool write_render_packet(
+	render_ring* ring,
+	const uint32_t type,
+	const void* data,
+	const uint32_t size
+) {
+	void* destination;
+
+	destination = begin_render_packet(ring, type, size);
+	if (!destination) {
+		return false;
+	}
+
+	memcpy(destination, data, size);
+	end_render_packet(ring);
+
+	return true;
+}
+
+const render_packet_header* peek_render_packet(render_ring* ring) {
+	uint64_t position;
+	const render_packet_header* header;
+
+	position = ring->read_position.load(memory_order_relaxed);
+
+	for (;;) {
+		if (!consumer_has_packet(ring, position)) {
+			return NULL;
+		}
+
+		header = (const render_packet_header*)&(ring->buffer[position & (ring->capacity - 1)]);
+
+		if (header->type != RENDER_PACKET_PADDING) {
+			return header;
+		}
+
+		// Skip the padding at the end of the ring.
+		position += sizeof(render_packet_header) + header->size;
+		ring->read_position.store(position, memory_order_seq_cst);
+		wake_other_side(&(ring->producer_waiter));
+	}
+}
+
+const render_packet_header* wait_for_render_packet(render_ring* ring) {
+	const render_packet_header* header;
+
+	header = peek_render_packet(ring);
+	if (header) {
+		return header;
+	}
+
+	ring->consumer_waits.store(ring->consumer_waits.load(memory_order_relaxed) + 1, memory_order_relaxed);
+
+	wait_for_ring(&(ring->consumer_waiter), [ring, &header]() {
+		header = peek_render_packet(ring);
+		return header != NULL;
+	});
+
+	return header;
+}
+
+void pop_render_packet(render_ring* ring) {
+	uint64_t position;
+	const render_packet_header* header;
+
+	position = ring->read_position.load(memory_order_relaxed);
+	header = (const render_packet_header*)&(ring->buffer[position & (ring->capacity - 1)]);
+
+	ring->read_position.store(position + get_packet_footprint(header->size), memory_order_seq_cst);
+	wake_other_side(&(ring->producer_waiter));
+
+	ring->packets_read.store(ring->packets_read.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+void finish_render_frame(render_ring* ring) {
+	ring->frames_read.store(ring->frames_read.load(memory_order_relaxed) + 1, memory_order_seq_cst);
+	wake_other_side(&(ring->producer_waiter));
+}
+
+render_ring_stats get_render_ring_stats(const render_ring* ring) {
+	render_ring_stats stats;
+
+	stats.capacity = ring->capacity;
+	stats.occupancy = ring->write_position.load() - ring->read_position.load();
+	stats.peak_occupancy = ring->peak_occupancy.load();
+	stats.packets_written = ring->packets_written.load();
+	stats.packets_read = ring->packets_read.load();
+	stats.bytes_written = ring->bytes_written.load();
+	stats.packets_dropped = ring->packets_dropped.load();
+	stats.producer_waits = ring->producer_waits.load();
+	stats.frame_waits = ring->frame_waits.load();
+	stats.consumer_waits = ring->consumer_waits.load();
+	stats.frames_queued = ring->frames_written.load() - ring->frames_read.load();
+
+	return stats;
+}
+
+string get_render_ring_report(const render_ring* ring) {
+	render_ring_stats stats;
+	char report[512];
+
+	stats = get_render_ring_stats(ring);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Render ring: %llu packets (%.1fKB), peak %.1f%% of %lluKB full, "
+		"%llu dropped, producer waited %llu times for room and %llu for frames, "
+		"consumer waited %llu times\n",
+		(unsigned long long)stats.packets_written,
+		(double)stats.bytes_written / 1024.0,
+		100.0 * (double)stats.peak_occupancy / (double)stats.capacity,
+		(unsigned long long)(stats.capacity / 1024),
+		(unsigned long long)stats.packets_dropped,
+		(unsigned long long)stats.producer_waits,
+		(unsigned long long)stats.frame_waits,
+		(unsigned long long)stats.consumer_waits
+	);
+
+	return report;
+}
+
+static uint64_t get_packet_footprint(const uint32_t size) {
+	uint64_t footprint;
+
+	footprint = sizeof(render_packet_header) + size;
+
+	return (footprint + RENDER_PACKET_ALIGNMENT - 1) & ~(uint64_t)(RENDER_PACKET_ALIGNMENT - 1);
+}
+
+static bool producer_has_room(render_ring* ring, const uint64_t end) {
+	//
+	// Only look at the consumer's position if the last one we saw
+	// doesn't leave enough room. Most of the time it does.
+	//
+
+	if (end - ring->cached_read_position <= ring->capacity) {
+		return true;
+	}
+
+	ring->cached_read_position = ring->read_position.load(memory_order_seq_cst);
+
+	return end - ring->cached_read_position <= ring->capacity;
+}
+
+static bool consumer_has_packet(render_ring* ring, const uint64_t position) {
+	if (position != ring->cached_write_position) {
+		return true;
+	}
+
+	ring->cached_write_position = ring->write_position.load(memory_order_seq_cst);
+
+	return position != ring->cached_write_position;
+}
+
+static bool consumer_caught_up(render_ring* ring, const uint32_t max_queued) {
+	uint64_t queued;
+
+	queued = ring->frames_written.load(memory_order_relaxed) -
+		ring->frames_read.load(memory_order_seq_cst);
+
+	return queued < max_queued;
+}
+
+static void wake_other_side(render_ring_waiter* waiter) {
+	//
+	// Taking the lock before notifying means the sleeper is either
+	// already waiting (and gets the notification), or hasn't checked
+	// for work yet (and will see what we just did).
+	//
+
+	if (waiter->sleeping.load(memory_order_seq_cst)) {
+		lock_guard<mutex> lock(waiter->lock);
+		waiter->wake.notify_one();
+	}
+}
+
+template <typename ready_fn>
+static void wait_for_ring(render_ring_waiter* waiter, ready_fn ready) {
+	uint32_t spins;
+
+	for (spins = 0; spins < RENDER_RING_SPIN_COUNT; spins++) {
+		if (ready()) {
+			return;
+		}
+
+		this_thread::yield();
+	}
+
+	unique_lock<mutex> lock(waiter->lock);
+
+	waiter->sleeping.store(true, memory_order_seq_cst);
+
+	while (!ready()) {
+		waiter->wake.wait(lock);
+	}
+
+	waiter->sleeping.store(false, memory_order_relaxed);
+}
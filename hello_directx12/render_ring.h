@@ -0,0 +1,176 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A ring buffer of render packets, going from the thread that decides
+// what to draw to the thread that records and submits it. There is
+// exactly one of each (single producer, single consumer), which is
+// what lets the ring get away without locks: the producer only ever
+// moves the write position and the consumer only ever moves the read
+// position.
+//
+// Packets are a small header followed by whatever the packet type
+// needs, all laid out in place in the ring, so writing one is a copy
+// into memory that's already there. A packet never wraps around the
+// end of the ring. If one won't fit, the rest of the ring is skipped
+// with a padding packet.
+//
+// Packets are grouped into frames. The producer can be held back so it
+// never gets more than a set number of frames ahead of the consumer.
+//
+// When the ring is full, the producer either waits for room or drops
+// the packet, depending on the ring's policy. Both are counted, along
+// with how full the ring gets, so we can tell whether it's sized
+// right.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Packets start on, and are padded out to, this many bytes.
+const uint32_t RENDER_PACKET_ALIGNMENT = 16;
+// Packet type 0 is reserved for the padding at the end of the ring.
+const uint32_t RENDER_PACKET_PADDING = 0;
+// How many times a side checks again (yielding in between) before it
+// goes to sleep waiting for the other.
+const uint32_t RENDER_RING_SPIN_COUNT = 64;
+
+enum render_ring_policy {
+	// Wait for the consumer to make room.
+	RENDER_RING_WAIT,
+	// Drop the packet. Only for packets that can be lost, like debug
+	// drawing.
+	RENDER_RING_DROP
+};
+
+struct render_packet_header {
+	uint32_t type;
+	// Bytes of data after the header, not counting padding.
+	uint32_t size;
+	// The frame this packet belongs to.
+	uint64_t frame;
+};
+
+struct render_ring_stats {
+	uint64_t capacity;
+	uint64_t occupancy;
+	uint64_t peak_occupancy;
+	uint64_t packets_written;
+	uint64_t packets_read;
+	uint64_t bytes_written;
+	uint64_t packets_dropped;
+	// How many times the producer had to wait for room, and for the
+	// consumer to catch up on frames.
+	uint64_t producer_waits;
+	uint64_t frame_waits;
+	// How many times the consumer found the ring empty and waited.
+	uint64_t consumer_waits;
+	uint64_t frames_queued;
+};
+
+// Somewhere for one side of the ring to sleep until the other wakes
+// it. sleeping is only set while someone is asleep, so the other side
+// normally only has to check it, not take the lock.
+struct render_ring_waiter {
+	render_ring_waiter();
+
+	std::atomic<bool> sleeping;
+	std::mutex lock;
+	std::condition_variable wake;
+};
+
+struct render_ring {
+	render_ring();
+
+	std::vector<uint8_t> buffer;
+	uint64_t capacity;
+	render_ring_policy policy;
+
+	//
+	// The two sides each get their own cache line, so they don't slow
+	// each other down just by writing their own counters. Positions
+	// count bytes from the start and never wrap, so the place in the
+	// buffer is position % capacity.
+	//
+
+	alignas(64) std::atomic<uint64_t> write_position;
+	std::atomic<uint64_t> frames_written;
+	// Producer only. The packet being written, and the last read
+	// position we saw, so we don't have to look at the consumer's
+	// cache line for every packet.
+	uint64_t packet_position;
+	uint64_t cached_read_position;
+	uint64_t frame;
+	std::atomic<uint64_t> packets_written;
+	std::atomic<uint64_t> bytes_written;
+	std::atomic<uint64_t> packets_dropped;
+	std::atomic<uint64_t> producer_waits;
+	std::atomic<uint64_t> frame_waits;
+	std::atomic<uint64_t> peak_occupancy;
+
+	alignas(64) std::atomic<uint64_t> read_position;
+	std::atomic<uint64_t> frames_read;
+	// Consumer only.
+	uint64_t cached_write_position;
+	std::atomic<uint64_t> packets_read;
+	std::atomic<uint64_t> consumer_waits;
+
+	// For when one side has nothing to do until the other catches up.
+	alignas(64) render_ring_waiter producer_waiter;
+	render_ring_waiter consumer_waiter;
+};
+
+// capacity must be a power of two.
+void initialize_render_ring(
+	render_ring* ring,
+	const uint64_t capacity,
+	const render_ring_policy policy
+);
+
+//
+// Producer side.
+//
+
+// Waits until fewer than max_queued frames are waiting to be consumed.
+void begin_render_frame(render_ring* ring, const uint32_t max_queued);
+// Marks the end of a frame's packets.
+void end_render_frame(render_ring* ring);
+
+// Makes room for a packet with size bytes of data and returns where to
+// write the data, or NULL if the packet was dropped. Nothing is visible
+// to the consumer until end_render_packet.
+void* begin_render_packet(render_ring* ring, const uint32_t type, const uint32_t size);
+void end_render_packet(render_ring* ring);
+
+// Writes a whole packet in one go. Returns false if it was dropped.
+bool write_render_packet(
+	render_ring* ring,
+	const uint32_t type,
+	const void* data,
+	const uint32_t size
+);
+
+//
+// Consumer side.
+//
+
+// Returns the next packet, or NULL if there isn't one yet.
+const render_packet_header* peek_render_packet(render_ring* ring);
+// Waits for the next packet.
+const render_packet_header* wait_for_render_packet(render_ring* ring);
+// Lets the producer reuse the packet from peek_render_packet.
+void pop_render_packet(render_ring* ring);
+// Marks a frame as consumed, letting the producer start another.
+void finish_render_frame(render_ring* ring);
+
+inline const void* get_render_packet_data(const render_packet_header* header) {
+	return header + 1;
+}
+
+render_ring_stats get_render_ring_stats(const render_ring* ring);
+std::string get_render_ring_report(const render_ring* ring);
@@ -0,0 +1,341 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "residency_manager.h"
+
+#include <cassert>
+
+using namespace std;
+
+static void lru_remove(residency_manager* manager, const uint32_t index);
+static void lru_push_back(residency_manager* manager, const uint32_t index);
+static void make_resident(
+	residency_manager* manager,
+	const uint32_t index,
+	residency_work* work
+);
+
+residency_manager::residency_manager() {
+	unused_objects = INVALID_RESIDENCY_HANDLE;
+	lru_head = INVALID_RESIDENCY_HANDLE;
+	lru_tail = INVALID_RESIDENCY_HANDLE;
+	frame = 0;
+	next_residency_fence = 1;
+	min_eviction_age = 1;
+	thrash_window = 0;
+	stats = {};
+}
+
+void initialize_residency_manager(
+	residency_manager* manager,
+	const uint32_t min_eviction_age,
+	const uint32_t thrash_window
+) {
+	*manager = residency_manager();
+
+	// Evicting something used this frame would be undone right away,
+	// so the youngest we'll evict is one frame old.
+	manager->min_eviction_age = min_eviction_age > 0 ? min_eviction_age : 1;
+	manager->thrash_window = thrash_window;
+}
+
+residency_handle track_residency(
+	residency_manager* manager,
+	void* object,
+	const uint64_t size
+) {
+	residency_object* o;
+	uint32_t index;
+
+	if (manager->unused_objects != INVALID_RESIDENCY_HANDLE) {
+		index = manager->unused_objects;
+		manager->unused_objects = manager->objects[index].lru_next;
+	} else {
+		index = (uint32_t)manager->objects.size();
+		manager->objects.push_back({});
+	}
+
+	o = &(manager->objects[index]);
+	*o = {};
+	o->object = object;
+	o->size = size;
+	o->state = RESIDENCY_RESIDENT;
+	o->last_used_frame = manager->frame;
+	o->lru_prev = INVALID_RESIDENCY_HANDLE;
+	o->lru_next = INVALID_RESIDENCY_HANDLE;
+
+	lru_push_back(manager, index);
+
+	manager->stats.tracked_bytes += size;
+	manager->stats.resident_bytes += size;
+
+	return index;
+}
+
+void untrack_residency(residency_manager* manager, const residency_handle handle) {
+	residency_object* o;
+	size_t i;
+
+	assert(handle < manager->objects.size());
+
+	o = &(manager->objects[handle]);
+
+	if (o->state != RESIDENCY_EVICTED) {
+		lru_remove(manager, handle);
+		manager->stats.resident_bytes -= o->size;
+	}
+
+	if (o->requested) {
+		for (i = 0; i < manager->requests.size(); i++) {
+			if (manager->requests[i] == handle) {
+				manager->requests[i] = manager->requests.back();
+				manager->requests.pop_back();
+				break;
+			}
+		}
+	}
+
+	manager->stats.tracked_bytes -= o->size;
+
+	o->object = NULL;
+	o->lru_next = manager->unused_objects;
+	manager->unused_objects = handle;
+}
+
+void use_resident_object(
+	residency_manager* manager,
+	const residency_handle handle,
+	const uint64_t fence_value
+) {
+	residency_object* o;
+
+	assert(handle < manager->objects.size());
+
+	o = &(manager->objects[handle]);
+
+	if (fence_value > o->last_used_fence) {
+		o->last_used_fence = fence_value;
+	}
+
+	o->last_used_frame = manager->frame;
+
+	if (o->state == RESIDENCY_EVICTED) {
+		// A synchronous request wins over an async one; we need it now.
+		o->requested_async = false;
+
+		if (!o->requested) {
+			o->requested = true;
+			manager->requests.push_back(handle);
+		}
+
+		return;
+	}
+
+	// Move it to the most recently used end.
+	lru_remove(manager, handle);
+	lru_push_back(manager, handle);
+}
+
+uint64_t request_residency_async(residency_manager* manager, const residency_handle handle) {
+	residency_object* o;
+
+	assert(handle < manager->objects.size());
+
+	o = &(manager->objects[handle]);
+
+	if (o->state != RESIDENCY_EVICTED) {
+		return o->resident_fence;
+	}
+
+	if (!o->requested) {
+		o->requested = true;
+		o->requested_async = true;
+		manager->requests.push_back(handle);
+	}
+
+	// Everything requested before the next update shares its fence.
+	return manager->next_residency_fence;
+}
+
+bool is_object_resident(const residency_manager* manager, const residency_handle handle) {
+	assert(handle < manager->objects.size());
+
+	return manager->objects[handle].state == RESIDENCY_RESIDENT;
+}
+
+void update_residency(
+	residency_manager* manager,
+	const residency_frame_info& info,
+	residency_work* work
+) {
+	residency_object* o;
+	uint64_t incoming_bytes;
+	uint64_t projected_usage;
+	uint64_t excess;
+	uint32_t index;
+	uint32_t next;
+	size_t i;
+
+	work->evict.clear();
+	work->make_resident.clear();
+	work->make_resident_async.clear();
+	work->async_fence_value = 0;
+
+	//
+	// Pending objects whose fence has come in are resident now.
+	//
+
+	for (index = manager->lru_head; index != INVALID_RESIDENCY_HANDLE; index = next) {
+		o = &(manager->objects[index]);
+		next = o->lru_next;
+
+		if (o->state == RESIDENCY_PENDING && o->resident_fence <= info.completed_residency_fence) {
+			o->state = RESIDENCY_RESIDENT;
+		}
+	}
+
+	//
+	// Bring back everything that's been asked for.
+	//
+
+	incoming_bytes = 0;
+
+	for (i = 0; i < manager->requests.size(); i++) {
+		index = manager->requests[i];
+		incoming_bytes += manager->objects[index].size;
+		make_resident(manager, index, work);
+	}
+
+	manager->requests.clear();
+
+	if (!work->make_resident_async.empty()) {
+		work->async_fence_value = manager->next_residency_fence;
+		manager->next_residency_fence++;
+	}
+
+	//
+	// The OS's usage doesn't include what we're about to make
+	// resident, so add it on. Then evict from the cold end of the LRU
+	// list until we fit.
+	//
+
+	projected_usage = info.usage + incoming_bytes;
+	excess = 0;
+	if (projected_usage > info.budget) {
+		excess = projected_usage - info.budget;
+	}
+
+	index = manager->lru_head;
+
+	while (excess > 0 && index != INVALID_RESIDENCY_HANDLE) {
+		o = &(manager->objects[index]);
+		next = o->lru_next;
+
+		//
+		// The list is in order of last use, so once we reach something
+		// that's too recent to evict, everything after it is too.
+		//
+
+		if (manager->frame - o->last_used_frame < manager->min_eviction_age) {
+			break;
+		}
+
+		if (o->last_used_fence > info.completed_fence) {
+			break;
+		}
+
+		if (o->state == RESIDENCY_RESIDENT) {
+			lru_remove(manager, index);
+
+			o->state = RESIDENCY_EVICTED;
+			o->evicted_frame = manager->frame;
+
+			work->evict.push_back(o->object);
+
+			manager->stats.resident_bytes -= o->size;
+			manager->stats.evictions++;
+			manager->stats.bytes_evicted += o->size;
+
+			excess = o->size < excess ? excess - o->size : 0;
+		}
+
+		index = next;
+	}
+
+	if (excess > 0) {
+		manager->stats.over_budget_frames++;
+	}
+
+	manager->stats.budget = info.budget;
+	manager->stats.usage = info.usage;
+	manager->frame++;
+}
+
+static void lru_remove(residency_manager* manager, const uint32_t index) {
+	residency_object* o;
+
+	o = &(manager->objects[index]);
+
+	if (o->lru_prev != INVALID_RESIDENCY_HANDLE) {
+		manager->objects[o->lru_prev].lru_next = o->lru_next;
+	} else {
+		manager->lru_head = o->lru_next;
+	}
+
+	if (o->lru_next != INVALID_RESIDENCY_HANDLE) {
+		manager->objects[o->lru_next].lru_prev = o->lru_prev;
+	} else {
+		manager->lru_tail = o->lru_prev;
+	}
+
+	o->lru_prev = INVALID_RESIDENCY_HANDLE;
+	o->lru_next = INVALID_RESIDENCY_HANDLE;
+}
+
+static void lru_push_back(residency_manager* manager, const uint32_t index) {
+	residency_object* o;
+
+	o = &(manager->objects[index]);
+	o->lru_prev = manager->lru_tail;
+	o->lru_next = INVALID_RESIDENCY_HANDLE;
+
+	if (manager->lru_tail != INVALID_RESIDENCY_HANDLE) {
+		manager->objects[manager->lru_tail].lru_next = index;
+	} else {
+		manager->lru_head = index;
+	}
+
+	manager->lru_tail = index;
+}
+
+static void make_resident(
+	residency_manager* manager,
+	const uint32_t index,
+	residency_work* work
+) {
+	residency_object* o;
+
+	o = &(manager->objects[index]);
+
+	if (manager->frame - o->evicted_frame <= manager->thrash_window) {
+		manager->stats.thrash_count++;
+	}
+
+	if (o->requested_async) {
+		o->state = RESIDENCY_PENDING;
+		o->resident_fence = manager->next_residency_fence;
+		work->make_resident_async.push_back(o->object);
+		manager->stats.async_make_residents++;
+	} else {
+		o->state = RESIDENCY_RESIDENT;
+		work->make_resident.push_back(o->object);
+	}
+
+	o->requested = false;
+	o->requested_async = false;
+
+	lru_push_back(manager, index);
+
+	manager->stats.resident_bytes += o->size;
+	manager->stats.make_residents++;
+	manager->stats.bytes_made_resident += o->size;
+}
@@ -0,0 +1,161 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// The OS gives every process a video memory budget, and it can change
+// while we run (another app starts, the window moves to another GPU).
+// If we go over it, the OS starts paging our memory out for us, with
+// no idea what we're about to draw. The residency manager makes that
+// call itself instead: it keeps a least recently used list of every
+// heap, and when the budget is exceeded it evicts from the cold end.
+// Anything evicted that gets used again is made resident before the
+// command list using it runs.
+//
+// This file only makes decisions. It deals in opaque object pointers
+// and hands back lists of what to evict and what to make resident, so
+// it can be driven by D3D12 (see update_gpu_residency in dx12_handler)
+// or by a simulation (see tools/residency_sim.cpp).
+//
+// Two rules keep it from thrashing:
+//   - Nothing is evicted while the GPU might still be using it, i.e.
+//     until the fence value of its last use has completed.
+//   - Nothing used in the last min_eviction_age frames is evicted. If
+//     the working set simply doesn't fit, we'd rather run over budget
+//     (and let the OS page) than evict and reload the same heaps every
+//     frame.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+typedef uint32_t residency_handle;
+
+const residency_handle INVALID_RESIDENCY_HANDLE = 0xffffffff;
+
+enum residency_state {
+	RESIDENCY_RESIDENT,
+	RESIDENCY_EVICTED,
+	// Asked to be made resident asynchronously, and not there yet.
+	RESIDENCY_PENDING
+};
+
+struct residency_object {
+	// NULL if this slot isn't in use.
+	void* object;
+	uint64_t size;
+	residency_state state;
+
+	uint64_t last_used_fence;
+	uint64_t last_used_frame;
+	uint64_t evicted_frame;
+	// When async, the residency fence value that says it's resident.
+	uint64_t resident_fence;
+	// Waiting to be made resident at the next update.
+	bool requested;
+	bool requested_async;
+
+	// Neighbours in the LRU list (resident and pending objects only).
+	// Also chains unused slots together through lru_next.
+	uint32_t lru_prev;
+	uint32_t lru_next;
+};
+
+// Filled in once per update from the OS and the GPU.
+struct residency_frame_info {
+	uint64_t budget;
+	// How much the OS says we are using, ours and everything else.
+	uint64_t usage;
+	// The last fence value the GPU has finished.
+	uint64_t completed_fence;
+	// The last residency fence value that has been signalled.
+	uint64_t completed_residency_fence;
+};
+
+// What the caller has to do after an update.
+struct residency_work {
+	std::vector<void*> evict;
+	std::vector<void*> make_resident;
+	// Made resident in the background. The caller should signal
+	// async_fence_value on the residency fence once they are in.
+	std::vector<void*> make_resident_async;
+	uint64_t async_fence_value;
+};
+
+struct residency_stats {
+	uint64_t budget;
+	uint64_t usage;
+	uint64_t tracked_bytes;
+	uint64_t resident_bytes;
+
+	uint32_t evictions;
+	uint32_t make_residents;
+	uint32_t async_make_residents;
+	uint64_t bytes_evicted;
+	uint64_t bytes_made_resident;
+	// Objects made resident again within thrash_window frames of
+	// being evicted.
+	uint32_t thrash_count;
+	// Updates where nothing more could be evicted and we stayed over.
+	uint32_t over_budget_frames;
+};
+
+struct residency_manager {
+	residency_manager();
+
+	std::vector<residency_object> objects;
+	uint32_t unused_objects;
+
+	// Least recently used at the head.
+	uint32_t lru_head;
+	uint32_t lru_tail;
+
+	// Objects waiting to be made resident at the next update.
+	std::vector<residency_handle> requests;
+
+	uint64_t frame;
+	uint64_t next_residency_fence;
+	uint32_t min_eviction_age;
+	uint32_t thrash_window;
+
+	residency_stats stats;
+};
+
+void initialize_residency_manager(
+	residency_manager* manager,
+	const uint32_t min_eviction_age,
+	const uint32_t thrash_window
+);
+
+// Starts tracking something that was just created (and so is resident).
+residency_handle track_residency(
+	residency_manager* manager,
+	void* object,
+	const uint64_t size
+);
+
+void untrack_residency(residency_manager* manager, const residency_handle handle);
+
+// Says the GPU will use the object in work that completes at
+// fence_value. Call before submitting that work, then update. If the
+// object was evicted, the update makes it resident again.
+void use_resident_object(
+	residency_manager* manager,
+	const residency_handle handle,
+	const uint64_t fence_value
+);
+
+// For streaming: asks for the object to be made resident in the
+// background. Returns the residency fence value to wait for before
+// using it.
+uint64_t request_residency_async(residency_manager* manager, const residency_handle handle);
+
+bool is_object_resident(const residency_manager* manager, const residency_handle handle);
+
+// Works out what to make resident and what to evict this frame.
+void update_residency(
+	residency_manager* manager,
+	const residency_frame_info& info,
+	residency_work* work
+);
@@ -0,0 +1,597 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "resource_state_tracker.h"
+
+#include <cassert>
+
+using namespace std;
+
+static tracked_resource* get_tracked_resource(
+	command_list_state_tracker* tracker,
+	const void* resource
+);
+static bool is_uniform(
+	const tracked_resource* tracked,
+	const bool check_queued_barriers
+);
+static bool is_state_satisfied(
+	const resource_state current,
+	const resource_state requested
+);
+static void transition_range(
+	command_list_state_tracker* tracker,
+	tracked_resource* tracked,
+	const void* resource,
+	const uint32_t barrier_subresource,
+	const resource_state state
+);
+static void get_range(
+	const tracked_resource* tracked,
+	const uint32_t barrier_subresource,
+	uint32_t* first,
+	uint32_t* last
+);
+
+tracked_resource::tracked_resource() {
+	list = 0;
+	subresource_count = 0;
+}
+
+command_list_state_tracker::command_list_state_tracker() {
+	registry = NULL;
+	list = 1;
+	stats = {};
+}
+
+void register_resource(
+	resource_state_registry* registry,
+	const void* resource,
+	const uint32_t subresource_count,
+	const resource_state initial_state
+) {
+	registered_resource* registered;
+
+	assert(subresource_count > 0);
+
+	registered = &(registry->resources[resource]);
+	registered->subresource_count = subresource_count;
+	registered->states.assign(subresource_count, initial_state);
+}
+
+void unregister_resource(
+	resource_state_registry* registry,
+	const void* resource
+) {
+	registry->resources.erase(resource);
+}
+
+resource_state get_registered_state(
+	const resource_state_registry* registry,
+	const void* resource,
+	const uint32_t subresource
+) {
+	unordered_map<const void*, registered_resource>::const_iterator it;
+
+	it = registry->resources.find(resource);
+	if (it == registry->resources.end()) {
+		return RESOURCE_STATE_UNKNOWN;
+	}
+
+	if (subresource == ALL_SUBRESOURCES) {
+		return it->second.states[0];
+	}
+
+	return it->second.states[subresource];
+}
+
+void reset_state_tracker(
+	command_list_state_tracker* tracker,
+	const resource_state_registry* registry
+) {
+	unordered_map<const void*, tracked_resource>::iterator it;
+
+	tracker->registry = registry;
+
+	//
+	// Rather than starting from an empty map every time (which would
+	// allocate every entry again, every frame), keep what recent lists
+	// used and only drop what they didn't.
+	//
+
+	it = tracker->resources.begin();
+	while (it != tracker->resources.end()) {
+		if (tracker->list - it->second.list >= TRACKED_RESOURCE_LIFETIME) {
+			it = tracker->resources.erase(it);
+		} else {
+			it++;
+		}
+	}
+
+	tracker->list++;
+	tracker->queued.clear();
+	tracker->pending.clear();
+}
+
+void transition_resource(
+	command_list_state_tracker* tracker,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state state
+) {
+	tracked_resource* tracked;
+	uint32_t i;
+
+	tracker->stats.transitions_requested++;
+	tracked = get_tracked_resource(tracker, resource);
+
+	//
+	// If the whole resource is asked for, and all of its subresources
+	// are in the same state, we can do it with one barrier. Otherwise
+	// each subresource needs its own.
+	//
+
+	if (subresource == ALL_SUBRESOURCES && !is_uniform(tracked, false)) {
+		for (i = 0; i < tracked->subresource_count; i++) {
+			transition_range(tracker, tracked, resource, i, state);
+		}
+	} else {
+		transition_range(tracker, tracked, resource, subresource, state);
+	}
+}
+
+void begin_resource_transition(
+	command_list_state_tracker* tracker,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state state
+) {
+	tracked_resource* tracked;
+	resource_barrier barrier;
+	resource_state current;
+	uint32_t first;
+	uint32_t last;
+	uint32_t i;
+
+	tracked = get_tracked_resource(tracker, resource);
+	get_range(tracked, subresource, &first, &last);
+	current = tracked->states[first];
+
+	//
+	// A split barrier needs a known before state, and the same state
+	// across every subresource it covers. If we don't have that, or
+	// there is nothing to transition, fall back to a regular
+	// transition. end_resource_transition then has nothing to do.
+	//
+
+	if (current == RESOURCE_STATE_UNKNOWN ||
+		is_state_satisfied(current, state) ||
+		(subresource == ALL_SUBRESOURCES && !is_uniform(tracked, false)))
+	{
+		transition_resource(tracker, resource, subresource, state);
+		return;
+	}
+
+	tracker->stats.transitions_requested++;
+
+	barrier = {};
+	barrier.type = RESOURCE_BARRIER_TRANSITION;
+	barrier.split = RESOURCE_BARRIER_SPLIT_BEGIN_ONLY;
+	barrier.resource = resource;
+	barrier.subresource = subresource;
+	barrier.before = current;
+	barrier.after = state;
+
+	tracker->queued.push_back(barrier);
+
+	// The state stays the old one until the transition ends, but we
+	// can no longer fold later transitions into an earlier barrier.
+	for (i = first; i <= last; i++) {
+		assert(tracked->split_targets[i] == RESOURCE_STATE_UNKNOWN);
+		tracked->split_targets[i] = state;
+		tracked->queued_barriers[i] = -1;
+	}
+}
+
+void end_resource_transition(
+	command_list_state_tracker* tracker,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state state
+) {
+	tracked_resource* tracked;
+	resource_barrier barrier;
+	uint32_t first;
+	uint32_t last;
+	uint32_t i;
+
+	tracked = get_tracked_resource(tracker, resource);
+	get_range(tracked, subresource, &first, &last);
+
+	// begin_resource_transition fell back to a normal transition.
+	if (tracked->split_targets[first] != state) {
+		return;
+	}
+
+	barrier = {};
+	barrier.type = RESOURCE_BARRIER_TRANSITION;
+	barrier.split = RESOURCE_BARRIER_SPLIT_END_ONLY;
+	barrier.resource = resource;
+	barrier.subresource = subresource;
+	barrier.before = tracked->states[first];
+	barrier.after = state;
+
+	tracker->queued.push_back(barrier);
+
+	for (i = first; i <= last; i++) {
+		tracked->states[i] = state;
+		tracked->split_targets[i] = RESOURCE_STATE_UNKNOWN;
+	}
+}
+
+void uav_barrier(command_list_state_tracker* tracker, const void* resource) {
+	resource_barrier barrier;
+
+	barrier = {};
+	barrier.type = RESOURCE_BARRIER_UAV;
+	barrier.split = RESOURCE_BARRIER_SPLIT_NONE;
+	barrier.resource = resource;
+	barrier.subresource = ALL_SUBRESOURCES;
+	barrier.before = RESOURCE_STATE_UNORDERED_ACCESS;
+	barrier.after = RESOURCE_STATE_UNORDERED_ACCESS;
+
+	tracker->queued.push_back(barrier);
+}
+
+size_t flush_resource_barriers(
+	command_list_state_tracker* tracker,
+	vector<resource_barrier>* barriers
+) {
+	const resource_barrier* barrier;
+	tracked_resource* tracked;
+	uint32_t first;
+	uint32_t last;
+	uint32_t i;
+	size_t j;
+
+	barriers->clear();
+
+	for (j = 0; j < tracker->queued.size(); j++) {
+		barrier = &(tracker->queued[j]);
+
+		// Barriers that collapsed into nothing are left behind with
+		// their resource cleared.
+		if (!barrier->resource) {
+			continue;
+		}
+
+		barriers->push_back(*barrier);
+
+		//
+		// Once recorded, a barrier can't be changed, so stop pointing
+		// the resource at it.
+		//
+
+		if (barrier->type == RESOURCE_BARRIER_TRANSITION) {
+			tracked = &(tracker->resources[barrier->resource]);
+			get_range(tracked, barrier->subresource, &first, &last);
+
+			for (i = first; i <= last; i++) {
+				tracked->queued_barriers[i] = -1;
+			}
+		}
+	}
+
+	tracker->queued.clear();
+
+	tracker->stats.barriers_emitted += (uint32_t)barriers->size();
+	if (!barriers->empty()) {
+		tracker->stats.barrier_batches++;
+	}
+
+	return barriers->size();
+}
+
+size_t resolve_pending_barriers(
+	resource_state_registry* registry,
+	command_list_state_tracker* tracker,
+	vector<resource_barrier>* barriers
+) {
+	unordered_map<const void*, registered_resource>::iterator registered_it;
+	unordered_map<const void*, tracked_resource>::iterator tracked_it;
+	const resource_barrier* pending;
+	registered_resource* registered;
+	tracked_resource* tracked;
+	resource_barrier barrier;
+	bool uniform;
+	uint32_t i;
+	size_t j;
+
+	barriers->clear();
+
+	//
+	// Work out the barriers that get the resources from the state they
+	// are in now to the state the command list first needs them in.
+	//
+
+	for (j = 0; j < tracker->pending.size(); j++) {
+		pending = &(tracker->pending[j]);
+
+		registered_it = registry->resources.find(pending->resource);
+
+		// We can't transition something we know nothing about. The
+		// caller has to register every resource it tracks.
+		assert(registered_it != registry->resources.end());
+		if (registered_it == registry->resources.end()) {
+			continue;
+		}
+
+		registered = &(registered_it->second);
+		barrier = *pending;
+
+		uniform = true;
+		if (pending->subresource == ALL_SUBRESOURCES) {
+			for (i = 1; i < registered->subresource_count; i++) {
+				uniform = uniform && registered->states[i] == registered->states[0];
+			}
+		}
+
+		// Note we only skip exact matches here. A partial match (say
+		// the resource is in two read states and we only need one)
+		// still needs a barrier, since the command list assumed it was
+		// in exactly the state it asked for.
+		if (pending->subresource != ALL_SUBRESOURCES || uniform) {
+			barrier.before = get_registered_state(
+				registry,
+				pending->resource,
+				pending->subresource
+			);
+
+			if (barrier.before != barrier.after) {
+				barriers->push_back(barrier);
+			}
+		} else {
+			for (i = 0; i < registered->subresource_count; i++) {
+				barrier.subresource = i;
+				barrier.before = registered->states[i];
+
+				if (barrier.before != barrier.after) {
+					barriers->push_back(barrier);
+				}
+			}
+		}
+	}
+
+	tracker->stats.pending_resolved += (uint32_t)tracker->pending.size();
+	tracker->stats.barriers_emitted += (uint32_t)barriers->size();
+	if (!barriers->empty()) {
+		tracker->stats.barrier_batches++;
+	}
+
+	//
+	// Now remember the states the command list leaves everything in.
+	//
+
+	for (tracked_it = tracker->resources.begin();
+		tracked_it != tracker->resources.end();
+		tracked_it++)
+	{
+		// Left over from an earlier command list.
+		if (tracked_it->second.list != tracker->list) {
+			continue;
+		}
+
+		registered_it = registry->resources.find(tracked_it->first);
+		if (registered_it == registry->resources.end()) {
+			continue;
+		}
+
+		tracked = &(tracked_it->second);
+		registered = &(registered_it->second);
+
+		for (i = 0; i < tracked->subresource_count; i++) {
+			assert(tracked->split_targets[i] == RESOURCE_STATE_UNKNOWN);
+
+			if (tracked->states[i] != RESOURCE_STATE_UNKNOWN) {
+				registered->states[i] = tracked->states[i];
+			}
+		}
+	}
+
+	tracker->pending.clear();
+	tracker->queued.clear();
+
+	return barriers->size();
+}
+
+static tracked_resource* get_tracked_resource(
+	command_list_state_tracker* tracker,
+	const void* resource
+) {
+	unordered_map<const void*, registered_resource>::const_iterator registered;
+	tracked_resource* tracked;
+	uint32_t subresource_count;
+
+	tracked = &(tracker->resources[resource]);
+
+	//
+	// First time this command list has seen the resource. Reusing the
+	// vectors from an earlier list means this doesn't allocate.
+	//
+
+	if (tracked->list != tracker->list) {
+		tracked->list = tracker->list;
+
+		subresource_count = 1;
+
+		if (tracker->registry) {
+			registered = tracker->registry->resources.find(resource);
+			if (registered != tracker->registry->resources.end()) {
+				subresource_count = registered->second.subresource_count;
+			}
+		}
+
+		tracked->subresource_count = subresource_count;
+		tracked->states.assign(subresource_count, RESOURCE_STATE_UNKNOWN);
+		tracked->queued_barriers.assign(subresource_count, -1);
+		tracked->split_targets.assign(subresource_count, RESOURCE_STATE_UNKNOWN);
+	}
+
+	return tracked;
+}
+
+static bool is_uniform(
+	const tracked_resource* tracked,
+	const bool check_queued_barriers
+) {
+	uint32_t i;
+
+	for (i = 1; i < tracked->subresource_count; i++) {
+		if (tracked->states[i] != tracked->states[0]) {
+			return false;
+		}
+
+		if (check_queued_barriers &&
+			tracked->queued_barriers[i] != tracked->queued_barriers[0])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool is_state_satisfied(
+	const resource_state current,
+	const resource_state requested
+) {
+	if (current == requested) {
+		return true;
+	}
+
+	// If we're in a combination of read states, asking for any part
+	// of that combination needs no barrier.
+	return
+		current != RESOURCE_STATE_COMMON &&
+		(current & RESOURCE_STATE_READ_MASK) == current &&
+		(requested & current) == requested &&
+		requested != RESOURCE_STATE_COMMON;
+}
+
+static void transition_range(
+	command_list_state_tracker* tracker,
+	tracked_resource* tracked,
+	const void* resource,
+	const uint32_t barrier_subresource,
+	const resource_state state
+) {
+	resource_barrier barrier;
+	resource_barrier* queued;
+	resource_state current;
+	int32_t queued_index;
+	uint32_t first;
+	uint32_t last;
+	uint32_t i;
+
+	get_range(tracked, barrier_subresource, &first, &last);
+	current = tracked->states[first];
+
+	// Using a resource in the middle of a split barrier is a bug.
+	assert(tracked->split_targets[first] == RESOURCE_STATE_UNKNOWN);
+
+	//
+	// First use in this command list: we can't know the before state
+	// until submission, so leave a pending barrier.
+	//
+
+	if (current == RESOURCE_STATE_UNKNOWN) {
+		barrier = {};
+		barrier.type = RESOURCE_BARRIER_TRANSITION;
+		barrier.split = RESOURCE_BARRIER_SPLIT_NONE;
+		barrier.resource = resource;
+		barrier.subresource = barrier_subresource;
+		barrier.before = RESOURCE_STATE_UNKNOWN;
+		barrier.after = state;
+
+		tracker->pending.push_back(barrier);
+
+		for (i = first; i <= last; i++) {
+			tracked->states[i] = state;
+		}
+
+		return;
+	}
+
+	//
+	// Already there, so there's nothing to do.
+	//
+
+	if (is_state_satisfied(current, state)) {
+		tracker->stats.transitions_elided++;
+		return;
+	}
+
+	//
+	// If the last barrier for exactly this range hasn't been flushed
+	// yet, fold this transition into it instead of adding another.
+	// If that brings us back where we started, the barrier goes away.
+	//
+
+	queued_index = tracked->queued_barriers[first];
+
+	if (queued_index >= 0 &&
+		tracker->queued[queued_index].subresource == barrier_subresource &&
+		(barrier_subresource != ALL_SUBRESOURCES || is_uniform(tracked, true)))
+	{
+		queued = &(tracker->queued[queued_index]);
+		queued->after = state;
+		tracker->stats.transitions_elided++;
+
+		if (queued->before == state) {
+			queued->resource = NULL;
+			queued_index = -1;
+		}
+
+		for (i = first; i <= last; i++) {
+			tracked->states[i] = state;
+			tracked->queued_barriers[i] = queued_index;
+		}
+
+		return;
+	}
+
+	//
+	// Otherwise it's a brand new barrier.
+	//
+
+	barrier = {};
+	barrier.type = RESOURCE_BARRIER_TRANSITION;
+	barrier.split = RESOURCE_BARRIER_SPLIT_NONE;
+	barrier.resource = resource;
+	barrier.subresource = barrier_subresource;
+	barrier.before = current;
+	barrier.after = state;
+
+	queued_index = (int32_t)tracker->queued.size();
+	tracker->queued.push_back(barrier);
+
+	for (i = first; i <= last; i++) {
+		tracked->states[i] = state;
+		tracked->queued_barriers[i] = queued_index;
+	}
+}
+
+static void get_range(
+	const tracked_resource* tracked,
+	const uint32_t barrier_subresource,
+	uint32_t* first,
+	uint32_t* last
+) {
+	if (barrier_subresource == ALL_SUBRESOURCES) {
+		*first = 0;
+		*last = tracked->subresource_count - 1;
+	} else {
+		assert(barrier_subresource < tracked->subresource_count);
+		*first = barrier_subresource;
+		*last = barrier_subresource;
+	}
+}
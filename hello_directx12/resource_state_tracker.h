@@ -0,0 +1,244 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Keeps track of what state every GPU resource is in, so we don't
+// have to write out each resource barrier by hand.
+//
+// There are two halves to this:
+//
+// 1. The resource_state_registry knows the state every resource is in
+//    as of the last command list we submitted.
+//
+// 2. A command_list_state_tracker is used while recording a single
+//    command list. When you say "I need this resource in this state",
+//    it works out the barrier for you. The first time a command list
+//    touches a resource, it can't know what state the resource will be
+//    in when the list actually runs. So instead of guessing, it writes
+//    down a "pending" barrier. When the list is submitted, the pending
+//    barriers are resolved against the registry, and the list's final
+//    states are written back to it.
+//
+// Along the way the tracker drops transitions that don't do anything
+// (e.g. asking for a state we are already in), collapses A->B->C into
+// A->C, and hands back all the barriers at once so they go out in a
+// single ResourceBarrier call.
+//
+// None of this talks to DirectX: resources are just pointers, and the
+// state values are the same bits as D3D12_RESOURCE_STATES. The DX12
+// side converts these barriers into D3D12_RESOURCE_BARRIERs (see
+// record_resource_barriers in dx12_handler).
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// These match D3D12_RESOURCE_STATES bit for bit.
+typedef uint32_t resource_state;
+
+const resource_state RESOURCE_STATE_COMMON = 0;
+const resource_state RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER = 0x1;
+const resource_state RESOURCE_STATE_INDEX_BUFFER = 0x2;
+const resource_state RESOURCE_STATE_RENDER_TARGET = 0x4;
+const resource_state RESOURCE_STATE_UNORDERED_ACCESS = 0x8;
+const resource_state RESOURCE_STATE_DEPTH_WRITE = 0x10;
+const resource_state RESOURCE_STATE_DEPTH_READ = 0x20;
+const resource_state RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE = 0x40;
+const resource_state RESOURCE_STATE_PIXEL_SHADER_RESOURCE = 0x80;
+const resource_state RESOURCE_STATE_STREAM_OUT = 0x100;
+const resource_state RESOURCE_STATE_INDIRECT_ARGUMENT = 0x200;
+const resource_state RESOURCE_STATE_COPY_DEST = 0x400;
+const resource_state RESOURCE_STATE_COPY_SOURCE = 0x800;
+const resource_state RESOURCE_STATE_RESOLVE_DEST = 0x1000;
+const resource_state RESOURCE_STATE_RESOLVE_SOURCE = 0x2000;
+const resource_state RESOURCE_STATE_GENERIC_READ = 0xac3;
+const resource_state RESOURCE_STATE_PRESENT = 0;
+
+// Every state bit that only reads from the resource. Read states can
+// be combined, write states must be used on their own.
+const resource_state RESOURCE_STATE_READ_MASK =
+	RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+	RESOURCE_STATE_INDEX_BUFFER |
+	RESOURCE_STATE_DEPTH_READ |
+	RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+	RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+	RESOURCE_STATE_INDIRECT_ARGUMENT |
+	RESOURCE_STATE_COPY_SOURCE |
+	RESOURCE_STATE_RESOLVE_SOURCE;
+
+// Used inside the tracker for "we don't know yet".
+const resource_state RESOURCE_STATE_UNKNOWN = 0xffffffff;
+
+// Same value as D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES.
+const uint32_t ALL_SUBRESOURCES = 0xffffffff;
+
+enum resource_barrier_type {
+	RESOURCE_BARRIER_TRANSITION,
+	RESOURCE_BARRIER_UAV,
+	// The resource is about to start using memory that another
+	// resource was using. Only the resource taking over is given.
+	RESOURCE_BARRIER_ALIASING
+};
+
+// Split barriers let the GPU start a transition early (BEGIN_ONLY) and
+// only wait for it where the resource is actually needed (END_ONLY).
+enum resource_barrier_split {
+	RESOURCE_BARRIER_SPLIT_NONE,
+	RESOURCE_BARRIER_SPLIT_BEGIN_ONLY,
+	RESOURCE_BARRIER_SPLIT_END_ONLY
+};
+
+struct resource_barrier {
+	resource_barrier_type type;
+	resource_barrier_split split;
+	const void* resource;
+	uint32_t subresource;
+	resource_state before;
+	resource_state after;
+};
+
+struct registered_resource {
+	uint32_t subresource_count;
+	// The state of each subresource as of the last submission.
+	std::vector<resource_state> states;
+};
+
+struct resource_state_registry {
+	std::unordered_map<const void*, registered_resource> resources;
+};
+
+// How many command lists a tracker keeps an entry around for after its
+// resource was last used. Enough to cover the back buffers taking
+// turns.
+const uint64_t TRACKED_RESOURCE_LIFETIME = 16;
+
+// What a single command list knows about a single resource.
+struct tracked_resource {
+	tracked_resource();
+
+	// The command list this was last set up for. Entries outlive a
+	// command list so their vectors can be reused by the next one.
+	uint64_t list;
+	uint32_t subresource_count;
+	// The state each subresource will be in at this point of the
+	// command list, or RESOURCE_STATE_UNKNOWN if the list hasn't
+	// touched it yet.
+	std::vector<resource_state> states;
+	// Index into the tracker's queued barriers for the barrier that
+	// last transitioned each subresource, or -1 if it was flushed.
+	// This is how we collapse A->B->C into A->C.
+	std::vector<int32_t> queued_barriers;
+	// The target of an in-flight split barrier, or
+	// RESOURCE_STATE_UNKNOWN if there isn't one.
+	std::vector<resource_state> split_targets;
+};
+
+struct state_tracker_stats {
+	// Number of transitions asked for.
+	uint32_t transitions_requested;
+	// Transitions that turned out to do nothing and were dropped.
+	uint32_t transitions_elided;
+	// Barriers actually handed back to be recorded.
+	uint32_t barriers_emitted;
+	// Number of batches the barriers went out in.
+	uint32_t barrier_batches;
+	// Pending barriers that were resolved at submission.
+	uint32_t pending_resolved;
+};
+
+struct command_list_state_tracker {
+	command_list_state_tracker();
+
+	// Only used to look up subresource counts, which never change.
+	// The registry's states are only touched at submission.
+	const resource_state_registry* registry;
+
+	std::unordered_map<const void*, tracked_resource> resources;
+	// Counts up with each reset. Entries in resources from an older
+	// list are stale.
+	uint64_t list;
+
+	// Barriers waiting to be flushed into the command list.
+	std::vector<resource_barrier> queued;
+	// First uses of a resource. Only the after state is known.
+	std::vector<resource_barrier> pending;
+
+	state_tracker_stats stats;
+};
+
+void register_resource(
+	resource_state_registry* registry,
+	const void* resource,
+	const uint32_t subresource_count,
+	const resource_state initial_state
+);
+
+void unregister_resource(
+	resource_state_registry* registry,
+	const void* resource
+);
+
+// Returns the registered state of a subresource, or
+// RESOURCE_STATE_UNKNOWN for an unregistered resource.
+resource_state get_registered_state(
+	const resource_state_registry* registry,
+	const void* resource,
+	const uint32_t subresource
+);
+
+// Call this whenever a command list is reset, before recording.
+void reset_state_tracker(
+	command_list_state_tracker* tracker,
+	const resource_state_registry* registry
+);
+
+// Asks for a resource (or one subresource of it) to be in state for the
+// commands that follow. Remember to flush the barriers before recording
+// those commands.
+void transition_resource(
+	command_list_state_tracker* tracker,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state state
+);
+
+// Starts a split transition. The resource must not be used until
+// end_resource_transition is called with the same arguments.
+void begin_resource_transition(
+	command_list_state_tracker* tracker,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state state
+);
+
+void end_resource_transition(
+	command_list_state_tracker* tracker,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state state
+);
+
+// Waits for all UAV writes to the resource to finish.
+void uav_barrier(command_list_state_tracker* tracker, const void* resource);
+
+// Moves every queued barrier into barriers (which is cleared first).
+// Record them with a single ResourceBarrier call. Returns how many
+// there are.
+size_t flush_resource_barriers(
+	command_list_state_tracker* tracker,
+	std::vector<resource_barrier>* barriers
+);
+
+// Called when the command list is submitted. Writes the barriers that
+// must run *before* the command list into barriers (cleared first),
+// then updates the registry with the states the command list leaves
+// things in. Any barriers still queued in the tracker are dropped, so
+// flush before closing the command list.
+size_t resolve_pending_barriers(
+	resource_state_registry* registry,
+	command_list_state_tracker* tracker,
+	std::vector<resource_barrier>* barriers
+);
@@ -0,0 +1,253 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "shader_archive.h"
+#include "hash_utils.h"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+static uint64_t align_archive_offset(const uint64_t offset);
+
+shader_archive::shader_archive() {
+	header = NULL;
+	entries = NULL;
+}
+
+uint64_t get_shader_permutation_key(
+	const string& source_name,
+	const string& entry_point,
+	const string& target,
+	const vector<shader_define>& defines
+) {
+	vector<shader_define> sorted_defines;
+	uint64_t hash;
+	size_t i;
+
+	sorted_defines = defines;
+	sort(
+		sorted_defines.begin(),
+		sorted_defines.end(),
+		[](const shader_define& a, const shader_define& b) {
+			return a.name < b.name;
+		}
+	);
+
+	hash = hash_string(source_name);
+	hash = hash_string(entry_point, hash);
+	hash = hash_string(target, hash);
+
+	for (i = 0; i < sorted_defines.size(); i++) {
+		hash = hash_string(sorted_defines[i].name, hash);
+		hash = hash_string(sorted_defines[i].value, hash);
+	}
+
+	return hash;
+}
+
+bool open_shader_archive(shader_archive* archive, const string& path) {
+	const shader_archive_header* header;
+	const shader_archive_entry* entries;
+	const shader_archive_entry* entry;
+	uint64_t table_end;
+	uint64_t file_size;
+	uint32_t i;
+
+	archive->header = NULL;
+	archive->entries = NULL;
+
+	if (!open_mapped_file(&(archive->file), path)) {
+		return false;
+	}
+
+	//
+	// Check the header and make sure the table and every blob it
+	// points to actually lie inside the file. After this, lookups
+	// can trust the offsets without checking them again.
+	//
+
+	file_size = archive->file.size;
+	header = (const shader_archive_header*)archive->file.data;
+
+	if (file_size < sizeof(shader_archive_header) ||
+		header->magic != SHADER_ARCHIVE_MAGIC ||
+		header->version != SHADER_ARCHIVE_VERSION)
+	{
+		close_shader_archive(archive);
+		return false;
+	}
+
+	table_end = sizeof(shader_archive_header) +
+		(uint64_t)header->entry_count * sizeof(shader_archive_entry);
+
+	if (table_end > file_size) {
+		close_shader_archive(archive);
+		return false;
+	}
+
+	entries = (const shader_archive_entry*)(header + 1);
+
+	for (i = 0; i < header->entry_count; i++) {
+		entry = &entries[i];
+
+		if (entry->bytecode_offset > file_size ||
+			entry->bytecode_size > file_size - entry->bytecode_offset ||
+			entry->reflection_offset > file_size ||
+			entry->reflection_size > file_size - entry->reflection_offset ||
+			(i > 0 && entries[i - 1].key >= entry->key))
+		{
+			close_shader_archive(archive);
+			return false;
+		}
+	}
+
+	archive->header = header;
+	archive->entries = entries;
+
+	return true;
+}
+
+bool find_shader_in_archive(
+	const shader_archive* archive,
+	const uint64_t key,
+	shader_archive_view* view
+) {
+	const shader_archive_entry* begin;
+	const shader_archive_entry* end;
+	const shader_archive_entry* entry;
+
+	if (!archive->header) {
+		return false;
+	}
+
+	//
+	// The entries are sorted by key, so a binary search finds it.
+	//
+
+	begin = archive->entries;
+	end = begin + archive->header->entry_count;
+	entry = lower_bound(
+		begin,
+		end,
+		key,
+		[](const shader_archive_entry& e, const uint64_t k) {
+			return e.key < k;
+		}
+	);
+
+	if (entry == end || entry->key != key) {
+		return false;
+	}
+
+	view->source_hash = entry->source_hash;
+	view->bytecode = archive->file.data + entry->bytecode_offset;
+	view->bytecode_size = (size_t)entry->bytecode_size;
+	view->reflection = archive->file.data + entry->reflection_offset;
+	view->reflection_size = (size_t)entry->reflection_size;
+
+	return true;
+}
+
+void close_shader_archive(shader_archive* archive) {
+	close_mapped_file(&(archive->file));
+	archive->header = NULL;
+	archive->entries = NULL;
+}
+
+bool write_shader_archive(
+	const string& path,
+	vector<shader_archive_input>* inputs
+) {
+	shader_archive_header header;
+	vector<shader_archive_entry> entries;
+	shader_archive_input* input;
+	uint64_t offset;
+	ofstream file;
+	const char padding[SHADER_ARCHIVE_ALIGNMENT] = {};
+	size_t i;
+
+	sort(
+		inputs->begin(),
+		inputs->end(),
+		[](const shader_archive_input& a, const shader_archive_input& b) {
+			return a.key < b.key;
+		}
+	);
+
+	for (i = 1; i < inputs->size(); i++) {
+		if ((*inputs)[i - 1].key == (*inputs)[i].key) {
+			return false;
+		}
+	}
+
+	//
+	// Lay out the blobs after the table of entries.
+	//
+
+	header = {};
+	header.magic = SHADER_ARCHIVE_MAGIC;
+	header.version = SHADER_ARCHIVE_VERSION;
+	header.entry_count = (uint32_t)inputs->size();
+
+	offset = sizeof(header) + inputs->size() * sizeof(shader_archive_entry);
+	entries.resize(inputs->size());
+
+	for (i = 0; i < inputs->size(); i++) {
+		input = &(*inputs)[i];
+
+		entries[i].key = input->key;
+		entries[i].source_hash = input->source_hash;
+
+		offset = align_archive_offset(offset);
+		entries[i].bytecode_offset = offset;
+		entries[i].bytecode_size = input->bytecode.size();
+		offset += input->bytecode.size();
+
+		offset = align_archive_offset(offset);
+		entries[i].reflection_offset = offset;
+		entries[i].reflection_size = input->reflection.size();
+		offset += input->reflection.size();
+	}
+
+	//
+	// Now write everything out in the same order.
+	//
+
+	file.open(path, ios::out | ios::binary | ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write(
+		(const char*)entries.data(),
+		entries.size() * sizeof(shader_archive_entry)
+	);
+
+	offset = sizeof(header) + entries.size() * sizeof(shader_archive_entry);
+
+	for (i = 0; i < inputs->size(); i++) {
+		input = &(*inputs)[i];
+
+		file.write(padding, entries[i].bytecode_offset - offset);
+		file.write((const char*)input->bytecode.data(), input->bytecode.size());
+		offset = entries[i].bytecode_offset + entries[i].bytecode_size;
+
+		file.write(padding, entries[i].reflection_offset - offset);
+		file.write(
+			(const char*)input->reflection.data(),
+			input->reflection.size()
+		);
+		offset = entries[i].reflection_offset + entries[i].reflection_size;
+	}
+
+	file.close();
+
+	return !file.fail();
+}
+
+static uint64_t align_archive_offset(const uint64_t offset) {
+	return (offset + SHADER_ARCHIVE_ALIGNMENT - 1) &
+		~((uint64_t)SHADER_ARCHIVE_ALIGNMENT - 1);
+}
@@ -0,0 +1,110 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A shader archive is a single file holding many precompiled shaders.
+// It is produced offline by tools/shader_packer, which runs DXC over
+// every permutation listed in shader_permutations.txt. At start up we
+// memory map the archive and look shaders up by key, so there is no
+// compiling and no per-shader file to open.
+//
+// The layout of the file is:
+//
+//	shader_archive_header
+//	shader_archive_entry[entry_count]  (sorted by key)
+//	DXIL and reflection blobs          (each 16 byte aligned)
+//
+// The key for a shader is computed by get_shader_permutation_key from
+// its source name, entry point, target, and defines. Both the packer
+// and the runtime use that function, so they always agree.
+//
+// The key says nothing about what the source said when it was packed,
+// so each entry also keeps hash_shader_source of the source and its
+// includes. If the source next to the program no longer matches, the
+// archive is older than it and the shader should be compiled instead.
+//
+
+#pragma once
+
+#include "file_mapping.h"
+#include "shader_cache.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// "SHPK" in little-endian.
+const uint32_t SHADER_ARCHIVE_MAGIC = 0x4b504853;
+const uint32_t SHADER_ARCHIVE_VERSION = 2;
+const uint32_t SHADER_ARCHIVE_ALIGNMENT = 16;
+
+struct shader_archive_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t reserved;
+};
+
+struct shader_archive_entry {
+	uint64_t key;
+	uint64_t source_hash;
+	uint64_t bytecode_offset;
+	uint64_t bytecode_size;
+	uint64_t reflection_offset;
+	uint64_t reflection_size;
+};
+
+struct shader_archive {
+	shader_archive();
+
+	mapped_file file;
+	const shader_archive_header* header;
+	const shader_archive_entry* entries;
+};
+
+// One shader for write_shader_archive.
+struct shader_archive_input {
+	uint64_t key;
+	uint64_t source_hash;
+	std::vector<uint8_t> bytecode;
+	std::vector<uint8_t> reflection;
+};
+
+// A shader found in the archive. The pointers point into the mapped
+// file, so they are only valid while the archive is open.
+struct shader_archive_view {
+	// What the source and its includes hashed to when it was packed.
+	uint64_t source_hash;
+	const void* bytecode;
+	size_t bytecode_size;
+	const void* reflection;
+	size_t reflection_size;
+};
+
+// The define order does not matter here: they are sorted by name
+// before hashing. The source name should be given the same way the
+// permutation file gives it (e.g. "texture_shader.hlsl").
+uint64_t get_shader_permutation_key(
+	const std::string& source_name,
+	const std::string& entry_point,
+	const std::string& target,
+	const std::vector<shader_define>& defines
+);
+
+// Maps the archive at path and validates it. Returns false if the
+// file is missing or not a valid archive.
+bool open_shader_archive(shader_archive* archive, const std::string& path);
+
+bool find_shader_in_archive(
+	const shader_archive* archive,
+	const uint64_t key,
+	shader_archive_view* view
+);
+
+void close_shader_archive(shader_archive* archive);
+
+// Writes an archive holding all of inputs. The inputs don't need to
+// be sorted, but their keys must be unique.
+bool write_shader_archive(
+	const std::string& path,
+	std::vector<shader_archive_input>* inputs
+);
@@ -0,0 +1,455 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "shader_cache.h"
+#include "hash_utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// "SHDC" in little-endian.
+const uint32_t SHADER_CACHE_MAGIC = 0x43444853;
+// Bump this whenever the layout of the cache files changes.
+const uint32_t SHADER_CACHE_VERSION = 1;
+// How deep we follow #includes before giving up. This is only here
+// to protect us from include cycles the visited list doesn't catch.
+const uint32_t SHADER_CACHE_MAX_INCLUDE_DEPTH = 32;
+
+// Every cache file starts with this header, followed immediately by
+// the bytecode. The header is 32 bytes so the bytecode stays nicely
+// aligned inside the mapping.
+struct shader_cache_file_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;
+	uint64_t bytecode_size;
+	uint64_t reserved;
+};
+
+static bool read_whole_file(const fs::path& path, string* contents);
+static bool hash_source_file(
+	const fs::path& path,
+	const uint32_t depth,
+	vector<fs::path>* visited,
+	uint64_t* hash
+);
+static bool parse_include_name(const string& line, string* include_name);
+static string get_cache_file_path(const shader_cache* cache, const uint64_t key);
+static bool write_cache_file(
+	const shader_cache* cache,
+	const uint64_t key,
+	const vector<uint8_t>& bytecode
+);
+
+shader_cache::shader_cache() {
+	compile = NULL;
+	compiler_id = 0;
+	hits = 0;
+	misses = 0;
+}
+
+shader_bytecode::shader_bytecode() {
+	key = 0;
+	cache_hit = false;
+}
+
+void initialize_shader_cache(
+	shader_cache* cache,
+	const string& directory,
+	shader_compile_fn compile,
+	const uint64_t compiler_id
+) {
+	error_code err;
+
+	cache->directory = directory;
+	cache->compile = compile;
+	cache->compiler_id = compiler_id;
+	cache->hits = 0;
+	cache->misses = 0;
+
+	// If we can't make the directory, that's fine. Every lookup will
+	// just be a miss and we fall back to compiling like before.
+	fs::create_directories(directory, err);
+}
+
+bool compute_shader_cache_key(
+	const shader_cache* cache,
+	const shader_compile_request& request,
+	uint64_t* key
+) {
+	uint64_t hash;
+	size_t i;
+
+	//
+	// First hash the source file and everything it includes.
+	//
+
+	if (!hash_shader_source(request.source_path, &hash)) {
+		return false;
+	}
+
+	//
+	// Now hash all the compiler inputs. The order of the defines
+	// matters to us even though it may not matter to the compiler.
+	// That's okay: at worst we compile something twice.
+	//
+
+	for (i = 0; i < request.defines.size(); i++) {
+		hash = hash_string(request.defines[i].name, hash);
+		hash = hash_string(request.defines[i].value, hash);
+	}
+
+	hash = hash_string(request.entry_point, hash);
+	hash = hash_string(request.target, hash);
+	hash = hash_combine(hash, request.flags);
+	hash = hash_combine(hash, cache->compiler_id);
+	hash = hash_combine(hash, SHADER_CACHE_VERSION);
+
+	*key = hash;
+
+	return true;
+}
+
+bool hash_shader_source(const string& source_path, uint64_t* hash) {
+	vector<fs::path> visited;
+
+	*hash = FNV_OFFSET_BASIS;
+
+	return hash_source_file(source_path, 0, &visited, hash);
+}
+
+bool load_shader(
+	shader_cache* cache,
+	const shader_compile_request& request,
+	shader_bytecode* bytecode,
+	string* errors
+) {
+	uint64_t key;
+	string cache_file_path;
+	const shader_cache_file_header* header;
+	bool result;
+
+	release_shader_bytecode(bytecode);
+
+	//
+	// If we can't even compute the key, the source file is missing.
+	// Let the compiler report that, since it gives a nicer message.
+	//
+
+	if (compute_shader_cache_key(cache, request, &key)) {
+		bytecode->key = key;
+		cache_file_path = get_cache_file_path(cache, key);
+
+		//
+		// Look for the shader in the cache. A file that is truncated
+		// or was written with a different key (in the very unlikely
+		// case of a collision) counts as a miss.
+		//
+
+		if (open_mapped_file(&(bytecode->mapping), cache_file_path)) {
+			header = (const shader_cache_file_header*)bytecode->mapping.data;
+
+			if (bytecode->mapping.size >= sizeof(shader_cache_file_header) &&
+				header->magic == SHADER_CACHE_MAGIC &&
+				header->version == SHADER_CACHE_VERSION &&
+				header->key == key &&
+				header->bytecode_size ==
+					bytecode->mapping.size - sizeof(shader_cache_file_header))
+			{
+				bytecode->cache_hit = true;
+				cache->hits++;
+				return true;
+			}
+
+			close_mapped_file(&(bytecode->mapping));
+		}
+	} else {
+		key = 0;
+	}
+
+	//
+	// We missed, so compile it ourselves.
+	//
+
+	cache->misses++;
+
+	if (!cache->compile) {
+		return false;
+	}
+
+	result = cache->compile(request, &(bytecode->compiled), errors);
+	if (!result) {
+		return false;
+	}
+
+	//
+	// Save it for next time. Failing to write the cache file is not
+	// an error: we still have the bytecode.
+	//
+
+	if (key != 0) {
+		write_cache_file(cache, key, bytecode->compiled);
+	}
+
+	return true;
+}
+
+bool load_shaders_parallel(
+	shader_cache* cache,
+	const shader_compile_request* requests,
+	shader_bytecode* bytecodes,
+	const size_t count,
+	string* errors
+) {
+	vector<thread> threads;
+	vector<string> thread_errors;
+	vector<char> thread_results;
+	bool success;
+	size_t i;
+
+	thread_errors.resize(count);
+	thread_results.resize(count);
+
+	//
+	// Each shader gets its own thread. We only ever have a handful of
+	// shaders to load at once, so a thread each is fine.
+	//
+
+	for (i = 0; i < count; i++) {
+		threads.emplace_back([=, &thread_errors, &thread_results]() {
+			thread_results[i] = load_shader(
+				cache,
+				requests[i],
+				&bytecodes[i],
+				&thread_errors[i]
+			);
+		});
+	}
+
+	for (i = 0; i < count; i++) {
+		threads[i].join();
+	}
+
+	//
+	// Gather up the results.
+	//
+
+	success = true;
+
+	for (i = 0; i < count; i++) {
+		if (!thread_results[i]) {
+			success = false;
+
+			if (errors) {
+				*errors += requests[i].source_path + " (" +
+					requests[i].entry_point + "): " + thread_errors[i] + "\n";
+			}
+		}
+	}
+
+	return success;
+}
+
+const void* get_shader_bytecode_data(const shader_bytecode* bytecode) {
+	if (bytecode->cache_hit) {
+		return bytecode->mapping.data + sizeof(shader_cache_file_header);
+	}
+
+	return bytecode->compiled.data();
+}
+
+size_t get_shader_bytecode_size(const shader_bytecode* bytecode) {
+	if (bytecode->cache_hit) {
+		return bytecode->mapping.size - sizeof(shader_cache_file_header);
+	}
+
+	return bytecode->compiled.size();
+}
+
+void release_shader_bytecode(shader_bytecode* bytecode) {
+	close_mapped_file(&(bytecode->mapping));
+	bytecode->compiled.clear();
+	bytecode->key = 0;
+	bytecode->cache_hit = false;
+}
+
+static bool read_whole_file(const fs::path& path, string* contents) {
+	ifstream file;
+	stringstream stream;
+
+	file.open(path, ios::in | ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	stream << file.rdbuf();
+	*contents = stream.str();
+
+	return true;
+}
+
+static bool hash_source_file(
+	const fs::path& path,
+	const uint32_t depth,
+	vector<fs::path>* visited,
+	uint64_t* hash
+) {
+	string contents;
+	string line;
+	string include_name;
+	istringstream lines;
+	fs::path include_path;
+	error_code err;
+	size_t i;
+
+	if (depth > SHADER_CACHE_MAX_INCLUDE_DEPTH) {
+		return false;
+	}
+
+	//
+	// Each file only needs to be hashed once, no matter how many
+	// times it is included.
+	//
+
+	for (i = 0; i < visited->size(); i++) {
+		if ((*visited)[i] == path) {
+			return true;
+		}
+	}
+
+	visited->push_back(path);
+
+	if (!read_whole_file(path, &contents)) {
+		return false;
+	}
+
+	*hash = hash_string(contents, *hash);
+
+	//
+	// Now look for any #include lines and hash those files too. This
+	// is a very simple scan: it doesn't understand #if blocks or
+	// comments. That just means we might hash a file we didn't need
+	// to, which only costs us an unneeded recompile.
+	//
+
+	lines.str(contents);
+
+	while (getline(lines, line)) {
+		if (!parse_include_name(line, &include_name)) {
+			continue;
+		}
+
+		include_path = path.parent_path() / include_name;
+
+		// If the include isn't next to the source file, the compiler
+		// must be finding it somewhere else. All we can do is hash the
+		// name so the key at least changes if the include does.
+		if (!fs::exists(include_path, err)) {
+			*hash = hash_string(include_name, *hash);
+			continue;
+		}
+
+		if (!hash_source_file(include_path, depth + 1, visited, hash)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool parse_include_name(const string& line, string* include_name) {
+	size_t pos;
+	size_t end;
+	char closing;
+
+	pos = line.find_first_not_of(" \t");
+	if (pos == string::npos || line.compare(pos, 1, "#") != 0) {
+		return false;
+	}
+
+	pos = line.find_first_not_of(" \t", pos + 1);
+	if (pos == string::npos || line.compare(pos, 7, "include") != 0) {
+		return false;
+	}
+
+	pos = line.find_first_of("\"<", pos + 7);
+	if (pos == string::npos) {
+		return false;
+	}
+
+	closing = line[pos] == '"' ? '"' : '>';
+	end = line.find(closing, pos + 1);
+	if (end == string::npos) {
+		return false;
+	}
+
+	*include_name = line.substr(pos + 1, end - pos - 1);
+
+	return true;
+}
+
+static string get_cache_file_path(const shader_cache* cache, const uint64_t key) {
+	char name[32];
+
+	snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key);
+
+	return (fs::path(cache->directory) / name).string();
+}
+
+static bool write_cache_file(
+	const shader_cache* cache,
+	const uint64_t key,
+	const vector<uint8_t>& bytecode
+) {
+	shader_cache_file_header header;
+	string final_path;
+	string temp_path;
+	ofstream file;
+	error_code err;
+	size_t thread_hash;
+
+	header = {};
+	header.magic = SHADER_CACHE_MAGIC;
+	header.version = SHADER_CACHE_VERSION;
+	header.key = key;
+	header.bytecode_size = bytecode.size();
+
+	//
+	// Write to a temporary file first and then move it into place.
+	// That way a reader (maybe another instance of the program) never
+	// maps a half-written file.
+	//
+
+	final_path = get_cache_file_path(cache, key);
+	thread_hash = hash<thread::id>()(this_thread::get_id());
+	temp_path = final_path + "." + to_string(thread_hash) + ".tmp";
+
+	file.open(temp_path, ios::out | ios::binary | ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)bytecode.data(), bytecode.size());
+	file.close();
+
+	if (file.fail()) {
+		fs::remove(temp_path, err);
+		return false;
+	}
+
+	fs::rename(temp_path, final_path, err);
+	if (err) {
+		fs::remove(temp_path, err);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,133 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// The shader cache keeps compiled shader bytecode on disk so we
+// don't have to run the HLSL compiler every time the program starts.
+// Compiling was the slowest part of start up, and the shaders almost
+// never change between runs.
+//
+// Each compiled shader is stored in its own file named after a key.
+// The key is a hash of everything that can change the output: the
+// shader source, every file it #includes, the defines, the entry
+// point, the target profile, the compile flags, and the compiler
+// version. If any of those change, we get a different key and thus
+// a cache miss, so we never have to "invalidate" anything by hand.
+//
+// On a hit, the file is memory mapped and the bytecode is handed out
+// directly from the mapping. On a miss, we call the compile function
+// the cache was set up with, and write the result out for next time.
+//
+// The cache itself knows nothing about DirectX: the actual compiler
+// is passed in as a function. That means it builds anywhere and the
+// compiler can be swapped for a stub.
+//
+
+#pragma once
+
+#include "file_mapping.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct shader_define {
+	std::string name;
+	std::string value;
+};
+
+// Everything needed to compile a single shader entry point.
+struct shader_compile_request {
+	std::string source_path;
+	std::string entry_point;
+	std::string target;
+	std::vector<shader_define> defines;
+	uint32_t flags;
+};
+
+// Compiles request and writes the bytecode. On failure, returns false
+// and (if the compiler provides them) writes the error messages.
+typedef bool (*shader_compile_fn)(
+	const shader_compile_request& request,
+	std::vector<uint8_t>* bytecode,
+	std::string* errors
+);
+
+// The result of a shader lookup. The bytecode either lives in a
+// mapped cache file (on a hit) or in compiled (on a miss). Use
+// get_shader_bytecode_data/size rather than looking at either
+// directly.
+struct shader_bytecode {
+	shader_bytecode();
+
+	mapped_file mapping;
+	std::vector<uint8_t> compiled;
+	uint64_t key;
+	bool cache_hit;
+};
+
+struct shader_cache {
+	shader_cache();
+
+	// Where the compiled shaders are written to.
+	std::string directory;
+
+	shader_compile_fn compile;
+
+	// Identifies the compiler (and its version). This goes into every
+	// key so that upgrading the compiler invalidates the cache.
+	uint64_t compiler_id;
+
+	// Simple statistics. These are atomics since shaders may be looked
+	// up from several threads at once.
+	std::atomic<uint32_t> hits;
+	std::atomic<uint32_t> misses;
+};
+
+void initialize_shader_cache(
+	shader_cache* cache,
+	const std::string& directory,
+	shader_compile_fn compile,
+	const uint64_t compiler_id
+);
+
+// Computes the cache key for request. This reads the source file (and
+// any files it includes), so it returns false if any of them could
+// not be read.
+bool compute_shader_cache_key(
+	const shader_cache* cache,
+	const shader_compile_request& request,
+	uint64_t* key
+);
+
+// Hashes the source file at source_path and every file it includes,
+// which is the part of the cache key that comes from the files. Returns
+// false if any of them could not be read. The shader archive keeps this
+// hash for each of its shaders, to tell when the source has changed.
+bool hash_shader_source(const std::string& source_path, uint64_t* hash);
+
+// Finds the compiled shader for request, compiling it only if it is
+// not already in the cache. Returns false if the shader could not be
+// compiled, in which case errors holds the compiler output.
+bool load_shader(
+	shader_cache* cache,
+	const shader_compile_request& request,
+	shader_bytecode* bytecode,
+	std::string* errors
+);
+
+// Same as load_shader, but loads all of the requests at once with each
+// one on its own thread. Returns false if any of them failed. The
+// errors for each failed shader are appended to errors.
+bool load_shaders_parallel(
+	shader_cache* cache,
+	const shader_compile_request* requests,
+	shader_bytecode* bytecodes,
+	const size_t count,
+	std::string* errors
+);
+
+const void* get_shader_bytecode_data(const shader_bytecode* bytecode);
+size_t get_shader_bytecode_size(const shader_bytecode* bytecode);
+
+void release_shader_bytecode(shader_bytecode* bytecode);
@@ -0,0 +1,414 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "simulation.h"
+#include "hash_utils.h"
+#include "profiler.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static void run_simulation_thread(simulation* sim);
+static void publish_snapshot(simulation* sim);
+static void lerp_floats(
+	const float* a,
+	const float* b,
+	const uint32_t count,
+	const float alpha,
+	float* out
+);
+static void nlerp_quaternions(
+	const float* a,
+	const float* b,
+	const float alpha,
+	float* out
+);
+
+simulation::simulation() {
+	step = NULL;
+	step_user_data = NULL;
+	step_ns = 0;
+	clock = get_system_time_ns;
+	sleep = sleep_system_ns;
+	clock_user_data = NULL;
+	world = {};
+	next_step_ns = 0;
+	write_slot = 0;
+	dropped_ns = 0;
+	recording = false;
+	ready_slot = 1;
+	input = 0;
+	running = false;
+	current_slot = 2;
+	previous_slot = 3;
+}
+
+void initialize_simulation(
+	simulation* sim,
+	const uint32_t steps_per_second,
+	sim_step_fn step,
+	void* step_user_data,
+	const sim_snapshot* initial_world
+) {
+	uint32_t i;
+
+	sim->step = step;
+	sim->step_user_data = step_user_data;
+	sim->step_ns = 1000000000ULL / steps_per_second;
+	sim->clock = get_system_time_ns;
+	sim->sleep = sleep_system_ns;
+	sim->clock_user_data = NULL;
+
+	sim->world = *initial_world;
+	sim->world.step = 0;
+	sim->world.time_ns = 0;
+	sim->world.published_ns = 0;
+
+	sim->next_step_ns = 0;
+	sim->dropped_ns = 0;
+	sim->recorded_input.clear();
+	sim->input.store(0);
+
+	//
+	// Every slot starts out with the initial world, so the renderer has
+	// something to draw before the first step.
+	//
+
+	for (i = 0; i < SIM_SNAPSHOT_SLOTS; i++) {
+		sim->slots[i] = sim->world;
+	}
+
+	sim->write_slot = 0;
+	sim->ready_slot.store(1);
+	sim->current_slot = 2;
+	sim->previous_slot = 3;
+}
+
+void set_simulation_clock(
+	simulation* sim,
+	pacer_clock_fn clock,
+	pacer_sleep_fn sleep,
+	void* user_data
+) {
+	sim->clock = clock;
+	sim->sleep = sleep;
+	sim->clock_user_data = user_data;
+	sim->next_step_ns = 0;
+}
+
+void start_simulation(simulation* sim) {
+	if (sim->running.load()) {
+		return;
+	}
+
+	sim->running.store(true);
+	sim->thread = thread(run_simulation_thread, sim);
+}
+
+void stop_simulation(simulation* sim) {
+	if (!sim->running.load()) {
+		return;
+	}
+
+	sim->running.store(false);
+	sim->thread.join();
+}
+
+uint32_t advance_simulation(simulation* sim, const uint64_t now_ns) {
+	uint32_t steps;
+	uint32_t input;
+
+	//
+	// The first step is due a whole step after we start, since it
+	// simulates the time between now and then.
+	//
+
+	if (sim->next_step_ns == 0) {
+		sim->next_step_ns = now_ns + sim->step_ns;
+		sim->world.published_ns = now_ns;
+		return 0;
+	}
+
+	steps = 0;
+
+	while (sim->next_step_ns <= now_ns) {
+		if (steps == SIM_MAX_CATCH_UP_STEPS) {
+			//
+			// We're too far behind. Drop the whole steps we haven't
+			// run, but keep the grid so the rate stays exact.
+			//
+
+			while (sim->next_step_ns <= now_ns) {
+				sim->next_step_ns += sim->step_ns;
+				sim->dropped_ns += sim->step_ns;
+			}
+
+			break;
+		}
+
+		input = sim->input.load(memory_order_relaxed);
+		if (sim->recording) {
+			sim->recorded_input.push_back(input);
+		}
+
+		sim->step(
+			&(sim->world),
+			input,
+			(double)sim->step_ns / 1000000000.0,
+			sim->step_user_data
+		);
+
+		sim->world.step++;
+		sim->world.time_ns += sim->step_ns;
+		sim->world.published_ns = sim->next_step_ns;
+		sim->next_step_ns += sim->step_ns;
+
+		steps++;
+	}
+
+	if (steps > 0) {
+		publish_snapshot(sim);
+	}
+
+	return steps;
+}
+
+void press_simulation_input(simulation* sim, const uint32_t buttons) {
+	sim->input.fetch_or(buttons, memory_order_relaxed);
+}
+
+void release_simulation_input(simulation* sim, const uint32_t buttons) {
+	sim->input.fetch_and(~buttons, memory_order_relaxed);
+}
+
+void read_simulation(simulation* sim, const uint64_t now_ns, sim_snapshot* out) {
+	uint32_t ready;
+	const sim_snapshot* previous;
+	const sim_snapshot* current;
+	float alpha;
+
+	//
+	// If there's a new snapshot, swap our older one in for it. The
+	// simulation can have the old one back to write into, since we
+	// only need the two newest.
+	//
+
+	ready = sim->ready_slot.load(memory_order_relaxed);
+
+	if (ready & SIM_SLOT_NEW) {
+		ready = sim->ready_slot.exchange(sim->previous_slot, memory_order_acq_rel);
+
+		sim->previous_slot = sim->current_slot;
+		sim->current_slot = ready & ~SIM_SLOT_NEW;
+	}
+
+	previous = &(sim->slots[sim->previous_slot]);
+	current = &(sim->slots[sim->current_slot]);
+
+	alpha = get_interpolation_alpha(previous, current, sim->step_ns, now_ns);
+	interpolate_snapshots(previous, current, alpha, out);
+}
+
+float get_interpolation_alpha(
+	const sim_snapshot* previous,
+	const sim_snapshot* current,
+	const uint64_t step_ns,
+	const uint64_t now_ns
+) {
+	double render_time;
+	double span;
+	double alpha;
+
+	//
+	// Work out the simulation time we're drawing: one step behind
+	// where the simulation would be by now. Snapshots can be more than
+	// a step apart if we missed some, so go by their times rather than
+	// assuming a single step between them.
+	//
+
+	span = (double)current->time_ns - (double)previous->time_ns;
+	if (span <= 0.0) {
+		return 1.0f;
+	}
+
+	render_time = (double)current->time_ns - (double)step_ns;
+	if (now_ns > current->published_ns) {
+		render_time += (double)(now_ns - current->published_ns);
+	}
+
+	alpha = (render_time - (double)previous->time_ns) / span;
+
+	if (alpha < 0.0) {
+		alpha = 0.0;
+	}
+
+	if (alpha > 1.0) {
+		alpha = 1.0;
+	}
+
+	return (float)alpha;
+}
+
+void interpolate_snapshots(
+	const sim_snapshot* previous,
+	const sim_snapshot* current,
+	const float alpha,
+	sim_snapshot* out
+) {
+	const sim_transform* a;
+	const sim_transform* b;
+	sim_transform* result;
+	uint32_t i;
+
+	out->step = current->step;
+	out->time_ns = current->time_ns;
+	out->published_ns = current->published_ns;
+
+	lerp_floats(previous->camera.eye, current->camera.eye, 3, alpha, out->camera.eye);
+	lerp_floats(previous->camera.focus, current->camera.focus, 3, alpha, out->camera.focus);
+	lerp_floats(previous->camera.up, current->camera.up, 3, alpha, out->camera.up);
+	lerp_floats(
+		&(previous->camera.field_of_view),
+		&(current->camera.field_of_view),
+		1,
+		alpha,
+		&(out->camera.field_of_view)
+	);
+
+	out->transform_count = current->transform_count;
+
+	for (i = 0; i < current->transform_count; i++) {
+		b = &(current->transforms[i]);
+		result = &(out->transforms[i]);
+
+		// Anything that's only just appeared has nothing to blend from.
+		if (i >= previous->transform_count) {
+			*result = *b;
+			continue;
+		}
+
+		a = &(previous->transforms[i]);
+
+		lerp_floats(a->position, b->position, 3, alpha, result->position);
+		nlerp_quaternions(a->rotation, b->rotation, alpha, result->rotation);
+		lerp_floats(a->scale, b->scale, 3, alpha, result->scale);
+	}
+}
+
+void replay_simulation(
+	sim_step_fn step,
+	void* step_user_data,
+	const uint64_t step_ns,
+	const vector<uint32_t>& inputs,
+	sim_snapshot* world
+) {
+	size_t i;
+
+	for (i = 0; i < inputs.size(); i++) {
+		step(world, inputs[i], (double)step_ns / 1000000000.0, step_user_data);
+
+		world->step++;
+		world->time_ns += step_ns;
+	}
+}
+
+uint64_t hash_snapshot(const sim_snapshot* snapshot) {
+	uint64_t hash;
+
+	hash = hash_bytes(&(snapshot->step), sizeof(snapshot->step));
+	hash = hash_bytes(&(snapshot->time_ns), sizeof(snapshot->time_ns), hash);
+	hash = hash_bytes(&(snapshot->camera), sizeof(snapshot->camera), hash);
+	hash = hash_bytes(&(snapshot->transform_count), sizeof(snapshot->transform_count), hash);
+	hash = hash_bytes(
+		snapshot->transforms,
+		sizeof(sim_transform) * snapshot->transform_count,
+		hash
+	);
+
+	return hash;
+}
+
+static void run_simulation_thread(simulation* sim) {
+	uint64_t now;
+
+	set_profile_thread_name("Simulation thread");
+
+	while (sim->running.load(memory_order_acquire)) {
+		{
+			PROFILE_ZONE("simulation step");
+			advance_simulation(sim, sim->clock(sim->clock_user_data));
+		}
+
+		now = sim->clock(sim->clock_user_data);
+		if (now < sim->next_step_ns) {
+			sim->sleep(sim->next_step_ns - now, sim->clock_user_data);
+		}
+	}
+}
+
+static void publish_snapshot(simulation* sim) {
+	uint32_t old_ready;
+
+	//
+	// Fill our slot, then swap it with the waiting one. Whatever was
+	// waiting is ours to write next time. Either the renderer never
+	// picked it up (so it's stale), or it's the one the renderer just
+	// handed back.
+	//
+
+	sim->slots[sim->write_slot] = sim->world;
+
+	old_ready = sim->ready_slot.exchange(
+		sim->write_slot | SIM_SLOT_NEW,
+		memory_order_acq_rel
+	);
+
+	sim->write_slot = old_ready & ~SIM_SLOT_NEW;
+}
+
+static void lerp_floats(
+	const float* a,
+	const float* b,
+	const uint32_t count,
+	const float alpha,
+	float* out
+) {
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		out[i] = a[i] + (b[i] - a[i]) * alpha;
+	}
+}
+
+static void nlerp_quaternions(
+	const float* a,
+	const float* b,
+	const float alpha,
+	float* out
+) {
+	float dot;
+	float sign;
+	float length;
+	uint32_t i;
+
+	//
+	// q and -q are the same rotation. Blend towards whichever of them
+	// is closer, or we'd go the long way around.
+	//
+
+	dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+	sign = dot < 0.0f ? -1.0f : 1.0f;
+
+	for (i = 0; i < 4; i++) {
+		out[i] = a[i] + (sign * b[i] - a[i]) * alpha;
+	}
+
+	length = sqrtf(out[0] * out[0] + out[1] * out[1] + out[2] * out[2] + out[3] * out[3]);
+
+	if (length > 0.0f) {
+		for (i = 0; i < 4; i++) {
+			out[i] /= length;
+		}
+	}
+}
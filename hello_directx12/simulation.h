@@ -0,0 +1,190 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// The simulation runs the game logic at a fixed rate on its own thread,
+// so it doesn't speed up, slow down, or stall along with the renderer.
+//
+// After each batch of steps it publishes a snapshot of the world (the
+// transforms and the camera). The renderer keeps the two latest
+// snapshots and draws a blend of them, so motion stays smooth even when
+// the frame rate and the simulation rate don't line up.
+//
+// Snapshots are handed over without locks. There are four slots: one
+// the simulation is writing, one waiting to be picked up, and the two
+// the renderer is blending. Publishing and picking up are each a single
+// atomic exchange of the waiting slot, so neither side ever waits on
+// the other.
+//
+// A step only sees the world, a fixed time step, and the input for
+// that step. So the same inputs always give the same world, and inputs
+// can be recorded and replayed to check that. Like the frame pacer, the
+// clock can be swapped out, so all of this can run headless (see
+// tools/simulation_test.cpp).
+//
+
+#pragma once
+
+#include "frame_pacer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+const uint32_t SIM_MAX_TRANSFORMS = 64;
+const uint32_t SIM_SNAPSHOT_SLOTS = 4;
+// Set on the waiting slot when it holds a snapshot the renderer
+// hasn't picked up yet.
+const uint32_t SIM_SLOT_NEW = 0x80000000;
+// If the simulation falls further behind than this many steps (say,
+// the window was being dragged), the extra time is dropped rather than
+// trying to catch up on all of it at once.
+const uint32_t SIM_MAX_CATCH_UP_STEPS = 8;
+
+struct sim_transform {
+	float position[3];
+	// A quaternion, x y z w.
+	float rotation[4];
+	float scale[3];
+};
+
+struct sim_camera {
+	float eye[3];
+	float focus[3];
+	float up[3];
+	// In degrees.
+	float field_of_view;
+};
+
+struct sim_snapshot {
+	// How many steps have run, and how much simulated time that is.
+	uint64_t step;
+	uint64_t time_ns;
+	// The clock time the last step was due. The renderer uses this to
+	// work out how far between two snapshots it is. Not part of the
+	// world, so it isn't hashed.
+	uint64_t published_ns;
+
+	sim_camera camera;
+	uint32_t transform_count;
+	sim_transform transforms[SIM_MAX_TRANSFORMS];
+};
+
+// Advances the world by one step. The result must only depend on the
+// world, the input and step_seconds, or replays won't match.
+typedef void (*sim_step_fn)(
+	sim_snapshot* world,
+	const uint32_t input,
+	const double step_seconds,
+	void* user_data
+);
+
+struct simulation {
+	simulation();
+
+	sim_step_fn step;
+	void* step_user_data;
+	uint64_t step_ns;
+
+	pacer_clock_fn clock;
+	pacer_sleep_fn sleep;
+	void* clock_user_data;
+
+	//
+	// Owned by the simulation thread.
+	//
+
+	sim_snapshot world;
+	// When the next step is due.
+	uint64_t next_step_ns;
+	uint32_t write_slot;
+	// Time thrown away because we fell too far behind.
+	uint64_t dropped_ns;
+	// If recording is set, the input each step used is kept here.
+	bool recording;
+	std::vector<uint32_t> recorded_input;
+
+	//
+	// Shared.
+	//
+
+	sim_snapshot slots[SIM_SNAPSHOT_SLOTS];
+	// The waiting slot, with SIM_SLOT_NEW if it hasn't been picked up.
+	std::atomic<uint32_t> ready_slot;
+	// Bit mask of buttons held. Written by the window thread, read at
+	// the start of each step.
+	std::atomic<uint32_t> input;
+	std::atomic<bool> running;
+	std::thread thread;
+
+	//
+	// Owned by the renderer.
+	//
+
+	uint32_t current_slot;
+	uint32_t previous_slot;
+};
+
+// Sets up the simulation with initial_world and the OS clock, but
+// doesn't start it.
+void initialize_simulation(
+	simulation* sim,
+	const uint32_t steps_per_second,
+	sim_step_fn step,
+	void* step_user_data,
+	const sim_snapshot* initial_world
+);
+
+// Changes where the simulation gets its time from. Call before
+// starting it.
+void set_simulation_clock(
+	simulation* sim,
+	pacer_clock_fn clock,
+	pacer_sleep_fn sleep,
+	void* user_data
+);
+
+void start_simulation(simulation* sim);
+// Stops the thread and waits for it to finish.
+void stop_simulation(simulation* sim);
+
+// Runs every step that is due by now_ns, then publishes a snapshot if
+// any ran. Returns how many steps ran. The simulation thread calls this
+// in a loop; tests can call it directly instead of starting the thread.
+uint32_t advance_simulation(simulation* sim, const uint64_t now_ns);
+
+void press_simulation_input(simulation* sim, const uint32_t buttons);
+void release_simulation_input(simulation* sim, const uint32_t buttons);
+
+// Picks up the newest snapshot if there is one, then blends the two
+// latest for the given time into out. Renderer only.
+void read_simulation(simulation* sim, const uint64_t now_ns, sim_snapshot* out);
+
+// How far between previous and current to draw at now_ns, from 0 to
+// 1. We draw one step behind the latest snapshot, so there is always a
+// snapshot on either side.
+float get_interpolation_alpha(
+	const sim_snapshot* previous,
+	const sim_snapshot* current,
+	const uint64_t step_ns,
+	const uint64_t now_ns
+);
+
+void interpolate_snapshots(
+	const sim_snapshot* previous,
+	const sim_snapshot* current,
+	const float alpha,
+	sim_snapshot* out
+);
+
+// Runs the inputs through step, one per step, starting from world.
+void replay_simulation(
+	sim_step_fn step,
+	void* step_user_data,
+	const uint64_t step_ns,
+	const std::vector<uint32_t>& inputs,
+	sim_snapshot* world
+);
+
+// Hashes the world state, for checking replays match.
+uint64_t hash_snapshot(const sim_snapshot* snapshot);
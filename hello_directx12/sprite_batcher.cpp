@@ -0,0 +1,503 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "sprite_batcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define SPRITES_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static void sort_sprite_keys(sprite_batcher* batcher);
+
+#if defined(SPRITES_USE_SSE)
+// How many sprites ahead expand_sprites fetches, when they're sorted.
+const uint32_t SPRITE_PREFETCH_DISTANCE = 32;
+
+// Sine and cosine of four angles at once. Accurate to a few millionths,
+// which is far below a pixel for anything on screen.
+static void sin_cos_4(const __m128 angles, __m128* sines, __m128* cosines);
+#endif
+
+sprite_batcher::sprite_batcher() {
+	max_quads = 0;
+	frame_count = 0;
+	vertices = NULL;
+	screen_scale[0] = 0.0f;
+	screen_scale[1] = 0.0f;
+	screen_offset[0] = 0.0f;
+	screen_offset[1] = 0.0f;
+	peak_quads = 0;
+	dropped = 0;
+	memset(sort_counts, 0, sizeof(sort_counts));
+}
+
+size_t get_sprite_vertex_buffer_size(const uint32_t max_quads, const uint32_t frame_count) {
+	return (size_t)max_quads * 4 * sizeof(sprite_vertex) * frame_count;
+}
+
+void write_sprite_indices(uint16_t* indices) {
+	uint32_t quad;
+	uint16_t vertex;
+
+	//
+	// Two clockwise triangles per quad: top left, top right, bottom
+	// right, then top left, bottom right, bottom left.
+	//
+
+	for (quad = 0; quad < SPRITE_QUADS_PER_DRAW; quad++) {
+		vertex = (uint16_t)(quad * 4);
+
+		indices[quad * 6 + 0] = vertex + 0;
+		indices[quad * 6 + 1] = vertex + 1;
+		indices[quad * 6 + 2] = vertex + 2;
+		indices[quad * 6 + 3] = vertex + 0;
+		indices[quad * 6 + 4] = vertex + 2;
+		indices[quad * 6 + 5] = vertex + 3;
+	}
+}
+
+void initialize_sprite_batcher(
+	sprite_batcher* batcher,
+	const uint32_t max_quads,
+	const uint32_t frame_count,
+	uint8_t* vertices
+) {
+	batcher->max_quads = min(max_quads, SPRITE_MAX_QUADS);
+	batcher->frame_count = frame_count;
+	batcher->vertices = vertices;
+	batcher->peak_quads = 0;
+	batcher->dropped = 0;
+
+	// All the room there'll ever be, so the frame loop never allocates.
+	batcher->sprites.clear();
+	batcher->sprites.reserve(batcher->max_quads);
+	batcher->keys.clear();
+	batcher->keys.reserve(batcher->max_quads);
+	batcher->sort_scratch.clear();
+	batcher->sort_scratch.reserve(batcher->max_quads);
+	batcher->draws.clear();
+	// At worst, every quad is a draw of its own.
+	batcher->draws.reserve(batcher->max_quads);
+
+	set_sprite_viewport(batcher, 1.0f, 1.0f);
+}
+
+void set_sprite_viewport(sprite_batcher* batcher, const float width, const float height) {
+	// x goes from 0 to width as -1 to 1, and y from 0 to height as 1
+	// to -1, since clip space is y up.
+	batcher->screen_scale[0] = 2.0f / width;
+	batcher->screen_scale[1] = -2.0f / height;
+	batcher->screen_offset[0] = -1.0f;
+	batcher->screen_offset[1] = 1.0f;
+}
+
+void reset_sprite_batch(sprite_batcher* batcher) {
+	batcher->sprites.clear();
+	batcher->keys.clear();
+	batcher->draws.clear();
+	memset(batcher->sort_counts, 0, sizeof(batcher->sort_counts));
+}
+
+uint32_t add_sprites(sprite_batcher* batcher, const sprite* sprites, const uint32_t count) {
+	uint64_t key;
+	uint32_t blend;
+	uint32_t texture;
+	uint32_t added;
+	uint32_t index;
+	uint32_t digit;
+	uint32_t i;
+
+	index = (uint32_t)batcher->sprites.size();
+	added = min(count, batcher->max_quads - index);
+	batcher->sprites.insert(batcher->sprites.end(), sprites, sprites + added);
+	batcher->dropped += count - added;
+
+	//
+	// The key is the layer, then blend mode, then texture, with the
+	// sprite's index in the low 24 bits. Sorting the keys sorts the
+	// sprites, and the index keeps sprites that are otherwise the same
+	// in the order they were added.
+	//
+
+	for (i = 0; i < added; i++) {
+		const sprite& s = sprites[i];
+
+		blend = s.blend < SPRITE_BLEND_COUNT ? (uint32_t)s.blend : (uint32_t)SPRITE_BLEND_ALPHA;
+		texture = s.texture & 0xfffff;
+
+		key = (uint64_t)s.layer << 48;
+		key |= (uint64_t)blend << 44;
+		key |= (uint64_t)texture << 24;
+		key |= index + i;
+
+		batcher->keys.push_back(key);
+
+		for (digit = 0; digit < SPRITE_SORT_DIGITS; digit++) {
+			batcher->sort_counts[digit][(key >> ((SPRITE_SORT_FIRST_DIGIT + digit) * 8)) & 0xff]++;
+		}
+	}
+
+	return added;
+}
+
+uint32_t build_sprite_batch(sprite_batcher* batcher, const uint32_t frame) {
+	sprite_draw draw;
+	uint32_t blend;
+	uint32_t count;
+	uint32_t quads;
+	uint32_t i;
+
+	batcher->draws.clear();
+
+	count = (uint32_t)batcher->sprites.size();
+	batcher->peak_quads = max(batcher->peak_quads, count);
+
+	if (count == 0 || !batcher->vertices) {
+		return 0;
+	}
+
+	sort_sprite_keys(batcher);
+
+	expand_sprites(
+		batcher->sprites.data(),
+		batcher->keys.data(),
+		count,
+		batcher->screen_scale,
+		batcher->screen_offset,
+		(sprite_vertex*)(batcher->vertices + get_sprite_frame_offset(batcher, frame))
+	);
+
+	//
+	// A new draw whenever the blend mode changes, or the indices run
+	// out.
+	//
+
+	draw = {};
+	quads = 0;
+
+	for (i = 0; i < count; i++) {
+		blend = (uint32_t)(batcher->keys[i] >> 44) & 0xf;
+
+		if (quads > 0 && (blend != draw.blend || quads == SPRITE_QUADS_PER_DRAW)) {
+			draw.index_count = quads * 6;
+			batcher->draws.push_back(draw);
+			quads = 0;
+		}
+
+		if (quads == 0) {
+			draw.blend = blend;
+			draw.base_vertex = i * 4;
+		}
+
+		quads++;
+	}
+
+	draw.index_count = quads * 6;
+	batcher->draws.push_back(draw);
+
+	return (uint32_t)batcher->draws.size();
+}
+
+size_t get_sprite_frame_offset(const sprite_batcher* batcher, const uint32_t frame) {
+	return (size_t)batcher->max_quads * 4 * sizeof(sprite_vertex) * (frame % batcher->frame_count);
+}
+
+void expand_sprites(
+	const sprite* sprites,
+	const uint64_t* keys,
+	const uint32_t count,
+	const float screen_scale[2],
+	const float screen_offset[2],
+	sprite_vertex* destination
+) {
+	const sprite* group[4];
+	sprite_vertex* vertex;
+	uint32_t group_size;
+	uint32_t i;
+	uint32_t j;
+#if defined(SPRITES_USE_SSE)
+	float angles[4];
+	float sines[4];
+	float cosines[4];
+	__m128 corner_x;
+	__m128 corner_y;
+	__m128 corner_u;
+	__m128 corner_v;
+	__m128 scale_x;
+	__m128 scale_y;
+	__m128 offset_x;
+	__m128 offset_y;
+	__m128 sin_4;
+	__m128 cos_4;
+	__m128 half_x;
+	__m128 half_y;
+	__m128 x;
+	__m128 y;
+	__m128 u;
+	__m128 v;
+	__m128i extra;
+#else
+	static const float CORNER_X[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+	static const float CORNER_Y[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+	static const float CORNER_U[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+	static const float CORNER_V[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+	float sine;
+	float cosine;
+	float corner_x;
+	float corner_y;
+	uint32_t k;
+#endif
+
+#if defined(SPRITES_USE_SSE)
+	//
+	// Each quad is done as one vector per attribute, with a lane for
+	// each corner: top left, top right, bottom right, bottom left.
+	//
+
+	corner_x = _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f);
+	corner_y = _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+	corner_u = _mm_setr_ps(0.0f, 1.0f, 1.0f, 0.0f);
+	corner_v = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+	scale_x = _mm_set1_ps(screen_scale[0]);
+	scale_y = _mm_set1_ps(screen_scale[1]);
+	offset_x = _mm_set1_ps(screen_offset[0]);
+	offset_y = _mm_set1_ps(screen_offset[1]);
+#endif
+
+	vertex = destination;
+
+	for (i = 0; i < count; i += 4) {
+		group_size = min(count - i, 4u);
+
+		for (j = 0; j < group_size; j++) {
+			group[j] = &(sprites[keys ? (uint32_t)(keys[i + j] & 0xffffff) : i + j]);
+		}
+
+#if defined(SPRITES_USE_SSE)
+		//
+		// In sorted order the sprites are all over the place, so fetch
+		// the ones a few groups ahead while these are worked on.
+		//
+
+		if (keys) {
+			for (j = i + SPRITE_PREFETCH_DISTANCE; j < min(count, i + SPRITE_PREFETCH_DISTANCE + 4); j++) {
+				_mm_prefetch((const char*)(&(sprites[keys[j] & 0xffffff])), _MM_HINT_T0);
+			}
+		}
+#endif
+
+#if defined(SPRITES_USE_SSE)
+		// The rotations for the whole group in one go.
+		for (j = 0; j < 4; j++) {
+			angles[j] = j < group_size ? group[j]->rotation : 0.0f;
+		}
+
+		sin_cos_4(_mm_loadu_ps(angles), &sin_4, &cos_4);
+		_mm_storeu_ps(sines, sin_4);
+		_mm_storeu_ps(cosines, cos_4);
+#endif
+
+		for (j = 0; j < group_size; j++) {
+			const sprite& s = *(group[j]);
+
+#if defined(SPRITES_USE_SSE)
+			sin_4 = _mm_set1_ps(sines[j]);
+			cos_4 = _mm_set1_ps(cosines[j]);
+			half_x = _mm_mul_ps(corner_x, _mm_set1_ps(s.size[0] * 0.5f));
+			half_y = _mm_mul_ps(corner_y, _mm_set1_ps(s.size[1] * 0.5f));
+
+			// Rotate the corners about the centre, then go to clip space.
+			x = _mm_sub_ps(_mm_mul_ps(half_x, cos_4), _mm_mul_ps(half_y, sin_4));
+			y = _mm_add_ps(_mm_mul_ps(half_x, sin_4), _mm_mul_ps(half_y, cos_4));
+			x = _mm_add_ps(_mm_mul_ps(_mm_add_ps(x, _mm_set1_ps(s.position[0])), scale_x), offset_x);
+			y = _mm_add_ps(_mm_mul_ps(_mm_add_ps(y, _mm_set1_ps(s.position[1])), scale_y), offset_y);
+
+			u = _mm_add_ps(_mm_mul_ps(corner_u, _mm_set1_ps(s.uv_scale[0])), _mm_set1_ps(s.uv_offset[0]));
+			v = _mm_add_ps(_mm_mul_ps(corner_v, _mm_set1_ps(s.uv_scale[1])), _mm_set1_ps(s.uv_offset[1]));
+
+			// Now each vector is one corner's x, y, u and v.
+			_MM_TRANSPOSE4_PS(x, y, u, v);
+
+			//
+			// The vertex buffer is write combined, so only ever write
+			// to it, front to back.
+			//
+
+			extra = _mm_set_epi32(0, 0, (int)s.texture, (int)s.color);
+
+			_mm_storeu_ps(vertex[0].position, x);
+			_mm_storel_epi64((__m128i*)(&(vertex[0].color)), extra);
+			_mm_storeu_ps(vertex[1].position, y);
+			_mm_storel_epi64((__m128i*)(&(vertex[1].color)), extra);
+			_mm_storeu_ps(vertex[2].position, u);
+			_mm_storel_epi64((__m128i*)(&(vertex[2].color)), extra);
+			_mm_storeu_ps(vertex[3].position, v);
+			_mm_storel_epi64((__m128i*)(&(vertex[3].color)), extra);
+#else
+			sine = sinf(s.rotation);
+			cosine = cosf(s.rotation);
+
+			for (k = 0; k < 4; k++) {
+				corner_x = CORNER_X[k] * s.size[0] * 0.5f;
+				corner_y = CORNER_Y[k] * s.size[1] * 0.5f;
+
+				vertex[k].position[0] = (corner_x * cosine - corner_y * sine + s.position[0]) * screen_scale[0] + screen_offset[0];
+				vertex[k].position[1] = (corner_x * sine + corner_y * cosine + s.position[1]) * screen_scale[1] + screen_offset[1];
+				vertex[k].uv[0] = CORNER_U[k] * s.uv_scale[0] + s.uv_offset[0];
+				vertex[k].uv[1] = CORNER_V[k] * s.uv_scale[1] + s.uv_offset[1];
+				vertex[k].color = s.color;
+				vertex[k].texture = s.texture;
+			}
+#endif
+
+			vertex += 4;
+		}
+	}
+}
+
+sprite_batcher_stats get_sprite_batcher_stats(const sprite_batcher* batcher) {
+	sprite_batcher_stats stats;
+
+	stats.quads = (uint32_t)batcher->sprites.size();
+	stats.draws = (uint32_t)batcher->draws.size();
+	stats.peak_quads = batcher->peak_quads;
+	stats.dropped = batcher->dropped;
+
+	return stats;
+}
+
+string get_sprite_batcher_report(const sprite_batcher* batcher) {
+	sprite_batcher_stats stats;
+	char report[256];
+
+	stats = get_sprite_batcher_stats(batcher);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Sprites: %u quads in %u draws last frame, peak of %u of %u, %llu dropped\n",
+		stats.quads,
+		stats.draws,
+		stats.peak_quads,
+		batcher->max_quads,
+		(unsigned long long)stats.dropped
+	);
+
+	return report;
+}
+
+static void sort_sprite_keys(sprite_batcher* batcher) {
+	uint32_t offsets[SPRITE_SORT_RADIX];
+	const uint32_t* counts;
+	uint64_t* source;
+	uint64_t* destination;
+	uint64_t key;
+	uint32_t offset;
+	uint32_t shift;
+	uint32_t count;
+	uint32_t digit;
+	uint32_t value;
+	uint32_t i;
+	bool skip;
+
+	count = (uint32_t)batcher->keys.size();
+
+	// Overwritten before it's read, and never grows past what was
+	// reserved.
+	batcher->sort_scratch.resize(count);
+
+	source = batcher->keys.data();
+	destination = batcher->sort_scratch.data();
+
+	for (digit = 0; digit < SPRITE_SORT_DIGITS; digit++) {
+		//
+		// A byte where every key has the same value wouldn't move
+		// anything. Otherwise, turn the counts into where the first key
+		// with each value goes.
+		//
+
+		counts = batcher->sort_counts[digit];
+
+		skip = false;
+		for (value = 0; value < SPRITE_SORT_RADIX; value++) {
+			skip = skip || counts[value] == count;
+		}
+
+		if (skip) {
+			continue;
+		}
+
+		offset = 0;
+		for (value = 0; value < SPRITE_SORT_RADIX; value++) {
+			offsets[value] = offset;
+			offset += counts[value];
+		}
+
+		// Going front to back keeps keys with the same byte in the order
+		// the last pass left them, which is what makes it a sort.
+		shift = (SPRITE_SORT_FIRST_DIGIT + digit) * 8;
+
+		for (i = 0; i < count; i++) {
+			key = source[i];
+			destination[offsets[(key >> shift) & 0xff]++] = key;
+		}
+
+		swap(source, destination);
+	}
+
+	// An odd number of passes leaves the sorted keys in the scratch.
+	if (source != batcher->keys.data()) {
+		batcher->keys.swap(batcher->sort_scratch);
+	}
+}
+
+#if defined(SPRITES_USE_SSE)
+static void sin_cos_4(const __m128 angles, __m128* sines, __m128* cosines) {
+	__m128i quadrant;
+	__m128 whole;
+	__m128 r;
+	__m128 r2;
+	__m128 s;
+	__m128 c;
+	__m128 sign;
+
+	//
+	// Take off the nearest multiple of pi, leaving r in [-pi/2, pi/2].
+	// Pi is split in two so the subtraction doesn't lose precision.
+	// Every multiple of pi flips the sign of both.
+	//
+
+	quadrant = _mm_cvtps_epi32(_mm_mul_ps(angles, _mm_set1_ps(0.318309886f)));
+	whole = _mm_cvtepi32_ps(quadrant);
+
+	r = _mm_sub_ps(angles, _mm_mul_ps(whole, _mm_set1_ps(3.14159274f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(whole, _mm_set1_ps(-8.74227766e-8f)));
+	r2 = _mm_mul_ps(r, r);
+
+	// Taylor series, which are plenty over this range.
+	s = _mm_set1_ps(2.75573192e-6f);
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.98412698e-4f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(8.33333333e-3f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.66666667e-1f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(1.0f));
+	s = _mm_mul_ps(s, r);
+
+	c = _mm_set1_ps(-2.75573192e-7f);
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(2.48015873e-5f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.38888889e-3f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.16666667e-2f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-0.5f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(1.0f));
+
+	sign = _mm_castsi128_ps(_mm_slli_epi32(quadrant, 31));
+	*sines = _mm_xor_ps(s, sign);
+	*cosines = _mm_xor_ps(c, sign);
+}
+#endif
@@ -0,0 +1,177 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Immediate mode 2D: HUD, debug overlays, particles. Each frame, code
+// adds however many sprites it wants, and the batcher turns them into
+// as few draws as it can.
+//
+// Sprites are quads, expanded on the CPU straight into a persistently
+// mapped vertex buffer with a region for each back buffer, so nothing
+// is copied or uploaded afterwards. Every quad uses the same six
+// indices, so one small static index buffer covers them all; a draw
+// just starts at its first quad's vertices.
+//
+// Sprites are drawn in order of layer. Within a layer they're sorted by
+// blend mode and then texture. Each vertex says which texture it uses
+// (the shaders index the bindless texture array with it), so textures
+// never split a batch. Only a change of blend mode, which needs another
+// pipeline state, does, or running past SPRITE_QUADS_PER_DRAW. The sort
+// means sprites in the same layer aren't drawn in the order they were
+// added, so anything that has to be on top goes in a higher layer.
+//
+// The sort is a least significant digit radix sort of the sort keys, a
+// byte at a time, like the render queue's. The key's low bytes are the
+// sprite's index, which are already in order, and bytes that are the
+// same in every key (most of the layer, usually) are skipped, so a
+// frame is only a few passes over the keys. Keys are made, and counted
+// for the sort, as sprites are added, while they're still in the cache.
+//
+// Positions are in pixels from the top left of the screen, and are
+// turned into clip space as the quads are expanded.
+//
+// The frame loop mustn't allocate (see frame_arena.h), so everything
+// is sized up front by initialize_sprite_batcher. Sprites past
+// max_quads are dropped and counted.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The indices are 16 bit, so a draw can reach this many quads' worth of
+// vertices.
+const uint32_t SPRITE_QUADS_PER_DRAW = 16384;
+const uint32_t SPRITE_INDEX_COUNT = SPRITE_QUADS_PER_DRAW * 6;
+// Sort keys have 24 bits for the sprite's index.
+const uint32_t SPRITE_MAX_QUADS = 1 << 24;
+const uint32_t SPRITE_NO_TEXTURE = 0xffffffff;
+// The sort goes a byte at a time, over the bytes of the key above the
+// sprite's index.
+const uint32_t SPRITE_SORT_RADIX = 256;
+const uint32_t SPRITE_SORT_FIRST_DIGIT = 3;
+const uint32_t SPRITE_SORT_DIGITS = 8 - SPRITE_SORT_FIRST_DIGIT;
+
+enum sprite_blend {
+	SPRITE_BLEND_OPAQUE = 0,
+	SPRITE_BLEND_ALPHA,
+	SPRITE_BLEND_ADDITIVE,
+	SPRITE_BLEND_COUNT
+};
+
+struct sprite {
+	// The centre, in pixels from the top left of the screen.
+	float position[2];
+	float size[2];
+	// Clockwise, in radians, about the centre.
+	float rotation;
+	// RGBA, 8 bits each with red in the lowest byte. Multiplies the
+	// texture.
+	uint32_t color;
+	// The part of the texture to show, as a scale and offset for UVs
+	// from 0 to 1. get_atlas_uv_transform gives these for atlas images.
+	float uv_scale[2];
+	float uv_offset[2];
+	// Slot in the texture array, or SPRITE_NO_TEXTURE for just color.
+	uint32_t texture;
+	uint16_t layer;
+	// A sprite_blend.
+	uint16_t blend;
+};
+
+// Must match the input layout of the sprite pipelines.
+struct sprite_vertex {
+	// Clip space.
+	float position[2];
+	float uv[2];
+	uint32_t color;
+	uint32_t texture;
+};
+
+static_assert(sizeof(sprite_vertex) == 24, "sprite_vertex must match the input layout");
+
+// One DrawIndexedInstanced.
+struct sprite_draw {
+	uint32_t blend;
+	// Where the draw's first quad starts in the frame's region.
+	uint32_t base_vertex;
+	uint32_t index_count;
+};
+
+struct sprite_batcher_stats {
+	uint32_t quads;
+	uint32_t draws;
+	uint32_t peak_quads;
+	uint64_t dropped;
+};
+
+struct sprite_batcher {
+	sprite_batcher();
+
+	uint32_t max_quads;
+	uint32_t frame_count;
+	// The mapped vertex buffer, with max_quads * 4 vertices for each
+	// frame.
+	uint8_t* vertices;
+
+	// Pixels to clip space.
+	float screen_scale[2];
+	float screen_offset[2];
+
+	// This frame's sprites and their sort keys, and the draws
+	// build_sprite_batch made of them. After build_sprite_batch, the
+	// keys are sorted.
+	std::vector<sprite> sprites;
+	std::vector<uint64_t> keys;
+	std::vector<sprite_draw> draws;
+	// Where the sort puts the keys between passes.
+	std::vector<uint64_t> sort_scratch;
+	// How many of this frame's keys have each value of each byte the
+	// sort looks at.
+	uint32_t sort_counts[SPRITE_SORT_DIGITS][SPRITE_SORT_RADIX];
+
+	uint32_t peak_quads;
+	uint64_t dropped;
+};
+
+// How big the vertex buffer has to be.
+size_t get_sprite_vertex_buffer_size(const uint32_t max_quads, const uint32_t frame_count);
+// Fills in the SPRITE_INDEX_COUNT indices every draw shares.
+void write_sprite_indices(uint16_t* indices);
+
+void initialize_sprite_batcher(
+	sprite_batcher* batcher,
+	const uint32_t max_quads,
+	const uint32_t frame_count,
+	uint8_t* vertices
+);
+void set_sprite_viewport(sprite_batcher* batcher, const float width, const float height);
+
+// Throws away last frame's sprites.
+void reset_sprite_batch(sprite_batcher* batcher);
+// Returns how many were added before the batcher filled up.
+uint32_t add_sprites(sprite_batcher* batcher, const sprite* sprites, const uint32_t count);
+
+// Sorts the sprites and expands them into frame's region of the vertex
+// buffer, which the GPU must be done with. Fills in draws, and returns
+// how many there are. The vertex buffer view for the draws starts at
+// get_sprite_frame_offset.
+uint32_t build_sprite_batch(sprite_batcher* batcher, const uint32_t frame);
+size_t get_sprite_frame_offset(const sprite_batcher* batcher, const uint32_t frame);
+
+// Writes count quads, taking the sprites in the order of the low 24
+// bits of keys (or in order if keys is NULL). Used by
+// build_sprite_batch.
+void expand_sprites(
+	const sprite* sprites,
+	const uint64_t* keys,
+	const uint32_t count,
+	const float screen_scale[2],
+	const float screen_offset[2],
+	sprite_vertex* destination
+);
+
+sprite_batcher_stats get_sprite_batcher_stats(const sprite_batcher* batcher);
+std::string get_sprite_batcher_report(const sprite_batcher* batcher);
@@ -0,0 +1,62 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+    Draws the quads made by the sprite batcher. The batcher has already
+    put the corners in clip space, so there's nothing for the vertex
+    shader to do but pass them on.
+
+    Each vertex says which texture it uses, so one draw can use any
+    mix of textures (see sprite_batcher.h).
+*/
+
+// Must match sprite_vertex in sprite_batcher.h.
+struct sprite_vertex
+{
+    float2 position : POSITION;
+    float2 uv : TEXCOORD;
+    float4 color : COLOR;
+    uint texture_index : TEXTURE;
+};
+
+struct sprite_pixel
+{
+    float4 position : SV_Position;
+    float2 uv : TEXCOORD;
+    float4 color : COLOR;
+    nointerpolation uint texture_index : TEXTURE;
+};
+
+// What texture_index is when a sprite is just a color.
+#define NO_TEXTURE 0xffffffff
+
+// The same texture array, and sampler, the cube uses.
+Texture2D textures[] : register(t0, space1);
+SamplerState my_sampler : register(s0);
+
+sprite_pixel vs_main(sprite_vertex input)
+{
+    sprite_pixel result;
+
+    result.position = float4(input.position, 0.0f, 1.0f);
+    result.uv = input.uv;
+    result.color = input.color;
+    result.texture_index = input.texture_index;
+
+    return result;
+}
+
+float4 ps_main(sprite_pixel input) : SV_Target
+{
+    float4 color;
+
+    color = input.color;
+
+    // Neighbouring pixels can be from different sprites, with
+    // different textures, so the index has to be marked non-uniform.
+    if (input.texture_index != NO_TEXTURE)
+    {
+        color *= textures[NonUniformResourceIndex(input.texture_index)].Sample(my_sampler, input.uv);
+    }
+
+    return color;
+}
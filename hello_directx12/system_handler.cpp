@@ -166,11 +166,23 @@ void run_system(system_handler* system) {
 	msg = {};
 
 	while (msg.message != WM_QUIT) {
+
+		//
+		// Handle every message that's waiting, not just one, so input
+		// doesn't lag behind when a lot of it comes in at once.
+		//
+
 		peek_result = PeekMessage(&msg, NULL, 0, 0, PM_REMOVE);
 
-		if (peek_result) {
+		while (peek_result && msg.message != WM_QUIT) {
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
+
+			peek_result = PeekMessage(&msg, NULL, 0, 0, PM_REMOVE);
+		}
+
+		if (msg.message == WM_QUIT) {
+			break;
 		}
 
 		//
@@ -211,6 +223,28 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 	case WM_DESTROY:
 		PostQuitMessage(0);
 		return 0;
+	case WM_KEYDOWN:
+		// F9 captures a profile of the next few frames.
+		if (wparam == VK_F9) {
+			start_profile_capture(get_profiler(), PROFILE_CAPTURE_FRAMES);
+		}
+
+		// Anything else might be for the game logic.
+		if (application_system && application_system->app) {
+			press_simulation_input(
+				&(application_system->app->sim),
+				get_simulation_buttons(wparam)
+			);
+		}
+		return 0;
+	case WM_KEYUP:
+		if (application_system && application_system->app) {
+			release_simulation_input(
+				&(application_system->app->sim),
+				get_simulation_buttons(wparam)
+			);
+		}
+		return 0;
 	default:
 		return DefWindowProc(hwnd, msg, wparam, lparam);
 	}
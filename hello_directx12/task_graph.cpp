@@ -0,0 +1,315 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "task_graph.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+// How wide the bars in the timeline are.
+const uint32_t TIMELINE_WIDTH = 40;
+
+static int64_t get_time_ns();
+static bool sort_tasks(task_graph* graph);
+static void run_task(void* data);
+
+task_graph::task_graph() {
+	system = NULL;
+	start_ns = 0;
+	end_ns = 0;
+	failed = false;
+}
+
+void reset_task_graph(task_graph* graph) {
+	graph->tasks.clear();
+	graph->order.clear();
+	graph->system = NULL;
+	graph->waiting.reset();
+	graph->start_ns = 0;
+	graph->end_ns = 0;
+	graph->error = NULL;
+	graph->failed.store(false);
+}
+
+uint32_t add_task(
+	task_graph* graph,
+	const char* name,
+	task_fn function,
+	void* data
+) {
+	task_graph_task task;
+
+	task.name = name;
+	task.function = function;
+	task.data = data;
+	task.graph = graph;
+	task.dependency_count = 0;
+	task.start_ns = 0;
+	task.end_ns = 0;
+	task.worker = JOB_NOT_A_WORKER;
+	task.skipped = false;
+
+	graph->tasks.push_back(task);
+
+	return (uint32_t)(graph->tasks.size() - 1);
+}
+
+void add_task_dependency(
+	task_graph* graph,
+	const uint32_t task,
+	const uint32_t depends_on
+) {
+	graph->tasks[depends_on].dependents.push_back(task);
+	graph->tasks[task].dependency_count++;
+}
+
+bool run_task_graph(task_graph* graph, job_system* system) {
+	vector<job_decl> roots;
+	size_t i;
+
+	if (!sort_tasks(graph)) {
+		return false;
+	}
+
+	graph->system = system;
+	graph->error = NULL;
+	graph->failed.store(false);
+	graph->waiting.reset(new atomic<uint32_t>[graph->tasks.size()]);
+
+	for (i = 0; i < graph->tasks.size(); i++) {
+		graph->waiting[i].store(graph->tasks[i].dependency_count);
+
+		if (graph->tasks[i].dependency_count == 0) {
+			roots.push_back({ run_task, &(graph->tasks[i]) });
+		}
+	}
+
+	//
+	// Start everything that doesn't depend on anything. The rest are
+	// started by the last of their dependencies to finish.
+	//
+
+	graph->start_ns = get_time_ns();
+
+	run_jobs(system, roots.data(), (uint32_t)roots.size(), &(graph->counter));
+	wait_for_counter(system, &(graph->counter));
+
+	graph->end_ns = get_time_ns();
+	graph->system = NULL;
+	graph->waiting.reset();
+
+	if (graph->error) {
+		rethrow_exception(graph->error);
+	}
+
+	return true;
+}
+
+task_graph_stats get_task_graph_stats(const task_graph* graph) {
+	task_graph_stats stats;
+	vector<int64_t> finish;
+	const task_graph_task* task;
+	int64_t duration;
+	size_t i;
+	size_t j;
+
+	stats = {};
+	stats.task_count = (uint32_t)graph->tasks.size();
+	stats.wall_ns = graph->end_ns - graph->start_ns;
+
+	//
+	// Work out the longest chain by going through the tasks in order:
+	// a task can't finish sooner than its slowest dependency plus its
+	// own time.
+	//
+
+	finish.assign(graph->tasks.size(), 0);
+
+	for (i = 0; i < graph->order.size(); i++) {
+		task = &(graph->tasks[graph->order[i]]);
+		duration = task->end_ns - task->start_ns;
+
+		stats.serial_ns += duration;
+		finish[graph->order[i]] += duration;
+
+		for (j = 0; j < task->dependents.size(); j++) {
+			finish[task->dependents[j]] = max(finish[task->dependents[j]], finish[graph->order[i]]);
+		}
+
+		stats.critical_path_ns = max(stats.critical_path_ns, finish[graph->order[i]]);
+	}
+
+	return stats;
+}
+
+string get_task_graph_timeline(const task_graph* graph) {
+	task_graph_stats stats;
+	vector<uint32_t> rows;
+	const task_graph_task* task;
+	string report;
+	string bar;
+	char line[256];
+	uint32_t first;
+	uint32_t last;
+	size_t i;
+
+	stats = get_task_graph_stats(graph);
+
+	snprintf(
+		line,
+		sizeof(line),
+		"%u tasks in %.1fms: %.1fms of work (%.2fx), critical path %.1fms\n"
+		"  start    time  worker  task\n",
+		stats.task_count,
+		(double)stats.wall_ns / 1000000.0,
+		(double)stats.serial_ns / 1000000.0,
+		stats.wall_ns > 0 ? (double)stats.serial_ns / (double)stats.wall_ns : 0.0,
+		(double)stats.critical_path_ns / 1000000.0
+	);
+
+	report = line;
+
+	// In the order they started.
+	rows = graph->order;
+	stable_sort(rows.begin(), rows.end(), [graph](const uint32_t a, const uint32_t b) {
+		return graph->tasks[a].start_ns < graph->tasks[b].start_ns;
+	});
+
+	for (i = 0; i < rows.size(); i++) {
+		task = &(graph->tasks[rows[i]]);
+
+		//
+		// Draw where the task falls in the whole run.
+		//
+
+		first = 0;
+		last = 0;
+
+		if (stats.wall_ns > 0) {
+			first = (uint32_t)(task->start_ns * TIMELINE_WIDTH / stats.wall_ns);
+			last = (uint32_t)(task->end_ns * TIMELINE_WIDTH / stats.wall_ns);
+		}
+
+		first = min(first, TIMELINE_WIDTH - 1);
+		last = max(min(last, TIMELINE_WIDTH), first + 1);
+
+		bar.assign(TIMELINE_WIDTH, '.');
+		bar.replace(first, last - first, last - first, task->skipped ? 'x' : '#');
+
+		snprintf(
+			line,
+			sizeof(line),
+			"%6.1fms %6.1fms  %6s  %-20s |%s|\n",
+			(double)task->start_ns / 1000000.0,
+			(double)(task->end_ns - task->start_ns) / 1000000.0,
+			task->worker == JOB_NOT_A_WORKER ? "-" : to_string(task->worker).c_str(),
+			task->name,
+			bar.c_str()
+		);
+
+		report += line;
+	}
+
+	return report;
+}
+
+static int64_t get_time_ns() {
+	return chrono::duration_cast<chrono::nanoseconds>(
+		chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+static bool sort_tasks(task_graph* graph) {
+	vector<uint32_t> waiting;
+	const task_graph_task* task;
+	size_t next;
+	size_t i;
+
+	//
+	// Start with the tasks that don't depend on anything, and add each
+	// task once everything it depends on has been added. If some never
+	// get added, they're waiting on each other.
+	//
+
+	graph->order.clear();
+	waiting.resize(graph->tasks.size());
+
+	for (i = 0; i < graph->tasks.size(); i++) {
+		waiting[i] = graph->tasks[i].dependency_count;
+
+		if (waiting[i] == 0) {
+			graph->order.push_back((uint32_t)i);
+		}
+	}
+
+	for (next = 0; next < graph->order.size(); next++) {
+		task = &(graph->tasks[graph->order[next]]);
+
+		for (i = 0; i < task->dependents.size(); i++) {
+			waiting[task->dependents[i]]--;
+
+			if (waiting[task->dependents[i]] == 0) {
+				graph->order.push_back(task->dependents[i]);
+			}
+		}
+	}
+
+	return graph->order.size() == graph->tasks.size();
+}
+
+static void run_task(void* data) {
+	task_graph_task* task;
+	task_graph* graph;
+	job_decl decl;
+	uint32_t dependent;
+	size_t i;
+
+	task = (task_graph_task*)data;
+	graph = task->graph;
+
+	task->worker = get_current_job_worker(graph->system);
+	task->start_ns = get_time_ns() - graph->start_ns;
+	task->skipped = graph->failed.load(memory_order_acquire);
+
+	//
+	// Once something has failed, there's no point doing anything more:
+	// run_task_graph is going to throw anyway. The tasks still go
+	// through the motions, so the graph finishes.
+	//
+
+	if (!task->skipped) {
+		PROFILE_ZONE(task->name);
+
+		try {
+			task->function(task->data);
+		} catch (...) {
+			lock_guard<mutex> lock(graph->error_lock);
+
+			if (!graph->error) {
+				graph->error = current_exception();
+			}
+
+			graph->failed.store(true, memory_order_release);
+		}
+	}
+
+	task->end_ns = get_time_ns() - graph->start_ns;
+
+	//
+	// Start whatever was only waiting on us. This job still counts
+	// against the graph's counter until it returns, so the counter
+	// can't reach zero in between.
+	//
+
+	for (i = 0; i < task->dependents.size(); i++) {
+		dependent = task->dependents[i];
+
+		if (graph->waiting[dependent].fetch_sub(1, memory_order_acq_rel) == 1) {
+			decl = { run_task, &(graph->tasks[dependent]) };
+			run_jobs(graph->system, &decl, 1, &(graph->counter));
+		}
+	}
+}
@@ -0,0 +1,121 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A task graph runs a handful of big, one-off steps (like loading the
+// assets at startup) on the job system, with each step starting as
+// soon as the steps it depends on are done. Steps that don't depend on
+// each other run at the same time.
+//
+// Using it looks like:
+//
+//	reset_task_graph(&graph);
+//	shaders = add_task(&graph, "shaders", load_shaders, app);
+//	root = add_task(&graph, "root signature", create_root_signature, app);
+//	pso = add_task(&graph, "pipeline state", create_pso, app);
+//	add_task_dependency(&graph, pso, shaders);
+//	add_task_dependency(&graph, pso, root);
+//	run_task_graph(&graph, &jobs);
+//
+// Each task records when it started and finished, and on which worker,
+// so afterwards get_task_graph_timeline shows where the time went.
+//
+// If a task throws, every task that hasn't started yet is skipped, and
+// run_task_graph throws the same exception once the ones already
+// running are done.
+//
+
+#pragma once
+
+#include "job_system.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef void (*task_fn)(void* data);
+
+struct task_graph;
+
+struct task_graph_task {
+	const char* name;
+	task_fn function;
+	void* data;
+
+	task_graph* graph;
+	// Tasks that depend on this one.
+	std::vector<uint32_t> dependents;
+	uint32_t dependency_count;
+
+	// Filled in by run_task_graph. Times are in nanoseconds from when
+	// the graph started.
+	int64_t start_ns;
+	int64_t end_ns;
+	uint32_t worker;
+	// Set if another task threw before this one started.
+	bool skipped;
+};
+
+struct task_graph_stats {
+	uint32_t task_count;
+	// How long the whole graph took.
+	int64_t wall_ns;
+	// How long it would have taken one task at a time.
+	int64_t serial_ns;
+	// The longest chain of dependent tasks. The graph can't finish
+	// faster than this, however many workers there are.
+	int64_t critical_path_ns;
+};
+
+struct task_graph {
+	task_graph();
+
+	std::vector<task_graph_task> tasks;
+	// Tasks in an order where each comes after its dependencies. Made
+	// by run_task_graph.
+	std::vector<uint32_t> order;
+
+	// Only used while the graph runs.
+	job_system* system;
+	job_counter counter;
+	// How many unfinished dependencies each task has.
+	std::unique_ptr<std::atomic<uint32_t>[]> waiting;
+	int64_t start_ns;
+	int64_t end_ns;
+
+	// The first exception a task threw, if any.
+	std::mutex error_lock;
+	std::exception_ptr error;
+	std::atomic<bool> failed;
+};
+
+void reset_task_graph(task_graph* graph);
+
+// Returns the task's index. name must outlive the graph (it's usually a
+// string literal), since the profiler holds on to it too.
+uint32_t add_task(
+	task_graph* graph,
+	const char* name,
+	task_fn function,
+	void* data
+);
+
+// task won't start until depends_on is done.
+void add_task_dependency(
+	task_graph* graph,
+	const uint32_t task,
+	const uint32_t depends_on
+);
+
+// Runs every task and returns once they're all done, helping out in
+// the meantime. Returns false without running anything if the
+// dependencies have a cycle.
+bool run_task_graph(task_graph* graph, job_system* system);
+
+task_graph_stats get_task_graph_stats(const task_graph* graph);
+// Every task's start, duration and worker, with a bar showing when it
+// ran.
+std::string get_task_graph_timeline(const task_graph* graph);
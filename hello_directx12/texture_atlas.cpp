@@ -0,0 +1,600 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// Shelves get their heights rounded up to this, so images that are
+// nearly the same height share them.
+const uint32_t ATLAS_SHELF_GRANULARITY = 8;
+
+static uint32_t align_up(const uint32_t value, const uint32_t alignment);
+static void get_padded_size(
+	const atlas_settings* settings,
+	const uint32_t width,
+	const uint32_t height,
+	uint32_t* padded_width,
+	uint32_t* padded_height
+);
+static bool fit_skyline(
+	const atlas_skyline* skyline,
+	const size_t index,
+	const uint32_t width,
+	const uint32_t height,
+	uint32_t* y
+);
+static bool has_shelf_room(const atlas_shelf* shelf, const uint32_t width);
+static bool take_shelf_span(atlas_shelf* shelf, const uint32_t width, uint32_t* x);
+
+atlas_skyline::atlas_skyline() {
+	width = 0;
+	height = 0;
+	used_area = 0;
+}
+
+atlas_allocator::atlas_allocator() {
+	settings = {};
+	top = 0;
+	image_count = 0;
+	image_area = 0;
+	allocations = 0;
+	failures = 0;
+}
+
+uint32_t get_atlas_gutter(const atlas_settings* settings) {
+	return settings->padding << (max(settings->mip_levels, 1u) - 1);
+}
+
+uint32_t get_atlas_alignment(const atlas_settings* settings) {
+	return 1u << (max(settings->mip_levels, 1u) - 1);
+}
+
+void initialize_atlas_skyline(atlas_skyline* skyline, const uint32_t width, const uint32_t height) {
+	atlas_skyline_node node;
+
+	skyline->width = width;
+	skyline->height = height;
+	skyline->used_area = 0;
+
+	// The whole page is one run at the bottom to begin with.
+	node.x = 0;
+	node.y = 0;
+	node.width = width;
+
+	skyline->nodes.clear();
+	skyline->nodes.push_back(node);
+}
+
+bool insert_atlas_skyline(
+	atlas_skyline* skyline,
+	const uint32_t width,
+	const uint32_t height,
+	uint32_t* x,
+	uint32_t* y
+) {
+	atlas_skyline_node node;
+	uint32_t best_top;
+	uint32_t best_width;
+	size_t best_index;
+	uint32_t node_y;
+	uint32_t shrink;
+	size_t i;
+
+	//
+	// Try the rectangle at the start of every run, and keep whichever
+	// leaves its top lowest. Ties go to the narrowest run, which
+	// leaves the wide ones for wide rectangles.
+	//
+
+	best_top = UINT_MAX;
+	best_width = UINT_MAX;
+	best_index = skyline->nodes.size();
+
+	for (i = 0; i < skyline->nodes.size(); i++) {
+		if (!fit_skyline(skyline, i, width, height, &node_y)) {
+			continue;
+		}
+
+		if (node_y + height < best_top ||
+			(node_y + height == best_top && skyline->nodes[i].width < best_width))
+		{
+			best_top = node_y + height;
+			best_width = skyline->nodes[i].width;
+			best_index = i;
+			*y = node_y;
+		}
+	}
+
+	if (best_index == skyline->nodes.size()) {
+		return false;
+	}
+
+	*x = skyline->nodes[best_index].x;
+
+	//
+	// The rectangle becomes a new run, and covers up the start of
+	// whatever runs it sits on.
+	//
+
+	node.x = *x;
+	node.y = best_top;
+	node.width = width;
+	skyline->nodes.insert(skyline->nodes.begin() + best_index, node);
+
+	i = best_index + 1;
+	while (i < skyline->nodes.size()) {
+		if (skyline->nodes[i].x >= node.x + node.width) {
+			break;
+		}
+
+		shrink = node.x + node.width - skyline->nodes[i].x;
+		if (shrink < skyline->nodes[i].width) {
+			skyline->nodes[i].x += shrink;
+			skyline->nodes[i].width -= shrink;
+			break;
+		}
+
+		skyline->nodes.erase(skyline->nodes.begin() + i);
+	}
+
+	//
+	// Merge neighbouring runs at the same height.
+	//
+
+	i = best_index > 0 ? best_index - 1 : 0;
+	while (i + 1 < skyline->nodes.size() && i <= best_index + 1) {
+		if (skyline->nodes[i].y == skyline->nodes[i + 1].y) {
+			skyline->nodes[i].width += skyline->nodes[i + 1].width;
+			skyline->nodes.erase(skyline->nodes.begin() + i + 1);
+		} else {
+			i++;
+		}
+	}
+
+	skyline->used_area += (uint64_t)width * height;
+
+	return true;
+}
+
+uint32_t pack_atlas(const atlas_settings* settings, vector<atlas_rect>* rects) {
+	vector<atlas_skyline> pages;
+	vector<uint32_t> order;
+	atlas_rect* rect;
+	uint32_t gutter;
+	uint32_t padded_width;
+	uint32_t padded_height;
+	uint32_t x;
+	uint32_t y;
+	size_t page;
+	size_t i;
+
+	gutter = get_atlas_gutter(settings);
+
+	//
+	// Tallest first, then widest. Packing big rectangles first leaves
+	// the small ones to fill the gaps, and keeps the skyline flat.
+	//
+
+	order.resize(rects->size());
+	for (i = 0; i < order.size(); i++) {
+		order[i] = (uint32_t)i;
+	}
+
+	sort(
+		order.begin(),
+		order.end(),
+		[rects](const uint32_t a, const uint32_t b) {
+			const atlas_rect& first = (*rects)[a];
+			const atlas_rect& second = (*rects)[b];
+
+			if (first.height != second.height) {
+				return first.height > second.height;
+			}
+
+			if (first.width != second.width) {
+				return first.width > second.width;
+			}
+
+			return a < b;
+		}
+	);
+
+	for (i = 0; i < order.size(); i++) {
+		rect = &((*rects)[order[i]]);
+		rect->page = ATLAS_NO_PAGE;
+
+		get_padded_size(settings, rect->width, rect->height, &padded_width, &padded_height);
+		if (padded_width > settings->page_width || padded_height > settings->page_height) {
+			continue;
+		}
+
+		// The first page with room for it, or a new one.
+		for (page = 0; page < pages.size(); page++) {
+			if (insert_atlas_skyline(&(pages[page]), padded_width, padded_height, &x, &y)) {
+				break;
+			}
+		}
+
+		if (page == pages.size()) {
+			pages.emplace_back();
+			initialize_atlas_skyline(&(pages[page]), settings->page_width, settings->page_height);
+			insert_atlas_skyline(&(pages[page]), padded_width, padded_height, &x, &y);
+		}
+
+		rect->x = x + gutter;
+		rect->y = y + gutter;
+		rect->page = (uint32_t)page;
+	}
+
+	return (uint32_t)pages.size();
+}
+
+void initialize_atlas_allocator(atlas_allocator* allocator, const atlas_settings* settings) {
+	allocator->settings = *settings;
+	allocator->shelves.clear();
+	allocator->top = 0;
+	allocator->image_count = 0;
+	allocator->image_area = 0;
+	allocator->allocations = 0;
+	allocator->failures = 0;
+}
+
+bool allocate_atlas_rect(
+	atlas_allocator* allocator,
+	const uint32_t width,
+	const uint32_t height,
+	atlas_rect* rect
+) {
+	atlas_shelf shelf;
+	atlas_shelf* best;
+	atlas_shelf* candidate;
+	uint32_t gutter;
+	uint32_t padded_width;
+	uint32_t padded_height;
+	uint32_t shelf_height;
+	uint32_t x;
+	size_t i;
+
+	allocator->allocations++;
+
+	gutter = get_atlas_gutter(&(allocator->settings));
+	get_padded_size(&(allocator->settings), width, height, &padded_width, &padded_height);
+	shelf_height = align_up(padded_height, max(ATLAS_SHELF_GRANULARITY, get_atlas_alignment(&(allocator->settings))));
+
+	rect->width = width;
+	rect->height = height;
+	rect->page = ATLAS_NO_PAGE;
+
+	//
+	// Look for the shortest shelf it fits on that won't waste more
+	// than half its height. Empty shelves can take anything that fits,
+	// since there's nothing on them to waste space next to.
+	//
+
+	best = NULL;
+	x = 0;
+
+	for (i = 0; i < allocator->shelves.size(); i++) {
+		candidate = &(allocator->shelves[i]);
+
+		if (candidate->height < padded_height) {
+			continue;
+		}
+
+		if (candidate->used_width > 0 && candidate->height > padded_height * 2) {
+			continue;
+		}
+
+		if (best && candidate->height >= best->height) {
+			continue;
+		}
+
+		if (has_shelf_room(candidate, padded_width)) {
+			best = candidate;
+		}
+	}
+
+	//
+	// Otherwise start a new shelf, if there's room at the top.
+	//
+
+	if (!best && padded_width <= allocator->settings.page_width) {
+		if (allocator->top + shelf_height <= allocator->settings.page_height) {
+			shelf.y = allocator->top;
+			shelf.height = shelf_height;
+			shelf.used_width = 0;
+			shelf.free_spans.push_back({ 0, allocator->settings.page_width });
+
+			allocator->shelves.push_back(shelf);
+			allocator->top += shelf_height;
+			best = &(allocator->shelves.back());
+		}
+	}
+
+	//
+	// As a last resort, put up with the waste.
+	//
+
+	if (!best) {
+		for (i = 0; i < allocator->shelves.size(); i++) {
+			candidate = &(allocator->shelves[i]);
+
+			if (candidate->height < padded_height) {
+				continue;
+			}
+
+			if (take_shelf_span(candidate, padded_width, &x)) {
+				best = candidate;
+				break;
+			}
+		}
+
+		if (!best) {
+			allocator->failures++;
+			return false;
+		}
+	} else {
+		take_shelf_span(best, padded_width, &x);
+	}
+
+	rect->x = x + gutter;
+	rect->y = best->y + gutter;
+	rect->page = 0;
+
+	allocator->image_count++;
+	allocator->image_area += (uint64_t)width * height;
+
+	return true;
+}
+
+void free_atlas_rect(atlas_allocator* allocator, const atlas_rect* rect) {
+	vector<atlas_shelf>::iterator shelf;
+	vector<atlas_span>::iterator next;
+	atlas_span span;
+	uint32_t gutter;
+	uint32_t padded_width;
+	uint32_t padded_height;
+
+	if (rect->page == ATLAS_NO_PAGE) {
+		return;
+	}
+
+	gutter = get_atlas_gutter(&(allocator->settings));
+	get_padded_size(&(allocator->settings), rect->width, rect->height, &padded_width, &padded_height);
+
+	// Shelves are kept in order of y.
+	shelf = upper_bound(
+		allocator->shelves.begin(),
+		allocator->shelves.end(),
+		rect->y - gutter,
+		[](const uint32_t y, const atlas_shelf& s) { return y < s.y; }
+	);
+	shelf--;
+
+	//
+	// Put the span back, merging it with whatever free space is either
+	// side of it.
+	//
+
+	span.x = rect->x - gutter;
+	span.width = padded_width;
+
+	next = lower_bound(
+		shelf->free_spans.begin(),
+		shelf->free_spans.end(),
+		span.x,
+		[](const atlas_span& s, const uint32_t x) { return s.x < x; }
+	);
+
+	if (next != shelf->free_spans.end() && span.x + span.width == next->x) {
+		span.width += next->width;
+		next = shelf->free_spans.erase(next);
+	}
+
+	if (next != shelf->free_spans.begin() && (next - 1)->x + (next - 1)->width == span.x) {
+		(next - 1)->width += span.width;
+	} else {
+		shelf->free_spans.insert(next, span);
+	}
+
+	shelf->used_width -= padded_width;
+
+	allocator->image_count--;
+	allocator->image_area -= (uint64_t)rect->width * rect->height;
+
+	//
+	// Empty shelves at the top go, so their space can be a shelf of
+	// any height again.
+	//
+
+	while (!allocator->shelves.empty() && allocator->shelves.back().used_width == 0) {
+		allocator->top = allocator->shelves.back().y;
+		allocator->shelves.pop_back();
+	}
+}
+
+void get_atlas_uv_transform(
+	const atlas_settings* settings,
+	const atlas_rect* rect,
+	float scale[2],
+	float offset[2]
+) {
+	scale[0] = (float)rect->width / settings->page_width;
+	scale[1] = (float)rect->height / settings->page_height;
+	offset[0] = (float)rect->x / settings->page_width;
+	offset[1] = (float)rect->y / settings->page_height;
+}
+
+void copy_atlas_image(
+	const atlas_settings* settings,
+	const atlas_rect* rect,
+	const uint8_t* image,
+	const uint32_t image_pitch,
+	const uint32_t pixel_size,
+	uint8_t* page,
+	const uint32_t page_pitch
+) {
+	const uint8_t* source;
+	uint8_t* destination;
+	uint32_t gutter;
+	int64_t row;
+	int64_t source_row;
+	uint32_t i;
+
+	gutter = get_atlas_gutter(settings);
+
+	//
+	// Every row of the gutter above and below is a copy of the nearest
+	// edge row, and every row is extended left and right by copies of
+	// its edge pixels. So the gutter's corners are the corner pixels.
+	//
+
+	for (row = -(int64_t)gutter; row < (int64_t)rect->height + gutter; row++) {
+		source_row = min(max(row, (int64_t)0), (int64_t)rect->height - 1);
+		source = image + source_row * image_pitch;
+		destination = page + (rect->y + row) * page_pitch + (size_t)(rect->x - gutter) * pixel_size;
+
+		for (i = 0; i < gutter; i++) {
+			memcpy(destination + (size_t)i * pixel_size, source, pixel_size);
+		}
+
+		destination += (size_t)gutter * pixel_size;
+		memcpy(destination, source, (size_t)rect->width * pixel_size);
+
+		destination += (size_t)rect->width * pixel_size;
+		source += (size_t)(rect->width - 1) * pixel_size;
+		for (i = 0; i < gutter; i++) {
+			memcpy(destination + (size_t)i * pixel_size, source, pixel_size);
+		}
+	}
+}
+
+atlas_allocator_stats get_atlas_allocator_stats(const atlas_allocator* allocator) {
+	atlas_allocator_stats stats;
+
+	stats.image_count = allocator->image_count;
+	stats.shelf_count = (uint32_t)allocator->shelves.size();
+	stats.image_area = allocator->image_area;
+	stats.page_area = (uint64_t)allocator->settings.page_width * allocator->settings.page_height;
+	stats.allocations = allocator->allocations;
+	stats.failures = allocator->failures;
+
+	return stats;
+}
+
+string get_atlas_allocator_report(const atlas_allocator* allocator) {
+	atlas_allocator_stats stats;
+	char report[256];
+
+	stats = get_atlas_allocator_stats(allocator);
+
+	snprintf(
+		report,
+		sizeof(report),
+		"Atlas: %u images on %u shelves, %.1f%% of the page, %llu allocations, %llu failed\n",
+		stats.image_count,
+		stats.shelf_count,
+		stats.page_area > 0 ? 100.0 * stats.image_area / stats.page_area : 0.0,
+		(unsigned long long)stats.allocations,
+		(unsigned long long)stats.failures
+	);
+
+	return report;
+}
+
+static uint32_t align_up(const uint32_t value, const uint32_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static void get_padded_size(
+	const atlas_settings* settings,
+	const uint32_t width,
+	const uint32_t height,
+	uint32_t* padded_width,
+	uint32_t* padded_height
+) {
+	uint32_t gutter;
+	uint32_t alignment;
+
+	gutter = get_atlas_gutter(settings);
+	alignment = get_atlas_alignment(settings);
+
+	*padded_width = align_up(width + 2 * gutter, alignment);
+	*padded_height = align_up(height + 2 * gutter, alignment);
+}
+
+static bool fit_skyline(
+	const atlas_skyline* skyline,
+	const size_t index,
+	const uint32_t width,
+	const uint32_t height,
+	uint32_t* y
+) {
+	uint32_t remaining;
+	size_t i;
+
+	if (skyline->nodes[index].x + width > skyline->width) {
+		return false;
+	}
+
+	//
+	// The rectangle has to sit on top of the highest run it covers.
+	//
+
+	*y = 0;
+	remaining = width;
+	i = index;
+
+	while (remaining > 0) {
+		*y = max(*y, skyline->nodes[i].y);
+		if (*y + height > skyline->height) {
+			return false;
+		}
+
+		remaining -= min(remaining, skyline->nodes[i].width);
+		i++;
+	}
+
+	return true;
+}
+
+static bool has_shelf_room(const atlas_shelf* shelf, const uint32_t width) {
+	size_t i;
+
+	for (i = 0; i < shelf->free_spans.size(); i++) {
+		if (shelf->free_spans[i].width >= width) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool take_shelf_span(atlas_shelf* shelf, const uint32_t width, uint32_t* x) {
+	size_t i;
+
+	// First fit.
+	for (i = 0; i < shelf->free_spans.size(); i++) {
+		if (shelf->free_spans[i].width < width) {
+			continue;
+		}
+
+		*x = shelf->free_spans[i].x;
+		shelf->free_spans[i].x += width;
+		shelf->free_spans[i].width -= width;
+
+		if (shelf->free_spans[i].width == 0) {
+			shelf->free_spans.erase(shelf->free_spans.begin() + i);
+		}
+
+		shelf->used_width += width;
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,172 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Texture atlases: lots of small images (icons, sprites, decals) packed
+// into a few big textures, so they cost one resource and one texture
+// slot between them instead of one each. Whatever samples an image
+// just remaps its UVs into the image's rectangle (see
+// get_atlas_uv_transform, which fits a material's uv_scale and
+// uv_offset).
+//
+// There are two ways to place images:
+//
+// - pack_atlas is for building atlases ahead of time, when every image
+//   is known up front. It sorts them tallest first and packs them with
+//   a skyline packer, opening pages as it needs them.
+// - atlas_allocator is for images that come and go at runtime. It
+//   places them on shelves (rows of images about the same height) and
+//   can free them again.
+//
+// Either way, every image gets a gutter around it that's filled with
+// copies of its edge pixels (see copy_atlas_image), so filtering near
+// the edge never picks up the neighbouring image. Mipmapping halves the
+// gutter at each level, so the gutter starts out at padding << (mips -
+// 1) texels and every rectangle is aligned to 1 << (mips - 1). That way
+// each image still has padding texels of gutter, and starts on a texel,
+// at its smallest mip.
+//
+// None of this touches D3D. The application creates the textures and
+// copies the images in.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint32_t ATLAS_NO_PAGE = 0xffffffff;
+
+struct atlas_settings {
+	uint32_t page_width;
+	uint32_t page_height;
+	// Texels of gutter around each image at its smallest mip.
+	uint32_t padding;
+	// Mip levels the atlas textures will have. At least 1.
+	uint32_t mip_levels;
+};
+
+// Where an image is. x and y are where the image itself starts, past
+// its gutter.
+struct atlas_rect {
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+	// ATLAS_NO_PAGE if the image didn't fit.
+	uint32_t page;
+};
+
+// A run of the skyline: everything from x to x + width is used up to y.
+struct atlas_skyline_node {
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+};
+
+// Packs rectangles into one page, bottom-left first.
+struct atlas_skyline {
+	atlas_skyline();
+
+	uint32_t width;
+	uint32_t height;
+	std::vector<atlas_skyline_node> nodes;
+	uint64_t used_area;
+};
+
+// A run of free space on a shelf.
+struct atlas_span {
+	uint32_t x;
+	uint32_t width;
+};
+
+struct atlas_shelf {
+	uint32_t y;
+	uint32_t height;
+	// Sorted by x, and never touching.
+	std::vector<atlas_span> free_spans;
+	uint32_t used_width;
+};
+
+struct atlas_allocator_stats {
+	uint32_t image_count;
+	uint32_t shelf_count;
+	// The area of the images, without their gutters or alignment.
+	uint64_t image_area;
+	uint64_t page_area;
+	uint64_t allocations;
+	uint64_t failures;
+};
+
+// Places images on one page at runtime.
+struct atlas_allocator {
+	atlas_allocator();
+
+	atlas_settings settings;
+	std::vector<atlas_shelf> shelves;
+	// Where the next shelf goes.
+	uint32_t top;
+
+	uint32_t image_count;
+	uint64_t image_area;
+	uint64_t allocations;
+	uint64_t failures;
+};
+
+// How much gutter goes around each image, and what rectangles are
+// aligned to.
+uint32_t get_atlas_gutter(const atlas_settings* settings);
+uint32_t get_atlas_alignment(const atlas_settings* settings);
+
+void initialize_atlas_skyline(atlas_skyline* skyline, const uint32_t width, const uint32_t height);
+// Finds room for a width by height rectangle, which includes any
+// gutter. Returns false if there isn't any.
+bool insert_atlas_skyline(
+	atlas_skyline* skyline,
+	const uint32_t width,
+	const uint32_t height,
+	uint32_t* x,
+	uint32_t* y
+);
+
+// Places every rectangle, using each one's width and height and filling
+// in the rest. Images too big for a page get ATLAS_NO_PAGE. Returns how
+// many pages were used.
+uint32_t pack_atlas(const atlas_settings* settings, std::vector<atlas_rect>* rects);
+
+void initialize_atlas_allocator(atlas_allocator* allocator, const atlas_settings* settings);
+// Finds room for a width by height image. Returns false, with rect's
+// page set to ATLAS_NO_PAGE, if the page is full.
+bool allocate_atlas_rect(
+	atlas_allocator* allocator,
+	const uint32_t width,
+	const uint32_t height,
+	atlas_rect* rect
+);
+// Gives an image's room back. rect must be what allocate_atlas_rect
+// gave out.
+void free_atlas_rect(atlas_allocator* allocator, const atlas_rect* rect);
+
+// The scale and offset that take an image's UVs, from 0 to 1, to where
+// it is on its page.
+void get_atlas_uv_transform(
+	const atlas_settings* settings,
+	const atlas_rect* rect,
+	float scale[2],
+	float offset[2]
+);
+
+// Copies an image into its place on a page, and fills its gutter with
+// its edge pixels. page_pitch and image_pitch are in bytes.
+void copy_atlas_image(
+	const atlas_settings* settings,
+	const atlas_rect* rect,
+	const uint8_t* image,
+	const uint32_t image_pitch,
+	const uint32_t pixel_size,
+	uint8_t* page,
+	const uint32_t page_pitch
+);
+
+atlas_allocator_stats get_atlas_allocator_stats(const atlas_allocator* allocator);
+std::string get_atlas_allocator_report(const atlas_allocator* allocator);
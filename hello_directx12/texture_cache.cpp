@@ -0,0 +1,489 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "texture_cache.h"
+#include "hash_utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+using namespace std;
+
+const uint32_t TEXTURE_DECODING = 0;
+const uint32_t TEXTURE_READY = 1;
+const uint32_t TEXTURE_FAILED = 2;
+
+// Set in references once an entry's been evicted.
+const uint32_t TEXTURE_EVICTED = 0x80000000;
+
+// Eviction goes until the cache is this far under budget (an eighth of
+// it), so it doesn't have to happen again for a while.
+const uint32_t TEXTURE_EVICTION_SLACK_SHIFT = 3;
+
+struct eviction_candidate {
+	uint64_t last_used;
+	texture_cache_entry* entry;
+};
+
+static texture_cache_shard* get_shard(texture_cache* cache, const uint64_t key);
+static uint32_t get_bucket(const uint64_t key);
+static texture_cache_entry* find_entry(
+	texture_cache_shard* shard,
+	const uint64_t key,
+	const uint64_t path_hash,
+	const uint64_t content_hash
+);
+static bool try_reference(texture_cache_entry* entry);
+static texture_cache_entry* finish_lookup(texture_cache* cache, texture_cache_entry* entry);
+static void evict_textures(texture_cache* cache);
+static bool evict_entry(texture_cache* cache, texture_cache_entry* entry);
+static void free_retired(texture_cache_shard* shard);
+static bool compare_candidates(const eviction_candidate& a, const eviction_candidate& b);
+
+texture_cache_entry::texture_cache_entry() {
+	path_hash = 0;
+	content_hash = 0;
+	key = 0;
+	references = 0;
+	state = TEXTURE_DECODING;
+	last_used = 0;
+	next = NULL;
+}
+
+texture_cache_shard::texture_cache_shard() {
+	uint32_t i;
+
+	for (i = 0; i < TEXTURE_CACHE_BUCKETS; i++) {
+		buckets[i] = NULL;
+	}
+
+	readers = 0;
+	entry_count = 0;
+	hits = 0;
+}
+
+texture_cache::texture_cache() {
+	budget = 0;
+	bytes = 0;
+	peak_bytes = 0;
+	clock = 0;
+	misses = 0;
+	shared_decodes = 0;
+	failures = 0;
+	evictions = 0;
+}
+
+void initialize_texture_cache(texture_cache* cache, const uint64_t budget) {
+	uint32_t i;
+
+	cache->budget = budget;
+	cache->bytes = 0;
+	cache->peak_bytes = 0;
+	cache->clock = 0;
+	cache->misses = 0;
+	cache->shared_decodes = 0;
+	cache->failures = 0;
+	cache->evictions = 0;
+
+	for (i = 0; i < TEXTURE_CACHE_SHARDS; i++) {
+		cache->shards[i].hits = 0;
+	}
+}
+
+void shutdown_texture_cache(texture_cache* cache) {
+	texture_cache_shard* shard;
+	texture_cache_entry* entry;
+	texture_cache_entry* next;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < TEXTURE_CACHE_SHARDS; i++) {
+		shard = &(cache->shards[i]);
+		lock_guard<mutex> guard(shard->lock);
+
+		for (j = 0; j < TEXTURE_CACHE_BUCKETS; j++) {
+			entry = shard->buckets[j].load();
+
+			while (entry) {
+				next = entry->next.load();
+				delete entry;
+				entry = next;
+			}
+
+			shard->buckets[j] = NULL;
+		}
+
+		free_retired(shard);
+		shard->entry_count = 0;
+	}
+
+	cache->bytes = 0;
+}
+
+texture_cache_entry* acquire_texture(
+	texture_cache* cache,
+	const string& path,
+	const uint64_t content_hash,
+	texture_decode_function decode,
+	void* data
+) {
+	texture_cache_shard* shard;
+	texture_cache_entry* entry;
+	uint64_t path_hash;
+	uint64_t key;
+	uint64_t total;
+	uint64_t peak;
+	bool acquired;
+	bool succeeded;
+
+	// These keys are only ever in memory, so unlike hash_string's, they
+	// don't need to be the same from run to run. std::hash is a lot
+	// faster on a path, which matters when a hit is this cheap.
+	path_hash = (uint64_t)std::hash<string>()(path);
+	key = hash_combine(path_hash, content_hash);
+	shard = get_shard(cache, key);
+
+	//
+	// Most of the time it's there, and this is all it takes.
+	//
+
+	shard->readers.fetch_add(1);
+	entry = find_entry(shard, key, path_hash, content_hash);
+	acquired = entry && try_reference(entry);
+	shard->readers.fetch_sub(1);
+
+	if (acquired) {
+		return finish_lookup(cache, entry);
+	}
+
+	//
+	// It isn't, or it was just evicted. Look again with the shard
+	// locked, since someone might have added it in the meantime, and
+	// add it if not. Entries are only unlinked with the lock held, so
+	// whatever's found now can be referenced.
+	//
+
+	{
+		lock_guard<mutex> guard(shard->lock);
+
+		entry = find_entry(shard, key, path_hash, content_hash);
+
+		if (entry) {
+			entry->references.fetch_add(1);
+		} else {
+			entry = new texture_cache_entry;
+			entry->path_hash = path_hash;
+			entry->content_hash = content_hash;
+			entry->key = key;
+			entry->references = 1;
+			entry->last_used = cache->clock.load(memory_order_relaxed);
+			entry->next = shard->buckets[get_bucket(key)].load();
+
+			// Whoever finds it now waits for the decode.
+			shard->buckets[get_bucket(key)].store(entry);
+			shard->entry_count++;
+			acquired = true;
+		}
+	}
+
+	if (!acquired) {
+		return finish_lookup(cache, entry);
+	}
+
+	//
+	// It's ours to decode, which happens without any lock held.
+	//
+
+	cache->misses.fetch_add(1, memory_order_relaxed);
+	cache->clock.fetch_add(1, memory_order_relaxed);
+
+	succeeded = decode(data, &(entry->pixels));
+
+	if (!succeeded) {
+		vector<uint8_t>().swap(entry->pixels);
+		cache->failures.fetch_add(1, memory_order_relaxed);
+	}
+
+	total = cache->bytes.fetch_add(entry->pixels.size()) + entry->pixels.size();
+	peak = cache->peak_bytes.load();
+	while (total > peak && !cache->peak_bytes.compare_exchange_weak(peak, total)) {
+	}
+
+	// The lock is so a waiter can't see it still decoding, then miss
+	// the notify and sleep.
+	{
+		lock_guard<mutex> guard(cache->decode_lock);
+		entry->state.store(succeeded ? TEXTURE_READY : TEXTURE_FAILED, memory_order_release);
+	}
+
+	cache->decoded.notify_all();
+
+	if (total > cache->budget) {
+		evict_textures(cache);
+	}
+
+	if (!succeeded) {
+		release_texture(cache, entry);
+		return NULL;
+	}
+
+	return entry;
+}
+
+void retain_texture(texture_cache_entry* texture) {
+	texture->references.fetch_add(1);
+}
+
+void release_texture(texture_cache* cache, texture_cache_entry* texture) {
+	if (!texture) {
+		return;
+	}
+
+	// Nobody else can be using it, so it can go, if something has to.
+	if (texture->references.fetch_sub(1, memory_order_acq_rel) == 1 && cache->bytes.load() > cache->budget) {
+		evict_textures(cache);
+	}
+}
+
+texture_cache_stats get_texture_cache_stats(texture_cache* cache) {
+	texture_cache_stats stats;
+	uint32_t i;
+
+	stats = {};
+	stats.bytes = cache->bytes.load();
+	stats.peak_bytes = cache->peak_bytes.load();
+	stats.budget = cache->budget;
+	stats.misses = cache->misses.load();
+	stats.shared_decodes = cache->shared_decodes.load();
+	stats.failures = cache->failures.load();
+	stats.evictions = cache->evictions.load();
+
+	for (i = 0; i < TEXTURE_CACHE_SHARDS; i++) {
+		lock_guard<mutex> guard(cache->shards[i].lock);
+
+		stats.entry_count += cache->shards[i].entry_count;
+		stats.hits += cache->shards[i].hits.load();
+	}
+
+	return stats;
+}
+
+string get_texture_cache_report(texture_cache* cache) {
+	texture_cache_stats stats;
+	uint64_t lookups;
+	char line[256];
+	string report;
+
+	stats = get_texture_cache_stats(cache);
+	lookups = stats.hits + stats.misses + stats.shared_decodes;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"Texture cache: %u textures, %.2fMB of %.2fMB (peak %.2fMB)\n",
+		stats.entry_count,
+		stats.bytes / (1024.0 * 1024.0),
+		stats.budget / (1024.0 * 1024.0),
+		stats.peak_bytes / (1024.0 * 1024.0)
+	);
+	report += line;
+
+	snprintf(
+		line,
+		sizeof(line),
+		"  %llu hits, %llu misses (%.1f%% hit), %llu waited on a decode, %llu failed, %llu evicted\n",
+		(unsigned long long)stats.hits,
+		(unsigned long long)stats.misses,
+		lookups > 0 ? 100.0 * stats.hits / lookups : 0.0,
+		(unsigned long long)stats.shared_decodes,
+		(unsigned long long)stats.failures,
+		(unsigned long long)stats.evictions
+	);
+	report += line;
+
+	return report;
+}
+
+static texture_cache_shard* get_shard(texture_cache* cache, const uint64_t key) {
+	// The top bits, since the bucket uses the bottom ones.
+	return &(cache->shards[(key >> 32) % TEXTURE_CACHE_SHARDS]);
+}
+
+static uint32_t get_bucket(const uint64_t key) {
+	return (uint32_t)(key % TEXTURE_CACHE_BUCKETS);
+}
+
+static texture_cache_entry* find_entry(
+	texture_cache_shard* shard,
+	const uint64_t key,
+	const uint64_t path_hash,
+	const uint64_t content_hash
+) {
+	texture_cache_entry* entry;
+
+	entry = shard->buckets[get_bucket(key)].load();
+
+	while (entry) {
+		if (entry->path_hash == path_hash && entry->content_hash == content_hash) {
+			return entry;
+		}
+
+		entry = entry->next.load();
+	}
+
+	return NULL;
+}
+
+static bool try_reference(texture_cache_entry* entry) {
+	uint32_t references;
+
+	references = entry->references.load();
+
+	do {
+		if (references & TEXTURE_EVICTED) {
+			return false;
+		}
+	} while (!entry->references.compare_exchange_weak(references, references + 1));
+
+	return true;
+}
+
+static texture_cache_entry* finish_lookup(texture_cache* cache, texture_cache_entry* entry) {
+	uint32_t state;
+
+	entry->last_used.store(cache->clock.load(memory_order_relaxed), memory_order_relaxed);
+	state = entry->state.load(memory_order_acquire);
+
+	//
+	// Someone else is decoding it. Wait for them.
+	//
+
+	if (state == TEXTURE_DECODING) {
+		cache->shared_decodes.fetch_add(1, memory_order_relaxed);
+
+		unique_lock<mutex> guard(cache->decode_lock);
+
+		while ((state = entry->state.load(memory_order_acquire)) == TEXTURE_DECODING) {
+			cache->decoded.wait(guard);
+		}
+	} else {
+		get_shard(cache, entry->key)->hits.fetch_add(1, memory_order_relaxed);
+	}
+
+	if (state == TEXTURE_FAILED) {
+		release_texture(cache, entry);
+		return NULL;
+	}
+
+	return entry;
+}
+
+static void evict_textures(texture_cache* cache) {
+	vector<eviction_candidate> candidates;
+	eviction_candidate candidate;
+	texture_cache_shard* shard;
+	texture_cache_entry* entry;
+	uint64_t target;
+	uint32_t evicted;
+	uint32_t i;
+	uint32_t j;
+	size_t k;
+
+	unique_lock<mutex> evicting(cache->eviction_lock, try_to_lock);
+	if (!evicting.owns_lock()) {
+		return;
+	}
+
+	target = cache->budget - (cache->budget >> TEXTURE_EVICTION_SLACK_SHIFT);
+
+	//
+	// Everything nobody's using, oldest first. Something might pick one
+	// up between here and evicting it, in which case it's skipped. And
+	// textures might be let go of meanwhile, by threads that leave the
+	// evicting to this one, so go round again while that helps.
+	//
+
+	do {
+		candidates.clear();
+
+		for (i = 0; i < TEXTURE_CACHE_SHARDS; i++) {
+			shard = &(cache->shards[i]);
+			lock_guard<mutex> guard(shard->lock);
+
+			for (j = 0; j < TEXTURE_CACHE_BUCKETS; j++) {
+				for (entry = shard->buckets[j].load(); entry; entry = entry->next.load()) {
+					if (entry->references.load() == 0) {
+						candidate.last_used = entry->last_used.load(memory_order_relaxed);
+						candidate.entry = entry;
+						candidates.push_back(candidate);
+					}
+				}
+			}
+		}
+
+		sort(candidates.begin(), candidates.end(), compare_candidates);
+		evicted = 0;
+
+		for (k = 0; k < candidates.size() && cache->bytes.load() > target; k++) {
+			evicted += evict_entry(cache, candidates[k].entry) ? 1 : 0;
+		}
+	} while (evicted > 0 && cache->bytes.load() > target);
+}
+
+static bool evict_entry(texture_cache* cache, texture_cache_entry* entry) {
+	texture_cache_shard* shard;
+	atomic<texture_cache_entry*>* link;
+	uint32_t references;
+
+	shard = get_shard(cache, entry->key);
+	lock_guard<mutex> guard(shard->lock);
+
+	// Only if nobody's taken a reference since it was picked. After
+	// this, nobody can. It's still linked in, so it can't have been
+	// deleted yet either.
+	references = 0;
+	if (!entry->references.compare_exchange_strong(references, TEXTURE_EVICTED)) {
+		return false;
+	}
+
+	link = &(shard->buckets[get_bucket(entry->key)]);
+	while (link->load() != entry) {
+		link = &(link->load()->next);
+	}
+
+	// Lookups already on it carry on to the next one from it.
+	link->store(entry->next.load());
+	shard->entry_count--;
+
+	cache->bytes.fetch_sub(entry->pixels.size());
+	cache->evictions.fetch_add(1, memory_order_relaxed);
+
+	// Lookups only look at the rest of it, so the pixels can go now.
+	vector<uint8_t>().swap(entry->pixels);
+	shard->retired.push_back(entry);
+
+	if (shard->readers.load() == 0) {
+		free_retired(shard);
+	}
+
+	return true;
+}
+
+static void free_retired(texture_cache_shard* shard) {
+	size_t i;
+
+	//
+	// Anyone who starts walking the shard after this got unlinked can't
+	// reach it, so if nobody's walking it now, nobody is on it.
+	//
+
+	for (i = 0; i < shard->retired.size(); i++) {
+		delete shard->retired[i];
+	}
+
+	shard->retired.clear();
+}
+
+static bool compare_candidates(const eviction_candidate& a, const eviction_candidate& b) {
+	return a.last_used < b.last_used;
+}
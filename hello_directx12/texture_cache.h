@@ -0,0 +1,142 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// Keeps decoded textures in memory, so asking for the same image twice
+// decodes it once. Textures are found by their path and a hash of
+// their contents, so an image that's changed on disk is a new texture
+// rather than the old one, and the old one just ages out.
+//
+// Whoever asks for a texture gets a reference to it, and gives it back
+// with release_texture. Referenced textures are never evicted. Once
+// the decoded textures add up to more than the budget, the ones nobody
+// is using go, least recently used first, until they're back under it
+// by a bit (so that streaming in a texture at a time doesn't mean
+// looking for something to evict every time). If everything is in use,
+// the cache stays over budget until some of it isn't.
+//
+// The map is split into shards, each with its own lock, and finding a
+// texture that's already there doesn't take any lock at all: a lookup
+// walks its bucket's chain and takes a reference with a compare and
+// swap. Only adding and evicting lock the shard. Evicted entries are
+// unlinked straight away, but only deleted once nobody is walking the
+// shard, since a lookup might be standing on one.
+//
+// If several threads ask for the same texture that isn't there yet,
+// the first decodes it and the others wait for that, rather than
+// decoding it again. A texture that fails to decode is remembered as
+// having failed, since the same bytes would only fail again.
+//
+// "Least recently used" is by a clock that ticks once per decode, not
+// per lookup, so lookups don't all write to the same counter. Textures
+// used between the same two decodes are as old as each other.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const uint32_t TEXTURE_CACHE_SHARDS = 16;
+// Buckets in each shard. The map never grows, so this is enough for a
+// few thousand textures without long chains.
+const uint32_t TEXTURE_CACHE_BUCKETS = 256;
+
+// Fills pixels in from whatever data is, and returns false if it can't.
+typedef bool (*texture_decode_function)(void* data, std::vector<uint8_t>* pixels);
+
+struct texture_cache_entry {
+	texture_cache_entry();
+
+	uint64_t path_hash;
+	uint64_t content_hash;
+	// Both of those, hashed together. Picks the shard and bucket.
+	uint64_t key;
+
+	// Only to be read once the texture's been acquired.
+	std::vector<uint8_t> pixels;
+
+	// The top bit is set once it's been evicted, after which nothing
+	// can take a reference.
+	std::atomic<uint32_t> references;
+	std::atomic<uint32_t> state;
+	std::atomic<uint64_t> last_used;
+
+	std::atomic<texture_cache_entry*> next;
+};
+
+struct alignas(64) texture_cache_shard {
+	texture_cache_shard();
+
+	// Held to add or unlink entries, never to find them.
+	std::mutex lock;
+	std::atomic<texture_cache_entry*> buckets[TEXTURE_CACHE_BUCKETS];
+	// Lookups walking this shard right now.
+	std::atomic<uint32_t> readers;
+	// Unlinked, but maybe still being looked at.
+	std::vector<texture_cache_entry*> retired;
+	uint32_t entry_count;
+
+	std::atomic<uint64_t> hits;
+};
+
+struct texture_cache_stats {
+	uint32_t entry_count;
+	uint64_t bytes;
+	uint64_t peak_bytes;
+	uint64_t budget;
+	uint64_t hits;
+	uint64_t misses;
+	// Lookups that found someone else decoding and waited for them.
+	uint64_t shared_decodes;
+	uint64_t failures;
+	uint64_t evictions;
+};
+
+struct texture_cache {
+	texture_cache();
+
+	uint64_t budget;
+	texture_cache_shard shards[TEXTURE_CACHE_SHARDS];
+
+	std::atomic<uint64_t> bytes;
+	std::atomic<uint64_t> peak_bytes;
+	std::atomic<uint64_t> clock;
+
+	// Lookups that find a texture still decoding wait on this.
+	std::mutex decode_lock;
+	std::condition_variable decoded;
+	// Only one thread evicts at a time. Any other that wants to just
+	// leaves it to that one.
+	std::mutex eviction_lock;
+
+	std::atomic<uint64_t> misses;
+	std::atomic<uint64_t> shared_decodes;
+	std::atomic<uint64_t> failures;
+	std::atomic<uint64_t> evictions;
+};
+
+// Budget is in bytes of decoded pixels.
+void initialize_texture_cache(texture_cache* cache, const uint64_t budget);
+// Frees every texture. None can still be referenced.
+void shutdown_texture_cache(texture_cache* cache);
+
+// Returns the texture for path with the given contents, decoding it
+// with decode(data, ...) if it isn't cached. Returns NULL if it
+// doesn't decode. Otherwise, release it when done with it.
+texture_cache_entry* acquire_texture(
+	texture_cache* cache,
+	const std::string& path,
+	const uint64_t content_hash,
+	texture_decode_function decode,
+	void* data
+);
+// Another reference to a texture that's already referenced.
+void retain_texture(texture_cache_entry* texture);
+void release_texture(texture_cache* cache, texture_cache_entry* texture);
+
+texture_cache_stats get_texture_cache_stats(texture_cache* cache);
+std::string get_texture_cache_report(texture_cache* cache);
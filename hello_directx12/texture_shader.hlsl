@@ -7,6 +7,14 @@
     1. Supply an MVP matrix
 */
 
+// Permutation: converts the sampled color from linear to gamma space
+// before writing it out. The back buffer is not an sRGB format, so
+// without this the texture comes out darker and more saturated than
+// it should.
+#ifndef APPLY_GAMMA
+#define APPLY_GAMMA 0
+#endif
+
 struct vertex_pos_uv
 {
     float4 position : SV_Position;
@@ -18,11 +26,34 @@ struct model_view_projection
     matrix mvp;
 };
 
-// t registers are for shader resource views. So we are putting
-// my_texture in register t0, the first. Not explictly written
-// is that our texture is in register space 0. I think this
-// can be specified as register(t0, space0). But not sure.
-Texture2D my_texture : register(t0);
+// Must match gpu_material in material_registry.h.
+struct material
+{
+    uint albedo_texture;
+    uint flags;
+    float roughness;
+    float metallic;
+    float4 base_color;
+    float2 uv_scale;
+    float2 uv_offset;
+};
+
+struct draw_material
+{
+    uint index;
+};
+
+// What albedo_texture is when a material has no texture.
+#define NO_TEXTURE 0xffffffff
+
+// t registers are for shader resource views. Every material's
+// record is in this structured buffer, in register t0 of the
+// default space, space0.
+StructuredBuffer<material> materials : register(t0);
+// Every texture we have, as one unbounded array. It needs a
+// register space all to itself, since it claims every t register
+// from t0 onwards.
+Texture2D textures[] : register(t0, space1);
 // s registers are for samplers. In our case, we put
 // this generic sampler in the 0th register of the 0th
 // space.
@@ -31,6 +62,9 @@ SamplerState my_sampler : register(s0);
 // are for anything that is constant across all the threads.
 // So things like an MVP matrix can be placed in a cbuffer
 ConstantBuffer<model_view_projection> my_mvp : register(b0);
+// Which record in materials this draw uses. It's a root constant,
+// so switching materials is cheap.
+ConstantBuffer<draw_material> my_material : register(b1);
 
 vertex_pos_uv vs_main(float3 position : POSITION, float2 uv : TEXCOORD)
 {
@@ -48,6 +82,26 @@ vertex_pos_uv vs_main(float3 position : POSITION, float2 uv : TEXCOORD)
 
 float4 ps_main(vertex_pos_uv input) : SV_Target
 {
-    return my_texture.Sample(my_sampler, input.uv);
+    material mat;
+    float2 uv;
+    float4 color;
+
+    mat = materials[my_material.index];
+    uv = input.uv * mat.uv_scale + mat.uv_offset;
+
+    // The index is the same for the whole draw, so there's no need
+    // for NonUniformResourceIndex.
+    color = float4(1.0f, 1.0f, 1.0f, 1.0f);
+    if (mat.albedo_texture != NO_TEXTURE)
+    {
+        color = textures[mat.albedo_texture].Sample(my_sampler, uv);
+    }
+
+    color *= mat.base_color;
+
+#if APPLY_GAMMA
+    color.rgb = pow(color.rgb, 1.0f / 2.2f);
+#endif
 
+    return color;
 }
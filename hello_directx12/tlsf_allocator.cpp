@@ -0,0 +1,452 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+#include "tlsf_allocator.h"
+
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+static uint32_t find_first_set(const uint32_t bits);
+static uint32_t find_last_set(const uint64_t bits);
+static void map_size(const uint64_t size, uint32_t* first, uint32_t* second);
+static uint32_t create_block(tlsf_allocator* allocator);
+static void destroy_block(tlsf_allocator* allocator, const uint32_t block);
+static void insert_free_block(tlsf_allocator* allocator, const uint32_t block);
+static void remove_free_block(tlsf_allocator* allocator, const uint32_t block);
+static uint32_t find_free_block(tlsf_allocator* allocator, const uint64_t size);
+static uint32_t split_block(
+	tlsf_allocator* allocator,
+	const uint32_t block,
+	const uint64_t size
+);
+static void merge_with_next(tlsf_allocator* allocator, const uint32_t block);
+
+tlsf_allocator::tlsf_allocator() {
+	size = 0;
+	unused_blocks = TLSF_INVALID_BLOCK;
+	first_level_bitmap = 0;
+	used_bytes = 0;
+	allocation_count = 0;
+	free_block_count = 0;
+}
+
+void initialize_tlsf_allocator(tlsf_allocator* allocator, const uint64_t size) {
+	uint32_t block;
+	uint32_t i;
+	uint32_t j;
+
+	allocator->size = size & ~(TLSF_GRANULARITY - 1);
+	allocator->blocks.clear();
+	allocator->unused_blocks = TLSF_INVALID_BLOCK;
+	allocator->first_level_bitmap = 0;
+	allocator->used_bytes = 0;
+	allocator->allocation_count = 0;
+	allocator->free_block_count = 0;
+
+	for (i = 0; i < TLSF_FIRST_LEVEL_COUNT; i++) {
+		allocator->second_level_bitmaps[i] = 0;
+
+		for (j = 0; j < TLSF_SECOND_LEVEL_COUNT; j++) {
+			allocator->free_lists[i][j] = TLSF_INVALID_BLOCK;
+		}
+	}
+
+	if (allocator->size == 0) {
+		return;
+	}
+
+	//
+	// Start with one free block covering everything.
+	//
+
+	block = create_block(allocator);
+	allocator->blocks[block].offset = 0;
+	allocator->blocks[block].size = allocator->size;
+
+	insert_free_block(allocator, block);
+}
+
+uint32_t tlsf_allocate(
+	tlsf_allocator* allocator,
+	const uint64_t size,
+	const uint64_t alignment,
+	uint64_t* offset
+) {
+	uint64_t aligned_size;
+	uint64_t search_size;
+	uint64_t aligned_offset;
+	uint64_t padding;
+	uint32_t block;
+	uint32_t padding_block;
+
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	if (size == 0) {
+		return TLSF_INVALID_BLOCK;
+	}
+
+	//
+	// Blocks always start on a granularity boundary, so the most we
+	// could ever need to skip to reach the alignment is
+	// alignment - granularity. Search for a block with room for that.
+	//
+
+	aligned_size = (size + TLSF_GRANULARITY - 1) & ~(TLSF_GRANULARITY - 1);
+	search_size = aligned_size;
+	if (alignment > TLSF_GRANULARITY) {
+		search_size += alignment - TLSF_GRANULARITY;
+	}
+
+	block = find_free_block(allocator, search_size);
+	if (block == TLSF_INVALID_BLOCK) {
+		return TLSF_INVALID_BLOCK;
+	}
+
+	remove_free_block(allocator, block);
+
+	//
+	// If the block doesn't start where we need it to, the space before
+	// the aligned offset goes back as its own free block. Its physical
+	// neighbour before it must be in use (free neighbours are always
+	// merged), so there's nothing to merge it with.
+	//
+
+	aligned_offset = allocator->blocks[block].offset;
+	aligned_offset = (aligned_offset + alignment - 1) & ~(alignment - 1);
+	padding = aligned_offset - allocator->blocks[block].offset;
+
+	if (padding > 0) {
+		padding_block = block;
+		block = split_block(allocator, padding_block, padding);
+		insert_free_block(allocator, padding_block);
+	}
+
+	//
+	// Give back whatever is left over after the allocation.
+	//
+
+	if (allocator->blocks[block].size > aligned_size) {
+		insert_free_block(allocator, split_block(allocator, block, aligned_size));
+	}
+
+	allocator->blocks[block].free = false;
+	allocator->used_bytes += allocator->blocks[block].size;
+	allocator->allocation_count++;
+
+	*offset = allocator->blocks[block].offset;
+
+	return block;
+}
+
+void tlsf_free(tlsf_allocator* allocator, const uint32_t block) {
+	uint32_t prev;
+	uint32_t next;
+	uint32_t merged;
+
+	assert(block < allocator->blocks.size());
+	assert(!allocator->blocks[block].free);
+
+	allocator->used_bytes -= allocator->blocks[block].size;
+	allocator->allocation_count--;
+	allocator->blocks[block].free = true;
+
+	//
+	// Merge with the free neighbours on either side, so there are
+	// never two free blocks next to each other.
+	//
+
+	merged = block;
+
+	next = allocator->blocks[merged].next_physical;
+	if (next != TLSF_INVALID_BLOCK && allocator->blocks[next].free) {
+		remove_free_block(allocator, next);
+		merge_with_next(allocator, merged);
+	}
+
+	prev = allocator->blocks[merged].prev_physical;
+	if (prev != TLSF_INVALID_BLOCK && allocator->blocks[prev].free) {
+		remove_free_block(allocator, prev);
+		merge_with_next(allocator, prev);
+		merged = prev;
+	}
+
+	insert_free_block(allocator, merged);
+}
+
+tlsf_stats get_tlsf_stats(const tlsf_allocator* allocator) {
+	tlsf_stats stats;
+	uint32_t first;
+	uint32_t second;
+	uint32_t block;
+
+	stats = {};
+	stats.total_bytes = allocator->size;
+	stats.used_bytes = allocator->used_bytes;
+	stats.free_bytes = allocator->size - allocator->used_bytes;
+	stats.allocation_count = allocator->allocation_count;
+	stats.free_block_count = allocator->free_block_count;
+
+	//
+	// The largest free block is in the highest non-empty list. That
+	// list covers a range of sizes though, so walk it to find the
+	// biggest.
+	//
+
+	if (allocator->first_level_bitmap != 0) {
+		first = find_last_set(allocator->first_level_bitmap);
+		second = find_last_set(allocator->second_level_bitmaps[first]);
+		block = allocator->free_lists[first][second];
+
+		while (block != TLSF_INVALID_BLOCK) {
+			if (allocator->blocks[block].size > stats.largest_free_block) {
+				stats.largest_free_block = allocator->blocks[block].size;
+			}
+
+			block = allocator->blocks[block].next_free;
+		}
+	}
+
+	if (stats.free_bytes > 0) {
+		stats.fragmentation =
+			1.0f - (float)stats.largest_free_block / (float)stats.free_bytes;
+	}
+
+	return stats;
+}
+
+static uint32_t find_first_set(const uint32_t bits) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(bits);
+#endif
+}
+
+static uint32_t find_last_set(const uint64_t bits) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, bits);
+	return (uint32_t)index;
+#else
+	return 63 - (uint32_t)__builtin_clzll(bits);
+#endif
+}
+
+static void map_size(const uint64_t size, uint32_t* first, uint32_t* second) {
+	uint32_t last_bit;
+
+	//
+	// Small sizes all go in the first bucket, split evenly. Bigger
+	// sizes go in the bucket for their highest set bit, and the next
+	// TLSF_SECOND_LEVEL_LOG2 bits pick the list within it.
+	//
+
+	if (size < (1ULL << TLSF_FIRST_LEVEL_SHIFT)) {
+		*first = 0;
+		*second = (uint32_t)(size >> TLSF_GRANULARITY_LOG2);
+		return;
+	}
+
+	last_bit = find_last_set(size);
+	*first = last_bit - TLSF_FIRST_LEVEL_SHIFT + 1;
+	*second = (uint32_t)(size >> (last_bit - TLSF_SECOND_LEVEL_LOG2)) ^
+		TLSF_SECOND_LEVEL_COUNT;
+
+	if (*first >= TLSF_FIRST_LEVEL_COUNT) {
+		*first = TLSF_FIRST_LEVEL_COUNT - 1;
+		*second = TLSF_SECOND_LEVEL_COUNT - 1;
+	}
+}
+
+static uint32_t create_block(tlsf_allocator* allocator) {
+	tlsf_block* block;
+	uint32_t index;
+
+	if (allocator->unused_blocks != TLSF_INVALID_BLOCK) {
+		index = allocator->unused_blocks;
+		allocator->unused_blocks = allocator->blocks[index].next_free;
+	} else {
+		index = (uint32_t)allocator->blocks.size();
+		allocator->blocks.push_back({});
+	}
+
+	block = &(allocator->blocks[index]);
+	block->offset = 0;
+	block->size = 0;
+	block->prev_physical = TLSF_INVALID_BLOCK;
+	block->next_physical = TLSF_INVALID_BLOCK;
+	block->prev_free = TLSF_INVALID_BLOCK;
+	block->next_free = TLSF_INVALID_BLOCK;
+	block->free = false;
+
+	return index;
+}
+
+static void destroy_block(tlsf_allocator* allocator, const uint32_t block) {
+	allocator->blocks[block].next_free = allocator->unused_blocks;
+	allocator->unused_blocks = block;
+}
+
+static void insert_free_block(tlsf_allocator* allocator, const uint32_t block) {
+	tlsf_block* b;
+	uint32_t first;
+	uint32_t second;
+	uint32_t head;
+
+	b = &(allocator->blocks[block]);
+	map_size(b->size, &first, &second);
+
+	head = allocator->free_lists[first][second];
+
+	b->free = true;
+	b->prev_free = TLSF_INVALID_BLOCK;
+	b->next_free = head;
+
+	if (head != TLSF_INVALID_BLOCK) {
+		allocator->blocks[head].prev_free = block;
+	}
+
+	allocator->free_lists[first][second] = block;
+	allocator->first_level_bitmap |= 1u << first;
+	allocator->second_level_bitmaps[first] |= 1u << second;
+	allocator->free_block_count++;
+}
+
+static void remove_free_block(tlsf_allocator* allocator, const uint32_t block) {
+	tlsf_block* b;
+	uint32_t first;
+	uint32_t second;
+
+	b = &(allocator->blocks[block]);
+	map_size(b->size, &first, &second);
+
+	if (b->prev_free != TLSF_INVALID_BLOCK) {
+		allocator->blocks[b->prev_free].next_free = b->next_free;
+	} else {
+		allocator->free_lists[first][second] = b->next_free;
+	}
+
+	if (b->next_free != TLSF_INVALID_BLOCK) {
+		allocator->blocks[b->next_free].prev_free = b->prev_free;
+	}
+
+	// If that emptied the list, clear its bits.
+	if (allocator->free_lists[first][second] == TLSF_INVALID_BLOCK) {
+		allocator->second_level_bitmaps[first] &= ~(1u << second);
+
+		if (allocator->second_level_bitmaps[first] == 0) {
+			allocator->first_level_bitmap &= ~(1u << first);
+		}
+	}
+
+	b->free = false;
+	b->prev_free = TLSF_INVALID_BLOCK;
+	b->next_free = TLSF_INVALID_BLOCK;
+	allocator->free_block_count--;
+}
+
+static uint32_t find_free_block(tlsf_allocator* allocator, const uint64_t size) {
+	uint64_t rounded_size;
+	uint32_t first;
+	uint32_t second;
+	uint32_t second_level_map;
+	uint32_t first_level_map;
+
+	//
+	// Round the size up to the start of the next list. Then *any*
+	// block in that list or above is big enough, so we never have to
+	// walk a list looking for one that fits.
+	//
+
+	rounded_size = size;
+	if (size >= (1ULL << TLSF_FIRST_LEVEL_SHIFT)) {
+		rounded_size += (1ULL << (find_last_set(size) - TLSF_SECOND_LEVEL_LOG2)) - 1;
+	}
+
+	map_size(rounded_size, &first, &second);
+
+	if (first >= TLSF_FIRST_LEVEL_COUNT) {
+		return TLSF_INVALID_BLOCK;
+	}
+
+	// Anything left in this first level, at or above our list?
+	second_level_map = 0;
+	if (second < TLSF_SECOND_LEVEL_COUNT) {
+		second_level_map = allocator->second_level_bitmaps[first] & (~0u << second);
+	}
+
+	if (second_level_map == 0) {
+		// No, so take the smallest list of a bigger first level.
+		first_level_map = 0;
+		if (first + 1 < 32) {
+			first_level_map = allocator->first_level_bitmap & (~0u << (first + 1));
+		}
+
+		if (first_level_map == 0) {
+			return TLSF_INVALID_BLOCK;
+		}
+
+		first = find_first_set(first_level_map);
+		second_level_map = allocator->second_level_bitmaps[first];
+	}
+
+	second = find_first_set(second_level_map);
+
+	return allocator->free_lists[first][second];
+}
+
+static uint32_t split_block(
+	tlsf_allocator* allocator,
+	const uint32_t block,
+	const uint64_t size
+) {
+	uint32_t remainder;
+	uint32_t next;
+
+	//
+	// Cut the block in two: block keeps the first size bytes and the
+	// new block gets the rest. The new block is returned, not yet in
+	// any free list.
+	//
+
+	remainder = create_block(allocator);
+
+	// create_block can grow the pool, so look the blocks up after.
+	allocator->blocks[remainder].offset = allocator->blocks[block].offset + size;
+	allocator->blocks[remainder].size = allocator->blocks[block].size - size;
+	allocator->blocks[block].size = size;
+
+	next = allocator->blocks[block].next_physical;
+	allocator->blocks[remainder].prev_physical = block;
+	allocator->blocks[remainder].next_physical = next;
+	allocator->blocks[block].next_physical = remainder;
+
+	if (next != TLSF_INVALID_BLOCK) {
+		allocator->blocks[next].prev_physical = remainder;
+	}
+
+	return remainder;
+}
+
+static void merge_with_next(tlsf_allocator* allocator, const uint32_t block) {
+	uint32_t next;
+	uint32_t after;
+
+	next = allocator->blocks[block].next_physical;
+	after = allocator->blocks[next].next_physical;
+
+	allocator->blocks[block].size += allocator->blocks[next].size;
+	allocator->blocks[block].next_physical = after;
+
+	if (after != TLSF_INVALID_BLOCK) {
+		allocator->blocks[after].prev_physical = block;
+	}
+
+	destroy_block(allocator, next);
+}
@@ -0,0 +1,101 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+//
+// A two-level segregated fit (TLSF) allocator. It doesn't hand out
+// memory itself; it hands out offsets into a range of memory someone
+// else owns. We use it to carve placed resources out of big
+// ID3D12Heaps (see gpu_allocator), but nothing here knows that.
+//
+// Free blocks are kept in lists bucketed by size. The first level
+// splits sizes by powers of two, the second level splits each power
+// of two into TLSF_SECOND_LEVEL_COUNT equal pieces. Two bitmaps say
+// which lists have anything in them, so finding a block that fits is
+// a couple of bit scans rather than a search. That, and merging freed
+// blocks with their neighbours right away, makes both allocate and
+// free O(1).
+//
+// Offsets and sizes are always multiples of TLSF_GRANULARITY.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+const uint32_t TLSF_GRANULARITY_LOG2 = 8;
+const uint64_t TLSF_GRANULARITY = 1ULL << TLSF_GRANULARITY_LOG2;
+const uint32_t TLSF_SECOND_LEVEL_LOG2 = 5;
+const uint32_t TLSF_SECOND_LEVEL_COUNT = 1 << TLSF_SECOND_LEVEL_LOG2;
+// Sizes below this all go into the first level's first bucket, split
+// linearly by the second level.
+const uint32_t TLSF_FIRST_LEVEL_SHIFT = TLSF_SECOND_LEVEL_LOG2 + TLSF_GRANULARITY_LOG2;
+// Big enough for blocks up to 1TB.
+const uint32_t TLSF_FIRST_LEVEL_MAX = 40;
+const uint32_t TLSF_FIRST_LEVEL_COUNT = TLSF_FIRST_LEVEL_MAX - TLSF_FIRST_LEVEL_SHIFT + 1;
+
+const uint32_t TLSF_INVALID_BLOCK = 0xffffffff;
+
+struct tlsf_block {
+	uint64_t offset;
+	uint64_t size;
+	// Neighbours in memory.
+	uint32_t prev_physical;
+	uint32_t next_physical;
+	// Neighbours in the free list this block is in (if it is free).
+	uint32_t prev_free;
+	uint32_t next_free;
+	bool free;
+};
+
+struct tlsf_stats {
+	uint64_t total_bytes;
+	uint64_t used_bytes;
+	uint64_t free_bytes;
+	uint64_t largest_free_block;
+	uint32_t allocation_count;
+	uint32_t free_block_count;
+	// 0 when all the free memory is in one block, and close to 1 when
+	// it's scattered across lots of small ones. This is
+	// 1 - largest_free_block / free_bytes.
+	float fragmentation;
+};
+
+struct tlsf_allocator {
+	tlsf_allocator();
+
+	uint64_t size;
+
+	// All blocks, free or used, live in this pool. Blocks refer to
+	// each other by index, and unused slots are chained through
+	// next_free starting at unused_blocks.
+	std::vector<tlsf_block> blocks;
+	uint32_t unused_blocks;
+
+	// Bit i is set if first level i has any free blocks, and bit j of
+	// second_level_bitmaps[i] is set if list (i, j) has any.
+	uint32_t first_level_bitmap;
+	uint32_t second_level_bitmaps[TLSF_FIRST_LEVEL_COUNT];
+	uint32_t free_lists[TLSF_FIRST_LEVEL_COUNT][TLSF_SECOND_LEVEL_COUNT];
+
+	uint64_t used_bytes;
+	uint32_t allocation_count;
+	uint32_t free_block_count;
+};
+
+// Sets up the allocator to manage [0, size). The size is rounded down
+// to the granularity.
+void initialize_tlsf_allocator(tlsf_allocator* allocator, const uint64_t size);
+
+// Allocates size bytes at an offset that is a multiple of alignment
+// (which must be a power of two). Returns the block handle, or
+// TLSF_INVALID_BLOCK if there is no room.
+uint32_t tlsf_allocate(
+	tlsf_allocator* allocator,
+	const uint64_t size,
+	const uint64_t alignment,
+	uint64_t* offset
+);
+
+void tlsf_free(tlsf_allocator* allocator, const uint32_t block);
+
+tlsf_stats get_tlsf_stats(const tlsf_allocator* allocator);
@@ -0,0 +1,901 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the LZ4 block codec and the asset archive, then compares
+	loading 10,000 assets from an archive with loading them as loose
+	files.
+
+	Checks:
+		lz4         Blocks round trip whatever's in them (nothing,
+		            too little to match, runs, repeats at every offset,
+		            long literals and long matches, noise), never go
+		            over the bound, and a block written by hand from
+		            the format's description decodes.
+		damaged     Every truncation of a block fails to decode, and so
+		            does asking for the wrong size. Blocks with random
+		            bytes changed never read or write out of bounds (run
+		            it under AddressSanitizer to be sure of that).
+		archive     Assets come back as they went in, whichever way
+		            their names are written. Noise and assets told not
+		            to compress are stored, aligned in the mapping, and
+		            everything else is compressed in chunks.
+		parallel    A big asset decompressed across the job system
+		            matches one decompressed on one thread.
+		rejects     Names with the same hash aren't packed, and damaged
+		            or truncated archives don't open or don't read.
+
+	Benchmark:
+		Writes 10,000 assets (between 256 bytes and 64KB, most of them
+		compressible, some noise) to a directory 100 files to a folder,
+		packs them, and times reading all of them back: as loose files
+		(checking each exists first, like the application does), from
+		the archive on one thread, from the archive across the job
+		system, from an archive with nothing compressed, and straight
+		out of the mapping for the stored ones.
+		They'll all be in the OS's file cache by then, so this is the
+		cost of opening files, not of the disk. Then it times
+		compressing and decompressing a 16MB asset.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		asset_archive_bench [--quick]
+*/
+
+#include "asset_archive.h"
+#include "job_system.h"
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+const uint32_t BENCH_ASSETS = 10000;
+const uint32_t BENCH_FOLDER_SIZE = 100;
+const size_t BENCH_BIG_ASSET = 16 * 1024 * 1024;
+const uint32_t BENCH_RUNS = 5;
+
+struct bench_asset {
+	string name;
+	vector<uint8_t> data;
+};
+
+struct read_assets_job {
+	const asset_archive* archive;
+	const vector<bench_asset>* assets;
+	vector<vector<uint8_t>>* contents;
+	atomic<uint32_t> failures;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static void make_text(mt19937* random, const size_t size, vector<uint8_t>* data);
+static void make_noise(mt19937* random, const size_t size, vector<uint8_t>* data);
+static bool round_trips(const vector<uint8_t>& data);
+static bool write_file(const string& path, const vector<uint8_t>& data);
+static bool read_loose_file(const fs::path& path, vector<uint8_t>* contents);
+static void read_assets(const uint32_t begin, const uint32_t end, void* data);
+
+static bool run_lz4_check();
+static bool run_damaged_check();
+static bool run_archive_check(job_system* system, const string& directory);
+static bool run_parallel_check(job_system* system, const string& directory);
+static bool run_reject_check(const string& directory);
+static void run_benchmark(const string& directory, const uint32_t cores);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	string directory;
+	uint32_t cores;
+	bool quick;
+	bool success;
+	error_code err;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	directory = (fs::temp_directory_path() / ("asset_archive_bench_" + to_string((unsigned long long)now_seconds()))).string();
+	fs::create_directories(directory, err);
+
+	system = new job_system;
+	initialize_job_system(system, cores < 4 ? 4 : cores, false);
+
+	success = true;
+	success = run_lz4_check() && success;
+	success = run_damaged_check() && success;
+	success = run_archive_check(system, directory) && success;
+	success = run_parallel_check(system, directory) && success;
+	success = run_reject_check(directory) && success;
+
+	shutdown_job_system(system);
+	delete system;
+
+	if (!quick) {
+		run_benchmark(directory, cores);
+	}
+
+	fs::remove_all(directory, err);
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void make_text(mt19937* random, const size_t size, vector<uint8_t>* data) {
+	const char* words[] = {
+		"vertex", "index", "buffer", "texture", "sampler", "float4", "position",
+		"normal", "uv", "material", "{", "}", ";", "\n", "\t", "0.5", "1.0",
+		"return", "struct", "cbuffer", "register", "light", "shadow"
+	};
+	uniform_int_distribution<uint32_t> word(0, sizeof(words) / sizeof(words[0]) - 1);
+	uniform_int_distribution<uint32_t> number(0, 9999);
+	string text;
+
+	//
+	// Words from a small vocabulary, with numbers here and there, which
+	// compresses a bit better than 2:1 like most text formats.
+	//
+
+	while (text.size() < size) {
+		text += words[word(*random)];
+		text += ' ';
+
+		if (number(*random) < 1500) {
+			text += to_string(number(*random));
+			text += ' ';
+		}
+	}
+
+	data->assign(text.begin(), text.begin() + size);
+}
+
+static void make_noise(mt19937* random, const size_t size, vector<uint8_t>* data) {
+	size_t i;
+
+	data->resize(size);
+	for (i = 0; i < size; i++) {
+		(*data)[i] = (uint8_t)((*random)() >> 24);
+	}
+}
+
+static bool round_trips(const vector<uint8_t>& data) {
+	vector<uint8_t> compressed;
+	vector<uint8_t> decompressed;
+	size_t size;
+
+	compressed.resize(get_lz4_bound(data.size()));
+	size = compress_lz4_block(data.data(), data.size(), compressed.data(), compressed.size());
+
+	if (size == 0 || size > get_lz4_bound(data.size())) {
+		return false;
+	}
+
+	// Exactly the size, so anything reading past the end gets caught by
+	// AddressSanitizer.
+	compressed.resize(size);
+	compressed.shrink_to_fit();
+	decompressed.resize(data.size());
+
+	return decompress_lz4_block(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()) &&
+		decompressed == data;
+}
+
+static bool write_file(const string& path, const vector<uint8_t>& data) {
+	ofstream file;
+
+	file.open(path, ios::out | ios::binary | ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file.write((const char*)data.data(), data.size());
+	file.close();
+
+	return !file.fail();
+}
+
+static bool read_loose_file(const fs::path& path, vector<uint8_t>* contents) {
+	ifstream file;
+	streamsize size;
+
+	// Like the application used to, check it's there first.
+	if (!fs::exists(path)) {
+		return false;
+	}
+
+	file.open(path, ios::in | ios::binary | ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	size = file.tellg();
+	file.seekg(0);
+
+	contents->resize((size_t)size);
+	file.read((char*)contents->data(), size);
+
+	return !file.fail();
+}
+
+static void read_assets(const uint32_t begin, const uint32_t end, void* data) {
+	read_assets_job* job;
+	const asset_archive_entry* entry;
+	vector<uint8_t>* contents;
+	uint32_t i;
+
+	job = (read_assets_job*)data;
+
+	for (i = begin; i < end; i++) {
+		entry = find_asset(job->archive, (*job->assets)[i].name);
+		contents = &((*job->contents)[i]);
+
+		// Every asset's small, so one thread each.
+		if (entry) {
+			contents->resize((size_t)entry->size);
+			if (read_asset(NULL, job->archive, entry, contents->data())) {
+				continue;
+			}
+		}
+
+		job->failures++;
+	}
+}
+
+static bool run_lz4_check() {
+	mt19937 random(1);
+	vector<uint8_t> data;
+	vector<uint8_t> compressed;
+	vector<uint8_t> decompressed;
+	const uint8_t by_hand[] = {
+		// "abc", then 9 more from 3 back.
+		0x35, 'a', 'b', 'c', 0x03, 0x00,
+		// The last 5 bytes are literals.
+		0x50, 'h', 'e', 'l', 'l', 'o'
+	};
+	bool right;
+	bool success;
+	size_t size;
+	size_t offset;
+
+	printf("lz4\n");
+	success = true;
+
+	right = true;
+
+	//
+	// Small sizes, around where matching starts being allowed.
+	//
+
+	for (size = 0; size < 40; size++) {
+		make_text(&random, size, &data);
+		right = right && round_trips(data);
+
+		data.assign(size, 'x');
+		right = right && round_trips(data);
+	}
+
+	success = check(right, "nothing to 40 bytes, of text and of one byte over and over") && success;
+
+	//
+	// Something repeating every offset bytes, which makes matches that
+	// overlap what they write when the offset is short.
+	//
+
+	right = true;
+
+	for (offset = 1; offset < 70; offset++) {
+		make_noise(&random, offset, &compressed);
+
+		data.clear();
+		while (data.size() < 5000) {
+			data.insert(data.end(), compressed.begin(), compressed.end());
+		}
+
+		right = right && round_trips(data);
+	}
+
+	success = check(right, "repeats every 1 to 70 bytes") && success;
+
+	//
+	// The farthest a match can reach, and just past it.
+	//
+
+	make_noise(&random, 65535 + 1000, &data);
+	memcpy(&data[65535], &data[0], 1000);
+	right = round_trips(data);
+
+	make_noise(&random, 65536 + 1000, &data);
+	memcpy(&data[65536], &data[0], 1000);
+	right = right && round_trips(data);
+
+	success = check(right, "matches 65535 bytes back, and too far back to match") && success;
+
+	//
+	// Lengths that need many extra bytes.
+	//
+
+	make_noise(&random, 100000, &data);
+	right = round_trips(data);
+
+	data.assign(100000, 0);
+	right = right && round_trips(data);
+
+	make_noise(&random, 300, &data);
+	compressed.assign(5000, 'z');
+	data.insert(data.end(), compressed.begin(), compressed.end());
+	make_noise(&random, 300, &compressed);
+	data.insert(data.end(), compressed.begin(), compressed.end());
+	right = right && round_trips(data);
+
+	success = check(right, "long literals, long matches, and both") && success;
+
+	//
+	// Things compress about how they should.
+	//
+
+	make_text(&random, 1 << 20, &data);
+	compressed.resize(get_lz4_bound(data.size()));
+	size = compress_lz4_block(data.data(), data.size(), compressed.data(), compressed.size());
+	printf("  (1MB of text compresses to %.1f%%)\n", 100.0 * size / data.size());
+	success = check(round_trips(data) && size < data.size() / 2, "text round trips, and at least halves") && success;
+
+	make_noise(&random, 1 << 20, &data);
+	size = compress_lz4_block(data.data(), data.size(), compressed.data(), compressed.size());
+	success = check(size > data.size() && size <= get_lz4_bound(data.size()), "noise grows a little, no more than the bound") && success;
+
+	success = check(compress_lz4_block(data.data(), data.size(), compressed.data(), data.size()) == 0, "too little room is refused") && success;
+
+	decompressed.resize(17);
+	success = check(
+		decompress_lz4_block(by_hand, sizeof(by_hand), decompressed.data(), decompressed.size()) &&
+			memcmp(decompressed.data(), "abcabcabcabchello", 17) == 0,
+		"a block written by hand decodes"
+	) && success;
+
+	return success;
+}
+
+static bool run_damaged_check() {
+	mt19937 random(2);
+	vector<uint8_t> data;
+	vector<uint8_t> compressed;
+	vector<uint8_t> damaged;
+	vector<uint8_t> decompressed;
+	size_t size;
+	size_t length;
+	uint32_t decoded;
+	uint32_t trial;
+	uint32_t changes;
+	bool rejected;
+	bool success;
+
+	printf("damaged\n");
+	success = true;
+
+	make_text(&random, 20000, &data);
+	compressed.resize(get_lz4_bound(data.size()));
+	size = compress_lz4_block(data.data(), data.size(), compressed.data(), compressed.size());
+	compressed.resize(size);
+	decompressed.resize(data.size());
+
+	rejected = true;
+
+	for (length = 0; length < size; length++) {
+		damaged.assign(compressed.begin(), compressed.begin() + length);
+		damaged.shrink_to_fit();
+		rejected = rejected && !decompress_lz4_block(damaged.data(), damaged.size(), decompressed.data(), decompressed.size());
+	}
+
+	success = check(rejected, "every truncation fails") && success;
+
+	decompressed.resize(data.size() - 1);
+	rejected = !decompress_lz4_block(compressed.data(), compressed.size(), decompressed.data(), decompressed.size());
+	decompressed.resize(data.size() + 1);
+	rejected = rejected && !decompress_lz4_block(compressed.data(), compressed.size(), decompressed.data(), decompressed.size());
+	success = check(rejected, "so does the wrong size") && success;
+
+	//
+	// Change a few bytes at random, many times over. Whatever comes out
+	// has to stay in bounds.
+	//
+
+	decoded = 0;
+
+	for (trial = 0; trial < 20000; trial++) {
+		damaged = compressed;
+
+		for (changes = 0; changes < 1 + trial % 4; changes++) {
+			damaged[random() % damaged.size()] = (uint8_t)random();
+		}
+
+		decompressed.assign(data.size(), 0);
+		decoded += decompress_lz4_block(damaged.data(), damaged.size(), decompressed.data(), decompressed.size()) ? 1 : 0;
+	}
+
+	printf("  (%u of 20000 damaged blocks still decoded to the right size, none out of bounds)\n", decoded);
+
+	return success;
+}
+
+static bool run_archive_check(job_system* system, const string& directory) {
+	mt19937 random(3);
+	vector<asset_archive_input> inputs;
+	asset_archive_input input;
+	asset_archive archive;
+	const asset_archive_entry* entry;
+	const uint8_t* mapped;
+	vector<uint8_t> contents;
+	string path;
+	bool right;
+	bool success;
+	size_t i;
+
+	printf("archive\n");
+	success = true;
+
+	//
+	// Something of every kind.
+	//
+
+	input.compress = true;
+
+	input.name = "empty.txt";
+	input.data.clear();
+	inputs.push_back(input);
+
+	input.name = "shaders/texture_shader.hlsl";
+	make_text(&random, 200000, &(input.data));
+	inputs.push_back(input);
+
+	input.name = "textures/Friendo.png";
+	make_noise(&random, 100000, &(input.data));
+	inputs.push_back(input);
+
+	input.name = "one_chunk.txt";
+	make_text(&random, ASSET_CHUNK_SIZE, &(input.data));
+	inputs.push_back(input);
+
+	input.name = "one_chunk_and_a_byte.txt";
+	make_text(&random, ASSET_CHUNK_SIZE + 1, &(input.data));
+	inputs.push_back(input);
+
+	input.name = "tiny.txt";
+	input.data.assign(5, 'q');
+	inputs.push_back(input);
+
+	input.name = "told_not_to.txt";
+	make_text(&random, 50000, &(input.data));
+	input.compress = false;
+	inputs.push_back(input);
+
+	path = directory + "/check.pak";
+	success = check(write_asset_archive(system, path, inputs), "the archive is written") && success;
+	success = check(open_asset_archive(&archive, path), "and opens") && success;
+
+	if (!archive.header) {
+		return false;
+	}
+
+	printf("%s", get_asset_archive_report(&archive).c_str());
+
+	right = archive.header->entry_count == inputs.size();
+
+	for (i = 0; i < inputs.size(); i++) {
+		entry = find_asset(&archive, inputs[i].name);
+		right = right && entry && entry->size == inputs[i].data.size();
+
+		if (entry) {
+			contents.assign((size_t)entry->size, 0xcd);
+			right = right && read_asset(system, &archive, entry, contents.data()) && contents == inputs[i].data;
+		}
+	}
+
+	success = check(right, "every asset reads back as it went in") && success;
+
+	right = find_asset(&archive, "./Shaders\\TEXTURE_shader.hlsl") == find_asset(&archive, "shaders/texture_shader.hlsl");
+	right = right && find_asset(&archive, "textures/friendo.png") != NULL;
+	right = right && find_asset(&archive, "missing.png") == NULL;
+	success = check(right, "names are found with either slash, in any case, after ./") && success;
+
+	entry = find_asset(&archive, "textures/friendo.png");
+	mapped = (const uint8_t*)get_mapped_asset(&archive, entry);
+	right = is_asset_stored(entry) &&
+		mapped >= archive.file.data &&
+		mapped + entry->size <= archive.file.data + archive.file.size &&
+		entry->offset % ASSET_ARCHIVE_ALIGNMENT == 0 &&
+		memcmp(mapped, inputs[2].data.data(), inputs[2].data.size()) == 0;
+	success = check(right, "noise is stored, aligned, and read straight out of the mapping") && success;
+
+	entry = find_asset(&archive, "told_not_to.txt");
+	success = check(is_asset_stored(entry), "so is an asset told not to compress") && success;
+
+	right = !is_asset_stored(find_asset(&archive, "shaders/texture_shader.hlsl")) &&
+		find_asset(&archive, "shaders/texture_shader.hlsl")->chunk_count == 4 &&
+		find_asset(&archive, "one_chunk.txt")->chunk_count == 1 &&
+		find_asset(&archive, "one_chunk_and_a_byte.txt")->chunk_count == 2 &&
+		get_mapped_asset(&archive, find_asset(&archive, "one_chunk.txt")) == NULL;
+	success = check(right, "text is compressed, in 64KB chunks") && success;
+
+	close_asset_archive(&archive);
+
+	return success;
+}
+
+static bool run_parallel_check(job_system* system, const string& directory) {
+	mt19937 random(4);
+	vector<asset_archive_input> inputs;
+	asset_archive archive;
+	const asset_archive_entry* entry;
+	vector<uint8_t> serial;
+	vector<uint8_t> parallel;
+	string path;
+	bool success;
+
+	printf("parallel\n");
+
+	inputs.resize(1);
+	inputs[0].name = "big.txt";
+	inputs[0].compress = true;
+	make_text(&random, 4 * 1024 * 1024 + 123, &(inputs[0].data));
+
+	path = directory + "/parallel.pak";
+
+	// Written on one thread, to check that comes out the same too.
+	success = write_asset_archive(NULL, path, inputs) && open_asset_archive(&archive, path);
+	entry = success ? find_asset(&archive, "big.txt") : NULL;
+	success = entry != NULL;
+
+	if (success) {
+		serial.resize((size_t)entry->size);
+		parallel.resize((size_t)entry->size);
+
+		success = read_asset(NULL, &archive, entry, serial.data()) &&
+			read_asset(system, &archive, entry, parallel.data());
+	}
+
+	success = check(success && entry->chunk_count == 65, "a 4MB asset is 65 chunks") && success;
+	success = check(serial == parallel && serial == inputs[0].data, "the job system reads the same as one thread") && success;
+
+	close_asset_archive(&archive);
+
+	return success;
+}
+
+static bool run_reject_check(const string& directory) {
+	mt19937 random(5);
+	vector<asset_archive_input> inputs;
+	asset_archive archive;
+	const asset_archive_entry* entry;
+	const asset_archive_chunk* chunk;
+	vector<uint8_t> file;
+	vector<uint8_t> contents;
+	fstream stream;
+	string path;
+	bool success;
+
+	printf("rejects\n");
+	success = true;
+
+	inputs.resize(2);
+	inputs[0].name = "Textures/a.png";
+	inputs[0].compress = true;
+	inputs[1].name = "textures\\A.PNG";
+	inputs[1].compress = true;
+
+	path = directory + "/reject.pak";
+	success = check(!write_asset_archive(NULL, path, inputs), "two names for the same asset aren't packed") && success;
+
+	inputs[1].name = "textures/b.txt";
+	make_text(&random, 300000, &(inputs[1].data));
+	write_asset_archive(NULL, path, inputs);
+	read_loose_file(path, &file);
+
+	//
+	// Cut short.
+	//
+
+	write_file(path + ".short", vector<uint8_t>(file.begin(), file.end() - 1));
+	success = check(!open_asset_archive(&archive, path + ".short"), "a truncated archive doesn't open") && success;
+
+	write_file(path + ".tiny", vector<uint8_t>(file.begin(), file.begin() + 10));
+	success = check(!open_asset_archive(&archive, path + ".tiny"), "nor does a bit of one") && success;
+
+	file[0] = 'X';
+	write_file(path + ".magic", file);
+	file[0] = 'A';
+	success = check(!open_asset_archive(&archive, path + ".magic"), "nor one with the wrong magic") && success;
+
+	//
+	// A damaged chunk opens, since nothing checks what's in them until
+	// they're read, but then doesn't read.
+	//
+
+	open_asset_archive(&archive, path);
+	entry = find_asset(&archive, "textures/b.txt");
+	chunk = &(archive.chunks[entry->first_chunk + 2]);
+	file[chunk->offset + chunk->compressed_size / 2] ^= 0x5a;
+	file[chunk->offset + 1] ^= 0xff;
+	close_asset_archive(&archive);
+
+	write_file(path + ".damaged", file);
+	success = check(open_asset_archive(&archive, path + ".damaged"), "an archive with a damaged chunk opens") && success;
+
+	entry = find_asset(&archive, "textures/b.txt");
+	contents.resize((size_t)entry->size);
+	success = check(!read_asset(NULL, &archive, entry, contents.data()), "but the asset doesn't read") && success;
+
+	close_asset_archive(&archive);
+
+	return success;
+}
+
+static void run_benchmark(const string& directory, const uint32_t cores) {
+	mt19937 random(6);
+	uniform_real_distribution<double> size_power(8.0, 16.0);
+	vector<bench_asset> assets;
+	vector<asset_archive_input> inputs;
+	vector<vector<uint8_t>> contents;
+	vector<uint8_t> data;
+	vector<uint8_t> compressed;
+	asset_archive archive;
+	const asset_archive_entry* entry;
+	const void* mapped;
+	read_assets_job job;
+	job_system* system;
+	string loose_directory;
+	string path;
+	string stored_path;
+	uint64_t total_size;
+	uint64_t archive_size;
+	uint32_t stored;
+	uint32_t failures;
+	uint32_t run;
+	uint32_t i;
+	size_t size;
+	double start;
+	double loose_time;
+	double archive_time;
+	double parallel_time;
+	double stored_time;
+	double mapped_time;
+	double compress_time;
+	double decompress_time;
+	double big_serial_time;
+	double big_parallel_time;
+	error_code err;
+
+	printf("\nWriting %u assets...\n", BENCH_ASSETS);
+
+	loose_directory = directory + "/loose";
+	assets.resize(BENCH_ASSETS);
+	total_size = 0;
+
+	for (i = 0; i < BENCH_ASSETS; i++) {
+		if (i % BENCH_FOLDER_SIZE == 0) {
+			fs::create_directories(loose_directory + "/folder_" + to_string(i / BENCH_FOLDER_SIZE), err);
+		}
+
+		assets[i].name = "folder_" + to_string(i / BENCH_FOLDER_SIZE) + "/asset_" + to_string(i) + ".bin";
+		size = (size_t)pow(2.0, size_power(random));
+
+		// One in four is noise, like already compressed images.
+		if (i % 4 == 0) {
+			make_noise(&random, size, &(assets[i].data));
+		} else {
+			make_text(&random, size, &(assets[i].data));
+		}
+
+		write_file(loose_directory + "/" + assets[i].name, assets[i].data);
+		total_size += size;
+	}
+
+	//
+	// Pack them, like the packer does.
+	//
+
+	inputs.resize(BENCH_ASSETS);
+	for (i = 0; i < BENCH_ASSETS; i++) {
+		inputs[i].name = assets[i].name;
+		inputs[i].data = assets[i].data;
+		inputs[i].compress = true;
+	}
+
+	system = new job_system;
+	initialize_job_system(system, cores, true);
+
+	path = directory + "/bench.pak";
+	write_asset_archive(system, path, inputs);
+
+	// And again with nothing compressed, which leaves just the cost of
+	// finding things.
+	for (i = 0; i < BENCH_ASSETS; i++) {
+		inputs[i].compress = false;
+	}
+
+	stored_path = directory + "/bench_stored.pak";
+	write_asset_archive(system, stored_path, inputs);
+	inputs.clear();
+
+	archive_size = fs::file_size(path, err);
+	contents.resize(BENCH_ASSETS);
+
+	//
+	// Loose files.
+	//
+
+	loose_time = 1e9;
+	failures = 0;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+
+		for (i = 0; i < BENCH_ASSETS; i++) {
+			failures += read_loose_file(loose_directory + "/" + assets[i].name, &contents[i]) ? 0 : 1;
+		}
+
+		loose_time = min(loose_time, now_seconds() - start);
+	}
+
+	//
+	// The archive, opening it each time, on one thread and then across
+	// the job system, then the one with nothing compressed.
+	//
+
+	archive_time = 1e9;
+	parallel_time = 1e9;
+	stored_time = 1e9;
+
+	job.assets = &assets;
+	job.contents = &contents;
+	job.failures = 0;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+		open_asset_archive(&archive, path);
+		job.archive = &archive;
+		read_assets(0, BENCH_ASSETS, &job);
+		close_asset_archive(&archive);
+		archive_time = min(archive_time, now_seconds() - start);
+
+		start = now_seconds();
+		open_asset_archive(&archive, path);
+		job.archive = &archive;
+		parallel_for(system, BENCH_ASSETS, 64, read_assets, &job);
+		close_asset_archive(&archive);
+		parallel_time = min(parallel_time, now_seconds() - start);
+
+		start = now_seconds();
+		open_asset_archive(&archive, stored_path);
+		job.archive = &archive;
+		read_assets(0, BENCH_ASSETS, &job);
+		close_asset_archive(&archive);
+		stored_time = min(stored_time, now_seconds() - start);
+	}
+
+	failures += job.failures;
+
+	for (i = 0; i < BENCH_ASSETS; i++) {
+		failures += contents[i] == assets[i].data ? 0 : 1;
+	}
+
+	//
+	// Stored assets straight from the mapping, touching a byte of each
+	// so it's not just the lookups.
+	//
+
+	open_asset_archive(&archive, path);
+	printf("%s", get_asset_archive_report(&archive).c_str());
+
+	mapped_time = 1e9;
+	stored = 0;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+		size = 0;
+		stored = 0;
+
+		for (i = 0; i < BENCH_ASSETS; i++) {
+			entry = find_asset(&archive, assets[i].name);
+			mapped = get_mapped_asset(&archive, entry);
+
+			if (mapped) {
+				size += ((const uint8_t*)mapped)[entry->size / 2];
+				stored++;
+			}
+		}
+
+		mapped_time = min(mapped_time, now_seconds() - start);
+	}
+
+	close_asset_archive(&archive);
+
+	printf(
+		"\n%u assets, %.2fMB loose, %.2fMB packed, %u cores%s\n",
+		BENCH_ASSETS,
+		total_size / (1024.0 * 1024.0),
+		archive_size / (1024.0 * 1024.0),
+		cores,
+		failures > 0 ? " (SOME READS FAILED)" : ""
+	);
+	printf("loose files          %10.3fms (%.1fus an asset)\n", loose_time * 1000.0, loose_time * 1e6 / BENCH_ASSETS);
+	printf("archive              %10.3fms (%4.2fx)\n", archive_time * 1000.0, loose_time / archive_time);
+	printf("archive, job system  %10.3fms (%4.2fx)\n", parallel_time * 1000.0, loose_time / parallel_time);
+	printf("uncompressed archive %10.3fms (%4.2fx)\n", stored_time * 1000.0, loose_time / stored_time);
+	printf("%u stored, mapped   %10.3fms (touching %zu)\n", stored, mapped_time * 1000.0, size % 10);
+
+	//
+	// One big asset.
+	//
+
+	make_text(&random, BENCH_BIG_ASSET, &data);
+	compressed.resize(get_lz4_bound(data.size()));
+
+	compress_time = 1e9;
+	decompress_time = 1e9;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+		size = compress_lz4_block(data.data(), data.size(), compressed.data(), compressed.size());
+		compress_time = min(compress_time, now_seconds() - start);
+
+		start = now_seconds();
+		decompress_lz4_block(compressed.data(), size, data.data(), data.size());
+		decompress_time = min(decompress_time, now_seconds() - start);
+	}
+
+	inputs.resize(1);
+	inputs[0].name = "big.txt";
+	inputs[0].data = data;
+	inputs[0].compress = true;
+	write_asset_archive(system, path, inputs);
+	open_asset_archive(&archive, path);
+	entry = find_asset(&archive, "big.txt");
+
+	big_serial_time = 1e9;
+	big_parallel_time = 1e9;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+		read_asset(NULL, &archive, entry, data.data());
+		big_serial_time = min(big_serial_time, now_seconds() - start);
+
+		start = now_seconds();
+		read_asset(system, &archive, entry, data.data());
+		big_parallel_time = min(big_parallel_time, now_seconds() - start);
+	}
+
+	close_asset_archive(&archive);
+	shutdown_job_system(system);
+	delete system;
+
+	printf("\n16MB of text, %.1f%% compressed\n", 100.0 * size / BENCH_BIG_ASSET);
+	printf("lz4 compress         %10.3fms (%.0fMB/s)\n", compress_time * 1000.0, 16.0 / compress_time);
+	printf("lz4 decompress       %10.3fms (%.0fMB/s)\n", decompress_time * 1000.0, 16.0 / decompress_time);
+	printf("read, one thread     %10.3fms (%.0fMB/s)\n", big_serial_time * 1000.0, 16.0 / big_serial_time);
+	printf("read, job system     %10.3fms (%.0fMB/s, %4.2fx)\n",
+		big_parallel_time * 1000.0, 16.0 / big_parallel_time, big_serial_time / big_parallel_time);
+}
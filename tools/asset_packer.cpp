@@ -0,0 +1,211 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	The asset packer packs every file under a directory into a single
+	asset archive (see hello_directx12/asset_archive.h), which the
+	application memory maps at start up instead of opening each file.
+
+	Each asset is named by its path under the directory, with forward
+	slashes, so hello_directx12/assets/friendo.png packs as
+	"friendo.png". Files are compressed when it's worth it and stored
+	when it isn't. Extensions given with --store are never compressed,
+	which saves trying on things like PNGs that are compressed already.
+
+	Usage:
+		asset_packer <directory> <output archive>
+			[--store <extension>]... [--jobs <thread count>]
+
+	Chunks are compressed in parallel across the job system.
+*/
+
+#include "asset_archive.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct packer_settings {
+	string directory;
+	string output_path;
+	vector<string> stored_extensions;
+	uint32_t job_count;
+};
+
+static bool parse_arguments(int argc, char** argv, packer_settings* settings);
+static string to_lower(const string& text);
+static bool read_binary_file(const fs::path& path, vector<uint8_t>* contents);
+
+int main(int argc, char** argv) {
+	packer_settings settings;
+	vector<asset_archive_input> inputs;
+	asset_archive_input input;
+	asset_archive archive;
+	job_system* jobs;
+	fs::recursive_directory_iterator it;
+	fs::recursive_directory_iterator end;
+	chrono::steady_clock::time_point start;
+	string extension;
+	uint64_t total_size;
+	double seconds;
+	bool success;
+	error_code err;
+
+	if (!parse_arguments(argc, argv, &settings)) {
+		cerr << "usage: asset_packer <directory> <output archive> "
+			<< "[--store <extension>]... [--jobs <count>]" << endl;
+		return 1;
+	}
+
+	//
+	// Read in every file. The output might be inside the directory, so
+	// skip it.
+	//
+
+	it = fs::recursive_directory_iterator(settings.directory, err);
+	if (err) {
+		cerr << "asset_packer: could not open " << settings.directory << endl;
+		return 1;
+	}
+
+	total_size = 0;
+
+	for (; it != end; it.increment(err)) {
+		if (err) {
+			cerr << "asset_packer: could not read " << settings.directory << endl;
+			return 1;
+		}
+
+		if (!it->is_regular_file() || fs::equivalent(it->path(), settings.output_path, err)) {
+			continue;
+		}
+
+		input.name = it->path().lexically_relative(settings.directory).generic_string();
+		extension = to_lower(it->path().extension().string());
+		input.compress = find(
+			settings.stored_extensions.begin(),
+			settings.stored_extensions.end(),
+			extension
+		) == settings.stored_extensions.end();
+
+		if (!read_binary_file(it->path(), &(input.data))) {
+			cerr << "asset_packer: could not read " << it->path().string() << endl;
+			return 1;
+		}
+
+		total_size += input.data.size();
+		inputs.push_back(input);
+	}
+
+	jobs = new job_system;
+	initialize_job_system(jobs, settings.job_count, false);
+
+	start = chrono::steady_clock::now();
+	success = write_asset_archive(jobs, settings.output_path, inputs);
+	seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	shutdown_job_system(jobs);
+	delete jobs;
+
+	if (!success) {
+		cerr << "asset_packer: could not write " << settings.output_path
+			<< " (two names might have the same hash)" << endl;
+		return 1;
+	}
+
+	if (!open_asset_archive(&archive, settings.output_path)) {
+		cerr << "asset_packer: " << settings.output_path << " didn't come out right" << endl;
+		return 1;
+	}
+
+	printf("%s", get_asset_archive_report(&archive).c_str());
+	printf(
+		"Packed %zu files (%.2fMB) in %.3f s on %u threads\n",
+		inputs.size(),
+		total_size / (1024.0 * 1024.0),
+		seconds,
+		settings.job_count
+	);
+
+	close_asset_archive(&archive);
+
+	return 0;
+}
+
+static bool parse_arguments(int argc, char** argv, packer_settings* settings) {
+	string arg;
+	int i;
+
+	settings->job_count = thread::hardware_concurrency();
+	if (settings->job_count == 0) {
+		settings->job_count = 1;
+	}
+
+	for (i = 1; i < argc; i++) {
+		arg = argv[i];
+
+		if (arg == "--store" && i + 1 < argc) {
+			arg = to_lower(argv[++i]);
+			if (arg[0] != '.') {
+				arg = "." + arg;
+			}
+
+			settings->stored_extensions.push_back(arg);
+		} else if (arg == "--jobs" && i + 1 < argc) {
+			settings->job_count = (uint32_t)atoi(argv[++i]);
+			if (settings->job_count == 0) {
+				return false;
+			}
+		} else if (settings->directory.empty()) {
+			settings->directory = arg;
+		} else if (settings->output_path.empty()) {
+			settings->output_path = arg;
+		} else {
+			return false;
+		}
+	}
+
+	return !settings->directory.empty() && !settings->output_path.empty();
+}
+
+static string to_lower(const string& text) {
+	string result;
+	size_t i;
+
+	result = text;
+	for (i = 0; i < result.size(); i++) {
+		if (result[i] >= 'A' && result[i] <= 'Z') {
+			result[i] = (char)(result[i] - 'A' + 'a');
+		}
+	}
+
+	return result;
+}
+
+static bool read_binary_file(const fs::path& path, vector<uint8_t>* contents) {
+	ifstream file;
+	streamsize size;
+
+	file.open(path, ios::in | ios::binary | ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	size = file.tellg();
+	file.seekg(0);
+
+	contents->resize((size_t)size);
+	file.read((char*)contents->data(), size);
+
+	return !file.fail();
+}
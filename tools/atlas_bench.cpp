@@ -0,0 +1,455 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the texture atlas packer and runtime allocator, then measures
+	how fast they are and how full they keep their pages.
+
+	Checks:
+		packer       Packed images never overlap (gutters included), stay
+		             on their pages and are aligned for their mips. Ones
+		             too big for a page aren't placed.
+		allocator    The same for the shelf allocator, while images are
+		             allocated and freed, and freeing everything empties
+		             the page.
+		copy         The gutter is filled with the image's edge pixels,
+		             and the UV transform lands on the image.
+
+	Benchmark: 100,000 images, mostly small with a few big ones, packed
+	into 4096x4096 pages ahead of time, then allocated at runtime with a
+	new page whenever one fills up. Then half the runtime images are
+	freed and as many new ones allocated, to see how the shelves cope
+	with churn. Occupancy is the area of the images over the area of the
+	pages they're on.
+
+	Usage:
+		atlas_bench [--quick]
+*/
+
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+const uint32_t BENCH_IMAGES = 100000;
+const uint32_t BENCH_PAGE_SIZE = 4096;
+const uint32_t CHECK_IMAGES = 3000;
+const uint32_t CHECK_PAGE_SIZE = 512;
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static uint32_t random_size(mt19937* random);
+// Marks each rectangle, with its gutter, on a bitmap of its page.
+// Returns false if any of them overlap, or go off the page.
+static bool mark_rects(
+	const atlas_settings* settings,
+	const vector<atlas_rect>& rects,
+	const uint32_t page_count
+);
+static bool are_aligned(const atlas_settings* settings, const vector<atlas_rect>& rects);
+
+static bool run_packer();
+static bool run_allocator();
+static bool run_copy();
+static void run_benchmark();
+
+int main(int argc, char** argv) {
+	bool quick;
+	bool success;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	success = true;
+	success = run_packer() && success;
+	success = run_allocator() && success;
+	success = run_copy() && success;
+
+	if (!quick) {
+		run_benchmark();
+	}
+
+	printf(success ? "All checks passed\n" : "Some checks failed\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t random_size(mt19937* random) {
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+	float t;
+
+	// Mostly icon sized, with the odd big one.
+	t = unit(*random);
+	return 4 + (uint32_t)(t * t * t * 124.0f);
+}
+
+static bool mark_rects(
+	const atlas_settings* settings,
+	const vector<atlas_rect>& rects,
+	const uint32_t page_count
+) {
+	vector<vector<uint8_t>> pages;
+	uint32_t gutter;
+	uint32_t x;
+	uint32_t y;
+	size_t i;
+
+	gutter = get_atlas_gutter(settings);
+	pages.assign(page_count, vector<uint8_t>((size_t)settings->page_width * settings->page_height, 0));
+
+	for (i = 0; i < rects.size(); i++) {
+		const atlas_rect& rect = rects[i];
+
+		if (rect.page == ATLAS_NO_PAGE) {
+			continue;
+		}
+
+		if (rect.page >= page_count ||
+			rect.x < gutter || rect.y < gutter ||
+			rect.x + rect.width + gutter > settings->page_width ||
+			rect.y + rect.height + gutter > settings->page_height)
+		{
+			return false;
+		}
+
+		for (y = rect.y - gutter; y < rect.y + rect.height + gutter; y++) {
+			for (x = rect.x - gutter; x < rect.x + rect.width + gutter; x++) {
+				uint8_t& texel = pages[rect.page][(size_t)y * settings->page_width + x];
+
+				if (texel) {
+					return false;
+				}
+
+				texel = 1;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool are_aligned(const atlas_settings* settings, const vector<atlas_rect>& rects) {
+	uint32_t gutter;
+	uint32_t alignment;
+	size_t i;
+
+	gutter = get_atlas_gutter(settings);
+	alignment = get_atlas_alignment(settings);
+
+	for (i = 0; i < rects.size(); i++) {
+		if (rects[i].page == ATLAS_NO_PAGE) {
+			continue;
+		}
+
+		if ((rects[i].x - gutter) % alignment != 0 || (rects[i].y - gutter) % alignment != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool run_packer() {
+	atlas_settings settings;
+	vector<atlas_rect> rects;
+	mt19937 random(1);
+	uint32_t page_count;
+	uint32_t unplaced;
+	bool success;
+	size_t i;
+
+	printf("Packer\n");
+
+	settings.page_width = CHECK_PAGE_SIZE;
+	settings.page_height = CHECK_PAGE_SIZE;
+	settings.padding = 1;
+	settings.mip_levels = 3;
+
+	rects.resize(CHECK_IMAGES);
+	for (i = 0; i < rects.size(); i++) {
+		rects[i] = {};
+		rects[i].width = random_size(&random);
+		rects[i].height = random_size(&random);
+	}
+
+	// One that can never fit.
+	rects[7].width = CHECK_PAGE_SIZE;
+
+	page_count = pack_atlas(&settings, &rects);
+
+	unplaced = 0;
+	for (i = 0; i < rects.size(); i++) {
+		unplaced += rects[i].page == ATLAS_NO_PAGE ? 1 : 0;
+	}
+
+	success = check(page_count > 1, "more pages are opened as they fill up");
+	success = check(rects[7].page == ATLAS_NO_PAGE && unplaced == 1, "only images too big for a page are left out") && success;
+	success = check(mark_rects(&settings, rects, page_count), "no two images or gutters overlap") && success;
+	success = check(are_aligned(&settings, rects), "every image is aligned for its smallest mip") && success;
+
+	return success;
+}
+
+static bool run_allocator() {
+	atlas_allocator allocator;
+	atlas_settings settings;
+	vector<atlas_rect> live;
+	atlas_rect rect;
+	mt19937 random(2);
+	uint32_t gutter;
+	bool success;
+	uint32_t round;
+	size_t i;
+
+	printf("Allocator\n");
+
+	settings.page_width = CHECK_PAGE_SIZE;
+	settings.page_height = CHECK_PAGE_SIZE;
+	settings.padding = 2;
+	settings.mip_levels = 2;
+	gutter = get_atlas_gutter(&settings);
+
+	initialize_atlas_allocator(&allocator, &settings);
+
+	//
+	// Fill it up.
+	//
+
+	while (allocate_atlas_rect(&allocator, random_size(&random), random_size(&random), &rect)) {
+		live.push_back(rect);
+	}
+
+	success = check(live.size() > 20 && rect.page == ATLAS_NO_PAGE, "images are allocated until the page is full");
+	success = check(mark_rects(&settings, live, 1), "no two images or gutters overlap") && success;
+	success = check(are_aligned(&settings, live), "every image is aligned for its smallest mip") && success;
+
+	//
+	// Churn: free half at random and allocate more, a few times over.
+	//
+
+	for (round = 0; round < 20; round++) {
+		shuffle(live.begin(), live.end(), random);
+
+		for (i = live.size() / 2; i < live.size(); i++) {
+			free_atlas_rect(&allocator, &(live[i]));
+		}
+		live.resize(live.size() / 2);
+
+		while (allocate_atlas_rect(&allocator, random_size(&random), random_size(&random), &rect)) {
+			live.push_back(rect);
+		}
+	}
+
+	success = check(mark_rects(&settings, live, 1), "nothing overlaps after freeing and reallocating") && success;
+	success = check(get_atlas_allocator_stats(&allocator).image_count == live.size(), "every live image is counted") && success;
+
+	for (i = 0; i < live.size(); i++) {
+		free_atlas_rect(&allocator, &(live[i]));
+	}
+
+	success = check(allocator.shelves.empty() && allocator.top == 0, "freeing everything empties the page") && success;
+	success = check(
+		allocate_atlas_rect(&allocator, CHECK_PAGE_SIZE - 2 * gutter, CHECK_PAGE_SIZE - 2 * gutter, &rect),
+		"so the whole page can be used again"
+	) && success;
+
+	return success;
+}
+
+static bool run_copy() {
+	atlas_settings settings;
+	atlas_rect rect;
+	vector<uint8_t> page;
+	uint8_t image[6];
+	float scale[2];
+	float offset[2];
+	bool success;
+	uint32_t x;
+	uint32_t y;
+
+	printf("Copy\n");
+
+	settings.page_width = 8;
+	settings.page_height = 8;
+	settings.padding = 2;
+	settings.mip_levels = 1;
+
+	//
+	// A 3x2 single channel image at (2, 2), with a 2 texel gutter.
+	//
+
+	image[0] = 1; image[1] = 2; image[2] = 3;
+	image[3] = 4; image[4] = 5; image[5] = 6;
+
+	rect.x = 2;
+	rect.y = 2;
+	rect.width = 3;
+	rect.height = 2;
+	rect.page = 0;
+
+	page.assign(64, 0);
+	copy_atlas_image(&settings, &rect, image, 3, 1, page.data(), 8);
+
+	success = check(page[2 * 8 + 2] == 1 && page[3 * 8 + 4] == 6, "the image is copied in");
+	success = check(page[0 * 8 + 0] == 1 && page[5 * 8 + 6] == 6, "the gutter's corners are the image's corners") && success;
+	success = check(page[0 * 8 + 3] == 2 && page[5 * 8 + 3] == 5, "the gutter above and below repeats the edge rows") && success;
+	success = check(page[2 * 8 + 0] == 1 && page[3 * 8 + 6] == 6, "the gutter left and right repeats the edge pixels") && success;
+
+	// Nothing past the gutter is touched.
+	for (y = 0; y < 8; y++) {
+		for (x = 0; x < 8; x++) {
+			if ((x == 7 || y >= 6) && page[y * 8 + x] != 0) {
+				success = check(false, "nothing past the gutter is written");
+				return success;
+			}
+		}
+	}
+
+	get_atlas_uv_transform(&settings, &rect, scale, offset);
+	success = check(
+		scale[0] == 3.0f / 8.0f && scale[1] == 2.0f / 8.0f && offset[0] == 2.0f / 8.0f && offset[1] == 2.0f / 8.0f,
+		"UVs from 0 to 1 map onto the image"
+	) && success;
+
+	return success;
+}
+
+static void run_benchmark() {
+	atlas_settings settings;
+	vector<atlas_rect> rects;
+	vector<atlas_allocator> allocators;
+	vector<atlas_rect> live;
+	atlas_rect rect;
+	mt19937 random(3);
+	uint64_t image_area;
+	uint64_t live_area;
+	uint32_t page_count;
+	uint32_t failures;
+	double start;
+	double pack_time;
+	double allocate_time;
+	double churn_time;
+	size_t page;
+	size_t i;
+
+	printf("Benchmark (%u images, %ux%u pages)\n", BENCH_IMAGES, BENCH_PAGE_SIZE, BENCH_PAGE_SIZE);
+
+	settings.page_width = BENCH_PAGE_SIZE;
+	settings.page_height = BENCH_PAGE_SIZE;
+	settings.padding = 1;
+	settings.mip_levels = 1;
+
+	rects.resize(BENCH_IMAGES);
+	image_area = 0;
+
+	for (i = 0; i < rects.size(); i++) {
+		rects[i] = {};
+		rects[i].width = random_size(&random);
+		rects[i].height = random_size(&random);
+		image_area += (uint64_t)rects[i].width * rects[i].height;
+	}
+
+	//
+	// Ahead of time.
+	//
+
+	start = now_seconds();
+	page_count = pack_atlas(&settings, &rects);
+	pack_time = now_seconds() - start;
+
+	printf(
+		"  %-10s %8.1fms  %3u pages  %5.1f%% occupancy\n",
+		"skyline",
+		pack_time * 1000.0,
+		page_count,
+		100.0 * image_area / ((double)page_count * BENCH_PAGE_SIZE * BENCH_PAGE_SIZE)
+	);
+
+	//
+	// At runtime, in the same order as they come.
+	//
+
+	live.reserve(BENCH_IMAGES);
+	start = now_seconds();
+
+	for (i = 0; i < rects.size(); i++) {
+		if (allocators.empty() ||
+			!allocate_atlas_rect(&(allocators.back()), rects[i].width, rects[i].height, &rect))
+		{
+			allocators.emplace_back();
+			initialize_atlas_allocator(&(allocators.back()), &settings);
+			allocate_atlas_rect(&(allocators.back()), rects[i].width, rects[i].height, &rect);
+		}
+
+		rect.page = (uint32_t)allocators.size() - 1;
+		live.push_back(rect);
+	}
+
+	allocate_time = now_seconds() - start;
+
+	printf(
+		"  %-10s %8.1fms  %3zu pages  %5.1f%% occupancy\n",
+		"shelf",
+		allocate_time * 1000.0,
+		allocators.size(),
+		100.0 * image_area / ((double)allocators.size() * BENCH_PAGE_SIZE * BENCH_PAGE_SIZE)
+	);
+
+	//
+	// Churn: free half of them, then put the same number of new ones on
+	// the same pages.
+	//
+
+	shuffle(live.begin(), live.end(), random);
+	failures = 0;
+	start = now_seconds();
+
+	for (i = live.size() / 2; i < live.size(); i++) {
+		page = live[i].page;
+		live[i].page = 0;
+		free_atlas_rect(&(allocators[page]), &(live[i]));
+	}
+
+	for (i = live.size() / 2; i < live.size(); i++) {
+		page = i % allocators.size();
+
+		if (!allocate_atlas_rect(&(allocators[page]), random_size(&random), random_size(&random), &rect)) {
+			failures++;
+		}
+	}
+
+	churn_time = now_seconds() - start;
+
+	live_area = 0;
+	for (page = 0; page < allocators.size(); page++) {
+		live_area += get_atlas_allocator_stats(&(allocators[page])).image_area;
+	}
+
+	printf(
+		"  %-10s %8.1fms  %3zu pages  %5.1f%% occupancy, %u of %zu didn't fit\n",
+		"churn",
+		churn_time * 1000.0,
+		allocators.size(),
+		100.0 * live_area / ((double)allocators.size() * BENCH_PAGE_SIZE * BENCH_PAGE_SIZE),
+		failures,
+		live.size() - live.size() / 2
+	);
+	printf(
+		"  %.0fns an image packed, %.0fns an image allocated\n",
+		pack_time * 1e9 / BENCH_IMAGES,
+		allocate_time * 1e9 / BENCH_IMAGES
+	);
+}
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Liam Wynn, 10/18/2026, Hello DirectX 12
+#
+# Builds the asset packer and uses it to pack everything in
+# hello_directx12/assets into hello_directx12/assets.pak.
+#
+# Needs a C++17 compiler. Set CXX to pick it.
+
+set -e
+
+TOOLS_DIR=$(cd "$(dirname "$0")" && pwd)
+PROJECT_DIR="$TOOLS_DIR/../hello_directx12"
+
+"$TOOLS_DIR/build_tools.sh"
+
+"$TOOLS_DIR/bin/asset_packer" \
+	"$PROJECT_DIR/assets" \
+	"$PROJECT_DIR/assets.pak" \
+	--store png \
+	"$@"
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Liam Wynn, 10/18/2026, Hello DirectX 12
+#
+# Builds the shader packer and uses it to compile every permutation in
+# hello_directx12/shader_permutations.txt into hello_directx12/shaders.pak.
+#
+# Needs a C++17 compiler and DXC. Set DXC to point at dxc if it is not
+# on the PATH, and CXX to pick the C++ compiler.
+
+set -e
+
+TOOLS_DIR=$(cd "$(dirname "$0")" && pwd)
+PROJECT_DIR="$TOOLS_DIR/../hello_directx12"
+
+"$TOOLS_DIR/build_tools.sh"
+
+"$TOOLS_DIR/bin/shader_packer" \
+	"$PROJECT_DIR/shader_permutations.txt" \
+	"$PROJECT_DIR/shaders.pak" \
+	"$@"
@@ -0,0 +1,193 @@
+#!/bin/sh
+# Liam Wynn, 10/18/2026, Hello DirectX 12
+#
+# Builds the command line tools in this directory into tools/bin. These
+# only use the platform-neutral parts of the project, so they build on
+# Linux as well as Windows (with any C++17 compiler; set CXX to pick one).
+#
+# Set SANITIZE to build with a sanitizer, e.g. SANITIZE=thread for
+# ThreadSanitizer or SANITIZE=address.
+
+set -e
+
+TOOLS_DIR=$(cd "$(dirname "$0")" && pwd)
+PROJECT_DIR="$TOOLS_DIR/../hello_directx12"
+BUILD_DIR="$TOOLS_DIR/bin"
+
+CXX="${CXX:-c++}"
+CXXFLAGS="-std=c++17 -O2 -pthread -I$PROJECT_DIR"
+
+if [ -n "$SANITIZE" ]; then
+	CXXFLAGS="$CXXFLAGS -g -fsanitize=$SANITIZE"
+fi
+
+mkdir -p "$BUILD_DIR"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/shader_packer.cpp" \
+	"$PROJECT_DIR/shader_archive.cpp" \
+	"$PROJECT_DIR/shader_cache.cpp" \
+	"$PROJECT_DIR/file_mapping.cpp" \
+	-o "$BUILD_DIR/shader_packer"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/shader_cache_bench.cpp" \
+	"$PROJECT_DIR/shader_cache.cpp" \
+	"$PROJECT_DIR/file_mapping.cpp" \
+	-o "$BUILD_DIR/shader_cache_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/asset_packer.cpp" \
+	"$PROJECT_DIR/asset_archive.cpp" \
+	"$PROJECT_DIR/lz4_block.cpp" \
+	"$PROJECT_DIR/file_mapping.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/asset_packer"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/frame_graph_report.cpp" \
+	"$PROJECT_DIR/frame_graph.cpp" \
+	"$PROJECT_DIR/resource_state_tracker.cpp" \
+	-o "$BUILD_DIR/frame_graph_report"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/resource_state_tracker_test.cpp" \
+	"$PROJECT_DIR/resource_state_tracker.cpp" \
+	-o "$BUILD_DIR/resource_state_tracker_test"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/tlsf_stress.cpp" \
+	"$PROJECT_DIR/tlsf_allocator.cpp" \
+	-o "$BUILD_DIR/tlsf_stress"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/residency_sim.cpp" \
+	"$PROJECT_DIR/residency_manager.cpp" \
+	-o "$BUILD_DIR/residency_sim"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/profiler_bench.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/profiler_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/frame_pacer_sim.cpp" \
+	"$PROJECT_DIR/frame_pacer.cpp" \
+	-o "$BUILD_DIR/frame_pacer_sim"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/simulation_test.cpp" \
+	"$PROJECT_DIR/simulation.cpp" \
+	"$PROJECT_DIR/frame_pacer.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/simulation_test"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/render_ring_bench.cpp" \
+	"$PROJECT_DIR/render_ring.cpp" \
+	-o "$BUILD_DIR/render_ring_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/job_system_bench.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/job_system_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/startup_graph_bench.cpp" \
+	"$PROJECT_DIR/task_graph.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/startup_graph_bench"
+
+# Replaces the global operator new, so it gets ALLOC_TRACKING and only
+# the modules the frame loop uses.
+$CXX $CXXFLAGS -DALLOC_TRACKING \
+	"$TOOLS_DIR/frame_alloc_test.cpp" \
+	"$PROJECT_DIR/alloc_tracker.cpp" \
+	"$PROJECT_DIR/frame_arena.cpp" \
+	"$PROJECT_DIR/render_ring.cpp" \
+	"$PROJECT_DIR/frame_pacer.cpp" \
+	"$PROJECT_DIR/simulation.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	"$PROJECT_DIR/frame_graph.cpp" \
+	"$PROJECT_DIR/resource_state_tracker.cpp" \
+	"$PROJECT_DIR/render_queue.cpp" \
+	-o "$BUILD_DIR/frame_alloc_test"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/constant_allocator_bench.cpp" \
+	"$PROJECT_DIR/constant_allocator.cpp" \
+	-o "$BUILD_DIR/constant_allocator_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/material_bench.cpp" \
+	"$PROJECT_DIR/material_registry.cpp" \
+	-o "$BUILD_DIR/material_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/atlas_bench.cpp" \
+	"$PROJECT_DIR/texture_atlas.cpp" \
+	-o "$BUILD_DIR/atlas_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/sprite_bench.cpp" \
+	"$PROJECT_DIR/sprite_batcher.cpp" \
+	-o "$BUILD_DIR/sprite_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/render_queue_bench.cpp" \
+	"$PROJECT_DIR/render_queue.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/render_queue_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/gpu_culling_test.cpp" \
+	"$PROJECT_DIR/gpu_culling.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/gpu_culling_test"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/simplify_bench.cpp" \
+	"$PROJECT_DIR/mesh_simplifier.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/simplify_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/lod_bench.cpp" \
+	"$PROJECT_DIR/lod_selector.cpp" \
+	"$PROJECT_DIR/mesh_simplifier.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/lod_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/occlusion_test.cpp" \
+	"$PROJECT_DIR/occlusion_culler.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/occlusion_test"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/asset_archive_bench.cpp" \
+	"$PROJECT_DIR/asset_archive.cpp" \
+	"$PROJECT_DIR/lz4_block.cpp" \
+	"$PROJECT_DIR/file_mapping.cpp" \
+	"$PROJECT_DIR/job_system.cpp" \
+	"$PROJECT_DIR/profiler.cpp" \
+	-o "$BUILD_DIR/asset_archive_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/io_queue_bench.cpp" \
+	"$PROJECT_DIR/io_queue.cpp" \
+	-o "$BUILD_DIR/io_queue_bench"
+
+$CXX $CXXFLAGS \
+	"$TOOLS_DIR/texture_cache_bench.cpp" \
+	"$PROJECT_DIR/texture_cache.cpp" \
+	-o "$BUILD_DIR/texture_cache_bench"
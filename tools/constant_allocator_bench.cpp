@@ -0,0 +1,389 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the per-frame constant allocator, then measures how fast it
+	can fill a frame's constants.
+
+	Checks:
+		alignment    Every slice, whatever its size, starts on a 256 byte
+		             boundary, and its CPU and GPU addresses agree.
+		offsets      Slices are packed one after another and never
+		             overlap.
+		frames       Each frame has its own region, beginning a frame
+		             starts it from the beginning again, and frames wrap
+		             around the frame count.
+		full         An allocation that doesn't fit fails without
+		             touching the frame, and is counted.
+		batch        write_transform_constants gives the same matrices
+		             as multiplying them one by one.
+
+	Benchmarks, at 100,000 constants a frame:
+		one by one   An allocation per draw, each matrix multiplied and
+		             copied on its own (what a simple renderer does).
+		batch        One allocation for the whole frame, and every matrix
+		             written by write_transform_constants.
+
+	The "GPU addresses" are made up; nothing here needs a GPU.
+
+	Usage:
+		constant_allocator_bench [--quick]
+*/
+
+#include "constant_allocator.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+const uint32_t FRAME_COUNT = 3;
+const uint32_t BENCH_CONSTANTS = 100000;
+const uint32_t BENCH_FRAMES = 20;
+const uint64_t FAKE_GPU_BASE = 0x100000000ull;
+// One MVP matrix.
+const uint64_t MATRIX_SIZE = 64;
+
+// Laid out like the application's draw_packet.
+struct draw {
+	float model_matrix[16];
+	uint32_t index_count;
+};
+
+// A mapped upload buffer stand-in, aligned like a real one.
+struct fake_buffer {
+	unique_ptr<uint8_t[]> memory;
+	uint8_t* base;
+	uint64_t size;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static void create_fake_buffer(fake_buffer* buffer, const uint64_t size);
+static void make_matrix(mt19937* random, float* matrix);
+static void multiply_matrix(const float* a, const float* b, float* result);
+
+static bool run_alignment();
+static bool run_offsets();
+static bool run_frames();
+static bool run_full();
+static bool run_batch();
+static void run_benchmarks();
+
+int main(int argc, char** argv) {
+	bool quick;
+	bool success;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	success = true;
+	success = run_alignment() && success;
+	success = run_offsets() && success;
+	success = run_frames() && success;
+	success = run_full() && success;
+	success = run_batch() && success;
+
+	if (!quick) {
+		run_benchmarks();
+	}
+
+	printf(success ? "All checks passed\n" : "Some checks failed\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void create_fake_buffer(fake_buffer* buffer, const uint64_t size) {
+	buffer->memory.reset(new uint8_t[size + CONSTANT_BUFFER_ALIGNMENT]);
+	buffer->base = (uint8_t*)(((uintptr_t)buffer->memory.get() + CONSTANT_BUFFER_ALIGNMENT - 1) &
+		~(uintptr_t)(CONSTANT_BUFFER_ALIGNMENT - 1));
+	buffer->size = size;
+}
+
+static void make_matrix(mt19937* random, float* matrix) {
+	uniform_real_distribution<float> value(-10.0f, 10.0f);
+	uint32_t i;
+
+	for (i = 0; i < 16; i++) {
+		matrix[i] = value(*random);
+	}
+}
+
+static void multiply_matrix(const float* a, const float* b, float* result) {
+	uint32_t i;
+	uint32_t j;
+	uint32_t k;
+
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < 4; j++) {
+			result[i * 4 + j] = 0.0f;
+
+			for (k = 0; k < 4; k++) {
+				result[i * 4 + j] += a[i * 4 + k] * b[k * 4 + j];
+			}
+		}
+	}
+}
+
+static bool run_alignment() {
+	constant_allocator allocator;
+	fake_buffer buffer;
+	constant_slice slice;
+	mt19937 random(1);
+	uniform_int_distribution<uint32_t> size(0, 2000);
+	bool aligned;
+	bool agree;
+	uint32_t i;
+
+	printf("Alignment\n");
+
+	create_fake_buffer(&buffer, get_constant_buffer_size(1 << 20, FRAME_COUNT));
+	initialize_constant_allocator(&allocator, buffer.base, FAKE_GPU_BASE, 1 << 20, FRAME_COUNT);
+	begin_constant_frame(&allocator, 0);
+
+	aligned = true;
+	agree = true;
+
+	for (i = 0; i < 500; i++) {
+		if (!allocate_constants(&allocator, size(random), &slice)) {
+			break;
+		}
+
+		aligned = aligned && slice.offset % CONSTANT_BUFFER_ALIGNMENT == 0;
+		aligned = aligned && (uintptr_t)slice.cpu % CONSTANT_BUFFER_ALIGNMENT == 0;
+		aligned = aligned && slice.gpu_address % CONSTANT_BUFFER_ALIGNMENT == 0;
+		agree = agree && slice.gpu_address - FAKE_GPU_BASE == (uint64_t)(slice.cpu - buffer.base);
+	}
+
+	return check(i == 500, "every allocation fitted") &&
+		check(aligned, "every slice is 256 byte aligned") &&
+		check(agree, "CPU and GPU addresses point at the same place");
+}
+
+static bool run_offsets() {
+	constant_allocator allocator;
+	fake_buffer buffer;
+	constant_slice slices[4];
+	constant_slice array;
+	uint64_t stride;
+	bool success;
+
+	printf("Offsets\n");
+
+	create_fake_buffer(&buffer, get_constant_buffer_size(4096, FRAME_COUNT));
+	initialize_constant_allocator(&allocator, buffer.base, FAKE_GPU_BASE, 4096, FRAME_COUNT);
+	begin_constant_frame(&allocator, 0);
+
+	allocate_constants(&allocator, 64, &(slices[0]));
+	allocate_constants(&allocator, 256, &(slices[1]));
+	allocate_constants(&allocator, 257, &(slices[2]));
+	allocate_constants(&allocator, 0, &(slices[3]));
+	allocate_constant_array(&allocator, MATRIX_SIZE, 4, &array, &stride);
+
+	success = check(
+		slices[0].offset == 0 && slices[1].offset == 256 &&
+		slices[2].offset == 512 && slices[3].offset == 1024,
+		"slices are rounded up to 256 bytes and packed in order"
+	);
+	success = check(slices[2].size == 512, "257 bytes takes two blocks") && success;
+	success = check(slices[3].size == 256, "even an empty slice gets a block of its own") && success;
+	success = check(stride == 256 && array.offset == 1280 && array.size == 1024, "arrays get a block per element") && success;
+	success = check(get_constant_allocator_stats(&allocator).used == 2304, "used counts the rounding") && success;
+
+	return success;
+}
+
+static bool run_frames() {
+	constant_allocator allocator;
+	fake_buffer buffer;
+	constant_slice first[FRAME_COUNT];
+	constant_slice second[FRAME_COUNT];
+	constant_slice wrapped;
+	bool separate;
+	bool restarted;
+	uint32_t frame;
+
+	printf("Frames\n");
+
+	create_fake_buffer(&buffer, get_constant_buffer_size(1000, FRAME_COUNT));
+	initialize_constant_allocator(&allocator, buffer.base, FAKE_GPU_BASE, 1000, FRAME_COUNT);
+
+	separate = true;
+	restarted = true;
+
+	for (frame = 0; frame < FRAME_COUNT; frame++) {
+		begin_constant_frame(&allocator, frame);
+		allocate_constants(&allocator, 100, &(first[frame]));
+		allocate_constants(&allocator, 100, &(second[frame]));
+
+		// 1000 rounds up to 1024, so each frame's region starts 1024
+		// bytes after the last.
+		separate = separate && first[frame].cpu == buffer.base + frame * 1024;
+		restarted = restarted && first[frame].offset == 0 && second[frame].offset == 256;
+	}
+
+	begin_constant_frame(&allocator, FRAME_COUNT);
+	allocate_constants(&allocator, 100, &wrapped);
+
+	return check(get_constant_buffer_size(1000, FRAME_COUNT) == 3 * 1024, "the buffer has a whole region per frame") &&
+		check(separate, "each frame has its own region") &&
+		check(restarted, "beginning a frame starts from the beginning of its region") &&
+		check(wrapped.cpu == first[0].cpu, "frames wrap around the frame count");
+}
+
+static bool run_full() {
+	constant_allocator allocator;
+	fake_buffer buffer;
+	constant_slice slice;
+	uint64_t stride;
+	bool success;
+
+	printf("Full\n");
+
+	create_fake_buffer(&buffer, get_constant_buffer_size(1024, FRAME_COUNT));
+	initialize_constant_allocator(&allocator, buffer.base, FAKE_GPU_BASE, 1024, FRAME_COUNT);
+	begin_constant_frame(&allocator, 1);
+
+	success = check(allocate_constants(&allocator, 768, &slice), "768 of 1024 bytes fits");
+	success = check(!allocate_constant_array(&allocator, MATRIX_SIZE, 2, &slice, &stride), "two more blocks don't") && success;
+	success = check(get_constant_allocator_stats(&allocator).used == 768, "the failed allocation used nothing") && success;
+	success = check(allocate_constants(&allocator, 256, &slice), "the last block still does") && success;
+	success = check(slice.cpu + 256 == buffer.base + 2 * 1024, "and ends right where the next frame starts") && success;
+	success = check(!allocate_constants(&allocator, 1, &slice), "after that nothing does") && success;
+	success = check(get_constant_allocator_stats(&allocator).failures == 2, "both failures were counted") && success;
+
+	return success;
+}
+
+static bool run_batch() {
+	vector<draw> draws;
+	fake_buffer buffer;
+	float view_projection[16];
+	float expected[16];
+	const float* written;
+	mt19937 random(2);
+	float worst;
+	float error;
+	uint32_t i;
+	uint32_t j;
+
+	printf("Batch\n");
+
+	draws.resize(1000);
+	for (i = 0; i < draws.size(); i++) {
+		make_matrix(&random, draws[i].model_matrix);
+		draws[i].index_count = 36;
+	}
+
+	make_matrix(&random, view_projection);
+
+	create_fake_buffer(&buffer, draws.size() * 256);
+	write_transform_constants(
+		view_projection,
+		&(draws[0].model_matrix),
+		sizeof(draw),
+		(uint32_t)draws.size(),
+		buffer.base,
+		256
+	);
+
+	worst = 0.0f;
+
+	for (i = 0; i < draws.size(); i++) {
+		multiply_matrix(draws[i].model_matrix, view_projection, expected);
+		written = (const float*)(buffer.base + i * 256);
+
+		for (j = 0; j < 16; j++) {
+			error = fabsf(written[j] - expected[j]) / (1.0f + fabsf(expected[j]));
+			worst = error > worst ? error : worst;
+		}
+	}
+
+	return check(worst < 1e-5f, "every matrix matches model * view_projection");
+}
+
+static void run_benchmarks() {
+	constant_allocator allocator;
+	fake_buffer buffer;
+	vector<draw> draws;
+	float view_projection[16];
+	float mvp[16];
+	constant_slice slice;
+	uint64_t stride;
+	mt19937 random(3);
+	double start;
+	double one_by_one;
+	double batch;
+	uint32_t frame;
+	uint32_t i;
+
+	printf("Benchmarks (%u constants a frame, %u frames)\n", BENCH_CONSTANTS, BENCH_FRAMES);
+
+	draws.resize(BENCH_CONSTANTS);
+	for (i = 0; i < draws.size(); i++) {
+		make_matrix(&random, draws[i].model_matrix);
+	}
+
+	make_matrix(&random, view_projection);
+
+	create_fake_buffer(&buffer, get_constant_buffer_size(BENCH_CONSTANTS * 256, FRAME_COUNT));
+	initialize_constant_allocator(
+		&allocator,
+		buffer.base,
+		FAKE_GPU_BASE,
+		BENCH_CONSTANTS * 256,
+		FRAME_COUNT
+	);
+
+	// Touch every page first, so neither run pays for faulting them in.
+	memset(buffer.base, 0, buffer.size);
+
+	start = now_seconds();
+
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		begin_constant_frame(&allocator, frame);
+
+		for (i = 0; i < BENCH_CONSTANTS; i++) {
+			allocate_constants(&allocator, MATRIX_SIZE, &slice);
+			multiply_matrix(draws[i].model_matrix, view_projection, mvp);
+			memcpy(slice.cpu, mvp, sizeof(mvp));
+		}
+	}
+
+	one_by_one = (now_seconds() - start) / BENCH_FRAMES;
+
+	start = now_seconds();
+
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		begin_constant_frame(&allocator, frame);
+
+		allocate_constant_array(&allocator, MATRIX_SIZE, BENCH_CONSTANTS, &slice, &stride);
+		write_transform_constants(
+			view_projection,
+			&(draws[0].model_matrix),
+			sizeof(draw),
+			BENCH_CONSTANTS,
+			slice.cpu,
+			stride
+		);
+	}
+
+	batch = (now_seconds() - start) / BENCH_FRAMES;
+
+	printf("  %-12s %8.3fms a frame  %6.1fns a constant\n", "one by one", one_by_one * 1000.0, one_by_one * 1e9 / BENCH_CONSTANTS);
+	printf("  %-12s %8.3fms a frame  %6.1fns a constant\n", "batch", batch * 1000.0, batch * 1e9 / BENCH_CONSTANTS);
+	printf("  batch is %.2fx faster\n", one_by_one / batch);
+	printf("  %s", get_constant_allocator_report(&allocator).c_str());
+}
@@ -0,0 +1,531 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Runs the application's frame loop without a GPU, and checks that once
+	it has warmed up, a frame doesn't allocate anything.
+
+	The main thread does what application::frame does: it paces the
+	frame, reads the simulation, splits some work across the job system,
+	and writes the frame's packets into the render ring. The render
+	thread does what run_render_thread and render do: it copies the draws
+	into its frame arena, sorts them with the render queue, then tracks the back buffer's states and runs
+	the frame graph, with fake resources standing in for the D3D ones.
+	Both threads count their allocations each frame, and the profiler
+	collects every frame as it does in the application.
+
+	Also checks the frame arena itself:
+
+		alignment    Allocations are aligned as asked.
+		overflow     A frame that doesn't fit still gets its memory, and
+		             the arena grows so the next one does fit.
+
+	Must be built with ALLOC_TRACKING (build_tools.sh does this).
+
+	Usage:
+		frame_alloc_test
+*/
+
+#include "alloc_tracker.h"
+#include "frame_arena.h"
+#include "frame_graph.h"
+#include "frame_pacer.h"
+#include "job_system.h"
+#include "profiler.h"
+#include "render_queue.h"
+#include "render_ring.h"
+#include "resource_state_tracker.h"
+#include "simulation.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+const uint32_t FRAMES = 240;
+// Frames before we start expecting no allocations. The first few grow
+// the arena, the profiler's buffers and so on.
+const uint32_t WARM_UP_FRAMES = 30;
+const uint32_t FRAME_RATE = 500;
+const uint32_t SIM_RATE = 60;
+const uint32_t DRAWS_PER_FRAME = 200;
+const uint64_t RING_SIZE = 1 << 16;
+const uint32_t MAX_QUEUED_FRAMES = 2;
+// Smaller than a frame's draws, so the arena has to grow.
+const size_t ARENA_SIZE = 1024;
+const uint32_t BACK_BUFFER_COUNT = 3;
+
+enum {
+	PACKET_BEGIN_FRAME = 1,
+	PACKET_DRAW,
+	PACKET_END_FRAME,
+	PACKET_QUIT
+};
+
+// The same shape as the application's packets, without DirectXMath.
+struct begin_packet {
+	float view_matrix[16];
+	float projection_matrix[16];
+	uint32_t back_buffer;
+	uint32_t draw_count;
+};
+
+struct draw {
+	float model_matrix[16];
+	uint32_t index_count;
+	uint32_t material;
+	uint64_t sort_key;
+};
+
+struct renderer {
+	render_ring ring;
+	frame_arena arena;
+	alloc_frame_stats allocs;
+
+	resource_state_registry registry;
+	command_list_state_tracker tracker;
+	vector<resource_barrier> barriers;
+	frame_graph graph;
+	// Stand-ins for the back buffers. Only their addresses are used.
+	uint8_t back_buffers[BACK_BUFFER_COUNT];
+
+	draw* draws;
+	uint32_t draw_count;
+	uint32_t draw_capacity;
+	render_queue queue;
+	uint32_t back_buffer;
+
+	uint64_t indices_drawn;
+	uint64_t barriers_recorded;
+};
+
+static bool check(const bool condition, const char* message);
+
+static void step_world(
+	sim_snapshot* world,
+	const uint32_t input,
+	const double step_seconds,
+	void* user_data
+);
+static void build_matrices(const uint32_t begin, const uint32_t end, void* data);
+static void submit_frame(renderer* render, const sim_snapshot* drawn, const uint32_t frame);
+static void run_render_thread(renderer* render);
+static void render_frame(renderer* render);
+static void record_main_pass(void* user_data);
+static void record_barriers(
+	const frame_graph* graph,
+	const vector<frame_graph_barrier>& barriers,
+	void* user_data
+);
+
+static bool run_alignment();
+static bool run_overflow();
+static bool run_frame_loop();
+
+// Too big for the stack.
+static renderer render_state;
+static simulation sim;
+static sim_snapshot drawn;
+static draw frame_draws[DRAWS_PER_FRAME];
+
+int main() {
+	bool success;
+
+	if (!is_alloc_tracking_enabled()) {
+		printf("FAIL: built without ALLOC_TRACKING, so there is nothing to count\n");
+		return 1;
+	}
+
+	success = true;
+	success = run_alignment() && success;
+	success = run_overflow() && success;
+	success = run_frame_loop() && success;
+
+	printf(success ? "All checks passed\n" : "Some checks failed\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static void step_world(
+	sim_snapshot* world,
+	const uint32_t,
+	const double step_seconds,
+	void*
+) {
+	uint32_t i;
+
+	for (i = 0; i < world->transform_count; i++) {
+		world->transforms[i].position[0] += (float)step_seconds;
+	}
+}
+
+// Stands in for working out each object's matrices.
+static void build_matrices(const uint32_t begin, const uint32_t end, void* data) {
+	const sim_snapshot* world;
+	const sim_transform* transform;
+	uint32_t i;
+
+	world = (const sim_snapshot*)data;
+
+	for (i = begin; i < end; i++) {
+		transform = &(world->transforms[i % world->transform_count]);
+
+		memset(frame_draws[i].model_matrix, 0, sizeof(frame_draws[i].model_matrix));
+		frame_draws[i].model_matrix[0] = transform->scale[0];
+		frame_draws[i].model_matrix[5] = transform->scale[1];
+		frame_draws[i].model_matrix[10] = transform->scale[2];
+		frame_draws[i].model_matrix[12] = transform->position[0];
+		frame_draws[i].model_matrix[13] = transform->position[1];
+		frame_draws[i].model_matrix[14] = transform->position[2];
+		frame_draws[i].model_matrix[15] = 1.0f;
+		frame_draws[i].index_count = 36;
+		frame_draws[i].material = i % 8;
+		frame_draws[i].sort_key = make_render_key(
+			0,
+			RENDER_PASS_OPAQUE,
+			0,
+			frame_draws[i].material,
+			transform->position[2]
+		);
+	}
+}
+
+static void submit_frame(renderer* render, const sim_snapshot* world, const uint32_t frame) {
+	begin_packet* begin;
+	draw* packet;
+	uint32_t i;
+
+	PROFILE_ZONE("submit frame");
+
+	begin_render_frame(&(render->ring), MAX_QUEUED_FRAMES);
+
+	begin = (begin_packet*)begin_render_packet(&(render->ring), PACKET_BEGIN_FRAME, sizeof(begin_packet));
+	memcpy(begin->view_matrix, world->camera.eye, sizeof(world->camera.eye));
+	memset(begin->projection_matrix, 0, sizeof(begin->projection_matrix));
+	begin->back_buffer = frame % BACK_BUFFER_COUNT;
+	begin->draw_count = DRAWS_PER_FRAME;
+	end_render_packet(&(render->ring));
+
+	for (i = 0; i < DRAWS_PER_FRAME; i++) {
+		packet = (draw*)begin_render_packet(&(render->ring), PACKET_DRAW, sizeof(draw));
+		*packet = frame_draws[i];
+		end_render_packet(&(render->ring));
+	}
+
+	write_render_packet(&(render->ring), PACKET_END_FRAME, NULL, 0);
+	end_render_frame(&(render->ring));
+}
+
+static void run_render_thread(renderer* render) {
+	const render_packet_header* packet;
+	const begin_packet* begin;
+	uint32_t type;
+	bool running;
+
+	set_profile_thread_name("Render thread");
+	initialize_alloc_frame_stats(&(render->allocs), "render thread");
+
+	running = true;
+
+	while (running) {
+		packet = wait_for_render_packet(&(render->ring));
+		type = packet->type;
+
+		switch (type) {
+		case PACKET_BEGIN_FRAME:
+			begin_alloc_frame(&(render->allocs));
+			reset_frame_arena(&(render->arena));
+
+			begin = (const begin_packet*)get_render_packet_data(packet);
+			render->draws = allocate_array_from_arena<draw>(&(render->arena), begin->draw_count);
+			render->draw_count = 0;
+			render->draw_capacity = begin->draw_count;
+			reset_render_queue(&(render->queue));
+			render->back_buffer = begin->back_buffer;
+			break;
+		case PACKET_DRAW:
+			if (render->draw_count < render->draw_capacity) {
+				render->draws[render->draw_count] = *(const draw*)get_render_packet_data(packet);
+				add_render_item(&(render->queue), render->draws[render->draw_count].sort_key, render->draw_count);
+				render->draw_count++;
+			}
+			break;
+		case PACKET_END_FRAME:
+			render_frame(render);
+			end_alloc_frame(&(render->allocs));
+			break;
+		case PACKET_QUIT:
+			running = false;
+			break;
+		}
+
+		pop_render_packet(&(render->ring));
+
+		if (type == PACKET_END_FRAME) {
+			finish_render_frame(&(render->ring));
+		}
+	}
+}
+
+// What populate_command_list and execute_command_list do to the
+// states, minus the D3D calls.
+static void render_frame(renderer* render) {
+	const void* back_buffer;
+
+	PROFILE_ZONE("render");
+
+	back_buffer = &(render->back_buffers[render->back_buffer]);
+
+	reset_state_tracker(&(render->tracker), &(render->registry));
+
+	transition_resource(&(render->tracker), back_buffer, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET);
+	render->barriers_recorded += flush_resource_barriers(&(render->tracker), &(render->barriers));
+
+	execute_frame_graph(&(render->graph), record_barriers, render);
+
+	transition_resource(&(render->tracker), back_buffer, ALL_SUBRESOURCES, RESOURCE_STATE_PRESENT);
+	render->barriers_recorded += flush_resource_barriers(&(render->tracker), &(render->barriers));
+
+	render->barriers_recorded += resolve_pending_barriers(
+		&(render->registry),
+		&(render->tracker),
+		&(render->barriers)
+	);
+}
+
+static void record_main_pass(void* user_data) {
+	renderer* render;
+	uint32_t i;
+
+	PROFILE_ZONE("main pass");
+
+	render = (renderer*)user_data;
+
+	// Few enough draws that the application sorts them on the render
+	// thread too.
+	sort_render_queue(&(render->queue), NULL);
+
+	for (i = 0; i < (uint32_t)render->queue.items.size(); i++) {
+		get_render_state_changes(&(render->queue), i);
+		render->indices_drawn += render->draws[render->queue.items[i].draw].index_count;
+	}
+}
+
+static void record_barriers(
+	const frame_graph*,
+	const vector<frame_graph_barrier>& barriers,
+	void* user_data
+) {
+	((renderer*)user_data)->barriers_recorded += barriers.size();
+}
+
+static bool run_alignment() {
+	frame_arena arena;
+	void* pointer;
+	bool aligned;
+	uint32_t i;
+
+	printf("Alignment\n");
+
+	initialize_frame_arena(&arena, 65536);
+	aligned = true;
+
+	for (i = 0; i < 64; i++) {
+		// Odd sizes, so the next allocation starts misaligned.
+		pointer = allocate_from_arena(&arena, i * 3 + 1, (size_t)1 << (i % 9));
+		aligned = aligned && ((uintptr_t)pointer % ((size_t)1 << (i % 9))) == 0;
+	}
+
+	pointer = allocate_array_from_arena<uint64_t>(&arena, 3);
+
+	return check(aligned, "every allocation is aligned as asked") &&
+		check((uintptr_t)pointer % FRAME_ARENA_ALIGNMENT == 0, "arrays are at least 16 byte aligned") &&
+		check(get_frame_arena_stats(&arena).overflows == 0, "everything fitted");
+}
+
+static bool run_overflow() {
+	frame_arena arena;
+	uint8_t* first;
+	uint8_t* second;
+	alloc_counts before;
+	bool success;
+
+	printf("Overflow\n");
+
+	initialize_frame_arena(&arena, 256);
+
+	first = (uint8_t*)allocate_from_arena(&arena, 200);
+	second = (uint8_t*)allocate_from_arena(&arena, 200);
+	memset(first, 1, 200);
+	memset(second, 2, 200);
+
+	success = check(second != NULL, "an allocation that doesn't fit still gets memory");
+	success = check(first[199] == 1 && second[0] == 2, "and doesn't overlap the one before") && success;
+	success = check(get_frame_arena_stats(&arena).overflows == 1, "it was counted as an overflow") && success;
+
+	// Grows here.
+	reset_frame_arena(&arena);
+
+	before = get_thread_alloc_counts();
+	allocate_from_arena(&arena, 200);
+	allocate_from_arena(&arena, 200);
+	reset_frame_arena(&arena);
+
+	success = check(get_frame_arena_stats(&arena).grows == 1, "the arena grew once") && success;
+	success = check(
+		get_thread_alloc_counts().allocations == before.allocations,
+		"the same frame afterwards doesn't touch the heap"
+	) && success;
+
+	return success;
+}
+
+static bool run_frame_loop() {
+	frame_pacer pacer;
+	job_system jobs;
+	profiler* prof;
+	alloc_frame_stats main_allocs;
+	frame_graph_resource depth;
+	frame_graph_texture_desc depth_desc;
+	sim_snapshot initial;
+	thread render_thread;
+	alloc_counts steady_start;
+	alloc_counts steady_end;
+	uint64_t main_steady;
+	uint64_t render_steady;
+	uint32_t pass;
+	uint32_t frame;
+	uint32_t i;
+	bool success;
+
+	printf("Frame loop (%u frames, %u draws each)\n", FRAMES, DRAWS_PER_FRAME);
+
+	set_profile_thread_name("Main thread");
+	initialize_alloc_frame_stats(&main_allocs, "main thread");
+	prof = get_profiler();
+
+	//
+	// Set everything up the way the application does.
+	//
+
+	initialize_frame_pacer(&pacer, FRAME_RATE);
+	initialize_job_system(&jobs, 0, false);
+
+	memset(&initial, 0, sizeof(initial));
+	initial.transform_count = SIM_MAX_TRANSFORMS;
+
+	for (i = 0; i < SIM_MAX_TRANSFORMS; i++) {
+		initial.transforms[i].rotation[3] = 1.0f;
+		initial.transforms[i].scale[0] = 1.0f;
+		initial.transforms[i].scale[1] = 1.0f;
+		initial.transforms[i].scale[2] = 1.0f;
+	}
+
+	initialize_simulation(&sim, SIM_RATE, step_world, NULL, &initial);
+	start_simulation(&sim);
+
+	for (i = 0; i < BACK_BUFFER_COUNT; i++) {
+		register_resource(&(render_state.registry), &(render_state.back_buffers[i]), 1, RESOURCE_STATE_PRESENT);
+	}
+
+	depth_desc = {};
+	depth_desc.width = 640;
+	depth_desc.height = 480;
+	depth_desc.format = 40;
+	depth_desc.size = 640 * 480 * 4;
+	depth_desc.alignment = 65536;
+
+	reset_frame_graph(&(render_state.graph));
+	depth = create_transient_texture(&(render_state.graph), "depth", depth_desc);
+	pass = add_pass(&(render_state.graph), "main", record_main_pass, &render_state, true);
+	write_resource(&(render_state.graph), pass, depth, RESOURCE_STATE_DEPTH_WRITE);
+
+	if (!compile_frame_graph(&(render_state.graph))) {
+		return check(false, "the frame graph compiles");
+	}
+
+	initialize_render_ring(&(render_state.ring), RING_SIZE, RENDER_RING_WAIT);
+	initialize_frame_arena(&(render_state.arena), ARENA_SIZE);
+	render_state.draws = NULL;
+	render_state.draw_count = 0;
+	render_state.draw_capacity = 0;
+	initialize_render_queue(&(render_state.queue), DRAWS_PER_FRAME);
+	render_state.indices_drawn = 0;
+	render_state.barriers_recorded = 0;
+	render_thread = thread(run_render_thread, &render_state);
+
+	//
+	// The loop itself. Everything here should be allocation free once
+	// it has warmed up.
+	//
+
+	steady_start = {};
+	main_steady = 0;
+	render_steady = 0;
+
+	for (frame = 0; frame < FRAMES; frame++) {
+		if (frame == WARM_UP_FRAMES) {
+			steady_start = get_alloc_counts();
+			main_steady = main_allocs.total_allocations.load();
+			render_steady = render_state.allocs.total_allocations.load();
+		}
+
+		begin_paced_frame(&pacer);
+		begin_alloc_frame(&main_allocs);
+
+		{
+			PROFILE_ZONE("frame");
+
+			read_simulation(&sim, get_system_time_ns(NULL), &drawn);
+			parallel_for(&jobs, DRAWS_PER_FRAME, 16, build_matrices, &drawn);
+			submit_frame(&render_state, &drawn, frame);
+		}
+
+		collect_profile_frame(prof);
+		end_alloc_frame(&main_allocs);
+	}
+
+	//
+	// Let the render thread finish the last frames before counting.
+	//
+
+	begin_render_frame(&(render_state.ring), 1);
+	steady_end = get_alloc_counts();
+
+	write_render_packet(&(render_state.ring), PACKET_QUIT, NULL, 0);
+	render_thread.join();
+	stop_simulation(&sim);
+	shutdown_job_system(&jobs);
+
+	main_steady = main_allocs.total_allocations.load() - main_steady;
+	render_steady = render_state.allocs.total_allocations.load() - render_steady;
+
+	printf("  %s", get_alloc_report(&main_allocs).c_str());
+	printf("  %s", get_alloc_report(&(render_state.allocs)).c_str());
+	printf("  %s", get_frame_arena_report(&(render_state.arena)).c_str());
+	printf(
+		"  Whole program: %llu allocations after warming up\n",
+		(unsigned long long)(steady_end.allocations - steady_start.allocations)
+	);
+
+	success = check(render_state.allocs.frames.load() == FRAMES, "the render thread saw every frame");
+	success = check(
+		render_state.indices_drawn == (uint64_t)FRAMES * DRAWS_PER_FRAME * 36,
+		"every draw made it through the arena"
+	) && success;
+	success = check(render_state.barriers_recorded > 0, "the state tracker recorded barriers") && success;
+	success = check(render_state.arena.grows > 0, "the frame arena grew to fit a frame") && success;
+	success = check(main_steady == 0, "the main thread doesn't allocate after warming up") && success;
+	success = check(render_steady == 0, "the render thread doesn't allocate after warming up") && success;
+	success = check(
+		steady_end.allocations == steady_start.allocations,
+		"nothing else allocates either"
+	) && success;
+
+	return success;
+}
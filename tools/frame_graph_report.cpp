@@ -0,0 +1,183 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Builds a few example frame graphs and prints the compiled result for
+	each: which passes survive culling, where each transient lands in the
+	transient heap, and the peak transient memory with and without
+	aliasing.
+
+	The graphs are made up, but the passes are the kind we expect to
+	add (shadow maps, post-processing), so this is a quick way to see
+	what a change to the frame graph does to memory.
+
+	Usage:
+		frame_graph_report
+*/
+
+#include "frame_graph.h"
+
+#include <cstdio>
+
+using namespace std;
+
+// DXGI_FORMAT values, so we don't need the Windows headers here.
+const uint32_t FORMAT_R8G8B8A8_UNORM = 28;
+const uint32_t FORMAT_R16G16B16A16_FLOAT = 10;
+const uint32_t FORMAT_D32_FLOAT = 40;
+
+// Textures are 64KB aligned. We estimate sizes the way the driver
+// would for a plain 2D texture without any padding.
+const uint64_t TEXTURE_ALIGNMENT = 65536;
+
+static frame_graph_texture_desc make_texture_desc(
+	const uint32_t width,
+	const uint32_t height,
+	const uint32_t format,
+	const uint32_t bytes_per_pixel
+);
+static void build_forward_graph(frame_graph* graph);
+static void build_post_processing_graph(frame_graph* graph);
+static void report(const char* title, frame_graph* graph);
+
+int main() {
+	frame_graph graph;
+
+	build_forward_graph(&graph);
+	report("Forward (what the application does today)", &graph);
+
+	build_post_processing_graph(&graph);
+	report("Shadows + HDR + bloom + tone mapping", &graph);
+
+	return 0;
+}
+
+static frame_graph_texture_desc make_texture_desc(
+	const uint32_t width,
+	const uint32_t height,
+	const uint32_t format,
+	const uint32_t bytes_per_pixel
+) {
+	frame_graph_texture_desc desc;
+	uint64_t size;
+
+	size = (uint64_t)width * height * bytes_per_pixel;
+
+	desc = {};
+	desc.width = width;
+	desc.height = height;
+	desc.format = format;
+	desc.size = (size + TEXTURE_ALIGNMENT - 1) / TEXTURE_ALIGNMENT * TEXTURE_ALIGNMENT;
+	desc.alignment = TEXTURE_ALIGNMENT;
+
+	return desc;
+}
+
+static void build_forward_graph(frame_graph* graph) {
+	frame_graph_resource depth;
+	uint32_t pass;
+
+	reset_frame_graph(graph);
+
+	depth = create_transient_texture(
+		graph,
+		"depth",
+		make_texture_desc(640, 480, FORMAT_D32_FLOAT, 4)
+	);
+
+	pass = add_pass(graph, "main", NULL, NULL, true);
+	write_resource(graph, pass, depth, RESOURCE_STATE_DEPTH_WRITE);
+}
+
+static void build_post_processing_graph(frame_graph* graph) {
+	frame_graph_resource back_buffer;
+	frame_graph_resource shadow_map;
+	frame_graph_resource depth;
+	frame_graph_resource hdr;
+	frame_graph_resource bloom_half;
+	frame_graph_resource bloom_quarter;
+	frame_graph_resource debug_view;
+	uint32_t pass;
+
+	reset_frame_graph(graph);
+
+	back_buffer = import_resource(
+		graph,
+		"back buffer",
+		NULL,
+		RESOURCE_STATE_PRESENT,
+		RESOURCE_STATE_PRESENT
+	);
+
+	shadow_map = create_transient_texture(
+		graph,
+		"shadow map",
+		make_texture_desc(2048, 2048, FORMAT_D32_FLOAT, 4)
+	);
+
+	depth = create_transient_texture(
+		graph,
+		"depth",
+		make_texture_desc(1920, 1080, FORMAT_D32_FLOAT, 4)
+	);
+
+	hdr = create_transient_texture(
+		graph,
+		"hdr color",
+		make_texture_desc(1920, 1080, FORMAT_R16G16B16A16_FLOAT, 8)
+	);
+
+	bloom_half = create_transient_texture(
+		graph,
+		"bloom 1/2",
+		make_texture_desc(960, 540, FORMAT_R16G16B16A16_FLOAT, 8)
+	);
+
+	bloom_quarter = create_transient_texture(
+		graph,
+		"bloom 1/4",
+		make_texture_desc(480, 270, FORMAT_R16G16B16A16_FLOAT, 8)
+	);
+
+	debug_view = create_transient_texture(
+		graph,
+		"debug view",
+		make_texture_desc(1920, 1080, FORMAT_R8G8B8A8_UNORM, 4)
+	);
+
+	pass = add_pass(graph, "shadows", NULL, NULL, false);
+	write_resource(graph, pass, shadow_map, RESOURCE_STATE_DEPTH_WRITE);
+
+	pass = add_pass(graph, "opaque", NULL, NULL, false);
+	read_resource(graph, pass, shadow_map, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	write_resource(graph, pass, depth, RESOURCE_STATE_DEPTH_WRITE);
+	write_resource(graph, pass, hdr, RESOURCE_STATE_RENDER_TARGET);
+
+	pass = add_pass(graph, "bloom downsample", NULL, NULL, false);
+	read_resource(graph, pass, hdr, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	write_resource(graph, pass, bloom_half, RESOURCE_STATE_RENDER_TARGET);
+
+	pass = add_pass(graph, "bloom blur", NULL, NULL, false);
+	read_resource(graph, pass, bloom_half, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	write_resource(graph, pass, bloom_quarter, RESOURCE_STATE_RENDER_TARGET);
+
+	// Nobody reads the debug view, so this pass gets culled.
+	pass = add_pass(graph, "debug depth view", NULL, NULL, false);
+	read_resource(graph, pass, depth, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	write_resource(graph, pass, debug_view, RESOURCE_STATE_RENDER_TARGET);
+
+	pass = add_pass(graph, "tone map", NULL, NULL, false);
+	read_resource(graph, pass, hdr, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	read_resource(graph, pass, bloom_quarter, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	write_resource(graph, pass, back_buffer, RESOURCE_STATE_RENDER_TARGET);
+}
+
+static void report(const char* title, frame_graph* graph) {
+	printf("%s\n", title);
+
+	if (!compile_frame_graph(graph)) {
+		printf("  failed to compile\n\n");
+		return;
+	}
+
+	printf("%s\n", get_frame_graph_report(graph).c_str());
+}
@@ -0,0 +1,216 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Runs the frame pacer against a fake clock and checks it:
+
+		uncapped     No cap, so it should never sleep.
+		capped       A 60Hz cap with frames that finish early. The rate
+		             should be exactly 60Hz, even though every sleep
+		             oversleeps a little.
+		spikes       A 60Hz cap with the odd frame that takes too long.
+		             Each should count as a missed deadline, and the
+		             frames after it shouldn't bunch up to catch up.
+		histogram    Known frame times in, known percentiles out.
+
+	The fake clock only moves when the "game" does work or the pacer
+	sleeps, so this runs instantly and gives the same answer every time.
+
+	Usage:
+		frame_pacer_sim
+*/
+
+#include "frame_pacer.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+const uint64_t MS = 1000000;
+const uint64_t TARGET_NS = 1000000000ULL / 60;
+
+struct fake_clock {
+	uint64_t now_ns;
+	// How much longer than asked every sleep takes.
+	uint64_t oversleep_ns;
+	uint32_t sleeps;
+};
+
+static uint64_t fake_clock_now(void* user_data);
+static void fake_clock_sleep(const uint64_t duration_ns, void* user_data);
+static bool check(const bool condition, const char* message);
+static bool near(const double a, const double b, const double tolerance);
+
+static bool run_uncapped();
+static bool run_capped();
+static bool run_spikes();
+static bool run_histogram();
+
+int main() {
+	bool success;
+
+	success = true;
+	success = run_uncapped() && success;
+	success = run_capped() && success;
+	success = run_spikes() && success;
+	success = run_histogram() && success;
+
+	printf(success ? "All scenarios passed\n" : "Some scenarios FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool run_uncapped() {
+	frame_pacer pacer;
+	fake_clock clock;
+	frame_time_percentiles percentiles;
+	uint32_t i;
+	bool success;
+
+	clock = { 1 * MS, 0, 0 };
+	initialize_frame_pacer(&pacer, 0);
+	set_frame_pacer_clock(&pacer, fake_clock_now, fake_clock_sleep, &clock);
+
+	for (i = 0; i < 1000; i++) {
+		begin_paced_frame(&pacer);
+		clock.now_ns += 5 * MS;
+	}
+
+	percentiles = get_frame_time_percentiles(&(pacer.frame_times));
+
+	success = true;
+	success = check(clock.sleeps == 0, "uncapped shouldn't sleep") && success;
+	success = check(near(percentiles.p50_ms, 5.0, 0.1), "p50 should be 5ms") && success;
+	success = check(near(percentiles.p99_ms, 5.0, 0.1), "p99 should be 5ms") && success;
+
+	printf("uncapped   %s: %s", success ? "ok" : "FAILED", get_frame_pacing_report(&pacer).c_str());
+
+	return success;
+}
+
+static bool run_capped() {
+	frame_pacer pacer;
+	fake_clock clock;
+	frame_time_percentiles percentiles;
+	uint64_t start_ns;
+	double average_ms;
+	uint32_t i;
+	bool success;
+
+	clock = { 1 * MS, 300000, 0 };
+	initialize_frame_pacer(&pacer, 60);
+	set_frame_pacer_clock(&pacer, fake_clock_now, fake_clock_sleep, &clock);
+	pacer.spin_threshold_ns = 0;
+
+	begin_paced_frame(&pacer);
+	start_ns = clock.now_ns;
+
+	for (i = 0; i < 600; i++) {
+		clock.now_ns += 5 * MS;
+		begin_paced_frame(&pacer);
+	}
+
+	percentiles = get_frame_time_percentiles(&(pacer.frame_times));
+	average_ms = (double)(clock.now_ns - start_ns) / 600.0 / (double)MS;
+
+	success = true;
+	success = check(clock.sleeps == 600, "should sleep every frame") && success;
+	success = check(near(average_ms, 16.667, 0.01), "average rate should be 60Hz") && success;
+	success = check(near(percentiles.p50_ms, 16.65, 0.1), "p50 should be 16.7ms") && success;
+	success = check(percentiles.p99_ms < 17.1, "p99 should be under 17.1ms") && success;
+	success = check(pacer.missed_deadlines == 0, "shouldn't miss any deadlines") && success;
+
+	printf("capped     %s: %s", success ? "ok" : "FAILED", get_frame_pacing_report(&pacer).c_str());
+
+	return success;
+}
+
+static bool run_spikes() {
+	frame_pacer pacer;
+	fake_clock clock;
+	frame_time_percentiles percentiles;
+	uint32_t i;
+	bool success;
+
+	clock = { 1 * MS, 0, 0 };
+	initialize_frame_pacer(&pacer, 60);
+	set_frame_pacer_clock(&pacer, fake_clock_now, fake_clock_sleep, &clock);
+	pacer.spin_threshold_ns = 0;
+
+	for (i = 0; i < 1000; i++) {
+		begin_paced_frame(&pacer);
+
+		// Every 10th frame takes 40ms instead of 5.
+		clock.now_ns += (i % 10 == 9) ? 40 * MS : 5 * MS;
+	}
+
+	begin_paced_frame(&pacer);
+
+	percentiles = get_frame_time_percentiles(&(pacer.frame_times));
+
+	success = true;
+	success = check(pacer.missed_deadlines == 100, "every spike should miss a deadline") && success;
+	success = check(percentiles.min_ms >= 16.6, "frames after a spike shouldn't bunch up") && success;
+	success = check(near(percentiles.p50_ms, 16.65, 0.1), "p50 should be 16.7ms") && success;
+	success = check(near(percentiles.p99_ms, 40.0, 0.1), "p99 should be the spikes") && success;
+
+	printf("spikes     %s: %s", success ? "ok" : "FAILED", get_frame_pacing_report(&pacer).c_str());
+
+	return success;
+}
+
+static bool run_histogram() {
+	frame_time_histogram histogram;
+	frame_time_percentiles percentiles;
+	uint32_t i;
+	bool success;
+
+	// 0.5ms, 1.5ms, ... 99.5ms, plus one frame off the end of the
+	// histogram.
+	for (i = 0; i < 100; i++) {
+		add_frame_time(&histogram, i * MS + MS / 2);
+	}
+
+	add_frame_time(&histogram, 250 * MS);
+
+	percentiles = get_frame_time_percentiles(&histogram);
+
+	success = true;
+	success = check(near(percentiles.p50_ms, 50.5, 0.1), "p50 should be 50.5ms") && success;
+	success = check(near(percentiles.p95_ms, 95.5, 0.1), "p95 should be 95.5ms") && success;
+	success = check(near(percentiles.p99_ms, 99.5, 0.1), "p99 should be 99.5ms") && success;
+	success = check(near(percentiles.max_ms, 250.0, 0.001), "max should be 250ms") && success;
+
+	printf("histogram  %s: p50 %.2fms, p95 %.2fms, p99 %.2fms, max %.2fms\n",
+		success ? "ok" : "FAILED",
+		percentiles.p50_ms,
+		percentiles.p95_ms,
+		percentiles.p99_ms,
+		percentiles.max_ms);
+
+	return success;
+}
+
+static uint64_t fake_clock_now(void* user_data) {
+	return ((fake_clock*)user_data)->now_ns;
+}
+
+static void fake_clock_sleep(const uint64_t duration_ns, void* user_data) {
+	fake_clock* clock;
+
+	clock = (fake_clock*)user_data;
+	clock->now_ns += duration_ns + clock->oversleep_ns;
+	clock->sleeps++;
+}
+
+static bool check(const bool condition, const char* message) {
+	if (!condition) {
+		printf("  FAIL: %s\n", message);
+	}
+
+	return condition;
+}
+
+static bool near(const double a, const double b, const double tolerance) {
+	return fabs(a - b) <= tolerance;
+}
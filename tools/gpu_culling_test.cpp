@@ -0,0 +1,591 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the frustum culling that writes the indirect draw commands,
+	using the CPU version of the culling shader (cull_objects), then
+	times it.
+
+	Checks:
+		planes      The planes of a DirectXMath style perspective
+		            camera are normalized, and points inside and outside
+		            each of them land on the right side.
+		visibility  Spheres inside, outside and straddling a plane,
+		            including ones moved off centre and scaled by the
+		            world matrix.
+		commands    Every visible object gets exactly one command, with
+		            its constants, material and draw, and the count is
+		            right. The 64 bit constants address carries into its
+		            high half.
+		overflow    Past max_commands, objects are still counted but
+		            nothing is written past the end of the buffer.
+		parallel    Culling on the job system, in whatever order the
+		            threads get to the counter (like the GPU), gives
+		            the same commands as one thread once both are put
+		            through sort_indirect_commands.
+
+	Benchmark:
+		A million objects scattered around the camera, culled on one
+		thread and then across the job system. Prints how many were
+		visible and the time for each.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		gpu_culling_test [--quick]
+*/
+
+#include "gpu_culling.h"
+#include "job_system.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const uint32_t BENCH_OBJECTS = 1 << 20;
+const uint32_t BENCH_RUNS = 5;
+// Where the test camera's constant buffer is, and each object's slice.
+const uint64_t TEST_CONSTANTS_ADDRESS = 0x0000000212340000ull;
+const uint32_t TEST_CONSTANT_STRIDE = 256;
+
+// What cull_job needs to cull a range of objects.
+struct cull_job_data {
+	const gpu_object* objects;
+	const culling_constants* constants;
+	indirect_command* commands;
+	atomic<uint32_t>* counter;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static void make_view_projection(float view_projection[16]);
+static void make_object(gpu_object* object, const float x, const float y, const float z, const float scale, const uint32_t i);
+static void make_scene(vector<gpu_object>* objects, const uint32_t count, const uint32_t seed);
+static void make_constants(culling_constants* constants, const uint32_t object_count, const uint32_t max_commands);
+static float plane_distance(const float plane[4], const float x, const float y, const float z);
+static bool is_inside(const float planes[FRUSTUM_PLANE_COUNT][4], const float x, const float y, const float z);
+static void cull_job(const uint32_t begin, const uint32_t end, void* data);
+static uint32_t cull_parallel(
+	job_system* system,
+	const vector<gpu_object>& objects,
+	const culling_constants* constants,
+	indirect_command* commands
+);
+
+static bool run_plane_check();
+static bool run_visibility_check();
+static bool run_command_check();
+static bool run_overflow_check();
+static bool run_parallel_check(job_system* system);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	vector<gpu_object> scene;
+	vector<indirect_command> commands;
+	culling_constants constants;
+	atomic<uint32_t> counter;
+	uint32_t cores;
+	uint32_t visible;
+	double start;
+	double serial_time;
+	double parallel_time;
+	double best;
+	bool quick;
+	bool success;
+	uint32_t run;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	system = new job_system;
+	initialize_job_system(system, cores < 4 ? 4 : cores, false);
+
+	success = true;
+	success = run_plane_check() && success;
+	success = run_visibility_check() && success;
+	success = run_command_check() && success;
+	success = run_overflow_check() && success;
+	success = run_parallel_check(system) && success;
+
+	shutdown_job_system(system);
+	delete system;
+
+	if (quick) {
+		printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+		return success ? 0 : 1;
+	}
+
+	//
+	// Benchmark.
+	//
+
+	make_scene(&scene, BENCH_OBJECTS, 1234);
+	make_constants(&constants, BENCH_OBJECTS, BENCH_OBJECTS);
+	commands.resize(BENCH_OBJECTS);
+
+	best = 1e9;
+	visible = 0;
+	for (run = 0; run < BENCH_RUNS; run++) {
+		counter = 0;
+		start = now_seconds();
+		cull_objects(scene.data(), &constants, 0, BENCH_OBJECTS, commands.data(), &counter);
+		best = min(best, now_seconds() - start);
+		visible = counter.load();
+	}
+	serial_time = best;
+
+	system = new job_system;
+	initialize_job_system(system, cores, true);
+
+	best = 1e9;
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+		cull_parallel(system, scene, &constants, commands.data());
+		best = min(best, now_seconds() - start);
+	}
+	parallel_time = best;
+
+	shutdown_job_system(system);
+	delete system;
+
+	printf("\n%u objects, %u visible (%.1f%%), %u cores\n",
+		BENCH_OBJECTS, visible, 100.0 * visible / BENCH_OBJECTS, cores);
+	printf("one thread  %7.2fms (%5.1fns an object)\n", serial_time * 1000.0, serial_time * 1e9 / BENCH_OBJECTS);
+	printf("job system  %7.2fms (%4.2fx)\n", parallel_time * 1000.0, serial_time / parallel_time);
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void make_view_projection(float view_projection[16]) {
+	float view[4][4];
+	float projection[4][4];
+	float y_scale;
+	float x_scale;
+	float near_z;
+	float far_z;
+	uint32_t row;
+	uint32_t column;
+	uint32_t k;
+
+	//
+	// The same camera as the application's: XMMatrixLookAtLH from
+	// (0, 0, -5) towards the origin, and XMMatrixPerspectiveFovLH with
+	// a 90 degree field of view, a square aspect and depths 0.1 to 100.
+	// Row vectors, so view * projection.
+	//
+
+	memset(view, 0, sizeof(view));
+	view[0][0] = 1.0f;
+	view[1][1] = 1.0f;
+	view[2][2] = 1.0f;
+	view[3][2] = 5.0f;
+	view[3][3] = 1.0f;
+
+	near_z = 0.1f;
+	far_z = 100.0f;
+	y_scale = 1.0f / tanf(0.25f * 3.14159265f);
+	x_scale = y_scale;
+
+	memset(projection, 0, sizeof(projection));
+	projection[0][0] = x_scale;
+	projection[1][1] = y_scale;
+	projection[2][2] = far_z / (far_z - near_z);
+	projection[2][3] = 1.0f;
+	projection[3][2] = -near_z * far_z / (far_z - near_z);
+
+	for (row = 0; row < 4; row++) {
+		for (column = 0; column < 4; column++) {
+			view_projection[row * 4 + column] = 0.0f;
+			for (k = 0; k < 4; k++) {
+				view_projection[row * 4 + column] += view[row][k] * projection[k][column];
+			}
+		}
+	}
+}
+
+static void make_object(gpu_object* object, const float x, const float y, const float z, const float scale, const uint32_t i) {
+	memset(object, 0, sizeof(gpu_object));
+
+	object->world[0][0] = scale;
+	object->world[1][1] = scale;
+	object->world[2][2] = scale;
+	object->world[3][0] = x;
+	object->world[3][1] = y;
+	object->world[3][2] = z;
+	object->world[3][3] = 1.0f;
+
+	object->bounds[3] = 1.7320508f;
+	object->index_count = 36 + (i % 7) * 3;
+	object->first_index = i % 5;
+	object->base_vertex = (int32_t)(i % 3) - 1;
+	object->material = i % 256;
+}
+
+static void make_scene(vector<gpu_object>* objects, const uint32_t count, const uint32_t seed) {
+	mt19937 random(seed);
+	uniform_real_distribution<float> position(-120.0f, 120.0f);
+	uniform_real_distribution<float> scale(0.25f, 4.0f);
+	uint32_t i;
+
+	objects->resize(count);
+
+	for (i = 0; i < count; i++) {
+		make_object(&((*objects)[i]), position(random), position(random), position(random), scale(random), i);
+	}
+}
+
+static void make_constants(culling_constants* constants, const uint32_t object_count, const uint32_t max_commands) {
+	float view_projection[16];
+
+	make_view_projection(view_projection);
+	extract_frustum_planes(view_projection, constants->planes);
+
+	constants->object_count = object_count;
+	constants->max_commands = max_commands;
+	constants->constants_address[0] = (uint32_t)(TEST_CONSTANTS_ADDRESS & 0xffffffff);
+	constants->constants_address[1] = (uint32_t)(TEST_CONSTANTS_ADDRESS >> 32);
+	constants->constant_stride = TEST_CONSTANT_STRIDE;
+}
+
+static float plane_distance(const float plane[4], const float x, const float y, const float z) {
+	return plane[0] * x + plane[1] * y + plane[2] * z + plane[3];
+}
+
+static bool is_inside(const float planes[FRUSTUM_PLANE_COUNT][4], const float x, const float y, const float z) {
+	uint32_t i;
+
+	for (i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+		if (plane_distance(planes[i], x, y, z) < 0.0f) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void cull_job(const uint32_t begin, const uint32_t end, void* data) {
+	cull_job_data* job;
+
+	job = (cull_job_data*)data;
+	cull_objects(job->objects, job->constants, begin, end, job->commands, job->counter);
+}
+
+static uint32_t cull_parallel(
+	job_system* system,
+	const vector<gpu_object>& objects,
+	const culling_constants* constants,
+	indirect_command* commands
+) {
+	cull_job_data job;
+	atomic<uint32_t> counter;
+
+	counter = 0;
+
+	job.objects = objects.data();
+	job.constants = constants;
+	job.commands = commands;
+	job.counter = &counter;
+
+	// A group's worth of objects at a time, like the shader's groups.
+	parallel_for(system, (uint32_t)objects.size(), CULLING_GROUP_SIZE, cull_job, &job);
+
+	return counter.load();
+}
+
+static bool run_plane_check() {
+	float view_projection[16];
+	float planes[FRUSTUM_PLANE_COUNT][4];
+	float length;
+	bool normalized;
+	bool success;
+	uint32_t i;
+
+	printf("planes\n");
+	success = true;
+
+	make_view_projection(view_projection);
+	extract_frustum_planes(view_projection, planes);
+
+	normalized = true;
+	for (i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+		length = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+		normalized = normalized && fabsf(length - 1.0f) < 1e-5f;
+	}
+	success = check(normalized, "planes are normalized") && success;
+
+	// The camera is at z = -5 looking down +z, with a 90 degree field
+	// of view, so at distance d the frustum is d wide either side.
+	success = check(is_inside(planes, 0.0f, 0.0f, 0.0f), "the origin is inside") && success;
+	success = check(is_inside(planes, 4.9f, -4.9f, 0.0f), "just inside the corner is inside") && success;
+	success = check(!is_inside(planes, -5.1f, 0.0f, 0.0f), "left of the frustum is outside") && success;
+	success = check(!is_inside(planes, 5.1f, 0.0f, 0.0f), "right of the frustum is outside") && success;
+	success = check(!is_inside(planes, 0.0f, -5.1f, 0.0f), "below the frustum is outside") && success;
+	success = check(!is_inside(planes, 0.0f, 5.1f, 0.0f), "above the frustum is outside") && success;
+	success = check(!is_inside(planes, 0.0f, 0.0f, -5.05f), "in front of the near plane is outside") && success;
+	success = check(is_inside(planes, 0.0f, 0.0f, -4.85f), "just past the near plane is inside") && success;
+	success = check(!is_inside(planes, 0.0f, 0.0f, 95.5f), "past the far plane is outside") && success;
+	success = check(is_inside(planes, 0.0f, 0.0f, 94.5f), "just before the far plane is inside") && success;
+
+	// Normalized, so the distance is in world units: the origin is 5
+	// units in front of the camera, so 4.9 past the near plane.
+	success = check(fabsf(plane_distance(planes[4], 0.0f, 0.0f, 0.0f) - 4.9f) < 1e-3f, "distances are in world units") && success;
+
+	return success;
+}
+
+static bool run_visibility_check() {
+	culling_constants constants;
+	gpu_object object;
+	bool success;
+
+	printf("visibility\n");
+	success = true;
+
+	make_constants(&constants, 1, 1);
+
+	// The right plane at z = 0 is x = 5, and leans out at 45 degrees,
+	// so a point's distance from it is (5 - x) / sqrt(2).
+	make_object(&object, 0.0f, 0.0f, 0.0f, 1.0f, 0);
+	success = check(is_object_visible(&object, constants.planes), "a sphere in the middle is visible") && success;
+
+	make_object(&object, 6.0f, 0.0f, 0.0f, 1.0f, 0);
+	success = check(is_object_visible(&object, constants.planes), "a sphere straddling a plane is visible") && success;
+
+	make_object(&object, 8.0f, 0.0f, 0.0f, 1.0f, 0);
+	success = check(!is_object_visible(&object, constants.planes), "a sphere past a plane is culled") && success;
+
+	make_object(&object, 8.0f, 0.0f, 0.0f, 3.0f, 0);
+	success = check(is_object_visible(&object, constants.planes), "scaling the world grows the sphere") && success;
+
+	make_object(&object, 8.0f, 0.0f, 0.0f, 1.0f, 0);
+	object.world[1][1] = 4.0f;
+	success = check(is_object_visible(&object, constants.planes), "the radius grows by the largest axis") && success;
+
+	make_object(&object, 8.0f, 0.0f, 0.0f, 1.0f, 0);
+	object.bounds[0] = -4.0f;
+	success = check(is_object_visible(&object, constants.planes), "an off centre sphere is moved by the world") && success;
+
+	make_object(&object, 8.0f, 0.0f, 0.0f, 2.0f, 0);
+	object.bounds[0] = 2.0f;
+	success = check(!is_object_visible(&object, constants.planes), "its offset is scaled too") && success;
+
+	make_object(&object, 0.0f, 0.0f, -8.0f, 1.0f, 0);
+	success = check(!is_object_visible(&object, constants.planes), "a sphere behind the camera is culled") && success;
+
+	return success;
+}
+
+static bool run_command_check() {
+	vector<gpu_object> objects;
+	vector<indirect_command> commands;
+	culling_constants constants;
+	const indirect_command* command;
+	const gpu_object* object;
+	atomic<uint32_t> counter;
+	uint32_t expected;
+	uint32_t next;
+	bool in_order;
+	bool contents_match;
+	bool success;
+	uint32_t i;
+
+	printf("commands\n");
+	success = true;
+
+	make_scene(&objects, 5000, 7);
+	make_constants(&constants, (uint32_t)objects.size(), (uint32_t)objects.size());
+	commands.resize(objects.size());
+
+	expected = 0;
+	for (i = 0; i < objects.size(); i++) {
+		if (is_object_visible(&(objects[i]), constants.planes)) {
+			expected++;
+		}
+	}
+
+	counter = 0;
+	cull_objects(objects.data(), &constants, 0, (uint32_t)objects.size(), commands.data(), &counter);
+
+	success = check(expected > 0 && expected < objects.size(), "some of the scene is visible and some isn't") && success;
+	success = check(counter.load() == expected, "the count is the number of visible objects") && success;
+
+	//
+	// On one thread the commands are in object order, so walk the
+	// objects alongside them.
+	//
+
+	in_order = true;
+	contents_match = true;
+	next = 0;
+
+	for (i = 0; i < objects.size() && next < counter.load(); i++) {
+		object = &(objects[i]);
+		if (!is_object_visible(object, constants.planes)) {
+			continue;
+		}
+
+		command = &(commands[next]);
+		next++;
+
+		in_order = in_order && command->constants_address == TEST_CONSTANTS_ADDRESS + (uint64_t)i * TEST_CONSTANT_STRIDE;
+		contents_match = contents_match &&
+			command->material == object->material &&
+			command->draw.index_count_per_instance == object->index_count &&
+			command->draw.instance_count == 1 &&
+			command->draw.start_index_location == object->first_index &&
+			command->draw.base_vertex_location == object->base_vertex &&
+			command->draw.start_instance_location == 0;
+	}
+
+	success = check(in_order, "one thread writes the commands in object order") && success;
+	success = check(contents_match, "each command draws its object with its material") && success;
+
+	//
+	// An address just under 4GB: the next object's is just over.
+	//
+
+	objects.resize(2);
+	make_object(&(objects[0]), 0.0f, 0.0f, 0.0f, 1.0f, 0);
+	make_object(&(objects[1]), 0.0f, 0.0f, 0.0f, 1.0f, 1);
+	make_constants(&constants, 2, 2);
+	constants.constants_address[0] = 0xffffff00;
+	constants.constants_address[1] = 0x2;
+
+	counter = 0;
+	cull_objects(objects.data(), &constants, 0, 2, commands.data(), &counter);
+	success = check(
+		counter.load() == 2 &&
+		commands[0].constants_address == 0x2ffffff00ull &&
+		commands[1].constants_address == 0x300000000ull,
+		"the constants address carries into its high half"
+	) && success;
+
+	//
+	// Threads past object_count do nothing.
+	//
+
+	make_constants(&constants, 1, 2);
+	counter = 0;
+	cull_objects(objects.data(), &constants, 0, 2, commands.data(), &counter);
+	success = check(counter.load() == 1, "objects past object_count are skipped") && success;
+
+	return success;
+}
+
+static bool run_overflow_check() {
+	vector<gpu_object> objects;
+	vector<indirect_command> commands;
+	culling_constants constants;
+	indirect_command sentinel;
+	atomic<uint32_t> counter;
+	bool untouched;
+	bool success;
+	uint32_t i;
+
+	printf("overflow\n");
+	success = true;
+
+	objects.resize(100);
+	for (i = 0; i < objects.size(); i++) {
+		make_object(&(objects[i]), 0.0f, 0.0f, (float)i * 0.1f, 1.0f, i);
+	}
+
+	make_constants(&constants, (uint32_t)objects.size(), 10);
+
+	memset(&sentinel, 0xcd, sizeof(sentinel));
+	commands.resize(objects.size(), sentinel);
+
+	counter = 0;
+	cull_objects(objects.data(), &constants, 0, (uint32_t)objects.size(), commands.data(), &counter);
+
+	untouched = true;
+	for (i = 10; i < commands.size(); i++) {
+		untouched = untouched && memcmp(&(commands[i]), &sentinel, sizeof(sentinel)) == 0;
+	}
+
+	success = check(counter.load() == 100, "the counter counts every visible object") && success;
+	success = check(commands[9].constants_address == TEST_CONSTANTS_ADDRESS + 9 * TEST_CONSTANT_STRIDE, "the buffer is filled") && success;
+	success = check(untouched, "nothing is written past max_commands") && success;
+
+	return success;
+}
+
+static bool run_parallel_check(job_system* system) {
+	const uint32_t sizes[] = { 0, 1, 63, 64, 65, 1000, 100003 };
+	vector<gpu_object> objects;
+	vector<indirect_command> serial;
+	vector<indirect_command> parallel;
+	culling_constants constants;
+	atomic<uint32_t> counter;
+	uint32_t serial_count;
+	uint32_t parallel_count;
+	bool counts_match;
+	bool commands_match;
+	bool overflow_matches;
+	size_t s;
+
+	printf("parallel\n");
+
+	counts_match = true;
+	commands_match = true;
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		make_scene(&objects, sizes[s], 100 + (uint32_t)s);
+		make_constants(&constants, sizes[s], sizes[s]);
+
+		serial.assign(sizes[s], indirect_command());
+		parallel.assign(sizes[s], indirect_command());
+
+		counter = 0;
+		cull_objects(objects.data(), &constants, 0, sizes[s], serial.data(), &counter);
+		serial_count = counter.load();
+
+		parallel_count = cull_parallel(system, objects, &constants, parallel.data());
+		sort_indirect_commands(parallel.data(), parallel_count, constants.max_commands);
+
+		counts_match = counts_match && serial_count == parallel_count;
+		commands_match = commands_match &&
+			(serial_count == 0 || memcmp(serial.data(), parallel.data(), serial_count * sizeof(indirect_command)) == 0);
+	}
+
+	check(counts_match, "the job system counts the same objects");
+	check(commands_match, "and, sorted, writes the same commands");
+
+	//
+	// When the buffer's too small, which objects make it in depends on
+	// the order, but how many doesn't.
+	//
+
+	make_scene(&objects, 100003, 5);
+	make_constants(&constants, 100003, 1000);
+	parallel.assign(100003, indirect_command());
+
+	counter = 0;
+	cull_objects(objects.data(), &constants, 0, 100003, parallel.data(), &counter);
+	serial_count = counter.load();
+
+	parallel_count = cull_parallel(system, objects, &constants, parallel.data());
+	overflow_matches = serial_count == parallel_count && serial_count > 1000;
+	check(overflow_matches, "an overflowing buffer still counts every object");
+
+	return counts_match && commands_match && overflow_matches;
+}
@@ -0,0 +1,717 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the I/O queue with each backend it has on Linux, then times
+	reading a file through it at different queue depths.
+
+	Checks (for io_uring, if it's there, and the thread pool):
+		reads       Random reads of a file, big and small, lined up
+		            and not, land where they were asked to and hold
+		            what the file does. So does a read of nothing.
+		threads     Batches submitted and waited on from eight threads
+		            at once all finish, with the right bytes.
+		polling     A render thread that each frame submits a batch
+		            into one of three staging slots, and copies out the
+		            batches it finds done without waiting for them,
+		            ends up with the whole file.
+		failures    Reads past the end of a file fail their batch, and
+		            so does a read of a file that was cut short after
+		            it was opened (which comes up short first, and is
+		            carried on with until it can't be). Good reads in
+		            the same batch still land.
+		depth       Never more than depth reads are in flight, and with
+		            plenty to do, more than one is.
+		shutdown    Shutting down with reads still queued finishes
+		            them first.
+
+	Benchmark:
+		Writes a 64MB file and reads all of it in random order, 64KB
+		and then 4KB at a time: with pread on one thread, then through
+		each backend at queue depths from 1 to 128, as one batch. The
+		file will be in the OS's file cache, so this is the cost of
+		getting reads to and from the kernel rather than of the disk.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		io_queue_bench [--quick]
+*/
+
+#include "io_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+const size_t CHECK_FILE_SIZE = 8 * 1024 * 1024 + 123;
+const uint32_t CHECK_THREADS = 8;
+const uint32_t CHECK_FRAMES_IN_FLIGHT = 3;
+const uint32_t CHECK_DEPTH = 16;
+const size_t BENCH_FILE_SIZE = 64 * 1024 * 1024;
+const uint32_t BENCH_RUNS = 3;
+
+struct submit_thread_data {
+	io_queue* queue;
+	const io_file* file;
+	const vector<uint8_t>* expected;
+	uint32_t seed;
+	bool success;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static uint8_t get_pattern(const uint64_t offset);
+static bool write_pattern_file(const string& path, const size_t size);
+static bool matches_pattern(const uint8_t* data, const uint64_t offset, const size_t size);
+static void run_submit_thread(submit_thread_data* data);
+
+static bool run_checks(const string& path, const bool use_threads);
+static bool run_read_check(io_queue* queue, const io_file* file);
+static bool run_thread_check(io_queue* queue, const io_file* file);
+static bool run_polling_check(io_queue* queue, const io_file* file);
+static bool run_failure_check(io_queue* queue, const io_file* file, const string& path);
+static bool run_depth_check(io_queue* queue, const io_file* file);
+static bool run_shutdown_check(const string& path, const bool use_threads);
+static void run_benchmark(const string& directory);
+static double time_queue(
+	const io_file* file,
+	const vector<uint64_t>& offsets,
+	const uint32_t size,
+	const uint32_t depth,
+	const bool use_threads,
+	uint8_t* destination,
+	io_queue_stats* stats
+);
+
+int main(int argc, char** argv) {
+	io_queue* probe;
+	string directory;
+	string path;
+	bool has_io_uring;
+	bool quick;
+	bool success;
+	error_code err;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	directory = (fs::temp_directory_path() / ("io_queue_bench_" + to_string((unsigned long long)now_seconds()))).string();
+	fs::create_directories(directory, err);
+
+	path = directory + "/pattern.bin";
+	if (!write_pattern_file(path, CHECK_FILE_SIZE)) {
+		printf("Couldn't write %s\n", path.c_str());
+		return 1;
+	}
+
+	probe = new io_queue;
+	initialize_io_queue(probe, CHECK_DEPTH, false);
+	has_io_uring = probe->backend == IO_BACKEND_IO_URING;
+	shutdown_io_queue(probe);
+	delete probe;
+
+	success = true;
+
+	if (has_io_uring) {
+		success = run_checks(path, false) && success;
+	} else {
+		printf("io_uring isn't available here, so only the thread pool is checked\n\n");
+	}
+
+	success = run_checks(path, true) && success;
+
+	if (!quick) {
+		run_benchmark(directory);
+	}
+
+	fs::remove_all(directory, err);
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint8_t get_pattern(const uint64_t offset) {
+	// Different at every offset near each other, and not a power of two
+	// long, so a read from the wrong place shows up.
+	return (uint8_t)((offset * 131) ^ (offset >> 9) ^ (offset >> 17));
+}
+
+static bool write_pattern_file(const string& path, const size_t size) {
+	vector<uint8_t> data;
+	ofstream file;
+	size_t i;
+
+	data.resize(size);
+	for (i = 0; i < size; i++) {
+		data[i] = get_pattern(i);
+	}
+
+	file.open(path, ios::binary | ios::trunc);
+	file.write((const char*)data.data(), (streamsize)data.size());
+
+	return file.good();
+}
+
+static bool matches_pattern(const uint8_t* data, const uint64_t offset, const size_t size) {
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		if (data[i] != get_pattern(offset + i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void run_submit_thread(submit_thread_data* data) {
+	mt19937 random(data->seed);
+	uniform_int_distribution<uint32_t> size_range(1, 64 * 1024);
+	vector<io_request> requests;
+	vector<vector<uint8_t>> buffers;
+	io_batch batch;
+	uint32_t round;
+	uint32_t i;
+
+	data->success = true;
+	requests.resize(16);
+	buffers.resize(16);
+
+	for (round = 0; round < 40; round++) {
+		batch.pending = 0;
+		batch.failures = 0;
+
+		for (i = 0; i < requests.size(); i++) {
+			requests[i].file = data->file;
+			requests[i].size = size_range(random);
+			requests[i].offset = random() % (data->file->size - requests[i].size);
+			buffers[i].assign(requests[i].size, 0);
+			requests[i].destination = buffers[i].data();
+		}
+
+		submit_io_batch(data->queue, &batch, requests.data(), (uint32_t)requests.size());
+
+		if (!wait_for_io_batch(data->queue, &batch)) {
+			data->success = false;
+		}
+
+		for (i = 0; i < requests.size(); i++) {
+			if (memcmp(buffers[i].data(), data->expected->data() + requests[i].offset, requests[i].size) != 0) {
+				data->success = false;
+			}
+		}
+	}
+}
+
+static bool run_checks(const string& path, const bool use_threads) {
+	io_queue* queue;
+	io_file file;
+	io_file missing;
+	bool success;
+
+	queue = new io_queue;
+	initialize_io_queue(queue, CHECK_DEPTH, use_threads);
+
+	printf("== %s ==\n", get_io_backend_name(queue->backend));
+
+	success = check(open_io_file(queue, &file, path), "the file opens");
+	success = check(file.size == CHECK_FILE_SIZE, "with the right size") && success;
+	success = check(!open_io_file(queue, &missing, path + ".missing") && missing.size == 0, "a missing one doesn't") && success;
+
+	success = run_read_check(queue, &file) && success;
+	success = run_thread_check(queue, &file) && success;
+	success = run_polling_check(queue, &file) && success;
+	success = run_failure_check(queue, &file, path) && success;
+	success = run_depth_check(queue, &file) && success;
+
+	printf("%s", get_io_queue_report(queue).c_str());
+
+	close_io_file(&file);
+	shutdown_io_queue(queue);
+	delete queue;
+
+	success = run_shutdown_check(path, use_threads) && success;
+	printf("\n");
+
+	return success;
+}
+
+static bool run_read_check(io_queue* queue, const io_file* file) {
+	mt19937 random(1);
+	uniform_int_distribution<uint32_t> size_range(1, 256 * 1024);
+	vector<io_request> requests;
+	vector<uint8_t> staging;
+	io_batch batch;
+	uint64_t staging_size;
+	bool right;
+	bool success;
+	size_t i;
+
+	printf("reads\n");
+
+	//
+	// Like a staging buffer: everything goes into one block, one after
+	// the other. Every fourth read is 4KB aligned in the file, and the
+	// last is for nothing at all.
+	//
+
+	requests.resize(200);
+	staging_size = 0;
+
+	for (i = 0; i < requests.size(); i++) {
+		requests[i].file = file;
+		requests[i].size = i + 1 == requests.size() ? 0 : size_range(random);
+		requests[i].offset = random() % (file->size - requests[i].size);
+
+		if (i % 4 == 0) {
+			requests[i].offset &= ~(uint64_t)4095;
+		}
+
+		requests[i].destination = (void*)(uintptr_t)staging_size;
+		staging_size += requests[i].size;
+	}
+
+	// One byte more, to check nothing writes past the end.
+	staging.assign((size_t)staging_size + 1, 0xcd);
+
+	for (i = 0; i < requests.size(); i++) {
+		requests[i].destination = staging.data() + (uintptr_t)requests[i].destination;
+	}
+
+	submit_io_batch(queue, &batch, requests.data(), (uint32_t)requests.size());
+	success = check(wait_for_io_batch(queue, &batch), "200 random reads succeed");
+	success = check(is_io_batch_done(&batch) && batch.failures == 0, "and the batch says it's done") && success;
+
+	right = true;
+	for (i = 0; i < requests.size(); i++) {
+		right = right &&
+			matches_pattern((const uint8_t*)requests[i].destination, requests[i].offset, requests[i].size) &&
+			requests[i].done == requests[i].size;
+	}
+
+	success = check(right, "each one holds what the file does") && success;
+	success = check(staging.back() == 0xcd, "and nothing's written past the end") && success;
+
+	// A batch with nothing in it is done already.
+	batch.failures = 0;
+	submit_io_batch(queue, &batch, NULL, 0);
+	success = check(is_io_batch_done(&batch) && wait_for_io_batch(queue, &batch), "an empty batch is done") && success;
+
+	return success;
+}
+
+static bool run_thread_check(io_queue* queue, const io_file* file) {
+	submit_thread_data data[CHECK_THREADS];
+	thread threads[CHECK_THREADS];
+	vector<uint8_t> expected;
+	bool success;
+	uint32_t i;
+
+	printf("threads\n");
+
+	expected.resize((size_t)file->size);
+	for (i = 0; i < expected.size(); i++) {
+		expected[i] = get_pattern(i);
+	}
+
+	for (i = 0; i < CHECK_THREADS; i++) {
+		data[i].queue = queue;
+		data[i].file = file;
+		data[i].expected = &expected;
+		data[i].seed = 100 + i;
+		threads[i] = thread(run_submit_thread, &data[i]);
+	}
+
+	success = true;
+	for (i = 0; i < CHECK_THREADS; i++) {
+		threads[i].join();
+		success = success && data[i].success;
+	}
+
+	return check(success, "8 threads, 40 batches of 16 each, all read right");
+}
+
+static bool run_polling_check(io_queue* queue, const io_file* file) {
+	const uint32_t read_size = 48 * 1024 + 7;
+	const uint32_t reads_per_frame = 4;
+	io_batch batches[CHECK_FRAMES_IN_FLIGHT];
+	io_request requests[CHECK_FRAMES_IN_FLIGHT][reads_per_frame];
+	vector<uint8_t> staging;
+	vector<uint8_t> gpu;
+	uint64_t next_offset;
+	uint32_t busy[CHECK_FRAMES_IN_FLIGHT];
+	uint32_t frame;
+	uint32_t slot;
+	uint32_t frames_waiting;
+	uint32_t copies;
+	uint32_t i;
+	bool success;
+
+	printf("polling\n");
+
+	//
+	// Each frame, the slot for this frame is checked. If its batch is
+	// done, it's "copied to the GPU" (into gpu, at the offsets read) and
+	// the slot is reused for the next few reads of the file. A slot
+	// that's still busy is left for a later frame, never waited on.
+	//
+
+	staging.resize((size_t)CHECK_FRAMES_IN_FLIGHT * reads_per_frame * read_size);
+	gpu.assign((size_t)file->size, 0);
+	memset(busy, 0, sizeof(busy));
+	next_offset = 0;
+	frames_waiting = 0;
+	copies = 0;
+
+	for (frame = 0; next_offset < file->size || busy[0] || busy[1] || busy[2]; frame++) {
+		slot = frame % CHECK_FRAMES_IN_FLIGHT;
+
+		if (busy[slot]) {
+			if (!is_io_batch_done(&batches[slot])) {
+				frames_waiting++;
+				this_thread::yield();
+				continue;
+			}
+
+			for (i = 0; i < busy[slot]; i++) {
+				memcpy(gpu.data() + requests[slot][i].offset, requests[slot][i].destination, requests[slot][i].size);
+			}
+
+			copies++;
+			busy[slot] = 0;
+		}
+
+		if (next_offset >= file->size) {
+			continue;
+		}
+
+		batches[slot].failures = 0;
+
+		for (i = 0; i < reads_per_frame && next_offset < file->size; i++) {
+			requests[slot][i].file = file;
+			requests[slot][i].offset = next_offset;
+			requests[slot][i].size = (uint32_t)min((uint64_t)read_size, file->size - next_offset);
+			requests[slot][i].destination = staging.data() + ((size_t)slot * reads_per_frame + i) * read_size;
+			next_offset += requests[slot][i].size;
+		}
+
+		busy[slot] = i;
+		submit_io_batch(queue, &batches[slot], requests[slot], busy[slot]);
+	}
+
+	success = check(matches_pattern(gpu.data(), 0, gpu.size()), "the whole file arrives through three staging slots");
+	printf("  %u frames, %u copies, %u frames found their slot still busy\n", frame, copies, frames_waiting);
+
+	return success;
+}
+
+static bool run_failure_check(io_queue* queue, const io_file* file, const string& path) {
+	io_request requests[3];
+	uint8_t buffers[3][4096];
+	vector<uint8_t> big;
+	io_file short_file;
+	io_batch batch;
+	string short_path;
+	bool success;
+	error_code err;
+
+	printf("failures\n");
+
+	requests[0].file = file;
+	requests[0].offset = 0;
+	requests[0].size = sizeof(buffers[0]);
+	requests[0].destination = buffers[0];
+
+	// One byte past the end.
+	requests[1].file = file;
+	requests[1].offset = file->size - sizeof(buffers[1]) + 1;
+	requests[1].size = sizeof(buffers[1]);
+	requests[1].destination = buffers[1];
+
+	// Nowhere near it.
+	requests[2].file = file;
+	requests[2].offset = file->size * 4;
+	requests[2].size = sizeof(buffers[2]);
+	requests[2].destination = buffers[2];
+
+	submit_io_batch(queue, &batch, requests, 3);
+	success = check(!wait_for_io_batch(queue, &batch) && batch.failures == 2, "reads past the end fail their batch");
+	success = check(matches_pattern(buffers[0], 0, sizeof(buffers[0])), "and a good one with them still lands") && success;
+
+	//
+	// A file that's shorter than it was when it was opened. The read
+	// gets what's there, then nothing.
+	//
+
+	short_path = path + ".short";
+	fs::copy_file(path, short_path, fs::copy_options::overwrite_existing, err);
+	open_io_file(queue, &short_file, short_path);
+	fs::resize_file(short_path, 1024 * 1024 + 5, err);
+
+	big.assign(2 * 1024 * 1024, 0);
+	requests[0].file = &short_file;
+	requests[0].offset = 3;
+	requests[0].size = (uint32_t)big.size();
+	requests[0].destination = big.data();
+
+	batch.failures = 0;
+	submit_io_batch(queue, &batch, requests, 1);
+	success = check(!wait_for_io_batch(queue, &batch), "a file cut short after opening fails") && success;
+	success = check(
+		requests[0].done == 1024 * 1024 + 2 && matches_pattern(big.data(), 3, requests[0].done),
+		"after reading up to where it ends"
+	) && success;
+
+	close_io_file(&short_file);
+	fs::remove(short_path, err);
+
+	return success;
+}
+
+static bool run_depth_check(io_queue* queue, const io_file* file) {
+	vector<io_request> requests;
+	vector<uint8_t> staging;
+	io_queue_stats stats;
+	io_batch batch;
+	uint32_t i;
+	bool success;
+
+	printf("depth\n");
+
+	requests.resize(CHECK_DEPTH * 16);
+	staging.resize(requests.size() * 4096);
+
+	for (i = 0; i < requests.size(); i++) {
+		requests[i].file = file;
+		requests[i].offset = ((uint64_t)i * 7919 * 4096) % (file->size - 4096);
+		requests[i].size = 4096;
+		requests[i].destination = staging.data() + (size_t)i * 4096;
+	}
+
+	submit_io_batch(queue, &batch, requests.data(), (uint32_t)requests.size());
+	success = check(wait_for_io_batch(queue, &batch), "256 reads at once succeed");
+
+	stats = get_io_queue_stats(queue);
+	success = check(stats.most_in_flight <= CHECK_DEPTH, "never more than 16 in flight") && success;
+	success = check(stats.most_in_flight > 1, "but more than one") && success;
+
+	return success;
+}
+
+static bool run_shutdown_check(const string& path, const bool use_threads) {
+	vector<io_request> requests;
+	vector<uint8_t> staging;
+	io_queue* queue;
+	io_file file;
+	io_batch batch;
+	uint32_t i;
+	bool right;
+	bool success;
+
+	printf("shutdown\n");
+
+	queue = new io_queue;
+	initialize_io_queue(queue, 4, use_threads);
+	open_io_file(queue, &file, path);
+
+	requests.resize(512);
+	staging.resize(requests.size() * 8192);
+
+	for (i = 0; i < requests.size(); i++) {
+		requests[i].file = &file;
+		requests[i].offset = (uint64_t)i * 8192;
+		requests[i].size = 8192;
+		requests[i].destination = staging.data() + (size_t)i * 8192;
+	}
+
+	submit_io_batch(queue, &batch, requests.data(), (uint32_t)requests.size());
+	shutdown_io_queue(queue);
+
+	success = check(is_io_batch_done(&batch) && batch.failures == 0, "shutting down finishes what's queued");
+
+	right = true;
+	for (i = 0; i < requests.size(); i++) {
+		right = right && matches_pattern(staging.data() + (size_t)i * 8192, requests[i].offset, 8192);
+	}
+
+	success = check(right, "and it's all there") && success;
+
+	close_io_file(&file);
+	delete queue;
+
+	return success;
+}
+
+static void run_benchmark(const string& directory) {
+	const uint32_t sizes[] = {64 * 1024, 4 * 1024};
+	const uint32_t depths[] = {1, 2, 4, 8, 16, 32, 64, 128};
+	mt19937 random(7);
+	vector<uint64_t> offsets;
+	vector<uint8_t> destination;
+	io_queue_stats stats;
+	io_file file;
+	io_queue* probe;
+	string path;
+	uint32_t size;
+	uint32_t count;
+	uint32_t run;
+	uint32_t backend;
+	uint32_t s;
+	uint32_t d;
+	uint32_t i;
+	int file_descriptor;
+	double start;
+	double pread_time;
+	double queue_time;
+	bool has_io_uring;
+	error_code err;
+
+	path = directory + "/bench.bin";
+	printf("Writing a %uMB file...\n", (uint32_t)(BENCH_FILE_SIZE / (1024 * 1024)));
+	write_pattern_file(path, BENCH_FILE_SIZE);
+
+	probe = new io_queue;
+	initialize_io_queue(probe, 1, false);
+	has_io_uring = probe->backend == IO_BACKEND_IO_URING;
+	open_io_file(probe, &file, path);
+	shutdown_io_queue(probe);
+	delete probe;
+
+	destination.resize(BENCH_FILE_SIZE);
+	file_descriptor = open(path.c_str(), O_RDONLY);
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		size = sizes[s];
+		count = (uint32_t)(BENCH_FILE_SIZE / size);
+
+		// Every block of the file once, in random order.
+		offsets.resize(count);
+		for (i = 0; i < count; i++) {
+			offsets[i] = (uint64_t)i * size;
+		}
+
+		shuffle(offsets.begin(), offsets.end(), random);
+
+		//
+		// pread on one thread, which is what the queue is up against.
+		//
+
+		pread_time = 1e9;
+
+		for (run = 0; run < BENCH_RUNS; run++) {
+			start = now_seconds();
+
+			for (i = 0; i < count; i++) {
+				if (pread(file_descriptor, destination.data() + offsets[i], size, (off_t)offsets[i]) != (ssize_t)size) {
+					printf("pread failed\n");
+				}
+			}
+
+			pread_time = min(pread_time, now_seconds() - start);
+		}
+
+		printf("\n%u reads of %uKB:\n", count, size / 1024);
+		printf(
+			"  %-12s          %8.2fms  %8.0fMB/s\n",
+			"pread",
+			pread_time * 1000.0,
+			BENCH_FILE_SIZE / (1024.0 * 1024.0) / pread_time
+		);
+
+		for (backend = has_io_uring ? 0 : 1; backend < 2; backend++) {
+			for (d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+				queue_time = time_queue(&file, offsets, size, depths[d], backend == 1, destination.data(), &stats);
+
+				printf(
+					"  %-12s depth %3u %8.2fms  %8.0fMB/s  %5.2fx  %.2f calls a read, %u in flight at most\n",
+					backend == 1 ? "thread pool" : "io_uring",
+					depths[d],
+					queue_time * 1000.0,
+					BENCH_FILE_SIZE / (1024.0 * 1024.0) / queue_time,
+					pread_time / queue_time,
+					(double)stats.system_calls / stats.requests,
+					stats.most_in_flight
+				);
+			}
+		}
+	}
+
+	if (!matches_pattern(destination.data(), 0, destination.size())) {
+		printf("The benchmark read the wrong bytes!\n");
+	}
+
+	close(file_descriptor);
+	close_io_file(&file);
+	fs::remove(path, err);
+	printf("\n");
+}
+
+static double time_queue(
+	const io_file* file,
+	const vector<uint64_t>& offsets,
+	const uint32_t size,
+	const uint32_t depth,
+	const bool use_threads,
+	uint8_t* destination,
+	io_queue_stats* stats
+) {
+	vector<io_request> requests;
+	io_queue* queue;
+	io_batch batch;
+	uint32_t run;
+	size_t i;
+	double start;
+	double best;
+
+	queue = new io_queue;
+	initialize_io_queue(queue, depth, use_threads);
+
+	requests.resize(offsets.size());
+	best = 1e9;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		for (i = 0; i < offsets.size(); i++) {
+			requests[i].file = file;
+			requests[i].offset = offsets[i];
+			requests[i].size = size;
+			requests[i].destination = destination + offsets[i];
+		}
+
+		batch.failures = 0;
+
+		start = now_seconds();
+		submit_io_batch(queue, &batch, requests.data(), (uint32_t)requests.size());
+		wait_for_io_batch(queue, &batch);
+		best = min(best, now_seconds() - start);
+	}
+
+	*stats = get_io_queue_stats(queue);
+
+	shutdown_io_queue(queue);
+	delete queue;
+
+	return best;
+}
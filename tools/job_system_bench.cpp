@@ -0,0 +1,526 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the job system, then measures how it scales.
+
+	Checks:
+		batch          Lots of small jobs against one counter.
+		dependencies   Three batches chained with run_jobs_after. No job
+		               may start before the batch it depends on is done.
+		parallel for   Every index is visited exactly once, for a range
+		               of sizes and grains.
+		nested         Jobs that start jobs and wait on them (fib).
+		outside        A thread that isn't a worker running jobs and a
+		               parallel_for while the workers are busy.
+
+	Benchmarks, each with 1, 2, 4... workers up to one per core:
+		fib            fib(n) with a job per call above a cutoff.
+		parallel for   A few million square roots.
+		fan out        One job starting a thousand, then waiting on
+		               them, over and over.
+
+	Build with SANITIZE=thread (see build_tools.sh) to run the checks
+	under ThreadSanitizer. Pass --quick to skip the benchmarks, which
+	are slow under it.
+
+	Usage:
+		job_system_bench [--quick]
+*/
+
+#include "job_system.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const uint32_t FIB_CUTOFF = 12;
+
+struct fib_job {
+	job_system* system;
+	uint32_t n;
+	uint64_t result;
+};
+
+struct stage_data {
+	atomic<uint32_t>* previous_done;
+	atomic<uint32_t>* done;
+	uint32_t previous_count;
+	atomic<uint32_t>* early;
+};
+
+struct visit_data {
+	vector<atomic<uint32_t>>* visits;
+};
+
+struct sqrt_data {
+	const float* input;
+	float* output;
+};
+
+struct fan_out_data {
+	job_system* system;
+	atomic<uint64_t>* total;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+
+static uint64_t fib_serial(const uint32_t n);
+static void fib_job_fn(void* data);
+static void count_job_fn(void* data);
+static void stage_job_fn(void* data);
+static void visit_range(const uint32_t begin, const uint32_t end, void* data);
+static void sqrt_range(const uint32_t begin, const uint32_t end, void* data);
+static void fan_out_leaf(void* data);
+
+static bool run_batch_check(job_system* system);
+static bool run_dependency_check(job_system* system);
+static bool run_parallel_for_check(job_system* system);
+static bool run_nested_check(job_system* system);
+static bool run_outside_check(job_system* system);
+
+static double run_fib_bench(job_system* system, const uint32_t n);
+static double run_parallel_for_bench(job_system* system, const vector<float>& input, vector<float>* output);
+static double run_fan_out_bench(job_system* system);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	vector<float> input;
+	vector<float> output;
+	uint32_t cores;
+	uint32_t workers;
+	double fib_1;
+	double for_1;
+	double fan_1;
+	double fib_time;
+	double for_time;
+	double fan_time;
+	bool quick;
+	bool success;
+	uint32_t i;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	//
+	// Checks, with at least four workers even on a small machine, so
+	// there's some stealing going on.
+	//
+
+	system = new job_system;
+	initialize_job_system(system, cores < 4 ? 4 : cores, false);
+
+	success = true;
+	success = run_batch_check(system) && success;
+	success = run_dependency_check(system) && success;
+	success = run_parallel_for_check(system) && success;
+	success = run_nested_check(system) && success;
+	success = run_outside_check(system) && success;
+
+	printf("%s", get_job_system_report(system).c_str());
+
+	shutdown_job_system(system);
+	delete system;
+
+	if (quick) {
+		printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+		return success ? 0 : 1;
+	}
+
+	//
+	// Benchmarks.
+	//
+
+	input.resize(4 << 20);
+	output.resize(input.size());
+	for (i = 0; i < input.size(); i++) {
+		input[i] = (float)i;
+	}
+
+	printf("\n%u cores\n", cores);
+	printf("workers        fib(32)          parallel for        fan out\n");
+
+	fib_1 = 0.0;
+	for_1 = 0.0;
+	fan_1 = 0.0;
+
+	for (workers = 1; ; workers *= 2) {
+		if (workers > cores) {
+			workers = cores;
+		}
+
+		system = new job_system;
+		initialize_job_system(system, workers, true);
+
+		fib_time = run_fib_bench(system, 32);
+		for_time = run_parallel_for_bench(system, input, &output);
+		fan_time = run_fan_out_bench(system);
+
+		if (workers == 1) {
+			fib_1 = fib_time;
+			for_1 = for_time;
+			fan_1 = fan_time;
+		}
+
+		printf("%7u  %7.1fms (%4.2fx)  %7.1fms (%4.2fx)  %7.1fms (%4.2fx)\n",
+			workers,
+			fib_time * 1000.0, fib_1 / fib_time,
+			for_time * 1000.0, for_1 / for_time,
+			fan_time * 1000.0, fan_1 / fan_time
+		);
+
+		shutdown_job_system(system);
+		delete system;
+
+		if (workers == cores) {
+			break;
+		}
+	}
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	if (!condition) {
+		printf("  FAILED: %s\n", message);
+	}
+
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t fib_serial(const uint32_t n) {
+	if (n < 2) {
+		return n;
+	}
+
+	return fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static void fib_job_fn(void* data) {
+	fib_job* fib;
+	fib_job children[2];
+	job_decl decls[2];
+	job_counter counter;
+
+	fib = (fib_job*)data;
+
+	if (fib->n < FIB_CUTOFF) {
+		fib->result = fib_serial(fib->n);
+		return;
+	}
+
+	children[0] = { fib->system, fib->n - 1, 0 };
+	children[1] = { fib->system, fib->n - 2, 0 };
+	decls[0] = { fib_job_fn, &(children[0]) };
+	decls[1] = { fib_job_fn, &(children[1]) };
+
+	run_jobs(fib->system, decls, 2, &counter);
+	wait_for_counter(fib->system, &counter);
+
+	fib->result = children[0].result + children[1].result;
+}
+
+static void count_job_fn(void* data) {
+	((atomic<uint32_t>*)data)->fetch_add(1, memory_order_relaxed);
+}
+
+static void stage_job_fn(void* data) {
+	stage_data* stage;
+
+	stage = (stage_data*)data;
+
+	if (!stage->previous_done) {
+		this_thread::sleep_for(chrono::microseconds(50));
+	}
+
+	if (stage->previous_done &&
+		stage->previous_done->load(memory_order_acquire) != stage->previous_count) {
+		stage->early->fetch_add(1, memory_order_relaxed);
+	}
+
+	stage->done->fetch_add(1, memory_order_acq_rel);
+}
+
+static void visit_range(const uint32_t begin, const uint32_t end, void* data) {
+	visit_data* visit;
+	uint32_t i;
+
+	visit = (visit_data*)data;
+
+	for (i = begin; i < end; i++) {
+		(*visit->visits)[i].fetch_add(1, memory_order_relaxed);
+	}
+}
+
+static void sqrt_range(const uint32_t begin, const uint32_t end, void* data) {
+	sqrt_data* sqrts;
+	uint32_t i;
+
+	sqrts = (sqrt_data*)data;
+
+	for (i = begin; i < end; i++) {
+		sqrts->output[i] = sqrtf(sqrts->input[i]) * 0.5f + sinf(sqrts->input[i]);
+	}
+}
+
+static void fan_out_leaf(void* data) {
+	((fan_out_data*)data)->total->fetch_add(1, memory_order_relaxed);
+}
+
+static bool run_batch_check(job_system* system) {
+	atomic<uint32_t> count;
+	vector<job_decl> decls;
+	job_counter counter;
+	uint32_t round;
+	uint32_t i;
+	bool success;
+
+	count = 0;
+	decls.resize(10000);
+	for (i = 0; i < decls.size(); i++) {
+		decls[i] = { count_job_fn, &count };
+	}
+
+	// More rounds than there are slots in the job pools, so they wrap.
+	for (round = 0; round < 10; round++) {
+		run_jobs(system, decls.data(), (uint32_t)decls.size(), &counter);
+		wait_for_counter(system, &counter);
+	}
+
+	success = check(count.load() == 10 * decls.size(), "not every job ran once");
+
+	printf("batch          %s: %u jobs\n", success ? "ok" : "FAILED", count.load());
+
+	return success;
+}
+
+static bool run_dependency_check(job_system* system) {
+	const uint32_t jobs_per_stage = 200;
+	atomic<uint32_t> done[3];
+	atomic<uint32_t> early;
+	vector<stage_data> stages[3];
+	vector<job_decl> decls[3];
+	job_counter counters[3];
+	uint32_t s;
+	uint32_t i;
+	bool success;
+
+	early = 0;
+
+	for (s = 0; s < 3; s++) {
+		done[s] = 0;
+		stages[s].resize(jobs_per_stage);
+		decls[s].resize(jobs_per_stage);
+
+		for (i = 0; i < jobs_per_stage; i++) {
+			stages[s][i].previous_done = s > 0 ? &(done[s - 1]) : NULL;
+			stages[s][i].done = &(done[s]);
+			stages[s][i].previous_count = jobs_per_stage;
+			stages[s][i].early = &early;
+			decls[s][i] = { stage_job_fn, &(stages[s][i]) };
+		}
+	}
+
+	//
+	// The first stage's jobs take a little while, so the later stages
+	// are almost always set up before it finishes, and really do wait.
+	//
+
+	run_jobs(system, decls[0].data(), jobs_per_stage, &(counters[0]));
+	run_jobs_after(system, &(counters[0]), decls[1].data(), jobs_per_stage, &(counters[1]));
+	run_jobs_after(system, &(counters[1]), decls[2].data(), jobs_per_stage, &(counters[2]));
+
+	wait_for_counter(system, &(counters[0]));
+	wait_for_counter(system, &(counters[1]));
+	wait_for_counter(system, &(counters[2]));
+
+	success = true;
+	success = check(done[2].load() == jobs_per_stage, "last stage didn't finish") && success;
+	success = check(early.load() == 0, "a job started before its dependency finished") && success;
+
+	printf("dependencies   %s: 3 stages of %u jobs\n", success ? "ok" : "FAILED", jobs_per_stage);
+
+	return success;
+}
+
+static bool run_parallel_for_check(job_system* system) {
+	const uint32_t sizes[] = { 1, 7, 1000, 65537, 1000000 };
+	const uint32_t grains[] = { 0, 1, 64, 100000 };
+	vector<atomic<uint32_t>> visits;
+	visit_data visit;
+	uint32_t s;
+	uint32_t g;
+	uint32_t i;
+	uint32_t wrong;
+	bool success;
+
+	visit.visits = &visits;
+	wrong = 0;
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		for (g = 0; g < sizeof(grains) / sizeof(grains[0]); g++) {
+			visits = vector<atomic<uint32_t>>(sizes[s]);
+			for (i = 0; i < sizes[s]; i++) {
+				visits[i].store(0);
+			}
+
+			parallel_for(system, sizes[s], grains[g], visit_range, &visit);
+
+			for (i = 0; i < sizes[s]; i++) {
+				if (visits[i].load() != 1) {
+					wrong++;
+				}
+			}
+		}
+	}
+
+	success = check(wrong == 0, "an index wasn't visited exactly once");
+
+	printf("parallel for   %s: %u wrong visits\n", success ? "ok" : "FAILED", wrong);
+
+	return success;
+}
+
+static bool run_nested_check(job_system* system) {
+	fib_job fib;
+	job_decl decl;
+	job_counter counter;
+	bool success;
+
+	fib = { system, 25, 0 };
+	decl = { fib_job_fn, &fib };
+
+	run_jobs(system, &decl, 1, &counter);
+	wait_for_counter(system, &counter);
+
+	success = check(fib.result == fib_serial(25), "fib(25) is wrong");
+
+	printf("nested         %s: fib(25) = %llu\n", success ? "ok" : "FAILED", (unsigned long long)fib.result);
+
+	return success;
+}
+
+static bool run_outside_check(job_system* system) {
+	fib_job fib;
+	job_decl decl;
+	job_counter counter;
+	vector<atomic<uint32_t>> visits;
+	visit_data visit;
+	thread outsider;
+	uint32_t wrong;
+	uint32_t i;
+	bool success;
+
+	//
+	// Keep the workers busy from here, while another thread that isn't
+	// a worker uses the job system at the same time.
+	//
+
+	fib = { system, 24, 0 };
+	decl = { fib_job_fn, &fib };
+	run_jobs(system, &decl, 1, &counter);
+
+	visits = vector<atomic<uint32_t>>(100000);
+	for (i = 0; i < visits.size(); i++) {
+		visits[i].store(0);
+	}
+	visit.visits = &visits;
+
+	outsider = thread([system, &visit]() {
+		parallel_for(system, (uint32_t)visit.visits->size(), 0, visit_range, &visit);
+	});
+
+	outsider.join();
+	wait_for_counter(system, &counter);
+
+	wrong = 0;
+	for (i = 0; i < visits.size(); i++) {
+		if (visits[i].load() != 1) {
+			wrong++;
+		}
+	}
+
+	success = true;
+	success = check(fib.result == fib_serial(24), "fib(24) is wrong") && success;
+	success = check(wrong == 0, "outside parallel_for missed indices") && success;
+
+	printf("outside        %s\n", success ? "ok" : "FAILED");
+
+	return success;
+}
+
+static double run_fib_bench(job_system* system, const uint32_t n) {
+	fib_job fib;
+	job_decl decl;
+	job_counter counter;
+	double start;
+
+	fib = { system, n, 0 };
+	decl = { fib_job_fn, &fib };
+
+	start = now_seconds();
+	run_jobs(system, &decl, 1, &counter);
+	wait_for_counter(system, &counter);
+
+	return now_seconds() - start;
+}
+
+static double run_parallel_for_bench(job_system* system, const vector<float>& input, vector<float>* output) {
+	sqrt_data sqrts;
+	double start;
+	uint32_t round;
+
+	sqrts.input = input.data();
+	sqrts.output = output->data();
+
+	start = now_seconds();
+
+	for (round = 0; round < 4; round++) {
+		parallel_for(system, (uint32_t)input.size(), 0, sqrt_range, &sqrts);
+	}
+
+	return now_seconds() - start;
+}
+
+static double run_fan_out_bench(job_system* system) {
+	atomic<uint64_t> total;
+	fan_out_data data;
+	vector<job_decl> decls;
+	job_counter counter;
+	double start;
+	uint32_t round;
+	uint32_t i;
+
+	total = 0;
+	data.system = system;
+	data.total = &total;
+
+	decls.resize(1000);
+	for (i = 0; i < decls.size(); i++) {
+		decls[i] = { fan_out_leaf, &data };
+	}
+
+	start = now_seconds();
+
+	for (round = 0; round < 200; round++) {
+		run_jobs(system, decls.data(), (uint32_t)decls.size(), &counter);
+		wait_for_counter(system, &counter);
+	}
+
+	return now_seconds() - start;
+}
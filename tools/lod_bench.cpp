@@ -0,0 +1,679 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the screen-space error LOD selection, then times it on a
+	million instances.
+
+	Checks:
+		view        pixels_per_unit is right for a known field of view
+		            and screen height.
+		levels      With no hysteresis, an instance gets the coarsest
+		            level whose error is under max_pixel_error on
+		            screen, measuring from the nearest point of its
+		            bounding sphere.
+		hysteresis  An instance only goes coarser once it's well past a
+		            switch distance, and only goes finer once it's well
+		            inside it. A camera bobbing back and forth across a
+		            switch distance doesn't make it flicker.
+		dither      A crowd of the same mesh at the same distance
+		            switches over several frames as the camera backs
+		            away, rather than all on one. Each instance's dither
+		            is the same every frame.
+		simd        Four at a time gives exactly the levels one at a
+		            time does, for ranges that don't start or end on a
+		            multiple of four.
+		bands       Frame after frame, with the camera moving and the
+		            options changing partway, keeping each instance's
+		            band gives the same levels as working every
+		            instance out from scratch.
+		parallel    Selecting on the job system gives the same levels
+		            as one thread.
+
+	Benchmark:
+		A million instances scattered around a camera that moves every
+		frame, selected on one thread and then across the job system,
+		with and without dither. Prints the best time for each, and how
+		much of the million went to each level, and the time for the
+		first frame, when every instance is worked out. Then times the job
+		system again with 1, 2, 4 and so on workers up to the core
+		count, to show how it scales.
+
+		The goal is under a millisecond a frame on the job system with
+		every core. Missing it fails the run, like a failed check.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		lod_bench [--quick]
+*/
+
+#include "lod_selector.h"
+#include "job_system.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const uint32_t BENCH_INSTANCES = 1000000;
+const uint32_t BENCH_FRAMES = 20;
+const double GOAL_SECONDS = 0.001;
+const float TEST_FIELD_OF_VIEW = 1.5707963f;
+const float TEST_SCREEN_HEIGHT = 1000.0f;
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+// A chain whose level i has error base * 2^(i - 1), and no indices. The
+// selector only needs the errors.
+static void make_chain(lod_chain* chain, const uint32_t lod_count, const float base);
+static void make_view(lod_view* view, const float x, const float y, const float z);
+static void make_scene(lod_group* group, const lod_chain* chain, const uint32_t count, const uint32_t seed);
+// Selects one instance at a time, so never four at once.
+static void select_lods_one_by_one(const lod_view* view, const lod_selection_options* options, lod_group* group);
+// The best time over BENCH_FRAMES frames for select_all_lods on a job
+// system with worker_count workers.
+static double time_select_all_lods(const uint32_t worker_count, const lod_selection_options* options, lod_group* scene);
+
+static bool run_view_check();
+static bool run_level_check();
+static bool run_hysteresis_check();
+static bool run_dither_check();
+static bool run_simd_check();
+static bool run_band_check();
+static bool run_parallel_check(job_system* system);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	lod_chain chain;
+	lod_group scene;
+	lod_selection_options options;
+	lod_view view;
+	uint32_t cores;
+	uint32_t frame;
+	double start;
+	double frame_time;
+	double rebuild_time;
+	double serial_time;
+	double parallel_time;
+	double dithered_time;
+	double scaled_time;
+	uint32_t workers;
+	bool quick;
+	bool success;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	system = new job_system;
+	initialize_job_system(system, cores < 4 ? 4 : cores, false);
+
+	success = true;
+	success = run_view_check() && success;
+	success = run_level_check() && success;
+	success = run_hysteresis_check() && success;
+	success = run_dither_check() && success;
+	success = run_simd_check() && success;
+	success = run_band_check() && success;
+	success = run_parallel_check(system) && success;
+
+	shutdown_job_system(system);
+	delete system;
+
+	if (quick) {
+		printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+		return success ? 0 : 1;
+	}
+
+	//
+	// Benchmark. The camera drifts a little each frame, like it would in
+	// a game, so some instances change level every frame.
+	//
+
+	make_chain(&chain, MAX_MESH_LODS, 0.05f);
+	make_scene(&scene, &chain, BENCH_INSTANCES, 1234);
+
+	// The first frame works out every instance's band. After that,
+	// only the few that leave theirs are.
+	rebuild_time = 0.0;
+	serial_time = 1e9;
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		make_view(&view, frame * 0.5f, 0.0f, 0.0f);
+		start = now_seconds();
+		select_all_lods(NULL, &view, &options, &scene);
+		frame_time = now_seconds() - start;
+
+		if (frame == 0) {
+			rebuild_time = frame_time;
+		} else {
+			serial_time = min(serial_time, frame_time);
+		}
+	}
+
+	printf("\n");
+	printf("%s", get_lod_group_report(&scene).c_str());
+
+	parallel_time = time_select_all_lods(cores, &options, &scene);
+
+	options.dither = 0.1f;
+	dithered_time = time_select_all_lods(cores, &options, &scene);
+	options.dither = 0.0f;
+
+	printf("\n%u instances, %u levels, %u cores\n", BENCH_INSTANCES, chain.lod_count, cores);
+	printf("one thread  %7.3fms (%5.2fns an instance)\n", serial_time * 1000.0, serial_time * 1e9 / BENCH_INSTANCES);
+	printf("job system  %7.3fms (%4.2fx)\n", parallel_time * 1000.0, serial_time / parallel_time);
+	printf("dithered    %7.3fms\n", dithered_time * 1000.0);
+	printf("first frame %7.3fms (every instance worked out)\n", rebuild_time * 1000.0);
+
+	printf("\nworkers  job system\n");
+	for (workers = 1; workers < cores; workers *= 2) {
+		scaled_time = time_select_all_lods(workers, &options, &scene);
+		printf("%7u  %7.3fms (%4.2fx)\n", workers, scaled_time * 1000.0, serial_time / scaled_time);
+	}
+	printf("%7u  %7.3fms (%4.2fx)\n", cores, parallel_time * 1000.0, serial_time / parallel_time);
+
+	printf("\n");
+	success = check(parallel_time < GOAL_SECONDS, "a million instances in under 1ms on the job system") && success;
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double time_select_all_lods(const uint32_t worker_count, const lod_selection_options* options, lod_group* scene) {
+	job_system* system;
+	lod_view view;
+	uint32_t frame;
+	double start;
+	double best_time;
+
+	system = new job_system;
+	initialize_job_system(system, worker_count, true);
+
+	best_time = 1e9;
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		make_view(&view, frame * 0.5f, 0.0f, 0.0f);
+		start = now_seconds();
+		select_all_lods(system, &view, options, scene);
+		best_time = min(best_time, now_seconds() - start);
+	}
+
+	shutdown_job_system(system);
+	delete system;
+
+	return best_time;
+}
+
+static void make_chain(lod_chain* chain, const uint32_t lod_count, const float base) {
+	uint32_t i;
+
+	chain->lod_count = lod_count;
+
+	for (i = 0; i < lod_count; i++) {
+		chain->lods[i].first_index = i * 3;
+		chain->lods[i].index_count = (MAX_MESH_LODS - i) * 3;
+		chain->lods[i].error = i == 0 ? 0.0f : base * (float)(1u << (i - 1));
+	}
+}
+
+static void make_view(lod_view* view, const float x, const float y, const float z) {
+	float eye[3];
+
+	eye[0] = x;
+	eye[1] = y;
+	eye[2] = z;
+
+	set_lod_view(view, eye, TEST_FIELD_OF_VIEW, TEST_SCREEN_HEIGHT);
+}
+
+static void make_scene(lod_group* group, const lod_chain* chain, const uint32_t count, const uint32_t seed) {
+	mt19937 random(seed);
+	uniform_real_distribution<float> position(-200.0f, 200.0f);
+	uniform_real_distribution<float> radius(0.1f, 4.0f);
+	uniform_int_distribution<uint32_t> level(0, chain->lod_count - 1);
+	float center[3];
+	uint32_t i;
+
+	*group = lod_group();
+	group->chain = chain;
+
+	for (i = 0; i < count; i++) {
+		center[0] = position(random);
+		center[1] = position(random);
+		center[2] = position(random);
+		add_lod_instance(group, center, radius(random));
+
+		// Start from all over the place, as if they'd been selected
+		// from somewhere else last frame.
+		group->lods[i] = (uint8_t)level(random);
+	}
+}
+
+static void select_lods_one_by_one(const lod_view* view, const lod_selection_options* options, lod_group* group) {
+	uint32_t i;
+
+	for (i = 0; i < group->lods.size(); i++) {
+		select_lods(view, options, group, i, i + 1);
+	}
+}
+
+static bool run_view_check() {
+	lod_view view;
+	float eye[3];
+	bool success;
+
+	printf("view\n");
+	success = true;
+
+	eye[0] = 1.0f;
+	eye[1] = 2.0f;
+	eye[2] = 3.0f;
+
+	// 90 degrees: the screen is 2 units tall, one unit away.
+	set_lod_view(&view, eye, TEST_FIELD_OF_VIEW, TEST_SCREEN_HEIGHT);
+	success = check(fabsf(view.pixels_per_unit - 500.0f) < 0.01f, "a 90 degree view 1000 pixels tall is 500 pixels a unit") && success;
+	success = check(view.eye[0] == 1.0f && view.eye[1] == 2.0f && view.eye[2] == 3.0f, "the eye is kept") && success;
+
+	set_lod_view(&view, eye, 2.0f * atanf(0.25f), TEST_SCREEN_HEIGHT);
+	success = check(fabsf(view.pixels_per_unit - 2000.0f) < 0.1f, "a narrower view is more pixels a unit") && success;
+
+	return success;
+}
+
+static bool run_level_check() {
+	// Level i can be used from i * 5 units away (error 0.01 * 2^(i - 1)
+	// is 1 pixel at 500 pixels a unit from 5 * 2^(i - 1) away).
+	const float distances[] = { 0.0f, 4.9f, 5.1f, 9.9f, 10.1f, 19.0f, 21.0f, 39.0f, 41.0f, 1000.0f };
+	const uint8_t expected[] = { 0, 0, 1, 1, 2, 2, 3, 3, 4, 4 };
+	lod_chain chain;
+	lod_group group;
+	lod_selection_options options;
+	lod_view view;
+	float center[3];
+	bool right;
+	bool success;
+	uint32_t i;
+
+	printf("levels\n");
+	success = true;
+
+	make_chain(&chain, 5, 0.01f);
+	make_view(&view, 0.0f, 0.0f, 0.0f);
+	options.hysteresis = 0.0f;
+	group.chain = &chain;
+
+	center[0] = 0.0f;
+	center[1] = 0.0f;
+
+	right = true;
+	for (i = 0; i < sizeof(distances) / sizeof(distances[0]); i++) {
+		center[2] = distances[i];
+		add_lod_instance(&group, center, 0.0f);
+	}
+
+	select_lods(&view, &options, &group, 0, (uint32_t)group.lods.size());
+
+	for (i = 0; i < sizeof(distances) / sizeof(distances[0]); i++) {
+		right = right && group.lods[i] == expected[i];
+	}
+
+	success = check(right, "each distance gets the coarsest level that's under a pixel") && success;
+	success = check(get_instance_lod(&group, 4)->first_index == chain.lods[2].first_index, "the instance's index range is its level's") && success;
+
+	//
+	// 11 units away with a radius of 2 is 9 to the nearest point.
+	//
+
+	center[2] = 11.0f;
+	move_lod_instance(&group, 0, center, 2.0f);
+	group.lods[0] = 0;
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 1, "distance is to the nearest point of the sphere") && success;
+
+	center[2] = 1.0f;
+	move_lod_instance(&group, 0, center, 2.0f);
+	group.lods[0] = 3;
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 0, "inside the sphere is level 0") && success;
+
+	options.max_pixel_error = 2.0f;
+	center[2] = 5.1f;
+	move_lod_instance(&group, 0, center, 0.0f);
+	group.lods[0] = 0;
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 2, "allowing more pixels of error halves the distances") && success;
+
+	return success;
+}
+
+static bool run_hysteresis_check() {
+	lod_chain chain;
+	lod_group group;
+	lod_selection_options options;
+	lod_view view;
+	float center[3];
+	uint32_t changes;
+	uint8_t last;
+	bool success;
+	uint32_t frame;
+
+	printf("hysteresis\n");
+	success = true;
+
+	// Level 1 from 5 units away, with 10% either side.
+	make_chain(&chain, 3, 0.01f);
+	options.hysteresis = 0.1f;
+	group.chain = &chain;
+
+	center[0] = 0.0f;
+	center[1] = 0.0f;
+	center[2] = 0.0f;
+	add_lod_instance(&group, center, 0.0f);
+
+	make_view(&view, 0.0f, 0.0f, -5.2f);
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 0, "just past a switch distance stays finer") && success;
+
+	make_view(&view, 0.0f, 0.0f, -5.6f);
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 1, "well past it goes coarser") && success;
+
+	make_view(&view, 0.0f, 0.0f, -4.8f);
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 1, "just inside it stays coarser") && success;
+
+	make_view(&view, 0.0f, 0.0f, -4.4f);
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 0, "well inside it goes finer") && success;
+
+	make_view(&view, 0.0f, 0.0f, -1000.0f);
+	select_lods(&view, &options, &group, 0, 1);
+	success = check(group.lods[0] == 2, "a big jump goes straight to the right level") && success;
+
+	//
+	// Bob the camera 4% either side of the switch distance.
+	//
+
+	group.lods[0] = 0;
+	last = 0;
+	changes = 0;
+
+	for (frame = 0; frame < 100; frame++) {
+		make_view(&view, 0.0f, 0.0f, -5.0f * (1.0f + 0.04f * sinf(frame * 0.7f)));
+		select_lods(&view, &options, &group, 0, 1);
+
+		if (group.lods[0] != last) {
+			changes++;
+			last = group.lods[0];
+		}
+	}
+
+	success = check(changes == 0, "bobbing across a switch distance doesn't flicker") && success;
+
+	options.hysteresis = 0.0f;
+	changes = 0;
+
+	for (frame = 0; frame < 100; frame++) {
+		make_view(&view, 0.0f, 0.0f, -5.0f * (1.0f + 0.04f * sinf(frame * 0.7f)));
+		select_lods(&view, &options, &group, 0, 1);
+
+		if (group.lods[0] != last) {
+			changes++;
+			last = group.lods[0];
+		}
+	}
+
+	success = check(changes > 10, "without hysteresis, it does") && success;
+
+	return success;
+}
+
+static bool run_dither_check() {
+	lod_chain chain;
+	lod_group group;
+	lod_selection_options options;
+	lod_view view;
+	vector<uint8_t> before;
+	float center[3];
+	uint32_t plain_frames;
+	uint32_t dithered_frames;
+	uint32_t switched;
+	bool stable;
+	bool success;
+	uint32_t frame;
+	uint32_t i;
+
+	printf("dither\n");
+	success = true;
+
+	make_chain(&chain, 2, 0.01f);
+	options.hysteresis = 0.0f;
+	group.chain = &chain;
+
+	center[0] = 0.0f;
+	center[1] = 0.0f;
+	center[2] = 0.0f;
+
+	for (i = 0; i < 10000; i++) {
+		add_lod_instance(&group, center, 0.0f);
+	}
+
+	//
+	// Back the camera away from the crowd, from 4 units to 6, and
+	// count the frames on which any of them switched.
+	//
+
+	plain_frames = 0;
+	dithered_frames = 0;
+
+	for (options.dither = 0.0f; options.dither < 0.2f; options.dither += 0.1f) {
+		memset(group.lods.data(), 0, group.lods.size());
+
+		for (frame = 0; frame < 100; frame++) {
+			before = group.lods;
+
+			make_view(&view, 0.0f, 0.0f, -4.0f - frame * 0.02f);
+			select_lods(&view, &options, &group, 0, (uint32_t)group.lods.size());
+
+			switched = 0;
+			for (i = 0; i < group.lods.size(); i++) {
+				switched += group.lods[i] != before[i] ? 1 : 0;
+			}
+
+			if (switched > 0) {
+				if (options.dither == 0.0f) {
+					plain_frames++;
+				} else {
+					dithered_frames++;
+				}
+			}
+		}
+	}
+
+	success = check(plain_frames == 1, "without dither, the crowd switches on one frame") && success;
+	success = check(dithered_frames >= 10, "with it, over many") && success;
+
+	//
+	// Halfway through the transition, selecting again from the same
+	// place changes nothing, so the dither doesn't flicker.
+	//
+
+	options.dither = 0.1f;
+	memset(group.lods.data(), 0, group.lods.size());
+
+	make_view(&view, 0.0f, 0.0f, -5.0f);
+	select_lods(&view, &options, &group, 0, (uint32_t)group.lods.size());
+	before = group.lods;
+
+	stable = true;
+	for (frame = 0; frame < 10; frame++) {
+		memset(group.lods.data(), 0, group.lods.size());
+		select_lods(&view, &options, &group, 0, (uint32_t)group.lods.size());
+		stable = stable && group.lods == before;
+	}
+
+	switched = 0;
+	for (i = 0; i < group.lods.size(); i++) {
+		switched += group.lods[i];
+	}
+
+	success = check(switched > 3000 && switched < 7000, "halfway, about half the crowd has switched") && success;
+	success = check(stable, "each instance's dither is the same every frame") && success;
+
+	return success;
+}
+
+static bool run_simd_check() {
+	const uint32_t sizes[] = { 1, 3, 4, 5, 8, 13, 1000, 4099 };
+	lod_chain chain;
+	lod_group scene;
+	lod_group one_by_one;
+	lod_group ranged;
+	lod_selection_options options;
+	lod_view view;
+	bool same;
+	bool same_ranged;
+	bool some_changed;
+	size_t s;
+	uint32_t run;
+	uint32_t first;
+	uint32_t last;
+
+	printf("simd\n");
+
+	make_chain(&chain, MAX_MESH_LODS, 0.05f);
+
+	same = true;
+	same_ranged = true;
+	some_changed = false;
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		for (run = 0; run < 3; run++) {
+			make_scene(&scene, &chain, sizes[s], 17 + (uint32_t)s);
+			make_view(&view, run * 3.0f, -2.0f, 1.0f);
+
+			options.hysteresis = run * 0.1f;
+			options.dither = run == 2 ? 0.15f : 0.0f;
+
+			one_by_one = scene;
+			ranged = scene;
+
+			select_lods(&view, &options, &scene, 0, sizes[s]);
+			select_lods_one_by_one(&view, &options, &one_by_one);
+
+			same = same && scene.lods == one_by_one.lods;
+			some_changed = some_changed || scene.lods != ranged.lods;
+
+			// A range that starts and ends partway through a group of
+			// four.
+			first = sizes[s] / 3;
+			last = sizes[s] - sizes[s] / 5;
+			select_lods(&view, &options, &ranged, first, last);
+			select_lods(&view, &options, &ranged, 0, first);
+			select_lods(&view, &options, &ranged, last, sizes[s]);
+
+			same_ranged = same_ranged && ranged.lods == one_by_one.lods;
+		}
+	}
+
+	check(some_changed, "selection changes levels");
+	check(same, "four at a time is the same as one at a time");
+	check(same_ranged, "including in ranges that aren't lined up");
+
+	return some_changed && same && same_ranged;
+}
+
+static bool run_band_check() {
+	lod_chain chain;
+	lod_group kept;
+	lod_group scratch;
+	lod_selection_options options;
+	lod_view view;
+	vector<uint8_t> first_levels;
+	bool same;
+	bool success;
+	uint32_t frame;
+
+	printf("bands\n");
+
+	make_chain(&chain, MAX_MESH_LODS, 0.05f);
+	make_scene(&kept, &chain, 10007, 91);
+
+	same = true;
+
+	for (frame = 0; frame < 40; frame++) {
+		// Halfway, the options change, which the bands have to notice.
+		if (frame == 20) {
+			options.hysteresis = 0.25f;
+			options.dither = 0.1f;
+		}
+
+		make_view(&view, frame * 2.0f, frame * 0.5f, 0.0f);
+
+		// Without band_distances, select_lods can't use the bands, so
+		// this is every instance worked out from scratch.
+		scratch = kept;
+		scratch.band_distances = lod_group().band_distances;
+		select_lods(&view, &options, &scratch, 0, (uint32_t)scratch.lods.size());
+
+		select_all_lods(NULL, &view, &options, &kept);
+
+		if (frame == 0) {
+			first_levels = kept.lods;
+		}
+
+		same = same && kept.lods == scratch.lods;
+	}
+
+	success = check(first_levels != kept.lods, "the camera moving changes levels");
+	success = check(same, "keeping bands gives the same levels as working them out every frame") && success;
+
+	return success;
+}
+
+static bool run_parallel_check(job_system* system) {
+	const uint32_t sizes[] = { 0, 1, 7, 16384, 16385, 100003 };
+	lod_chain chain;
+	lod_group serial;
+	lod_group parallel;
+	lod_selection_options options;
+	lod_view view;
+	bool same;
+	size_t s;
+
+	printf("parallel\n");
+
+	make_chain(&chain, MAX_MESH_LODS, 0.02f);
+	options.dither = 0.1f;
+	make_view(&view, 10.0f, 5.0f, -20.0f);
+
+	same = true;
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		make_scene(&serial, &chain, sizes[s], 300 + (uint32_t)s);
+		parallel = serial;
+
+		select_all_lods(NULL, &view, &options, &serial);
+		select_all_lods(system, &view, &options, &parallel);
+
+		same = same && serial.lods == parallel.lods;
+	}
+
+	return check(same, "the job system picks the same levels as one thread");
+}
@@ -0,0 +1,389 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the bindless material registry, then compares what switching
+	materials costs the CPU with and without it.
+
+	Checks:
+		textures     Each texture gets one slot, and freed slots are
+		             reused.
+		materials    Adding, finding, replacing and removing materials,
+		             and refusing ones that point at an empty slot.
+		upload       Only the records that changed are copied, and the
+		             copy matches the GPU layout.
+
+	Benchmark: a million draws, each with a random one of 256 materials.
+	Without bindless, every switch copies the material's texture
+	descriptor into the shader visible heap, points the descriptor
+	table at it, and sets the material's parameters as root constants.
+	With bindless, every switch sets one root constant. D3D isn't on
+	Linux, so the command list and descriptor heap are stand-ins that
+	do the same amount of copying as the real thing: a command is a
+	small header plus its arguments, and a descriptor is 32 bytes. The
+	time for the same draws without any switching is taken off, to get
+	the cost of each switch.
+
+	Usage:
+		material_bench [--quick]
+*/
+
+#include "material_registry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+const uint32_t MAX_MATERIALS = 256;
+const uint32_t MAX_TEXTURES = 1024;
+const uint32_t BENCH_DRAWS = 1000000;
+// The size of a CBV/SRV/UAV descriptor on most hardware.
+const size_t DESCRIPTOR_SIZE = 32;
+
+enum {
+	COMMAND_SET_TABLE = 1,
+	COMMAND_SET_CONSTANTS,
+	COMMAND_DRAW
+};
+
+// Records commands the way a command list does: a header, then the
+// arguments.
+struct fake_command_list {
+	vector<uint8_t> commands;
+	size_t size;
+};
+
+// A shader visible heap we copy descriptors into, as a ring.
+struct fake_descriptor_heap {
+	vector<uint8_t> descriptors;
+	uint32_t capacity;
+	uint32_t next;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static void record_command(
+	fake_command_list* list,
+	const uint32_t type,
+	const void* arguments,
+	const uint32_t size
+);
+
+static bool run_textures();
+static bool run_materials();
+static bool run_upload();
+static void run_benchmark();
+
+int main(int argc, char** argv) {
+	bool quick;
+	bool success;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	success = true;
+	success = run_textures() && success;
+	success = run_materials() && success;
+	success = run_upload() && success;
+
+	if (!quick) {
+		run_benchmark();
+	}
+
+	printf(success ? "All checks passed\n" : "Some checks failed\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void record_command(
+	fake_command_list* list,
+	const uint32_t type,
+	const void* arguments,
+	const uint32_t size
+) {
+	uint32_t header[2];
+
+	header[0] = type;
+	header[1] = size;
+
+	memcpy(&(list->commands[list->size]), header, sizeof(header));
+	memcpy(&(list->commands[list->size + sizeof(header)]), arguments, size);
+	list->size += sizeof(header) + size;
+}
+
+static bool run_textures() {
+	material_registry registry;
+	int textures[4];
+	uint32_t slots[4];
+	bool success;
+
+	printf("Textures\n");
+
+	initialize_material_registry(&registry, 16, 3);
+
+	slots[0] = add_material_texture(&registry, &(textures[0]));
+	slots[1] = add_material_texture(&registry, &(textures[1]));
+	slots[2] = add_material_texture(&registry, &(textures[2]));
+	slots[3] = add_material_texture(&registry, &(textures[3]));
+
+	success = check(slots[0] == 0 && slots[1] == 1 && slots[2] == 2, "slots are handed out in order");
+	success = check(slots[3] == MATERIAL_NO_TEXTURE, "there's no slot once they're all used") && success;
+	success = check(add_material_texture(&registry, &(textures[1])) == 1, "a texture only ever gets one slot") && success;
+	success = check(add_material_texture(&registry, NULL) == MATERIAL_NO_TEXTURE, "NULL doesn't get a slot") && success;
+
+	remove_material_texture(&registry, &(textures[1]));
+	success = check(add_material_texture(&registry, &(textures[3])) == 1, "a freed slot is reused") && success;
+	success = check(get_material_registry_stats(&registry).texture_count == 3, "the slots are all counted") && success;
+
+	return success;
+}
+
+static bool run_materials() {
+	material_registry registry;
+	gpu_material material;
+	int texture;
+	uint32_t slot;
+	uint32_t first;
+	uint32_t second;
+	bool success;
+
+	printf("Materials\n");
+
+	initialize_material_registry(&registry, 2, 4);
+	slot = add_material_texture(&registry, &texture);
+
+	material = get_default_material();
+	material.albedo_texture = slot;
+	material.roughness = 0.5f;
+
+	first = add_material(&registry, "brick", material);
+	second = add_material(&registry, "plain", get_default_material());
+
+	success = check(first == 0 && second == 1, "materials get the lowest free index");
+	success = check(find_material(&registry, "brick") == first, "materials can be found by name") && success;
+	success = check(find_material(&registry, "missing") == MATERIAL_INVALID, "missing materials aren't found") && success;
+
+	material.roughness = 0.25f;
+	success = check(add_material(&registry, "brick", material) == first, "adding the same name replaces it") && success;
+	success = check(registry.materials[first].roughness == 0.25f, "with the new parameters") && success;
+	success = check(add_material(&registry, "third", material) == MATERIAL_INVALID, "nothing is added when it's full") && success;
+
+	material.albedo_texture = 3;
+	success = check(!update_material(&registry, first, material), "materials can't point at an empty texture slot") && success;
+	success = check(registry.materials[first].albedo_texture == slot, "and a refused update changes nothing") && success;
+
+	remove_material(&registry, first);
+	success = check(find_material(&registry, "brick") == MATERIAL_INVALID, "removed materials can't be found") && success;
+	success = check(
+		registry.materials[first].albedo_texture == MATERIAL_NO_TEXTURE,
+		"a removed material's record goes back to the default"
+	) && success;
+	success = check(add_material(&registry, "stone", get_default_material()) == first, "and its index is reused") && success;
+
+	return success;
+}
+
+static bool run_upload() {
+	material_registry registry;
+	vector<gpu_material> buffer;
+	gpu_material material;
+	uint32_t copied;
+	bool success;
+
+	printf("Upload\n");
+
+	initialize_material_registry(&registry, 64, 4);
+	buffer.resize(64);
+	memset(buffer.data(), 0xff, buffer.size() * sizeof(gpu_material));
+
+	copied = upload_materials(&registry, buffer.data());
+	success = check(copied == 64, "the first upload copies every record");
+	success = check(
+		memcmp(buffer.data(), registry.materials.data(), 64 * sizeof(gpu_material)) == 0,
+		"and they're laid out as the records are"
+	) && success;
+	success = check(upload_materials(&registry, buffer.data()) == 0, "nothing is copied when nothing changed") && success;
+
+	material = get_default_material();
+	material.metallic = 1.0f;
+
+	add_material(&registry, "a", material);
+	add_material(&registry, "b", material);
+	add_material(&registry, "c", material);
+	remove_material(&registry, 1);
+
+	// Clobber what should be left alone.
+	buffer[5].metallic = 7.0f;
+	copied = upload_materials(&registry, buffer.data());
+
+	success = check(copied == 3, "only the changed range is copied") && success;
+	success = check(buffer[0].metallic == 1.0f && buffer[2].metallic == 1.0f, "the new records arrive") && success;
+	success = check(buffer[1].metallic == 0.0f, "so does the removed one") && success;
+	success = check(buffer[5].metallic == 7.0f, "and nothing past the range is touched") && success;
+
+	return success;
+}
+
+static void run_benchmark() {
+	material_registry registry;
+	fake_command_list list;
+	fake_descriptor_heap heap;
+	vector<uint8_t> source_descriptors;
+	vector<uint32_t> draw_materials;
+	vector<int> textures;
+	gpu_material material;
+	uint64_t table;
+	uint32_t draw[5];
+	uint32_t root_constant[2];
+	mt19937 random(1);
+	uniform_int_distribution<uint32_t> pick(0, MAX_MATERIALS - 1);
+	double start;
+	double draws_only;
+	double bound;
+	double bindless;
+	uint32_t switches;
+	uint32_t current;
+	uint32_t index;
+	uint32_t i;
+
+	printf("Benchmark (%u draws, %u materials)\n", BENCH_DRAWS, MAX_MATERIALS);
+
+	//
+	// A texture and a material for each.
+	//
+
+	initialize_material_registry(&registry, MAX_MATERIALS, MAX_TEXTURES);
+	textures.resize(MAX_MATERIALS);
+	source_descriptors.assign((size_t)MAX_TEXTURES * DESCRIPTOR_SIZE, 1);
+
+	for (i = 0; i < MAX_MATERIALS; i++) {
+		material = get_default_material();
+		material.albedo_texture = add_material_texture(&registry, &(textures[i]));
+		material.roughness = (float)i / MAX_MATERIALS;
+		add_material(&registry, "material " + to_string(i), material);
+	}
+
+	draw_materials.resize(BENCH_DRAWS);
+	for (i = 0; i < BENCH_DRAWS; i++) {
+		draw_materials[i] = pick(random);
+	}
+
+	// Room for every draw's commands, so neither run reallocates.
+	list.commands.resize((size_t)BENCH_DRAWS * 96);
+	heap.capacity = MAX_TEXTURES;
+	heap.descriptors.resize((size_t)heap.capacity * DESCRIPTOR_SIZE);
+
+	draw[0] = 36;
+	draw[1] = 1;
+	draw[2] = 0;
+	draw[3] = 0;
+	draw[4] = 0;
+
+	//
+	// Just the draws, to take off the others.
+	//
+
+	list.size = 0;
+	start = now_seconds();
+
+	for (i = 0; i < BENCH_DRAWS; i++) {
+		record_command(&list, COMMAND_DRAW, draw, sizeof(draw));
+	}
+
+	draws_only = now_seconds() - start;
+
+	//
+	// Without bindless.
+	//
+
+	list.size = 0;
+	heap.next = 0;
+	current = MATERIAL_INVALID;
+	switches = 0;
+	start = now_seconds();
+
+	for (i = 0; i < BENCH_DRAWS; i++) {
+		index = draw_materials[i];
+
+		if (index != current) {
+			// CopyDescriptorsSimple into the next slot of the ring.
+			memcpy(
+				&(heap.descriptors[(size_t)heap.next * DESCRIPTOR_SIZE]),
+				&(source_descriptors[(size_t)registry.materials[index].albedo_texture * DESCRIPTOR_SIZE]),
+				DESCRIPTOR_SIZE
+			);
+
+			// SetGraphicsRootDescriptorTable.
+			table = heap.next;
+			record_command(&list, COMMAND_SET_TABLE, &table, sizeof(table));
+			heap.next = (heap.next + 1) % heap.capacity;
+
+			// SetGraphicsRoot32BitConstants with the scalar parameters.
+			record_command(
+				&list,
+				COMMAND_SET_CONSTANTS,
+				&(registry.materials[index].roughness),
+				sizeof(gpu_material) - 2 * sizeof(uint32_t)
+			);
+
+			current = index;
+			switches++;
+		}
+
+		record_command(&list, COMMAND_DRAW, draw, sizeof(draw));
+	}
+
+	bound = now_seconds() - start;
+
+	//
+	// With bindless.
+	//
+
+	list.size = 0;
+	current = MATERIAL_INVALID;
+	start = now_seconds();
+
+	for (i = 0; i < BENCH_DRAWS; i++) {
+		index = draw_materials[i];
+
+		if (index != current) {
+			// SetGraphicsRoot32BitConstant with the material index.
+			root_constant[0] = 3;
+			root_constant[1] = index;
+			record_command(&list, COMMAND_SET_CONSTANTS, root_constant, sizeof(root_constant));
+
+			current = index;
+		}
+
+		record_command(&list, COMMAND_DRAW, draw, sizeof(draw));
+	}
+
+	bindless = now_seconds() - start;
+
+	printf("  %u material switches\n", switches);
+	printf(
+		"  %-16s %7.2fms  %5.1fns a switch\n",
+		"descriptor table",
+		bound * 1000.0,
+		(bound - draws_only) * 1e9 / switches
+	);
+	printf(
+		"  %-16s %7.2fms  %5.1fns a switch\n",
+		"bindless",
+		bindless * 1000.0,
+		(bindless - draws_only) * 1e9 / switches
+	);
+	printf("  a switch is %.1fx cheaper with bindless\n", (bound - draws_only) / (bindless - draws_only));
+	printf("  %s", get_material_registry_report(&registry).c_str());
+}
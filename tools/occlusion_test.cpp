@@ -0,0 +1,998 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the CPU occlusion culler against a brute force version of
+	it, then times it on a city of boxes.
+
+	Checks:
+		reference   Random scenes of boxes, seen from random cameras,
+		            rasterize to exactly the depth a brute force
+		            rasterizer gets: every triangle tested against every
+		            pixel, no tiles, bins or SIMD.
+		queries     Random boxes are visible exactly when the brute
+		            force test (every pixel under the box) says they
+		            are, so the hierarchical Z never changes an answer.
+		hiz         Every texel of every level is the farthest depth of
+		            the pixels under it.
+		cases       A box behind a wall is hidden, and one in front of
+		            it, beside it, poking out past it, crossing the near
+		            plane or off the screen isn't. Back faces are
+		            skipped, or drawn when asked to be, and triangles
+		            crossing the near plane are dropped.
+		parallel    Binning and rasterizing on the job system gives the
+		            same depth as one thread, and so does testing boxes.
+
+	Benchmark:
+		A city of 4096 buildings (49152 triangles) in a 320 x 192
+		buffer, seen from a roof at one corner, then 100000 boxes tested against
+		it. Prints the time for each, on one thread and across the job
+		system, and how many boxes were hidden.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		occlusion_test [--quick]
+*/
+
+#include "occlusion_culler.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const uint32_t TEST_WIDTH = 320;
+const uint32_t TEST_HEIGHT = 192;
+const uint32_t BENCH_BUILDINGS = 4096;
+const uint32_t BENCH_BOXES = 100000;
+const uint32_t BENCH_RUNS = 10;
+
+// A cube from -1 to 1. Corner i is at x = bit 0, y = bit 1, z = bit 2.
+const float CUBE_POSITIONS[24] = {
+	-1.0f, -1.0f, -1.0f,
+	 1.0f, -1.0f, -1.0f,
+	-1.0f,  1.0f, -1.0f,
+	 1.0f,  1.0f, -1.0f,
+	-1.0f, -1.0f,  1.0f,
+	 1.0f, -1.0f,  1.0f,
+	-1.0f,  1.0f,  1.0f,
+	 1.0f,  1.0f,  1.0f
+};
+
+// Each face clockwise from outside, like the application's cube.
+const uint32_t CUBE_INDICES[36] = {
+	0, 2, 3, 0, 3, 1,
+	5, 7, 6, 5, 6, 4,
+	4, 6, 2, 4, 2, 0,
+	1, 3, 7, 1, 7, 5,
+	1, 5, 4, 1, 4, 0,
+	2, 6, 7, 2, 7, 3
+};
+
+// A square from -1 to 1 in x and y, facing -z.
+const float WALL_POSITIONS[12] = {
+	-1.0f, -1.0f, 0.0f,
+	-1.0f,  1.0f, 0.0f,
+	 1.0f,  1.0f, 0.0f,
+	 1.0f, -1.0f, 0.0f
+};
+
+const uint32_t WALL_INDICES[6] = { 0, 1, 2, 0, 2, 3 };
+
+struct camera {
+	float view_projection[16];
+};
+
+struct test_scene {
+	vector<occluder_mesh> occluders;
+	// A min, max and matrix for each test box.
+	vector<float> box_mins;
+	vector<float> box_maxes;
+	vector<float> box_matrices;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static void multiply(const float* a, const float* b, float* result);
+static void make_camera(camera* result, const float eye[3], const float target[3], const float aspect);
+static void make_world(float* world, const float x, const float y, const float z, const float sx, const float sy, const float sz);
+static void add_box_occluder(test_scene* scene, const camera* view, const float x, const float y, const float z, const float sx, const float sy, const float sz);
+static void add_wall_occluder(test_scene* scene, const camera* view, const float x, const float y, const float z, const float sx, const float sy);
+static void add_test_box(test_scene* scene, const camera* view, const float x, const float y, const float z, const float size);
+static void make_random_scene(test_scene* scene, camera* view, const uint32_t seed, const uint32_t occluders, const uint32_t boxes);
+static void make_city(test_scene* scene, camera* view, const uint32_t buildings, const uint32_t boxes, const uint32_t seed);
+
+// The brute force versions.
+static void reference_rasterize(const occlusion_buffer* buffer, const test_scene* scene, vector<float>* depth);
+static bool reference_is_visible(
+	const occlusion_buffer* buffer,
+	const vector<float>& depth,
+	const float box_min[3],
+	const float box_max[3],
+	const float matrix[16]
+);
+
+static bool run_reference_check(job_system* system);
+static bool run_query_check();
+static bool run_hiz_check();
+static bool run_case_check();
+static bool run_parallel_check(job_system* system);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	occlusion_buffer* buffer;
+	test_scene city;
+	camera view;
+	vector<uint8_t> visible;
+	uint32_t cores;
+	uint32_t hidden;
+	double start;
+	double serial_render;
+	double parallel_render;
+	double serial_test;
+	double parallel_test;
+	bool quick;
+	bool success;
+	uint32_t run;
+	uint32_t i;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	system = new job_system;
+	initialize_job_system(system, cores < 4 ? 4 : cores, false);
+
+	success = true;
+	success = run_reference_check(system) && success;
+	success = run_query_check() && success;
+	success = run_hiz_check() && success;
+	success = run_case_check() && success;
+	success = run_parallel_check(system) && success;
+
+	shutdown_job_system(system);
+	delete system;
+
+	if (quick) {
+		printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+		return success ? 0 : 1;
+	}
+
+	//
+	// Benchmark.
+	//
+
+	buffer = new occlusion_buffer;
+	initialize_occlusion_buffer(buffer, TEST_WIDTH, TEST_HEIGHT);
+
+	make_city(&city, &view, BENCH_BUILDINGS, BENCH_BOXES, 99);
+	visible.resize(BENCH_BOXES);
+
+	serial_render = 1e9;
+	serial_test = 1e9;
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+		render_occluders(NULL, buffer, city.occluders.data(), (uint32_t)city.occluders.size());
+		serial_render = min(serial_render, now_seconds() - start);
+
+		start = now_seconds();
+		test_occlusion(NULL, buffer, city.box_mins.data(), city.box_maxes.data(), city.box_matrices.data(), BENCH_BOXES, visible.data());
+		serial_test = min(serial_test, now_seconds() - start);
+	}
+
+	printf("\n%s", get_occlusion_report(buffer).c_str());
+
+	system = new job_system;
+	initialize_job_system(system, cores, true);
+
+	parallel_render = 1e9;
+	parallel_test = 1e9;
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = now_seconds();
+		render_occluders(system, buffer, city.occluders.data(), (uint32_t)city.occluders.size());
+		parallel_render = min(parallel_render, now_seconds() - start);
+
+		start = now_seconds();
+		test_occlusion(system, buffer, city.box_mins.data(), city.box_maxes.data(), city.box_matrices.data(), BENCH_BOXES, visible.data());
+		parallel_test = min(parallel_test, now_seconds() - start);
+	}
+
+	shutdown_job_system(system);
+	delete system;
+
+	hidden = 0;
+	for (i = 0; i < BENCH_BOXES; i++) {
+		hidden += visible[i] ? 0 : 1;
+	}
+
+	printf("\n%u buildings, %u boxes, %u hidden (%.1f%%), %u cores\n",
+		BENCH_BUILDINGS, BENCH_BOXES, hidden, 100.0 * hidden / BENCH_BOXES, cores);
+	printf("                 one thread    job system\n");
+	printf("occluders     %10.3fms  %10.3fms (%4.2fx)\n", serial_render * 1000.0, parallel_render * 1000.0, serial_render / parallel_render);
+	printf("boxes         %10.3fms  %10.3fms (%4.2fx, %.0fns a box)\n",
+		serial_test * 1000.0, parallel_test * 1000.0, serial_test / parallel_test, serial_test * 1e9 / BENCH_BOXES);
+
+	delete buffer;
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void multiply(const float* a, const float* b, float* result) {
+	uint32_t row;
+	uint32_t column;
+	uint32_t k;
+
+	for (row = 0; row < 4; row++) {
+		for (column = 0; column < 4; column++) {
+			result[row * 4 + column] = 0.0f;
+			for (k = 0; k < 4; k++) {
+				result[row * 4 + column] += a[row * 4 + k] * b[k * 4 + column];
+			}
+		}
+	}
+}
+
+static void make_camera(camera* result, const float eye[3], const float target[3], const float aspect) {
+	float view[16];
+	float projection[16];
+	float x[3];
+	float y[3];
+	float z[3];
+	float length;
+	float near_z;
+	float far_z;
+	float y_scale;
+	uint32_t i;
+
+	//
+	// XMMatrixLookAtLH with y up, and XMMatrixPerspectiveFovLH with a
+	// 60 degree field of view and depths 0.1 to 1000, like the
+	// application's.
+	//
+
+	for (i = 0; i < 3; i++) {
+		z[i] = target[i] - eye[i];
+	}
+
+	length = sqrtf(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
+	for (i = 0; i < 3; i++) {
+		z[i] /= length;
+	}
+
+	// up x z, with up = (0, 1, 0).
+	x[0] = z[2];
+	x[1] = 0.0f;
+	x[2] = -z[0];
+	length = sqrtf(x[0] * x[0] + x[2] * x[2]);
+	x[0] /= length;
+	x[2] /= length;
+
+	y[0] = z[1] * x[2] - z[2] * x[1];
+	y[1] = z[2] * x[0] - z[0] * x[2];
+	y[2] = z[0] * x[1] - z[1] * x[0];
+
+	memset(view, 0, sizeof(view));
+	for (i = 0; i < 3; i++) {
+		view[i * 4 + 0] = x[i];
+		view[i * 4 + 1] = y[i];
+		view[i * 4 + 2] = z[i];
+	}
+
+	view[12] = -(x[0] * eye[0] + x[1] * eye[1] + x[2] * eye[2]);
+	view[13] = -(y[0] * eye[0] + y[1] * eye[1] + y[2] * eye[2]);
+	view[14] = -(z[0] * eye[0] + z[1] * eye[1] + z[2] * eye[2]);
+	view[15] = 1.0f;
+
+	near_z = 0.1f;
+	far_z = 1000.0f;
+	y_scale = 1.0f / tanf(3.14159265f / 6.0f);
+
+	memset(projection, 0, sizeof(projection));
+	projection[0] = y_scale / aspect;
+	projection[5] = y_scale;
+	projection[10] = far_z / (far_z - near_z);
+	projection[11] = 1.0f;
+	projection[14] = -near_z * far_z / (far_z - near_z);
+
+	multiply(view, projection, result->view_projection);
+}
+
+static void make_world(float* world, const float x, const float y, const float z, const float sx, const float sy, const float sz) {
+	memset(world, 0, 16 * sizeof(float));
+
+	world[0] = sx;
+	world[5] = sy;
+	world[10] = sz;
+	world[12] = x;
+	world[13] = y;
+	world[14] = z;
+	world[15] = 1.0f;
+}
+
+static void add_box_occluder(test_scene* scene, const camera* view, const float x, const float y, const float z, const float sx, const float sy, const float sz) {
+	occluder_mesh occluder;
+	float world[16];
+
+	occluder.positions = CUBE_POSITIONS;
+	occluder.vertex_count = 8;
+	occluder.indices = CUBE_INDICES;
+	occluder.index_count = 36;
+
+	make_world(world, x, y, z, sx, sy, sz);
+	multiply(world, view->view_projection, occluder.world_view_projection);
+
+	scene->occluders.push_back(occluder);
+}
+
+static void add_wall_occluder(test_scene* scene, const camera* view, const float x, const float y, const float z, const float sx, const float sy) {
+	occluder_mesh occluder;
+	float world[16];
+
+	occluder.positions = WALL_POSITIONS;
+	occluder.vertex_count = 4;
+	occluder.indices = WALL_INDICES;
+	occluder.index_count = 6;
+
+	make_world(world, x, y, z, sx, sy, 1.0f);
+	multiply(world, view->view_projection, occluder.world_view_projection);
+
+	scene->occluders.push_back(occluder);
+}
+
+static void add_test_box(test_scene* scene, const camera* view, const float x, const float y, const float z, const float size) {
+	float world[16];
+	size_t offset;
+	uint32_t i;
+
+	for (i = 0; i < 3; i++) {
+		scene->box_mins.push_back(-1.0f);
+		scene->box_maxes.push_back(1.0f);
+	}
+
+	offset = scene->box_matrices.size();
+	scene->box_matrices.resize(offset + 16);
+
+	make_world(world, x, y, z, size, size, size);
+	multiply(world, view->view_projection, &(scene->box_matrices[offset]));
+}
+
+static void make_random_scene(test_scene* scene, camera* view, const uint32_t seed, const uint32_t occluders, const uint32_t boxes) {
+	mt19937 random(seed);
+	uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	uniform_real_distribution<float> size(0.2f, 3.0f);
+	float eye[3];
+	float target[3];
+	uint32_t i;
+
+	*scene = test_scene();
+
+	eye[0] = unit(random) * 10.0f;
+	eye[1] = unit(random) * 5.0f;
+	eye[2] = -20.0f + unit(random) * 5.0f;
+	target[0] = unit(random) * 2.0f;
+	target[1] = unit(random) * 2.0f;
+	target[2] = unit(random) * 2.0f;
+
+	make_camera(view, eye, target, (float)TEST_WIDTH / (float)TEST_HEIGHT);
+
+	for (i = 0; i < occluders; i++) {
+		add_box_occluder(
+			scene,
+			view,
+			unit(random) * 12.0f,
+			unit(random) * 8.0f,
+			unit(random) * 12.0f,
+			size(random),
+			size(random),
+			size(random)
+		);
+	}
+
+	for (i = 0; i < boxes; i++) {
+		add_test_box(scene, view, unit(random) * 15.0f, unit(random) * 10.0f, unit(random) * 20.0f, size(random) * 0.3f);
+	}
+}
+
+static void make_city(test_scene* scene, camera* view, const uint32_t buildings, const uint32_t boxes, const uint32_t seed) {
+	mt19937 random(seed);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+	float eye[3];
+	float target[3];
+	uint32_t side;
+	uint32_t i;
+
+	*scene = test_scene();
+
+	// Up on a roof at one corner, looking across the city.
+	eye[0] = -5.0f;
+	eye[1] = 12.0f;
+	eye[2] = -5.0f;
+	target[0] = 100.0f;
+	target[1] = 0.0f;
+	target[2] = 100.0f;
+
+	make_camera(view, eye, target, (float)TEST_WIDTH / (float)TEST_HEIGHT);
+
+	//
+	// A grid of blocks 4 units apart, each building a random height.
+	//
+
+	side = (uint32_t)sqrtf((float)buildings);
+
+	for (i = 0; i < buildings; i++) {
+		add_box_occluder(
+			scene,
+			view,
+			(float)(i % side) * 4.0f,
+			5.0f,
+			(float)(i / side) * 4.0f,
+			1.2f + unit(random) * 0.4f,
+			3.0f + unit(random) * 2.0f,
+			1.2f + unit(random) * 0.4f
+		);
+	}
+
+	// Things in the streets, and on the roofs.
+	for (i = 0; i < boxes; i++) {
+		add_test_box(
+			scene,
+			view,
+			unit(random) * side * 4.0f,
+			unit(random) * 12.0f,
+			unit(random) * side * 4.0f,
+			0.2f + unit(random) * 0.5f
+		);
+	}
+}
+
+static void reference_rasterize(const occlusion_buffer* buffer, const test_scene* scene, vector<float>* depth) {
+	const occluder_mesh* occluder;
+	const float* position;
+	float clip[4];
+	float screen[3][3];
+	float edges[3][3];
+	float plane[3];
+	float inverse_w;
+	float area;
+	float swap;
+	float d1[3];
+	float d2[3];
+	float px;
+	float py;
+	float z;
+	bool dropped;
+	uint32_t o;
+	uint32_t t;
+	uint32_t i;
+	uint32_t j;
+	uint32_t x;
+	uint32_t y;
+
+	depth->assign((size_t)buffer->width * buffer->height, 1.0f);
+
+	for (o = 0; o < scene->occluders.size(); o++) {
+		occluder = &(scene->occluders[o]);
+
+		for (t = 0; t < occluder->index_count / 3; t++) {
+			dropped = false;
+
+			for (i = 0; i < 3; i++) {
+				position = &(occluder->positions[occluder->indices[t * 3 + i] * 3]);
+
+				for (j = 0; j < 4; j++) {
+					clip[j] =
+						position[0] * occluder->world_view_projection[j] +
+						position[1] * occluder->world_view_projection[4 + j] +
+						position[2] * occluder->world_view_projection[8 + j] +
+						occluder->world_view_projection[12 + j];
+				}
+
+				dropped = dropped || clip[3] <= 1e-6f || clip[2] < 0.0f;
+
+				inverse_w = 1.0f / clip[3];
+				screen[i][0] = (clip[0] * inverse_w * 0.5f + 0.5f) * (float)buffer->width;
+				screen[i][1] = (0.5f - clip[1] * inverse_w * 0.5f) * (float)buffer->height;
+				screen[i][2] = clip[2] * inverse_w;
+			}
+
+			if (dropped) {
+				continue;
+			}
+
+			area =
+				(screen[1][0] - screen[0][0]) * (screen[2][1] - screen[0][1]) -
+				(screen[1][1] - screen[0][1]) * (screen[2][0] - screen[0][0]);
+
+			if (area == 0.0f || (area < 0.0f && buffer->cull_back_faces)) {
+				continue;
+			}
+
+			if (area < 0.0f) {
+				for (j = 0; j < 3; j++) {
+					swap = screen[1][j];
+					screen[1][j] = screen[2][j];
+					screen[2][j] = swap;
+				}
+
+				area = -area;
+			}
+
+			for (i = 0; i < 3; i++) {
+				edges[i][0] = screen[i][1] - screen[(i + 1) % 3][1];
+				edges[i][1] = screen[(i + 1) % 3][0] - screen[i][0];
+				edges[i][2] =
+					(screen[(i + 1) % 3][1] - screen[i][1]) * screen[i][0] -
+					(screen[(i + 1) % 3][0] - screen[i][0]) * screen[i][1];
+			}
+
+			for (j = 0; j < 3; j++) {
+				d1[j] = screen[1][j] - screen[0][j];
+				d2[j] = screen[2][j] - screen[0][j];
+			}
+
+			plane[0] = (d1[2] * d2[1] - d2[2] * d1[1]) / area;
+			plane[1] = (d2[2] * d1[0] - d1[2] * d2[0]) / area;
+			plane[2] = screen[0][2] - plane[0] * screen[0][0] - plane[1] * screen[0][1];
+
+			//
+			// Every pixel on the screen.
+			//
+
+			for (y = 0; y < buffer->height; y++) {
+				for (x = 0; x < buffer->width; x++) {
+					px = (float)x + 0.5f;
+					py = (float)y + 0.5f;
+
+					if (edges[0][0] * px + edges[0][1] * py + edges[0][2] >= 0.0f &&
+						edges[1][0] * px + edges[1][1] * py + edges[1][2] >= 0.0f &&
+						edges[2][0] * px + edges[2][1] * py + edges[2][2] >= 0.0f)
+					{
+						z = plane[0] * px + plane[1] * py + plane[2];
+						(*depth)[(size_t)y * buffer->width + x] = min((*depth)[(size_t)y * buffer->width + x], z);
+					}
+				}
+			}
+		}
+	}
+}
+
+static bool reference_is_visible(
+	const occlusion_buffer* buffer,
+	const vector<float>& depth,
+	const float box_min[3],
+	const float box_max[3],
+	const float matrix[16]
+) {
+	float corner[3];
+	float clip[4];
+	float min_x;
+	float min_y;
+	float max_x;
+	float max_y;
+	float nearest;
+	float x;
+	float y;
+	float inverse_w;
+	int32_t pixel_x;
+	int32_t pixel_y;
+	uint32_t i;
+	uint32_t j;
+
+	min_x = FLT_MAX;
+	min_y = FLT_MAX;
+	max_x = -FLT_MAX;
+	max_y = -FLT_MAX;
+	nearest = FLT_MAX;
+
+	for (i = 0; i < 8; i++) {
+		corner[0] = (i & 1) ? box_max[0] : box_min[0];
+		corner[1] = (i & 2) ? box_max[1] : box_min[1];
+		corner[2] = (i & 4) ? box_max[2] : box_min[2];
+
+		for (j = 0; j < 4; j++) {
+			clip[j] = corner[0] * matrix[j] + corner[1] * matrix[4 + j] + corner[2] * matrix[8 + j] + matrix[12 + j];
+		}
+
+		if (clip[3] <= 1e-6f || clip[2] < 0.0f) {
+			return true;
+		}
+
+		inverse_w = 1.0f / clip[3];
+		x = (clip[0] * inverse_w * 0.5f + 0.5f) * (float)buffer->width;
+		y = (0.5f - clip[1] * inverse_w * 0.5f) * (float)buffer->height;
+
+		min_x = min(min_x, x);
+		min_y = min(min_y, y);
+		max_x = max(max_x, x);
+		max_y = max(max_y, y);
+		nearest = min(nearest, clip[2] * inverse_w);
+	}
+
+	if (max_x < 0.0f || max_y < 0.0f || min_x >= (float)buffer->width || min_y >= (float)buffer->height) {
+		return true;
+	}
+
+	//
+	// Every pixel the rectangle touches.
+	//
+
+	for (pixel_y = 0; pixel_y < (int32_t)buffer->height; pixel_y++) {
+		for (pixel_x = 0; pixel_x < (int32_t)buffer->width; pixel_x++) {
+			if ((float)(pixel_x + 1) <= min_x || (float)pixel_x > max_x ||
+				(float)(pixel_y + 1) <= min_y || (float)pixel_y > max_y)
+			{
+				continue;
+			}
+
+			if (depth[(size_t)pixel_y * buffer->width + pixel_x] >= nearest) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static bool run_reference_check(job_system* system) {
+	occlusion_buffer* buffer;
+	test_scene scene;
+	camera view;
+	vector<float> reference;
+	uint32_t mismatches;
+	uint32_t covered;
+	uint32_t x;
+	uint32_t y;
+	uint32_t seed;
+	bool success;
+
+	printf("reference\n");
+	success = true;
+
+	buffer = new occlusion_buffer;
+	initialize_occlusion_buffer(buffer, TEST_WIDTH, TEST_HEIGHT);
+
+	mismatches = 0;
+	covered = 0;
+
+	for (seed = 0; seed < 8; seed++) {
+		make_random_scene(&scene, &view, seed, 40, 0);
+
+		// Half of them with every face.
+		buffer->cull_back_faces = seed % 2 == 0;
+
+		render_occluders(system, buffer, scene.occluders.data(), (uint32_t)scene.occluders.size());
+		reference_rasterize(buffer, &scene, &reference);
+
+		for (y = 0; y < buffer->height; y++) {
+			for (x = 0; x < buffer->width; x++) {
+				mismatches += get_occlusion_depth(buffer, x, y) != reference[(size_t)y * buffer->width + x] ? 1 : 0;
+				covered += reference[(size_t)y * buffer->width + x] < 1.0f ? 1 : 0;
+			}
+		}
+	}
+
+	success = check(covered > TEST_WIDTH * TEST_HEIGHT, "the scenes cover a good part of the screen") && success;
+	success = check(mismatches == 0, "every pixel matches the brute force rasterizer") && success;
+
+	delete buffer;
+
+	return success;
+}
+
+static bool run_query_check() {
+	occlusion_buffer* buffer;
+	test_scene scene;
+	camera view;
+	vector<float> reference;
+	uint32_t mismatches;
+	uint32_t hidden;
+	uint32_t count;
+	uint32_t seed;
+	uint32_t i;
+	bool visible;
+	bool success;
+
+	printf("queries\n");
+	success = true;
+
+	buffer = new occlusion_buffer;
+	initialize_occlusion_buffer(buffer, TEST_WIDTH, TEST_HEIGHT);
+
+	mismatches = 0;
+	hidden = 0;
+	count = 0;
+
+	for (seed = 100; seed < 106; seed++) {
+		make_random_scene(&scene, &view, seed, 60, 2000);
+
+		render_occluders(NULL, buffer, scene.occluders.data(), (uint32_t)scene.occluders.size());
+		reference_rasterize(buffer, &scene, &reference);
+
+		for (i = 0; i < scene.box_matrices.size() / 16; i++) {
+			visible = is_box_visible(buffer, &(scene.box_mins[i * 3]), &(scene.box_maxes[i * 3]), &(scene.box_matrices[i * 16]));
+
+			mismatches += visible != reference_is_visible(
+				buffer,
+				reference,
+				&(scene.box_mins[i * 3]),
+				&(scene.box_maxes[i * 3]),
+				&(scene.box_matrices[i * 16])
+			) ? 1 : 0;
+
+			hidden += visible ? 0 : 1;
+			count++;
+		}
+	}
+
+	printf("  (%u of %u boxes hidden)\n", hidden, count);
+	success = check(hidden > count / 20 && hidden < count, "some boxes are hidden and some aren't") && success;
+	success = check(mismatches == 0, "every box gets the brute force answer") && success;
+
+	delete buffer;
+
+	return success;
+}
+
+static bool run_hiz_check() {
+	occlusion_buffer* buffer;
+	test_scene scene;
+	camera view;
+	float farthest;
+	uint32_t size;
+	uint32_t level;
+	uint32_t tx;
+	uint32_t ty;
+	uint32_t x;
+	uint32_t y;
+	bool right;
+	bool success;
+
+	printf("hiz\n");
+	success = true;
+
+	buffer = new occlusion_buffer;
+
+	// Not a power of two, so some texels only have some children.
+	initialize_occlusion_buffer(buffer, 300, 100);
+	success = check(buffer->width == 304 && buffer->height == 104, "sizes round up to whole tiles") && success;
+	success = check(buffer->hiz_widths.back() == 1 && buffer->hiz_heights.back() == 1, "the last level is one texel") && success;
+
+	make_random_scene(&scene, &view, 7, 50, 0);
+	render_occluders(NULL, buffer, scene.occluders.data(), (uint32_t)scene.occluders.size());
+
+	right = true;
+
+	for (level = 0; level < buffer->hiz_offsets.size(); level++) {
+		size = OCCLUSION_TILE_SIZE << level;
+
+		for (ty = 0; ty < buffer->hiz_heights[level]; ty++) {
+			for (tx = 0; tx < buffer->hiz_widths[level]; tx++) {
+				farthest = 0.0f;
+
+				for (y = ty * size; y < min((ty + 1) * size, buffer->height); y++) {
+					for (x = tx * size; x < min((tx + 1) * size, buffer->width); x++) {
+						farthest = max(farthest, get_occlusion_depth(buffer, x, y));
+					}
+				}
+
+				right = right && buffer->hiz[buffer->hiz_offsets[level] + ty * buffer->hiz_widths[level] + tx] == farthest;
+			}
+		}
+	}
+
+	success = check(right, "every texel is the farthest depth under it") && success;
+
+	delete buffer;
+
+	return success;
+}
+
+static bool run_case_check() {
+	occlusion_buffer* buffer;
+	test_scene scene;
+	camera view;
+	float eye[3];
+	float target[3];
+	float box_min[3];
+	float box_max[3];
+	float world[16];
+	float matrix[16];
+	bool success;
+
+	printf("cases\n");
+	success = true;
+
+	buffer = new occlusion_buffer;
+	initialize_occlusion_buffer(buffer, TEST_WIDTH, TEST_HEIGHT);
+
+	//
+	// A wall 4 x 4 at z = 0, seen from 10 units in front of it.
+	//
+
+	eye[0] = 0.0f;
+	eye[1] = 0.0f;
+	eye[2] = -10.0f;
+	target[0] = 0.0f;
+	target[1] = 0.0f;
+	target[2] = 0.0f;
+	make_camera(&view, eye, target, (float)TEST_WIDTH / (float)TEST_HEIGHT);
+
+	scene = test_scene();
+	add_wall_occluder(&scene, &view, 0.0f, 0.0f, 0.0f, 2.0f, 2.0f);
+	render_occluders(NULL, buffer, scene.occluders.data(), 1);
+
+	success = check(buffer->stats.rasterized == 2, "the wall is drawn") && success;
+
+	box_min[0] = -1.0f;
+	box_min[1] = -1.0f;
+	box_min[2] = -1.0f;
+	box_max[0] = 1.0f;
+	box_max[1] = 1.0f;
+	box_max[2] = 1.0f;
+
+	make_world(world, 0.0f, 0.0f, 3.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(!is_box_visible(buffer, box_min, box_max, matrix), "a box behind the wall is hidden") && success;
+
+	make_world(world, 0.0f, 0.0f, -3.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "a box in front of it isn't") && success;
+
+	make_world(world, 0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "nor is one through it") && success;
+
+	make_world(world, 6.0f, 0.0f, 3.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "nor one beside it") && success;
+
+	make_world(world, 2.2f, 0.0f, 3.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "nor one poking out past its edge") && success;
+
+	make_world(world, 0.0f, 0.0f, 40.0f, 16.0f, 16.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "nor a big one far behind it") && success;
+
+	make_world(world, 0.0f, 0.0f, -10.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "nor one around the camera") && success;
+
+	make_world(world, 0.0f, 0.0f, -20.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "nor one behind the camera") && success;
+
+	make_world(world, 100.0f, 0.0f, 3.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(is_box_visible(buffer, box_min, box_max, matrix), "nor one off the screen") && success;
+
+	//
+	// From behind, the wall faces away.
+	//
+
+	eye[2] = 10.0f;
+	make_camera(&view, eye, target, (float)TEST_WIDTH / (float)TEST_HEIGHT);
+
+	scene = test_scene();
+	add_wall_occluder(&scene, &view, 0.0f, 0.0f, 0.0f, 2.0f, 2.0f);
+
+	render_occluders(NULL, buffer, scene.occluders.data(), 1);
+	success = check(buffer->stats.back_facing == 2 && buffer->stats.rasterized == 0, "a wall facing away is skipped") && success;
+
+	buffer->cull_back_faces = false;
+	render_occluders(NULL, buffer, scene.occluders.data(), 1);
+	success = check(buffer->stats.rasterized == 2, "unless back faces are drawn") && success;
+
+	make_world(world, 0.0f, 0.0f, -3.0f, 1.0f, 1.0f, 1.0f);
+	multiply(world, view.view_projection, matrix);
+	success = check(!is_box_visible(buffer, box_min, box_max, matrix), "and then it hides things") && success;
+
+	buffer->cull_back_faces = true;
+
+	//
+	// A closed box, seen from off to one side, shows three faces.
+	//
+
+	eye[0] = 6.0f;
+	eye[1] = 5.0f;
+	eye[2] = -8.0f;
+	make_camera(&view, eye, target, (float)TEST_WIDTH / (float)TEST_HEIGHT);
+
+	scene = test_scene();
+	add_box_occluder(&scene, &view, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+	render_occluders(NULL, buffer, scene.occluders.data(), 1);
+	success = check(buffer->stats.back_facing == 6 && buffer->stats.rasterized == 6, "a cube's back faces are the far ones") && success;
+
+	//
+	// A wall right up against the camera.
+	//
+
+	eye[0] = 0.0f;
+	eye[1] = 0.0f;
+	eye[2] = -0.05f;
+	make_camera(&view, eye, target, (float)TEST_WIDTH / (float)TEST_HEIGHT);
+
+	scene = test_scene();
+	add_wall_occluder(&scene, &view, 0.0f, 0.0f, 0.0f, 2.0f, 2.0f);
+	render_occluders(NULL, buffer, scene.occluders.data(), 1);
+	success = check(buffer->stats.near_clipped == 2 && buffer->stats.rasterized == 0, "triangles crossing the near plane are dropped") && success;
+
+	delete buffer;
+
+	return success;
+}
+
+static bool run_parallel_check(job_system* system) {
+	occlusion_buffer* serial;
+	occlusion_buffer* parallel;
+	test_scene scene;
+	camera view;
+	vector<uint8_t> serial_visible;
+	vector<uint8_t> parallel_visible;
+	bool depth_matches;
+	bool hiz_matches;
+	bool tests_match;
+	bool chunked;
+	uint32_t count;
+	uint32_t i;
+
+	printf("parallel\n");
+
+	serial = new occlusion_buffer;
+	parallel = new occlusion_buffer;
+	initialize_occlusion_buffer(serial, TEST_WIDTH, TEST_HEIGHT);
+	initialize_occlusion_buffer(parallel, TEST_WIDTH, TEST_HEIGHT);
+
+	// Enough triangles for every chunk.
+	make_city(&scene, &view, 8000, 20000, 5);
+
+	render_occluders(NULL, serial, scene.occluders.data(), (uint32_t)scene.occluders.size());
+	render_occluders(system, parallel, scene.occluders.data(), (uint32_t)scene.occluders.size());
+
+	depth_matches = serial->depth == parallel->depth;
+	hiz_matches = serial->hiz == parallel->hiz;
+
+	count = (uint32_t)scene.box_matrices.size() / 16;
+	serial_visible.resize(count);
+	parallel_visible.resize(count);
+
+	for (i = 0; i < count; i++) {
+		serial_visible[i] = is_box_visible(serial, &(scene.box_mins[i * 3]), &(scene.box_maxes[i * 3]), &(scene.box_matrices[i * 16])) ? 1 : 0;
+	}
+
+	test_occlusion(system, parallel, scene.box_mins.data(), scene.box_maxes.data(), scene.box_matrices.data(), count, parallel_visible.data());
+	tests_match = serial_visible == parallel_visible;
+
+	chunked = parallel->chunk_count == MAX_OCCLUSION_CHUNKS;
+
+	check(chunked, "the occluders are cut into every chunk");
+	check(depth_matches, "the job system draws the same depth as one thread");
+	check(hiz_matches, "and the same hierarchical Z");
+	check(tests_match, "testing boxes on it gives the same answers");
+
+	delete serial;
+	delete parallel;
+
+	return chunked && depth_matches && hiz_matches && tests_match;
+}
@@ -0,0 +1,209 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Measures how much a PROFILE_ZONE costs, and writes an example Chrome
+	trace so the export can be checked in chrome://tracing or
+	ui.perfetto.dev.
+
+	The cost is measured by timing a loop of empty zones, and comparing
+	it against the same loop with the profiler turned off. We want a
+	zone to cost less than 50ns. Each thread has its own ring, so the
+	cost doesn't depend on how many threads are recording.
+
+	A zone has to read the clock twice, and on some machines (virtual
+	machines especially) a clock read alone is 20-30ns. So we also time
+	a clock read, and a zone passes if it costs no more than two of them
+	plus ZONE_BOOKKEEPING_NS for everything else. The output says which
+	of the two it was held to.
+
+	Pass --quick to time a tenth as many zones, and -o to say where the
+	trace goes (profile_trace.json if not).
+
+	Usage:
+		profiler_bench [--quick] [-o <trace.json>]
+*/
+
+#include "profiler.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const uint32_t ZONE_COUNT = 10000000;
+const double TARGET_NS_PER_ZONE = 50.0;
+// What a zone may cost on top of its two clock reads: finding the
+// thread's track and writing the event.
+const double ZONE_BOOKKEEPING_NS = 15.0;
+
+static double time_zones(const bool enabled, const uint32_t zone_count);
+static double time_clock_reads(const uint32_t read_count);
+static void simulate_frame(const uint32_t frame);
+static void busy_wait_us(const uint64_t us);
+
+int main(int argc, char** argv) {
+	profiler* prof;
+	double enabled_ns;
+	double disabled_ns;
+	double clock_ns;
+	double allowed_ns;
+	bool passed;
+	const char* trace_path;
+	uint32_t zone_count;
+	uint32_t frame;
+	int i;
+
+	prof = get_profiler();
+	trace_path = "profile_trace.json";
+	zone_count = ZONE_COUNT;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			zone_count = ZONE_COUNT / 10;
+		} else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			trace_path = argv[++i];
+		} else {
+			printf("usage: profiler_bench [--quick] [-o <trace.json>]\n");
+			return 1;
+		}
+	}
+
+	//
+	// First the overhead.
+	//
+
+	clock_ns = time_clock_reads(zone_count);
+	disabled_ns = time_zones(false, zone_count);
+	enabled_ns = time_zones(true, zone_count);
+
+	// Throw away everything the timing loops recorded.
+	collect_profile_frame(prof);
+	prof->zones.clear();
+	prof->dropped_events = 0;
+
+	printf("Zone cost: %.1fns enabled, %.1fns disabled (target < %.0fns), %.3fns per tick\n",
+		enabled_ns, disabled_ns, TARGET_NS_PER_ZONE, prof->ns_per_tick);
+	printf("Clock read: %.1fns\n", clock_ns);
+
+	allowed_ns = 2.0 * clock_ns + ZONE_BOOKKEEPING_NS;
+
+	if (enabled_ns < TARGET_NS_PER_ZONE) {
+		printf("  ok: under the %.0fns target\n", TARGET_NS_PER_ZONE);
+		passed = true;
+	} else if (enabled_ns <= allowed_ns) {
+		printf("  ok: over the %.0fns target, but this machine's clock is slow; within two clock reads + %.0fns (%.1fns)\n",
+			TARGET_NS_PER_ZONE, ZONE_BOOKKEEPING_NS, allowed_ns);
+		passed = true;
+	} else {
+		printf("  FAIL: over the %.0fns target, and over two clock reads + %.0fns (%.1fns)\n",
+			TARGET_NS_PER_ZONE, ZONE_BOOKKEEPING_NS, allowed_ns);
+		passed = false;
+	}
+
+	//
+	// Then a few made up frames, captured and exported.
+	//
+
+	set_profile_thread_name("Main thread");
+	start_profile_capture(prof, 10);
+
+	for (frame = 0; frame < 10; frame++) {
+		simulate_frame(frame);
+
+		if (collect_profile_frame(prof)) {
+			if (!write_chrome_trace(prof, trace_path)) {
+				printf("Couldn't write %s\n", trace_path);
+				return 1;
+			}
+
+			printf("Wrote %zu events to %s\n", prof->capture.size(), trace_path);
+		}
+	}
+
+	printf("%s", get_profile_report(prof).c_str());
+
+	return passed ? 0 : 1;
+}
+
+static double time_zones(const bool enabled, const uint32_t zone_count) {
+	uint64_t start_ns;
+	uint64_t end_ns;
+	uint32_t i;
+
+	get_profiler()->enabled = enabled;
+
+	start_ns = profile_now_ns();
+
+	for (i = 0; i < zone_count; i++) {
+		PROFILE_ZONE("empty zone");
+	}
+
+	end_ns = profile_now_ns();
+
+	get_profiler()->enabled = true;
+
+	return (double)(end_ns - start_ns) / (double)zone_count;
+}
+
+static double time_clock_reads(const uint32_t read_count) {
+	uint64_t start_ns;
+	uint64_t end_ns;
+	uint64_t sum;
+	uint32_t i;
+
+	sum = 0;
+	start_ns = profile_now_ns();
+
+	for (i = 0; i < read_count; i++) {
+		sum += profile_now();
+	}
+
+	end_ns = profile_now_ns();
+
+	// Keeps the reads from being optimized away.
+	if (sum == 0) {
+		printf("\n");
+	}
+
+	return (double)(end_ns - start_ns) / (double)read_count;
+}
+
+static void simulate_frame(const uint32_t frame) {
+	vector<thread> workers;
+	uint32_t i;
+
+	PROFILE_ZONE("frame");
+
+	{
+		PROFILE_ZONE("update");
+		busy_wait_us(500 + (frame % 3) * 100);
+	}
+
+	{
+		PROFILE_ZONE("render");
+
+		for (i = 0; i < 3; i++) {
+			workers.push_back(thread([i]() {
+				PROFILE_ZONE("record commands");
+				busy_wait_us(300 + i * 50);
+			}));
+		}
+
+		for (i = 0; i < workers.size(); i++) {
+			workers[i].join();
+		}
+
+		PROFILE_ZONE("present");
+		busy_wait_us(200);
+	}
+}
+
+static void busy_wait_us(const uint64_t us) {
+	uint64_t end_ns;
+
+	end_ns = profile_now_ns() + us * 1000;
+	while (profile_now_ns() < end_ns) {
+	}
+}
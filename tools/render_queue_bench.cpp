@@ -0,0 +1,512 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the render queue's sort keys and radix sort, then measures
+	the sort and what it saves.
+
+	Checks:
+		keys        Fields come back out as they went in, and compare
+		            in the right order: layer, then pass, then state.
+		            Opaque draws go front to back, transparent ones
+		            back to front.
+		sort        The radix sort matches std::stable_sort, on one
+		            thread and on the job system, for a range of sizes,
+		            including keys that are all the same.
+		state       Only pipeline and material changes are reported, and
+		            the queue's counts match count_render_state_changes.
+		capacity    Items past max_items are dropped and counted, and
+		            sorting never reallocates.
+
+	Benchmark:
+		A million draws from a made up scene (a few layers, 32
+		pipelines, 1024 materials, a fifth of them transparent), added
+		in a random order. Prints how many state changes that order
+		would need and how many the sorted one does, then times
+		std::sort, the radix sort on one thread, and the radix sort with
+		1, 2, 4... workers up to one per core.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		render_queue_bench [--quick]
+*/
+
+#include "job_system.h"
+#include "render_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const uint32_t BENCH_ITEMS = 1 << 20;
+const uint32_t BENCH_LAYERS = 3;
+const uint32_t BENCH_PIPELINES = 32;
+const uint32_t BENCH_MATERIALS = 1024;
+const uint32_t BENCH_RUNS = 5;
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static bool compare_items(const render_item& a, const render_item& b);
+static void make_scene(vector<render_item>* items, const uint32_t count, const uint32_t seed);
+static void fill_queue(render_queue* queue, const vector<render_item>& items);
+
+static bool run_key_check();
+static bool run_sort_check(job_system* system);
+static bool run_state_check(job_system* system);
+static bool run_capacity_check(job_system* system);
+
+// Best of BENCH_RUNS.
+static double time_std_sort(const vector<render_item>& items);
+static double time_radix_sort(render_queue* queue, const vector<render_item>& items, job_system* system);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	render_queue* queue;
+	vector<render_item> scene;
+	uint32_t cores;
+	uint32_t workers;
+	uint32_t pipeline_changes;
+	uint32_t material_changes;
+	double std_time;
+	double serial_time;
+	double one_worker;
+	double parallel_time;
+	bool quick;
+	bool success;
+	uint32_t i;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	system = new job_system;
+	initialize_job_system(system, cores < 4 ? 4 : cores, false);
+
+	success = true;
+	success = run_key_check() && success;
+	success = run_sort_check(system) && success;
+	success = run_state_check(system) && success;
+	success = run_capacity_check(system) && success;
+
+	shutdown_job_system(system);
+	delete system;
+
+	if (quick) {
+		printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+		return success ? 0 : 1;
+	}
+
+	//
+	// Benchmark.
+	//
+
+	queue = new render_queue;
+	initialize_render_queue(queue, BENCH_ITEMS);
+	make_scene(&scene, BENCH_ITEMS, 1234);
+
+	printf("\n%u draws, %u layers, %u pipelines, %u materials\n",
+		BENCH_ITEMS, BENCH_LAYERS, BENCH_PIPELINES, BENCH_MATERIALS);
+
+	count_render_state_changes(scene.data(), BENCH_ITEMS, &pipeline_changes, &material_changes);
+	printf("  as added:  %7u pipeline changes, %7u material changes\n", pipeline_changes, material_changes);
+
+	fill_queue(queue, scene);
+	sort_render_queue(queue, NULL);
+	for (i = 0; i < BENCH_ITEMS; i++) {
+		get_render_state_changes(queue, i);
+	}
+	printf("  sorted:    %7u pipeline changes, %7u material changes (%u sort passes)\n",
+		queue->pipeline_changes, queue->material_changes, queue->sort_passes);
+
+	std_time = time_std_sort(scene);
+	serial_time = time_radix_sort(queue, scene, NULL);
+
+	printf("\n%u cores\n", cores);
+	printf("std::sort          %7.2fms\n", std_time * 1000.0);
+	printf("radix, one thread  %7.2fms (%4.2fx std::sort)\n", serial_time * 1000.0, std_time / serial_time);
+	printf("workers  radix\n");
+
+	one_worker = 0.0;
+
+	for (workers = 1; ; workers *= 2) {
+		if (workers > cores) {
+			workers = cores;
+		}
+
+		system = new job_system;
+		initialize_job_system(system, workers, true);
+
+		parallel_time = time_radix_sort(queue, scene, system);
+		if (workers == 1) {
+			one_worker = parallel_time;
+		}
+
+		printf("%7u  %7.2fms (%4.2fx)\n", workers, parallel_time * 1000.0, one_worker / parallel_time);
+
+		shutdown_job_system(system);
+		delete system;
+
+		if (workers == cores) {
+			break;
+		}
+	}
+
+	delete queue;
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool compare_items(const render_item& a, const render_item& b) {
+	return a.key < b.key;
+}
+
+static void make_scene(vector<render_item>* items, const uint32_t count, const uint32_t seed) {
+	mt19937 random(seed);
+	uint32_t pass;
+	uint32_t i;
+
+	items->resize(count);
+
+	for (i = 0; i < count; i++) {
+		pass = random() % 5 == 0 ? RENDER_PASS_TRANSPARENT : RENDER_PASS_OPAQUE;
+
+		(*items)[i].key = make_render_key(
+			random() % BENCH_LAYERS,
+			pass,
+			random() % BENCH_PIPELINES,
+			random() % BENCH_MATERIALS,
+			0.1f + (float)(random() % 100000) * 0.01f
+		);
+		(*items)[i].draw = i;
+	}
+}
+
+static void fill_queue(render_queue* queue, const vector<render_item>& items) {
+	size_t i;
+
+	reset_render_queue(queue);
+
+	for (i = 0; i < items.size(); i++) {
+		add_render_item(queue, items[i].key, items[i].draw);
+	}
+}
+
+static bool run_key_check() {
+	uint64_t key;
+	uint64_t near_key;
+	uint64_t far_key;
+	bool success;
+
+	printf("keys\n");
+	success = true;
+
+	key = make_render_key(5, RENDER_PASS_OPAQUE, 300, 70000, 12.5f);
+	success = check(
+		get_render_key_layer(key) == 5 &&
+		get_render_key_pass(key) == RENDER_PASS_OPAQUE &&
+		get_render_key_pipeline(key) == 300 &&
+		get_render_key_material(key) == 70000,
+		"opaque fields come back out"
+	) && success;
+
+	key = make_render_key(5, RENDER_PASS_TRANSPARENT, 300, 70000, 12.5f);
+	success = check(
+		get_render_key_layer(key) == 5 &&
+		get_render_key_pass(key) == RENDER_PASS_TRANSPARENT &&
+		get_render_key_pipeline(key) == 300 &&
+		get_render_key_material(key) == 70000,
+		"transparent fields come back out"
+	) && success;
+
+	success = check(
+		get_render_key_depth(make_render_key(0, RENDER_PASS_OPAQUE, 0, 0, 2.0f)) ==
+		get_render_key_depth(make_render_key(0, RENDER_PASS_TRANSPARENT, 0, 0, 2.0f)),
+		"depth reads back the same in either pass"
+	) && success;
+
+	success = check(
+		make_render_key(1, RENDER_PASS_OPAQUE, 0, 0, 1.0f) >
+		make_render_key(0, RENDER_PASS_TRANSPARENT, 4095, 1048575, 1000.0f),
+		"layer comes first"
+	) && success;
+
+	success = check(
+		make_render_key(0, RENDER_PASS_TRANSPARENT, 0, 0, 1.0f) >
+		make_render_key(0, RENDER_PASS_OPAQUE, 4095, 1048575, 1000.0f),
+		"transparent after opaque"
+	) && success;
+
+	success = check(
+		make_render_key(0, RENDER_PASS_OPAQUE, 2, 0, 1.0f) >
+		make_render_key(0, RENDER_PASS_OPAQUE, 1, 1048575, 1000.0f),
+		"opaque: pipeline before material"
+	) && success;
+
+	success = check(
+		make_render_key(0, RENDER_PASS_OPAQUE, 1, 2, 1.0f) >
+		make_render_key(0, RENDER_PASS_OPAQUE, 1, 1, 1000.0f),
+		"opaque: material before depth"
+	) && success;
+
+	near_key = make_render_key(0, RENDER_PASS_OPAQUE, 1, 1, 1.0f);
+	far_key = make_render_key(0, RENDER_PASS_OPAQUE, 1, 1, 1.001f);
+	success = check(near_key < far_key, "opaque: front to back, even when close") && success;
+
+	near_key = make_render_key(0, RENDER_PASS_TRANSPARENT, 0, 0, 1.0f);
+	far_key = make_render_key(0, RENDER_PASS_TRANSPARENT, 4095, 1048575, 1.001f);
+	success = check(far_key < near_key, "transparent: back to front, before state") && success;
+
+	success = check(
+		get_render_key_depth(make_render_key(0, RENDER_PASS_OPAQUE, 0, 0, -3.0f)) == 0 &&
+		get_render_key_depth(make_render_key(0, RENDER_PASS_OPAQUE, 0, 0, 0.0f)) == 0,
+		"behind the camera is depth zero"
+	) && success;
+
+	success = check(
+		get_render_key_depth(make_render_key(0, RENDER_PASS_OPAQUE, 0, 0, 1e30f)) <
+		get_render_key_depth(make_render_key(0, RENDER_PASS_OPAQUE, 0, 0, 1e38f)),
+		"huge depths still order"
+	) && success;
+
+	return success;
+}
+
+static bool run_sort_check(job_system* system) {
+	const uint32_t sizes[] = { 0, 1, 2, 3, 100, 5000, RENDER_SORT_PARALLEL_MIN, 200003 };
+	render_queue queue;
+	vector<render_item> items;
+	vector<render_item> expected;
+	mt19937 random(99);
+	bool serial_matches;
+	bool parallel_matches;
+	bool same_key_matches;
+	bool stable_matches;
+	uint32_t pass_count;
+	size_t s;
+	uint32_t i;
+
+	printf("sort\n");
+
+	initialize_render_queue(&queue, 200003);
+
+	serial_matches = true;
+	parallel_matches = true;
+
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		make_scene(&items, sizes[s], (uint32_t)s);
+		expected = items;
+		stable_sort(expected.begin(), expected.end(), compare_items);
+
+		fill_queue(&queue, items);
+		sort_render_queue(&queue, NULL);
+		for (i = 0; i < sizes[s]; i++) {
+			if (queue.items[i].key != expected[i].key || queue.items[i].draw != expected[i].draw) {
+				serial_matches = false;
+				break;
+			}
+		}
+
+		fill_queue(&queue, items);
+		sort_render_queue(&queue, system);
+		for (i = 0; i < sizes[s]; i++) {
+			if (queue.items[i].key != expected[i].key || queue.items[i].draw != expected[i].draw) {
+				parallel_matches = false;
+				break;
+			}
+		}
+	}
+
+	check(serial_matches, "one thread matches std::stable_sort");
+	check(parallel_matches, "job system matches std::stable_sort");
+
+	//
+	// Every key the same: every pass is skipped, and nothing moves.
+	//
+
+	items.resize(100000);
+	for (i = 0; i < items.size(); i++) {
+		items[i].key = make_render_key(2, RENDER_PASS_OPAQUE, 7, 9, 4.0f);
+		items[i].draw = i;
+	}
+
+	fill_queue(&queue, items);
+	sort_render_queue(&queue, system);
+	same_key_matches = queue.sort_passes == 0;
+	for (i = 0; i < items.size(); i++) {
+		same_key_matches = same_key_matches && queue.items[i].draw == i;
+	}
+	check(same_key_matches, "keys that are all the same take no passes");
+
+	//
+	// Lots of equal keys, in a few groups: each group stays in the
+	// order it was added.
+	//
+
+	for (i = 0; i < items.size(); i++) {
+		items[i].key = make_render_key(0, RENDER_PASS_OPAQUE, random() % 4, random() % 4, 4.0f);
+		items[i].draw = i;
+	}
+
+	expected = items;
+	stable_sort(expected.begin(), expected.end(), compare_items);
+
+	fill_queue(&queue, items);
+	sort_render_queue(&queue, system);
+	stable_matches = true;
+	for (i = 0; i < items.size(); i++) {
+		stable_matches = stable_matches && queue.items[i].draw == expected[i].draw;
+	}
+	pass_count = queue.sort_passes;
+	check(stable_matches, "equal keys stay in the order they were added");
+	check(pass_count == 2, "only the bytes that differ are sorted");
+
+	return serial_matches && parallel_matches && same_key_matches && stable_matches && pass_count == 2;
+}
+
+static bool run_state_check(job_system* system) {
+	render_queue queue;
+	vector<render_item> items;
+	uint32_t changes[4];
+	uint32_t pipeline_changes;
+	uint32_t material_changes;
+	bool counts_match;
+	uint32_t i;
+	bool success;
+
+	printf("state\n");
+	success = true;
+
+	initialize_render_queue(&queue, 100000);
+
+	add_render_item(&queue, make_render_key(0, RENDER_PASS_OPAQUE, 1, 1, 5.0f), 0);
+	add_render_item(&queue, make_render_key(0, RENDER_PASS_OPAQUE, 1, 1, 2.0f), 1);
+	add_render_item(&queue, make_render_key(0, RENDER_PASS_OPAQUE, 1, 2, 2.0f), 2);
+	add_render_item(&queue, make_render_key(0, RENDER_PASS_OPAQUE, 3, 2, 1.0f), 3);
+	sort_render_queue(&queue, NULL);
+
+	for (i = 0; i < 4; i++) {
+		changes[i] = get_render_state_changes(&queue, i);
+	}
+
+	success = check(
+		queue.items[0].draw == 1 && queue.items[1].draw == 0,
+		"same state goes front to back"
+	) && success;
+	success = check(
+		changes[0] == (RENDER_STATE_PIPELINE | RENDER_STATE_MATERIAL),
+		"the first draw sets everything"
+	) && success;
+	success = check(changes[1] == 0, "a different depth alone sets nothing") && success;
+	success = check(changes[2] == RENDER_STATE_MATERIAL, "a new material sets just that") && success;
+	success = check(changes[3] == RENDER_STATE_PIPELINE, "a new pipeline sets just that") && success;
+
+	make_scene(&items, 100000, 7);
+	fill_queue(&queue, items);
+	sort_render_queue(&queue, system);
+	for (i = 0; i < items.size(); i++) {
+		get_render_state_changes(&queue, i);
+	}
+	count_render_state_changes(queue.items.data(), (uint32_t)queue.items.size(), &pipeline_changes, &material_changes);
+	counts_match = pipeline_changes == queue.pipeline_changes && material_changes == queue.material_changes;
+	success = check(counts_match, "the queue counts what it returns") && success;
+
+	count_render_state_changes(items.data(), (uint32_t)items.size(), &pipeline_changes, &material_changes);
+	success = check(
+		queue.pipeline_changes < pipeline_changes && queue.material_changes < material_changes,
+		"sorting cuts the state changes"
+	) && success;
+
+	return success;
+}
+
+static bool run_capacity_check(job_system* system) {
+	render_queue queue;
+	vector<render_item> items;
+	const render_item* buffers[2];
+	bool kept;
+	bool success;
+	uint32_t frame;
+
+	printf("capacity\n");
+	success = true;
+
+	initialize_render_queue(&queue, RENDER_SORT_PARALLEL_MIN * 2);
+	buffers[0] = queue.items.data();
+	buffers[1] = queue.scratch.data();
+
+	make_scene(&items, RENDER_SORT_PARALLEL_MIN * 2 + 10, 3);
+	fill_queue(&queue, items);
+	success = check(
+		queue.items.size() == RENDER_SORT_PARALLEL_MIN * 2 && queue.dropped == 10,
+		"items past max_items are dropped and counted"
+	) && success;
+
+	kept = true;
+	for (frame = 0; frame < 5; frame++) {
+		fill_queue(&queue, items);
+		sort_render_queue(&queue, frame % 2 ? system : NULL);
+
+		kept = kept &&
+			(queue.items.data() == buffers[0] || queue.items.data() == buffers[1]) &&
+			(queue.scratch.data() == buffers[0] || queue.scratch.data() == buffers[1]);
+	}
+	success = check(kept, "sorting never reallocates") && success;
+
+	return success;
+}
+
+static double time_std_sort(const vector<render_item>& items) {
+	vector<render_item> sorted;
+	double best;
+	double start;
+	uint32_t run;
+
+	best = 1e9;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		sorted = items;
+
+		start = now_seconds();
+		sort(sorted.begin(), sorted.end(), compare_items);
+		best = min(best, now_seconds() - start);
+	}
+
+	return best;
+}
+
+static double time_radix_sort(render_queue* queue, const vector<render_item>& items, job_system* system) {
+	double best;
+	double start;
+	uint32_t run;
+
+	best = 1e9;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		fill_queue(queue, items);
+
+		start = now_seconds();
+		sort_render_queue(queue, system);
+		best = min(best, now_seconds() - start);
+	}
+
+	return best;
+}
@@ -0,0 +1,314 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Stress tests and benchmarks the render ring, with a real producer
+	and consumer thread:
+
+		stress       Millions of packets of random sizes. Every packet
+		             must arrive once, in order, with its data intact,
+		             and the producer must never get more than the
+		             allowed number of frames ahead.
+		drop         A small ring that drops packets when full, with a
+		             consumer that keeps stalling. Every packet is either
+		             received in order or counted as dropped.
+		throughput   Packets a second for a few packet sizes.
+
+	Usage:
+		render_ring_bench [packet count]
+*/
+
+#include "render_ring.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+const uint32_t PACKET_DATA = 1;
+const uint32_t PACKET_END_FRAME = 2;
+const uint32_t PACKET_QUIT = 3;
+
+const uint32_t PACKETS_PER_FRAME = 100;
+const uint32_t MAX_QUEUED_FRAMES = 3;
+
+struct consumer_result {
+	uint64_t received;
+	uint64_t out_of_order;
+	uint64_t corrupt;
+	uint64_t too_far_ahead;
+};
+
+static bool check(const bool condition, const char* message);
+static void fill_packet(uint8_t* data, const uint32_t size, const uint64_t sequence);
+static bool verify_packet(const uint8_t* data, const uint32_t size, const uint64_t sequence);
+static void run_consumer(
+	render_ring* ring,
+	const bool allow_gaps,
+	const bool stall,
+	const bool verify,
+	consumer_result* result
+);
+
+static bool run_stress(const uint64_t packet_count);
+static bool run_drop(const uint64_t packet_count);
+static void run_throughput(const uint64_t packet_count, const uint32_t size);
+
+// Too big for the stack.
+static render_ring ring;
+
+int main(int argc, char** argv) {
+	uint64_t packet_count;
+	bool success;
+
+	packet_count = 2000000;
+	if (argc > 1) {
+		packet_count = strtoull(argv[1], NULL, 10);
+	}
+
+	success = true;
+	success = run_stress(packet_count) && success;
+	success = run_drop(packet_count / 10) && success;
+
+	run_throughput(packet_count, 16);
+	run_throughput(packet_count, 64);
+	run_throughput(packet_count, 256);
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	if (!condition) {
+		printf("  FAILED: %s\n", message);
+	}
+
+	return condition;
+}
+
+static void fill_packet(uint8_t* data, const uint32_t size, const uint64_t sequence) {
+	uint32_t i;
+
+	memcpy(data, &sequence, sizeof(sequence));
+
+	for (i = sizeof(sequence); i < size; i++) {
+		data[i] = (uint8_t)(sequence + i);
+	}
+}
+
+static bool verify_packet(const uint8_t* data, const uint32_t size, const uint64_t sequence) {
+	uint32_t i;
+
+	for (i = sizeof(sequence); i < size; i++) {
+		if (data[i] != (uint8_t)(sequence + i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void run_consumer(
+	render_ring* ring,
+	const bool allow_gaps,
+	const bool stall,
+	const bool verify,
+	consumer_result* result
+) {
+	const render_packet_header* header;
+	const uint8_t* data;
+	uint64_t sequence;
+	uint64_t expected;
+	uint64_t frames_read;
+
+	*result = {};
+	expected = 0;
+	frames_read = 0;
+
+	for (;;) {
+		header = wait_for_render_packet(ring);
+		data = (const uint8_t*)get_render_packet_data(header);
+
+		if (header->type == PACKET_QUIT) {
+			pop_render_packet(ring);
+			return;
+		}
+
+		if (header->frame >= frames_read + MAX_QUEUED_FRAMES) {
+			result->too_far_ahead++;
+		}
+
+		if (header->type == PACKET_END_FRAME) {
+			pop_render_packet(ring);
+			finish_render_frame(ring);
+			frames_read++;
+
+			// Pretend recording the frame takes a while now and then.
+			if (stall && frames_read % 16 == 0) {
+				this_thread::sleep_for(chrono::microseconds(500));
+			}
+
+			continue;
+		}
+
+		memcpy(&sequence, data, sizeof(sequence));
+
+		if (sequence != expected && !(allow_gaps && sequence > expected)) {
+			result->out_of_order++;
+		}
+
+		if (verify && !verify_packet(data, header->size, sequence)) {
+			result->corrupt++;
+		}
+
+		expected = sequence + 1;
+		result->received++;
+
+		pop_render_packet(ring);
+	}
+}
+
+static bool run_stress(const uint64_t packet_count) {
+	consumer_result result;
+	thread consumer;
+	mt19937 rng;
+	uint8_t* data;
+	uint32_t size;
+	uint64_t i;
+	render_ring_stats stats;
+	bool success;
+
+	// Small enough that it fills up and wraps all the time.
+	initialize_render_ring(&ring, 16 * 1024, RENDER_RING_WAIT);
+	consumer = thread(run_consumer, &ring, false, true, true, &result);
+
+	rng.seed(1);
+
+	for (i = 0; i < packet_count; i++) {
+		if (i % PACKETS_PER_FRAME == 0) {
+			begin_render_frame(&ring, MAX_QUEUED_FRAMES);
+		}
+
+		size = 8 + rng() % 240;
+		data = (uint8_t*)begin_render_packet(&ring, PACKET_DATA, size);
+		fill_packet(data, size, i);
+		end_render_packet(&ring);
+
+		if (i % PACKETS_PER_FRAME == PACKETS_PER_FRAME - 1) {
+			write_render_packet(&ring, PACKET_END_FRAME, NULL, 0);
+			end_render_frame(&ring);
+		}
+	}
+
+	write_render_packet(&ring, PACKET_QUIT, NULL, 0);
+	consumer.join();
+
+	stats = get_render_ring_stats(&ring);
+
+	success = true;
+	success = check(result.received == packet_count, "lost packets") && success;
+	success = check(result.out_of_order == 0, "packets out of order") && success;
+	success = check(result.corrupt == 0, "packet data corrupted") && success;
+	success = check(result.too_far_ahead == 0, "producer got too many frames ahead") && success;
+	success = check(stats.occupancy == 0, "ring isn't empty at the end") && success;
+
+	printf("stress      %s: %llu packets, %llu frames\n  %s",
+		success ? "ok" : "FAILED",
+		(unsigned long long)result.received,
+		(unsigned long long)(packet_count / PACKETS_PER_FRAME),
+		get_render_ring_report(&ring).c_str()
+	);
+
+	return success;
+}
+
+static bool run_drop(const uint64_t packet_count) {
+	consumer_result result;
+	thread consumer;
+	uint8_t payload[64];
+	uint64_t i;
+	render_ring_stats stats;
+	bool success;
+
+	initialize_render_ring(&ring, 4 * 1024, RENDER_RING_DROP);
+	consumer = thread(run_consumer, &ring, true, true, true, &result);
+
+	for (i = 0; i < packet_count; i++) {
+		if (i % PACKETS_PER_FRAME == 0) {
+			begin_render_frame(&ring, MAX_QUEUED_FRAMES);
+		}
+
+		fill_packet(payload, sizeof(payload), i);
+		write_render_packet(&ring, PACKET_DATA, payload, sizeof(payload));
+
+		// Frame boundaries aren't dropped: the consumer relies on them.
+		if (i % PACKETS_PER_FRAME == PACKETS_PER_FRAME - 1) {
+			ring.policy = RENDER_RING_WAIT;
+			write_render_packet(&ring, PACKET_END_FRAME, NULL, 0);
+			ring.policy = RENDER_RING_DROP;
+
+			end_render_frame(&ring);
+		}
+	}
+
+	ring.policy = RENDER_RING_WAIT;
+	write_render_packet(&ring, PACKET_QUIT, NULL, 0);
+	consumer.join();
+
+	stats = get_render_ring_stats(&ring);
+
+	success = true;
+	success = check(stats.packets_dropped > 0, "nothing was dropped, so this didn't test anything") && success;
+	success = check(
+		result.received + stats.packets_dropped == packet_count,
+		"packets neither received nor dropped"
+	) && success;
+	success = check(result.out_of_order == 0, "packets out of order") && success;
+	success = check(result.corrupt == 0, "packet data corrupted") && success;
+
+	printf("drop        %s: %llu of %llu packets received, %llu dropped\n",
+		success ? "ok" : "FAILED",
+		(unsigned long long)result.received,
+		(unsigned long long)packet_count,
+		(unsigned long long)stats.packets_dropped
+	);
+
+	return success;
+}
+
+static void run_throughput(const uint64_t packet_count, const uint32_t size) {
+	consumer_result result;
+	thread consumer;
+	uint8_t payload[256];
+	chrono::steady_clock::time_point start;
+	double seconds;
+	uint64_t i;
+
+	initialize_render_ring(&ring, 256 * 1024, RENDER_RING_WAIT);
+	memset(payload, 0, sizeof(payload));
+
+	consumer = thread(run_consumer, &ring, false, false, false, &result);
+	start = chrono::steady_clock::now();
+
+	for (i = 0; i < packet_count; i++) {
+		memcpy(payload, &i, sizeof(i));
+		write_render_packet(&ring, PACKET_DATA, payload, size);
+	}
+
+	write_render_packet(&ring, PACKET_QUIT, NULL, 0);
+	consumer.join();
+
+	seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	printf("throughput  %3u byte packets: %.1fM packets/sec, %.0fMB/sec (%llu producer waits, %llu consumer waits)\n",
+		size,
+		(double)packet_count / seconds / 1000000.0,
+		(double)packet_count * size / seconds / (1024.0 * 1024.0),
+		(unsigned long long)ring.producer_waits.load(),
+		(unsigned long long)ring.consumer_waits.load()
+	);
+}
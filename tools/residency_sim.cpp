@@ -0,0 +1,354 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Runs the residency manager against a simulated video memory budget
+	and checks how it behaves in a few situations we care about:
+
+		fits         The working set fits. Nothing should be evicted.
+		oversubscribed
+		             The working set is bigger than the budget and all
+		             of it is used every frame. Evicting anything would
+		             just reload it next frame, so nothing should be
+		             evicted (we run over budget instead).
+		streaming    Two levels' worth of heaps, used one level at a
+		             time. Switching levels should evict the old one
+		             once, without thrashing.
+		budget drop  The budget halves partway through. Cold heaps
+		             should go, hot ones shouldn't.
+		async        Heaps streamed in with asynchronous make-resident.
+
+	The simulated GPU runs a few frames behind, and every eviction is
+	checked against it to make sure we never evict anything in flight.
+
+	Usage:
+		residency_sim
+*/
+
+#include "residency_manager.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+const uint64_t MB = 1024 * 1024;
+const uint64_t HEAP_SIZE = 64 * MB;
+// How far behind the CPU the simulated GPU is.
+const uint64_t FRAMES_IN_FLIGHT = 3;
+// Memory used by things we don't track (the swap chain, other apps).
+const uint64_t EXTERNAL_USAGE = 256 * MB;
+
+struct simulated_heap {
+	residency_handle handle;
+	bool resident;
+	uint64_t last_used_fence;
+};
+
+struct simulation {
+	residency_manager manager;
+	vector<simulated_heap> heaps;
+	residency_work work;
+	uint64_t budget;
+	uint64_t frame;
+	uint64_t completed_residency_fence;
+	// Signalled at the start of the next frame.
+	uint64_t pending_residency_fence;
+	bool failed;
+};
+
+static void start_simulation(simulation* sim, const uint32_t heap_count, const uint64_t budget);
+static void use_heap(simulation* sim, const uint32_t heap);
+static void end_frame(simulation* sim);
+static uint64_t get_resident_bytes(const simulation* sim);
+static bool check(simulation* sim, const bool condition, const char* message);
+static void report(const char* name, simulation* sim);
+
+static bool run_fits();
+static bool run_oversubscribed();
+static bool run_streaming();
+static bool run_budget_drop();
+static bool run_async();
+
+int main() {
+	bool success;
+
+	success = true;
+	success = run_fits() && success;
+	success = run_oversubscribed() && success;
+	success = run_streaming() && success;
+	success = run_budget_drop() && success;
+	success = run_async() && success;
+
+	printf(success ? "All scenarios passed\n" : "Some scenarios FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool run_fits() {
+	simulation sim;
+	uint32_t frame;
+	uint32_t i;
+
+	start_simulation(&sim, 40, 4096 * MB);
+
+	for (frame = 0; frame < 200; frame++) {
+		for (i = 0; i < 40; i++) {
+			use_heap(&sim, i);
+		}
+
+		end_frame(&sim);
+	}
+
+	check(&sim, sim.manager.stats.evictions == 0, "nothing should be evicted");
+	report("fits", &sim);
+
+	return !sim.failed;
+}
+
+static bool run_oversubscribed() {
+	simulation sim;
+	uint32_t frame;
+	uint32_t i;
+
+	start_simulation(&sim, 80, 4096 * MB);
+
+	for (frame = 0; frame < 200; frame++) {
+		for (i = 0; i < 80; i++) {
+			use_heap(&sim, i);
+		}
+
+		end_frame(&sim);
+	}
+
+	check(&sim, sim.manager.stats.evictions == 0, "a hot working set shouldn't be evicted");
+	check(&sim, sim.manager.stats.thrash_count == 0, "nothing should thrash");
+	check(&sim, sim.manager.stats.over_budget_frames > 0, "should report being over budget");
+	report("oversubscribed", &sim);
+
+	return !sim.failed;
+}
+
+static bool run_streaming() {
+	simulation sim;
+	uint32_t frame;
+	uint32_t level;
+	uint32_t i;
+
+	// Two levels of 40 heaps each. One level fits, both don't.
+	start_simulation(&sim, 80, 3072 * MB);
+
+	for (frame = 0; frame < 600; frame++) {
+		level = (frame / 100) % 2;
+
+		for (i = 0; i < 40; i++) {
+			use_heap(&sim, level * 40 + i);
+		}
+
+		end_frame(&sim);
+	}
+
+	// Each of the 6 level switches should evict at most one level.
+	check(&sim, sim.manager.stats.evictions <= 6 * 40, "too many evictions");
+	check(&sim, sim.manager.stats.thrash_count == 0, "nothing should thrash");
+	check(&sim, get_resident_bytes(&sim) + EXTERNAL_USAGE <= sim.budget, "should end under budget");
+	report("streaming", &sim);
+
+	return !sim.failed;
+}
+
+static bool run_budget_drop() {
+	simulation sim;
+	uint32_t frame;
+	uint32_t i;
+
+	// 20 hot heaps used every frame, 30 cold ones used once at the start.
+	start_simulation(&sim, 50, 4096 * MB);
+
+	for (frame = 0; frame < 200; frame++) {
+		if (frame == 100) {
+			sim.budget = 2048 * MB;
+		}
+
+		for (i = 0; i < 20; i++) {
+			use_heap(&sim, i);
+		}
+
+		if (frame == 0) {
+			for (i = 20; i < 50; i++) {
+				use_heap(&sim, i);
+			}
+		}
+
+		end_frame(&sim);
+	}
+
+	for (i = 0; i < 20; i++) {
+		check(&sim, sim.heaps[i].resident, "hot heaps should stay resident");
+	}
+
+	check(&sim, get_resident_bytes(&sim) + EXTERNAL_USAGE <= sim.budget, "should end under budget");
+	check(&sim, sim.manager.stats.thrash_count == 0, "nothing should thrash");
+	report("budget drop", &sim);
+
+	return !sim.failed;
+}
+
+static bool run_async() {
+	simulation sim;
+	uint64_t fence_value;
+	uint32_t frame;
+	uint32_t i;
+
+	start_simulation(&sim, 60, 3072 * MB);
+
+	// Use the first 40 for a while, so the last 20 get evicted.
+	for (frame = 0; frame < 40; frame++) {
+		for (i = 0; i < 40; i++) {
+			use_heap(&sim, i);
+		}
+
+		end_frame(&sim);
+	}
+
+	check(&sim, !sim.heaps[50].resident, "unused heaps should have been evicted");
+
+	// Now stream heap 50 back in without waiting on it.
+	fence_value = request_residency_async(&(sim.manager), sim.heaps[50].handle);
+	end_frame(&sim);
+
+	check(
+		&sim,
+		!is_object_resident(&(sim.manager), sim.heaps[50].handle),
+		"shouldn't be resident until the fence is signalled"
+	);
+
+	check(&sim, sim.completed_residency_fence < fence_value, "fence signalled too early");
+	end_frame(&sim);
+
+	check(&sim, sim.completed_residency_fence >= fence_value, "fence was never signalled");
+	check(
+		&sim,
+		is_object_resident(&(sim.manager), sim.heaps[50].handle),
+		"should be resident once the fence is signalled"
+	);
+
+	report("async", &sim);
+
+	return !sim.failed;
+}
+
+static void start_simulation(simulation* sim, const uint32_t heap_count, const uint64_t budget) {
+	uint32_t i;
+
+	initialize_residency_manager(&(sim->manager), 2, 30);
+
+	sim->heaps.resize(heap_count);
+	for (i = 0; i < heap_count; i++) {
+		sim->heaps[i].handle = track_residency(&(sim->manager), &(sim->heaps[i]), HEAP_SIZE);
+		sim->heaps[i].resident = true;
+		sim->heaps[i].last_used_fence = 0;
+	}
+
+	sim->budget = budget;
+	sim->frame = 1;
+	sim->completed_residency_fence = 0;
+	sim->pending_residency_fence = 0;
+	sim->failed = false;
+}
+
+static void use_heap(simulation* sim, const uint32_t heap) {
+	use_resident_object(&(sim->manager), sim->heaps[heap].handle, sim->frame);
+	sim->heaps[heap].last_used_fence = sim->frame;
+}
+
+static void end_frame(simulation* sim) {
+	residency_frame_info info;
+	simulated_heap* heap;
+	uint64_t completed_fence;
+	size_t i;
+
+	completed_fence = sim->frame > FRAMES_IN_FLIGHT ? sim->frame - FRAMES_IN_FLIGHT : 0;
+
+	// Async make-residents take a frame to come in.
+	sim->completed_residency_fence = sim->pending_residency_fence;
+
+	info.budget = sim->budget;
+	info.usage = get_resident_bytes(sim) + EXTERNAL_USAGE;
+	info.completed_fence = completed_fence;
+	info.completed_residency_fence = sim->completed_residency_fence;
+
+	update_residency(&(sim->manager), info, &(sim->work));
+
+	for (i = 0; i < sim->work.evict.size(); i++) {
+		heap = (simulated_heap*)sim->work.evict[i];
+
+		check(sim, heap->resident, "evicted something that wasn't resident");
+		check(sim, heap->last_used_fence <= completed_fence, "evicted something the GPU is using");
+
+		heap->resident = false;
+	}
+
+	for (i = 0; i < sim->work.make_resident.size(); i++) {
+		((simulated_heap*)sim->work.make_resident[i])->resident = true;
+	}
+
+	// The memory counts against us as soon as it's asked for, even
+	// though the fence isn't signalled until next frame.
+	for (i = 0; i < sim->work.make_resident_async.size(); i++) {
+		((simulated_heap*)sim->work.make_resident_async[i])->resident = true;
+	}
+
+	if (sim->work.async_fence_value != 0) {
+		sim->pending_residency_fence = sim->work.async_fence_value;
+	}
+
+	check(
+		sim,
+		get_resident_bytes(sim) == sim->manager.stats.resident_bytes,
+		"manager's resident bytes don't match"
+	);
+
+	sim->frame++;
+}
+
+static uint64_t get_resident_bytes(const simulation* sim) {
+	uint64_t bytes;
+	size_t i;
+
+	bytes = 0;
+	for (i = 0; i < sim->heaps.size(); i++) {
+		if (sim->heaps[i].resident) {
+			bytes += HEAP_SIZE;
+		}
+	}
+
+	return bytes;
+}
+
+static bool check(simulation* sim, const bool condition, const char* message) {
+	if (!condition) {
+		printf("  FAIL: %s\n", message);
+		sim->failed = true;
+	}
+
+	return condition;
+}
+
+static void report(const char* name, simulation* sim) {
+	residency_stats* stats;
+
+	stats = &(sim->manager.stats);
+
+	printf(
+		"%-15s %s: %u evictions (%.0fMB), %u make residents, %u thrashed, "
+		"%u frames over budget, %.0fMB resident\n",
+		name,
+		sim->failed ? "FAILED" : "ok",
+		stats->evictions,
+		(double)stats->bytes_evicted / (double)MB,
+		stats->make_residents,
+		stats->thrash_count,
+		stats->over_budget_frames,
+		(double)stats->resident_bytes / (double)MB
+	);
+}
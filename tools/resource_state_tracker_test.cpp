@@ -0,0 +1,460 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the resource state tracker, then times it on a frame's worth
+	of resources.
+
+	Checks:
+		pending         A command list's first use of a resource leaves
+		                a pending barrier instead of guessing the state.
+		                At submission it resolves against the registry:
+		                a barrier from the registered state, none if the
+		                state already matches, and the registry takes
+		                the state the list leaves it in.
+		fold            A->B->C before a flush goes out as one A->C
+		                barrier. A->B->A goes out as nothing, and asking
+		                for a read state already covered adds nothing.
+		split           A begin/end pair queues a BEGIN_ONLY and then an
+		                END_ONLY barrier with the same before and after
+		                states. Without a known before state it falls
+		                back to a normal (pending) transition, and the
+		                end does nothing.
+		subresources    A whole resource in one state moves with one
+		                ALL_SUBRESOURCES barrier. Once one subresource
+		                differs, asking for the whole resource gives one
+		                barrier per subresource, and a pending
+		                ALL_SUBRESOURCES barrier resolves per subresource
+		                if the registry has them in different states.
+
+	Benchmark:
+		10,000 registered resources, each transitioned twice a command
+		list (so once pending, once queued), then flushed and resolved.
+		Prints the best time a list and per resource.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		resource_state_tracker_test [--quick]
+*/
+
+#include "resource_state_tracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+const uint32_t BENCH_RESOURCES = 10000;
+const uint32_t BENCH_LISTS = 100;
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static bool is_barrier(
+	const resource_barrier* barrier,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state before,
+	const resource_state after
+);
+
+static bool run_pending_check();
+static bool run_fold_check();
+static bool run_split_check();
+static bool run_subresource_check();
+static void run_benchmark();
+
+int main(int argc, char** argv) {
+	bool quick;
+	bool success;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	success = true;
+	success = run_pending_check() && success;
+	success = run_fold_check() && success;
+	success = run_split_check() && success;
+	success = run_subresource_check() && success;
+
+	if (!quick) {
+		run_benchmark();
+	}
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool is_barrier(
+	const resource_barrier* barrier,
+	const void* resource,
+	const uint32_t subresource,
+	const resource_state before,
+	const resource_state after
+) {
+	return
+		barrier->type == RESOURCE_BARRIER_TRANSITION &&
+		barrier->resource == resource &&
+		barrier->subresource == subresource &&
+		barrier->before == before &&
+		barrier->after == after;
+}
+
+static bool run_pending_check() {
+	resource_state_registry registry;
+	command_list_state_tracker tracker;
+	vector<resource_barrier> barriers;
+	int texture;
+	size_t count;
+	bool success;
+
+	printf("pending\n");
+	success = true;
+
+	register_resource(&registry, &texture, 1, RESOURCE_STATE_COPY_DEST);
+
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(count == 0, "a first use queues nothing") && success;
+	success = check(
+		tracker.pending.size() == 1 && tracker.pending[0].before == RESOURCE_STATE_UNKNOWN,
+		"a first use is pending, with an unknown before state"
+	) && success;
+
+	count = resolve_pending_barriers(&registry, &tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		"resolves from the registered state"
+	) && success;
+	success = check(
+		get_registered_state(&registry, &texture, 0) == RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+		"the registry takes the state the list leaves it in"
+	) && success;
+	success = check(tracker.pending.empty(), "resolving clears the pending barriers") && success;
+
+	// A list that wants it in the state it's already in needs nothing.
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	count = resolve_pending_barriers(&registry, &tracker, &barriers);
+	success = check(count == 0, "nothing to resolve if the registry already matches") && success;
+
+	//
+	// Used in one state and then another. The pending barrier only gets
+	// it to the first, and the registry ends up in the last.
+	//
+
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_SOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_COPY_SOURCE),
+		"a later use in the same list is a normal barrier"
+	) && success;
+
+	count = resolve_pending_barriers(&registry, &tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE, RESOURCE_STATE_RENDER_TARGET),
+		"the pending barrier only goes to the first use"
+	) && success;
+	success = check(
+		get_registered_state(&registry, &texture, 0) == RESOURCE_STATE_COPY_SOURCE,
+		"the registry ends in the last use"
+	) && success;
+
+	return success;
+}
+
+static bool run_fold_check() {
+	resource_state_registry registry;
+	command_list_state_tracker tracker;
+	vector<resource_barrier> barriers;
+	int texture;
+	size_t count;
+	bool success;
+
+	printf("fold\n");
+	success = true;
+
+	register_resource(&registry, &texture, 1, RESOURCE_STATE_COMMON);
+	reset_state_tracker(&tracker, &registry);
+
+	// The first use is pending, so A is known from here on.
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_SOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_COPY_SOURCE),
+		"A->B->C is one A->C barrier"
+	) && success;
+
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_SOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(count == 0, "A->B->A is no barrier at all") && success;
+
+	// Don't fold into a barrier that's already been flushed.
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET);
+	flush_resource_barriers(&tracker, &barriers);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_SOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_COPY_SOURCE),
+		"a flushed barrier is left alone"
+	) && success;
+
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_GENERIC_READ);
+	flush_resource_barriers(&tracker, &barriers);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_GENERIC_READ);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(count == 0, "a read state inside the current ones needs nothing") && success;
+	success = check(tracker.stats.transitions_elided == 4, "the folded and covered transitions are counted as elided") && success;
+
+	resolve_pending_barriers(&registry, &tracker, &barriers);
+
+	return success;
+}
+
+static bool run_split_check() {
+	resource_state_registry registry;
+	command_list_state_tracker tracker;
+	vector<resource_barrier> barriers;
+	int texture;
+	int other;
+	size_t count;
+	bool success;
+
+	printf("split\n");
+	success = true;
+
+	register_resource(&registry, &texture, 1, RESOURCE_STATE_COMMON);
+	register_resource(&registry, &other, 1, RESOURCE_STATE_COMMON);
+	reset_state_tracker(&tracker, &registry);
+
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET);
+	begin_resource_transition(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 &&
+		barriers[0].split == RESOURCE_BARRIER_SPLIT_BEGIN_ONLY &&
+		is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		"begin queues a BEGIN_ONLY barrier"
+	) && success;
+
+	end_resource_transition(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 &&
+		barriers[0].split == RESOURCE_BARRIER_SPLIT_END_ONLY &&
+		is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		"end queues the matching END_ONLY barrier"
+	) && success;
+
+	// Back in a normal state, so a later transition is a normal barrier.
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_SOURCE);
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 &&
+		barriers[0].split == RESOURCE_BARRIER_SPLIT_NONE &&
+		is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE, RESOURCE_STATE_COPY_SOURCE),
+		"after the end the state is the split's target"
+	) && success;
+
+	// The list hasn't seen other yet, so there's no before state to
+	// split from.
+	begin_resource_transition(&tracker, &other, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	end_resource_transition(&tracker, &other, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(count == 0, "a split on a first use queues nothing") && success;
+	success = check(
+		tracker.pending.size() == 2 && tracker.pending[1].resource == &other,
+		"a split on a first use falls back to a pending barrier"
+	) && success;
+
+	resolve_pending_barriers(&registry, &tracker, &barriers);
+	success = check(
+		get_registered_state(&registry, &texture, 0) == RESOURCE_STATE_COPY_SOURCE &&
+		get_registered_state(&registry, &other, 0) == RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+		"the registry takes the states after the splits"
+	) && success;
+
+	return success;
+}
+
+static bool run_subresource_check() {
+	resource_state_registry registry;
+	command_list_state_tracker tracker;
+	vector<resource_barrier> barriers;
+	int texture;
+	size_t count;
+	bool matches;
+	bool success;
+	uint32_t i;
+
+	printf("subresources\n");
+	success = true;
+
+	register_resource(&registry, &texture, 4, RESOURCE_STATE_COMMON);
+
+	//
+	// All four in the same state: one barrier for the lot.
+	//
+
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, ALL_SUBRESOURCES, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		"a uniform resource moves with one ALL_SUBRESOURCES barrier"
+	) && success;
+
+	//
+	// Now move just one mip, then ask for the whole thing. Only the
+	// odd one out needs a barrier.
+	//
+
+	transition_resource(&tracker, &texture, 2, RESOURCE_STATE_RENDER_TARGET);
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, 2, RESOURCE_STATE_PIXEL_SHADER_RESOURCE, RESOURCE_STATE_RENDER_TARGET),
+		"one subresource moves on its own"
+	) && success;
+
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	count = flush_resource_barriers(&tracker, &barriers);
+	success = check(
+		count == 1 && is_barrier(&barriers[0], &texture, 2, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		"a mixed resource gets a barrier for each subresource that needs one"
+	) && success;
+
+	resolve_pending_barriers(&registry, &tracker, &barriers);
+
+	//
+	// Leave the registry with one mip different from the rest. A
+	// pending barrier for the whole resource then has to resolve per
+	// subresource.
+	//
+
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, 1, RESOURCE_STATE_COPY_DEST);
+	resolve_pending_barriers(&registry, &tracker, &barriers);
+
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_SOURCE);
+	count = resolve_pending_barriers(&registry, &tracker, &barriers);
+
+	matches = count == 4;
+	for (i = 0; matches && i < 4; i++) {
+		matches = is_barrier(
+			&barriers[i],
+			&texture,
+			i,
+			i == 1 ? RESOURCE_STATE_COPY_DEST : RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+			RESOURCE_STATE_COPY_SOURCE
+		);
+	}
+
+	success = check(matches, "a pending ALL_SUBRESOURCES barrier splits against a mixed registry") && success;
+
+	//
+	// The same thing, but one mip was already where it needed to be.
+	//
+
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, 3, RESOURCE_STATE_COPY_DEST);
+	resolve_pending_barriers(&registry, &tracker, &barriers);
+
+	reset_state_tracker(&tracker, &registry);
+	transition_resource(&tracker, &texture, ALL_SUBRESOURCES, RESOURCE_STATE_COPY_SOURCE);
+	count = resolve_pending_barriers(&registry, &tracker, &barriers);
+	success = check(count == 1 && is_barrier(&barriers[0], &texture, 3, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_COPY_SOURCE), "subresources already in the state are skipped") && success;
+
+	matches = true;
+	for (i = 0; i < 4; i++) {
+		matches = matches && get_registered_state(&registry, &texture, i) == RESOURCE_STATE_COPY_SOURCE;
+	}
+
+	success = check(matches, "every subresource ends up registered in the new state") && success;
+
+	return success;
+}
+
+static void run_benchmark() {
+	resource_state_registry registry;
+	command_list_state_tracker tracker;
+	vector<resource_barrier> barriers;
+	vector<uint8_t> resources;
+	resource_state first_state;
+	resource_state second_state;
+	size_t flushed;
+	size_t resolved;
+	double start;
+	double best_time;
+	uint32_t list;
+	uint32_t i;
+
+	//
+	// Every list uses every resource as a render target and then reads
+	// it. Odd lists use them as copy destinations instead, so every
+	// pending barrier has something to resolve.
+	//
+
+	resources.resize(BENCH_RESOURCES);
+	for (i = 0; i < BENCH_RESOURCES; i++) {
+		register_resource(&registry, &resources[i], 1, RESOURCE_STATE_COMMON);
+	}
+
+	flushed = 0;
+	resolved = 0;
+	best_time = 1e9;
+
+	for (list = 0; list < BENCH_LISTS; list++) {
+		first_state = list % 2 == 0 ? RESOURCE_STATE_RENDER_TARGET : RESOURCE_STATE_COPY_DEST;
+		second_state = RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+		start = now_seconds();
+
+		reset_state_tracker(&tracker, &registry);
+
+		for (i = 0; i < BENCH_RESOURCES; i++) {
+			transition_resource(&tracker, &resources[i], ALL_SUBRESOURCES, first_state);
+		}
+
+		for (i = 0; i < BENCH_RESOURCES; i++) {
+			transition_resource(&tracker, &resources[i], ALL_SUBRESOURCES, second_state);
+		}
+
+		flushed = flush_resource_barriers(&tracker, &barriers);
+		resolved = resolve_pending_barriers(&registry, &tracker, &barriers);
+
+		best_time = min(best_time, now_seconds() - start);
+	}
+
+	printf("\n%u resources, %zu barriers flushed and %zu resolved a list\n", BENCH_RESOURCES, flushed, resolved);
+	printf("transition and resolve  %7.3fms (%5.1fns a resource)\n", best_time * 1000.0, best_time * 1e9 / BENCH_RESOURCES);
+}
@@ -0,0 +1,578 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the shader cache with a stub compiler standing in for the
+	real one, then times hits.
+
+	The stub's bytecode starts with how many times it has been called,
+	so every compile gives different bytes and a hit can be told apart
+	from a recompile.
+
+	Checks:
+		miss        The first load of a shader compiles it, hands out
+		            the compiled bytes, and leaves one cache file.
+		hit         Loading it again, even from a new cache (like the
+		            next run would), doesn't compile. The bytecode comes
+		            straight out of the mapped file, and is what the
+		            miss compiled. Changing the entry point, target,
+		            defines, flags or compiler id misses.
+		includes    Changing a file the source includes, or a file that
+		            one includes, misses. Changing it back hits the old
+		            entry again. Include cycles and includes that aren't
+		            next to the source still give a key.
+		write       Cache files are written to a temporary file and
+		            renamed into place: no temporary files are left
+		            behind, a bytecode still mapped from a file that
+		            gets replaced keeps its bytes, and a truncated or
+		            damaged file is a miss that gets rewritten. Eight
+		            threads missing the same shader at once all get it,
+		            and leave one good file. A shader that doesn't
+		            compile writes nothing, and a cache that can't write
+		            still hands out what it compiled.
+
+	Benchmark:
+		Loads a cached shader (with two includes and 64KB of bytecode)
+		over and over, and prints how long a hit takes: computing the
+		key, then mapping and checking the file. Also prints a miss
+		with the stub compiler, which is just the cost of writing the
+		file.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		shader_cache_bench [--quick]
+*/
+
+#include "shader_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+const uint32_t STUB_COMPILER_ID = 7;
+const size_t CHECK_BYTECODE_SIZE = 1000;
+const size_t BENCH_BYTECODE_SIZE = 64 * 1024;
+const uint32_t CHECK_THREADS = 8;
+const uint32_t BENCH_LOADS = 10000;
+
+// The stub compiler's output. Set before each run.
+static size_t stub_bytecode_size;
+static atomic<uint32_t> stub_compiles;
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static bool write_text_file(const string& path, const string& contents);
+static bool stub_compile(
+	const shader_compile_request& request,
+	vector<uint8_t>* bytecode,
+	string* errors
+);
+// Which stub compile produced bytecode.
+static uint32_t get_compile_number(const shader_bytecode* bytecode);
+static size_t count_files(const string& directory, const string& extension);
+static void make_request(shader_compile_request* request, const string& source_path);
+
+static bool run_miss_check(const string& directory);
+static bool run_hit_check(const string& directory);
+static bool run_include_check(const string& directory);
+static bool run_write_check(const string& directory);
+static void run_benchmark(const string& directory);
+
+int main(int argc, char** argv) {
+	string directory;
+	bool quick;
+	bool success;
+	error_code err;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	directory = (fs::temp_directory_path() / ("shader_cache_bench_" + to_string((unsigned long long)now_seconds()))).string();
+	fs::create_directories(directory, err);
+
+	stub_bytecode_size = CHECK_BYTECODE_SIZE;
+
+	success = true;
+	success = run_miss_check(directory + "/miss") && success;
+	success = run_hit_check(directory + "/hit") && success;
+	success = run_include_check(directory + "/includes") && success;
+	success = run_write_check(directory + "/write") && success;
+
+	if (!quick) {
+		run_benchmark(directory + "/bench");
+	}
+
+	fs::remove_all(directory, err);
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool write_text_file(const string& path, const string& contents) {
+	ofstream file;
+
+	file.open(path, ios::binary | ios::trunc);
+	file.write(contents.data(), (streamsize)contents.size());
+
+	return file.good();
+}
+
+static bool stub_compile(
+	const shader_compile_request& request,
+	vector<uint8_t>* bytecode,
+	string* errors
+) {
+	uint32_t number;
+	size_t i;
+
+	if (request.entry_point == "broken") {
+		if (errors) {
+			*errors = "error X3000: syntax error";
+		}
+
+		return false;
+	}
+
+	number = ++stub_compiles;
+
+	bytecode->resize(stub_bytecode_size);
+	memcpy(bytecode->data(), &number, sizeof(number));
+
+	for (i = sizeof(number); i < bytecode->size(); i++) {
+		(*bytecode)[i] = (uint8_t)(i * 31 + number);
+	}
+
+	return true;
+}
+
+static uint32_t get_compile_number(const shader_bytecode* bytecode) {
+	uint32_t number;
+
+	if (get_shader_bytecode_size(bytecode) < sizeof(number)) {
+		return 0;
+	}
+
+	memcpy(&number, get_shader_bytecode_data(bytecode), sizeof(number));
+
+	return number;
+}
+
+static size_t count_files(const string& directory, const string& extension) {
+	fs::directory_iterator it;
+	error_code err;
+	size_t count;
+
+	count = 0;
+
+	for (it = fs::directory_iterator(directory, err); !err && it != fs::directory_iterator(); it.increment(err)) {
+		if (it->path().extension() == extension) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void make_request(shader_compile_request* request, const string& source_path) {
+	request->source_path = source_path;
+	request->entry_point = "main";
+	request->target = "ps_5_1";
+	request->defines.clear();
+	request->flags = 0;
+}
+
+static bool run_miss_check(const string& directory) {
+	shader_cache cache;
+	shader_compile_request request;
+	shader_bytecode bytecode;
+	string errors;
+	string source_path;
+	uint32_t compiles;
+	bool loaded;
+	bool success;
+	error_code err;
+
+	printf("miss\n");
+	success = true;
+
+	fs::create_directories(directory, err);
+	source_path = directory + "/shader.hlsl";
+	write_text_file(source_path, "float4 main() : SV_Target { return 1; }\n");
+
+	initialize_shader_cache(&cache, directory + "/cache", stub_compile, STUB_COMPILER_ID);
+	make_request(&request, source_path);
+
+	compiles = stub_compiles;
+	loaded = load_shader(&cache, request, &bytecode, &errors);
+
+	success = check(loaded && !bytecode.cache_hit, "the first load misses") && success;
+	success = check(stub_compiles == compiles + 1 && get_compile_number(&bytecode) == compiles + 1, "and compiles once") && success;
+	success = check(get_shader_bytecode_size(&bytecode) == CHECK_BYTECODE_SIZE, "the compiled bytes are handed out") && success;
+	success = check(cache.misses == 1 && cache.hits == 0, "the miss is counted") && success;
+	success = check(count_files(directory + "/cache", ".cso") == 1, "one cache file is written") && success;
+
+	release_shader_bytecode(&bytecode);
+
+	return success;
+}
+
+static bool run_hit_check(const string& directory) {
+	shader_cache cache;
+	shader_cache next_run;
+	shader_compile_request request;
+	shader_compile_request changed;
+	shader_bytecode first;
+	shader_bytecode bytecode;
+	string source_path;
+	uint32_t compiles;
+	uint32_t misses;
+	bool in_mapping;
+	bool success;
+	error_code err;
+
+	printf("hit\n");
+	success = true;
+
+	fs::create_directories(directory, err);
+	source_path = directory + "/shader.hlsl";
+	write_text_file(source_path, "float4 main() : SV_Target { return 1; }\n");
+
+	initialize_shader_cache(&cache, directory + "/cache", stub_compile, STUB_COMPILER_ID);
+	make_request(&request, source_path);
+
+	load_shader(&cache, request, &first, NULL);
+	compiles = stub_compiles;
+
+	success = check(load_shader(&cache, request, &bytecode, NULL) && bytecode.cache_hit, "the second load hits") && success;
+	success = check(stub_compiles == compiles, "and doesn't compile") && success;
+
+	initialize_shader_cache(&next_run, directory + "/cache", stub_compile, STUB_COMPILER_ID);
+	success = check(load_shader(&next_run, request, &bytecode, NULL) && bytecode.cache_hit, "a new cache in the same directory hits") && success;
+	success = check(stub_compiles == compiles && next_run.hits == 1 && next_run.misses == 0, "and doesn't compile either") && success;
+
+	in_mapping =
+		(const uint8_t*)get_shader_bytecode_data(&bytecode) > bytecode.mapping.data &&
+		(const uint8_t*)get_shader_bytecode_data(&bytecode) + get_shader_bytecode_size(&bytecode) == bytecode.mapping.data + bytecode.mapping.size;
+	success = check(in_mapping, "the bytecode is read straight from the mapped file") && success;
+	success = check(
+		get_shader_bytecode_size(&bytecode) == get_shader_bytecode_size(&first) &&
+		memcmp(get_shader_bytecode_data(&bytecode), get_shader_bytecode_data(&first), get_shader_bytecode_size(&first)) == 0,
+		"and is what the miss compiled"
+	) && success;
+	success = check(bytecode.key == first.key, "with the same key") && success;
+
+	//
+	// Everything else that goes into the key.
+	//
+
+	misses = cache.misses;
+
+	changed = request;
+	changed.entry_point = "other_main";
+	load_shader(&cache, changed, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "a different entry point misses") && success;
+
+	changed = request;
+	changed.target = "ps_6_0";
+	load_shader(&cache, changed, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "a different target misses") && success;
+
+	changed = request;
+	changed.defines.push_back({ "USE_FOG", "1" });
+	load_shader(&cache, changed, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "a define misses") && success;
+
+	changed.defines[0].value = "0";
+	load_shader(&cache, changed, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "a define's value misses") && success;
+
+	changed = request;
+	changed.flags = 1;
+	load_shader(&cache, changed, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "different flags miss") && success;
+
+	initialize_shader_cache(&next_run, directory + "/cache", stub_compile, STUB_COMPILER_ID + 1);
+	load_shader(&next_run, request, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "a different compiler id misses") && success;
+
+	success = check(cache.misses == misses + 5, "every one of those is counted as a miss") && success;
+
+	release_shader_bytecode(&first);
+	release_shader_bytecode(&bytecode);
+
+	return success;
+}
+
+static bool run_include_check(const string& directory) {
+	shader_cache cache;
+	shader_compile_request request;
+	shader_compile_request cycle;
+	shader_bytecode bytecode;
+	string source_path;
+	uint32_t original;
+	uint64_t key;
+	bool success;
+	error_code err;
+
+	printf("includes\n");
+	success = true;
+
+	fs::create_directories(directory, err);
+	source_path = directory + "/shader.hlsl";
+	write_text_file(source_path, "#include \"common.hlsli\"\n  #  include <missing.hlsli>\nfloat4 main() : SV_Target { return fog(1); }\n");
+	write_text_file(directory + "/common.hlsli", "#include \"nested.hlsli\"\nfloat4 fog(float4 c) { return c * FOG; }\n");
+	write_text_file(directory + "/nested.hlsli", "#define FOG 0.5\n");
+
+	initialize_shader_cache(&cache, directory + "/cache", stub_compile, STUB_COMPILER_ID);
+	make_request(&request, source_path);
+
+	success = check(compute_shader_cache_key(&cache, request, &key), "an include that isn't next to the source still gives a key") && success;
+
+	load_shader(&cache, request, &bytecode, NULL);
+	original = get_compile_number(&bytecode);
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(bytecode.cache_hit, "unchanged includes hit") && success;
+
+	write_text_file(directory + "/common.hlsli", "#include \"nested.hlsli\"\nfloat4 fog(float4 c) { return c + FOG; }\n");
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(!bytecode.cache_hit && get_compile_number(&bytecode) != original, "changing an include misses and recompiles") && success;
+
+	write_text_file(directory + "/nested.hlsli", "#define FOG 0.25\n");
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "changing an include's include misses") && success;
+
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(bytecode.cache_hit, "and hits after that") && success;
+
+	write_text_file(directory + "/common.hlsli", "#include \"nested.hlsli\"\nfloat4 fog(float4 c) { return c * FOG; }\n");
+	write_text_file(directory + "/nested.hlsli", "#define FOG 0.5\n");
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(bytecode.cache_hit && get_compile_number(&bytecode) == original, "changing them back hits the first entry again") && success;
+
+	//
+	// Two files that include each other.
+	//
+
+	write_text_file(directory + "/a.hlsli", "#include \"b.hlsli\"\n");
+	write_text_file(directory + "/b.hlsli", "#include \"a.hlsli\"\n");
+	make_request(&cycle, directory + "/a.hlsli");
+	success = check(compute_shader_cache_key(&cache, cycle, &key), "an include cycle still gives a key") && success;
+
+	release_shader_bytecode(&bytecode);
+
+	return success;
+}
+
+static bool run_write_check(const string& directory) {
+	shader_cache cache;
+	shader_cache unwritable;
+	shader_compile_request request;
+	shader_compile_request requests[CHECK_THREADS];
+	shader_bytecode bytecodes[CHECK_THREADS];
+	shader_bytecode held;
+	shader_bytecode bytecode;
+	vector<uint8_t> before;
+	string cache_directory;
+	string source_path;
+	string cache_file;
+	string errors;
+	uint32_t compiles;
+	bool loaded;
+	bool same;
+	bool success;
+	uint32_t i;
+	error_code err;
+
+	printf("write\n");
+	success = true;
+
+	fs::create_directories(directory, err);
+	source_path = directory + "/shader.hlsl";
+	write_text_file(source_path, "float4 main() : SV_Target { return 1; }\n");
+
+	cache_directory = directory + "/cache";
+	initialize_shader_cache(&cache, cache_directory, stub_compile, STUB_COMPILER_ID);
+	make_request(&request, source_path);
+
+	load_shader(&cache, request, &bytecode, NULL);
+	cache_file = fs::directory_iterator(cache_directory)->path().string();
+	success = check(count_files(cache_directory, ".tmp") == 0, "a miss leaves no temporary file") && success;
+
+	//
+	// Hold a hit, then damage its file (by renaming junk over it, so
+	// the mapping we hold isn't touched). The next load misses and
+	// writes a new file, and the held bytecode doesn't change.
+	//
+
+	load_shader(&cache, request, &held, NULL);
+	before.assign(
+		(const uint8_t*)get_shader_bytecode_data(&held),
+		(const uint8_t*)get_shader_bytecode_data(&held) + get_shader_bytecode_size(&held)
+	);
+
+	write_text_file(cache_file + ".junk", "not a cache file");
+	fs::rename(cache_file + ".junk", cache_file, err);
+
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "a damaged cache file misses") && success;
+
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(bytecode.cache_hit, "and is rewritten") && success;
+
+	same =
+		get_shader_bytecode_size(&held) == before.size() &&
+		memcmp(get_shader_bytecode_data(&held), before.data(), before.size()) == 0;
+	success = check(same, "a hit still mapped keeps its bytes when its file is replaced") && success;
+
+	release_shader_bytecode(&held);
+
+	fs::resize_file(cache_file, 40, err);
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(!bytecode.cache_hit, "a truncated cache file misses") && success;
+
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(bytecode.cache_hit && get_shader_bytecode_size(&bytecode) == CHECK_BYTECODE_SIZE, "and is rewritten") && success;
+
+	//
+	// Eight threads miss the same shader at once. Each writes its own
+	// temporary file and the renames race, but whichever wins leaves a
+	// whole file.
+	//
+
+	release_shader_bytecode(&bytecode);
+	fs::remove(cache_file, err);
+
+	for (i = 0; i < CHECK_THREADS; i++) {
+		requests[i] = request;
+	}
+
+	loaded = load_shaders_parallel(&cache, requests, bytecodes, CHECK_THREADS, &errors);
+	success = check(loaded, "eight threads loading the same shader at once all get it") && success;
+	success = check(count_files(cache_directory, ".tmp") == 0 && count_files(cache_directory, ".cso") == 1, "and leave one cache file and no temporary files") && success;
+
+	load_shader(&cache, request, &bytecode, NULL);
+	success = check(bytecode.cache_hit && get_shader_bytecode_size(&bytecode) == CHECK_BYTECODE_SIZE, "which is whole") && success;
+
+	for (i = 0; i < CHECK_THREADS; i++) {
+		release_shader_bytecode(&bytecodes[i]);
+	}
+
+	//
+	// Failures.
+	//
+
+	request.entry_point = "broken";
+	errors.clear();
+	loaded = load_shader(&cache, request, &bytecode, &errors);
+	success = check(!loaded && errors.find("X3000") != string::npos, "a shader that doesn't compile fails, with the compiler's errors") && success;
+	success = check(count_files(cache_directory, ".cso") == 1, "and writes nothing") && success;
+
+	// A regular file where the cache directory should be.
+	write_text_file(directory + "/not_a_directory", "");
+	initialize_shader_cache(&unwritable, directory + "/not_a_directory", stub_compile, STUB_COMPILER_ID);
+
+	request.entry_point = "main";
+	compiles = stub_compiles;
+	loaded = load_shader(&unwritable, request, &bytecode, NULL);
+	success = check(loaded && get_compile_number(&bytecode) == compiles + 1, "a cache that can't write still hands out what it compiled") && success;
+
+	loaded = load_shader(&unwritable, request, &bytecode, NULL);
+	success = check(loaded && !bytecode.cache_hit, "and just misses every time") && success;
+
+	release_shader_bytecode(&bytecode);
+
+	return success;
+}
+
+static void run_benchmark(const string& directory) {
+	shader_cache cache;
+	shader_compile_request request;
+	shader_bytecode bytecode;
+	string source_path;
+	string body;
+	uint64_t key;
+	uint64_t checksum;
+	double start;
+	double key_time;
+	double hit_time;
+	double best_hit_time;
+	double miss_time;
+	uint32_t i;
+	error_code err;
+
+	fs::create_directories(directory, err);
+	stub_bytecode_size = BENCH_BYTECODE_SIZE;
+
+	//
+	// A few KB of source across three files, about what the project's
+	// own shaders are.
+	//
+
+	for (i = 0; i < 100; i++) {
+		body += "float4 light_" + to_string(i) + "(float4 c) { return c * " + to_string(i) + ".0 + FOG; }\n";
+	}
+
+	source_path = directory + "/shader.hlsl";
+	write_text_file(source_path, "#include \"lighting.hlsli\"\nfloat4 main() : SV_Target { return light_0(1); }\n");
+	write_text_file(directory + "/lighting.hlsli", "#include \"fog.hlsli\"\n" + body);
+	write_text_file(directory + "/fog.hlsli", "#define FOG 0.5\n");
+
+	initialize_shader_cache(&cache, directory + "/cache", stub_compile, STUB_COMPILER_ID);
+	make_request(&request, source_path);
+
+	start = now_seconds();
+	load_shader(&cache, request, &bytecode, NULL);
+	miss_time = now_seconds() - start;
+
+	start = now_seconds();
+	for (i = 0; i < BENCH_LOADS; i++) {
+		compute_shader_cache_key(&cache, request, &key);
+	}
+	key_time = (now_seconds() - start) / BENCH_LOADS;
+
+	//
+	// Touch the bytecode each time, so the pages are actually read
+	// rather than just mapped.
+	//
+
+	checksum = 0;
+	best_hit_time = 1e9;
+	start = now_seconds();
+
+	for (i = 0; i < BENCH_LOADS; i++) {
+		hit_time = now_seconds();
+		load_shader(&cache, request, &bytecode, NULL);
+		checksum += ((const uint8_t*)get_shader_bytecode_data(&bytecode))[i % get_shader_bytecode_size(&bytecode)];
+		best_hit_time = min(best_hit_time, now_seconds() - hit_time);
+	}
+
+	hit_time = (now_seconds() - start) / BENCH_LOADS;
+
+	release_shader_bytecode(&bytecode);
+
+	printf("\n%u hits of a %zuKB shader with two includes (checksum %llu)\n", cache.hits.load(), BENCH_BYTECODE_SIZE / 1024, (unsigned long long)checksum);
+	printf("key only   %8.2fus\n", key_time * 1e6);
+	printf("hit        %8.2fus (best %.2fus)\n", hit_time * 1e6, best_hit_time * 1e6);
+	printf("map        %8.2fus (the hit without the key)\n", (hit_time - key_time) * 1e6);
+	printf("miss       %8.2fus (stub compile and write)\n", miss_time * 1e6);
+
+	stub_bytecode_size = CHECK_BYTECODE_SIZE;
+}
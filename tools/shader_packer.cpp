@@ -0,0 +1,465 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	The shader packer compiles every shader permutation listed in a
+	permutation file (see hello_directx12/shader_permutations.txt) with
+	DXC, and packs the resulting DXIL and reflection data into a single
+	shader archive that the application memory maps at start up. Each
+	shader is stored with a hash of its source and includes, so the
+	application can tell when the archive is out of date.
+
+	Usage:
+		shader_packer <permutation file> <output archive>
+			[--dxc <path to dxc>] [--jobs <thread count>]
+
+	DXC runs fine on Linux, so this is the same on every platform. The
+	permutations are compiled in parallel, one DXC process per thread.
+*/
+
+#include "shader_archive.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct permutation_axis {
+	string name;
+	vector<string> values;
+};
+
+struct shader_entry {
+	string entry_point;
+	string target;
+};
+
+// A single source file from the permutation file.
+struct shader_source {
+	string name;
+	vector<shader_entry> entries;
+	vector<permutation_axis> axes;
+	string arguments;
+};
+
+// A single thing for DXC to compile.
+struct permutation {
+	const shader_source* source;
+	const shader_entry* entry;
+	vector<shader_define> defines;
+};
+
+struct packer_settings {
+	string permutation_file;
+	string output_path;
+	string dxc_path;
+	uint32_t job_count;
+};
+
+static bool parse_arguments(int argc, char** argv, packer_settings* settings);
+static bool parse_permutation_file(
+	const string& path,
+	vector<shader_source>* sources
+);
+static void expand_permutations(
+	const vector<shader_source>& sources,
+	vector<permutation>* permutations
+);
+static bool compile_permutation(
+	const packer_settings& settings,
+	const fs::path& source_directory,
+	const fs::path& work_directory,
+	const size_t index,
+	const permutation& perm,
+	shader_archive_input* output
+);
+static bool read_binary_file(const fs::path& path, vector<uint8_t>* contents);
+
+int main(int argc, char** argv) {
+	packer_settings settings;
+	vector<shader_source> sources;
+	vector<permutation> permutations;
+	vector<shader_archive_input> outputs;
+	vector<char> results;
+	vector<thread> workers;
+	atomic<size_t> next_permutation;
+	fs::path source_directory;
+	fs::path work_directory;
+	chrono::steady_clock::time_point start;
+	double seconds;
+	bool success;
+	error_code err;
+	uint32_t i;
+	size_t j;
+
+	if (!parse_arguments(argc, argv, &settings)) {
+		cerr << "usage: shader_packer <permutation file> <output archive> "
+			<< "[--dxc <path>] [--jobs <count>]" << endl;
+		return 1;
+	}
+
+	if (!parse_permutation_file(settings.permutation_file, &sources)) {
+		return 1;
+	}
+
+	expand_permutations(sources, &permutations);
+
+	//
+	// Each permutation compiles into its own files in a scratch
+	// directory, so the threads never step on each other.
+	//
+
+	source_directory = fs::path(settings.permutation_file).parent_path();
+	work_directory = fs::path(settings.output_path).string() + ".work";
+	fs::create_directories(work_directory, err);
+
+	outputs.resize(permutations.size());
+	results.resize(permutations.size());
+	next_permutation = 0;
+
+	start = chrono::steady_clock::now();
+
+	for (i = 0; i < settings.job_count; i++) {
+		workers.emplace_back([&]() {
+			size_t index;
+
+			while (true) {
+				index = next_permutation++;
+				if (index >= permutations.size()) {
+					break;
+				}
+
+				results[index] = compile_permutation(
+					settings,
+					source_directory,
+					work_directory,
+					index,
+					permutations[index],
+					&outputs[index]
+				);
+			}
+		});
+	}
+
+	for (i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+
+	seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	fs::remove_all(work_directory, err);
+
+	success = true;
+	for (j = 0; j < results.size(); j++) {
+		success = success && results[j];
+	}
+
+	if (!success) {
+		cerr << "shader_packer: some permutations failed to compile" << endl;
+		return 1;
+	}
+
+	if (!write_shader_archive(settings.output_path, &outputs)) {
+		cerr << "shader_packer: could not write " << settings.output_path << endl;
+		return 1;
+	}
+
+	//
+	// Report how fast we went. This is the number to watch as the
+	// permutation matrix grows.
+	//
+
+	printf(
+		"Compiled %zu permutations in %.3f s on %u threads "
+		"(%.1f permutations/sec)\n",
+		permutations.size(),
+		seconds,
+		settings.job_count,
+		seconds > 0.0 ? permutations.size() / seconds : 0.0
+	);
+
+	return 0;
+}
+
+static bool parse_arguments(int argc, char** argv, packer_settings* settings) {
+	const char* dxc_env;
+	string arg;
+	int i;
+
+	dxc_env = getenv("DXC");
+
+	settings->dxc_path = dxc_env ? dxc_env : "dxc";
+	settings->job_count = thread::hardware_concurrency();
+	if (settings->job_count == 0) {
+		settings->job_count = 1;
+	}
+
+	for (i = 1; i < argc; i++) {
+		arg = argv[i];
+
+		if (arg == "--dxc" && i + 1 < argc) {
+			settings->dxc_path = argv[++i];
+		} else if (arg == "--jobs" && i + 1 < argc) {
+			settings->job_count = (uint32_t)atoi(argv[++i]);
+			if (settings->job_count == 0) {
+				return false;
+			}
+		} else if (settings->permutation_file.empty()) {
+			settings->permutation_file = arg;
+		} else if (settings->output_path.empty()) {
+			settings->output_path = arg;
+		} else {
+			return false;
+		}
+	}
+
+	return !settings->permutation_file.empty() && !settings->output_path.empty();
+}
+
+static bool parse_permutation_file(
+	const string& path,
+	vector<shader_source>* sources
+) {
+	ifstream file;
+	string line;
+	string keyword;
+	string value;
+	istringstream words;
+	shader_source* current;
+	shader_entry entry;
+	permutation_axis axis;
+	uint32_t line_number;
+
+	file.open(path);
+	if (!file.is_open()) {
+		cerr << "shader_packer: could not open " << path << endl;
+		return false;
+	}
+
+	current = NULL;
+	line_number = 0;
+
+	while (getline(file, line)) {
+		line_number++;
+
+		words.clear();
+		words.str(line);
+
+		// Skip blank lines and comments.
+		if (!(words >> keyword) || keyword[0] == '#') {
+			continue;
+		}
+
+		if (keyword == "shader") {
+			sources->push_back({});
+			current = &sources->back();
+
+			if (!(words >> current->name)) {
+				cerr << path << ":" << line_number << ": missing source" << endl;
+				return false;
+			}
+
+			continue;
+		}
+
+		if (!current) {
+			cerr << path << ":" << line_number << ": expected shader" << endl;
+			return false;
+		}
+
+		if (keyword == "entry") {
+			if (!(words >> entry.entry_point >> entry.target)) {
+				cerr << path << ":" << line_number << ": bad entry" << endl;
+				return false;
+			}
+
+			current->entries.push_back(entry);
+		} else if (keyword == "define") {
+			axis = {};
+
+			if (!(words >> axis.name)) {
+				cerr << path << ":" << line_number << ": bad define" << endl;
+				return false;
+			}
+
+			while (words >> value) {
+				axis.values.push_back(value);
+			}
+
+			if (axis.values.empty()) {
+				cerr << path << ":" << line_number << ": define has no values" << endl;
+				return false;
+			}
+
+			current->axes.push_back(axis);
+		} else if (keyword == "args") {
+			while (words >> value) {
+				current->arguments += " " + value;
+			}
+		} else {
+			cerr << path << ":" << line_number << ": unknown keyword "
+				<< keyword << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void expand_permutations(
+	const vector<shader_source>& sources,
+	vector<permutation>* permutations
+) {
+	const shader_source* source;
+	vector<size_t> counters;
+	permutation perm;
+	size_t axis;
+	size_t i;
+	size_t j;
+	bool done;
+
+	for (i = 0; i < sources.size(); i++) {
+		source = &sources[i];
+
+		for (j = 0; j < source->entries.size(); j++) {
+			//
+			// Walk every combination of axis values like an odometer:
+			// bump the first axis, and carry into the next one when it
+			// wraps around.
+			//
+
+			counters.assign(source->axes.size(), 0);
+			done = false;
+
+			while (!done) {
+				perm.source = source;
+				perm.entry = &source->entries[j];
+				perm.defines.clear();
+
+				for (axis = 0; axis < source->axes.size(); axis++) {
+					perm.defines.push_back({
+						source->axes[axis].name,
+						source->axes[axis].values[counters[axis]]
+					});
+				}
+
+				permutations->push_back(perm);
+
+				done = true;
+				for (axis = 0; axis < counters.size(); axis++) {
+					counters[axis]++;
+					if (counters[axis] < source->axes[axis].values.size()) {
+						done = false;
+						break;
+					}
+
+					counters[axis] = 0;
+				}
+			}
+		}
+	}
+}
+
+static bool compile_permutation(
+	const packer_settings& settings,
+	const fs::path& source_directory,
+	const fs::path& work_directory,
+	const size_t index,
+	const permutation& perm,
+	shader_archive_input* output
+) {
+	fs::path dxil_path;
+	fs::path reflection_path;
+	fs::path source_path;
+	string command;
+	size_t i;
+	int exit_code;
+
+	dxil_path = work_directory / (to_string(index) + ".dxil");
+	reflection_path = work_directory / (to_string(index) + ".refl");
+	source_path = source_directory / perm.source->name;
+
+	//
+	// Hash the source before compiling it, so that if it changes while
+	// DXC runs, the archive looks out of date rather than up to date.
+	//
+
+	if (!hash_shader_source(source_path.string(), &(output->source_hash))) {
+		cerr << "shader_packer: could not read " << perm.source->name
+			<< " or one of its includes" << endl;
+		return false;
+	}
+
+	//
+	// Build up the DXC command line. Reflection is written to its own
+	// file (-Fre) and stripped from the DXIL so the bytecode we hand to
+	// the driver stays small.
+	//
+
+	command = "\"" + settings.dxc_path + "\"";
+	command += " -nologo";
+	command += " -T " + perm.entry->target;
+	command += " -E " + perm.entry->entry_point;
+
+	for (i = 0; i < perm.defines.size(); i++) {
+		command += " -D " + perm.defines[i].name + "=" + perm.defines[i].value;
+	}
+
+	command += perm.source->arguments;
+	command += " -Qstrip_reflect";
+	command += " -Fo \"" + dxil_path.string() + "\"";
+	command += " -Fre \"" + reflection_path.string() + "\"";
+	command += " \"" + source_path.string() + "\"";
+
+#if defined(_WIN32)
+	// system() hands the line to cmd /c, which strips the first and
+	// last quote when the line starts with one. With the quoted DXC
+	// path at the front and a quoted path at the end, that breaks both.
+	// An extra pair around everything is what it strips instead.
+	command = "\"" + command + "\"";
+#endif
+
+	exit_code = system(command.c_str());
+	if (exit_code != 0) {
+		cerr << "shader_packer: failed to compile " << perm.source->name
+			<< " (" << perm.entry->entry_point << ")" << endl;
+		return false;
+	}
+
+	output->key = get_shader_permutation_key(
+		perm.source->name,
+		perm.entry->entry_point,
+		perm.entry->target,
+		perm.defines
+	);
+
+	return
+		read_binary_file(dxil_path, &(output->bytecode)) &&
+		read_binary_file(reflection_path, &(output->reflection));
+}
+
+static bool read_binary_file(const fs::path& path, vector<uint8_t>* contents) {
+	ifstream file;
+	streamsize size;
+
+	file.open(path, ios::in | ios::binary | ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	size = file.tellg();
+	file.seekg(0);
+
+	contents->resize((size_t)size);
+	file.read((char*)contents->data(), size);
+
+	return !file.fail();
+}
@@ -0,0 +1,709 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the mesh simplifier and LOD chains, then times them on big
+	meshes.
+
+	Checks:
+		grid        A flat grid simplifies to almost nothing with no
+		            error, keeping its outline and area. With borders
+		            locked, every border vertex stays.
+		sphere      A UV sphere simplifies to close to the target, with
+		            nothing turned inside out and the surface still
+		            close to the sphere.
+		seams       The sphere's UV seam stays put, and no triangle ends
+		            up spanning it.
+		error       With only an error limit, the result's error is
+		            under it.
+		uv          UVs that don't follow the surface hold on to more
+		            triangles when they're weighted.
+		cube        The application's cube (all seams) stays as it is.
+		chain       Levels are packed one after another, each smaller
+		            than the last, with error that only goes up.
+		parallel    Building chains on the job system gives the same
+		            chains as one thread.
+
+	Benchmark:
+		A chain for one sphere of 2 million triangles, then chains for
+		16 spheres of 128 thousand each, on one thread and then across
+		the job system. Prints each level's triangles and error.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		simplify_bench [--quick]
+*/
+
+#include "job_system.h"
+#include "mesh_simplifier.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const float PI = 3.14159265f;
+const uint32_t BENCH_RINGS = 1000;
+const uint32_t BENCH_SEGMENTS = 1000;
+const uint32_t BENCH_MESHES = 16;
+const uint32_t BENCH_MESH_RINGS = 256;
+const uint32_t BENCH_MESH_SEGMENTS = 256;
+
+// A mesh the checks own.
+struct test_mesh {
+	vector<mesh_vertex> vertices;
+	vector<uint32_t> indices;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static mesh_source get_source(const test_mesh* mesh);
+// A flat size by size grid in the xy plane, from 0 to 1. With curved_uv
+// set, u goes with x squared instead of x.
+static void make_grid(test_mesh* mesh, const uint32_t size, const bool curved_uv);
+// A sphere of radius 1. Its seam is where u wraps from 1 back to 0.
+static void make_sphere(test_mesh* mesh, const uint32_t rings, const uint32_t segments);
+static void make_cube(test_mesh* mesh);
+static double get_area(const test_mesh* mesh, const uint32_t* indices, const uint32_t index_count);
+static bool is_referenced(const uint32_t* indices, const uint32_t index_count, const uint32_t vertex);
+
+static bool run_grid_check();
+static bool run_sphere_check();
+static bool run_seam_check();
+static bool run_error_check();
+static bool run_uv_check();
+static bool run_cube_check();
+static bool run_chain_check();
+static bool run_parallel_check(job_system* system);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	test_mesh big;
+	vector<test_mesh> meshes;
+	vector<mesh_source> sources;
+	vector<lod_chain> chains;
+	lod_chain big_chain;
+	lod_chain_options options;
+	mesh_source source;
+	uint32_t cores;
+	uint64_t total_triangles;
+	double start;
+	double serial_time;
+	double parallel_time;
+	bool quick;
+	bool success;
+	uint32_t i;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	system = new job_system;
+	initialize_job_system(system, cores < 4 ? 4 : cores, false);
+
+	success = true;
+	success = run_grid_check() && success;
+	success = run_sphere_check() && success;
+	success = run_seam_check() && success;
+	success = run_error_check() && success;
+	success = run_uv_check() && success;
+	success = run_cube_check() && success;
+	success = run_chain_check() && success;
+	success = run_parallel_check(system) && success;
+
+	shutdown_job_system(system);
+	delete system;
+
+	if (quick) {
+		printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+		return success ? 0 : 1;
+	}
+
+	//
+	// One big mesh.
+	//
+
+	make_sphere(&big, BENCH_RINGS, BENCH_SEGMENTS);
+	source = get_source(&big);
+
+	printf("\nOne sphere, %u triangles\n", source.index_count / 3);
+
+	build_lod_chain(&source, &options, &big_chain);
+	printf("%s", get_lod_chain_report(&big_chain, 1).c_str());
+	printf("%.1f million triangles a second\n", source.index_count / 3 / big_chain.build_seconds / 1e6);
+
+	//
+	// Lots of smaller ones, a job each.
+	//
+
+	meshes.resize(BENCH_MESHES);
+	sources.resize(BENCH_MESHES);
+	chains.resize(BENCH_MESHES);
+	total_triangles = 0;
+
+	for (i = 0; i < BENCH_MESHES; i++) {
+		make_sphere(&(meshes[i]), BENCH_MESH_RINGS + i, BENCH_MESH_SEGMENTS);
+		sources[i] = get_source(&(meshes[i]));
+		total_triangles += sources[i].index_count / 3;
+	}
+
+	printf("\n%u spheres, %llu triangles in all, %u cores\n",
+		BENCH_MESHES, (unsigned long long)total_triangles, cores);
+
+	start = now_seconds();
+	build_lod_chains(NULL, sources.data(), BENCH_MESHES, &options, chains.data());
+	serial_time = now_seconds() - start;
+
+	system = new job_system;
+	initialize_job_system(system, cores, true);
+
+	start = now_seconds();
+	build_lod_chains(system, sources.data(), BENCH_MESHES, &options, chains.data());
+	parallel_time = now_seconds() - start;
+
+	shutdown_job_system(system);
+	delete system;
+
+	printf("%s", get_lod_chain_report(chains.data(), 1).c_str());
+	printf("one thread  %8.1fms\n", serial_time * 1000.0);
+	printf("job system  %8.1fms (%4.2fx)\n", parallel_time * 1000.0, serial_time / parallel_time);
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static mesh_source get_source(const test_mesh* mesh) {
+	mesh_source source;
+
+	source.vertices = mesh->vertices.data();
+	source.vertex_count = (uint32_t)mesh->vertices.size();
+	source.indices = mesh->indices.data();
+	source.index_count = (uint32_t)mesh->indices.size();
+
+	return source;
+}
+
+static void make_grid(test_mesh* mesh, const uint32_t size, const bool curved_uv) {
+	mesh_vertex* vertex;
+	float x;
+	float y;
+	uint32_t row;
+	uint32_t column;
+	uint32_t corner;
+
+	mesh->vertices.resize((size + 1) * (size + 1));
+	mesh->indices.clear();
+
+	for (row = 0; row <= size; row++) {
+		for (column = 0; column <= size; column++) {
+			x = (float)column / size;
+			y = (float)row / size;
+
+			vertex = &(mesh->vertices[row * (size + 1) + column]);
+			vertex->position[0] = x;
+			vertex->position[1] = y;
+			vertex->position[2] = 0.0f;
+			vertex->uv[0] = curved_uv ? x * x : x;
+			vertex->uv[1] = y;
+		}
+	}
+
+	for (row = 0; row < size; row++) {
+		for (column = 0; column < size; column++) {
+			corner = row * (size + 1) + column;
+
+			mesh->indices.push_back(corner);
+			mesh->indices.push_back(corner + 1);
+			mesh->indices.push_back(corner + size + 2);
+			mesh->indices.push_back(corner);
+			mesh->indices.push_back(corner + size + 2);
+			mesh->indices.push_back(corner + size + 1);
+		}
+	}
+}
+
+static void make_sphere(test_mesh* mesh, const uint32_t rings, const uint32_t segments) {
+	mesh_vertex* vertex;
+	float theta;
+	float phi;
+	float radius;
+	uint32_t ring;
+	uint32_t segment;
+	uint32_t corner;
+
+	//
+	// A column more than there are segments: the last is the first
+	// again, with u = 1 instead of 0. The poles are a row of vertices
+	// each, all in the same place.
+	//
+
+	mesh->vertices.resize((rings + 1) * (segments + 1));
+	mesh->indices.clear();
+
+	for (ring = 0; ring <= rings; ring++) {
+		for (segment = 0; segment <= segments; segment++) {
+			theta = PI * ring / rings;
+			phi = 2.0f * PI * (segment % segments) / segments;
+
+			// sinf(PI) isn't quite 0, which would spread the south
+			// pole's copies out a little.
+			radius = ring == 0 || ring == rings ? 0.0f : sinf(theta);
+
+			vertex = &(mesh->vertices[ring * (segments + 1) + segment]);
+			vertex->position[0] = radius * cosf(phi);
+			vertex->position[1] = ring == rings ? -1.0f : cosf(theta);
+			vertex->position[2] = radius * sinf(phi);
+			vertex->uv[0] = (float)segment / segments;
+			vertex->uv[1] = (float)ring / rings;
+		}
+	}
+
+	// Wound so the normals point out.
+	for (ring = 0; ring < rings; ring++) {
+		for (segment = 0; segment < segments; segment++) {
+			corner = ring * (segments + 1) + segment;
+
+			mesh->indices.push_back(corner);
+			mesh->indices.push_back(corner + 1);
+			mesh->indices.push_back(corner + segments + 2);
+			mesh->indices.push_back(corner);
+			mesh->indices.push_back(corner + segments + 2);
+			mesh->indices.push_back(corner + segments + 1);
+		}
+	}
+}
+
+static void make_cube(test_mesh* mesh) {
+	const float corners[8][3] = {
+		{ -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 },
+		{ -1, -1, 1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, -1, 1 }
+	};
+	// Each face's corners, like the application's.
+	const uint32_t faces[6][4] = {
+		{ 0, 1, 2, 3 }, { 4, 5, 6, 7 }, { 4, 5, 1, 0 },
+		{ 3, 2, 6, 7 }, { 1, 5, 6, 2 }, { 4, 0, 3, 7 }
+	};
+	const float uvs[4][2] = { { 0, 1 }, { 0, 0 }, { 1, 0 }, { 1, 1 } };
+	mesh_vertex* vertex;
+	uint32_t face;
+	uint32_t i;
+
+	mesh->vertices.resize(24);
+	mesh->indices.clear();
+
+	for (face = 0; face < 6; face++) {
+		for (i = 0; i < 4; i++) {
+			vertex = &(mesh->vertices[face * 4 + i]);
+			memcpy(vertex->position, corners[faces[face][i]], sizeof(vertex->position));
+			memcpy(vertex->uv, uvs[i], sizeof(vertex->uv));
+		}
+
+		mesh->indices.push_back(face * 4);
+		mesh->indices.push_back(face * 4 + 1);
+		mesh->indices.push_back(face * 4 + 2);
+		mesh->indices.push_back(face * 4);
+		mesh->indices.push_back(face * 4 + 2);
+		mesh->indices.push_back(face * 4 + 3);
+	}
+}
+
+static double get_area(const test_mesh* mesh, const uint32_t* indices, const uint32_t index_count) {
+	const float* p;
+	const float* q;
+	const float* r;
+	double e1[3];
+	double e2[3];
+	double cross[3];
+	double area;
+	uint32_t i;
+	uint32_t j;
+
+	area = 0.0;
+
+	for (i = 0; i + 2 < index_count; i += 3) {
+		p = mesh->vertices[indices[i]].position;
+		q = mesh->vertices[indices[i + 1]].position;
+		r = mesh->vertices[indices[i + 2]].position;
+
+		for (j = 0; j < 3; j++) {
+			e1[j] = q[j] - p[j];
+			e2[j] = r[j] - p[j];
+		}
+
+		cross[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		cross[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		cross[2] = e1[0] * e2[1] - e1[1] * e2[0];
+		area += 0.5 * sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+	}
+
+	return area;
+}
+
+static bool is_referenced(const uint32_t* indices, const uint32_t index_count, const uint32_t vertex) {
+	uint32_t i;
+
+	for (i = 0; i < index_count; i++) {
+		if (indices[i] == vertex) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool run_grid_check() {
+	test_mesh grid;
+	mesh_source source;
+	simplify_options options;
+	vector<uint32_t> result;
+	uint32_t free_count;
+	uint32_t locked_count;
+	bool borders_kept;
+	float error;
+	bool success;
+	uint32_t i;
+
+	printf("grid\n");
+	success = true;
+
+	make_grid(&grid, 64, false);
+	source = get_source(&grid);
+	result.resize(source.index_count);
+
+	options.target_triangles = 80;
+	free_count = simplify_mesh(&source, &options, result.data(), &error);
+
+	success = check(free_count / 3 <= 80, "gets down to the target") && success;
+	success = check(error < 1e-4f, "with no error, since it's flat") && success;
+	success = check(fabs(get_area(&grid, result.data(), free_count) - 1.0) < 1e-4, "and keeps its area") && success;
+
+	options.lock_borders = true;
+	locked_count = simplify_mesh(&source, &options, result.data(), &error);
+
+	borders_kept = true;
+	for (i = 0; i <= 64; i++) {
+		borders_kept = borders_kept &&
+			is_referenced(result.data(), locked_count, i) &&
+			is_referenced(result.data(), locked_count, 64 * 65 + i) &&
+			is_referenced(result.data(), locked_count, i * 65) &&
+			is_referenced(result.data(), locked_count, i * 65 + 64);
+	}
+
+	success = check(borders_kept, "locked borders keep every border vertex") && success;
+	success = check(locked_count > free_count, "and so more triangles") && success;
+	success = check(fabs(get_area(&grid, result.data(), locked_count) - 1.0) < 1e-4, "and still the same area") && success;
+
+	return success;
+}
+
+static bool run_sphere_check() {
+	test_mesh sphere;
+	mesh_source source;
+	simplify_options options;
+	vector<uint32_t> result;
+	const float* p;
+	const float* q;
+	const float* r;
+	float e1[3];
+	float e2[3];
+	float normal[3];
+	float centroid[3];
+	float distance;
+	float worst;
+	uint32_t index_count;
+	uint32_t target;
+	bool outward;
+	float error;
+	bool success;
+	uint32_t i;
+	uint32_t j;
+
+	printf("sphere\n");
+	success = true;
+
+	make_sphere(&sphere, 64, 128);
+	source = get_source(&sphere);
+	result.resize(source.index_count);
+
+	target = source.index_count / 3 / 10;
+	options.target_triangles = target;
+	index_count = simplify_mesh(&source, &options, result.data(), &error);
+
+	success = check(index_count / 3 <= target && index_count / 3 >= target * 9 / 10, "gets to within 10% under the target") && success;
+
+	outward = true;
+	worst = 0.0f;
+
+	for (i = 0; i < index_count; i += 3) {
+		p = sphere.vertices[result[i]].position;
+		q = sphere.vertices[result[i + 1]].position;
+		r = sphere.vertices[result[i + 2]].position;
+
+		for (j = 0; j < 3; j++) {
+			e1[j] = q[j] - p[j];
+			e2[j] = r[j] - p[j];
+			centroid[j] = (p[j] + q[j] + r[j]) / 3.0f;
+		}
+
+		normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+		// A sliver along the seam can end up edge on, which is fine.
+		// Facing in isn't.
+		outward = outward && normal[0] * centroid[0] + normal[1] * centroid[1] + normal[2] * centroid[2] >= 0.0f;
+
+		distance = 1.0f - sqrtf(centroid[0] * centroid[0] + centroid[1] * centroid[1] + centroid[2] * centroid[2]);
+		worst = max(worst, distance);
+	}
+
+	success = check(outward, "no triangle is turned inside out") && success;
+	success = check(worst < 0.05f, "every triangle is still close to the sphere") && success;
+	success = check(error > 0.0f && error < 0.05f, "the error is small, but not 0") && success;
+
+	return success;
+}
+
+static bool run_seam_check() {
+	test_mesh sphere;
+	mesh_source source;
+	simplify_options options;
+	vector<uint32_t> result;
+	const mesh_vertex* corners[3];
+	uint32_t index_count;
+	bool seam_kept;
+	bool spans_seam;
+	float low;
+	float high;
+	bool success;
+	uint32_t ring;
+	uint32_t i;
+	uint32_t j;
+
+	printf("seams\n");
+	success = true;
+
+	make_sphere(&sphere, 64, 128);
+	source = get_source(&sphere);
+	result.resize(source.index_count);
+
+	options.target_triangles = source.index_count / 3 / 20;
+	index_count = simplify_mesh(&source, &options, result.data(), NULL);
+
+	// Both columns of the seam, other than the poles.
+	seam_kept = true;
+	for (ring = 1; ring < 64; ring++) {
+		seam_kept = seam_kept &&
+			is_referenced(result.data(), index_count, ring * 129) &&
+			is_referenced(result.data(), index_count, ring * 129 + 128);
+	}
+
+	spans_seam = false;
+	for (i = 0; i < index_count; i += 3) {
+		for (j = 0; j < 3; j++) {
+			corners[j] = &(sphere.vertices[result[i + j]]);
+		}
+
+		low = min(corners[0]->uv[0], min(corners[1]->uv[0], corners[2]->uv[0]));
+		high = max(corners[0]->uv[0], max(corners[1]->uv[0], corners[2]->uv[0]));
+		spans_seam = spans_seam || high - low > 0.5f;
+	}
+
+	success = check(seam_kept, "every seam vertex is kept") && success;
+	success = check(!spans_seam, "no triangle's UVs wrap around the seam") && success;
+
+	return success;
+}
+
+static bool run_error_check() {
+	test_mesh sphere;
+	mesh_source source;
+	simplify_options options;
+	vector<uint32_t> result;
+	uint32_t loose_count;
+	uint32_t tight_count;
+	float loose_error;
+	float tight_error;
+	bool success;
+
+	printf("error\n");
+	success = true;
+
+	make_sphere(&sphere, 64, 128);
+	source = get_source(&sphere);
+	result.resize(source.index_count);
+
+	options.target_triangles = 0;
+	options.target_error = 0.01f;
+	loose_count = simplify_mesh(&source, &options, result.data(), &loose_error);
+
+	options.target_error = 0.001f;
+	tight_count = simplify_mesh(&source, &options, result.data(), &tight_error);
+
+	success = check(loose_error <= 0.01f && tight_error <= 0.001f, "the error stays under the limit") && success;
+	success = check(tight_count > loose_count && loose_count < source.index_count, "a tighter limit keeps more") && success;
+
+	return success;
+}
+
+static bool run_uv_check() {
+	test_mesh grid;
+	mesh_source source;
+	simplify_options options;
+	vector<uint32_t> result;
+	uint32_t ignored_count;
+	uint32_t weighted_count;
+	bool success;
+
+	printf("uv\n");
+	success = true;
+
+	make_grid(&grid, 64, true);
+	source = get_source(&grid);
+	result.resize(source.index_count);
+
+	options.target_triangles = 0;
+	options.target_error = 0.002f;
+
+	options.uv_weight = 0.0f;
+	ignored_count = simplify_mesh(&source, &options, result.data(), NULL);
+
+	options.uv_weight = 1.0f;
+	weighted_count = simplify_mesh(&source, &options, result.data(), NULL);
+
+	success = check(weighted_count > ignored_count * 4, "curved UVs keep more triangles when weighted") && success;
+
+	return success;
+}
+
+static bool run_cube_check() {
+	test_mesh cube;
+	mesh_source source;
+	simplify_options options;
+	lod_chain_options chain_options;
+	lod_chain chain;
+	uint32_t result[36];
+	bool success;
+
+	printf("cube\n");
+	success = true;
+
+	make_cube(&cube);
+	source = get_source(&cube);
+
+	options.target_triangles = 2;
+	success = check(simplify_mesh(&source, &options, result, NULL) == 36, "every vertex is on a seam, so nothing goes") && success;
+
+	chain_options.min_triangles = 1;
+	build_lod_chain(&source, &chain_options, &chain);
+	success = check(chain.lod_count == 1 && chain.lods[0].index_count == 36, "its chain is just the cube") && success;
+
+	return success;
+}
+
+static bool run_chain_check() {
+	test_mesh sphere;
+	mesh_source source;
+	lod_chain_options options;
+	lod_chain chain;
+	const mesh_lod* lod;
+	bool packed;
+	bool shrinking;
+	bool error_grows;
+	bool in_range;
+	bool success;
+	uint32_t i;
+
+	printf("chain\n");
+	success = true;
+
+	make_sphere(&sphere, 128, 256);
+	source = get_source(&sphere);
+	build_lod_chain(&source, &options, &chain);
+
+	packed = chain.lods[0].first_index == 0;
+	shrinking = true;
+	error_grows = chain.lods[0].error == 0.0f;
+
+	for (i = 1; i < chain.lod_count; i++) {
+		lod = &(chain.lods[i]);
+
+		packed = packed && lod->first_index == chain.lods[i - 1].first_index + chain.lods[i - 1].index_count;
+		shrinking = shrinking && lod->index_count * 4 <= chain.lods[i - 1].index_count * 3;
+		error_grows = error_grows && lod->error >= chain.lods[i - 1].error;
+	}
+
+	lod = &(chain.lods[chain.lod_count - 1]);
+	packed = packed && lod->first_index + lod->index_count == chain.indices.size();
+
+	in_range = true;
+	for (i = 0; i < chain.indices.size(); i++) {
+		in_range = in_range && chain.indices[i] < source.vertex_count;
+	}
+
+	success = check(chain.lod_count >= 5, "the sphere gets at least 5 levels") && success;
+	success = check(memcmp(chain.indices.data(), source.indices, source.index_count * sizeof(uint32_t)) == 0, "the first is the mesh as it was") && success;
+	success = check(packed, "levels are packed one after another") && success;
+	success = check(shrinking, "each level is at most 3/4 of the last") && success;
+	success = check(error_grows, "error only goes up") && success;
+	success = check(in_range, "every index is one of the mesh's vertices") && success;
+	success = check(chain.lods[chain.lod_count - 1].index_count / 3 >= options.min_triangles, "no level is under min_triangles") && success;
+
+	return success;
+}
+
+static bool run_parallel_check(job_system* system) {
+	vector<test_mesh> meshes;
+	vector<mesh_source> sources;
+	vector<lod_chain> serial;
+	vector<lod_chain> parallel;
+	lod_chain_options options;
+	bool same;
+	uint32_t i;
+
+	printf("parallel\n");
+
+	meshes.resize(6);
+	sources.resize(6);
+	serial.resize(6);
+	parallel.resize(6);
+
+	for (i = 0; i < 6; i++) {
+		if (i % 2 == 0) {
+			make_sphere(&(meshes[i]), 16 + 8 * i, 32 + 8 * i);
+		} else {
+			make_grid(&(meshes[i]), 16 + 8 * i, i % 3 == 0);
+		}
+
+		sources[i] = get_source(&(meshes[i]));
+	}
+
+	build_lod_chains(NULL, sources.data(), 6, &options, serial.data());
+	build_lod_chains(system, sources.data(), 6, &options, parallel.data());
+
+	same = true;
+	for (i = 0; i < 6; i++) {
+		same = same &&
+			serial[i].lod_count == parallel[i].lod_count &&
+			serial[i].indices == parallel[i].indices &&
+			memcmp(serial[i].lods, parallel[i].lods, sizeof(serial[i].lods)) == 0;
+	}
+
+	return check(same, "the job system builds the same chains as one thread");
+}
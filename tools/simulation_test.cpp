@@ -0,0 +1,414 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the fixed-step simulation and the snapshot handoff:
+
+		fixed rate       Steps run exactly on a 60Hz grid, however
+		                 unevenly the clock is sampled.
+		catch up         After a long stall, only a few steps run and
+		                 the rest of the time is dropped.
+		interpolation    Drawing at 144Hz, an object moving at a constant
+		                 speed is drawn exactly where it should be.
+		threaded         The simulation thread runs flat out while this
+		                 thread reads snapshots and changes the input.
+		                 No snapshot is ever half written, and replaying
+		                 the recorded input gives the same world.
+		replay           The same inputs always give the same world, and
+		                 different inputs don't.
+
+	Everything except the threaded check uses a fake clock, so it runs
+	instantly and gives the same answer every time.
+
+	Usage:
+		simulation_test
+*/
+
+#include "simulation.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace std;
+
+const uint64_t MS = 1000000;
+const uint32_t SIM_RATE = 60;
+// How far the test object moves a second.
+const float VELOCITY = 3.0f;
+const uint32_t TEST_TRANSFORMS = 16;
+
+struct fake_clock {
+	uint64_t now_ns;
+};
+
+static uint64_t fake_clock_now(void* user_data);
+static void fake_clock_sleep(const uint64_t duration_ns, void* user_data);
+static bool check(const bool condition, const char* message);
+
+// Moves every transform along x at VELOCITY, and up while input bit 1
+// is held. They spin at a rate that depends on the height. Every
+// transform gets the same value, so a snapshot with two different
+// values was torn.
+static void step_test_world(
+	sim_snapshot* world,
+	const uint32_t input,
+	const double step_seconds,
+	void* user_data
+);
+static void make_initial_world(sim_snapshot* world);
+static bool transforms_match(const sim_snapshot* snapshot);
+
+static bool run_fixed_rate();
+static bool run_catch_up();
+static bool run_interpolation();
+static bool run_threaded();
+static bool run_replay();
+
+// Too big for the stack.
+static simulation sim;
+static sim_snapshot drawn;
+
+int main() {
+	bool success;
+
+	success = true;
+	success = run_fixed_rate() && success;
+	success = run_catch_up() && success;
+	success = run_interpolation() && success;
+	success = run_threaded() && success;
+	success = run_replay() && success;
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static uint64_t fake_clock_now(void* user_data) {
+	return ((fake_clock*)user_data)->now_ns;
+}
+
+static void fake_clock_sleep(const uint64_t duration_ns, void* user_data) {
+	((fake_clock*)user_data)->now_ns += duration_ns;
+}
+
+static bool check(const bool condition, const char* message) {
+	if (!condition) {
+		printf("  FAILED: %s\n", message);
+	}
+
+	return condition;
+}
+
+static void step_test_world(
+	sim_snapshot* world,
+	const uint32_t input,
+	const double step_seconds,
+	void*
+) {
+	float half_angle;
+	uint32_t i;
+
+	for (i = 0; i < world->transform_count; i++) {
+		if (input & 1) {
+			world->transforms[i].position[1] += (float)(VELOCITY * step_seconds);
+		}
+
+		half_angle = (float)world->step * world->transforms[i].position[1] * 0.01f;
+
+		world->transforms[i].position[0] += (float)(VELOCITY * step_seconds);
+		world->transforms[i].rotation[1] = sinf(half_angle);
+		world->transforms[i].rotation[3] = cosf(half_angle);
+	}
+
+	world->camera.focus[0] = world->transforms[0].position[0];
+}
+
+static void make_initial_world(sim_snapshot* world) {
+	sim_transform transform;
+	uint32_t i;
+
+	*world = {};
+	world->camera.eye[2] = -10.0f;
+	world->camera.up[1] = 1.0f;
+	world->camera.field_of_view = 45.0f;
+
+	transform = {};
+	transform.rotation[3] = 1.0f;
+	transform.scale[0] = 1.0f;
+	transform.scale[1] = 1.0f;
+	transform.scale[2] = 1.0f;
+
+	world->transform_count = TEST_TRANSFORMS;
+	for (i = 0; i < TEST_TRANSFORMS; i++) {
+		world->transforms[i] = transform;
+	}
+}
+
+static bool transforms_match(const sim_snapshot* snapshot) {
+	uint32_t i;
+
+	for (i = 1; i < snapshot->transform_count; i++) {
+		if (snapshot->transforms[i].position[0] != snapshot->transforms[0].position[0] ||
+			snapshot->transforms[i].rotation[1] != snapshot->transforms[0].rotation[1]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool run_fixed_rate() {
+	fake_clock clock;
+	sim_snapshot initial;
+	uint64_t start;
+	uint32_t steps;
+	uint32_t i;
+	bool success;
+
+	make_initial_world(&initial);
+	initialize_simulation(&sim, SIM_RATE, step_test_world, NULL, &initial);
+
+	clock.now_ns = 1000 * MS;
+	set_simulation_clock(&sim, fake_clock_now, fake_clock_sleep, &clock);
+
+	start = clock.now_ns;
+	advance_simulation(&sim, clock.now_ns);
+
+	//
+	// Sample the clock every 7ms for ten seconds, which never lines up
+	// with the steps.
+	//
+
+	steps = 0;
+	for (i = 0; i < 10000 / 7; i++) {
+		clock.now_ns += 7 * MS;
+		steps += advance_simulation(&sim, clock.now_ns);
+	}
+
+	success = true;
+	success = check(steps == (clock.now_ns - start) / sim.step_ns, "wrong number of steps") && success;
+	success = check(sim.world.step == steps, "step count doesn't match") && success;
+	success = check(
+		sim.world.published_ns == start + sim.world.step * sim.step_ns,
+		"last step isn't on the grid"
+	) && success;
+	success = check(sim.dropped_ns == 0, "dropped time without falling behind") && success;
+
+	printf("fixed rate     %s: %u steps in %.0fms\n",
+		success ? "ok" : "FAILED",
+		steps,
+		(double)(clock.now_ns - start) / MS
+	);
+
+	return success;
+}
+
+static bool run_catch_up() {
+	fake_clock clock;
+	sim_snapshot initial;
+	uint32_t steps;
+	uint32_t after;
+	bool success;
+
+	make_initial_world(&initial);
+	initialize_simulation(&sim, SIM_RATE, step_test_world, NULL, &initial);
+
+	clock.now_ns = 1000 * MS;
+	set_simulation_clock(&sim, fake_clock_now, fake_clock_sleep, &clock);
+	advance_simulation(&sim, clock.now_ns);
+
+	// Stall for a second.
+	clock.now_ns += 1000 * MS;
+	steps = advance_simulation(&sim, clock.now_ns);
+
+	// The step after that should be on time, with no second burst.
+	clock.now_ns += sim.step_ns;
+	after = advance_simulation(&sim, clock.now_ns);
+
+	success = true;
+	success = check(steps == SIM_MAX_CATCH_UP_STEPS, "didn't cap the catch up") && success;
+	success = check(after == 1, "kept catching up after the stall") && success;
+	success = check(
+		sim.dropped_ns == (SIM_RATE - SIM_MAX_CATCH_UP_STEPS) * sim.step_ns,
+		"dropped the wrong amount of time"
+	) && success;
+
+	printf("catch up       %s: %u steps after a 1s stall, %.0fms dropped\n",
+		success ? "ok" : "FAILED",
+		steps,
+		(double)sim.dropped_ns / MS
+	);
+
+	return success;
+}
+
+static bool run_interpolation() {
+	fake_clock clock;
+	sim_snapshot initial;
+	uint64_t start;
+	uint64_t frame_ns;
+	double expected;
+	double error;
+	double worst_error;
+	uint32_t i;
+	bool success;
+
+	make_initial_world(&initial);
+	initialize_simulation(&sim, SIM_RATE, step_test_world, NULL, &initial);
+
+	clock.now_ns = 1000 * MS;
+	set_simulation_clock(&sim, fake_clock_now, fake_clock_sleep, &clock);
+
+	start = clock.now_ns;
+	advance_simulation(&sim, clock.now_ns);
+
+	//
+	// Draw at 144Hz. We draw a step behind, so after the first step
+	// the object should be exactly where it was a step ago.
+	//
+
+	frame_ns = 1000000000ULL / 144;
+	worst_error = 0.0;
+	success = true;
+
+	for (i = 0; i < 1440; i++) {
+		clock.now_ns += frame_ns;
+		advance_simulation(&sim, clock.now_ns);
+		read_simulation(&sim, clock.now_ns, &drawn);
+
+		if (clock.now_ns - start < 2 * sim.step_ns) {
+			continue;
+		}
+
+		expected = VELOCITY * (double)(clock.now_ns - start - sim.step_ns) / 1000000000.0;
+		error = fabs(drawn.transforms[0].position[0] - expected);
+
+		if (error > worst_error) {
+			worst_error = error;
+		}
+	}
+
+	success = check(worst_error < 0.001, "drawn position is off") && success;
+
+	printf("interpolation  %s: worst error %.6f units\n",
+		success ? "ok" : "FAILED",
+		worst_error
+	);
+
+	return success;
+}
+
+static bool run_threaded() {
+	sim_snapshot initial;
+	sim_snapshot replayed;
+	mt19937 rng;
+	uint64_t start;
+	uint64_t last_step;
+	uint32_t reads;
+	uint32_t torn;
+	uint32_t backwards;
+	bool success;
+
+	make_initial_world(&initial);
+
+	// 2kHz, so plenty of snapshots go by in a short run.
+	initialize_simulation(&sim, 2000, step_test_world, NULL, &initial);
+	sim.recording = true;
+
+	start_simulation(&sim);
+
+	rng.seed(1234);
+	start = get_system_time_ns(NULL);
+	last_step = 0;
+	reads = 0;
+	torn = 0;
+	backwards = 0;
+
+	while (get_system_time_ns(NULL) - start < 300 * MS) {
+		if (rng() % 64 == 0) {
+			press_simulation_input(&sim, 1);
+		}
+
+		if (rng() % 64 == 0) {
+			release_simulation_input(&sim, 1);
+		}
+
+		read_simulation(&sim, get_system_time_ns(NULL), &drawn);
+
+		if (!transforms_match(&drawn)) {
+			torn++;
+		}
+
+		if (drawn.step < last_step) {
+			backwards++;
+		}
+
+		last_step = drawn.step;
+		reads++;
+	}
+
+	stop_simulation(&sim);
+	sim.recording = false;
+
+	replayed = initial;
+	replay_simulation(step_test_world, NULL, sim.step_ns, sim.recorded_input, &replayed);
+
+	success = true;
+	success = check(last_step > 0, "never saw a snapshot") && success;
+	success = check(torn == 0, "saw a torn snapshot") && success;
+	success = check(backwards == 0, "snapshots went backwards") && success;
+	success = check(
+		hash_snapshot(&replayed) == hash_snapshot(&(sim.world)),
+		"replay doesn't match the live run"
+	) && success;
+
+	printf("threaded       %s: %u reads over %llu steps, %u torn, replay %s\n",
+		success ? "ok" : "FAILED",
+		reads,
+		(unsigned long long)sim.world.step,
+		torn,
+		hash_snapshot(&replayed) == hash_snapshot(&(sim.world)) ? "matches" : "differs"
+	);
+
+	return success;
+}
+
+static bool run_replay() {
+	sim_snapshot initial;
+	sim_snapshot a;
+	sim_snapshot b;
+	sim_snapshot c;
+	vector<uint32_t> inputs;
+	mt19937 rng;
+	uint32_t i;
+	bool success;
+
+	make_initial_world(&initial);
+
+	rng.seed(42);
+	for (i = 0; i < 5000; i++) {
+		inputs.push_back(rng() & 1);
+	}
+
+	a = initial;
+	replay_simulation(step_test_world, NULL, MS * 16, inputs, &a);
+
+	b = initial;
+	replay_simulation(step_test_world, NULL, MS * 16, inputs, &b);
+
+	inputs[2500] ^= 1;
+	c = initial;
+	replay_simulation(step_test_world, NULL, MS * 16, inputs, &c);
+
+	success = true;
+	success = check(hash_snapshot(&a) == hash_snapshot(&b), "same inputs gave different worlds") && success;
+	success = check(hash_snapshot(&a) != hash_snapshot(&c), "different inputs gave the same world") && success;
+
+	printf("replay         %s: %u steps, hash %016llx\n",
+		success ? "ok" : "FAILED",
+		(uint32_t)inputs.size(),
+		(unsigned long long)hash_snapshot(&a)
+	);
+
+	return success;
+}
@@ -0,0 +1,540 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the sprite batcher, then times a million quads a frame
+	through it without a GPU.
+
+	Checks:
+		indices      Every quad's six indices make its two triangles.
+		expand       Quads come out where a plain sinf/cosf version puts
+		             them, for any rotation.
+		batches      Layers are drawn in order, only blend changes and
+		             running out of indices split draws, and the draws
+		             cover every quad exactly once.
+		sort         The radix sort puts keys in the same order as
+		             std::sort, for layers, blend modes and textures
+		             that use every byte of the key.
+		frames       Each frame writes only its own region, sprites past
+		             the limit are dropped and counted, and a frame
+		             doesn't allocate once it's warmed up.
+
+	Benchmark: a million particles a frame across 4 layers, 16 textures
+	and 2 blend modes, added, sorted, expanded and batched. The vertex
+	buffer is ordinary memory standing in for the mapped upload heap.
+	Expanding is also timed with a plain scalar loop, to see what the
+	SIMD expansion saves, and just writing the vertex buffer once is
+	timed too, as the least a frame could take.
+
+	The goal is a whole frame of a million quads in under 16.7ms, so it
+	fits in a frame at 60Hz. Missing it fails the run, like a failed
+	check.
+
+	Usage:
+		sprite_bench [--quick]
+*/
+
+#include "sprite_batcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+const uint32_t BENCH_QUADS = 1000000;
+const uint32_t BENCH_FRAMES = 10;
+const float SCREEN_W = 1920.0f;
+const float SCREEN_H = 1080.0f;
+const double GOAL_SECONDS = 1.0 / 60.0;
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static sprite random_sprite(mt19937* random, const float max_rotation);
+// What expand_sprites should give, done the obvious way.
+static void expand_reference(
+	const sprite* sprites,
+	const uint32_t count,
+	const float screen_scale[2],
+	const float screen_offset[2],
+	sprite_vertex* destination
+);
+
+static bool run_indices();
+static bool run_expand();
+static bool run_batches();
+static bool run_sort();
+static bool run_frames();
+static bool run_benchmark();
+
+int main(int argc, char** argv) {
+	bool quick;
+	bool success;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	success = true;
+	success = run_indices() && success;
+	success = run_expand() && success;
+	success = run_batches() && success;
+	success = run_sort() && success;
+	success = run_frames() && success;
+
+	if (!quick) {
+		success = run_benchmark() && success;
+	}
+
+	printf(success ? "All checks passed\n" : "Some checks failed\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static sprite random_sprite(mt19937* random, const float max_rotation) {
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+	sprite s;
+
+	s.position[0] = unit(*random) * SCREEN_W;
+	s.position[1] = unit(*random) * SCREEN_H;
+	s.size[0] = 2.0f + unit(*random) * 30.0f;
+	s.size[1] = 2.0f + unit(*random) * 30.0f;
+	s.rotation = (unit(*random) * 2.0f - 1.0f) * max_rotation;
+	s.color = (*random)();
+	s.uv_scale[0] = 0.125f;
+	s.uv_scale[1] = 0.125f;
+	s.uv_offset[0] = (float)((*random)() % 8) * 0.125f;
+	s.uv_offset[1] = (float)((*random)() % 8) * 0.125f;
+	s.texture = (*random)() % 16;
+	s.layer = (uint16_t)((*random)() % 4);
+	s.blend = (uint16_t)((*random)() % 2 == 0 ? SPRITE_BLEND_ALPHA : SPRITE_BLEND_ADDITIVE);
+
+	return s;
+}
+
+static void expand_reference(
+	const sprite* sprites,
+	const uint32_t count,
+	const float screen_scale[2],
+	const float screen_offset[2],
+	sprite_vertex* destination
+) {
+	static const float CORNER_X[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+	static const float CORNER_Y[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+	static const float CORNER_U[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+	static const float CORNER_V[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+	sprite_vertex* vertex;
+	float sine;
+	float cosine;
+	float x;
+	float y;
+	uint32_t i;
+	uint32_t k;
+
+	for (i = 0; i < count; i++) {
+		const sprite& s = sprites[i];
+
+		sine = sinf(s.rotation);
+		cosine = cosf(s.rotation);
+
+		for (k = 0; k < 4; k++) {
+			vertex = &(destination[i * 4 + k]);
+
+			x = CORNER_X[k] * s.size[0] * 0.5f;
+			y = CORNER_Y[k] * s.size[1] * 0.5f;
+
+			vertex->position[0] = (x * cosine - y * sine + s.position[0]) * screen_scale[0] + screen_offset[0];
+			vertex->position[1] = (x * sine + y * cosine + s.position[1]) * screen_scale[1] + screen_offset[1];
+			vertex->uv[0] = CORNER_U[k] * s.uv_scale[0] + s.uv_offset[0];
+			vertex->uv[1] = CORNER_V[k] * s.uv_scale[1] + s.uv_offset[1];
+			vertex->color = s.color;
+			vertex->texture = s.texture;
+		}
+	}
+}
+
+static bool run_indices() {
+	vector<uint16_t> indices;
+	bool correct;
+	uint32_t quad;
+
+	printf("Indices\n");
+
+	indices.resize(SPRITE_INDEX_COUNT);
+	write_sprite_indices(indices.data());
+
+	correct = true;
+	for (quad = 0; quad < SPRITE_QUADS_PER_DRAW; quad++) {
+		const uint16_t* q = &(indices[quad * 6]);
+		uint32_t base = quad * 4;
+
+		correct = correct &&
+			q[0] == base && q[1] == base + 1 && q[2] == base + 2 &&
+			q[3] == base && q[4] == base + 2 && q[5] == base + 3;
+	}
+
+	return check(correct, "each quad is two triangles over its own four vertices");
+}
+
+static bool run_expand() {
+	sprite_batcher batcher;
+	vector<sprite> sprites;
+	vector<sprite_vertex> expected;
+	vector<sprite_vertex> actual;
+	mt19937 random(1);
+	float error;
+	bool attributes_match;
+	uint32_t count;
+	uint32_t i;
+	bool success;
+
+	printf("Expand\n");
+
+	// Not a multiple of four, so the last group is partial.
+	count = 4097;
+	sprites.resize(count);
+	for (i = 0; i < count; i++) {
+		sprites[i] = random_sprite(&random, 100.0f);
+	}
+
+	initialize_sprite_batcher(&batcher, count, 1, NULL);
+	set_sprite_viewport(&batcher, SCREEN_W, SCREEN_H);
+
+	expected.resize(count * 4);
+	actual.resize(count * 4);
+
+	expand_reference(sprites.data(), count, batcher.screen_scale, batcher.screen_offset, expected.data());
+	expand_sprites(sprites.data(), NULL, count, batcher.screen_scale, batcher.screen_offset, actual.data());
+
+	error = 0.0f;
+	attributes_match = true;
+
+	for (i = 0; i < count * 4; i++) {
+		// In pixels.
+		error = max(error, fabsf(expected[i].position[0] - actual[i].position[0]) * SCREEN_W * 0.5f);
+		error = max(error, fabsf(expected[i].position[1] - actual[i].position[1]) * SCREEN_H * 0.5f);
+		error = max(error, fabsf(expected[i].uv[0] - actual[i].uv[0]) * 1000.0f);
+		error = max(error, fabsf(expected[i].uv[1] - actual[i].uv[1]) * 1000.0f);
+
+		attributes_match = attributes_match &&
+			expected[i].color == actual[i].color &&
+			expected[i].texture == actual[i].texture;
+	}
+
+	printf("  largest difference: %.5f pixels\n", error);
+
+	success = check(error < 0.01f, "corners are within a hundredth of a pixel of sinf/cosf");
+	success = check(attributes_match, "colors and textures are copied to every corner") && success;
+
+	return success;
+}
+
+static bool run_batches() {
+	sprite_batcher batcher;
+	vector<uint8_t> vertices;
+	vector<sprite> sprites;
+	sprite s;
+	mt19937 random(2);
+	uint32_t draw_count;
+	uint32_t next_vertex;
+	uint32_t previous_layer;
+	bool layers_in_order;
+	bool covered;
+	bool success;
+	uint32_t i;
+
+	printf("Batches\n");
+
+	vertices.resize(get_sprite_vertex_buffer_size(100000, 1));
+	initialize_sprite_batcher(&batcher, 100000, 1, vertices.data());
+	set_sprite_viewport(&batcher, SCREEN_W, SCREEN_H);
+
+	//
+	// Lots of textures, one blend mode, one layer: one draw.
+	//
+
+	reset_sprite_batch(&batcher);
+	for (i = 0; i < 1000; i++) {
+		s = random_sprite(&random, 0.0f);
+		s.layer = 0;
+		s.blend = SPRITE_BLEND_ALPHA;
+		add_sprites(&batcher, &s, 1);
+	}
+
+	success = check(build_sprite_batch(&batcher, 0) == 1, "different textures share a draw");
+
+	//
+	// Two blend modes in each of two layers: four draws, in layer
+	// order.
+	//
+
+	reset_sprite_batch(&batcher);
+	for (i = 0; i < 1000; i++) {
+		s = random_sprite(&random, 0.0f);
+		s.layer = (uint16_t)(i % 2 == 0 ? 7 : 3);
+		add_sprites(&batcher, &s, 1);
+	}
+
+	draw_count = build_sprite_batch(&batcher, 0);
+	success = check(draw_count == 4, "a blend mode in a layer is a draw") && success;
+
+	layers_in_order = true;
+	previous_layer = 0;
+	for (i = 0; i < 1000; i++) {
+		const sprite& sorted = batcher.sprites[batcher.keys[i] & 0xffffff];
+
+		layers_in_order = layers_in_order && sorted.layer >= previous_layer;
+		previous_layer = sorted.layer;
+	}
+
+	success = check(layers_in_order, "lower layers are drawn first") && success;
+
+	//
+	// More quads than the indices reach, all the same.
+	//
+
+	reset_sprite_batch(&batcher);
+	for (i = 0; i < SPRITE_QUADS_PER_DRAW * 2 + 5; i++) {
+		s = random_sprite(&random, 0.0f);
+		s.layer = 0;
+		s.blend = SPRITE_BLEND_OPAQUE;
+		add_sprites(&batcher, &s, 1);
+	}
+
+	draw_count = build_sprite_batch(&batcher, 0);
+	success = check(draw_count == 3, "draws are split when the indices run out") && success;
+
+	covered = true;
+	next_vertex = 0;
+	for (i = 0; i < draw_count; i++) {
+		covered = covered &&
+			batcher.draws[i].base_vertex == next_vertex &&
+			batcher.draws[i].index_count <= SPRITE_INDEX_COUNT &&
+			batcher.draws[i].index_count % 6 == 0;
+		next_vertex += batcher.draws[i].index_count / 6 * 4;
+	}
+
+	covered = covered && next_vertex == (SPRITE_QUADS_PER_DRAW * 2 + 5) * 4;
+	success = check(covered, "the draws cover every quad, once, in order") && success;
+
+	return success;
+}
+
+static bool run_sort() {
+	sprite_batcher batcher;
+	vector<uint8_t> vertices;
+	vector<uint64_t> expected;
+	sprite s;
+	mt19937 random(5);
+	uint32_t i;
+
+	printf("Sort\n");
+
+	vertices.resize(get_sprite_vertex_buffer_size(50000, 1));
+	initialize_sprite_batcher(&batcher, 50000, 1, vertices.data());
+	set_sprite_viewport(&batcher, SCREEN_W, SCREEN_H);
+
+	reset_sprite_batch(&batcher);
+	for (i = 0; i < 50000; i++) {
+		s = random_sprite(&random, 0.0f);
+		s.layer = (uint16_t)random();
+		s.blend = (uint16_t)(random() % SPRITE_BLEND_COUNT);
+		// A few repeats, so some keys differ only by index.
+		s.texture = random() % (i % 2 == 0 ? 4 : 0x100000);
+		add_sprites(&batcher, &s, 1);
+	}
+
+	expected = batcher.keys;
+	sort(expected.begin(), expected.end());
+
+	build_sprite_batch(&batcher, 0);
+
+	return check(batcher.keys == expected, "the same order as std::sort");
+}
+
+static bool run_frames() {
+	sprite_batcher batcher;
+	vector<uint8_t> vertices;
+	vector<sprite> sprites;
+	mt19937 random(3);
+	size_t region;
+	size_t capacity;
+	const sprite* data;
+	bool untouched;
+	bool success;
+	uint32_t frame;
+	uint32_t i;
+
+	printf("Frames\n");
+
+	vertices.assign(get_sprite_vertex_buffer_size(100, 3), 0);
+	initialize_sprite_batcher(&batcher, 100, 3, vertices.data());
+	set_sprite_viewport(&batcher, SCREEN_W, SCREEN_H);
+
+	sprites.resize(150);
+	for (i = 0; i < sprites.size(); i++) {
+		sprites[i] = random_sprite(&random, 3.0f);
+	}
+
+	reset_sprite_batch(&batcher);
+	success = check(add_sprites(&batcher, sprites.data(), 150) == 100, "only as many as fit are added");
+	success = check(get_sprite_batcher_stats(&batcher).dropped == 50, "and the rest are counted as dropped") && success;
+
+	//
+	// Frame 1 writes the middle region and nothing else.
+	//
+
+	build_sprite_batch(&batcher, 1);
+	region = get_sprite_vertex_buffer_size(100, 1);
+
+	untouched = true;
+	for (i = 0; i < region; i++) {
+		untouched = untouched && vertices[i] == 0 && vertices[region * 2 + i] == 0;
+	}
+
+	success = check(get_sprite_frame_offset(&batcher, 1) == region, "each frame has its own region") && success;
+	success = check(untouched, "and a frame only writes to its own") && success;
+
+	//
+	// The storage is all reserved up front.
+	//
+
+	capacity = batcher.sprites.capacity() + batcher.keys.capacity() + batcher.sort_scratch.capacity() + batcher.draws.capacity();
+	data = batcher.sprites.data();
+
+	for (frame = 0; frame < 10; frame++) {
+		reset_sprite_batch(&batcher);
+		add_sprites(&batcher, sprites.data(), 100);
+		build_sprite_batch(&batcher, frame);
+	}
+
+	success = check(
+		capacity == batcher.sprites.capacity() + batcher.keys.capacity() + batcher.sort_scratch.capacity() +
+			batcher.draws.capacity() &&
+		data == batcher.sprites.data(),
+		"frames don't reallocate anything"
+	) && success;
+
+	return success;
+}
+
+static bool run_benchmark() {
+	sprite_batcher batcher;
+	vector<uint8_t> vertices;
+	vector<sprite> sprites;
+	mt19937 random(4);
+	double start;
+	double frame_time;
+	double sorted_time;
+	double expand_time;
+	double scalar_time;
+	double write_time;
+	uint32_t draw_count;
+	uint32_t frame;
+	uint32_t i;
+
+	printf("Benchmark (%u quads a frame)\n", BENCH_QUADS);
+
+	vertices.resize(get_sprite_vertex_buffer_size(BENCH_QUADS, 1));
+	initialize_sprite_batcher(&batcher, BENCH_QUADS, 1, vertices.data());
+	set_sprite_viewport(&batcher, SCREEN_W, SCREEN_H);
+
+	sprites.resize(BENCH_QUADS);
+	for (i = 0; i < BENCH_QUADS; i++) {
+		sprites[i] = random_sprite(&random, 3.14159f);
+	}
+
+	// Touch everything once so the first frame isn't page faults.
+	reset_sprite_batch(&batcher);
+	add_sprites(&batcher, sprites.data(), BENCH_QUADS);
+	build_sprite_batch(&batcher, 0);
+
+	//
+	// Whole frames.
+	//
+
+	draw_count = 0;
+	start = now_seconds();
+
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		reset_sprite_batch(&batcher);
+		add_sprites(&batcher, sprites.data(), BENCH_QUADS);
+		draw_count = build_sprite_batch(&batcher, 0);
+	}
+
+	frame_time = (now_seconds() - start) / BENCH_FRAMES;
+
+	//
+	// Just the expansion: SIMD in the sorted order, as a frame does it,
+	// then SIMD and scalar in the order the sprites are in, to compare
+	// like with like.
+	//
+
+	start = now_seconds();
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		expand_sprites(
+			sprites.data(),
+			batcher.keys.data(),
+			BENCH_QUADS,
+			batcher.screen_scale,
+			batcher.screen_offset,
+			(sprite_vertex*)vertices.data()
+		);
+	}
+	sorted_time = (now_seconds() - start) / BENCH_FRAMES;
+
+	start = now_seconds();
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		expand_sprites(
+			sprites.data(),
+			NULL,
+			BENCH_QUADS,
+			batcher.screen_scale,
+			batcher.screen_offset,
+			(sprite_vertex*)vertices.data()
+		);
+	}
+	expand_time = (now_seconds() - start) / BENCH_FRAMES;
+
+	start = now_seconds();
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		expand_reference(
+			sprites.data(),
+			BENCH_QUADS,
+			batcher.screen_scale,
+			batcher.screen_offset,
+			(sprite_vertex*)vertices.data()
+		);
+	}
+	scalar_time = (now_seconds() - start) / BENCH_FRAMES;
+
+	start = now_seconds();
+	for (frame = 0; frame < BENCH_FRAMES; frame++) {
+		memset(vertices.data(), (int)frame, vertices.size());
+	}
+	write_time = (now_seconds() - start) / BENCH_FRAMES;
+
+	printf("  a frame: %.2fms, %u draws (%.1fns a quad)\n", frame_time * 1000.0, draw_count, frame_time * 1e9 / BENCH_QUADS);
+	printf("  adding, sorting and batching: %.2fms\n", (frame_time - sorted_time) * 1000.0);
+	printf("  expanding in sorted order: %.2fms\n", sorted_time * 1000.0);
+	printf(
+		"  expanding in order: %.2fms SIMD, %.2fms scalar (%.1fx)\n",
+		expand_time * 1000.0,
+		scalar_time * 1000.0,
+		scalar_time / expand_time
+	);
+	printf("  just writing the vertex buffer: %.2fms\n", write_time * 1000.0);
+	printf("  %s", get_sprite_batcher_report(&batcher).c_str());
+
+	return check(frame_time < GOAL_SECONDS, "a million quads a frame in under 16.7ms");
+}
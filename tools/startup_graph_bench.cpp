@@ -0,0 +1,273 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Runs the application's startup as a task graph with stand-ins for
+	the device work, and compares it with doing the same steps one after
+	another like it used to.
+
+	Each stand-in just sleeps for about as long as the real step takes
+	(compiling a shader, decoding the PNG, waiting on the GPU...), so
+	the numbers say how much the graph overlaps, not how fast any one
+	step is.
+
+	Checks:
+		order        No task starts before everything it depends on has
+		             finished.
+		cycle        A graph with a cycle is refused.
+		exception    A task that throws stops the tasks after it, and
+		             run_task_graph throws the same exception.
+
+	Usage:
+		startup_graph_bench [worker count]
+*/
+
+#include "task_graph.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+struct stub_step {
+	const char* name;
+	uint32_t milliseconds;
+};
+
+// Roughly what each step takes on a debug build.
+static stub_step root_signature_step = { "root signature", 3 };
+static stub_step vertex_shader_step = { "vertex shader", 60 };
+static stub_step pixel_shader_step = { "pixel shader", 55 };
+static stub_step pipeline_state_step = { "pipeline state", 20 };
+static stub_step decode_texture_step = { "decode texture", 30 };
+static stub_step cube_buffers_step = { "cube buffers", 2 };
+static stub_step upload_texture_step = { "upload texture", 4 };
+static stub_step frame_graph_step = { "frame graph", 3 };
+static stub_step depth_view_step = { "depth view", 1 };
+// How long the GPU takes to do the copies once asked to.
+static stub_step gpu_sync_step = { "gpu sync", 8 };
+
+static bool check(const bool condition, const char* message);
+static void run_stub(void* data);
+static void throw_error(void* data);
+static void build_startup_graph(task_graph* graph);
+static double run_serial_startup();
+static bool check_order(const task_graph* graph);
+
+static bool run_startup(job_system* system, const uint32_t workers);
+static bool run_cycle_check(job_system* system);
+static bool run_exception_check(job_system* system);
+
+int main(int argc, char** argv) {
+	job_system* system;
+	uint32_t workers;
+	bool success;
+
+	workers = 4;
+	if (argc > 1) {
+		workers = (uint32_t)strtoul(argv[1], NULL, 10);
+	}
+
+	system = new job_system;
+	initialize_job_system(system, workers, false);
+
+	success = true;
+	success = run_startup(system, workers) && success;
+	success = run_cycle_check(system) && success;
+	success = run_exception_check(system) && success;
+
+	shutdown_job_system(system);
+	delete system;
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	if (!condition) {
+		printf("  FAILED: %s\n", message);
+	}
+
+	return condition;
+}
+
+static void run_stub(void* data) {
+	this_thread::sleep_for(chrono::milliseconds(((stub_step*)data)->milliseconds));
+}
+
+static void throw_error(void*) {
+	throw runtime_error("decode failed");
+}
+
+static void build_startup_graph(task_graph* graph) {
+	uint32_t root_signature;
+	uint32_t vertex_shader;
+	uint32_t pixel_shader;
+	uint32_t pipeline_state;
+	uint32_t decode_texture;
+	uint32_t cube_buffers;
+	uint32_t upload_texture;
+	uint32_t frame_graph;
+	uint32_t depth_view;
+
+	//
+	// The same shape as load_assets.
+	//
+
+	reset_task_graph(graph);
+
+	root_signature = add_task(graph, root_signature_step.name, run_stub, &root_signature_step);
+	vertex_shader = add_task(graph, vertex_shader_step.name, run_stub, &vertex_shader_step);
+	pixel_shader = add_task(graph, pixel_shader_step.name, run_stub, &pixel_shader_step);
+	pipeline_state = add_task(graph, pipeline_state_step.name, run_stub, &pipeline_state_step);
+	decode_texture = add_task(graph, decode_texture_step.name, run_stub, &decode_texture_step);
+	cube_buffers = add_task(graph, cube_buffers_step.name, run_stub, &cube_buffers_step);
+	upload_texture = add_task(graph, upload_texture_step.name, run_stub, &upload_texture_step);
+	frame_graph = add_task(graph, frame_graph_step.name, run_stub, &frame_graph_step);
+	depth_view = add_task(graph, depth_view_step.name, run_stub, &depth_view_step);
+
+	add_task_dependency(graph, pipeline_state, root_signature);
+	add_task_dependency(graph, pipeline_state, vertex_shader);
+	add_task_dependency(graph, pipeline_state, pixel_shader);
+	add_task_dependency(graph, upload_texture, decode_texture);
+	add_task_dependency(graph, upload_texture, cube_buffers);
+	add_task_dependency(graph, frame_graph, upload_texture);
+	add_task_dependency(graph, depth_view, frame_graph);
+}
+
+static double run_serial_startup() {
+	chrono::steady_clock::time_point start;
+
+	//
+	// The order load_assets used to go in, waiting on the GPU after
+	// the texture and again before the depth buffer.
+	//
+
+	start = chrono::steady_clock::now();
+
+	run_stub(&root_signature_step);
+	run_stub(&vertex_shader_step);
+	run_stub(&pixel_shader_step);
+	run_stub(&pipeline_state_step);
+	run_stub(&cube_buffers_step);
+	run_stub(&decode_texture_step);
+	run_stub(&upload_texture_step);
+	run_stub(&gpu_sync_step);
+	run_stub(&frame_graph_step);
+	run_stub(&gpu_sync_step);
+	run_stub(&depth_view_step);
+
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static bool check_order(const task_graph* graph) {
+	const task_graph_task* task;
+	const task_graph_task* dependent;
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < graph->tasks.size(); i++) {
+		task = &(graph->tasks[i]);
+
+		for (j = 0; j < task->dependents.size(); j++) {
+			dependent = &(graph->tasks[task->dependents[j]]);
+
+			if (dependent->start_ns < task->end_ns) {
+				printf("  %s started before %s finished\n", dependent->name, task->name);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool run_startup(job_system* system, const uint32_t workers) {
+	task_graph graph;
+	chrono::steady_clock::time_point start;
+	double serial_seconds;
+	double graph_seconds;
+	bool success;
+
+	serial_seconds = run_serial_startup();
+
+	build_startup_graph(&graph);
+
+	start = chrono::steady_clock::now();
+	success = check(run_task_graph(&graph, system), "graph refused to run");
+	// One wait on the GPU at the end, for everything.
+	run_stub(&gpu_sync_step);
+	graph_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	success = check(check_order(&graph), "tasks ran out of order") && success;
+
+	printf("order        %s\n", success ? "ok" : "FAILED");
+	printf("%s", get_task_graph_timeline(&graph).c_str());
+	printf("startup      one at a time %.1fms, graph on %u workers %.1fms (%.2fx)\n",
+		serial_seconds * 1000.0,
+		workers,
+		graph_seconds * 1000.0,
+		serial_seconds / graph_seconds
+	);
+
+	return success;
+}
+
+static bool run_cycle_check(job_system* system) {
+	task_graph graph;
+	stub_step step;
+	uint32_t a;
+	uint32_t b;
+	uint32_t c;
+	bool success;
+
+	step = { "stub", 0 };
+
+	a = add_task(&graph, "a", run_stub, &step);
+	b = add_task(&graph, "b", run_stub, &step);
+	c = add_task(&graph, "c", run_stub, &step);
+	add_task_dependency(&graph, b, a);
+	add_task_dependency(&graph, c, b);
+	add_task_dependency(&graph, b, c);
+
+	success = check(!run_task_graph(&graph, system), "ran a graph with a cycle");
+	success = check(graph.tasks[a].end_ns == 0, "ran part of a graph with a cycle") && success;
+
+	printf("cycle        %s\n", success ? "ok" : "FAILED");
+
+	return success;
+}
+
+static bool run_exception_check(job_system* system) {
+	task_graph graph;
+	stub_step step;
+	uint32_t decode;
+	uint32_t upload;
+	bool threw;
+	bool success;
+
+	step = { "stub", 1 };
+
+	decode = add_task(&graph, "decode", throw_error, NULL);
+	upload = add_task(&graph, "upload", run_stub, &step);
+	add_task_dependency(&graph, upload, decode);
+
+	threw = false;
+
+	try {
+		run_task_graph(&graph, system);
+	} catch (const runtime_error& error) {
+		threw = string(error.what()) == "decode failed";
+	}
+
+	success = true;
+	success = check(threw, "didn't throw the task's exception") && success;
+	success = check(graph.tasks[upload].skipped, "ran a task after one failed") && success;
+
+	printf("exception    %s\n", success ? "ok" : "FAILED");
+
+	return success;
+}
@@ -0,0 +1,690 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Checks the decoded texture cache, then times finding textures in it
+	and adding them to it.
+
+	Checks:
+		basics      Asking twice decodes once and gives the same
+		            texture back. The same path with other contents is
+		            another texture. A texture that doesn't decode is
+		            NULL, and isn't decoded again.
+		eviction    Over budget, the least recently used textures go
+		            first, until it's under budget by an eighth, and
+		            ones still referenced never go.
+		sharing     Eight threads asking for the same texture at once
+		            decode it once, and all get it.
+		stress      Eight threads acquiring, retaining and releasing
+		            textures at random, in a cache that only fits a
+		            quarter of them, always see the pixels they should.
+		            Every decode is a miss, and the bytes add up. Run it
+		            under ThreadSanitizer and AddressSanitizer to be
+		            sure nothing's used after it's evicted.
+
+	Benchmark:
+		Times a lookup that hits, on one thread and on every core at
+		once, next to a std::unordered_map behind a mutex. Then a miss
+		(with a decode that does almost nothing, so it's the cache's
+		own cost), and a miss that has to evict.
+
+	Pass --quick to skip the benchmark.
+
+	Usage:
+		texture_cache_bench [--quick]
+*/
+
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+const uint32_t CHECK_THREADS = 8;
+const uint32_t STRESS_TEXTURES = 512;
+const uint32_t STRESS_LOOKUPS = 20000;
+const uint32_t BENCH_TEXTURES = 1024;
+const uint32_t BENCH_LOOKUPS = 1000000;
+
+// What a decode makes: size bytes, all of them seed.
+struct fake_texture {
+	uint32_t size;
+	uint8_t seed;
+	// Milliseconds to take over it.
+	uint32_t delay;
+	atomic<uint32_t>* decodes;
+};
+
+struct stress_thread_data {
+	texture_cache* cache;
+	fake_texture* textures;
+	atomic<uint32_t>* decodes;
+	uint32_t seed;
+	bool success;
+};
+
+struct sharing_thread_data {
+	texture_cache* cache;
+	fake_texture* texture;
+	atomic<uint32_t>* ready;
+	texture_cache_entry* result;
+};
+
+struct hit_thread_data {
+	texture_cache* cache;
+	const vector<string>* paths;
+	uint32_t seed;
+	uint32_t misses;
+};
+
+struct locked_map {
+	mutex lock;
+	unordered_map<string, vector<uint8_t>> textures;
+};
+
+struct locked_thread_data {
+	locked_map* map;
+	const vector<string>* paths;
+	uint32_t seed;
+	uint32_t misses;
+};
+
+static bool check(const bool condition, const char* message);
+static double now_seconds();
+static bool decode_fake_texture(void* data, vector<uint8_t>* pixels);
+static bool fail_decode(void* data, vector<uint8_t>* pixels);
+static bool holds(const texture_cache_entry* texture, const uint32_t size, const uint8_t seed);
+static string get_texture_path(const uint32_t index);
+static void run_sharing_thread(sharing_thread_data* data);
+static void run_stress_thread(stress_thread_data* data);
+static void run_hit_thread(hit_thread_data* data);
+static void run_locked_thread(locked_thread_data* data);
+
+static bool run_basic_check();
+static bool run_eviction_check();
+static bool run_sharing_check();
+static bool run_stress_check();
+static void run_benchmark(const uint32_t cores);
+static double time_hits(texture_cache* cache, const vector<string>& paths, const uint32_t thread_count);
+static double time_locked_hits(locked_map* map, const vector<string>& paths, const uint32_t thread_count);
+
+int main(int argc, char** argv) {
+	uint32_t cores;
+	bool quick;
+	bool success;
+
+	quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	cores = thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+
+	success = true;
+	success = run_basic_check() && success;
+	success = run_eviction_check() && success;
+	success = run_sharing_check() && success;
+	success = run_stress_check() && success;
+
+	if (!quick) {
+		run_benchmark(cores);
+	}
+
+	printf(success ? "All checks passed\n" : "Some checks FAILED\n");
+
+	return success ? 0 : 1;
+}
+
+static bool check(const bool condition, const char* message) {
+	printf("  %s: %s\n", condition ? "ok" : "FAIL", message);
+
+	return condition;
+}
+
+static double now_seconds() {
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool decode_fake_texture(void* data, vector<uint8_t>* pixels) {
+	fake_texture* texture;
+
+	texture = (fake_texture*)data;
+
+	if (texture->decodes) {
+		texture->decodes->fetch_add(1);
+	}
+
+	if (texture->delay > 0) {
+		this_thread::sleep_for(chrono::milliseconds(texture->delay));
+	}
+
+	pixels->assign(texture->size, texture->seed);
+
+	return true;
+}
+
+static bool fail_decode(void* data, vector<uint8_t>* pixels) {
+	fake_texture* texture;
+
+	texture = (fake_texture*)data;
+	texture->decodes->fetch_add(1);
+
+	// Some of it, like a decoder that gives up part way.
+	pixels->assign(100, 0);
+
+	return false;
+}
+
+static bool holds(const texture_cache_entry* texture, const uint32_t size, const uint8_t seed) {
+	uint32_t i;
+
+	if (!texture || texture->pixels.size() != size) {
+		return false;
+	}
+
+	for (i = 0; i < size; i++) {
+		if (texture->pixels[i] != seed) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static string get_texture_path(const uint32_t index) {
+	return "textures/texture_" + to_string(index) + ".png";
+}
+
+static void run_sharing_thread(sharing_thread_data* data) {
+	// All at once, or as near as threads can be.
+	(*data->ready)++;
+	while (*data->ready < CHECK_THREADS) {
+		this_thread::yield();
+	}
+
+	data->result = acquire_texture(data->cache, "shared.png", 9, decode_fake_texture, data->texture);
+}
+
+static void run_stress_thread(stress_thread_data* data) {
+	mt19937 random(data->seed);
+	texture_cache_entry* held[4];
+	texture_cache_entry* texture;
+	fake_texture* source;
+	uint32_t index;
+	uint32_t i;
+	uint32_t j;
+
+	data->success = true;
+	memset(held, 0, sizeof(held));
+
+	for (i = 0; i < STRESS_LOOKUPS; i++) {
+		// Some textures far more than others, like a real scene.
+		index = random() % STRESS_TEXTURES;
+		if (random() % 2 == 0) {
+			index %= STRESS_TEXTURES / 16;
+		}
+
+		source = &(data->textures[index]);
+		texture = acquire_texture(data->cache, get_texture_path(index), index, decode_fake_texture, source);
+
+		if (!holds(texture, source->size, source->seed)) {
+			data->success = false;
+		}
+
+		//
+		// Hang on to some for a while, through another reference, and
+		// check they're still right when they're let go.
+		//
+
+		j = random() % 4;
+
+		if (held[j]) {
+			if (held[j]->pixels.empty() || held[j]->pixels[0] != held[j]->pixels.back()) {
+				data->success = false;
+			}
+
+			release_texture(data->cache, held[j]);
+			held[j] = NULL;
+		}
+
+		if (texture && random() % 8 == 0) {
+			retain_texture(texture);
+			held[j] = texture;
+		}
+
+		release_texture(data->cache, texture);
+	}
+
+	for (j = 0; j < 4; j++) {
+		release_texture(data->cache, held[j]);
+	}
+}
+
+static void run_hit_thread(hit_thread_data* data) {
+	mt19937 random(data->seed);
+	texture_cache_entry* texture;
+	uint32_t i;
+
+	data->misses = 0;
+
+	for (i = 0; i < BENCH_LOOKUPS; i++) {
+		texture = acquire_texture(data->cache, (*data->paths)[random() % data->paths->size()], 0, fail_decode, NULL);
+
+		if (!texture) {
+			data->misses++;
+		}
+
+		release_texture(data->cache, texture);
+	}
+}
+
+static void run_locked_thread(locked_thread_data* data) {
+	mt19937 random(data->seed);
+	uint32_t i;
+
+	data->misses = 0;
+
+	for (i = 0; i < BENCH_LOOKUPS; i++) {
+		lock_guard<mutex> guard(data->map->lock);
+
+		if (data->map->textures.find((*data->paths)[random() % data->paths->size()]) == data->map->textures.end()) {
+			data->misses++;
+		}
+	}
+}
+
+static bool run_basic_check() {
+	texture_cache* cache;
+	texture_cache_entry* first;
+	texture_cache_entry* second;
+	texture_cache_entry* changed;
+	texture_cache_stats stats;
+	atomic<uint32_t> decodes;
+	fake_texture texture;
+	fake_texture broken;
+	bool success;
+
+	printf("basics\n");
+
+	cache = new texture_cache;
+	initialize_texture_cache(cache, 1024 * 1024);
+	decodes = 0;
+
+	texture.size = 4096;
+	texture.seed = 7;
+	texture.delay = 0;
+	texture.decodes = &decodes;
+
+	first = acquire_texture(cache, "a.png", 1, decode_fake_texture, &texture);
+	second = acquire_texture(cache, "a.png", 1, decode_fake_texture, &texture);
+	success = check(first && first == second && decodes == 1, "asking twice decodes once");
+	success = check(holds(second, 4096, 7), "and it holds what was decoded") && success;
+
+	texture.seed = 8;
+	changed = acquire_texture(cache, "a.png", 2, decode_fake_texture, &texture);
+	success = check(changed != first && decodes == 2 && holds(changed, 4096, 8), "other contents are another texture") && success;
+	success = check(holds(first, 4096, 7), "and the old one's still there") && success;
+
+	release_texture(cache, first);
+	release_texture(cache, second);
+	release_texture(cache, changed);
+
+	broken.decodes = &decodes;
+	success = check(!acquire_texture(cache, "broken.png", 3, fail_decode, &broken), "one that doesn't decode is NULL") && success;
+	success = check(!acquire_texture(cache, "broken.png", 3, fail_decode, &broken) && decodes == 3, "and isn't decoded again") && success;
+
+	stats = get_texture_cache_stats(cache);
+	success = check(
+		stats.entry_count == 3 && stats.bytes == 8192 && stats.misses == 3 && stats.hits == 2 && stats.failures == 1,
+		"3 textures, 8KB, 3 misses, 2 hits, 1 failure"
+	) && success;
+
+	printf("%s", get_texture_cache_report(cache).c_str());
+
+	shutdown_texture_cache(cache);
+	delete cache;
+
+	return success;
+}
+
+static bool run_eviction_check() {
+	const uint32_t size = 64 * 1024;
+	texture_cache* cache;
+	texture_cache_entry* texture;
+	texture_cache_entry* held[20];
+	texture_cache_stats stats;
+	atomic<uint32_t> decodes;
+	fake_texture sources[40];
+	uint32_t i;
+	bool right;
+	bool success;
+
+	printf("eviction\n");
+
+	// Room for 16.
+	cache = new texture_cache;
+	initialize_texture_cache(cache, 16 * size);
+	decodes = 0;
+
+	for (i = 0; i < 40; i++) {
+		sources[i].size = size;
+		sources[i].seed = (uint8_t)i;
+		sources[i].delay = 0;
+		sources[i].decodes = &decodes;
+	}
+
+	//
+	// Fill it, keep using the first one, then add one more than fits.
+	//
+
+	for (i = 0; i < 16; i++) {
+		release_texture(cache, acquire_texture(cache, get_texture_path(i), 0, decode_fake_texture, &sources[i]));
+	}
+
+	success = check(get_texture_cache_stats(cache).evictions == 0, "16 fit with nothing evicted");
+
+	release_texture(cache, acquire_texture(cache, get_texture_path(0), 0, decode_fake_texture, &sources[0]));
+	release_texture(cache, acquire_texture(cache, get_texture_path(16), 0, decode_fake_texture, &sources[16]));
+
+	stats = get_texture_cache_stats(cache);
+	success = check(stats.evictions == 3 && stats.bytes == 14 * size, "the 17th evicts down to 7/8 of the budget") && success;
+
+	decodes = 0;
+	texture = acquire_texture(cache, get_texture_path(0), 0, decode_fake_texture, &sources[0]);
+	success = check(decodes == 0 && holds(texture, size, 0), "the one that kept being used stayed") && success;
+	release_texture(cache, texture);
+
+	texture = acquire_texture(cache, get_texture_path(1), 0, decode_fake_texture, &sources[1]);
+	success = check(decodes == 1 && holds(texture, size, 1), "the oldest went") && success;
+	release_texture(cache, texture);
+
+	//
+	// Holding more than fits. Nothing held goes, and they all go once
+	// they're let go of.
+	//
+
+	for (i = 0; i < 20; i++) {
+		held[i] = acquire_texture(cache, get_texture_path(20 + i), 0, decode_fake_texture, &sources[20 + i]);
+	}
+
+	stats = get_texture_cache_stats(cache);
+	right = true;
+	for (i = 0; i < 20; i++) {
+		right = right && holds(held[i], size, (uint8_t)(20 + i));
+	}
+
+	success = check(stats.bytes >= 20 * size && right, "20 held stay, over budget") && success;
+
+	for (i = 0; i < 20; i++) {
+		release_texture(cache, held[i]);
+	}
+
+	stats = get_texture_cache_stats(cache);
+	success = check(stats.bytes <= 16 * size, "and go once they're released, till it's back under budget") && success;
+
+	printf("%s", get_texture_cache_report(cache).c_str());
+
+	shutdown_texture_cache(cache);
+	delete cache;
+
+	return success;
+}
+
+static bool run_sharing_check() {
+	texture_cache* cache;
+	sharing_thread_data data[CHECK_THREADS];
+	thread threads[CHECK_THREADS];
+	texture_cache_stats stats;
+	atomic<uint32_t> decodes;
+	atomic<uint32_t> ready;
+	fake_texture texture;
+	uint32_t i;
+	bool right;
+	bool success;
+
+	printf("sharing\n");
+
+	cache = new texture_cache;
+	initialize_texture_cache(cache, 1024 * 1024);
+	decodes = 0;
+	ready = 0;
+
+	texture.size = 256 * 1024;
+	texture.seed = 42;
+	texture.delay = 50;
+	texture.decodes = &decodes;
+
+	for (i = 0; i < CHECK_THREADS; i++) {
+		data[i].cache = cache;
+		data[i].texture = &texture;
+		data[i].ready = &ready;
+		threads[i] = thread(run_sharing_thread, &data[i]);
+	}
+
+	right = true;
+	for (i = 0; i < CHECK_THREADS; i++) {
+		threads[i].join();
+		right = right && data[i].result == data[0].result && holds(data[i].result, texture.size, 42);
+	}
+
+	stats = get_texture_cache_stats(cache);
+	success = check(decodes == 1, "8 threads at once decode it once");
+	success = check(right, "and all get it") && success;
+	success = check(stats.misses == 1 && stats.shared_decodes + stats.hits == CHECK_THREADS - 1, "one miss, and the rest wait for it") && success;
+	printf("  %llu waited for the decode, %llu came after it\n", (unsigned long long)stats.shared_decodes, (unsigned long long)stats.hits);
+
+	for (i = 0; i < CHECK_THREADS; i++) {
+		release_texture(cache, data[i].result);
+	}
+
+	shutdown_texture_cache(cache);
+	delete cache;
+
+	return success;
+}
+
+static bool run_stress_check() {
+	texture_cache* cache;
+	stress_thread_data data[CHECK_THREADS];
+	thread threads[CHECK_THREADS];
+	vector<fake_texture> sources;
+	texture_cache_stats stats;
+	atomic<uint32_t> decodes;
+	uint64_t total_size;
+	uint32_t i;
+	bool right;
+	bool success;
+
+	printf("stress\n");
+
+	mt19937 random(3);
+	sources.resize(STRESS_TEXTURES);
+	decodes = 0;
+	total_size = 0;
+
+	for (i = 0; i < STRESS_TEXTURES; i++) {
+		sources[i].size = 1024 + random() % (16 * 1024);
+		sources[i].seed = (uint8_t)(1 + random() % 255);
+		sources[i].delay = 0;
+		sources[i].decodes = &decodes;
+		total_size += sources[i].size;
+	}
+
+	cache = new texture_cache;
+	initialize_texture_cache(cache, total_size / 4);
+
+	for (i = 0; i < CHECK_THREADS; i++) {
+		data[i].cache = cache;
+		data[i].textures = sources.data();
+		data[i].decodes = &decodes;
+		data[i].seed = 200 + i;
+		threads[i] = thread(run_stress_thread, &data[i]);
+	}
+
+	right = true;
+	for (i = 0; i < CHECK_THREADS; i++) {
+		threads[i].join();
+		right = right && data[i].success;
+	}
+
+	stats = get_texture_cache_stats(cache);
+
+	success = check(right, "160,000 lookups from 8 threads all see the right pixels");
+	success = check(stats.misses == decodes, "every decode was a miss") && success;
+	success = check(stats.evictions > 0 && stats.bytes <= cache->budget, "textures were evicted, and it's under budget") && success;
+	success = check(stats.hits + stats.misses + stats.shared_decodes == CHECK_THREADS * STRESS_LOOKUPS, "every lookup is counted once") && success;
+
+	printf("%s", get_texture_cache_report(cache).c_str());
+
+	shutdown_texture_cache(cache);
+	delete cache;
+
+	return success;
+}
+
+static void run_benchmark(const uint32_t cores) {
+	vector<string> paths;
+	vector<fake_texture> sources;
+	texture_cache* cache;
+	locked_map* map;
+	fake_texture tiny;
+	double start;
+	double hit_time;
+	double locked_time;
+	double miss_time;
+	double evict_time;
+	uint32_t i;
+
+	paths.resize(BENCH_TEXTURES);
+	for (i = 0; i < BENCH_TEXTURES; i++) {
+		paths[i] = get_texture_path(i);
+	}
+
+	tiny.size = 64;
+	tiny.seed = 1;
+	tiny.delay = 0;
+	tiny.decodes = NULL;
+
+	cache = new texture_cache;
+	initialize_texture_cache(cache, 1024 * 1024 * 1024);
+	map = new locked_map;
+
+	for (i = 0; i < BENCH_TEXTURES; i++) {
+		release_texture(cache, acquire_texture(cache, paths[i], 0, decode_fake_texture, &tiny));
+		map->textures[paths[i]].assign(64, 1);
+	}
+
+	printf("\nLookups that hit, among %u textures:\n", BENCH_TEXTURES);
+
+	hit_time = time_hits(cache, paths, 1);
+	locked_time = time_locked_hits(map, paths, 1);
+	printf("  1 thread:   %6.1fns a lookup (a locked unordered_map takes %6.1fns)\n", hit_time * 1e9, locked_time * 1e9);
+
+	// Where the lock starts to cost something.
+	if (cores > 1) {
+		hit_time = time_hits(cache, paths, cores);
+		locked_time = time_locked_hits(map, paths, cores);
+		printf("  %u threads: %6.1fns a lookup (a locked unordered_map takes %6.1fns)\n", cores, hit_time * 1e9, locked_time * 1e9);
+	}
+
+	shutdown_texture_cache(cache);
+	delete cache;
+	delete map;
+
+	//
+	// Misses, into a cache big enough for everything, and then into one
+	// that only fits a tenth of it.
+	//
+
+	cache = new texture_cache;
+	initialize_texture_cache(cache, 1024 * 1024 * 1024);
+
+	start = now_seconds();
+	for (i = 0; i < BENCH_TEXTURES; i++) {
+		release_texture(cache, acquire_texture(cache, paths[i], 1, decode_fake_texture, &tiny));
+	}
+
+	miss_time = (now_seconds() - start) / BENCH_TEXTURES;
+
+	shutdown_texture_cache(cache);
+	initialize_texture_cache(cache, BENCH_TEXTURES * tiny.size / 10);
+
+	start = now_seconds();
+	for (i = 0; i < BENCH_TEXTURES; i++) {
+		release_texture(cache, acquire_texture(cache, paths[i], 1, decode_fake_texture, &tiny));
+	}
+
+	evict_time = (now_seconds() - start) / BENCH_TEXTURES;
+
+	printf("\nLookups that miss (the decode does almost nothing):\n");
+	printf("  %6.1fns each, or %6.1fns when it has to evict\n", miss_time * 1e9, evict_time * 1e9);
+	printf("%s\n", get_texture_cache_report(cache).c_str());
+
+	shutdown_texture_cache(cache);
+	delete cache;
+}
+
+static double time_hits(texture_cache* cache, const vector<string>& paths, const uint32_t thread_count) {
+	vector<hit_thread_data> data;
+	vector<thread> threads;
+	uint32_t misses;
+	uint32_t i;
+	double start;
+	double elapsed;
+
+	data.resize(thread_count);
+	start = now_seconds();
+
+	for (i = 0; i < thread_count; i++) {
+		data[i].cache = cache;
+		data[i].paths = &paths;
+		data[i].seed = i;
+		threads.push_back(thread(run_hit_thread, &data[i]));
+	}
+
+	misses = 0;
+	for (i = 0; i < thread_count; i++) {
+		threads[i].join();
+		misses += data[i].misses;
+	}
+
+	elapsed = now_seconds() - start;
+
+	if (misses > 0) {
+		printf("  %u lookups missed!\n", misses);
+	}
+
+	// Per lookup, for all the threads together.
+	return elapsed / ((double)BENCH_LOOKUPS * thread_count);
+}
+
+static double time_locked_hits(locked_map* map, const vector<string>& paths, const uint32_t thread_count) {
+	vector<locked_thread_data> data;
+	vector<thread> threads;
+	uint32_t i;
+	double start;
+
+	data.resize(thread_count);
+	start = now_seconds();
+
+	for (i = 0; i < thread_count; i++) {
+		data[i].map = map;
+		data[i].paths = &paths;
+		data[i].seed = i;
+		threads.push_back(thread(run_locked_thread, &data[i]));
+	}
+
+	for (i = 0; i < thread_count; i++) {
+		threads[i].join();
+	}
+
+	return (now_seconds() - start) / ((double)BENCH_LOOKUPS * thread_count);
+}
@@ -0,0 +1,205 @@
+// Liam Wynn, 10/18/2026, Hello DirectX 12
+
+/*
+	Hammers the TLSF allocator with random allocations and frees and
+	checks it never hands out overlapping or misaligned ranges, and that
+	everything merges back into one block once it's all freed. Then it
+	times allocate/free pairs and prints the fragmentation it ended up
+	with.
+
+	The sizes and alignments are the ones the GPU allocator sees:
+	4KB small textures, 64KB buffers and textures, 4MB MSAA targets.
+
+	Usage:
+		tlsf_stress [iterations] [seed]
+*/
+
+#include "tlsf_allocator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+const uint64_t HEAP_SIZE = 256ULL * 1024 * 1024;
+const uint64_t ALIGNMENTS[] = { 4096, 65536, 65536, 65536, 4 * 1024 * 1024 };
+const uint32_t ALIGNMENT_COUNT = sizeof(ALIGNMENTS) / sizeof(ALIGNMENTS[0]);
+
+struct live_allocation {
+	uint32_t block;
+	uint64_t offset;
+	uint64_t size;
+};
+
+static bool run_stress(const uint32_t iterations, const uint32_t seed);
+static void run_benchmark(const uint32_t iterations, const uint32_t seed);
+static void print_stats(const tlsf_stats& stats);
+
+int main(int argc, char** argv) {
+	uint32_t iterations;
+	uint32_t seed;
+
+	iterations = 200000;
+	seed = 1;
+
+	if (argc > 1) {
+		iterations = (uint32_t)strtoul(argv[1], NULL, 10);
+	}
+
+	if (argc > 2) {
+		seed = (uint32_t)strtoul(argv[2], NULL, 10);
+	}
+
+	if (!run_stress(iterations, seed)) {
+		return 1;
+	}
+
+	run_benchmark(iterations * 10, seed);
+
+	return 0;
+}
+
+static bool run_stress(const uint32_t iterations, const uint32_t seed) {
+	tlsf_allocator allocator;
+	vector<live_allocation> live;
+	live_allocation allocation;
+	tlsf_stats stats;
+	mt19937 random(seed);
+	uint64_t alignment;
+	uint32_t failed_allocations;
+	uint32_t i;
+	size_t j;
+	size_t victim;
+
+	initialize_tlsf_allocator(&allocator, HEAP_SIZE);
+	failed_allocations = 0;
+
+	for (i = 0; i < iterations; i++) {
+		// Allocate twice as often as we free, so the heap fills up and
+		// stays full.
+		if (!live.empty() && random() % 3 == 0) {
+			victim = random() % live.size();
+			tlsf_free(&allocator, live[victim].block);
+			live[victim] = live.back();
+			live.pop_back();
+			continue;
+		}
+
+		allocation.size = random() % (4 * 1024 * 1024) + 1;
+		alignment = ALIGNMENTS[random() % ALIGNMENT_COUNT];
+		allocation.block = tlsf_allocate(
+			&allocator,
+			allocation.size,
+			alignment,
+			&(allocation.offset)
+		);
+
+		if (allocation.block == TLSF_INVALID_BLOCK) {
+			failed_allocations++;
+			continue;
+		}
+
+		if (allocation.offset % alignment != 0) {
+			printf("FAIL: offset %llu isn't %llu aligned\n",
+				(unsigned long long)allocation.offset,
+				(unsigned long long)alignment);
+			return false;
+		}
+
+		if (allocation.offset + allocation.size > HEAP_SIZE) {
+			printf("FAIL: allocation runs off the end of the heap\n");
+			return false;
+		}
+
+		for (j = 0; j < live.size(); j++) {
+			if (allocation.offset < live[j].offset + live[j].size &&
+				live[j].offset < allocation.offset + allocation.size) {
+				printf("FAIL: allocations overlap\n");
+				return false;
+			}
+		}
+
+		live.push_back(allocation);
+	}
+
+	printf("Stress: %u iterations, %zu live allocations, %u didn't fit\n",
+		iterations, live.size(), failed_allocations);
+	print_stats(get_tlsf_stats(&allocator));
+
+	for (j = 0; j < live.size(); j++) {
+		tlsf_free(&allocator, live[j].block);
+	}
+
+	stats = get_tlsf_stats(&allocator);
+	if (stats.free_block_count != 1 || stats.largest_free_block != HEAP_SIZE) {
+		printf("FAIL: freeing everything left %u free blocks\n", stats.free_block_count);
+		return false;
+	}
+
+	printf("Stress: OK\n\n");
+
+	return true;
+}
+
+static void run_benchmark(const uint32_t iterations, const uint32_t seed) {
+	tlsf_allocator allocator;
+	vector<uint32_t> live;
+	vector<uint64_t> sizes;
+	vector<uint64_t> alignments;
+	chrono::high_resolution_clock::time_point start;
+	double seconds;
+	mt19937 random(seed);
+	uint64_t offset;
+	uint32_t block;
+	uint32_t i;
+	size_t slot;
+
+	initialize_tlsf_allocator(&allocator, HEAP_SIZE);
+
+	//
+	// Pick the sizes up front so we only time the allocator. Keep a
+	// few thousand allocations live so the free lists aren't trivial.
+	//
+
+	sizes.resize(iterations);
+	alignments.resize(iterations);
+	for (i = 0; i < iterations; i++) {
+		sizes[i] = random() % (256 * 1024) + 1;
+		alignments[i] = ALIGNMENTS[random() % (ALIGNMENT_COUNT - 1)];
+	}
+
+	live.resize(1024, TLSF_INVALID_BLOCK);
+
+	start = chrono::high_resolution_clock::now();
+
+	for (i = 0; i < iterations; i++) {
+		slot = i % live.size();
+
+		if (live[slot] != TLSF_INVALID_BLOCK) {
+			tlsf_free(&allocator, live[slot]);
+		}
+
+		block = tlsf_allocate(&allocator, sizes[i], alignments[i], &offset);
+		live[slot] = block;
+	}
+
+	seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+	printf("Benchmark: %u allocate/free pairs in %.3fms (%.1fns each)\n",
+		iterations, seconds * 1000.0, seconds * 1e9 / (double)iterations);
+	print_stats(get_tlsf_stats(&allocator));
+}
+
+static void print_stats(const tlsf_stats& stats) {
+	printf("  %.1fMB of %.1fMB used by %u allocations, %u free blocks, "
+		"largest free %.1fMB, %.0f%% fragmented\n",
+		(double)stats.used_bytes / (1024.0 * 1024.0),
+		(double)stats.total_bytes / (1024.0 * 1024.0),
+		stats.allocation_count,
+		stats.free_block_count,
+		(double)stats.largest_free_block / (1024.0 * 1024.0),
+		stats.fragmentation * 100.0f);
+}